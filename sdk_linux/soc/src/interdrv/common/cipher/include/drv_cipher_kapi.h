@@ -137,7 +137,9 @@ typedef enum {
 #define CRYPTO_CMD_SYMC_GET_CONFIG     crypto_iowr(0x0e, sizeof(symc_get_cfg_t))
 #define CRYPTO_CMD_KLAD_KEY            crypto_iowr(0x0f, sizeof(klad_key_t))
 #define CRYPTO_CMD_BN_EXP_MOD          crypto_iowr(0x10, sizeof(klad_key_t))
-#define CRYPTO_CMD_COUNT               0x11
+#define CRYPTO_CMD_SYMC_ENCRYPTMULTI_ASYNC crypto_iow (0x11, sizeof(symc_encrypt_multi_t))
+#define CRYPTO_CMD_SYMC_ASYNC_DONE     crypto_iowr(0x12, sizeof(symc_async_done_t))
+#define CRYPTO_CMD_COUNT               0x13
 
 #define crypto_chk_err_goto(_expr) \
     do { \
@@ -286,6 +288,13 @@ typedef struct {
     hi_u32 operation;       /* Decrypt or encrypt */
 } symc_encrypt_multi_t;
 
+/* struct of Symmetric cipher asynchronous completion */
+typedef struct {
+    hi_u32 id;              /* Id of soft channel */
+    hi_u32 done;            /* The submitted packages are finished or not */
+    hi_s32 result;          /* Result of the submitted packages, valid when done */
+} symc_async_done_t;
+
 /* struct of Symmetric cipher get tag */
 typedef struct {
     hi_u32 id;                            /* Id of soft channel */
@@ -499,6 +508,44 @@ hi_s32 kapi_symc_crypto_via(symc_encrypt_t *crypt, hi_u32 is_from_user);
  */
 hi_s32 kapi_symc_crypto_multi(hi_u32 id, const hi_cipher_data *pack, hi_u32 pack_num, hi_u32 operation, hi_u32 last);
 
+/*
+ * brief            SYMC multiple buffer encryption/decryption without waiting.
+ *
+ * The packages are started on the hardware channel of the handle and the call
+ * returns at once, the result is collected with kapi_symc_async_done().
+ * Only one submission may be pending per handle, other calls on the handle
+ * return HI_ERR_CIPHER_BUSY until it is collected.
+ *
+ * param[in] id     The channel number.
+ * param pack       Buffer of package information, from user
+ * param pack_num   Number of package information
+ * param operation  decrypt or encrypt
+ *
+ * return           0 if successful
+ */
+hi_s32 kapi_symc_crypto_multi_async(hi_u32 id, const hi_cipher_data *pack, hi_u32 pack_num, hi_u32 operation);
+
+/*
+ * brief             Collect the result of an asynchronous submission.
+ * param[in]  id     The channel number.
+ * param[out] done   HI_TRUE if the submission is finished and collected.
+ * param[out] result result of the submission, valid when done.
+ *
+ * return            0 if successful
+ */
+hi_s32 kapi_symc_async_done(hi_u32 id, hi_u32 *done, hi_s32 *result);
+
+/*
+ * brief   Check whether the caller has an asynchronous submission to collect.
+ * retval  HI_TRUE if one of the caller's handles is finished.
+ */
+hi_u32 kapi_symc_async_poll(hi_void);
+
+/*
+ * brief   Wait queue woken up when an asynchronous submission finishes.
+ */
+hi_void *kapi_symc_async_queue(hi_void);
+
 /*
  * brief          SYMC multiple buffer encryption/decryption.
  * param[in]  id  The channel number.
@@ -141,6 +141,7 @@ static CRYPTO_IRQRETURN_T drv_symc_interrupt_isr(hi_s32 irq, hi_void *dev_id)
 {
     hi_u32 mask, i;
     symc_hard_context *ctx = HI_NULL;
+    callback_symc_isr callback = HI_NULL;
 
     hi_log_debug("symc irq: %d\n", irq);
 
@@ -160,10 +161,10 @@ static CRYPTO_IRQRETURN_T drv_symc_interrupt_isr(hi_s32 irq, hi_void *dev_id)
                 continue;
             }
 
-            /* continue to load other nodes */
-            if ((ctx->callback) && (ctx->callback(ctx->ctx) == HI_FALSE)) {
+            /* continue to load other nodes, the callback restarts the channel */
+            callback = ctx->callback;
+            if ((callback != HI_NULL) && (callback(ctx->ctx) == HI_FALSE)) {
                 hi_log_debug("continue to compute chn %u\n", i);
-                drv_symc_start(i);
             } else { /* finished, no more nodes need to be load */
                 ctx->done = HI_TRUE;
                 hi_log_debug("chn %u wake up\n", i);
@@ -1399,6 +1400,47 @@ hi_s32 drv_symc_set_isr_callback(hi_u32 chn_num, callback_symc_isr callback, hi_
     return HI_SUCCESS;
 }
 
+hi_s32 drv_symc_reset(hi_u32 chn_num)
+{
+    hi_u32 int_valid = 0;
+    hi_u32 int_num = 0;
+    hi_u32 process;
+    symc_hard_context *ctx = HI_NULL;
+
+    hi_log_func_enter();
+
+    hi_log_chk_init_err_return(g_symc_initialize);
+    hi_log_chk_param_return(chn_num >= CRYPTO_HARD_CHANNEL_MAX);
+
+    ctx = crypto_channel_get_context(g_symc_hard_channel,
+                                     CRYPTO_HARD_CHANNEL_MAX, chn_num);
+    if (ctx == HI_NULL) {
+        hi_log_error("crypto channel get context failed, ctx is null!\n");
+        return HI_ERR_CIPHER_INVALID_POINT;
+    }
+
+    ctx->callback = HI_NULL;
+    ctx->ctx = HI_NULL;
+
+    /* wait for a running isr to leave the callback detached above. */
+    module_get_attr(CRYPTO_MODULE_ID_SYMC, &int_valid, &int_num, HI_NULL);
+#ifdef CRYPTO_OS_INT_SUPPORT
+    if (int_valid) {
+        crypto_synchronize_irq(int_num);
+    }
+#endif
+
+    /* release the nodes already computed and drop the pending count. */
+    process = symc_read(reg_chann_ofull_cnt(chn_num));
+    symc_write(reg_chann_iempty_cnt(chn_num), process);
+    symc_write(reg_chann_ofull_cnt(chn_num),  process);
+    ctx->cnt = 0;
+    ctx->done = HI_FALSE;
+
+    hi_log_func_exit();
+    return HI_SUCCESS;
+}
+
 hi_s32 drv_symc_start(hi_u32 chn_num)
 {
     symc_hard_context *ctx = HI_NULL;
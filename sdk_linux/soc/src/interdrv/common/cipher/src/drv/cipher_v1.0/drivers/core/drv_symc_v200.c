@@ -167,6 +167,7 @@ static CRYPTO_IRQRETURN_T drv_symc_interrupt_isr(hi_s32 irq, hi_void *dev_id)
 {
     hi_u32 mask, i;
     symc_hard_context *ctx = HI_NULL;
+    callback_symc_isr callback = HI_NULL;
     CRYPTO_IRQRETURN_T ret = IRQ_HANDLED;
 
     crypto_unused(irq);
@@ -179,10 +180,10 @@ static CRYPTO_IRQRETURN_T drv_symc_interrupt_isr(hi_s32 irq, hi_void *dev_id)
     for (i = 0; i < CRYPTO_HARD_CHANNEL_MAX; i++) {
         if ((mask >> i) & 0x01) {
             ctx = &g_hard_context[i];
-            if ((ctx->callback) && (ctx->callback(ctx->ctx) == HI_FALSE)) {
-                /* continue to compute */
+            callback = ctx->callback;
+            if ((callback != HI_NULL) && (callback(ctx->ctx) == HI_FALSE)) {
+                /* the callback restarted the channel to compute the next nodes */
                 hi_log_debug("continue to compute chn %u\n", i);
-                drv_symc_start(i);
             } else {
                 /* finish */
                 ctx->done = HI_TRUE;
@@ -1572,6 +1573,44 @@ hi_s32 drv_symc_set_isr_callback(hi_u32 chn_num, callback_symc_isr callback, hi_
     return HI_SUCCESS;
 }
 
+hi_s32 drv_symc_reset(hi_u32 chn_num)
+{
+    hi_s32 ret;
+    hi_u32 int_valid = 0;
+    hi_u32 int_num = 0;
+    symc_hard_context *ctx = HI_NULL;
+
+    hi_log_func_enter();
+
+    hi_log_chk_param_return(g_symc_initialize != HI_TRUE);
+    hi_log_chk_param_return(chn_num >= CRYPTO_HARD_CHANNEL_MAX);
+
+    ctx = &g_hard_context[chn_num];
+    ctx->callback = HI_NULL;
+    ctx->ctx = HI_NULL;
+
+    /* wait for a running isr to leave the callback detached above. */
+    module_get_attr(CRYPTO_MODULE_ID_SYMC, &int_valid, &int_num, HI_NULL);
+#ifdef CRYPTO_OS_INT_SUPPORT
+    if (int_valid) {
+        crypto_synchronize_irq(int_num);
+    }
+#endif
+
+    /* drop the nodes not yet started and resync the node index with the hardware. */
+    ctx->cnt_in = 0;
+    ctx->cnt_out = 0;
+    ctx->done = HI_FALSE;
+    ret = drv_symc_recover_entry(chn_num);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(drv_symc_recover_entry, ret);
+        return ret;
+    }
+
+    hi_log_func_exit();
+    return HI_SUCCESS;
+}
+
 hi_s32 drv_symc_start(hi_u32 chn_num)
 {
     symc_hard_context *ctx = HI_NULL;
@@ -217,6 +217,9 @@ typedef struct {
     hi_u32 num;
 } symc_multi_pack;
 
+/* async crypto finish notify, called in isr */
+typedef hi_void (*callback_symc_done)(hi_void *param, hi_s32 result);
+
 /*
  * \brief          symc context structure
  *
@@ -259,8 +262,12 @@ typedef struct {
     hi_u32 *length_list;         /* length of node list */
     symc_node_usage *usage_list; /* usage of node list */
     hi_bool tdes2dma;            /* 3des with invalid key turns to dma */
+
+    callback_symc_done notify;   /* async crypto finish notify */
+    hi_void *notify_param;       /* params for notify function */
 } cryp_symc_context;
 
+/* isr callback, returns HI_FALSE if it restarted the channel with more nodes, HI_TRUE when finished. */
 typedef hi_s32 (*callback_symc_isr)(hi_void *ctx);
 typedef hi_void (*callback_symc_destroy)(hi_void);
 
@@ -303,9 +310,9 @@ hi_s32 drv_symc_alloc_chn(hi_u32 *chn_num);
 hi_void drv_symc_free_chn(hi_u32 chn_num);
 
 /*
- * brief  set the iv to the symc module.
+ * brief  reset a symc channel after a timeout, detach the isr callback and drop the pending nodes.
  * param[in]  chn_num The channel number.
- * retval     NA.
+ * retval     On success, HI_SUCCESS is returned.  On error, HI_FAILURE is returned.
  */
 hi_s32 drv_symc_reset(hi_u32 chn_num);
 
@@ -28,6 +28,9 @@
 /* try to create memory for HASH */
 #define HASH_PHY_MEM_CREATE_TRY_TIME    10
 
+/* DMA memory is split into ping-pong buffers, one is copied while the other is hashed */
+#define HASH_DMA_BUF_CNT                2
+
 /* block size */
 #define SHA1_BLOCK_SIZE                 64
 #define SHA224_BLOCK_SIZE               64
@@ -348,12 +351,49 @@ static hi_s32 cryp_hash_chunk_copy(const hi_void *chunk, hi_u32 chunk_len,
     return HI_SUCCESS;
 }
 
-/* hash hardware computation */
+/* get the idx ping-pong buffer of the hash dma memory, each one is size bytes */
+static hi_void cryp_hash_dma_buf(const crypto_mem *mem, hi_u32 idx, hi_u32 size, crypto_mem *buf)
+{
+    *buf = *mem;
+    addr_u64(buf->dma_addr) += (hi_u64)idx * size;
+    addr_u64(buf->mmz_addr) += (hi_u64)idx * size;
+    buf->dma_virt = (hi_u8 *)mem->dma_virt + idx * size;
+    buf->dma_size = size;
+}
+
+static hi_s32 cryp_hash_chunk_start(cryp_hash_context *hisi_ctx, const crypto_mem *buf, hi_u32 size)
+{
+    hi_s32 ret;
+
+    /* configure mode, the state is the result of the last chunk */
+    ret = drv_hash_cfg(hisi_ctx->hard_chn, hisi_ctx->mode, hisi_ctx->hash);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(drv_hash_cfg, ret);
+        return ret;
+    }
+
+    /* start */
+    ret = drv_hash_start(hisi_ctx->hard_chn, buf, size);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(drv_hash_start, ret);
+        return ret;
+    }
+
+    return HI_SUCCESS;
+}
+
+/*
+ * hash hardware computation
+ * The message is copied into the ping-pong dma buffers in turn, the next chunk
+ * is copied while the engine is still hashing the previous one.
+ */
 static hi_s32 cryp_hash_process(cryp_hash_context *hisi_ctx, const hi_u8 *msg, hi_u32 length, hash_chunk_src src)
 {
     hi_s32 ret;
-    hi_void *buf = HI_NULL;
-    hi_u32 left, size, max;
+    hi_s32 ret_wait;
+    crypto_mem buf[HASH_DMA_BUF_CNT];
+    hi_u32 left, size, max, idx;
+    hi_u32 busy = HI_FALSE;
 
     hi_log_func_enter();
 
@@ -365,59 +405,59 @@ static hi_s32 cryp_hash_process(cryp_hash_context *hisi_ctx, const hi_u8 *msg, h
 
     hi_log_debug("length 0x%x, dma_size 0x%x\n", length, hisi_ctx->mem.dma_size);
 
-    /* get dma buffer */
-    buf = crypto_mem_virt(&hisi_ctx->mem);
-
-    /* align at block size */
-    max = hisi_ctx->mem.dma_size - hisi_ctx->mem.dma_size % hisi_ctx->block_size;
+    /* size of each dma buffer, align at block size */
+    max = hisi_ctx->mem.dma_size / HASH_DMA_BUF_CNT;
+    max -= max % hisi_ctx->block_size;
+    for (idx = 0; idx < HASH_DMA_BUF_CNT; idx++) {
+        cryp_hash_dma_buf(&hisi_ctx->mem, idx, max, &buf[idx]);
+    }
 
     /* re-compute left length */
-    for (left = length; left > 0; left -= size, msg += size) {
-        if (left <= max) {
-            /* left size less than dma buffer,
-             * can process all left message
-             */
-            size = left;
-        } else {
-            /* left size large than dma buffer,
-             * just process message with dma size
-             */
-            size = max;
-        }
+    for (idx = 0, left = length; left > 0; left -= size, msg += size, idx = (idx + 1) % HASH_DMA_BUF_CNT) {
+        /* process all left message or just message with dma size */
+        size = (left <= max) ? left : max;
 
         hi_log_debug("msg 0x%pK, size 0x%x, left 0x%x, max 0x%x\n", msg, size, left, max);
 
-        /* copy message to dma buffer */
-        ret = cryp_hash_chunk_copy(msg, size, buf, size, src);
+        /* copy message to the idle dma buffer while the last chunk is being hashed */
+        ret = cryp_hash_chunk_copy(msg, size, crypto_mem_virt(&buf[idx]), size, src);
         if (ret != HI_SUCCESS) {
             hi_log_print_func_err(cryp_hash_chunk_copy, ret);
-            return ret;
+            goto exit__;
         }
 
-        /* configure mode */
-        ret = drv_hash_cfg(hisi_ctx->hard_chn, hisi_ctx->mode, hisi_ctx->hash);
-        if (ret != HI_SUCCESS) {
-            hi_log_print_func_err(drv_hash_cfg, ret);
-            return ret;
+        /* wait the last chunk done, the state is needed by the next one */
+        if (busy == HI_TRUE) {
+            busy = HI_FALSE;
+            ret = drv_hash_wait_done(hisi_ctx->hard_chn, hisi_ctx->hash);
+            if (ret != HI_SUCCESS) {
+                hi_log_print_func_err(drv_hash_wait_done, ret);
+                return ret;
+            }
         }
 
-        /* start */
-        ret = drv_hash_start(hisi_ctx->hard_chn, &hisi_ctx->mem, size);
+        ret = cryp_hash_chunk_start(hisi_ctx, &buf[idx], size);
         if (ret != HI_SUCCESS) {
-            hi_log_print_func_err(drv_hash_start, ret);
+            hi_log_print_func_err(cryp_hash_chunk_start, ret);
             return ret;
         }
+        busy = HI_TRUE;
+    }
 
-        /* wait done */
-        ret = drv_hash_wait_done(hisi_ctx->hard_chn, hisi_ctx->hash);
-        if (ret != HI_SUCCESS) {
-            hi_log_print_func_err(drv_hash_wait_done, ret);
-            return ret;
+    ret = HI_SUCCESS;
+
+exit__:
+    /* never leave the engine running on the dma buffer */
+    if (busy == HI_TRUE) {
+        ret_wait = drv_hash_wait_done(hisi_ctx->hard_chn, hisi_ctx->hash);
+        if (ret_wait != HI_SUCCESS) {
+            hi_log_print_func_err(drv_hash_wait_done, ret_wait);
+            return ret_wait;
         }
     }
 
     hi_log_func_exit();
-    return HI_SUCCESS;
+    return ret;
 }
 
 /* hash message padding to align at block size */
@@ -679,7 +719,7 @@ static hi_void cryp_register_hash_default(hi_u32 capacity, hash_mode mode, hi_u3
         func.block_size = blocksize;
         func.size = hashlen;
         func.create = ext_sm3_create;
-        func.destroy = ext_sm3_destroy;
+        func.destroy = ext_sm3_destory;
         func.update = ext_sm3_update;
         func.finish = ext_sm3_finish;
         func_register_hash(&func);
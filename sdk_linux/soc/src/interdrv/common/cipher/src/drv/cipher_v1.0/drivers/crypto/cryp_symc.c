@@ -474,6 +474,29 @@ static hi_s32 symc_add_buf_list(hi_void *ctx)
     return SYMC_NODES_ADD_NOTFINISHED;
 }
 
+/* isr callback of async crypto, on finished HI_TRUE is returned otherwise HI_FALSE is returned */
+static hi_s32 symc_isr_add_buf_list(hi_void *ctx)
+{
+    hi_s32 ret;
+    cryp_symc_context *hisi_ctx = ctx;
+
+    ret = symc_add_buf_list(hisi_ctx);
+    if (ret == SYMC_NODES_ADD_NOTFINISHED) {
+        /* continue to compute the next nodes */
+        ret = drv_symc_start(hisi_ctx->hard_chn);
+        if (ret == HI_SUCCESS) {
+            return HI_FALSE;
+        }
+        hi_log_print_func_err(drv_symc_start, ret);
+    }
+
+    if (hisi_ctx->notify != HI_NULL) {
+        hisi_ctx->notify(hisi_ctx->notify_param, (ret == SYMC_NODES_ADD_FINISHED) ? HI_SUCCESS : ret);
+    }
+
+    return HI_TRUE;
+}
+
 static symc_klen cryp_symc_key_type(symc_alg alg, hi_u32 klen)
 {
     symc_klen type;
@@ -561,6 +584,10 @@ static hi_s32 cryp_symc_wait_done(hi_void *ctx, hi_u32 timeout)
     ret = drv_symc_wait_done(hisi_ctx->hard_chn, timeout);
     if (ret != HI_SUCCESS) {
         hi_log_print_func_err(drv_symc_wait_done, ret);
+
+        /* the isr must not walk the nodes list of a caller that gave up waiting. */
+        drv_symc_set_isr_callback(hisi_ctx->hard_chn, HI_NULL, HI_NULL);
+        drv_symc_reset(hisi_ctx->hard_chn);
         return ret;
     }
 
@@ -654,13 +681,13 @@ static hi_s32 cryp_symc_crypto_process(cryp_symc_context *hisi_ctx, hi_u32 wait)
     } else {
         /* add buf list once */
         ret = symc_add_buf_list(hisi_ctx);
-        if (ret != HI_SUCCESS) {
+        if (ret != SYMC_NODES_ADD_NOTFINISHED) {
             hi_log_print_func_err(symc_add_buf_list, ret);
-            return ret;
+            return (ret == SYMC_NODES_ADD_FINISHED) ? HI_ERR_CIPHER_INVALID_PARAM : ret;
         }
 
         /* set isr callback function */
-        ret = drv_symc_set_isr_callback(hisi_ctx->hard_chn, symc_add_buf_list, hisi_ctx);
+        ret = drv_symc_set_isr_callback(hisi_ctx->hard_chn, symc_isr_add_buf_list, hisi_ctx);
         if (ret != HI_SUCCESS) {
             hi_log_print_func_err(drv_symc_set_isr_callback, ret);
             return ret;
@@ -731,6 +758,33 @@ static hi_s32 cryp_symc_crypto(hi_void *ctx, hi_u32 operation, symc_multi_pack *
     return HI_SUCCESS;
 }
 
+static hi_s32 cryp_symc_crypto_async(hi_void *ctx, hi_u32 operation, symc_multi_pack *pack,
+    callback_symc_done notify, hi_void *param)
+{
+    cryp_symc_context *hisi_ctx = ctx;
+    hi_u32 int_valid = 0;
+    hi_u32 int_num = 0;
+
+    hi_log_chk_param_return(hisi_ctx == HI_NULL);
+    hi_log_chk_param_return(notify == HI_NULL);
+
+    /* the completion is only reported by the isr */
+    module_get_attr(CRYPTO_MODULE_ID_SYMC, &int_valid, &int_num, HI_NULL);
+#ifndef CRYPTO_OS_INT_SUPPORT
+    int_valid = HI_FALSE;
+#endif
+    if (int_valid != HI_TRUE) {
+        hi_log_error("async crypto need the interrupt of symc\n");
+        hi_log_print_err_code(HI_ERR_CIPHER_UNSUPPORTED);
+        return HI_ERR_CIPHER_UNSUPPORTED;
+    }
+
+    hisi_ctx->notify = notify;
+    hisi_ctx->notify_param = param;
+
+    return cryp_symc_crypto(ctx, operation, pack, HI_FALSE);
+}
+
 #ifdef CHIP_AES_CCM_GCM_SUPPORT
 static hi_s32 cryp_aead_ccm_setiv(hi_void *ctx, const hi_u8 *iv, hi_u32 ivlen, hi_u32 usage)
 {
@@ -1529,6 +1583,7 @@ static hi_void cryp_register_symc_aes(hi_u32 capacity, symc_mode mode)
 
     if (capacity == CRYPTO_CAPACITY_SUPPORT) {
         cryp_register_symc_default(&func, SYMC_ALG_AES, mode);
+        func.crypto_async = cryp_symc_crypto_async;
         ret = cryp_register_symc(&func);
         if (ret != HI_SUCCESS) {
             hi_log_print_func_err(cryp_register_symc, ret);
@@ -1703,6 +1758,7 @@ static hi_void cryp_register_symc_tdes(hi_u32 capacity, symc_mode mode)
     if (capacity == CRYPTO_CAPACITY_SUPPORT) {
         cryp_register_symc_default(&func, SYMC_ALG_TDES, mode);
         func.setkey = cryp_tdes_setkey;
+        func.crypto_async = cryp_symc_crypto_async;
         ret = cryp_register_symc(&func);
         if (ret != HI_SUCCESS) {
             hi_log_print_func_err(cryp_register_symc, ret);
@@ -1739,6 +1795,7 @@ static hi_void cryp_register_symc_des(hi_u32 capacity, symc_mode mode)
     if (capacity == CRYPTO_CAPACITY_SUPPORT) {
         cryp_register_symc_default(&func, SYMC_ALG_DES, mode);
         func.setkey = cryp_des_setkey;
+        func.crypto_async = cryp_symc_crypto_async;
         ret = cryp_register_symc(&func);
         if (ret != HI_SUCCESS) {
             hi_log_print_func_err(cryp_register_symc, ret);
@@ -1811,7 +1868,7 @@ static hi_void cryp_register_symc_sm4(hi_u32 capacity, symc_mode mode)
 
         cryp_register_symc_default(&func, SYMC_ALG_SM4, mode);
         func.create = ext_sm4_create;
-        func.destroy = ext_sm4_destroy;
+        func.destroy = ext_sm4_destory;
         func.setiv = ext_sm4_setiv;
         func.getiv = ext_sm4_getiv;
         func.setkey = ext_sm4_setkey;
@@ -128,6 +128,22 @@ typedef hi_s32 (*func_symc_sm1_setround)(hi_void *ctx, hi_u32 round);
  */
 typedef hi_s32 (*func_symc_crypto)(hi_void *ctx, hi_u32 operation, symc_multi_pack *pack, hi_u32 wait);
 
+/**
+ * brief          symc  buffer encryption/decryption without waiting.
+ *
+ * Note: The nodes of pack must be kept until notify is called from isr.
+ *
+ * param ctx       symc ctx
+ * param operation decrypt or encrypt
+ * param pack     package for encrypt or decrypt.
+ * param notify   called in isr when all the nodes finished or failed
+ * param param    param of notify
+ *
+ * return         0 if successful
+ */
+typedef hi_s32 (*func_symc_crypto_async)(hi_void *ctx, hi_u32 operation, symc_multi_pack *pack,
+    callback_symc_done notify, hi_void *param);
+
 /**
  * brief          CCM/GCM set Associated Data
  *
@@ -164,6 +180,7 @@ typedef struct {
     func_symc_getiv   getiv;    /* getiv function */
     func_aead_set_aad setadd;   /* setadd function */
     func_aead_get_tag gettag;   /* get tag function */
+    func_symc_crypto_async crypto_async; /* async crypto function, null if unsupported */
     func_symc_crypto  crypto;   /* crypto function */
     func_symc_wait_done waitdone; /* wait done */
 } symc_func;
@@ -18,38 +18,43 @@
 
 #include "drv_osal_lib.h"
 #include "cryp_hash.h"
+#include "ext_alg.h"
 #include "securec.h"
 
 #ifdef SOFT_SM3_SUPPORT
 
 /* ************************** Internal Structure Definition For SM3 *************************** */
-static hi_u32 rotate_left(hi_u32 x, hi_u32 n)
-{
-    n %= SHIFT_32BITS;
-
-    if (n == 0) {
-        return x;
-    }
-
-    return (x << n) | (x >> (SHIFT_32BITS - n));
-}
+/* rotate left of 32 bits word, 0 < n < 32 */
+#define rotate_left(x, n) (((x) << (n)) | ((x) >> (SHIFT_32BITS - (n))))
 
 #define p0(x) ((x) ^ rotate_left((x), SHIFT_9BITS)  ^ rotate_left((x), SHIFT_17BITS))
 #define p1(x) ((x) ^ rotate_left((x), SHIFT_15BITS) ^ rotate_left((x), SHIFT_23BITS))
 
 #define ff0(x, y, z) ((x) ^ (y) ^ (z))
-#define ff1(x, y, z) (((x) & (y)) | ((x) & (z)) | ((y) & (z)))
+#define ff1(x, y, z) (((x) & (y)) | (((x) | (y)) & (z)))
 
 #define gg0(x, y, z) ((x) ^ (y) ^ (z))
-#define gg1(x, y, z) (((x) & (y)) | ((~(x)) & (z)))
+#define gg1(x, y, z) ((((y) ^ (z)) & (x)) ^ (z))
+
+#define getu32(pt) (((hi_u32)(pt)[0] << 24) ^ ((hi_u32)(pt)[1] << 16) ^ ((hi_u32)(pt)[2] << 8) ^ ((hi_u32)(pt)[3]))
 
 #define SM3_BLOCK_SIZE            64
-#define SM3_W_SIZE                ((SM3_BLOCK_SIZE) + (WORD_WIDTH))
+#define SM3_ROUNDS                64
+#define SM3_W_SIZE                ((SM3_ROUNDS) + (WORD_WIDTH))
+#define SM3_BLOCK_SIZE_IN_WORD    ((SM3_BLOCK_SIZE) / (WORD_WIDTH))
 #define SM3_RESULT_SIZE_IN_WORD   ((SM3_RESULT_SIZE) / (WORD_WIDTH))
 #define SM3_PAD_MIN_SIZE          9
 #define SM3_PAD_LEN_SIZE          8
+#define SM3_PAD_SIZE              ((SM3_BLOCK_SIZE) * 2)
 #define SM3_BYTE_MSB              0x80
 
+/* streams hashed together by ext_sm3_multi */
+#define SM3_LANES                 4
+
+/* hmac ipad and opad byte */
+#define SM3_HMAC_IPAD_BYTE        0x36
+#define SM3_HMAC_OPAD_BYTE        0x5C
+
 /* SM3, the initial hash value, sm3_h(0). */
 #define SM3_H0    0x7380166F
 #define SM3_H1    0x4914B2B9
@@ -71,98 +76,225 @@ typedef struct {
     hi_u32 total;
 } ext_sm3_context;
 
+/* T(j) <<< j, T(j) is 0x79CC4519 for round 0 ~ 15 and 0x7A879D8A for round 16 ~ 63 */
+static const hi_u32 g_sm3_tj[SM3_ROUNDS] = {
+    0x79cc4519, 0xf3988a32, 0xe7311465, 0xce6228cb,
+    0x9cc45197, 0x3988a32f, 0x7311465e, 0xe6228cbc,
+    0xcc451979, 0x988a32f3, 0x311465e7, 0x6228cbce,
+    0xc451979c, 0x88a32f39, 0x11465e73, 0x228cbce6,
+    0x9d8a7a87, 0x3b14f50f, 0x7629ea1e, 0xec53d43c,
+    0xd8a7a879, 0xb14f50f3, 0x629ea1e7, 0xc53d43ce,
+    0x8a7a879d, 0x14f50f3b, 0x29ea1e76, 0x53d43cec,
+    0xa7a879d8, 0x4f50f3b1, 0x9ea1e762, 0x3d43cec5,
+    0x7a879d8a, 0xf50f3b14, 0xea1e7629, 0xd43cec53,
+    0xa879d8a7, 0x50f3b14f, 0xa1e7629e, 0x43cec53d,
+    0x879d8a7a, 0x0f3b14f5, 0x1e7629ea, 0x3cec53d4,
+    0x79d8a7a8, 0xf3b14f50, 0xe7629ea1, 0xcec53d43,
+    0x9d8a7a87, 0x3b14f50f, 0x7629ea1e, 0xec53d43c,
+    0xd8a7a879, 0xb14f50f3, 0x629ea1e7, 0xc53d43ce,
+    0x8a7a879d, 0x14f50f3b, 0x29ea1e76, 0x53d43cec,
+    0xa7a879d8, 0x4f50f3b1, 0x9ea1e762, 0x3d43cec5,
+};
+
+/* a lane of ext_sm3_multi: the full blocks of its message, then its 1 or 2 pad blocks */
+typedef struct {
+    const hi_u8 *data;
+    hi_u32 data_blocks;
+    hi_u32 blocks;
+    hi_u8 pad[SM3_PAD_SIZE];
+} sm3_lane;
+
+/* work area of ext_sm3_multi, too large for the kernel stack */
+typedef struct {
+    sm3_lane lane[SM3_LANES];
+    hi_u32 w[SM3_W_SIZE][SM3_LANES];
+    hi_u32 state[SM3_LANES][SM3_RESULT_SIZE_IN_WORD];
+    hi_u32 done[SM3_LANES][SM3_RESULT_SIZE_IN_WORD];
+} sm3_multi_work;
+
+/*
+ * One round of compression, wj and wj4 are W(j) and W(j + 4). Instead of
+ * shifting the 8 registers, the caller rotates the arguments: the new a is
+ * left in d, the new e in h, and b, f are rotated in place, so the next round
+ * is sm3_round(d, a, b, c, h, e, f, g).
+ */
+#define sm3_round(a, b, c, d, e, f, g, h, ff, gg, wj, wj4, j)                    \
+    do {                                                                        \
+        hi_u32 a12 = rotate_left((a), 12);                      /* 12: SS1 */   \
+        hi_u32 ss1 = rotate_left(a12 + (e) + g_sm3_tj[j], 7);   /* 7: SS1 */    \
+        hi_u32 ss2 = ss1 ^ a12;                                                 \
+        (d) += ff((a), (b), (c)) + ss2 + ((wj) ^ (wj4));        /* W'(j) */     \
+        (h) += gg((e), (f), (g)) + ss1 + (wj);                                  \
+        (b) = rotate_left((b), 9);                              /* 9: C */      \
+        (f) = rotate_left((f), 19);                             /* 19: G */     \
+        (h) = p0(h);                                                            \
+    } while (0)
+
+/*
+ * 4 rounds from round j, after which the registers are back to their roles.
+ * lane is empty for sm3_compress, or [l] for the lane l of sm3_compress_x4.
+ */
+#define sm3_rounds4(a, b, c, d, e, f, g, h, ff, gg, w, j, lane)                                  \
+    do {                                                                                        \
+        sm3_round(a lane, b lane, c lane, d lane, e lane, f lane, g lane, h lane, ff, gg,       \
+            (w)[j] lane, (w)[(j) + 4] lane, j);                                                 \
+        sm3_round(d lane, a lane, b lane, c lane, h lane, e lane, f lane, g lane, ff, gg,       \
+            (w)[(j) + 1] lane, (w)[(j) + 5] lane, (j) + 1);                                     \
+        sm3_round(c lane, d lane, a lane, b lane, g lane, h lane, e lane, f lane, ff, gg,       \
+            (w)[(j) + 2] lane, (w)[(j) + 6] lane, (j) + 2);                                     \
+        sm3_round(b lane, c lane, d lane, a lane, f lane, g lane, h lane, e lane, ff, gg,       \
+            (w)[(j) + 3] lane, (w)[(j) + 7] lane, (j) + 3);                                     \
+    } while (0)
+
 /* ****************************** API Code for sm3 **************************** */
-static hi_s32 sm3_compress(hi_u32 digest[SM3_RESULT_SIZE_IN_WORD],
-    const hi_u8 block[SM3_BLOCK_SIZE], hi_u32 block_len)
+static hi_void sm3_expand(hi_u32 w[SM3_W_SIZE], const hi_u8 *block)
 {
-    hi_s32 j;
-    hi_u32 *sm3_w = HI_NULL;
-    hi_u32 *sm3_w1 = HI_NULL;
-    hi_u32 *sm3_t = HI_NULL;
-    const hi_u32 *local_block = (const hi_u32 *)block;
-    hi_u32 sm3_a = digest[WORD_IDX_0];
-    hi_u32 sm3_b = digest[WORD_IDX_1];
-    hi_u32 sm3_c = digest[WORD_IDX_2];
-    hi_u32 sm3_d = digest[WORD_IDX_3];
-    hi_u32 sm3_e = digest[WORD_IDX_4];
-    hi_u32 sm3_f = digest[WORD_IDX_5];
-    hi_u32 sm3_g = digest[WORD_IDX_6];
-    hi_u32 sm3_h = digest[WORD_IDX_7];
-    hi_u32 sm3_ss1, sm3_ss2, sm3_tt1, sm3_tt2;
-    hi_u32 *buf = HI_NULL;
-    hi_u32 buf_size;
-
-    if (block_len != SM3_BLOCK_SIZE) {
-        return HI_ERR_CIPHER_INVALID_LENGTH;
-    }
-
-    buf_size = sizeof(hi_u32) * (SM3_W_SIZE + SM3_BLOCK_SIZE + SM3_BLOCK_SIZE);
-    buf = (hi_u32 *)crypto_malloc(buf_size);
-    if (buf == HI_NULL) {
-        hi_log_error("sm3 compress crypto malloc buff failed!\n");
-        return HI_ERR_CIPHER_FAILED_MEM;
+    hi_u32 j;
+
+    for (j = 0; j < SM3_BLOCK_SIZE_IN_WORD; j++) {
+        w[j] = getu32(block + j * WORD_WIDTH);
     }
-    (hi_void)memset_s(buf, buf_size, 0, buf_size);
-    sm3_w = buf;
-    sm3_w1 = buf + SM3_W_SIZE;
-    sm3_t = buf + SM3_W_SIZE + SM3_BLOCK_SIZE;
-
-    for (j = 0; j < SM3_BLOCK_SIZE / WORD_WIDTH; j++) {
-        sm3_w[j] = crypto_cpu_to_be32(local_block[j]);
-    }
-    for (j = SM3_BLOCK_SIZE / WORD_WIDTH; j < SM3_W_SIZE; j++) {
-        sm3_w[j] = p1(sm3_w[j - 16] ^ sm3_w[j - 9] ^ \  /* soft sm3 alg:offset 16, 9. */
-            rotate_left(sm3_w[j - 3], 15))  ^ \  /* soft sm3 alg:offset 3, and rotate left 15. */
-            rotate_left(sm3_w[j - 13], 7)   ^ sm3_w[j - 6];  /* soft sm3 alg:offset 13, 6 and rotate left 7. */
-    }
-    for (j = 0; j < SM3_BLOCK_SIZE; j++) {
-        sm3_w1[j] = sm3_w[j] ^ sm3_w[j + 4];    /* soft sm3 alg:offset 4. */
-    }
-
-    for (j = 0; j < SM3_BLOCK_SIZE / WORD_WIDTH; j++) {
-        sm3_t[j] = 0x79CC4519;  /* soft sm3 alg: sm3_t init 0x79CC4519. */
-        sm3_ss1 = rotate_left((rotate_left(sm3_a, 12) + sm3_e + rotate_left(sm3_t[j], j)), 7); /* rotate left 12, 7. */
-        sm3_ss2 = sm3_ss1 ^ rotate_left(sm3_a, 12);  /* soft sm3 alg:rotate left 12. */
-        sm3_tt1 = ff0(sm3_a, sm3_b, sm3_c) + sm3_d + sm3_ss2 + sm3_w1[j];
-        sm3_tt2 = gg0(sm3_e, sm3_f, sm3_g) + sm3_h + sm3_ss1 + sm3_w[j];
-        sm3_d = sm3_c;
-        sm3_c = rotate_left(sm3_b, 9);   /* soft sm3 alg:rotate left 9. */
-        sm3_b = sm3_a;
-        sm3_a = sm3_tt1;
-        sm3_h = sm3_g;
-        sm3_g = rotate_left(sm3_f, 19);  /* soft sm3 alg:rotate left 19. */
-        sm3_f = sm3_e;
-        sm3_e = p0(sm3_tt2);
-    }
-
-    for (j = SM3_BLOCK_SIZE / WORD_WIDTH; j < SM3_BLOCK_SIZE; j++) {
-        sm3_t[j] = 0x7A879D8A; /* soft sm3 alg: sm3_t init 0x7A879D8A. */
-        sm3_ss1 = rotate_left((rotate_left(sm3_a, 12) + sm3_e + rotate_left(sm3_t[j], j)), 7); /* rotate left 12, 7. */
-        sm3_ss2 = sm3_ss1 ^ rotate_left(sm3_a, 12);  /* soft sm3 alg:rotate left 12. */
-        sm3_tt1 = ff1(sm3_a, sm3_b, sm3_c) + sm3_d + sm3_ss2 + sm3_w1[j];
-        sm3_tt2 = gg1(sm3_e, sm3_f, sm3_g) + sm3_h + sm3_ss1 + sm3_w[j];
-        sm3_d = sm3_c;
-        sm3_c = rotate_left(sm3_b, 9);   /* soft sm3 alg:rotate left 9. */
-        sm3_b = sm3_a;
-        sm3_a = sm3_tt1;
-        sm3_h = sm3_g;
-        sm3_g = rotate_left(sm3_f, 19);  /* soft sm3 alg:rotate left 19. */
-        sm3_f = sm3_e;
-        sm3_e = p0(sm3_tt2);
-    }
-
-    digest[WORD_IDX_0] ^= sm3_a;
-    digest[WORD_IDX_1] ^= sm3_b;
-    digest[WORD_IDX_2] ^= sm3_c;
-    digest[WORD_IDX_3] ^= sm3_d;
-    digest[WORD_IDX_4] ^= sm3_e;
-    digest[WORD_IDX_5] ^= sm3_f;
-    digest[WORD_IDX_6] ^= sm3_g;
-    digest[WORD_IDX_7] ^= sm3_h;
-
-    if (buf != HI_NULL) {
-        crypto_free(buf);
-        buf = HI_NULL;
+
+    /* soft sm3 alg: offset 16, 9, 3, 13, 6 and rotate left 15, 7. */
+    for (j = SM3_BLOCK_SIZE_IN_WORD; j < SM3_W_SIZE; j++) {
+        w[j] = p1(w[j - 16] ^ w[j - 9] ^ rotate_left(w[j - 3], 15)) ^ rotate_left(w[j - 13], 7) ^ w[j - 6];
+    }
+}
+
+/* compress the full blocks of data into digest */
+static hi_void sm3_compress(hi_u32 digest[SM3_RESULT_SIZE_IN_WORD], const hi_u8 *data, hi_u32 blocks)
+{
+    hi_u32 j;
+    hi_u32 w[SM3_W_SIZE];
+    hi_u32 sm3_a, sm3_b, sm3_c, sm3_d, sm3_e, sm3_f, sm3_g, sm3_h;
+
+    for (; blocks > 0; blocks--, data += SM3_BLOCK_SIZE) {
+        sm3_expand(w, data);
+
+        sm3_a = digest[WORD_IDX_0];
+        sm3_b = digest[WORD_IDX_1];
+        sm3_c = digest[WORD_IDX_2];
+        sm3_d = digest[WORD_IDX_3];
+        sm3_e = digest[WORD_IDX_4];
+        sm3_f = digest[WORD_IDX_5];
+        sm3_g = digest[WORD_IDX_6];
+        sm3_h = digest[WORD_IDX_7];
+
+        /* 4 rounds each loop, the registers are back to their roles */
+        for (j = 0; j < SM3_BLOCK_SIZE_IN_WORD; j += WORD_IDX_4) {
+            sm3_rounds4(sm3_a, sm3_b, sm3_c, sm3_d, sm3_e, sm3_f, sm3_g, sm3_h, ff0, gg0, w, j, );
+        }
+        for (j = SM3_BLOCK_SIZE_IN_WORD; j < SM3_ROUNDS; j += WORD_IDX_4) {
+            sm3_rounds4(sm3_a, sm3_b, sm3_c, sm3_d, sm3_e, sm3_f, sm3_g, sm3_h, ff1, gg1, w, j, );
+        }
+
+        digest[WORD_IDX_0] ^= sm3_a;
+        digest[WORD_IDX_1] ^= sm3_b;
+        digest[WORD_IDX_2] ^= sm3_c;
+        digest[WORD_IDX_3] ^= sm3_d;
+        digest[WORD_IDX_4] ^= sm3_e;
+        digest[WORD_IDX_5] ^= sm3_f;
+        digest[WORD_IDX_6] ^= sm3_g;
+        digest[WORD_IDX_7] ^= sm3_h;
+    }
+
+    /* the message may be a hmac key */
+    (hi_void)memset_s(w, sizeof(w), 0, sizeof(w));
+}
+
+/*
+ * Compress one block of each of the SM3_LANES streams. The lane is the inner
+ * index of every word, so the loops over the lanes can run in vector registers.
+ */
+static hi_void sm3_compress_x4(hi_u32 digest[SM3_LANES][SM3_RESULT_SIZE_IN_WORD],
+    const hi_u8 *block[SM3_LANES], hi_u32 w[SM3_W_SIZE][SM3_LANES])
+{
+    hi_u32 j, l;
+    hi_u32 sm3_a[SM3_LANES], sm3_b[SM3_LANES], sm3_c[SM3_LANES], sm3_d[SM3_LANES];
+    hi_u32 sm3_e[SM3_LANES], sm3_f[SM3_LANES], sm3_g[SM3_LANES], sm3_h[SM3_LANES];
+
+    for (j = 0; j < SM3_BLOCK_SIZE_IN_WORD; j++) {
+        for (l = 0; l < SM3_LANES; l++) {
+            w[j][l] = getu32(block[l] + j * WORD_WIDTH);
+        }
+    }
+    for (j = SM3_BLOCK_SIZE_IN_WORD; j < SM3_W_SIZE; j++) {
+        for (l = 0; l < SM3_LANES; l++) {
+            w[j][l] = p1(w[j - 16][l] ^ w[j - 9][l] ^ rotate_left(w[j - 3][l], 15)) ^
+                rotate_left(w[j - 13][l], 7) ^ w[j - 6][l];
+        }
+    }
+
+    for (l = 0; l < SM3_LANES; l++) {
+        sm3_a[l] = digest[l][WORD_IDX_0];
+        sm3_b[l] = digest[l][WORD_IDX_1];
+        sm3_c[l] = digest[l][WORD_IDX_2];
+        sm3_d[l] = digest[l][WORD_IDX_3];
+        sm3_e[l] = digest[l][WORD_IDX_4];
+        sm3_f[l] = digest[l][WORD_IDX_5];
+        sm3_g[l] = digest[l][WORD_IDX_6];
+        sm3_h[l] = digest[l][WORD_IDX_7];
+    }
+
+    for (j = 0; j < SM3_BLOCK_SIZE_IN_WORD; j += WORD_IDX_4) {
+        for (l = 0; l < SM3_LANES; l++) {
+            sm3_rounds4(sm3_a, sm3_b, sm3_c, sm3_d, sm3_e, sm3_f, sm3_g, sm3_h, ff0, gg0, w, j, [l]);
+        }
+    }
+    for (j = SM3_BLOCK_SIZE_IN_WORD; j < SM3_ROUNDS; j += WORD_IDX_4) {
+        for (l = 0; l < SM3_LANES; l++) {
+            sm3_rounds4(sm3_a, sm3_b, sm3_c, sm3_d, sm3_e, sm3_f, sm3_g, sm3_h, ff1, gg1, w, j, [l]);
+        }
+    }
+
+    for (l = 0; l < SM3_LANES; l++) {
+        digest[l][WORD_IDX_0] ^= sm3_a[l];
+        digest[l][WORD_IDX_1] ^= sm3_b[l];
+        digest[l][WORD_IDX_2] ^= sm3_c[l];
+        digest[l][WORD_IDX_3] ^= sm3_d[l];
+        digest[l][WORD_IDX_4] ^= sm3_e[l];
+        digest[l][WORD_IDX_5] ^= sm3_f[l];
+        digest[l][WORD_IDX_6] ^= sm3_g[l];
+        digest[l][WORD_IDX_7] ^= sm3_h[l];
+    }
+}
+
+/* the last 1 or 2 blocks of a message of total bytes: its tail, 0x80, zeros and its length in bits */
+static hi_u32 sm3_pad(hi_u8 pad[SM3_PAD_SIZE], const hi_u8 *tail, hi_u32 tail_len, hi_u32 total)
+{
+    hi_u32 len = (tail_len + SM3_PAD_MIN_SIZE <= SM3_BLOCK_SIZE) ? SM3_BLOCK_SIZE : SM3_PAD_SIZE;
+    hi_u32 i;
+
+    for (i = 0; i < tail_len; i++) {
+        pad[i] = tail[i];
+    }
+    pad[tail_len] = SM3_BYTE_MSB;
+    for (i = tail_len + 1; i < len - WORD_IDX_5; i++) {
+        pad[i] = 0;
+    }
+
+    /* write 8 bytes fix data length * 8 */
+    pad[len - WORD_IDX_5] = (hi_u8)((total >> SHIFT_29BITS) & MAX_LOW_3BITS);
+    pad[len - WORD_IDX_4] = (hi_u8)((total >> SHIFT_21BITS) & MAX_LOW_8BITS);
+    pad[len - WORD_IDX_3] = (hi_u8)((total >> SHIFT_13BITS) & MAX_LOW_8BITS);
+    pad[len - WORD_IDX_2] = (hi_u8)((total >> SHIFT_5BITS)  & MAX_LOW_8BITS);
+    pad[len - WORD_IDX_1] = (hi_u8)((total << SHIFT_3BITS)  & MAX_LOW_8BITS);
+
+    return len / SM3_BLOCK_SIZE;
+}
+
+static hi_s32 sm3_digest_out(hi_u8 *digest, hi_u32 digest_len, const hi_u32 state[SM3_RESULT_SIZE_IN_WORD])
+{
+    hi_u32 i;
+    hi_u32 hash[SM3_RESULT_SIZE_IN_WORD];
+
+    for (i = 0; i < SM3_RESULT_SIZE_IN_WORD; i++) {
+        hash[i] = crypto_cpu_to_be32(state[i]);
+    }
+
+    if (memcpy_s(digest, digest_len, hash, SM3_RESULT_SIZE) != EOK) {
+        hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
+        return HI_ERR_CIPHER_MEMCPY_S_FAILED;
     }
 
     return HI_SUCCESS;
@@ -189,7 +321,6 @@ static hi_void sm3_init(ext_sm3_context *ctx)
 static hi_s32 sm3_update(ext_sm3_context *ctx, const hi_u8 *data, hi_u32 data_len)
 {
     hi_u32 left;
-    hi_s32 ret;
 
     hi_log_func_enter();
 
@@ -209,27 +340,17 @@ static hi_s32 sm3_update(ext_sm3_context *ctx, const hi_u8 *data, hi_u32 data_le
                 hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
                 return HI_ERR_CIPHER_MEMCPY_S_FAILED;
             }
-            ret = sm3_compress(ctx->state, ctx->tail, sizeof(ctx->tail));
-            if (ret != HI_SUCCESS) {
-                hi_log_print_func_err(sm3_compress, ret);
-                return ret;
-            }
+            sm3_compress(ctx->state, ctx->tail, 1);
 
             data += left;
             data_len -= left;
         }
     }
 
-    while (data_len >= SM3_BLOCK_SIZE) {
-        ret = sm3_compress(ctx->state, data, SM3_BLOCK_SIZE);
-        if (ret != HI_SUCCESS) {
-            hi_log_print_func_err(sm3_compress, ret);
-            return ret;
-        }
-
-        data += SM3_BLOCK_SIZE;
-        data_len -= SM3_BLOCK_SIZE;
-    }
+    /* all the full blocks in one go */
+    sm3_compress(ctx->state, data, data_len / SM3_BLOCK_SIZE);
+    data += data_len - data_len % SM3_BLOCK_SIZE;
+    data_len %= SM3_BLOCK_SIZE;
 
     ctx->tail_len = data_len;
     if (data_len) {
@@ -246,55 +367,23 @@ static hi_s32 sm3_update(ext_sm3_context *ctx, const hi_u8 *data, hi_u32 data_le
 
 static hi_s32 sm3_final(ext_sm3_context *ctx, hi_u8 *digest, hi_u32 digest_len)
 {
-    hi_s32 i;
     hi_s32 ret;
-    hi_u32 idx = 0;
-    hi_u32 hash[SM3_RESULT_SIZE_IN_WORD] = {0};
+    hi_u32 blocks;
+    hi_u8 pad[SM3_PAD_SIZE];
 
     hi_log_func_enter();
-    hi_log_chk_param_return(digest_len < SM3_BLOCK_SIZE);
-
-    ctx->tail[ctx->tail_len] = SM3_BYTE_MSB;
-    idx++;
-
-    /* a block is enough */
-    if (ctx->tail_len + SM3_PAD_MIN_SIZE <= SM3_BLOCK_SIZE) {
-        (hi_void)memset_s(ctx->tail + ctx->tail_len + idx, SM3_BLOCK_SIZE - ctx->tail_len - idx,
-                          0, SM3_BLOCK_SIZE - ctx->tail_len - idx);
-    } else {
-        /* 2 block is request */
-        (hi_void)memset_s(ctx->tail + ctx->tail_len + idx, SM3_BLOCK_SIZE - ctx->tail_len - idx,
-                          0, SM3_BLOCK_SIZE - ctx->tail_len - idx);
-        ret = sm3_compress(ctx->state, ctx->tail, sizeof(ctx->tail));
-        if (ret != HI_SUCCESS) {
-            hi_log_print_func_err(sm3_compress, ret);
-            return ret;
-        }
-        (hi_void)memset_s(ctx->tail, SM3_BLOCK_SIZE, 0, SM3_BLOCK_SIZE);
-    }
+    hi_log_chk_param_return(digest_len < SM3_RESULT_SIZE);
 
-    /* write 8 bytes fix data length * 8 */
-    ctx->tail[SM3_BLOCK_SIZE - WORD_IDX_5] = (hi_u8)((ctx->total >> SHIFT_29BITS) & MAX_LOW_3BITS);
-    ctx->tail[SM3_BLOCK_SIZE - WORD_IDX_4] = (hi_u8)((ctx->total >> SHIFT_21BITS) & MAX_LOW_8BITS);
-    ctx->tail[SM3_BLOCK_SIZE - WORD_IDX_3] = (hi_u8)((ctx->total >> SHIFT_13BITS) & MAX_LOW_8BITS);
-    ctx->tail[SM3_BLOCK_SIZE - WORD_IDX_2] = (hi_u8)((ctx->total >> SHIFT_5BITS)  & MAX_LOW_8BITS);
-    ctx->tail[SM3_BLOCK_SIZE - WORD_IDX_1] = (hi_u8)((ctx->total << SHIFT_3BITS)  & MAX_LOW_8BITS);
+    blocks = sm3_pad(pad, ctx->tail, ctx->tail_len, ctx->total);
+    sm3_compress(ctx->state, pad, blocks);
+    (hi_void)memset_s(pad, sizeof(pad), 0, sizeof(pad));
 
-    ret = sm3_compress(ctx->state, ctx->tail, sizeof(ctx->tail));
+    ret = sm3_digest_out(digest, digest_len, ctx->state);
     if (ret != HI_SUCCESS) {
-        hi_log_print_func_err(sm3_compress, ret);
+        hi_log_print_func_err(sm3_digest_out, ret);
         return ret;
     }
 
-    for (i = 0; i < SM3_RESULT_SIZE_IN_WORD; i++) {
-        hash[i] = crypto_cpu_to_be32(ctx->state[i]);
-    }
-
-    if (memcpy_s(digest, digest_len, hash, SM3_RESULT_SIZE) != EOK) {
-        hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
-        return HI_ERR_CIPHER_MEMCPY_S_FAILED;
-    }
-
     hi_log_func_exit();
 
     return HI_SUCCESS;
@@ -326,6 +415,7 @@ hi_s32 ext_sm3_update(hi_void *ctx, const hi_u8 *chunk, hi_u32 chunk_len, hash_c
     hi_s32 ret;
     hi_u32 offset = 0;
     hi_u32 length;
+    hi_u32 buf_size = 0;
 
     hi_log_func_enter();
 
@@ -336,22 +426,25 @@ hi_s32 ext_sm3_update(hi_void *ctx, const hi_u8 *chunk, hi_u32 chunk_len, hash_c
     }
 
     if (src == HASH_CHUNCK_SRC_USER) {
-        ptr = crypto_calloc(HASH_MAX_BUFFER_SIZE);
+        /* small segments don't need the whole bounce buffer */
+        buf_size = crypto_min(chunk_len, HASH_MAX_BUFFER_SIZE);
+        ptr = crypto_calloc(1, buf_size);
         if (ptr == HI_NULL) {
             hi_log_print_func_err(crypto_calloc, HI_ERR_CIPHER_FAILED_MEM);
             return HI_ERR_CIPHER_FAILED_MEM;
         }
 
         while (offset < chunk_len) {
-            length = chunk_len - offset;
-            if (length > HASH_MAX_BUFFER_SIZE) {
-                length = HASH_MAX_BUFFER_SIZE;
-            }
+            length = crypto_min(chunk_len - offset, buf_size);
 
-            crypto_chk_err_goto(crypto_copy_from_user(ptr, HASH_MAX_BUFFER_SIZE, chunk + offset, length));
+            crypto_chk_err_goto(crypto_copy_from_user(ptr, buf_size, chunk + offset, length));
             crypto_chk_err_goto(sm3_update(ctx, ptr, length));
-            crypto_msleep(1);
             offset += length;
+
+            /* only give up the cpu between the slices of a long chunk */
+            if (offset < chunk_len) {
+                crypto_msleep(1);
+            }
         }
     } else {
         if (chunk == HI_NULL) {
@@ -365,6 +458,7 @@ hi_s32 ext_sm3_update(hi_void *ctx, const hi_u8 *chunk, hi_u32 chunk_len, hash_c
 
 exit__:
     if (ptr != HI_NULL) {
+        (hi_void)memset_s(ptr, buf_size, 0, buf_size);
         crypto_free(ptr);
         ptr = HI_NULL;
     }
@@ -403,4 +497,202 @@ hi_s32 ext_sm3_destory(hi_void *ctx)
     hi_log_func_exit();
     return HI_SUCCESS;
 }
+
+static hi_void sm3_lane_init(sm3_lane *lane, const hi_u8 *data, hi_u32 len, hi_u32 prefix_len)
+{
+    hi_u32 full = len - len % SM3_BLOCK_SIZE;
+
+    lane->data = data;
+    lane->data_blocks = len / SM3_BLOCK_SIZE;
+    lane->blocks = lane->data_blocks +
+        sm3_pad(lane->pad, (full < len) ? data + full : HI_NULL, len - full, prefix_len + len);
+}
+
+static const hi_u8 *sm3_lane_block(const sm3_lane *lane, hi_u32 i)
+{
+    if (i < lane->data_blocks) {
+        return lane->data + i * SM3_BLOCK_SIZE;
+    }
+
+    /* a lane done before the others hashes its last block again, the result is dropped */
+    i = crypto_min(i, lane->blocks - 1);
+    return lane->pad + (i - lane->data_blocks) * SM3_BLOCK_SIZE;
+}
+
+/*
+ * Hash up to SM3_LANES jobs together from state iv, after prefix_len bytes
+ * already hashed into iv. The state of each job is left in work->done.
+ * The jobs take as many passes as the longest of them.
+ */
+static hi_void sm3_multi_group(sm3_multi_work *work, const hi_u32 iv[SM3_RESULT_SIZE_IN_WORD],
+    hi_u32 prefix_len, const ext_sm3_job *job, hi_u32 num)
+{
+    const hi_u8 *block[SM3_LANES];
+    hi_u32 passes = 0;
+    hi_u32 i, l;
+
+    for (l = 0; l < SM3_LANES; l++) {
+        /* a missing lane hashes an empty message */
+        if (l < num) {
+            sm3_lane_init(&work->lane[l], job[l].data, job[l].len, prefix_len);
+        } else {
+            sm3_lane_init(&work->lane[l], HI_NULL, 0, prefix_len);
+        }
+        passes = crypto_max(passes, work->lane[l].blocks);
+        (hi_void)memcpy_s(work->state[l], sizeof(work->state[l]), iv, SM3_RESULT_SIZE);
+    }
+
+    for (i = 0; i < passes; i++) {
+        for (l = 0; l < SM3_LANES; l++) {
+            block[l] = sm3_lane_block(&work->lane[l], i);
+        }
+        sm3_compress_x4(work->state, block, work->w);
+        for (l = 0; l < SM3_LANES; l++) {
+            if (i + 1 == work->lane[l].blocks) {
+                (hi_void)memcpy_s(work->done[l], sizeof(work->done[l]), work->state[l], SM3_RESULT_SIZE);
+            }
+        }
+    }
+}
+
+/* the hmac outer hash of the inner hashes in work->done, which it replaces */
+static hi_void sm3_multi_hmac_outer(sm3_multi_work *work, const hi_u32 iv[SM3_RESULT_SIZE_IN_WORD])
+{
+    const hi_u8 *block[SM3_LANES];
+    hi_u8 inner[SM3_RESULT_SIZE];
+    hi_u32 l;
+
+    for (l = 0; l < SM3_LANES; l++) {
+        (hi_void)sm3_digest_out(inner, sizeof(inner), work->done[l]);
+        (hi_void)sm3_pad(work->lane[l].pad, inner, SM3_RESULT_SIZE, SM3_BLOCK_SIZE + SM3_RESULT_SIZE);
+        block[l] = work->lane[l].pad;
+        (hi_void)memcpy_s(work->done[l], sizeof(work->done[l]), iv, SM3_RESULT_SIZE);
+    }
+    sm3_compress_x4(work->done, block, work->w);
+    (hi_void)memset_s(inner, sizeof(inner), 0, sizeof(inner));
+}
+
+static hi_s32 sm3_multi(const hi_u32 iv[SM3_RESULT_SIZE_IN_WORD], hi_u32 prefix_len,
+    const hi_u32 *outer_iv, ext_sm3_job *job, hi_u32 num)
+{
+    hi_s32 ret = HI_SUCCESS;
+    sm3_multi_work *work = HI_NULL;
+    hi_u32 i, l, n;
+
+    for (i = 0; i < num; i++) {
+        hi_log_chk_param_return((job[i].data == HI_NULL) && (job[i].len != 0));
+        hi_log_chk_param_return(job[i].digest == HI_NULL);
+    }
+
+    work = crypto_malloc(sizeof(sm3_multi_work));
+    if (work == HI_NULL) {
+        hi_log_print_func_err(crypto_malloc, HI_ERR_CIPHER_FAILED_MEM);
+        return HI_ERR_CIPHER_FAILED_MEM;
+    }
+
+    for (i = 0; i < num; i += n) {
+        n = crypto_min(num - i, SM3_LANES);
+        sm3_multi_group(work, iv, prefix_len, job + i, n);
+        if (outer_iv != HI_NULL) {
+            sm3_multi_hmac_outer(work, outer_iv);
+        }
+        for (l = 0; l < n; l++) {
+            crypto_chk_err_goto(sm3_digest_out(job[i + l].digest, SM3_RESULT_SIZE, work->done[l]));
+        }
+    }
+
+exit__:
+    (hi_void)memset_s(work, sizeof(sm3_multi_work), 0, sizeof(sm3_multi_work));
+    crypto_free(work);
+    return ret;
+}
+
+hi_s32 ext_sm3_multi(ext_sm3_job *job, hi_u32 num)
+{
+    static const hi_u32 iv[SM3_RESULT_SIZE_IN_WORD] = {
+        SM3_H0, SM3_H1, SM3_H2, SM3_H3, SM3_H4, SM3_H5, SM3_H6, SM3_H7
+    };
+    hi_s32 ret;
+
+    hi_log_func_enter();
+
+    hi_log_chk_param_return(job == HI_NULL);
+
+    ret = sm3_multi(iv, 0, HI_NULL, job, num);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(sm3_multi, ret);
+        return ret;
+    }
+
+    hi_log_func_exit();
+    return HI_SUCCESS;
+}
+
+hi_s32 ext_sm3_hmac_setkey(ext_sm3_hmac_key *hkey, const hi_u8 *key, hi_u32 keylen)
+{
+    hi_s32 ret;
+    hi_u32 i;
+    hi_u8 k0[SM3_BLOCK_SIZE] = {0};
+    hi_u8 pad[SM3_BLOCK_SIZE];
+    ext_sm3_context ctx;
+
+    hi_log_func_enter();
+
+    hi_log_chk_param_return(hkey == HI_NULL);
+    hi_log_chk_param_return((key == HI_NULL) && (keylen != 0));
+
+    /* K0 is the key, or its hash if it is longer than a block, padded with zeros */
+    (hi_void)memset_s(&ctx, sizeof(ctx), 0, sizeof(ctx));
+    if (keylen > SM3_BLOCK_SIZE) {
+        sm3_init(&ctx);
+        crypto_chk_err_goto(sm3_update(&ctx, key, keylen));
+        crypto_chk_err_goto(sm3_final(&ctx, k0, sizeof(k0)));
+    } else if (keylen > 0) {
+        if (memcpy_s(k0, sizeof(k0), key, keylen) != EOK) {
+            hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
+            return HI_ERR_CIPHER_MEMCPY_S_FAILED;
+        }
+    }
+
+    /* the states after K0 ^ ipad and K0 ^ opad, shared by all the messages of the key */
+    sm3_init(&ctx);
+    for (i = 0; i < SM3_BLOCK_SIZE; i++) {
+        pad[i] = k0[i] ^ SM3_HMAC_IPAD_BYTE;
+    }
+    (hi_void)memcpy_s(hkey->ipad_state, sizeof(hkey->ipad_state), ctx.state, sizeof(ctx.state));
+    sm3_compress(hkey->ipad_state, pad, 1);
+    for (i = 0; i < SM3_BLOCK_SIZE; i++) {
+        pad[i] = k0[i] ^ SM3_HMAC_OPAD_BYTE;
+    }
+    (hi_void)memcpy_s(hkey->opad_state, sizeof(hkey->opad_state), ctx.state, sizeof(ctx.state));
+    sm3_compress(hkey->opad_state, pad, 1);
+    ret = HI_SUCCESS;
+
+exit__:
+    (hi_void)memset_s(k0, sizeof(k0), 0, sizeof(k0));
+    (hi_void)memset_s(pad, sizeof(pad), 0, sizeof(pad));
+    (hi_void)memset_s(&ctx, sizeof(ctx), 0, sizeof(ctx));
+
+    hi_log_func_exit();
+    return ret;
+}
+
+hi_s32 ext_sm3_hmac_multi(const ext_sm3_hmac_key *hkey, ext_sm3_job *job, hi_u32 num)
+{
+    hi_s32 ret;
+
+    hi_log_func_enter();
+
+    hi_log_chk_param_return(hkey == HI_NULL);
+    hi_log_chk_param_return(job == HI_NULL);
+
+    ret = sm3_multi(hkey->ipad_state, SM3_BLOCK_SIZE, hkey->opad_state, job, num);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(sm3_multi, ret);
+        return ret;
+    }
+
+    hi_log_func_exit();
+    return HI_SUCCESS;
+}
 #endif
@@ -40,25 +40,6 @@ static const hi_u32 g_ck[] = {
     0x10171e25, 0x2c333a41, 0x484f565d, 0x646b7279
 };
 
-static const hi_u32 g_sbox[16][16] = { /* Two-dimensional array 16, 16. */
-    {0xd6, 0x90, 0xe9, 0xfe, 0xcc, 0xe1, 0x3d, 0xb7, 0x16, 0xb6, 0x14, 0xc2, 0x28, 0xfb, 0x2c, 0x05},
-    {0x2b, 0x67, 0x9a, 0x76, 0x2a, 0xbe, 0x04, 0xc3, 0xaa, 0x44, 0x13, 0x26, 0x49, 0x86, 0x06, 0x99},
-    {0x9c, 0x42, 0x50, 0xf4, 0x91, 0xef, 0x98, 0x7a, 0x33, 0x54, 0x0b, 0x43, 0xed, 0xcf, 0xac, 0x62},
-    {0xe4, 0xb3, 0x1c, 0xa9, 0xc9, 0x08, 0xe8, 0x95, 0x80, 0xdf, 0x94, 0xfa, 0x75, 0x8f, 0x3f, 0xa6},
-    {0x47, 0x07, 0xa7, 0xfc, 0xf3, 0x73, 0x17, 0xba, 0x83, 0x59, 0x3c, 0x19, 0xe6, 0x85, 0x4f, 0xa8},
-    {0x68, 0x6b, 0x81, 0xb2, 0x71, 0x64, 0xda, 0x8b, 0xf8, 0xeb, 0x0f, 0x4b, 0x70, 0x56, 0x9d, 0x35},
-    {0x1e, 0x24, 0x0e, 0x5e, 0x63, 0x58, 0xd1, 0xa2, 0x25, 0x22, 0x7c, 0x3b, 0x01, 0x21, 0x78, 0x87},
-    {0xd4, 0x00, 0x46, 0x57, 0x9f, 0xd3, 0x27, 0x52, 0x4c, 0x36, 0x02, 0xe7, 0xa0, 0xc4, 0xc8, 0x9e},
-    {0xea, 0xbf, 0x8a, 0xd2, 0x40, 0xc7, 0x38, 0xb5, 0xa3, 0xf7, 0xf2, 0xce, 0xf9, 0x61, 0x15, 0xa1},
-    {0xe0, 0xae, 0x5d, 0xa4, 0x9b, 0x34, 0x1a, 0x55, 0xad, 0x93, 0x32, 0x30, 0xf5, 0x8c, 0xb1, 0xe3},
-    {0x1d, 0xf6, 0xe2, 0x2e, 0x82, 0x66, 0xca, 0x60, 0xc0, 0x29, 0x23, 0xab, 0x0d, 0x53, 0x4e, 0x6f},
-    {0xd5, 0xdb, 0x37, 0x45, 0xde, 0xfd, 0x8e, 0x2f, 0x03, 0xff, 0x6a, 0x72, 0x6d, 0x6c, 0x5b, 0x51},
-    {0x8d, 0x1b, 0xaf, 0x92, 0xbb, 0xdd, 0xbc, 0x7f, 0x11, 0xd9, 0x5c, 0x41, 0x1f, 0x10, 0x5a, 0xd8},
-    {0x0a, 0xc1, 0x31, 0x88, 0xa5, 0xcd, 0x7b, 0xbd, 0x2d, 0x74, 0xd0, 0x12, 0xb8, 0xe5, 0xb4, 0xb0},
-    {0x89, 0x69, 0x97, 0x4a, 0x0c, 0x96, 0x77, 0x7e, 0x65, 0xb9, 0xf1, 0x09, 0xc5, 0x6e, 0xc6, 0x84},
-    {0x18, 0xf0, 0x7d, 0xec, 0x3a, 0xdc, 0x4d, 0x20, 0x79, 0xee, 0x5f, 0x3e, 0xd7, 0xcb, 0x39, 0x48}
-};
-
 #define getu32(pt) (((hi_u32)(pt)[0] << 24) ^ ((hi_u32)(pt)[1] << 16) ^ ((hi_u32)(pt)[2] << 8) ^ ((hi_u32)(pt)[3]))
 #define putu32(ct, st)                  \
     do {                                \
@@ -68,210 +49,280 @@ static const hi_u32 g_sbox[16][16] = { /* Two-dimensional array 16, 16. */
         (ct)[3] = (hi_u8)(st);          \
     } while (0)
 
-#define KEY_EXT                     0
-#define CIPHER                      1
+/* rotate left of 32 bits word, 0 < n < 32 */
+#define sm4_rotl(x, n)              (((x) << (n)) | ((x) >> (32 - (n))))
+
 #define SM4_RD_KEY_LEN              32
-#define SM4_RD_KEY_BUF_LEN          36
+#define SM4_WORD_NUM                (SM4_BLOCK_SIZE / WORD_WIDTH)
+#define SM4_SLICE_NUM               BYTE_BITS
+#define GF16_BITS                   4
+
+/*
+ * The cipher is bitsliced, no table is indexed by secret data.
+ * Slice i of a state word holds the bit i of its 4 bytes for several blocks:
+ * bit (4 * b + k) is the byte k (0 is the most significant) of block b, so a
+ * pass computes 8 blocks on 32-bit cpu and 16 blocks on 64-bit cpu.
+ */
+typedef hi_ulong sm4_slice;
+
+#define SM4_PARA_BLOCKS             ((hi_u32)(sizeof(sm4_slice) * BYTE_BITS / WORD_WIDTH))
+#define SM4_PARA_LEN                (SM4_PARA_BLOCKS * SM4_BLOCK_SIZE)
+
+/* lane 0 of all blocks: 0x1111... */
+#define SM4_LANE_ONES               ((sm4_slice)-1 / 0xf)
+
 typedef struct {
-    hi_u32 rd_key[SM4_RD_KEY_BUF_LEN];
+    hi_u32 rd_key[SM4_RD_KEY_LEN];
+    sm4_slice rd_slice[SM4_RD_KEY_LEN][SM4_SLICE_NUM];  /* rd_key in slices, for all blocks of a pass */
 } sm4_key;
 
-typedef union {
-    hi_u32  i; /* descript: i = {c[3], c[2], c[1], c[0]} */
-    hi_u8 c[WORD_WIDTH];
-} is4;
-
 typedef struct {
-    hi_u8  key[SM4_KEY_SIZE];      /* sm4 even round keys, default */
+    sm4_key key;                   /* round keys, expanded once by ext_sm4_setkey */
     hi_u32 klen;                   /* symc key length */
     hi_u8  iv[AES_IV_SIZE];
     symc_mode mode;
 } ext_sm4_context;
 
-/* linearity replace: left shift left, right shift right, max for residual. */
-#define linearity_replace(tmp, left, right, max)     (((tmp) << (left)) + (((tmp) >> (right)) & (max)))
-
-/* Sbox */
-static hi_u32 mix_r(const hi_u32 data_in, const hi_s32 type)
+/* bit i of the 4 bytes of a word, in lane order */
+static inline hi_u32 sm4_word_to_lanes(hi_u32 w, hi_u32 i)
 {
-    is4 temp;
-    hi_u32 rep_rsl;
-    hi_u8  sbox_tmp[WORD_WIDTH] = {0};
-    hi_u8  sbox_c, sbox_r;
-    hi_s32 j;
-
-    for (j = 0; j < WORD_WIDTH; j++) {
-        sbox_tmp[j] = 0;
-        sbox_r = ((data_in << (j * BYTE_BITS)) >> 28);              /* soft sm4 alg: right shift 28 bits. */
-        sbox_c = ((data_in << (j * BYTE_BITS + BYTE_4BIT)) >> 28);  /* soft sm4 alg: right shift 28 bits. */
-        sbox_tmp[j] = g_sbox[sbox_r][sbox_c];
-    }
-    temp.c[WORD_IDX_3] = sbox_tmp[WORD_IDX_0];
-    temp.c[WORD_IDX_2] = sbox_tmp[WORD_IDX_1];
-    temp.c[WORD_IDX_1] = sbox_tmp[WORD_IDX_2];
-    temp.c[WORD_IDX_0] = sbox_tmp[WORD_IDX_3];
-
-    /* linearity replace */
-    if (type == KEY_EXT) {
-        rep_rsl = temp.i  ^ \
-            linearity_replace(temp.i, 13, 19, 0x00001fff) ^ \ /* linearity replace: left shift 13, 19, 0x00001fff. */
-            linearity_replace(temp.i, 23,  9, 0x007fffff);    /* linearity replace: left shift 23,  9, 0x007fffff. */
-    } else {
-        rep_rsl = temp.i ^ \
-            linearity_replace(temp.i,  2, 30, 0x00000003) ^ \ /* linearity replace: left shift  2, 30, 0x00000003. */
-            linearity_replace(temp.i, 10, 22, 0x000003ff) ^ \ /* linearity replace: left shift 10, 22, 0x000003ff. */
-            linearity_replace(temp.i, 18, 14, 0x0003ffff) ^ \ /* linearity replace: left shift 18, 14, 0x0003ffff. */
-            linearity_replace(temp.i, 24,  8, 0x00ffffff);    /* linearity replace: left shift 24,  8, 0x00ffffff. */
-    }
+    hi_u32 m = (w >> i) & 0x01010101;
 
-    return rep_rsl;
+    /* byte 0, 1, 2, 3 from bit 24, 16, 8, 0 to lane 0, 1, 2, 3 */
+    return ((m >> 24) | (m >> 15) | (m >> 6) | (m << 3)) & 0xf;
 }
 
-/* Set key */
-static hi_s32 sm4_set_encrypt_key(const hi_u8 *user_key, const hi_s32 bits, sm4_key *key)
+/* inverse of sm4_word_to_lanes */
+static inline hi_u32 sm4_lanes_to_word(hi_u32 lanes, hi_u32 i)
 {
-    hi_s32 i;
-    hi_u32 k_temp[SM4_KEY_SIZE / WORD_WIDTH] = {0};
-    hi_u32 sm4_key[SM4_RD_KEY_BUF_LEN] = {0};
-    hi_u32 temp;
+    /* lane 0, 1, 2, 3 to byte 0, 1, 2, 3 at bit 24, 16, 8, 0 */
+    return (((lanes & 0x1) << 24) | ((lanes & 0x2) << 15) | ((lanes & 0x4) << 6) | ((lanes & 0x8) >> 3)) << i;
+}
 
-    if (user_key == HI_NULL || key == HI_NULL) {
-        return -1;
-    }
+/* rotate the bytes of each word, lane k takes lane (k + m) % 4, 0 < m < 4 */
+static inline sm4_slice sm4_lane_rot(sm4_slice s, hi_u32 m)
+{
+    sm4_slice lo = ((sm4_slice)0xf >> m) * SM4_LANE_ONES;
 
-    k_temp[WORD_IDX_0] = getu32(user_key);
-    k_temp[WORD_IDX_1] = getu32(user_key + WORD_IDX_1 * WORD_WIDTH);
-    k_temp[WORD_IDX_2] = getu32(user_key + WORD_IDX_2 * WORD_WIDTH);
-    k_temp[WORD_IDX_3] = getu32(user_key + WORD_IDX_3 * WORD_WIDTH);
+    return ((s >> m) & lo) | ((s << (WORD_WIDTH - m)) & ~lo);
+}
 
-    for (i = 0; i < SM4_KEY_SIZE / WORD_WIDTH; i++) {
-        sm4_key[i] = k_temp[i] ^ g_fk[i];
-    }
-    i = 0;
-    for (;;) {
-        temp = sm4_key[i + WORD_IDX_1] ^ sm4_key[i + WORD_IDX_2] ^ sm4_key[i + WORD_IDX_3] ^ g_ck[i];
-        sm4_key[i + WORD_IDX_4] = sm4_key[i] ^ mix_r(temp, KEY_EXT);
-        key->rd_key[i] = sm4_key[i + WORD_IDX_4];
-
-        if (++i == SM4_RD_KEY_LEN) {
-            (hi_void)memset_s(sm4_key, sizeof(sm4_key), 0, SM4_RD_KEY_BUF_LEN);
-            return 0;
-        }
-    }
-    (hi_void)memset_s(sm4_key, sizeof(sm4_key), 0, SM4_RD_KEY_BUF_LEN);
-    return 0;
+/* r = a * b in GF(2^4) with x^4 + x + 1, r may be a or b */
+static inline hi_void sm4_gf16_mul(sm4_slice r[GF16_BITS], const sm4_slice a[GF16_BITS], const sm4_slice b[GF16_BITS])
+{
+    sm4_slice p0, p1, p2, p3, p4, p5, p6;
+
+    p0 = a[0] & b[0];
+    p1 = (a[0] & b[1]) ^ (a[1] & b[0]);
+    p2 = (a[0] & b[2]) ^ (a[1] & b[1]) ^ (a[2] & b[0]);
+    p3 = (a[0] & b[3]) ^ (a[1] & b[2]) ^ (a[2] & b[1]) ^ (a[3] & b[0]);
+    p4 = (a[1] & b[3]) ^ (a[2] & b[2]) ^ (a[3] & b[1]);
+    p5 = (a[2] & b[3]) ^ (a[3] & b[2]);
+    p6 = a[3] & b[3];
+
+    /* x^4 = x + 1 */
+    r[0] = p0 ^ p4;
+    r[1] = p1 ^ p4 ^ p5;
+    r[2] = p2 ^ p5 ^ p6;
+    r[3] = p3 ^ p6;
 }
 
-/* SM4 Encrypt */
-static hi_void sm4_encrypt(const hi_u8 *in, hi_u8 *out, const sm4_key *key, hi_u32 len)
+/* r = a^2 in GF(2^4), r may be a */
+static inline hi_void sm4_gf16_sq(sm4_slice r[GF16_BITS], const sm4_slice a[GF16_BITS])
 {
-    hi_u32 s[SM4_RD_KEY_BUF_LEN] = {0};
-    hi_u32 temp;
-    hi_s32 i;
+    sm4_slice r0 = a[0] ^ a[2];
+    sm4_slice r2 = a[1] ^ a[3];
+
+    r[0] = r0;
+    r[1] = a[2];
+    r[2] = r2;
+    r[3] = a[3];
+}
 
-    crypto_unused(len);
+/*
+ * SM4 Sbox, S(x) = A * (A * x + 0xd3)^-1 + 0xd3 in GF(2^8) with
+ * x^8 + x^7 + x^6 + x^5 + x^4 + x^2 + 1. The inverse is computed in
+ * GF((2^4)^2) with y^2 + y + 9, the linear maps into and out of it are merged
+ * with the affine transforms.
+ */
+static hi_void sm4_sbox(sm4_slice x[SM4_SLICE_NUM])
+{
+    sm4_slice t[SM4_SLICE_NUM];
+    sm4_slice d[GF16_BITS];
+    sm4_slice e[GF16_BITS];
+    sm4_slice f[GF16_BITS];
+    sm4_slice *al = &t[0]; /* t = ah * y + al */
+    sm4_slice *ah = &t[GF16_BITS];
+
+    t[0] = ~(x[4] ^ x[5] ^ x[6] ^ x[7]);
+    t[1] = ~(x[1] ^ x[4] ^ x[5] ^ x[6]);
+    t[2] = ~(x[1] ^ x[2] ^ x[4] ^ x[6] ^ x[7]);
+    t[3] = ~(x[3] ^ x[4]);
+    t[4] = x[0] ^ x[1] ^ x[4] ^ x[7];
+    t[5] = ~x[6];
+    t[6] = x[2] ^ x[6] ^ x[7];
+    t[7] = ~(x[0] ^ x[1] ^ x[2] ^ x[3] ^ x[4] ^ x[5] ^ x[6]);
+
+    /* d = 9 * ah^2 + ah * al + al^2 */
+    sm4_gf16_mul(d, ah, al);
+    d[0] ^= ah[0] ^ al[0] ^ al[2];
+    d[1] ^= ah[1] ^ ah[3] ^ al[2];
+    d[2] ^= ah[3] ^ al[1] ^ al[3];
+    d[3] ^= ah[0] ^ ah[2] ^ al[3];
+
+    /* d^-1 = d^14 */
+    sm4_gf16_sq(e, d);
+    sm4_gf16_mul(f, e, d);
+    sm4_gf16_sq(f, f);
+    sm4_gf16_sq(f, f);
+    sm4_gf16_mul(d, f, e);
+
+    /* t^-1 = (ah * d^-1) * y + (ah + al) * d^-1 */
+    e[0] = ah[0] ^ al[0];
+    e[1] = ah[1] ^ al[1];
+    e[2] = ah[2] ^ al[2];
+    e[3] = ah[3] ^ al[3];
+    sm4_gf16_mul(al, e, d);
+    sm4_gf16_mul(ah, ah, d);
+
+    x[0] = ~(t[0] ^ t[1] ^ t[4] ^ t[5]);
+    x[1] = ~(t[0] ^ t[2] ^ t[5] ^ t[6]);
+    x[2] = t[2] ^ t[4];
+    x[3] = t[0] ^ t[2] ^ t[4] ^ t[5] ^ t[7];
+    x[4] = ~(t[1] ^ t[3] ^ t[7]);
+    x[5] = t[1] ^ t[3] ^ t[5];
+    x[6] = ~(t[0] ^ t[1] ^ t[2]);
+    x[7] = ~(t[0] ^ t[3] ^ t[5]);
+}
 
-    s[WORD_IDX_0] = getu32(in + WORD_IDX_0 * WORD_WIDTH);
-    s[WORD_IDX_1] = getu32(in + WORD_IDX_1 * WORD_WIDTH);
-    s[WORD_IDX_2] = getu32(in + WORD_IDX_2 * WORD_WIDTH);
-    s[WORD_IDX_3] = getu32(in + WORD_IDX_3 * WORD_WIDTH);
+/* L(B) = B ^ (B <<< 2) ^ (B <<< 10) ^ (B <<< 18) ^ (B <<< 24) */
+static hi_void sm4_linear(sm4_slice t[SM4_SLICE_NUM], const sm4_slice b[SM4_SLICE_NUM])
+{
+    hi_u32 i;
+    sm4_slice r;
 
-    for (i = 0; i < SM4_RD_KEY_LEN; i++) {
-        temp = s[i + WORD_IDX_1] ^ s[i + WORD_IDX_2] ^ s[i + WORD_IDX_3] ^ key->rd_key[i];
-        s[i + WORD_IDX_4] = s[i] ^ mix_r(temp, CIPHER);
+    for (i = 0; i < SM4_SLICE_NUM; i++) {
+        /* B <<< 2, the low 2 bits of a byte come from the high 2 bits of the next byte */
+        r = (i >= 2) ? b[i - 2] : sm4_lane_rot(b[i + 6], 1); /* 2, 6: rotate 2 bits */
+
+        /* rotate 8, 16, 24 bits move whole bytes */
+        t[i] = b[i] ^ r ^ sm4_lane_rot(r, 1) ^ sm4_lane_rot(r, 2) ^ sm4_lane_rot(b[i], 3); /* 1, 2, 3: bytes */
     }
-    putu32(out + WORD_IDX_0 * WORD_WIDTH, s[SM4_RD_KEY_LEN + WORD_IDX_3]);
-    putu32(out + WORD_IDX_1 * WORD_WIDTH, s[SM4_RD_KEY_LEN + WORD_IDX_2]);
-    putu32(out + WORD_IDX_2 * WORD_WIDTH, s[SM4_RD_KEY_LEN + WORD_IDX_1]);
-    putu32(out + WORD_IDX_3 * WORD_WIDTH, s[SM4_RD_KEY_LEN + WORD_IDX_0]);
-    (hi_void)memset_s(s, sizeof(s), 0, SM4_RD_KEY_BUF_LEN);
-    return;
 }
 
-/* SM4 Decrypt */
-static hi_void sm4_decrypt(const hi_u8 *in, hi_u8 *out, const sm4_key *key, hi_u32 len)
+/* the S box of the 4 bytes of a word */
+static hi_u32 sm4_tau(hi_u32 a)
 {
-    hi_u32 s[SM4_RD_KEY_BUF_LEN] = {0};
-    hi_u32 temp;
-    hi_s32 i;
+    sm4_slice s[SM4_SLICE_NUM];
+    hi_u32 i;
+    hi_u32 b = 0;
 
-    crypto_unused(len);
+    for (i = 0; i < SM4_SLICE_NUM; i++) {
+        s[i] = sm4_word_to_lanes(a, i);
+    }
 
-    s[WORD_IDX_0] = getu32(in + WORD_IDX_0 * WORD_WIDTH);
-    s[WORD_IDX_1] = getu32(in + WORD_IDX_1 * WORD_WIDTH);
-    s[WORD_IDX_2] = getu32(in + WORD_IDX_2 * WORD_WIDTH);
-    s[WORD_IDX_3] = getu32(in + WORD_IDX_3 * WORD_WIDTH);
+    sm4_sbox(s);
 
-    for (i = 0; i < SM4_RD_KEY_LEN; i++) {
-        temp = s[i + WORD_IDX_1] ^ s[i + WORD_IDX_2] ^ s[i + WORD_IDX_3] ^ \
-            key->rd_key[SM4_RD_KEY_LEN - BOUND_VAL_1 - i];
-        s[i + WORD_IDX_4] = s[i] ^ mix_r(temp, CIPHER);
+    for (i = 0; i < SM4_SLICE_NUM; i++) {
+        b |= sm4_lanes_to_word((hi_u32)s[i] & 0xf, i);
     }
 
-    putu32(out + WORD_IDX_0 * WORD_WIDTH, s[SM4_RD_KEY_LEN + WORD_IDX_3]);
-    putu32(out + WORD_IDX_1 * WORD_WIDTH, s[SM4_RD_KEY_LEN + WORD_IDX_2]);
-    putu32(out + WORD_IDX_2 * WORD_WIDTH, s[SM4_RD_KEY_LEN + WORD_IDX_1]);
-    putu32(out + WORD_IDX_3 * WORD_WIDTH, s[SM4_RD_KEY_LEN + WORD_IDX_0]);
-    (hi_void)memset_s(s, sizeof(s), 0, SM4_RD_KEY_BUF_LEN);
-    return;
+    return b;
 }
 
-/* SM4 ECB Crypt */
-static hi_void sm4_ecb_crypt(const hi_u8 *in, hi_u8 *out, hi_u32 len, const sm4_key *key, const hi_s32 dec)
+/* Set key */
+static hi_void sm4_set_encrypt_key(const hi_u8 *user_key, sm4_key *key)
 {
-    if (dec == SYMC_OPERATION_ENCRYPT) {
-        sm4_encrypt(in, out, key, len);
-    } else {
-        sm4_decrypt(in, out, key, len);
+    hi_u32 k[SM4_WORD_NUM];
+    hi_u32 i, j, t;
+
+    for (i = 0; i < SM4_WORD_NUM; i++) {
+        k[i] = getu32(user_key + i * WORD_WIDTH) ^ g_fk[i];
     }
-    return;
+
+    for (i = 0; i < SM4_RD_KEY_LEN; i++) {
+        t = sm4_tau(k[(i + WORD_IDX_1) % SM4_WORD_NUM] ^ k[(i + WORD_IDX_2) % SM4_WORD_NUM] ^
+            k[(i + WORD_IDX_3) % SM4_WORD_NUM] ^ g_ck[i]);
+        k[i % SM4_WORD_NUM] ^= t ^ sm4_rotl(t, 13) ^ sm4_rotl(t, 23); /* L': rotate 13, 23 */
+        key->rd_key[i] = k[i % SM4_WORD_NUM];
+        for (j = 0; j < SM4_SLICE_NUM; j++) {
+            key->rd_slice[i][j] = sm4_word_to_lanes(key->rd_key[i], j) * SM4_LANE_ONES;
+        }
+    }
+
+    (hi_void)memset_s(k, sizeof(k), 0, sizeof(k));
 }
 
-/* SM4 CBC Crypt */
-static hi_void sm4_cbc_crypt(const hi_u8 *in, hi_u8 *out, const hi_u32 length,
-    const sm4_key *key, hi_u8 *ivec, const hi_s32 dec)
+static hi_void sm4_bitslice(sm4_slice x[SM4_WORD_NUM][SM4_SLICE_NUM], const hi_u8 *in, hi_u32 blocks)
 {
-    hi_u32 n;
-    hi_u32 len = length;
-    hi_u8 tmp[SM4_BLOCK_SIZE] = {0};
+    hi_u32 b, w, i, v;
+
+    (hi_void)memset_s(x, sizeof(sm4_slice) * SM4_WORD_NUM * SM4_SLICE_NUM,
+        0, sizeof(sm4_slice) * SM4_WORD_NUM * SM4_SLICE_NUM);
 
-    if (dec == SYMC_OPERATION_ENCRYPT) {
-        while (len >= SM4_BLOCK_SIZE) {
-            for (n = 0; n < SM4_BLOCK_SIZE; ++n) {
-                tmp[n] = in[n] ^ ivec[n];
+    for (b = 0; b < blocks; b++) {
+        for (w = 0; w < SM4_WORD_NUM; w++) {
+            v = getu32(in + b * SM4_BLOCK_SIZE + w * WORD_WIDTH);
+            for (i = 0; i < SM4_SLICE_NUM; i++) {
+                x[w][i] |= (sm4_slice)sm4_word_to_lanes(v, i) << (b * WORD_WIDTH);
             }
+        }
+    }
+}
 
-            sm4_encrypt(tmp, out, key, SM4_BLOCK_SIZE);
+/* the output is X35, X34, X33, X32, which are in the slot 3, 2, 1, 0 */
+static hi_void sm4_unbitslice(hi_u8 *out, sm4_slice x[SM4_WORD_NUM][SM4_SLICE_NUM], hi_u32 blocks)
+{
+    hi_u32 b, w, i, v;
 
-            if (memcpy_s((hi_void *)ivec, AES_IV_SIZE, out, SM4_BLOCK_SIZE) != EOK) {
-                hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
-                return;
+    for (b = 0; b < blocks; b++) {
+        for (w = 0; w < SM4_WORD_NUM; w++) {
+            v = 0;
+            for (i = 0; i < SM4_SLICE_NUM; i++) {
+                v |= sm4_lanes_to_word((hi_u32)(x[SM4_WORD_NUM - BOUND_VAL_1 - w][i] >> (b * WORD_WIDTH)) & 0xf, i);
             }
-            len -= SM4_BLOCK_SIZE;
-            in  += SM4_BLOCK_SIZE;
-            out += SM4_BLOCK_SIZE;
+            putu32(out + b * SM4_BLOCK_SIZE + w * WORD_WIDTH, v);
         }
-    } else {
-        while (len >= SM4_BLOCK_SIZE) {
-            if (memcpy_s(tmp, sizeof(tmp), in, length) != EOK) {
-                hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
-                return;
-            }
-            sm4_decrypt(tmp, out, key, SM4_BLOCK_SIZE);
-            for (n = 0; n < SM4_BLOCK_SIZE; ++n) {
-                out[n] ^= ivec[n];
+    }
+}
+
+/* SM4 Encrypt or Decrypt of full blocks, in and out may be the same buffer */
+static hi_void sm4_crypt_blocks(const sm4_key *key, hi_u32 decrypt, const hi_u8 *in, hi_u8 *out, hi_u32 blocks)
+{
+    sm4_slice x[SM4_WORD_NUM][SM4_SLICE_NUM];
+    sm4_slice b[SM4_SLICE_NUM];
+    sm4_slice t[SM4_SLICE_NUM];
+    hi_u32 n, r, i;
+    const sm4_slice *rk = HI_NULL;
+
+    while (blocks > 0) {
+        n = crypto_min(blocks, SM4_PARA_BLOCKS);
+        sm4_bitslice(x, in, n);
+
+        /* X(r + 4) = X(r) ^ T(X(r + 1) ^ X(r + 2) ^ X(r + 3) ^ rk(r)) is kept in slot r % 4 */
+        for (r = 0; r < SM4_RD_KEY_LEN; r++) {
+            rk = (decrypt == SYMC_OPERATION_ENCRYPT) ? key->rd_slice[r] :
+                key->rd_slice[SM4_RD_KEY_LEN - BOUND_VAL_1 - r];
+            for (i = 0; i < SM4_SLICE_NUM; i++) {
+                b[i] = x[(r + WORD_IDX_1) % SM4_WORD_NUM][i] ^ x[(r + WORD_IDX_2) % SM4_WORD_NUM][i] ^
+                    x[(r + WORD_IDX_3) % SM4_WORD_NUM][i] ^ rk[i];
             }
-            if (memcpy_s((hi_void *)ivec, SM4_BLOCK_SIZE, tmp, sizeof(tmp)) != EOK) {
-                hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
-                return;
+            sm4_sbox(b);
+            sm4_linear(t, b);
+            for (i = 0; i < SM4_SLICE_NUM; i++) {
+                x[r % SM4_WORD_NUM][i] ^= t[i];
             }
-            len -= SM4_BLOCK_SIZE;
-            in  += SM4_BLOCK_SIZE;
-            out += SM4_BLOCK_SIZE;
         }
+
+        sm4_unbitslice(out, x, n);
+        in += n * SM4_BLOCK_SIZE;
+        out += n * SM4_BLOCK_SIZE;
+        blocks -= n;
     }
 
-    return;
+    (hi_void)memset_s(x, sizeof(x), 0, sizeof(x));
+    (hi_void)memset_s(b, sizeof(b), 0, sizeof(b));
+    (hi_void)memset_s(t, sizeof(t), 0, sizeof(t));
 }
 
 /* increment counter (128bit hi_s32) by 2^64 */
@@ -288,84 +339,113 @@ static hi_void sm4_ctr128_inc(hi_u8 *counter)
     return;
 }
 
-/* SM4 CTR Crypt, CTR mode is big-endian. The rest of SM4 code is endian-neutral */
-static hi_void sm4_ctr128_crypt(const hi_u8 *in, hi_u8 *out, hi_s32 length,
-    const sm4_key *key, hi_u8 counter[SM4_BLOCK_SIZE], hi_u8 ecount_buf[SM4_BLOCK_SIZE], hi_s32 *num)
+/* SM4 ECB RM */
+static hi_s32 sm4_ecb_rm(const hi_u8 *data_in, hi_u8 *data_out, hi_u32 data_len, const sm4_key *key, hi_u32 decrypt)
 {
-    hi_s32 n, l;
-
-    l = length;
-    n = *num;
-    while (l--) {
-        if (n == 0) {
-            sm4_encrypt(counter, ecount_buf, key, SM4_BLOCK_SIZE);
-            sm4_ctr128_inc(counter);
+    sm4_crypt_blocks(key, decrypt, data_in, data_out, data_len / SM4_BLOCK_SIZE);
+
+    return HI_SUCCESS;
+}
+
+static hi_s32 sm4_cbc_encrypt(const hi_u8 *in, hi_u8 *out, hi_u32 blocks, const sm4_key *key, hi_u8 *iv)
+{
+    hi_u32 n;
+    hi_u8 tmp[SM4_BLOCK_SIZE];
+
+    /* each block depends on the previous one, no parallel */
+    for (; blocks > 0; blocks--) {
+        for (n = 0; n < SM4_BLOCK_SIZE; n++) {
+            tmp[n] = in[n] ^ iv[n];
         }
-        *(out++) = *(in++) ^ ecount_buf[n];
-        n = (n + 1) % SM4_BLOCK_SIZE;
+
+        sm4_crypt_blocks(key, SYMC_OPERATION_ENCRYPT, tmp, out, 1);
+
+        if (memcpy_s(iv, AES_IV_SIZE, out, SM4_BLOCK_SIZE) != EOK) {
+            hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
+            return HI_ERR_CIPHER_MEMCPY_S_FAILED;
+        }
+        in  += SM4_BLOCK_SIZE;
+        out += SM4_BLOCK_SIZE;
     }
-    *num = n;
 
-    return;
+    return HI_SUCCESS;
 }
 
-/* SM4 ECB RM */
-static hi_u32 sm4_ecb_rm(const hi_u8 *data_in,
-    hi_u8 *data_out, hi_s32 data_len, const hi_u8 *key, hi_s32 bit, hi_u32 decrypt)
+static hi_s32 sm4_cbc_decrypt(const hi_u8 *in, hi_u8 *out, hi_u32 blocks, const sm4_key *key, hi_u8 *iv)
 {
-    sm4_key ctx;
+    hi_u32 n, i;
+    hi_u8 tmp[SM4_PARA_LEN];
+
+    for (; blocks > 0; blocks -= n) {
+        n = crypto_min(blocks, SM4_PARA_BLOCKS);
+
+        /* keep the cipher text, in and out may be the same buffer */
+        if (memcpy_s(tmp, sizeof(tmp), in, n * SM4_BLOCK_SIZE) != EOK) {
+            hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
+            return HI_ERR_CIPHER_MEMCPY_S_FAILED;
+        }
+
+        sm4_crypt_blocks(key, SYMC_OPERATION_DECRYPT, tmp, out, n);
 
-    sm4_set_encrypt_key(key, bit, &ctx);
+        for (i = 0; i < SM4_BLOCK_SIZE; i++) {
+            out[i] ^= iv[i];
+        }
+        for (i = SM4_BLOCK_SIZE; i < n * SM4_BLOCK_SIZE; i++) {
+            out[i] ^= tmp[i - SM4_BLOCK_SIZE];
+        }
 
-    while (data_len >= SM4_BLOCK_SIZE) {
-        sm4_ecb_crypt(data_in, data_out, SM4_BLOCK_SIZE, &ctx, decrypt);
-        data_len = data_len - SM4_BLOCK_SIZE;
-        data_in  = data_in + SM4_BLOCK_SIZE;
-        data_out = data_out + SM4_BLOCK_SIZE;
+        if (memcpy_s(iv, AES_IV_SIZE, tmp + (n - 1) * SM4_BLOCK_SIZE, SM4_BLOCK_SIZE) != EOK) {
+            hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
+            return HI_ERR_CIPHER_MEMCPY_S_FAILED;
+        }
+        in  += n * SM4_BLOCK_SIZE;
+        out += n * SM4_BLOCK_SIZE;
     }
 
-    return data_len;
+    return HI_SUCCESS;
 }
 
 /* SM4 CBC RM */
-static hi_u32 sm4_cbc_rm(const hi_u8 *data_in, hi_u8 *data_out, hi_s32 data_len,
-    const hi_u8 *key, hi_s32 bit, hi_u32 decrypt, hi_u8 *iv)
+static hi_s32 sm4_cbc_rm(const hi_u8 *data_in, hi_u8 *data_out, hi_u32 data_len,
+    const sm4_key *key, hi_u32 decrypt, hi_u8 *iv)
 {
-    hi_s32 left_len;
-    hi_s32 valid_data_len;
-    sm4_key ctx;
+    if (decrypt == SYMC_OPERATION_ENCRYPT) {
+        return sm4_cbc_encrypt(data_in, data_out, data_len / SM4_BLOCK_SIZE, key, iv);
+    } else {
+        return sm4_cbc_decrypt(data_in, data_out, data_len / SM4_BLOCK_SIZE, key, iv);
+    }
+}
 
-    sm4_set_encrypt_key(key, bit, &ctx);
+/* SM4 CTR RM, CTR mode is big-endian, the counter is increased for each block including the last partial one */
+static hi_s32 sm4_ctr_rm(const hi_u8 *data_in, hi_u8 *data_out, hi_u32 data_len, const sm4_key *key, hi_u8 *iv)
+{
+    hi_u32 n, i, len;
+    hi_u8 ecount[SM4_PARA_LEN];
 
-    left_len = data_len % SM4_BLOCK_SIZE;
-    valid_data_len = data_len - left_len;
-    sm4_cbc_crypt(data_in, data_out, valid_data_len, &ctx, iv, decrypt);
+    while (data_len > 0) {
+        n = crypto_min((data_len + SM4_BLOCK_SIZE - 1) / SM4_BLOCK_SIZE, SM4_PARA_BLOCKS);
+        for (i = 0; i < n; i++) {
+            if (memcpy_s(ecount + i * SM4_BLOCK_SIZE, SM4_BLOCK_SIZE, iv, SM4_BLOCK_SIZE) != EOK) {
+                hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
+                (hi_void)memset_s(ecount, sizeof(ecount), 0, sizeof(ecount));
+                return HI_ERR_CIPHER_MEMCPY_S_FAILED;
+            }
+            sm4_ctr128_inc(iv);
+        }
 
-    return left_len;
-}
+        sm4_crypt_blocks(key, SYMC_OPERATION_ENCRYPT, ecount, ecount, n);
 
-/* SM4 CTR RM */
-static hi_u32 sm4_ctr_rm(const hi_u8 *data_in, hi_u8 *data_out, hi_s32 data_len,
-    const hi_u8 *key, hi_s32 bit, hi_u32 decrypt, const hi_u8 *iv)
-{
-    hi_s32 num = 0;
-    hi_u32 valid_data_len;
-    hi_u8 encrypt_cnt[SM4_BLOCK_SIZE] = {0};
-    sm4_key ctx;
-
-    /* The SM4_ctr128_crypt request:
-     * The extra state information to record how much of the
-     * 128bit block we have used is contained in *num, and the
-     * encrypted counter is kept in ecount_buf. Both *num and
-     * ecount_buf must be initialized with zeros before the first
-     * called to SM4_ctr128_crypt().
-     */
-    valid_data_len = data_len;
-
-    sm4_set_encrypt_key(key, bit, &ctx);
-    sm4_ctr128_crypt(data_in, data_out, valid_data_len, &ctx, (hi_u8 *)iv, encrypt_cnt, &num);
-
-    return 0;
+        len = crypto_min(data_len, n * SM4_BLOCK_SIZE);
+        for (i = 0; i < len; i++) {
+            data_out[i] = data_in[i] ^ ecount[i];
+        }
+        data_in  += len;
+        data_out += len;
+        data_len -= len;
+    }
+
+    (hi_void)memset_s(ecount, sizeof(ecount), 0, sizeof(ecount));
+    return HI_SUCCESS;
 }
 
 hi_void *ext_sm4_create(hi_u32 hard_chn)
@@ -391,6 +471,8 @@ hi_s32 ext_sm4_destory(hi_void *ctx)
     hi_log_func_enter();
 
     if (ctx != HI_NULL) {
+        /* wipe the round keys */
+        (hi_void)memset_s(ctx, sizeof(ext_sm4_context), 0, sizeof(ext_sm4_context));
         crypto_free(ctx);
         ctx = HI_NULL;
     }
@@ -442,7 +524,7 @@ hi_s32 ext_sm4_setiv(hi_void *ctx, const hi_u8 *iv, hi_u32 ivlen, hi_u32 usage)
 
     hi_log_chk_param_return(symc == HI_NULL);
     hi_log_chk_param_return(iv == HI_NULL);
-    hi_log_chk_param_return(ivlen != HI_NULL);
+    hi_log_chk_param_return(ivlen > AES_IV_SIZE);
 
     if (memcpy_s(symc->iv, AES_IV_SIZE, iv, ivlen) != EOK) {
         hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
@@ -496,10 +578,7 @@ hi_s32 ext_sm4_setkey(hi_void *ctx, const hi_u8 *fkey, const hi_u8 *skey, hi_u32
     }
     hi_log_info("key len %u, type %u\n", klen, *hisi_klen);
 
-    if (memcpy_s(symc->key, sizeof(symc->key), fkey, klen) != EOK) {
-        hi_log_print_func_err(memcpy_s, HI_ERR_CIPHER_MEMCPY_S_FAILED);
-        return HI_ERR_CIPHER_MEMCPY_S_FAILED;
-    }
+    sm4_set_encrypt_key(fkey, &symc->key);
     symc->klen = klen;
     *hisi_klen = klen;
 
@@ -511,19 +590,13 @@ static hi_s32 ext_sm4_rm(ext_sm4_context *symc, crypto_mem *mem_in, crypto_mem *
 {
     switch (symc->mode) {
         case SYMC_MODE_ECB: {
-            sm4_ecb_rm(crypto_mem_virt(mem_in), crypto_mem_virt(mem_out),
-                       len, symc->key, symc->klen, operation);
-            break;
+            return sm4_ecb_rm(crypto_mem_virt(mem_in), crypto_mem_virt(mem_out), len, &symc->key, operation);
         }
         case SYMC_MODE_CBC: {
-            sm4_cbc_rm(crypto_mem_virt(mem_in), crypto_mem_virt(mem_out),
-                       len, symc->key, symc->klen, operation, symc->iv);
-            break;
+            return sm4_cbc_rm(crypto_mem_virt(mem_in), crypto_mem_virt(mem_out), len, &symc->key, operation, symc->iv);
         }
         case SYMC_MODE_CTR: {
-            sm4_ctr_rm(crypto_mem_virt(mem_in), crypto_mem_virt(mem_out),
-                       len, symc->key, symc->klen, operation, symc->iv);
-            break;
+            return sm4_ctr_rm(crypto_mem_virt(mem_in), crypto_mem_virt(mem_out), len, &symc->key, symc->iv);
         }
         default: {
             HI_PRINT("Err, Invalid mode 0x%x\n", symc->mode);
@@ -531,8 +604,6 @@ static hi_s32 ext_sm4_rm(ext_sm4_context *symc, crypto_mem *mem_in, crypto_mem *
             return HI_ERR_CIPHER_INVALID_PARAM;
         }
     }
-
-    return HI_SUCCESS;
 }
 
 hi_s32 ext_sm4_crypto(hi_void *ctx, hi_u32 operation, symc_multi_pack *pack, hi_u32 last)
@@ -303,7 +303,46 @@ hi_void *ext_sm3_create(hash_mode mode);
 
 hi_s32 ext_sm3_update(hi_void *ctx, const hi_u8 *chunk, hi_u32 chunk_len, hash_chunk_src src);
 
-hi_s32 ext_sm3_finish(hi_void *ctx,  hi_void *hash, hi_u32 *hashlen);
+hi_s32 ext_sm3_finish(hi_void *ctx, hi_void *hash, hi_u32 hash_buf_len, hi_u32 *hashlen);
 
 hi_s32 ext_sm3_destory(hi_void *ctx);
+
+/* a message of ext_sm3_multi or ext_sm3_hmac_multi, in kernel memory */
+typedef struct {
+    const hi_u8 *data;          /* message */
+    hi_u32 len;                 /* length of message */
+    hi_u8 *digest;              /* SM3_RESULT_SIZE bytes of result */
+} ext_sm3_job;
+
+/* hmac-sm3 key, the states after the first block of the inner and the outer hash */
+typedef struct {
+    hi_u32 ipad_state[SM3_RESULT_SIZE / WORD_WIDTH];
+    hi_u32 opad_state[SM3_RESULT_SIZE / WORD_WIDTH];
+} ext_sm3_hmac_key;
+
+/*
+ * brief          sm3 of several messages, 4 of them are hashed together
+ *
+ * param job      messages and their digests
+ * param num      number of messages
+ */
+hi_s32 ext_sm3_multi(ext_sm3_job *job, hi_u32 num);
+
+/*
+ * brief          hmac-sm3 key schedule, K0 ^ ipad and K0 ^ opad are hashed once for all the messages
+ *
+ * param hkey     hmac-sm3 key to be initialized
+ * param key      hmac key
+ * param keylen   length of hmac key
+ */
+hi_s32 ext_sm3_hmac_setkey(ext_sm3_hmac_key *hkey, const hi_u8 *key, hi_u32 keylen);
+
+/*
+ * brief          hmac-sm3 of several messages under one key, 4 of them are hashed together
+ *
+ * param hkey     hmac-sm3 key from ext_sm3_hmac_setkey
+ * param job      messages and their macs
+ * param num      number of messages
+ */
+hi_s32 ext_sm3_hmac_multi(const ext_sm3_hmac_key *hkey, ext_sm3_job *job, hi_u32 num);
 #endif
@@ -156,6 +156,42 @@ static hi_s32 dispatch_symc_encrypt_multi(hi_void *argp)
     return HI_SUCCESS;
 }
 
+static hi_s32 dispatch_symc_encrypt_multi_async(hi_void *argp)
+{
+    hi_s32 ret;
+    symc_encrypt_multi_t *encrypt_multi = argp;
+
+    hi_log_func_enter();
+
+    hi_log_debug("operation %u\n", encrypt_multi->operation);
+    ret = kapi_symc_crypto_multi_async(encrypt_multi->id,
+        addr_via(encrypt_multi->pack), encrypt_multi->pack_num, encrypt_multi->operation);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(kapi_symc_crypto_multi_async, ret);
+        return ret;
+    }
+
+    hi_log_func_exit();
+    return HI_SUCCESS;
+}
+
+static hi_s32 dispatch_symc_async_done(hi_void *argp)
+{
+    hi_s32 ret;
+    symc_async_done_t *async_done = argp;
+
+    hi_log_func_enter();
+
+    ret = kapi_symc_async_done(async_done->id, &async_done->done, &async_done->result);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(kapi_symc_async_done, ret);
+        return ret;
+    }
+
+    hi_log_func_exit();
+    return HI_SUCCESS;
+}
+
 static hi_s32 dispatch_symc_get_tag(hi_void *argp)
 {
     hi_s32 ret;
@@ -815,6 +851,8 @@ static crypto_dispatch_func g_dispatch_func[CRYPTO_CMD_COUNT] = {
     {"GetSymcConfig", dispatch_symc_get_cfg,        CRYPTO_CMD_SYMC_GET_CONFIG},
     {"KladKey",       dispatch_klad_key,            CRYPTO_CMD_KLAD_KEY},
     {"KladKey",       dispatch_rsa_bn_exp_mod,      CRYPTO_CMD_BN_EXP_MOD},
+    {"EncryptAsync",  dispatch_symc_encrypt_multi_async, CRYPTO_CMD_SYMC_ENCRYPTMULTI_ASYNC},
+    {"AsyncDone",     dispatch_symc_async_done,     CRYPTO_CMD_SYMC_ASYNC_DONE},
 };
 
 hi_s32 crypto_ioctl(hi_u32 cmd, hi_void *argp)
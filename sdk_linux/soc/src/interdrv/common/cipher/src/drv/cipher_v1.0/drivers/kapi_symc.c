@@ -27,6 +27,9 @@
 /* max length of CCM/GCM AAD */
 #define MAX_AEAD_A_LEN                  0x100000
 
+/* user buffers at least this long are pinned instead of copied through MMZ */
+#define SYMC_USER_SG_MIN_LEN            0x1000
+
 typedef struct {
     hi_u32 open   : 1;                  /* open or close */
     hi_u32 config : 1;                  /* already config or not */
@@ -34,6 +37,9 @@ typedef struct {
     void *cryp_ctx;                     /* Context of cryp instance */
     CRYPTO_OWNER owner;                 /* user ID */
     hi_cipher_ctrl  ctrl;               /* control information */
+    hi_void *async_buf;                 /* nodes of the pending async crypto, null if none */
+    hi_u32 async_done;                  /* async crypto finished, set by isr after async_ret */
+    hi_s32 async_ret;                   /* result of async crypto, set by isr */
 } kapi_symc_ctx;
 
 typedef struct {
@@ -50,6 +56,9 @@ static kapi_symc_ctx g_kapi_ctx[CRYPTO_HARD_CHANNEL_MAX];
 /* symc mutex */
 static CRYPTO_MUTEX g_symc_mutex;
 
+/* woken up when an async crypto finished */
+static CRYPTO_QUEUE_HEAD g_symc_async_queue;
+
 #define kapi_symc_lock_err_return()   \
     do { \
         ret = crypto_mutex_lock(&g_symc_mutex);  \
@@ -90,6 +99,40 @@ static hi_s32 kapi_symc_chk_handle(hi_handle handle)
     return HI_SUCCESS;
 }
 
+/* the handle can't be used by other crypto until the pending async crypto is collected */
+static hi_s32 kapi_symc_chk_async_idle(const kapi_symc_ctx *ctx)
+{
+    if (ctx->async_buf != HI_NULL) {
+        hi_log_error("async crypto of the handle is pending\n");
+        hi_log_print_err_code(HI_ERR_CIPHER_BUSY);
+        return HI_ERR_CIPHER_BUSY;
+    }
+
+    return HI_SUCCESS;
+}
+
+/* wait the hardware of the pending async crypto and release its nodes */
+static hi_s32 kapi_symc_async_reap(kapi_symc_ctx *ctx)
+{
+    hi_s32 ret = HI_SUCCESS;
+
+    if (ctx->func->waitdone != HI_NULL) {
+        /* read back the iv and tag, the irq is already raised if async_done is set.
+         * on timeout the isr callback is detached and the channel reset by waitdone,
+         * so the nodes lists in async_buf are no longer referenced when freed.
+         */
+        ret = ctx->func->waitdone(ctx->cryp_ctx, CRYPTO_TIME_OUT);
+        if (ret != HI_SUCCESS) {
+            hi_log_print_func_err(ctx->func->waitdone, ret);
+        }
+    }
+
+    crypto_free(ctx->async_buf);
+    ctx->async_buf = HI_NULL;
+
+    return ret;
+}
+
 hi_s32 kapi_symc_init(void)
 {
     hi_s32 ret;
@@ -99,6 +142,7 @@ hi_s32 kapi_symc_init(void)
     hi_log_func_enter();
 
     crypto_mutex_init(&g_symc_mutex);
+    crypto_queue_init(&g_symc_async_queue);
 
     (hi_void)memset_s(g_kapi_ctx, sizeof(g_kapi_ctx), 0, sizeof(g_kapi_ctx));
 
@@ -217,6 +261,11 @@ hi_s32 kapi_symc_destroy(hi_u32 id)
 
     kapi_symc_lock_err_return();
 
+    /* the nodes of async crypto must be kept until the hardware stopped */
+    if (ctx->async_buf != HI_NULL) {
+        (hi_void)kapi_symc_async_reap(ctx);
+    }
+
     cryp_symc_free_chn(soft_id);
 
     /* Destroy the attached instance of Symmetric cipher engine */
@@ -714,6 +763,12 @@ hi_s32 kapi_symc_cfg(const symc_cfg_t *cfg)
 
     kapi_symc_lock_err_return();
 
+    ret = kapi_symc_chk_async_idle(ctx);
+    if (ret != HI_SUCCESS) {
+        kapi_symc_unlock();
+        return ret;
+    }
+
     /* Destroy the last attached instance of Symmetric cipher engine. */
     if ((ctx->func != HI_NULL) && (ctx->func->destroy != HI_NULL)) {
         (void)ctx->func->destroy(ctx->cryp_ctx);
@@ -826,6 +881,12 @@ hi_s32 kapi_symc_crypto(symc_encrypt_t *crypt)
 
     kapi_symc_lock_err_return();
 
+    ret = kapi_symc_chk_async_idle(ctx);
+    if (ret != HI_SUCCESS) {
+        kapi_symc_unlock();
+        return ret;
+    }
+
     ret = ctx->func->crypto(ctx->cryp_ctx, crypt->operation, &pack, HI_TRUE);
     if (ret != HI_SUCCESS) {
         hi_log_print_func_err(ctx->func->crypto, ret);
@@ -838,11 +899,238 @@ hi_s32 kapi_symc_crypto(symc_encrypt_t *crypt)
     return HI_SUCCESS;
 }
 
+static hi_void kapi_symc_multi_pack_set_mem(symc_multi_pack *pack, const hi_u8 *buf, hi_u32 size)
+{
+    const hi_u8 *tmp = HI_NULL;
+    hi_u32 pack_num = pack->num;
+
+    crypto_unused(size);
+
+    tmp = buf;
+    pack->in = (compat_addr *)tmp;
+
+    tmp = (hi_u8 *)tmp + sizeof(compat_addr) * pack_num;    /* descrypt: buf + input. */
+    pack->out = (compat_addr *)tmp;
+
+    tmp = (hi_u8 *)tmp + sizeof(compat_addr) * pack_num;    /* descrypt: buf + input + output. */
+    pack->usage = (symc_node_usage *)tmp;
+
+    tmp = (hi_u8 *)tmp + sizeof(symc_node_usage) * pack_num;    /* descrypt: buf + input + output + usage. */
+    pack->len = (hi_u32 *)tmp;
+}
+
+static hi_u32 kapi_symc_user_sg_support(const kapi_symc_ctx *ctx, const symc_encrypt_t *crypt)
+{
+    /* short buffers are cheaper to bounce than to pin */
+    if (crypt->len < SYMC_USER_SG_MIN_LEN) {
+        return HI_FALSE;
+    }
+
+    /* only the hardware aes without aad, the nodes split at page boundary must keep block aligned */
+    if ((ctx->func == HI_NULL) || (ctx->config != HI_TRUE) || (ctx->ctrl.alg != HI_CIPHER_ALG_AES) ||
+        (ctx->ctrl.work_mode > HI_CIPHER_WORK_MODE_CTR)) {
+        return HI_FALSE;
+    }
+
+    if (((addr_u64(crypt->in) % AES_BLOCK_SIZE) != 0) || ((addr_u64(crypt->out) % AES_BLOCK_SIZE) != 0)) {
+        return HI_FALSE;
+    }
+
+    return HI_TRUE;
+}
+
+/* split the pinned in/out buffers into nodes, each node is physically contiguous on both sides */
+static hi_void kapi_symc_user_sg_nodes(const crypto_user_pages *in, const crypto_user_pages *out,
+    hi_u32 len, symc_multi_pack *pack)
+{
+    hi_u32 pos, seg_in, seg_out;
+
+    for (pos = 0, pack->num = 0; pos < len; pos += pack->len[pack->num], pack->num++) {
+        seg_in = crypto_user_pages_seg(in, pos, &pack->in[pack->num]);
+        seg_out = crypto_user_pages_seg(out, pos, &pack->out[pack->num]);
+        pack->len[pack->num] = crypto_min(seg_in, seg_out);
+        pack->usage[pack->num] = SYMC_NODE_USAGE_NORMAL;
+
+        hi_log_debug("node %u, in 0x%x, out 0x%x, length 0x%x\n", pack->num, addr_l32(pack->in[pack->num]),
+            addr_l32(pack->out[pack->num]), pack->len[pack->num]);
+    }
+}
+
+static hi_s32 kapi_symc_crypto_user_start(const kapi_symc_ctx *ctx, const symc_encrypt_t *crypt,
+    const crypto_user_pages *in, const crypto_user_pages *out)
+{
+    hi_s32 ret;
+    hi_void *buf = HI_NULL;
+    hi_u32 size, num;
+    symc_multi_pack pack;
+
+    /* each node ends at a page boundary of in or out */
+    num = in->page_num + out->page_num;
+
+    /* size of input:output:usage:length */
+    size = (sizeof(compat_addr) + sizeof(compat_addr) + sizeof(symc_node_usage) + sizeof(hi_u32)) * num;
+    buf = crypto_calloc(1, size);
+    if (buf == HI_NULL) {
+        hi_log_print_func_err(crypto_calloc, HI_ERR_CIPHER_FAILED_MEM);
+        return HI_ERR_CIPHER_FAILED_MEM;
+    }
+
+    (hi_void)memset_s(&pack, sizeof(pack), 0, sizeof(pack));
+    pack.num = num;
+    kapi_symc_multi_pack_set_mem(&pack, buf, size);
+    kapi_symc_user_sg_nodes(in, out, crypt->len, &pack);
+
+    /* write back the input and drop the cached output before the device access them */
+    crypto_user_pages_flush(in);
+    crypto_user_pages_flush(out);
+
+    ret = crypto_mutex_lock(&g_symc_mutex);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(crypto_mutex_lock, ret);
+        crypto_free(buf);
+        return ret;
+    }
+
+    ret = kapi_symc_chk_async_idle(ctx);
+    if (ret == HI_SUCCESS) {
+        ret = ctx->func->crypto(ctx->cryp_ctx, crypt->operation & SYMC_OPERATION_DECRYPT, &pack, HI_TRUE);
+        if (ret != HI_SUCCESS) {
+            hi_log_print_func_err(ctx->func->crypto, ret);
+        }
+    }
+
+    kapi_symc_unlock();
+
+    /* drop the lines speculatively loaded while the device was writing */
+    crypto_user_pages_flush(out);
+
+    crypto_free(buf);
+    buf = HI_NULL;
+
+    return ret;
+}
+
+/* zero copy of user buffers, the pages are pinned and chained into the nodes list */
+static hi_s32 kapi_symc_crypto_user_pages(const kapi_symc_ctx *ctx, const symc_encrypt_t *crypt, hi_u32 *handled)
+{
+    hi_s32 ret;
+    crypto_user_pages in;
+    crypto_user_pages out;
+
+    hi_log_func_enter();
+
+    /* the buffer can't be pinned, e.g. a pfn mapping, bounce copy it instead */
+    ret = crypto_user_pages_pin(&in, addr_via(crypt->in), crypt->len, HI_FALSE);
+    if (ret != HI_SUCCESS) {
+        return HI_SUCCESS;
+    }
+
+    ret = crypto_user_pages_pin(&out, addr_via(crypt->out), crypt->len, HI_TRUE);
+    if (ret != HI_SUCCESS) {
+        crypto_user_pages_unpin(&in);
+        return HI_SUCCESS;
+    }
+
+    /* too scattered for the nodes list */
+    if (in.page_num + out.page_num > MAX_PKG_NUMBER) {
+        crypto_user_pages_unpin(&out);
+        crypto_user_pages_unpin(&in);
+        return HI_SUCCESS;
+    }
+
+    *handled = HI_TRUE;
+    ret = kapi_symc_crypto_user_start(ctx, crypt, &in, &out);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(kapi_symc_crypto_user_start, ret);
+    }
+
+    crypto_user_pages_unpin(&out);
+    crypto_user_pages_unpin(&in);
+
+    hi_log_func_exit();
+    return ret;
+}
+
+/* mmz mapped to user space, the device accesses it by the physical address as a mmz handle */
+static hi_s32 kapi_symc_crypto_user_pfn(const symc_encrypt_t *crypt, const compat_addr *in, const compat_addr *out)
+{
+    hi_s32 ret;
+    symc_encrypt_t local_crypt;
+
+    hi_log_func_enter();
+
+    ret = cipher_check_mmz_phy_addr((hi_phys_addr_t)addr_u64(*in), crypt->len);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(cipher_check_mmz_phy_addr, ret);
+        return ret;
+    }
+
+    ret = cipher_check_mmz_phy_addr((hi_phys_addr_t)addr_u64(*out), crypt->len);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(cipher_check_mmz_phy_addr, ret);
+        return ret;
+    }
+
+    /* the mapping may be cached, write back the input and drop the output lines */
+    if ((crypto_user_pfn_flush(addr_via(crypt->in), crypt->len) != HI_SUCCESS) ||
+        (crypto_user_pfn_flush(addr_via(crypt->out), crypt->len) != HI_SUCCESS)) {
+        hi_log_print_func_err(crypto_user_pfn_flush, HI_ERR_CIPHER_INVALID_ADDR);
+        return HI_ERR_CIPHER_INVALID_ADDR;
+    }
+
+    (hi_void)memset_s(&local_crypt, sizeof(local_crypt), 0, sizeof(local_crypt));
+    local_crypt.id   = crypt->id;
+    local_crypt.in   = *in;
+    local_crypt.out  = *out;
+    local_crypt.len  = crypt->len;
+    local_crypt.last = crypt->last;
+    local_crypt.operation = crypt->operation & SYMC_OPERATION_DECRYPT;
+    ret = kapi_symc_crypto(&local_crypt);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(kapi_symc_crypto, ret);
+        return ret;
+    }
+
+    /* drop the lines speculatively loaded while the device was writing */
+    if (crypto_user_pfn_flush(addr_via(crypt->out), crypt->len) != HI_SUCCESS) {
+        hi_log_print_func_err(crypto_user_pfn_flush, HI_ERR_CIPHER_INVALID_ADDR);
+        return HI_ERR_CIPHER_INVALID_ADDR;
+    }
+
+    hi_log_func_exit();
+    return HI_SUCCESS;
+}
+
+/*
+ * the user buffers without bounce copy, handled is left HI_FALSE
+ * if they fit none of the paths and the caller has to bounce copy.
+ */
+static hi_s32 kapi_symc_crypto_user(const kapi_symc_ctx *ctx, const symc_encrypt_t *crypt, hi_u32 *handled)
+{
+    compat_addr in, out;
+
+    *handled = HI_FALSE;
+
+    if ((crypto_user_pfn_phys(addr_via(crypt->in), crypt->len, HI_FALSE, &in) == HI_SUCCESS) &&
+        (crypto_user_pfn_phys(addr_via(crypt->out), crypt->len, HI_TRUE, &out) == HI_SUCCESS)) {
+        *handled = HI_TRUE;
+        return kapi_symc_crypto_user_pfn(crypt, &in, &out);
+    }
+
+    if (kapi_symc_user_sg_support(ctx, crypt) != HI_TRUE) {
+        return HI_SUCCESS;
+    }
+
+    return kapi_symc_crypto_user_pages(ctx, crypt, handled);
+}
+
 hi_s32 kapi_symc_crypto_via(symc_encrypt_t *crypt, hi_u32 is_from_user)
 {
     hi_s32 ret, ret_exit;
+    hi_u32 handled = HI_FALSE;
     crypto_mem mem = {0};
     symc_encrypt_t local_crypt;
+    kapi_symc_ctx *ctx = HI_NULL;
 
     hi_log_func_enter();
 
@@ -851,6 +1139,22 @@ hi_s32 kapi_symc_crypto_via(symc_encrypt_t *crypt, hi_u32 is_from_user)
     hi_log_chk_param_return(addr_via(crypt->out) == HI_NULL);
     hi_log_chk_param_return(crypt->len == 0x00);
 
+    if (is_from_user == HI_TRUE) {
+        ret = kapi_symc_chk_handle((hi_handle)crypt->id);
+        if (ret != HI_SUCCESS) {
+            hi_log_print_func_err(kapi_symc_chk_handle, ret);
+            return ret;
+        }
+
+        ctx = &g_kapi_ctx[hi_handle_get_chnid(crypt->id)];
+        crypto_chk_owner_err_return(&ctx->owner);
+
+        ret = kapi_symc_crypto_user(ctx, crypt, &handled);
+        if (handled == HI_TRUE) {
+            return ret;
+        }
+    }
+
     (hi_void)memset_s(&local_crypt, sizeof(local_crypt), 0, sizeof(local_crypt));
 
     ret = crypto_mem_create(&mem, SEC_MMZ, "AES_IN", crypt->len);
@@ -940,71 +1244,72 @@ static hi_s32 kapi_symc_chk_multi_pack(hi_cipher_data *tmp, const hi_cipher_data
     return HI_SUCCESS;
 }
 
-static hi_void kapi_symc_multi_pack_set_mem(symc_multi_pack *pack, const hi_u8 *buf, hi_u32 size)
-{
-    const hi_u8 *tmp = HI_NULL;
-    hi_u32 pack_num = pack->num;
-
-    crypto_unused(size);
-
-    tmp = buf;
-    pack->in = (compat_addr *)tmp;
-
-    tmp = (hi_u8 *)tmp + sizeof(compat_addr) * pack_num;    /* descrypt: buf + input. */
-    pack->out = (compat_addr *)tmp;
-
-    tmp = (hi_u8 *)tmp + sizeof(compat_addr) * pack_num;    /* descrypt: buf + input + output. */
-    pack->usage = (symc_node_usage *)tmp;
-
-    tmp = (hi_u8 *)tmp + sizeof(symc_node_usage) * pack_num;    /* descrypt: buf + input + output + usage. */
-    pack->len = (hi_u32 *)tmp;
-}
-
-static hi_s32 kapi_symc_crypto_multi_start(const kapi_symc_ctx *ctx,
-    const hi_cipher_data *pkg, hi_u32 pkg_num, hi_u32 operation, hi_u32 wait)
+/* copy the packages from user into the nodes list, buf must be freed by the caller on success */
+static hi_s32 kapi_symc_multi_pack_create(const hi_cipher_data *pkg, hi_u32 pkg_num,
+    symc_multi_pack *pack, hi_void **buf)
 {
     hi_s32 ret;
-    hi_void *buf = HI_NULL;
     hi_cipher_data pkg_tmp;
     hi_u32 i, size;
-    symc_multi_pack pack;
 
-    hi_log_func_enter();
-
-    hi_log_chk_param_return((ctx == HI_NULL) || (ctx->cryp_ctx == HI_NULL) ||
-        (ctx->func == HI_NULL) || (ctx->func->crypto == HI_NULL));
     hi_log_chk_param_return((pkg == HI_NULL) || (pkg_num > MAX_PKG_NUMBER) || (pkg_num == 0x00));
 
     /* size of input:output:usage:length */
     size = (sizeof(compat_addr) + sizeof(compat_addr) + sizeof(symc_node_usage) + sizeof(hi_u32)) * pkg_num;
-    buf = crypto_calloc(1, size);
-    if (buf == HI_NULL) {
+    *buf = crypto_calloc(1, size);
+    if (*buf == HI_NULL) {
         hi_log_print_func_err(crypto_calloc, HI_ERR_CIPHER_FAILED_MEM);
         return HI_ERR_CIPHER_FAILED_MEM;
     }
 
-    (hi_void)memset_s(&pack, sizeof(pack), 0, sizeof(pack));
+    (hi_void)memset_s(pack, sizeof(symc_multi_pack), 0, sizeof(symc_multi_pack));
 
-    pack.num = pkg_num;
-    kapi_symc_multi_pack_set_mem(&pack, buf, size);
+    pack->num = pkg_num;
+    kapi_symc_multi_pack_set_mem(pack, *buf, size);
 
     /* Compute and check the nodes length. */
     for (i = 0; i < pkg_num; i++) {
         ret = kapi_symc_chk_multi_pack(&pkg_tmp, (hi_cipher_data *)((hi_u8 *)pkg + sizeof(hi_cipher_data) * i));
         if (ret != HI_SUCCESS) {
             hi_log_print_func_err(kapi_symc_chk_multi_pack, ret);
-            crypto_free(buf);
-            buf = HI_NULL;
+            crypto_free(*buf);
+            *buf = HI_NULL;
             return ret;
         }
 
-        addr_u64(pack.in[i]) = pkg_tmp.src_phys_addr;
-        addr_u64(pack.out[i]) = pkg_tmp.dst_phys_addr;
-        pack.len[i] = pkg_tmp.byte_len;
-        pack.usage[i] = SYMC_NODE_USAGE_EVEN_KEY;
+        addr_u64(pack->in[i]) = pkg_tmp.src_phys_addr;
+        addr_u64(pack->out[i]) = pkg_tmp.dst_phys_addr;
+        pack->len[i] = pkg_tmp.byte_len;
+        pack->usage[i] = SYMC_NODE_USAGE_EVEN_KEY;
+
+        hi_log_debug("pkg %u, in 0x%x, out 0x%x, length 0x%x, usage 0x%x\n", i, addr_l32(pack->in[i]),
+            addr_l32(pack->out[i]), pack->len[i], pack->usage[i]);
+    }
+
+    return HI_SUCCESS;
+}
+
+static hi_s32 kapi_symc_crypto_multi_start(const kapi_symc_ctx *ctx,
+    const hi_cipher_data *pkg, hi_u32 pkg_num, hi_u32 operation, hi_u32 wait)
+{
+    hi_s32 ret;
+    hi_void *buf = HI_NULL;
+    symc_multi_pack pack;
+
+    hi_log_func_enter();
+
+    hi_log_chk_param_return((ctx == HI_NULL) || (ctx->cryp_ctx == HI_NULL) ||
+        (ctx->func == HI_NULL) || (ctx->func->crypto == HI_NULL));
 
-        hi_log_debug("pkg %u, in 0x%x, out 0x%x, length 0x%x, usage 0x%x\n", i, addr_l32(pack.in[i]),
-            addr_l32(pack.out[i]), pack.len[i], pack.usage[i]);
+    ret = kapi_symc_chk_async_idle(ctx);
+    if (ret != HI_SUCCESS) {
+        return ret;
+    }
+
+    ret = kapi_symc_multi_pack_create(pkg, pkg_num, &pack, &buf);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(kapi_symc_multi_pack_create, ret);
+        return ret;
     }
 
     ret = ctx->func->crypto(ctx->cryp_ctx, operation, &pack, wait);
@@ -1059,6 +1364,164 @@ hi_s32 kapi_symc_crypto_multi(hi_u32 id, const hi_cipher_data *pkg, hi_u32 pkg_n
     return HI_SUCCESS;
 }
 
+/* called in isr when the async crypto finished */
+static hi_void kapi_symc_async_notify(hi_void *param, hi_s32 result)
+{
+    kapi_symc_ctx *ctx = param;
+
+    ctx->async_ret = result;
+    /* pairs with the acquire in kapi_symc_async_done and kapi_symc_async_poll */
+    crypto_store_release(&ctx->async_done, HI_TRUE);
+
+    crypto_queue_wait_up(&g_symc_async_queue);
+}
+
+static hi_s32 kapi_symc_crypto_async_start(kapi_symc_ctx *ctx,
+    const hi_cipher_data *pkg, hi_u32 pkg_num, hi_u32 operation)
+{
+    hi_s32 ret;
+    hi_void *buf = HI_NULL;
+    symc_multi_pack pack;
+
+    hi_log_func_enter();
+
+    ret = kapi_symc_chk_async_idle(ctx);
+    if (ret != HI_SUCCESS) {
+        return ret;
+    }
+
+    ret = kapi_symc_multi_pack_create(pkg, pkg_num, &pack, &buf);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(kapi_symc_multi_pack_create, ret);
+        return ret;
+    }
+
+    /* the nodes are read by isr, keep them until collected; the start of the channel orders the stores */
+    ctx->async_buf = buf;
+    ctx->async_done = HI_FALSE;
+    ctx->async_ret = HI_SUCCESS;
+
+    ret = ctx->func->crypto_async(ctx->cryp_ctx, operation, &pack, kapi_symc_async_notify, ctx);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(ctx->func->crypto_async, ret);
+        ctx->async_buf = HI_NULL;
+        crypto_free(buf);
+        buf = HI_NULL;
+        return ret;
+    }
+
+    hi_log_func_exit();
+    return HI_SUCCESS;
+}
+
+hi_s32 kapi_symc_crypto_multi_async(hi_u32 id, const hi_cipher_data *pkg, hi_u32 pkg_num, hi_u32 operation)
+{
+    hi_s32 ret;
+    kapi_symc_ctx *ctx = HI_NULL;
+
+    hi_log_func_enter();
+
+    ret = kapi_symc_chk_handle((hi_handle)id);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(kapi_symc_chk_handle, ret);
+        return ret;
+    }
+
+    ctx = &g_kapi_ctx[hi_handle_get_chnid(id)];
+    crypto_chk_owner_err_return(&ctx->owner);
+    hi_log_chk_param_return(ctx->config != HI_TRUE);
+    hi_log_chk_param_return((operation != SYMC_OPERATION_ENCRYPT) && (operation != SYMC_OPERATION_DECRYPT));
+
+    if ((ctx->func == HI_NULL) || (ctx->func->crypto_async == HI_NULL)) {
+        hi_log_error("async crypto is unsupported, alg %d, work_mode %d\n", ctx->ctrl.alg, ctx->ctrl.work_mode);
+        hi_log_print_err_code(HI_ERR_CIPHER_UNSUPPORTED);
+        return HI_ERR_CIPHER_UNSUPPORTED;
+    }
+
+    kapi_symc_lock_err_return();
+
+    ret = kapi_symc_crypto_async_start(ctx, pkg, pkg_num, operation);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(kapi_symc_crypto_async_start, ret);
+        kapi_symc_unlock();
+        return ret;
+    }
+
+    kapi_symc_unlock();
+
+    hi_log_func_exit();
+    return HI_SUCCESS;
+}
+
+hi_s32 kapi_symc_async_done(hi_u32 id, hi_u32 *done, hi_s32 *result)
+{
+    hi_s32 ret;
+    kapi_symc_ctx *ctx = HI_NULL;
+
+    hi_log_func_enter();
+
+    hi_log_chk_param_return(done == HI_NULL);
+    hi_log_chk_param_return(result == HI_NULL);
+
+    ret = kapi_symc_chk_handle((hi_handle)id);
+    if (ret != HI_SUCCESS) {
+        hi_log_print_func_err(kapi_symc_chk_handle, ret);
+        return ret;
+    }
+
+    ctx = &g_kapi_ctx[hi_handle_get_chnid(id)];
+    crypto_chk_owner_err_return(&ctx->owner);
+
+    kapi_symc_lock_err_return();
+
+    if (ctx->async_buf == HI_NULL) {
+        hi_log_error("no async crypto is pending\n");
+        hi_log_print_err_code(HI_ERR_CIPHER_INVALID_PARAM);
+        kapi_symc_unlock();
+        return HI_ERR_CIPHER_INVALID_PARAM;
+    }
+
+    *done = crypto_load_acquire(&ctx->async_done);
+    *result = HI_SUCCESS;
+    if (*done == HI_TRUE) {
+        ret = kapi_symc_async_reap(ctx);
+        *result = (ctx->async_ret != HI_SUCCESS) ? ctx->async_ret : ret;
+    }
+
+    kapi_symc_unlock();
+
+    hi_log_func_exit();
+    return HI_SUCCESS;
+}
+
+hi_u32 kapi_symc_async_poll(hi_void)
+{
+    hi_u32 i;
+    kapi_symc_ctx *ctx = HI_NULL;
+    CRYPTO_OWNER owner;
+
+    crypto_get_owner(&owner);
+
+    for (i = 0; i < CRYPTO_HARD_CHANNEL_MAX; i++) {
+        ctx = &g_kapi_ctx[i];
+        /* without the symc lock, a stale answer only costs the caller one more poll */
+        if ((ctx->open != HI_TRUE) || (crypto_read_once(ctx->async_buf) == HI_NULL) ||
+            (crypto_load_acquire(&ctx->async_done) != HI_TRUE)) {
+            continue;
+        }
+        if (memcmp(&owner, &ctx->owner, sizeof(owner)) == 0) {
+            return HI_TRUE;
+        }
+    }
+
+    return HI_FALSE;
+}
+
+hi_void *kapi_symc_async_queue(hi_void)
+{
+    return &g_symc_async_queue;
+}
+
 hi_s32 kapi_aead_get_tag(hi_u32 id, hi_u32 tag[AEAD_TAG_SIZE_IN_WORD], hi_u32 *taglen)
 {
     hi_s32 ret;
@@ -40,6 +40,7 @@
 #include <linux/miscdevice.h>
 #include <linux/delay.h>
 #include <linux/of_device.h>
+#include <linux/poll.h>
 #include "drv_osal_lib.h"
 #include "drv_symc.h"
 #include "drv_hash.h"
@@ -199,6 +200,18 @@ static long hi_cipher_ioctl(struct file *ffile, unsigned int cmd, unsigned long
     return HI_SUCCESS;
 }
 
+/* readable when an async crypto of the caller is finished and can be collected */
+static unsigned int hi_cipher_poll(struct file *file, struct poll_table_struct *wait)
+{
+    poll_wait(file, (CRYPTO_QUEUE_HEAD *)kapi_symc_async_queue(), wait);
+
+    if (kapi_symc_async_poll() == HI_TRUE) {
+        return POLLIN | POLLRDNORM;
+    }
+
+    return 0;
+}
+
 static hi_s32 hi_cipher_release(struct inode *inode, struct file *file)
 {
     crypto_unused(inode);
@@ -213,6 +226,7 @@ static struct file_operations g_dev_cipher_fops = {
 #ifdef CONFIG_COMPAT
     .compat_ioctl     = hi_cipher_ioctl,
 #endif
+    .poll             = hi_cipher_poll,
     .release          = hi_cipher_release,
 };
 
@@ -18,6 +18,8 @@
 
 #include "drv_osal_lib.h"
 #include <linux/dmapool.h>
+#include <linux/mm.h>
+#include <linux/highmem.h>
 #include <asm/cacheflush.h>
 #include "securec.h"
 
@@ -397,6 +399,212 @@ hi_void *crypto_mem_virt(const crypto_mem *mem)
     return mem->dma_virt;
 }
 
+/*
+ * The device reads and writes the pages while no user mapping is locked, so they are pinned with FOLL_PIN
+ * where the kernel has it, and the mm can tell the DMA pin from a plain page reference.
+ */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5,6,0)
+#define crypto_pin_pages(start, num, flags, pages)  pin_user_pages_fast((start), (num), (flags), (pages))
+#define crypto_unpin_pages(pages, num, dirty)       unpin_user_pages_dirty_lock((pages), (num), (dirty))
+#else
+#define crypto_pin_pages(start, num, flags, pages)  get_user_pages_fast((start), (num), (flags), (pages))
+static hi_void crypto_unpin_pages(struct page **pages, hi_u32 num, hi_u32 dirty)
+{
+    hi_u32 i;
+
+    for (i = 0; i < num; i++) {
+        if (dirty == HI_TRUE) {
+            set_page_dirty_lock(pages[i]);
+        }
+        put_page(pages[i]);
+    }
+}
+#endif
+
+hi_s32 crypto_user_pages_pin(crypto_user_pages *upages, hi_void *buffer, hi_u32 length, hi_u32 write)
+{
+    hi_s32 ret;
+    unsigned long start;
+
+    hi_log_chk_param_return(upages == HI_NULL);
+    hi_log_chk_param_return(buffer == HI_NULL);
+    hi_log_chk_param_return((length == 0) || (length > MAX_COPY_FROM_USER_SIZE));
+
+    (hi_void)memset_s(upages, sizeof(crypto_user_pages), 0, sizeof(crypto_user_pages));
+
+    start = (uintptr_t)buffer & PAGE_MASK;
+    upages->offset = (uintptr_t)buffer & ~PAGE_MASK;
+    upages->length = length;
+    upages->write = write;
+    upages->page_num = (upages->offset + length + PAGE_SIZE - 1) >> PAGE_SHIFT;
+
+    upages->pages = crypto_calloc(upages->page_num, sizeof(struct page *));
+    if (upages->pages == HI_NULL) {
+        hi_log_print_func_err(crypto_calloc, HI_ERR_CIPHER_FAILED_MEM);
+        return HI_ERR_CIPHER_FAILED_MEM;
+    }
+
+    ret = crypto_pin_pages(start, upages->page_num, (write == HI_TRUE) ? FOLL_WRITE : 0,
+        (struct page **)upages->pages);
+    if (ret != (hi_s32)upages->page_num) {
+        hi_log_info("pin user pages failed, %d of %u\n", ret, upages->page_num);
+        if (ret > 0) {
+            crypto_unpin_pages((struct page **)upages->pages, (hi_u32)ret, HI_FALSE);
+        }
+        crypto_free(upages->pages);
+        upages->page_num = 0;
+        return HI_ERR_CIPHER_INVALID_ADDR;
+    }
+
+    return HI_SUCCESS;
+}
+
+hi_void crypto_user_pages_unpin(crypto_user_pages *upages)
+{
+    if ((upages == HI_NULL) || (upages->pages == HI_NULL)) {
+        return;
+    }
+
+    crypto_unpin_pages((struct page **)upages->pages, upages->page_num, upages->write);
+    crypto_free(upages->pages);
+    upages->page_num = 0;
+}
+
+hi_u32 crypto_user_pages_seg(const crypto_user_pages *upages, hi_u32 pos, compat_addr *dma_addr)
+{
+    hi_u32 idx, len;
+    hi_phys_addr_t phy;
+
+    if (pos >= upages->length) {
+        return 0;
+    }
+
+    /* position in the pinned pages */
+    pos += upages->offset;
+    idx = pos >> PAGE_SHIFT;
+    phy = page_to_phys((struct page *)upages->pages[idx]) + (pos & ~PAGE_MASK);
+    len = PAGE_SIZE - (pos & ~PAGE_MASK);
+
+    /* merge the following pages while they are physically contiguous */
+    for (idx++; idx < upages->page_num; idx++) {
+        if (page_to_phys((struct page *)upages->pages[idx]) != phy + len) {
+            break;
+        }
+        len += PAGE_SIZE;
+    }
+
+    addr_u64(*dma_addr) = phy;
+
+    return crypto_min(len, upages->offset + upages->length - pos);
+}
+
+hi_void crypto_user_pages_flush(const crypto_user_pages *upages)
+{
+    hi_u32 i, offset, len;
+    hi_u32 left = upages->length;
+    hi_void *virt = HI_NULL;
+
+    offset = upages->offset;
+    for (i = 0; (i < upages->page_num) && (left > 0); i++) {
+        len = crypto_min(left, PAGE_SIZE - offset);
+        virt = kmap((struct page *)upages->pages[i]);
+        CRYPTO_FLUSH_DCACHE_AREA((hi_u8 *)virt + offset, len);
+        kunmap((struct page *)upages->pages[i]);
+        left -= len;
+        offset = 0;
+    }
+}
+
+static hi_void crypto_mmap_read_lock(struct mm_struct *mm)
+{
+#if LINUX_VERSION_CODE > KERNEL_VERSION(5,10,0)
+    down_read(&mm->mmap_lock);
+#else
+    down_read(&mm->mmap_sem);
+#endif
+}
+
+static hi_void crypto_mmap_read_unlock(struct mm_struct *mm)
+{
+#if LINUX_VERSION_CODE > KERNEL_VERSION(5,10,0)
+    up_read(&mm->mmap_lock);
+#else
+    up_read(&mm->mmap_sem);
+#endif
+}
+
+/* the pfn mapping of current process that covers the whole buffer, mmap lock must be held */
+static struct vm_area_struct *crypto_user_pfn_vma(unsigned long start, hi_u32 length, hi_u32 write)
+{
+    struct vm_area_struct *vma = HI_NULL;
+
+    vma = find_vma(current->mm, start);
+    if ((vma == HI_NULL) || (vma->vm_start > start) || (vma->vm_end - start < length)) {
+        return HI_NULL;
+    }
+
+    if (((vma->vm_flags & VM_PFNMAP) == 0) || ((vma->vm_flags & VM_READ) == 0) ||
+        ((write == HI_TRUE) && ((vma->vm_flags & VM_WRITE) == 0))) {
+        return HI_NULL;
+    }
+
+    return vma;
+}
+
+hi_s32 crypto_user_pfn_phys(hi_void *buffer, hi_u32 length, hi_u32 write, compat_addr *dma_addr)
+{
+    hi_s32 ret = HI_ERR_CIPHER_INVALID_ADDR;
+    unsigned long start = (uintptr_t)buffer;
+    unsigned long addr, pfn, first_pfn;
+    struct vm_area_struct *vma = HI_NULL;
+
+    hi_log_chk_param_return(buffer == HI_NULL);
+    hi_log_chk_param_return(dma_addr == HI_NULL);
+    hi_log_chk_param_return((length == 0) || (length > MAX_COPY_FROM_USER_SIZE));
+
+    crypto_mmap_read_lock(current->mm);
+
+    vma = crypto_user_pfn_vma(start, length, write);
+    if (vma == HI_NULL) {
+        goto exit__;
+    }
+
+    if (follow_pfn(vma, start & PAGE_MASK, &first_pfn) != 0) {
+        goto exit__;
+    }
+
+    /* the device accesses the buffer by one physical address, so it must be contiguous */
+    for (addr = (start & PAGE_MASK) + PAGE_SIZE; addr < start + length; addr += PAGE_SIZE) {
+        if ((follow_pfn(vma, addr, &pfn) != 0) ||
+            (pfn != first_pfn + ((addr - (start & PAGE_MASK)) >> PAGE_SHIFT))) {
+            goto exit__;
+        }
+    }
+
+    addr_u64(*dma_addr) = ((hi_phys_addr_t)first_pfn << PAGE_SHIFT) + (start & ~PAGE_MASK);
+    ret = HI_SUCCESS;
+
+exit__:
+    crypto_mmap_read_unlock(current->mm);
+    return ret;
+}
+
+hi_s32 crypto_user_pfn_flush(hi_void *buffer, hi_u32 length)
+{
+    hi_s32 ret = HI_ERR_CIPHER_INVALID_ADDR;
+
+    crypto_mmap_read_lock(current->mm);
+
+    /* the mapping may be gone meanwhile, only flush it while it is still there */
+    if (crypto_user_pfn_vma((uintptr_t)buffer, length, HI_FALSE) != HI_NULL) {
+        CRYPTO_FLUSH_DCACHE_AREA(buffer, length);
+        ret = HI_SUCCESS;
+    }
+
+    crypto_mmap_read_unlock(current->mm);
+    return ret;
+}
+
 hi_s32 crypto_copy_from_user(hi_void *to, unsigned long to_len,
     const hi_void *from, unsigned long from_len)
 {
@@ -87,6 +87,15 @@ typedef struct {
     hi_void *user_buf;         /* buffer of user */
 } crypto_mem;
 
+/* struct of user pages pinned for dma. */
+typedef struct {
+    hi_void **pages;           /* pinned pages of the user buffer */
+    hi_u32 page_num;           /* number of pinned pages */
+    hi_u32 offset;             /* offset of the user buffer in the first page */
+    hi_u32 length;             /* length of the user buffer */
+    hi_u32 write;              /* the device writes to the pages or not */
+} crypto_user_pages;
+
 /* -------------------------------------------------------------------------------------------------------------
  * Definition of basic data types. The data types are applicable to both the application layer and kernel codes.
  * -------------------------------------------------------------------------------------------------------------
@@ -219,6 +228,57 @@ hi_s32 crypto_mem_phys(crypto_mem *mem, compat_addr *dma_addr);
  */
 hi_void *crypto_mem_virt(const crypto_mem *mem);
 
+/*
+ * \brief  pin the pages of a user buffer, so the device can access it without bounce copy.
+ * \param[out] upages The struct of crypto_user_pages.
+ * \param[in] buffer The user's buffer.
+ * \param[in] length The length of user's buffer.
+ * \param[in] write The device writes to the buffer or not.
+ * \return         HI_SUCCESS if successful, or HI_FAILURE.
+ */
+hi_s32 crypto_user_pages_pin(crypto_user_pages *upages, hi_void *buffer, hi_u32 length, hi_u32 write);
+
+/*
+ * \brief  unpin the pages of a user buffer, the pages written by device are marked dirty.
+ * \param[in] upages The struct of crypto_user_pages.
+ * \return         NA.
+ */
+hi_void crypto_user_pages_unpin(crypto_user_pages *upages);
+
+/*
+ * \brief  get the physically contiguous segment of the pinned buffer at position pos.
+ * \param[in] upages The struct of crypto_user_pages.
+ * \param[in] pos The position within the user's buffer.
+ * \param[out] dma_addr The dma address of the segment.
+ * \return         the length of the segment, zero if pos is out of the buffer.
+ */
+hi_u32 crypto_user_pages_seg(const crypto_user_pages *upages, hi_u32 pos, compat_addr *dma_addr);
+
+/*
+ * \brief  flush the cpu cache of the pinned buffer, before and after the device access it.
+ * \param[in] upages The struct of crypto_user_pages.
+ * \return         NA.
+ */
+hi_void crypto_user_pages_flush(const crypto_user_pages *upages);
+
+/*
+ * \brief  get the physical address of a user buffer mapped by pfn, e.g. mmz mapped by remap_pfn_range.
+ * \param[in] buffer The user's buffer.
+ * \param[in] length The length of user's buffer.
+ * \param[in] write The device writes to the buffer or not.
+ * \param[out] dma_addr The physical address of the buffer.
+ * \return         HI_SUCCESS if the buffer is one physically contiguous pfn mapping, or HI_FAILURE.
+ */
+hi_s32 crypto_user_pfn_phys(hi_void *buffer, hi_u32 length, hi_u32 write, compat_addr *dma_addr);
+
+/*
+ * \brief  flush the cpu cache of a user buffer mapped by pfn, before and after the device access it.
+ * \param[in] buffer The user's buffer.
+ * \param[in] length The length of user's buffer.
+ * \return         HI_SUCCESS if successful, or HI_FAILURE if the mapping is gone.
+ */
+hi_s32 crypto_user_pfn_flush(hi_void *buffer, hi_u32 length);
+
 /*
  * \brief  check whether cpu is secure or not.
  * \retval secure cpu, true is returned otherwise false is returned.
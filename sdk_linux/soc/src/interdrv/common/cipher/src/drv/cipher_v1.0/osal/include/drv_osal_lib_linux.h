@@ -32,6 +32,7 @@
 #include <linux/sched.h>
 #include <linux/interrupt.h>
 #include <asm/atomic.h>
+#include <asm/barrier.h>
 #include <asm/cacheflush.h>
 #include <asm/io.h>
 #include <asm/uaccess.h>
@@ -80,6 +81,11 @@ hi_s32 crypto_copy_from_user(hi_void *to, unsigned long to_len,
 hi_s32 crypto_copy_to_user(hi_void *to, unsigned long to_len,
     const hi_void *from, unsigned long from_len);
 
+/* publish a flag written in isr after the data it guards, and read it before that data */
+#define crypto_store_release(p, v)  smp_store_release(p, v)
+#define crypto_load_acquire(p)      smp_load_acquire(p)
+#define crypto_read_once(x)         READ_ONCE(x)
+
 #define CRYPTO_QUEUE_HEAD       wait_queue_head_t
 #define crypto_queue_init(x)    init_waitqueue_head(x)
 #define crypto_queue_wait_up(x) wake_up_interruptible(x)
@@ -101,6 +107,8 @@ hi_s32 crypto_copy_to_user(hi_void *to, unsigned long to_len,
 #define crypto_free_irq(irq, name)          \
     free_irq(irq, (hi_void *)(name))
 
+#define crypto_synchronize_irq(irq)         synchronize_irq(irq)
+
 #define CRYPTO_MUTEX                         struct semaphore
 #define crypto_mutex_init(x)                 sema_init(x, 1)
 #define crypto_mutex_lock(x)                 down_interruptible(x)
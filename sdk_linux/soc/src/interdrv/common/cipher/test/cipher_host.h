@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host stand-in of drv_osal_lib_linux.h for the host builds of the cipher
+ * driver. A harness includes it before the driver sources, so that the Linux
+ * header is skipped by its include guard and the driver runs on libc. The
+ * macros keep the names and semantics of the Linux ones; crypto_malloc and
+ * crypto_free go to calloc and free, so ASan sees every driver buffer.
+ */
+
+#ifndef __CIPHER_HOST_H__
+#define __CIPHER_HOST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define __DRV_OSAL_LIB_LINUX_H__
+#define _OSAL_MMZ_H
+
+#include "hi_types.h"
+#include "hi_debug.h"
+#include "drv_osal_chip.h"
+#include "drv_cipher_kapi.h"
+
+typedef struct hil_media_memory_block hil_mmb_t;
+typedef unsigned long long phys_addr_t;
+int hil_map_mmz_check_phys(unsigned long addr_start, unsigned long addr_len);
+
+#define crypto_ioremap_nocache(addr, size)  ((hi_void *)(uintptr_t)(addr))
+#define crypto_iounmap(addr, size)
+
+#define crypto_read(addr)       (*(volatile hi_u32 *)(addr))
+#define crypto_write(addr, val) (*(volatile hi_u32 *)(addr) = (val))
+
+#define crypto_msleep(msec)     usleep((msec) * 1000)
+#define crypto_udelay(usec)     usleep(usec)
+
+#define MAX_MALLOC_BUF_SIZE     0x10000
+hi_void *crypto_calloc(size_t n, size_t size);
+#define crypto_malloc(x)        ((x) > 0 ? calloc(1, (x)) : HI_NULL)
+#define crypto_free(x)        \
+    do {                      \
+        if ((x) != HI_NULL) { \
+            free((x));        \
+            x = HI_NULL;      \
+        }                     \
+    } while (0)
+
+#define MAX_COPY_FROM_USER_SIZE    0x20000000
+
+hi_s32 crypto_copy_from_user(hi_void *to, unsigned long to_len,
+    const hi_void *from, unsigned long from_len);
+
+hi_s32 crypto_copy_to_user(hi_void *to, unsigned long to_len,
+    const hi_void *from, unsigned long from_len);
+
+#define crypto_store_release(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define crypto_load_acquire(p)      __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define crypto_read_once(x)         (*(volatile __typeof__(x) *)&(x))
+
+/* a harness that waits implements the queue, the others only count wake ups, maybe from another thread */
+#define CRYPTO_QUEUE_HEAD       hi_u32
+#define crypto_queue_init(x)    (*(x) = 0)
+#define crypto_queue_wait_up(x) __atomic_add_fetch((x), 1, __ATOMIC_RELAXED)
+#define crypto_queue_wait_timeout(head, con, time) (*(con) ? 1 : 0)
+
+#define crypto_request_irq(irq, func, name) 0
+#define crypto_free_irq(irq, name)
+#define crypto_synchronize_irq(irq)
+
+#define CRYPTO_MUTEX                         hi_u32
+#define crypto_mutex_init(x)                 (*(x) = 0)
+#define crypto_mutex_lock(x)                 ((*(x))++, 0)
+#define crypto_mutex_unlock(x)               ((*(x))--)
+#define crypto_mutex_destroy(x)
+
+#define CRYPTO_OWNER                         hi_s32
+#define crypto_get_owner(x)                  (*(x) = 1)
+
+#define CRYPTO_IRQRETURN_T                   hi_s32
+#define IRQ_HANDLED                          1
+#define IRQ_NONE                             0
+
+#define hi_log_fatal(fmt...) \
+    do { \
+        printf("[FATAL-HI_CIPHER]:%s[%d]:", __FUNCTION__, __LINE__); \
+        printf(fmt); \
+    } while (0)
+#define hi_log_error(fmt...) \
+    do { \
+        if (g_cipher_host_log) { \
+            printf("[ERROR-HI_CIPHER]:%s[%d]:", __FUNCTION__, __LINE__); \
+            printf(fmt); \
+        } \
+    } while (0)
+
+#define hi_log_warn(fmt...)
+#define hi_log_info(fmt...)
+#define hi_log_debug(fmt...)
+
+#define CRYPTO_PROC_PRINT               fprintf
+
+/* errors are expected by the negative checks of a harness, it silences them */
+static hi_bool g_cipher_host_log = HI_TRUE;
+
+#endif /* __CIPHER_HOST_H__ */
@@ -0,0 +1,415 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host simulation of the hash chunk pipeline of cryp_hash.c.
+ *
+ * The real cryp_hash.c runs against a mock hash engine that computes SHA-256
+ * on the DMA buffer it is started on. A virtual clock advances on the copies
+ * from user space (crypto_copy_from_user), the register setup of a start and
+ * the engine digest, so the copy of a chunk overlaps the digest of the last
+ * one exactly as far as the driver lets it. It checks that:
+ *  - the digests match the FIPS 180-2 vectors, with the message split in random
+ *    update sizes across the ping-pong buffers;
+ *  - no chunk is copied into the buffer the engine is reading, the engine is
+ *    never configured or started while busy, and every start is block aligned;
+ *  - a failed copy still waits for the running chunk before returning;
+ *  - the pipeline is never slower than the same work done one chunk at a time.
+ * It then reports MB/s per message size for a few copy/engine speed ratios,
+ * next to the one chunk at a time time of the same work. The costs are a model
+ * (MODEL_*), not measures.
+ */
+
+#include "cipher_host.h"
+#include "../src/drv/cipher_v1.0/drivers/crypto/cryp_hash.c"
+
+#define tool_check(cond, name) \
+    do { \
+        if (cond) { \
+            printf("ok   %s\n", name); \
+        } else { \
+            printf("FAIL %s\n", name); \
+            g_fail++; \
+        } \
+    } while (0)
+
+static hi_u32 g_fail = 0;
+
+/* register writes of drv_hash_cfg and drv_hash_start, in ps */
+#define MODEL_START_PS      2000000ULL
+/* from the engine interrupt to the waiter running again, in ps */
+#define MODEL_WAKE_PS       10000000ULL
+#define MODEL_PS_PER_S      1000000000000ULL
+
+typedef struct {
+    const char *name;
+    hi_u64 copy_ps;   /* copy_from_user cost, ps per byte */
+    hi_u64 engine_ps; /* engine digest cost, ps per byte */
+} model;
+
+static const model g_models[] = {
+    { "copy 1GB/s, engine 400MB/s", 1000, 2500 },
+    { "copy 1GB/s, engine 1GB/s",   1000, 1000 },
+    { "copy 400MB/s, engine 1GB/s", 2500, 1000 },
+};
+
+typedef struct {
+    const model *model;
+    hi_u64 now;           /* virtual time of the cpu, ps */
+    hi_u64 done;          /* virtual time the running chunk is done, ps */
+    hi_u32 busy;
+    const hi_u8 *buf;     /* the dma buffer the engine reads */
+    hi_u32 size;
+    hi_u32 state[HASH_RESULT_MAX_SIZE_IN_WORD];
+    /* the same work one chunk at a time */
+    hi_u64 copy_total;
+    hi_u64 engine_total;
+    hi_u32 starts;
+    /* failures */
+    hi_u32 bad_overlap;
+    hi_u32 bad_busy;
+    hi_u32 bad_align;
+    hi_u32 bad_wait;
+    /* a copy_from_user fails when it reaches zero */
+    hi_u32 copy_fail_in;
+} mock_engine;
+
+static mock_engine g_mock;
+static crypto_mem g_mock_mem;
+
+/* ************************* sha-256 of the mock engine ************************* */
+static const hi_u32 g_sha256_k[64] = { /* 64: rounds */
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ror32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static hi_u32 load_be32(const hi_u8 *p)
+{
+    return ((hi_u32)p[0] << 24) | ((hi_u32)p[1] << 16) | ((hi_u32)p[2] << 8) | p[3];
+}
+
+static hi_void sha256_block(hi_u32 h[8], const hi_u8 *blk)
+{
+    hi_u32 w[64];
+    hi_u32 v[8];
+    hi_u32 i, t1, t2;
+
+    for (i = 0; i < 16; i++) {
+        w[i] = load_be32(blk + i * 4);
+    }
+    for (i = 16; i < 64; i++) {
+        w[i] = w[i - 16] + (ror32(w[i - 15], 7) ^ ror32(w[i - 15], 18) ^ (w[i - 15] >> 3)) + w[i - 7] +
+            (ror32(w[i - 2], 17) ^ ror32(w[i - 2], 19) ^ (w[i - 2] >> 10));
+    }
+    (hi_void)memcpy(v, h, sizeof(v));
+    for (i = 0; i < 64; i++) {
+        t1 = v[7] + (ror32(v[4], 6) ^ ror32(v[4], 11) ^ ror32(v[4], 25)) + ((v[4] & v[5]) ^ (~v[4] & v[6])) +
+            g_sha256_k[i] + w[i];
+        t2 = (ror32(v[0], 2) ^ ror32(v[0], 13) ^ ror32(v[0], 22)) + ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+        (hi_void)memmove(&v[1], &v[0], 7 * sizeof(hi_u32));
+        v[4] += t1;
+        v[0] = t1 + t2;
+    }
+    for (i = 0; i < 8; i++) {
+        h[i] += v[i];
+    }
+}
+
+/* ************************* mock hash engine ************************* */
+hi_s32 drv_hash_init(hi_void)
+{
+    return HI_SUCCESS;
+}
+
+hi_s32 drv_hash_deinit(hi_void)
+{
+    return HI_SUCCESS;
+}
+
+hi_void drv_hash_get_capacity(hash_capacity *capacity)
+{
+    capacity->sha256 = 1;
+}
+
+hi_void drv_hash_reset(hi_u32 chn_num)
+{
+}
+
+hi_s32 drv_hash_cfg(hi_u32 chn_num, hash_mode mode, const hi_u32 *state)
+{
+    g_mock.bad_busy += g_mock.busy;
+    (hi_void)memcpy(g_mock.state, state, sizeof(g_mock.state));
+    return HI_SUCCESS;
+}
+
+hi_s32 drv_hash_start(hi_u32 chn_num, const crypto_mem *mem, hi_u32 buf_size)
+{
+    g_mock.bad_busy += g_mock.busy;
+    g_mock.bad_align += (buf_size % HASH_BLOCK_SIZE_64) != 0;
+    g_mock.now += MODEL_START_PS;
+    g_mock.done = g_mock.now + buf_size * g_mock.model->engine_ps;
+    g_mock.buf = crypto_mem_virt(mem);
+    g_mock.size = buf_size;
+    g_mock.busy = HI_TRUE;
+    g_mock.engine_total += buf_size * g_mock.model->engine_ps;
+    g_mock.starts++;
+    return HI_SUCCESS;
+}
+
+hi_s32 drv_hash_wait_done(hi_u32 chn_num, hi_u32 *state)
+{
+    hi_u32 h[8]; /* 8: sha-256 state words */
+    hi_u32 i;
+
+    if (!g_mock.busy) {
+        g_mock.bad_wait++;
+        return HI_FAILURE;
+    }
+    /* the state words hold the digest bytes in order, as the registers return them */
+    for (i = 0; i < 8; i++) {
+        h[i] = load_be32((const hi_u8 *)&g_mock.state[i]);
+    }
+    for (i = 0; i < g_mock.size; i += HASH_BLOCK_SIZE_64) {
+        sha256_block(h, g_mock.buf + i);
+    }
+    for (i = 0; i < 8; i++) {
+        state[i] = crypto_cpu_to_be32(h[i]);
+    }
+    g_mock.now = ((g_mock.now > g_mock.done) ? g_mock.now : g_mock.done) + MODEL_WAKE_PS;
+    g_mock.busy = HI_FALSE;
+    return HI_SUCCESS;
+}
+
+hi_s32 hash_mem_create(crypto_mem *mem, hi_u32 type, const char *name, hi_u32 size)
+{
+    (hi_void)memset_s(mem, sizeof(crypto_mem), 0, sizeof(crypto_mem));
+    mem->dma_virt = calloc(1, size);
+    if (mem->dma_virt == HI_NULL) {
+        return HI_FAILURE;
+    }
+    mem->dma_size = size;
+    g_mock_mem = *mem;
+    return HI_SUCCESS;
+}
+
+hi_s32 hash_mem_destroy(crypto_mem *mem)
+{
+    free(mem->dma_virt);
+    mem->dma_virt = HI_NULL;
+    return HI_SUCCESS;
+}
+
+hi_void *crypto_mem_virt(const crypto_mem *mem)
+{
+    return mem->dma_virt;
+}
+
+hi_void *crypto_calloc(size_t n, size_t size)
+{
+    return calloc(n, size);
+}
+
+hi_s32 crypto_copy_from_user(hi_void *to, unsigned long to_len, const hi_void *from, unsigned long from_len)
+{
+    const hi_u8 *dst = to;
+
+    if (g_mock.busy && (dst < g_mock.buf + g_mock.size) && (dst + from_len > g_mock.buf)) {
+        g_mock.bad_overlap++;
+    }
+    if ((g_mock.copy_fail_in != 0) && (--g_mock.copy_fail_in == 0)) {
+        return HI_FAILURE;
+    }
+    g_mock.now += from_len * g_mock.model->copy_ps;
+    g_mock.copy_total += from_len * g_mock.model->copy_ps;
+    return memcpy_s(to, to_len, from, from_len) == EOK ? HI_SUCCESS : HI_FAILURE;
+}
+
+hi_s32 crypto_copy_to_user(hi_void *to, unsigned long to_len, const hi_void *from, unsigned long from_len)
+{
+    return memcpy_s(to, to_len, from, from_len) == EOK ? HI_SUCCESS : HI_FAILURE;
+}
+
+/* ************************* tests ************************* */
+static hi_void mock_reset(const model *m)
+{
+    hi_u32 copy_fail_in = g_mock.copy_fail_in;
+
+    (hi_void)memset_s(&g_mock, sizeof(g_mock), 0, sizeof(g_mock));
+    g_mock.model = m;
+    g_mock.copy_fail_in = copy_fail_in;
+}
+
+/* the one chunk at a time time of the work the mock saw */
+static hi_u64 mock_serial_time(hi_void)
+{
+    return g_mock.copy_total + g_mock.engine_total + g_mock.starts * (MODEL_START_PS + MODEL_WAKE_PS);
+}
+
+static hi_u32 g_seed = 0x5a17;
+
+static hi_u32 rand_below(hi_u32 n)
+{
+    g_seed = g_seed * 1103515245 + 12345; /* LCG */
+    return (g_seed >> 16) % n;
+}
+
+static hi_s32 sha256_digest(const hi_u8 *msg, hi_u32 len, hi_u32 max_update, hi_u8 digest[SHA256_RESULT_SIZE])
+{
+    hash_func *func = cryp_get_hash(HASH_MODE_SHA256);
+    hi_void *ctx = func->create(HASH_MODE_SHA256);
+    hi_u32 pos, n, hashlen;
+    hi_s32 ret = HI_SUCCESS;
+
+    for (pos = 0; (pos < len) && (ret == HI_SUCCESS); pos += n) {
+        n = (max_update == 0) ? (len - pos) : (1 + rand_below(max_update));
+        n = (n > len - pos) ? (len - pos) : n;
+        ret = func->update(ctx, msg + pos, n, HASH_CHUNCK_SRC_USER);
+    }
+    if (ret == HI_SUCCESS) {
+        ret = func->finish(ctx, digest, SHA256_RESULT_SIZE, &hashlen);
+    }
+    func->destroy(ctx);
+    return ret;
+}
+
+static hi_bool digest_is(const hi_u8 *digest, const char *hex)
+{
+    hi_char str[SHA256_RESULT_SIZE * 2 + 1];
+    hi_u32 i;
+
+    for (i = 0; i < SHA256_RESULT_SIZE; i++) {
+        (hi_void)snprintf(&str[i * 2], sizeof(str) - i * 2, "%02x", digest[i]);
+    }
+    return strcmp(str, hex) == 0;
+}
+
+static hi_void test_vectors(hi_void)
+{
+    static const char *abc_448 = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    hi_u8 digest[SHA256_RESULT_SIZE];
+    hi_u8 *million = malloc(1000000); /* 1000000: the FIPS 180-2 long message */
+    hi_bool ok = HI_TRUE;
+    hi_u32 i;
+
+    mock_reset(&g_models[0]);
+    ok = (sha256_digest((const hi_u8 *)"", 0, 0, digest) == HI_SUCCESS) &&
+        digest_is(digest, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    tool_check(ok, "sha256 of the empty message");
+    ok = (sha256_digest((const hi_u8 *)"abc", 3, 0, digest) == HI_SUCCESS) &&
+        digest_is(digest, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    tool_check(ok, "sha256 of abc");
+    ok = (sha256_digest((const hi_u8 *)abc_448, strlen(abc_448), 0, digest) == HI_SUCCESS) &&
+        digest_is(digest, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    tool_check(ok, "sha256 of the 448 bit message");
+
+    (hi_void)memset(million, 'a', 1000000); /* 1000000: the FIPS 180-2 long message */
+    ok = (sha256_digest(million, 1000000, 0, digest) == HI_SUCCESS) && /* 1000000: one update */
+        digest_is(digest, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    tool_check(ok && (g_mock.starts > 2), "sha256 of a million a in one update, across both buffers");
+    for (i = 0; i < 20; i++) { /* 20: runs of random update sizes */
+        ok = ok && (sha256_digest(million, 1000000, 1 + rand_below(0x180000), digest) == HI_SUCCESS) &&
+            digest_is(digest, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+    tool_check(ok, "sha256 of a million a in random updates");
+    free(million);
+
+    tool_check(g_mock.bad_overlap == 0, "no chunk copied into the buffer being hashed");
+    tool_check(g_mock.bad_busy == 0, "the engine is never set up while busy");
+    tool_check(g_mock.bad_align == 0, "every chunk is block aligned");
+    tool_check(g_mock.bad_wait == 0, "every wait has a chunk to wait for");
+}
+
+static hi_void test_copy_error(hi_void)
+{
+    hash_func *func = cryp_get_hash(HASH_MODE_SHA256);
+    hi_u32 len = g_mock_mem.dma_size * 2; /* 2: a few chunks */
+    hi_u8 *msg = calloc(1, len);
+    hi_void *ctx = HI_NULL;
+    hi_s32 ret;
+
+    mock_reset(&g_models[0]);
+    g_mock.copy_fail_in = 3; /* 3: the third chunk, while the second one is hashed */
+    ctx = func->create(HASH_MODE_SHA256);
+    ret = func->update(ctx, msg, len, HASH_CHUNCK_SRC_USER);
+    tool_check(ret != HI_SUCCESS, "a failed copy fails the update");
+    tool_check((g_mock.starts == 2) && !g_mock.busy, "the running chunk is waited for on a failed copy");
+    func->destroy(ctx);
+    g_mock.copy_fail_in = 0;
+    free(msg);
+}
+
+static hi_void test_throughput(hi_void)
+{
+    static const hi_u32 sizes[] = { 0x1000, 0x10000, 0x80000, 0x100000, 0x400000, 0x1000000 };
+    hi_u8 digest[SHA256_RESULT_SIZE];
+    hi_u8 *msg = calloc(1, sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+    hi_bool never_slower = HI_TRUE;
+    hi_bool overlapped = HI_TRUE;
+    hi_u64 piped, serial;
+    hi_u32 m, s;
+
+    for (m = 0; m < sizeof(g_models) / sizeof(g_models[0]); m++) {
+        printf("     %s\n", g_models[m].name);
+        printf("     %10s %8s %12s %12s\n", "message", "chunks", "pipelined", "serial");
+        for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            mock_reset(&g_models[m]);
+            (hi_void)sha256_digest(msg, sizes[s], 0, digest);
+            piped = g_mock.now;
+            serial = mock_serial_time();
+            printf("     %9uK %8u %7.1f MB/s %7.1f MB/s\n", sizes[s] / 1024, g_mock.starts, /* 1024: K */
+                (double)sizes[s] * MODEL_PS_PER_S / piped / 1e6, (double)sizes[s] * MODEL_PS_PER_S / serial / 1e6);
+            never_slower = never_slower && (piped <= serial);
+            /* 4: two chunks per buffer at least, 5/4: a quarter of the time saved */
+            if (sizes[s] >= g_mock_mem.dma_size * 2) {
+                overlapped = overlapped && (piped * 5 <= serial * 4);
+            }
+        }
+    }
+    free(msg);
+    tool_check(never_slower, "the pipeline is never slower than one chunk at a time");
+    tool_check(overlapped, "long messages save a quarter of the time or more");
+}
+
+int main(hi_void)
+{
+    if ((cryp_hash_init() != HI_SUCCESS) || (cryp_get_hash(HASH_MODE_SHA256) == HI_NULL)) {
+        printf("FAIL cryp_hash_init\n");
+        return 1;
+    }
+    test_vectors();
+    g_cipher_host_log = HI_FALSE;
+    test_copy_error();
+    g_cipher_host_log = HI_TRUE;
+    test_throughput();
+    cryp_hash_deinit();
+
+    if (g_fail != 0) {
+        printf("%u check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
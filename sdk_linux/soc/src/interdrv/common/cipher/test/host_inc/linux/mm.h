@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Kernel stand-in for the host builds of osal/drv_osal_sys_linux.c, the
+ * subset of the mm, dma and highmem api it uses. The functions are only
+ * declared, a harness implements the ones it drives and stubs the others.
+ * A struct page carries its physical address and the counts a harness checks.
+ */
+
+#ifndef __CIPHER_HOST_LINUX_MM_H__
+#define __CIPHER_HOST_LINUX_MM_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define KERNEL_VERSION(a, b, c) (((a) << 16) + ((b) << 8) + (c))
+#ifndef LINUX_VERSION_CODE
+#define LINUX_VERSION_CODE      KERNEL_VERSION(5, 10, 0)
+#endif
+
+#define PAGE_SHIFT              12
+#define PAGE_SIZE               (1UL << PAGE_SHIFT)
+#define PAGE_MASK               (~(PAGE_SIZE - 1))
+
+#define GFP_KERNEL              0
+#define GFP_ATOMIC              1
+#define FOLL_WRITE              0x01
+
+#define VM_READ                 0x00000001
+#define VM_WRITE                0x00000002
+#define VM_PFNMAP               0x00000400
+
+#define DMA_BIT_MASK(n)         (((n) == 64) ? ~0ULL : ((1ULL << (n)) - 1))
+
+typedef unsigned long long dma_addr_t;
+
+struct device;
+
+struct page {
+    unsigned long phys;
+    int pin;                    /* FOLL_PIN references */
+    int ref;                    /* plain references */
+    int dirty;
+};
+
+#define page_to_phys(page)      ((page)->phys)
+
+struct rw_semaphore {
+    int readers;
+};
+
+#define down_read(sem)          ((sem)->readers++)
+#define up_read(sem)            ((sem)->readers--)
+
+struct mm_struct {
+    struct rw_semaphore mmap_sem;
+    struct rw_semaphore mmap_lock;
+};
+
+struct vm_area_struct {
+    unsigned long vm_start;
+    unsigned long vm_end;
+    unsigned long vm_flags;
+};
+
+struct task_struct {
+    struct mm_struct *mm;
+};
+
+extern struct task_struct g_host_task;
+#define current                 (&g_host_task)
+
+int pin_user_pages_fast(unsigned long start, int nr_pages, unsigned int gup_flags, struct page **pages);
+void unpin_user_pages_dirty_lock(struct page **pages, unsigned long npages, bool make_dirty);
+int get_user_pages_fast(unsigned long start, int nr_pages, unsigned int gup_flags, struct page **pages);
+void put_page(struct page *page);
+int set_page_dirty_lock(struct page *page);
+void *kmap(struct page *page);
+void kunmap(struct page *page);
+
+struct vm_area_struct *find_vma(struct mm_struct *mm, unsigned long addr);
+int follow_pfn(struct vm_area_struct *vma, unsigned long address, unsigned long *pfn);
+
+int dma_set_coherent_mask(struct device *dev, unsigned long long mask);
+void *dma_alloc_coherent(struct device *dev, size_t size, dma_addr_t *dma_handle, int gfp);
+void dma_free_coherent(struct device *dev, size_t size, void *cpu_addr, dma_addr_t dma_handle);
+
+void *kzalloc(size_t size, int gfp);
+void kfree(const void *ptr);
+unsigned long virt_to_phys(const volatile void *address);
+void *phys_to_virt(unsigned long long address);
+unsigned long copy_from_user(void *to, const void *from, unsigned long n);
+unsigned long copy_to_user(void *to, const void *from, unsigned long n);
+
+void __cpuc_flush_dcache_area(void *addr, size_t size);
+void __flush_dcache_area(void *addr, size_t len);
+
+#endif /* __CIPHER_HOST_LINUX_MM_H__ */
@@ -0,0 +1,415 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host known answer test and benchmark of the software SM3
+ * (drivers/extend/ext_sm3.c), built with SOFT_SM3_SUPPORT. It checks:
+ *  - the GB/T 32905 examples, with the message split in updates of several
+ *    sizes, from kernel and from user memory;
+ *  - the messages of 0 to 200 bytes, across all the padding cases, one at a
+ *    time and as a batch, against a digest of their digests made with OpenSSL;
+ *  - ext_sm3_multi against one ext_sm3_update per message, on random batches
+ *    of messages around the block and padding boundaries;
+ *  - ext_sm3_hmac_multi against HMAC-SM3 vectors made with OpenSSL, and
+ *    against HMAC composed on ext_sm3_update as kapi_hash does, on random keys
+ *    up to twice a block long;
+ *  - the checks of the parameters.
+ * With "bench" it reports MB/s of one message at a time against 4 lanes, for
+ * hashes and for HMACs of a batch of messages, from the fastest of 200 batches
+ * so that the other load of the host is left out.
+ */
+
+#include <time.h>
+#include "cipher_host.h"
+#include "../src/drv/cipher_v1.0/drivers/extend/ext_sm3.c"
+
+#define tool_check(cond, name) \
+    do { \
+        if (cond) { \
+            printf("ok   %s\n", name); \
+        } else { \
+            printf("FAIL %s\n", name); \
+            g_fail++; \
+        } \
+    } while (0)
+
+#define SM3_KAT_LENS        201
+#define SM3_KAT_RUNS        300
+#define SM3_KAT_MAX_JOBS    9
+#define SM3_KAT_MAX_LEN     300
+#define SM3_KAT_MAX_KEY     130
+#define SM3_BENCH_JOBS      64
+#define SM3_BENCH_LOOP      200
+
+static hi_u32 g_fail = 0;
+
+/* ************************* stubs of the driver ************************* */
+hi_void *crypto_calloc(size_t n, size_t size)
+{
+    return calloc(n, size);
+}
+
+hi_s32 crypto_copy_from_user(hi_void *to, unsigned long to_len, const hi_void *from, unsigned long from_len)
+{
+    return memcpy_s(to, to_len, from, from_len) == EOK ? HI_SUCCESS : HI_FAILURE;
+}
+
+hi_s32 crypto_copy_to_user(hi_void *to, unsigned long to_len, const hi_void *from, unsigned long from_len)
+{
+    return memcpy_s(to, to_len, from, from_len) == EOK ? HI_SUCCESS : HI_FAILURE;
+}
+
+/* ************************* helpers ************************* */
+static hi_u32 g_seed = 0x5d3;
+
+static hi_u32 rand_below(hi_u32 n)
+{
+    g_seed = g_seed * 1103515245 + 12345; /* LCG */
+    return (g_seed >> 16) % n;
+}
+
+static hi_void rand_fill(hi_u8 *buf, hi_u32 len)
+{
+    hi_u32 i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = (hi_u8)rand_below(256); /* 256: a byte */
+    }
+}
+
+/* one message through create, update in pieces of step bytes, finish */
+static hi_s32 sm3_once(const hi_u8 *data, hi_u32 len, hi_u32 step, hash_chunk_src src, hi_u8 *digest)
+{
+    hi_void *ctx = ext_sm3_create(HASH_MODE_SM3);
+    hi_u32 off, n, hashlen;
+    hi_s32 ret = HI_SUCCESS;
+
+    for (off = 0; (off < len) && (ret == HI_SUCCESS); off += n) {
+        n = crypto_min(step, len - off);
+        ret = ext_sm3_update(ctx, data + off, n, src);
+    }
+    if (ret == HI_SUCCESS) {
+        ret = ext_sm3_finish(ctx, digest, SM3_RESULT_SIZE, &hashlen);
+    }
+    ext_sm3_destory(ctx);
+    return ret;
+}
+
+/* HMAC composed on the hash functions, as kapi_hmac_start and kapi_hmac_finish do */
+static hi_void hmac_once(const hi_u8 *key, hi_u32 keylen, const hi_u8 *data, hi_u32 len, hi_u8 *mac)
+{
+    hi_u8 k0[SM3_BLOCK_SIZE] = { 0 };
+    hi_u8 ipad[SM3_BLOCK_SIZE], opad[SM3_BLOCK_SIZE];
+    hi_u8 sum[SM3_RESULT_SIZE];
+    hi_void *ctx = HI_NULL;
+    hi_u32 i, hashlen;
+
+    if (keylen > SM3_BLOCK_SIZE) {
+        (hi_void)sm3_once(key, keylen, keylen, HASH_CHUNCK_SRC_LOCAL, k0);
+    } else if (keylen > 0) {
+        (hi_void)memcpy(k0, key, keylen);
+    }
+    for (i = 0; i < SM3_BLOCK_SIZE; i++) {
+        ipad[i] = k0[i] ^ 0x36; /* 0x36: ipad byte */
+        opad[i] = k0[i] ^ 0x5c; /* 0x5c: opad byte */
+    }
+
+    ctx = ext_sm3_create(HASH_MODE_SM3);
+    (hi_void)ext_sm3_update(ctx, ipad, sizeof(ipad), HASH_CHUNCK_SRC_LOCAL);
+    (hi_void)ext_sm3_update(ctx, data, len, HASH_CHUNCK_SRC_LOCAL);
+    (hi_void)ext_sm3_finish(ctx, sum, sizeof(sum), &hashlen);
+    ext_sm3_destory(ctx);
+
+    ctx = ext_sm3_create(HASH_MODE_SM3);
+    (hi_void)ext_sm3_update(ctx, opad, sizeof(opad), HASH_CHUNCK_SRC_LOCAL);
+    (hi_void)ext_sm3_update(ctx, sum, sizeof(sum), HASH_CHUNCK_SRC_LOCAL);
+    (hi_void)ext_sm3_finish(ctx, mac, SM3_RESULT_SIZE, &hashlen);
+    ext_sm3_destory(ctx);
+}
+
+/* ************************* tests ************************* */
+static hi_void test_kat(hi_void)
+{
+    /* GB/T 32905-2016 appendix A */
+    static const hi_u8 abc_sum[SM3_RESULT_SIZE] = {
+        0x66, 0xc7, 0xf0, 0xf4, 0x62, 0xee, 0xed, 0xd9, 0xd1, 0xf2, 0xd4, 0x6b, 0xdc, 0x10, 0xe4, 0xe2,
+        0x41, 0x67, 0xc4, 0x87, 0x5c, 0xf2, 0xf7, 0xa2, 0x29, 0x7d, 0xa0, 0x2b, 0x8f, 0x4b, 0xa8, 0xe0
+    };
+    static const hi_u8 abcd_sum[SM3_RESULT_SIZE] = {
+        0xde, 0xbe, 0x9f, 0xf9, 0x22, 0x75, 0xb8, 0xa1, 0x38, 0x60, 0x48, 0x89, 0xc1, 0x8e, 0x5a, 0x4d,
+        0x6f, 0xdb, 0x70, 0xe5, 0x38, 0x7e, 0x57, 0x65, 0x29, 0x3d, 0xcb, 0xa3, 0x9c, 0x0c, 0x57, 0x32
+    };
+    static const hi_u32 steps[] = { 1, 3, 63, 64, 65, 0x10000 };
+    hi_u8 abcd[SM3_BLOCK_SIZE];
+    hi_u8 digest[SM3_RESULT_SIZE];
+    hi_u32 i, s, bad_abc = 0, bad_abcd = 0;
+
+    for (i = 0; i < sizeof(abcd); i++) {
+        abcd[i] = (hi_u8)('a' + i % WORD_WIDTH);
+    }
+    for (s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+        for (i = HASH_CHUNCK_SRC_LOCAL; i <= HASH_CHUNCK_SRC_USER; i++) {
+            bad_abc += (sm3_once((const hi_u8 *)"abc", 3, steps[s], i, digest) != HI_SUCCESS) || /* 3: abc */
+                (memcmp(digest, abc_sum, sizeof(digest)) != 0);
+            bad_abcd += (sm3_once(abcd, sizeof(abcd), steps[s], i, digest) != HI_SUCCESS) ||
+                (memcmp(digest, abcd_sum, sizeof(digest)) != 0);
+        }
+    }
+    tool_check(bad_abc == 0, "GB/T 32905 example 1, abc, in any update size");
+    tool_check(bad_abcd == 0, "GB/T 32905 example 2, 64 bytes, in any update size");
+}
+
+/* the digests of the messages of each length, with byte i of length len being (7 * i + len) & 0xff */
+static hi_void test_lengths(hi_void)
+{
+    /* sm3 of the digests of the lengths 0 to 200 one after the other, from OpenSSL 3.0 */
+    static const hi_u8 sum[SM3_RESULT_SIZE] = {
+        0xa0, 0xdf, 0xef, 0xcc, 0x0b, 0x81, 0x86, 0xa5, 0x96, 0xf2, 0x49, 0x04, 0x9a, 0x0f, 0x4f, 0x84,
+        0x54, 0x13, 0xe4, 0x0d, 0xb6, 0xbf, 0xf0, 0xf0, 0x13, 0x1c, 0x02, 0xde, 0xa3, 0xbf, 0x91, 0x08
+    };
+    static hi_u8 data[SM3_KAT_LENS][SM3_KAT_LENS];
+    static hi_u8 digests[SM3_KAT_LENS][SM3_RESULT_SIZE];
+    static ext_sm3_job job[SM3_KAT_LENS];
+    hi_u8 digest[SM3_RESULT_SIZE];
+    hi_u32 len, i;
+
+    for (len = 0; len < SM3_KAT_LENS; len++) {
+        for (i = 0; i < len; i++) {
+            data[len][i] = (hi_u8)(7 * i + len); /* 7: byte step */
+        }
+        (hi_void)sm3_once(data[len], len, len + 1, HASH_CHUNCK_SRC_LOCAL, digests[len]);
+        job[len].data = data[len];
+        job[len].len = len;
+        job[len].digest = digests[len];
+    }
+    (hi_void)sm3_once(digests[0], sizeof(digests), sizeof(digests), HASH_CHUNCK_SRC_LOCAL, digest);
+    tool_check(memcmp(digest, sum, sizeof(sum)) == 0, "lengths 0 to 200, one at a time");
+
+    (hi_void)memset(digests, 0, sizeof(digests));
+    (hi_void)ext_sm3_multi(job, SM3_KAT_LENS);
+    (hi_void)sm3_once(digests[0], sizeof(digests), sizeof(digests), HASH_CHUNCK_SRC_LOCAL, digest);
+    tool_check(memcmp(digest, sum, sizeof(sum)) == 0, "lengths 0 to 200, as a batch");
+}
+
+static hi_void test_multi(hi_void)
+{
+    static const hi_u32 edges[] = { 0, 1, 55, 56, 63, 64, 65, 119, 120, 128 };
+    static hi_u8 data[SM3_KAT_MAX_JOBS][SM3_KAT_MAX_LEN];
+    hi_u8 digest[SM3_KAT_MAX_JOBS][SM3_RESULT_SIZE];
+    hi_u8 ref[SM3_RESULT_SIZE];
+    ext_sm3_job job[SM3_KAT_MAX_JOBS];
+    hi_u32 run, num, i, bad = 0, bad_ret = 0;
+
+    for (run = 0; run < SM3_KAT_RUNS; run++) {
+        num = 1 + rand_below(SM3_KAT_MAX_JOBS);
+        for (i = 0; i < num; i++) {
+            job[i].len = (rand_below(2) == 0) ? edges[rand_below(sizeof(edges) / sizeof(edges[0]))] : /* 2: half */
+                rand_below(SM3_KAT_MAX_LEN + 1);
+            rand_fill(data[i], job[i].len);
+            job[i].data = data[i];
+            job[i].digest = digest[i];
+        }
+        bad_ret += (ext_sm3_multi(job, num) != HI_SUCCESS);
+        for (i = 0; i < num; i++) {
+            (hi_void)sm3_once(data[i], job[i].len, job[i].len + 1, HASH_CHUNCK_SRC_LOCAL, ref);
+            bad += (memcmp(digest[i], ref, sizeof(ref)) != 0);
+        }
+    }
+    tool_check(bad_ret == 0, "multi: every batch is hashed");
+    tool_check(bad == 0, "multi: every digest is the one of ext_sm3_update");
+}
+
+static hi_void test_hmac(hi_void)
+{
+    /* RFC 4231 test cases 1, 2 and 6 with SM3, the macs are from OpenSSL 3.0 */
+    static const hi_u8 mac1[SM3_RESULT_SIZE] = {
+        0x51, 0xb0, 0x0d, 0x1f, 0xb4, 0x98, 0x32, 0xbf, 0xb0, 0x1c, 0x3c, 0xe2, 0x78, 0x48, 0xe5, 0x9f,
+        0x87, 0x1d, 0x9b, 0xa9, 0x38, 0xdc, 0x56, 0x3b, 0x33, 0x8c, 0xa9, 0x64, 0x75, 0x5c, 0xce, 0x70
+    };
+    static const hi_u8 mac2[SM3_RESULT_SIZE] = {
+        0x2e, 0x87, 0xf1, 0xd1, 0x68, 0x62, 0xe6, 0xd9, 0x64, 0xb5, 0x0a, 0x52, 0x00, 0xbf, 0x2b, 0x10,
+        0xb7, 0x64, 0xfa, 0xa9, 0x68, 0x0a, 0x29, 0x6a, 0x24, 0x05, 0xf2, 0x4b, 0xec, 0x39, 0xf8, 0x82
+    };
+    static const hi_u8 mac6[SM3_RESULT_SIZE] = {
+        0xb4, 0xfd, 0x84, 0x4e, 0x13, 0x34, 0x20, 0x02, 0xf0, 0xb2, 0xe0, 0x69, 0x0e, 0xa7, 0x74, 0x1f,
+        0x14, 0x97, 0xd9, 0x93, 0xa7, 0x04, 0x94, 0xce, 0xa6, 0x01, 0xe6, 0x57, 0xbe, 0xdf, 0x67, 0xa0
+    };
+    static const hi_char *msg6 = "Test Using Larger Than Block-Size Key - Hash Key First";
+    static hi_u8 data[SM3_KAT_MAX_JOBS][SM3_KAT_MAX_LEN];
+    hi_u8 key[SM3_KAT_MAX_KEY + 1];
+    hi_u8 mac[SM3_KAT_MAX_JOBS][SM3_RESULT_SIZE];
+    hi_u8 ref[SM3_RESULT_SIZE];
+    ext_sm3_hmac_key hkey;
+    ext_sm3_job job[SM3_KAT_MAX_JOBS];
+    hi_u32 run, num, keylen, i, bad = 0;
+
+    job[0].digest = mac[0];
+    (hi_void)memset(key, 0x0b, 20); /* 20: key of case 1 */
+    job[0].data = (const hi_u8 *)"Hi There";
+    job[0].len = 8; /* 8: Hi There */
+    tool_check((ext_sm3_hmac_setkey(&hkey, key, 20) == HI_SUCCESS) && /* 20: key of case 1 */
+        (ext_sm3_hmac_multi(&hkey, job, 1) == HI_SUCCESS) && (memcmp(mac[0], mac1, sizeof(mac1)) == 0),
+        "hmac: RFC 4231 case 1 key and message");
+    job[0].data = (const hi_u8 *)"what do ya want for nothing?";
+    job[0].len = 28; /* 28: message of case 2 */
+    tool_check((ext_sm3_hmac_setkey(&hkey, (const hi_u8 *)"Jefe", 4) == HI_SUCCESS) && /* 4: Jefe */
+        (ext_sm3_hmac_multi(&hkey, job, 1) == HI_SUCCESS) && (memcmp(mac[0], mac2, sizeof(mac2)) == 0),
+        "hmac: RFC 4231 case 2 key and message");
+    (hi_void)memset(key, 0xaa, 131); /* 131: key of case 6 */
+    job[0].data = (const hi_u8 *)msg6;
+    job[0].len = strlen(msg6);
+    tool_check((ext_sm3_hmac_setkey(&hkey, key, 131) == HI_SUCCESS) && /* 131: key of case 6 */
+        (ext_sm3_hmac_multi(&hkey, job, 1) == HI_SUCCESS) && (memcmp(mac[0], mac6, sizeof(mac6)) == 0),
+        "hmac: RFC 4231 case 6, a key longer than a block is hashed");
+
+    for (run = 0; run < SM3_KAT_RUNS; run++) {
+        keylen = rand_below(SM3_KAT_MAX_KEY + 1);
+        rand_fill(key, keylen);
+        num = 1 + rand_below(SM3_KAT_MAX_JOBS);
+        for (i = 0; i < num; i++) {
+            job[i].len = rand_below(SM3_KAT_MAX_LEN + 1);
+            rand_fill(data[i], job[i].len);
+            job[i].data = data[i];
+            job[i].digest = mac[i];
+        }
+        (hi_void)ext_sm3_hmac_setkey(&hkey, key, keylen);
+        bad += (ext_sm3_hmac_multi(&hkey, job, num) != HI_SUCCESS);
+        for (i = 0; i < num; i++) {
+            hmac_once(key, keylen, data[i], job[i].len, ref);
+            bad += (memcmp(mac[i], ref, sizeof(ref)) != 0);
+        }
+    }
+    tool_check(bad == 0, "hmac: every mac of a batch is the one of the hash functions");
+}
+
+static hi_void test_params(hi_void)
+{
+    hi_u8 digest[SM3_RESULT_SIZE];
+    ext_sm3_job job = { HI_NULL, 0, digest };
+    ext_sm3_hmac_key hkey;
+
+    tool_check((ext_sm3_multi(&job, 1) == HI_SUCCESS) && (ext_sm3_multi(&job, 0) == HI_SUCCESS),
+        "an empty message and an empty batch are hashed");
+    g_cipher_host_log = HI_FALSE;
+    tool_check(ext_sm3_multi(HI_NULL, 1) != HI_SUCCESS, "a null batch is refused");
+    job.len = 1;
+    tool_check(ext_sm3_multi(&job, 1) != HI_SUCCESS, "a null message is refused");
+    job.data = digest;
+    job.digest = HI_NULL;
+    tool_check(ext_sm3_multi(&job, 1) != HI_SUCCESS, "a null digest is refused");
+    tool_check(ext_sm3_hmac_setkey(&hkey, HI_NULL, 1) != HI_SUCCESS, "a null hmac key is refused");
+    g_cipher_host_log = HI_TRUE;
+    tool_check(ext_sm3_hmac_setkey(&hkey, HI_NULL, 0) == HI_SUCCESS, "an empty hmac key is taken");
+}
+
+/* ************************* benchmark ************************* */
+static double now_sec(hi_void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9; /* 1e9: ns per s */
+}
+
+typedef enum {
+    BENCH_HASH_ONE,
+    BENCH_HASH_MULTI,
+    BENCH_HMAC_ONE,
+    BENCH_HMAC_MULTI,
+} bench_kind;
+
+/* MB/s of the fastest batch */
+static double bench_batch(bench_kind kind, const hi_u8 *buf, hi_u32 len, const hi_u8 *key)
+{
+    ext_sm3_job job[SM3_BENCH_JOBS];
+    hi_u8 digest[SM3_BENCH_JOBS][SM3_RESULT_SIZE];
+    ext_sm3_hmac_key hkey;
+    double t, best = 0;
+    hi_u32 n, i;
+
+    for (i = 0; i < SM3_BENCH_JOBS; i++) {
+        job[i].data = buf + i * len;
+        job[i].len = len;
+        job[i].digest = digest[i];
+    }
+    for (n = 0; n < SM3_BENCH_LOOP; n++) {
+        t = now_sec();
+        if (kind == BENCH_HASH_MULTI) {
+            (hi_void)ext_sm3_multi(job, SM3_BENCH_JOBS);
+        } else if (kind == BENCH_HMAC_MULTI) {
+            (hi_void)ext_sm3_hmac_setkey(&hkey, key, SM3_RESULT_SIZE);
+            (hi_void)ext_sm3_hmac_multi(&hkey, job, SM3_BENCH_JOBS);
+        } else {
+            for (i = 0; i < SM3_BENCH_JOBS; i++) {
+                if (kind == BENCH_HASH_ONE) {
+                    (hi_void)sm3_once(job[i].data, len, len, HASH_CHUNCK_SRC_LOCAL, digest[i]);
+                } else {
+                    hmac_once(key, SM3_RESULT_SIZE, job[i].data, len, digest[i]);
+                }
+            }
+        }
+        t = now_sec() - t;
+        best = crypto_max(best, (double)len * SM3_BENCH_JOBS / t / 1e6); /* 1e6: MB */
+    }
+    return best;
+}
+
+static hi_void bench(hi_void)
+{
+    static const hi_u32 lens[] = { 64, 256, 1024, 4096 };
+    hi_u8 *buf = malloc(SM3_BENCH_JOBS * lens[sizeof(lens) / sizeof(lens[0]) - 1]);
+    hi_u8 key[SM3_RESULT_SIZE];
+    double one, multi;
+    hi_u32 i;
+
+    rand_fill(buf, SM3_BENCH_JOBS * lens[sizeof(lens) / sizeof(lens[0]) - 1]);
+    rand_fill(key, sizeof(key));
+    printf("SM3, batches of %u messages, MB/s of one message at a time and of %u lanes\n",
+        SM3_BENCH_JOBS, SM3_LANES);
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        one = bench_batch(BENCH_HASH_ONE, buf, lens[i], key);
+        multi = bench_batch(BENCH_HASH_MULTI, buf, lens[i], key);
+        printf("hash %5u bytes  %7.1f  %7.1f  %.2fx\n", lens[i], one, multi, multi / one);
+    }
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        one = bench_batch(BENCH_HMAC_ONE, buf, lens[i], key);
+        multi = bench_batch(BENCH_HMAC_MULTI, buf, lens[i], key);
+        printf("hmac %5u bytes  %7.1f  %7.1f  %.2fx\n", lens[i], one, multi, multi / one);
+    }
+    free(buf);
+}
+
+int main(int argc, char *argv[])
+{
+    if ((argc > 1) && (strcmp(argv[1], "bench") == 0)) {
+        bench();
+        return 0;
+    }
+
+    test_kat();
+    test_lengths();
+    test_multi();
+    test_hmac();
+    test_params();
+    if (g_fail != 0) {
+        printf("%u check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host known answer test and benchmark of the bitsliced software SM4
+ * (drivers/extend/ext_sm4.c), built with SOFT_SM4_SUPPORT. It checks:
+ *  - the GB/T 32907 examples, a block and the block encrypted 1000000 times;
+ *  - ECB, CBC and CTR against a plain S box table implementation of SM4, on
+ *    random keys, IVs and lengths, in place or not and split over two calls;
+ *  - the IV left for the next call, and the key and IV lengths accepted.
+ * The default build slices 64-bit words (16 blocks a pass), sm4_kat_32 slices
+ * 32-bit words (8 blocks a pass) as a 32-bit cpu does. With "bench" it reports
+ * MB/s of each mode, next to the table implementation, from the fastest of
+ * 2000 calls of 4K so that the other load of the host is left out.
+ */
+
+#include <time.h>
+#include "cipher_host.h"
+#ifdef SM4_KAT_SLICE32
+#define hi_ulong hi_u32
+#endif
+#include "../src/drv/cipher_v1.0/drivers/extend/ext_sm4.c"
+
+#define tool_check(cond, name) \
+    do { \
+        if (cond) { \
+            printf("ok   %s\n", name); \
+        } else { \
+            printf("FAIL %s\n", name); \
+            g_fail++; \
+        } \
+    } while (0)
+
+#define SM4_KAT_RUNS        2000
+#define SM4_KAT_MAX_BLOCKS  64
+#define SM4_BENCH_LEN       0x1000
+#define SM4_BENCH_LOOP      2000
+
+static hi_u32 g_fail = 0;
+
+/* ************************* stubs of the driver ************************* */
+hi_s32 crypto_mem_open(crypto_mem *mem, compat_addr dma_ddr, hi_u32 dma_size)
+{
+    mem->dma_virt = dma_ddr.p;
+    mem->dma_size = dma_size;
+    return HI_SUCCESS;
+}
+
+hi_s32 crypto_mem_close(crypto_mem *mem)
+{
+    return HI_SUCCESS;
+}
+
+hi_void *crypto_mem_virt(const crypto_mem *mem)
+{
+    return mem->dma_virt;
+}
+
+/* ************************* table reference ************************* */
+/* the S box of GB/T 32907, as the table implementation of the driver had it */
+static const hi_u8 g_ref_sbox[256] = {
+    0xd6, 0x90, 0xe9, 0xfe, 0xcc, 0xe1, 0x3d, 0xb7, 0x16, 0xb6, 0x14, 0xc2, 0x28, 0xfb, 0x2c, 0x05,
+    0x2b, 0x67, 0x9a, 0x76, 0x2a, 0xbe, 0x04, 0xc3, 0xaa, 0x44, 0x13, 0x26, 0x49, 0x86, 0x06, 0x99,
+    0x9c, 0x42, 0x50, 0xf4, 0x91, 0xef, 0x98, 0x7a, 0x33, 0x54, 0x0b, 0x43, 0xed, 0xcf, 0xac, 0x62,
+    0xe4, 0xb3, 0x1c, 0xa9, 0xc9, 0x08, 0xe8, 0x95, 0x80, 0xdf, 0x94, 0xfa, 0x75, 0x8f, 0x3f, 0xa6,
+    0x47, 0x07, 0xa7, 0xfc, 0xf3, 0x73, 0x17, 0xba, 0x83, 0x59, 0x3c, 0x19, 0xe6, 0x85, 0x4f, 0xa8,
+    0x68, 0x6b, 0x81, 0xb2, 0x71, 0x64, 0xda, 0x8b, 0xf8, 0xeb, 0x0f, 0x4b, 0x70, 0x56, 0x9d, 0x35,
+    0x1e, 0x24, 0x0e, 0x5e, 0x63, 0x58, 0xd1, 0xa2, 0x25, 0x22, 0x7c, 0x3b, 0x01, 0x21, 0x78, 0x87,
+    0xd4, 0x00, 0x46, 0x57, 0x9f, 0xd3, 0x27, 0x52, 0x4c, 0x36, 0x02, 0xe7, 0xa0, 0xc4, 0xc8, 0x9e,
+    0xea, 0xbf, 0x8a, 0xd2, 0x40, 0xc7, 0x38, 0xb5, 0xa3, 0xf7, 0xf2, 0xce, 0xf9, 0x61, 0x15, 0xa1,
+    0xe0, 0xae, 0x5d, 0xa4, 0x9b, 0x34, 0x1a, 0x55, 0xad, 0x93, 0x32, 0x30, 0xf5, 0x8c, 0xb1, 0xe3,
+    0x1d, 0xf6, 0xe2, 0x2e, 0x82, 0x66, 0xca, 0x60, 0xc0, 0x29, 0x23, 0xab, 0x0d, 0x53, 0x4e, 0x6f,
+    0xd5, 0xdb, 0x37, 0x45, 0xde, 0xfd, 0x8e, 0x2f, 0x03, 0xff, 0x6a, 0x72, 0x6d, 0x6c, 0x5b, 0x51,
+    0x8d, 0x1b, 0xaf, 0x92, 0xbb, 0xdd, 0xbc, 0x7f, 0x11, 0xd9, 0x5c, 0x41, 0x1f, 0x10, 0x5a, 0xd8,
+    0x0a, 0xc1, 0x31, 0x88, 0xa5, 0xcd, 0x7b, 0xbd, 0x2d, 0x74, 0xd0, 0x12, 0xb8, 0xe5, 0xb4, 0xb0,
+    0x89, 0x69, 0x97, 0x4a, 0x0c, 0x96, 0x77, 0x7e, 0x65, 0xb9, 0xf1, 0x09, 0xc5, 0x6e, 0xc6, 0x84,
+    0x18, 0xf0, 0x7d, 0xec, 0x3a, 0xdc, 0x4d, 0x20, 0x79, 0xee, 0x5f, 0x3e, 0xd7, 0xcb, 0x39, 0x48,
+};
+
+static hi_u32 ref_tau(hi_u32 a)
+{
+    return ((hi_u32)g_ref_sbox[a >> 24] << 24) | ((hi_u32)g_ref_sbox[(a >> 16) & 0xff] << 16) |
+        ((hi_u32)g_ref_sbox[(a >> 8) & 0xff] << 8) | g_ref_sbox[a & 0xff];
+}
+
+static hi_void ref_key(const hi_u8 *key, hi_u32 rk[SM4_RD_KEY_LEN])
+{
+    hi_u32 k[SM4_WORD_NUM + SM4_RD_KEY_LEN];
+    hi_u32 i, b;
+
+    for (i = 0; i < SM4_WORD_NUM; i++) {
+        k[i] = getu32(key + i * WORD_WIDTH) ^ g_fk[i];
+    }
+    for (i = 0; i < SM4_RD_KEY_LEN; i++) {
+        b = ref_tau(k[i + 1] ^ k[i + 2] ^ k[i + 3] ^ g_ck[i]);
+        k[i + 4] = k[i] ^ b ^ sm4_rotl(b, 13) ^ sm4_rotl(b, 23);
+        rk[i] = k[i + 4];
+    }
+}
+
+static hi_void ref_block(const hi_u32 rk[SM4_RD_KEY_LEN], hi_u32 decrypt, const hi_u8 *in, hi_u8 *out)
+{
+    hi_u32 x[SM4_WORD_NUM + SM4_RD_KEY_LEN];
+    hi_u32 i, b;
+
+    for (i = 0; i < SM4_WORD_NUM; i++) {
+        x[i] = getu32(in + i * WORD_WIDTH);
+    }
+    for (i = 0; i < SM4_RD_KEY_LEN; i++) {
+        b = ref_tau(x[i + 1] ^ x[i + 2] ^ x[i + 3] ^ (decrypt ? rk[SM4_RD_KEY_LEN - 1 - i] : rk[i]));
+        x[i + 4] = x[i] ^ b ^ sm4_rotl(b, 2) ^ sm4_rotl(b, 10) ^ sm4_rotl(b, 18) ^ sm4_rotl(b, 24);
+    }
+    for (i = 0; i < SM4_WORD_NUM; i++) {
+        putu32(out + i * WORD_WIDTH, x[SM4_RD_KEY_LEN + SM4_WORD_NUM - 1 - i]);
+    }
+}
+
+/* in and out may be the same buffer, as for the driver */
+static hi_void ref_crypt(symc_mode mode, hi_u32 decrypt, const hi_u8 *key, hi_u8 *iv,
+    const hi_u8 *in, hi_u8 *out, hi_u32 len)
+{
+    hi_u32 rk[SM4_RD_KEY_LEN];
+    hi_u8 blk[SM4_BLOCK_SIZE];
+    hi_u8 prev[SM4_BLOCK_SIZE];
+    hi_u32 pos, i, n;
+
+    ref_key(key, rk);
+    for (pos = 0; pos < len; pos += SM4_BLOCK_SIZE) {
+        n = crypto_min(len - pos, SM4_BLOCK_SIZE);
+        if (mode == SYMC_MODE_ECB) {
+            ref_block(rk, decrypt, in + pos, out + pos);
+        } else if ((mode == SYMC_MODE_CBC) && !decrypt) {
+            for (i = 0; i < SM4_BLOCK_SIZE; i++) {
+                blk[i] = in[pos + i] ^ iv[i];
+            }
+            ref_block(rk, 0, blk, out + pos);
+            (hi_void)memcpy(iv, out + pos, SM4_BLOCK_SIZE);
+        } else if (mode == SYMC_MODE_CBC) {
+            (hi_void)memcpy(prev, in + pos, SM4_BLOCK_SIZE);
+            ref_block(rk, 1, in + pos, blk);
+            for (i = 0; i < SM4_BLOCK_SIZE; i++) {
+                out[pos + i] = blk[i] ^ iv[i];
+            }
+            (hi_void)memcpy(iv, prev, SM4_BLOCK_SIZE);
+        } else {
+            ref_block(rk, 0, iv, blk);
+            for (i = 0; i < n; i++) {
+                out[pos + i] = in[pos + i] ^ blk[i];
+            }
+            sm4_ctr128_inc(iv);
+        }
+    }
+}
+
+/* ************************* tests ************************* */
+static hi_u32 g_seed = 0x5d4;
+
+static hi_u32 rand_below(hi_u32 n)
+{
+    g_seed = g_seed * 1103515245 + 12345; /* LCG */
+    return (g_seed >> 16) % n;
+}
+
+static hi_void rand_fill(hi_u8 *buf, hi_u32 len)
+{
+    hi_u32 i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = (hi_u8)rand_below(256); /* 256: a byte */
+    }
+}
+
+static hi_void *sm4_open(symc_mode mode, const hi_u8 *key, const hi_u8 *iv)
+{
+    hi_void *ctx = ext_sm4_create(0);
+    hi_u32 klen = HI_CIPHER_KEY_AES_128BIT;
+
+    ext_sm4_setmode(ctx, SYMC_ALG_SM4, mode, SYMC_DAT_WIDTH_128);
+    (hi_void)ext_sm4_setkey(ctx, key, HI_NULL, &klen);
+    if (iv != HI_NULL) {
+        (hi_void)ext_sm4_setiv(ctx, iv, AES_IV_SIZE, 0);
+    }
+    return ctx;
+}
+
+static hi_s32 sm4_run(hi_void *ctx, hi_u32 decrypt, const hi_u8 *in, hi_u8 *out, hi_u32 len)
+{
+    compat_addr addr_in, addr_out;
+    symc_node_usage usage = SYMC_NODE_USAGE_NORMAL;
+    symc_multi_pack pack;
+
+    addr_in.cp = in;
+    addr_out.p = out;
+    pack.in = &addr_in;
+    pack.out = &addr_out;
+    pack.len = &len;
+    pack.usage = &usage;
+    pack.num = 1;
+    return ext_sm4_crypto(ctx, decrypt, &pack, HI_TRUE);
+}
+
+static hi_void test_kat(hi_void)
+{
+    /* GB/T 32907-2016 appendix A */
+    static const hi_u8 key[SM4_BLOCK_SIZE] = {
+        0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10
+    };
+    static const hi_u8 ct1[SM4_BLOCK_SIZE] = {
+        0x68, 0x1e, 0xdf, 0x34, 0xd2, 0x06, 0x96, 0x5e, 0x86, 0xb3, 0xe9, 0x4f, 0x53, 0x6e, 0x42, 0x46
+    };
+    static const hi_u8 ct1m[SM4_BLOCK_SIZE] = {
+        0x59, 0x52, 0x98, 0xc7, 0xc6, 0xfd, 0x27, 0x1f, 0x04, 0x02, 0xf8, 0x04, 0xc3, 0x3d, 0x3f, 0x66
+    };
+    hi_u8 buf[SM4_BLOCK_SIZE];
+    hi_void *ctx = sm4_open(SYMC_MODE_ECB, key, HI_NULL);
+    sm4_key rk;
+    hi_u32 i;
+
+    tool_check((sm4_run(ctx, SYMC_OPERATION_ENCRYPT, key, buf, sizeof(buf)) == HI_SUCCESS) &&
+        (memcmp(buf, ct1, sizeof(buf)) == 0), "GB/T 32907 example 1 encrypt");
+    tool_check((sm4_run(ctx, SYMC_OPERATION_DECRYPT, ct1, buf, sizeof(buf)) == HI_SUCCESS) &&
+        (memcmp(buf, key, sizeof(buf)) == 0), "GB/T 32907 example 1 decrypt");
+    ext_sm4_destory(ctx);
+
+    sm4_set_encrypt_key(key, &rk);
+    (hi_void)memcpy(buf, key, sizeof(buf));
+    for (i = 0; i < 1000000; i++) { /* 1000000: GB/T 32907 example 2 */
+        sm4_crypt_blocks(&rk, SYMC_OPERATION_ENCRYPT, buf, buf, 1);
+    }
+    tool_check(memcmp(buf, ct1m, sizeof(buf)) == 0, "GB/T 32907 example 2, 1000000 encryptions");
+    for (i = 0; i < 1000000; i++) { /* 1000000: GB/T 32907 example 2 */
+        sm4_crypt_blocks(&rk, SYMC_OPERATION_DECRYPT, buf, buf, 1);
+    }
+    tool_check(memcmp(buf, key, sizeof(buf)) == 0, "GB/T 32907 example 2, 1000000 decryptions");
+}
+
+static hi_void test_reference(hi_void)
+{
+    static const symc_mode modes[] = { SYMC_MODE_ECB, SYMC_MODE_CBC, SYMC_MODE_CTR };
+    static const char *names[] = { "ECB", "CBC", "CTR" };
+    hi_u8 key[SM4_BLOCK_SIZE], iv[AES_IV_SIZE], ref_iv[AES_IV_SIZE], got_iv[AES_IV_SIZE];
+    hi_u8 in[SM4_KAT_MAX_BLOCKS * SM4_BLOCK_SIZE];
+    hi_u8 out[sizeof(in)], ref[sizeof(in)];
+    hi_char name[64]; /* 64: check name */
+    hi_u32 bad_data, bad_iv, m, run, len, split, decrypt, ivlen;
+    hi_void *ctx = HI_NULL;
+
+    for (m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        bad_data = 0;
+        bad_iv = 0;
+        for (run = 0; run < SM4_KAT_RUNS; run++) {
+            rand_fill(key, sizeof(key));
+            rand_fill(iv, sizeof(iv));
+            rand_fill(in, sizeof(in));
+            decrypt = rand_below(2); /* 2: encrypt or decrypt */
+            len = 1 + rand_below(sizeof(in));
+            if (modes[m] != SYMC_MODE_CTR) {
+                len = (len + SM4_BLOCK_SIZE - 1) / SM4_BLOCK_SIZE * SM4_BLOCK_SIZE;
+            }
+            /* CTR keeps no partial block state, a call but the last ends on a block */
+            split = rand_below(len / SM4_BLOCK_SIZE + 1) * SM4_BLOCK_SIZE;
+
+            (hi_void)memcpy(ref_iv, iv, sizeof(iv));
+            ref_crypt(modes[m], decrypt, key, ref_iv, in, ref, len);
+
+            ctx = sm4_open(modes[m], key, iv);
+            (hi_void)memcpy(out, in, len);
+            if (rand_below(2) == 0) { /* 2: in place or not */
+                (hi_void)sm4_run(ctx, decrypt, out, out, split);
+                (hi_void)sm4_run(ctx, decrypt, out + split, out + split, len - split);
+            } else {
+                (hi_void)sm4_run(ctx, decrypt, in, out, split);
+                (hi_void)sm4_run(ctx, decrypt, in + split, out + split, len - split);
+            }
+            ext_sm4_getiv(ctx, got_iv, &ivlen);
+            ext_sm4_destory(ctx);
+            bad_data += (memcmp(out, ref, len) != 0);
+            bad_iv += (modes[m] != SYMC_MODE_ECB) && (memcmp(got_iv, ref_iv, sizeof(got_iv)) != 0);
+        }
+        (hi_void)snprintf(name, sizeof(name), "%s matches the table implementation", names[m]);
+        tool_check(bad_data == 0, name);
+        if (modes[m] != SYMC_MODE_ECB) {
+            (hi_void)snprintf(name, sizeof(name), "%s leaves the IV of the next call", names[m]);
+            tool_check(bad_iv == 0, name);
+        }
+    }
+}
+
+static hi_void test_params(hi_void)
+{
+    hi_u8 key[SM4_BLOCK_SIZE] = { 0 };
+    hi_u8 iv[AES_IV_SIZE] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    hi_u8 got[AES_IV_SIZE];
+    hi_void *ctx = ext_sm4_create(0);
+    hi_u32 klen, ivlen;
+
+    klen = HI_CIPHER_KEY_AES_256BIT;
+    g_cipher_host_log = HI_FALSE;
+    tool_check(ext_sm4_setkey(ctx, key, HI_NULL, &klen) != HI_SUCCESS, "a 256 bit key is refused");
+    g_cipher_host_log = HI_TRUE;
+    klen = HI_CIPHER_KEY_AES_128BIT;
+    tool_check((ext_sm4_setkey(ctx, key, HI_NULL, &klen) == HI_SUCCESS) && (klen == AES_KEY_128BIT),
+        "a 128 bit key is taken");
+    (hi_void)memset(got, 0xff, sizeof(got));
+    tool_check((ext_sm4_setiv(ctx, iv, 8, 0) == HI_SUCCESS), "a short IV is taken"); /* 8: half an IV */
+    ext_sm4_getiv(ctx, got, &ivlen);
+    tool_check((ivlen == AES_IV_SIZE) && (memcmp(got, iv, 8) == 0), "the IV reads back"); /* 8: half an IV */
+    ext_sm4_destory(ctx);
+}
+
+static double now_sec(hi_void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9; /* 1e9: ns per s */
+}
+
+static double bench_mode(symc_mode mode, hi_u32 decrypt, const hi_u8 *key, hi_u8 *iv, hi_u8 *buf, hi_u32 sliced)
+{
+    hi_void *ctx = sliced ? sm4_open(mode, key, iv) : HI_NULL;
+    double t, best = 0;
+    hi_u32 i;
+
+    for (i = 0; i < SM4_BENCH_LOOP; i++) {
+        t = now_sec();
+        if (sliced) {
+            (hi_void)sm4_run(ctx, decrypt, buf, buf, SM4_BENCH_LEN);
+        } else {
+            ref_crypt(mode, decrypt, key, iv, buf, buf, SM4_BENCH_LEN);
+        }
+        t = now_sec() - t;
+        best = crypto_max(best, (double)SM4_BENCH_LEN / t / 1e6); /* 1e6: MB */
+    }
+    if (ctx != HI_NULL) {
+        ext_sm4_destory(ctx);
+    }
+    return best;
+}
+
+static hi_void bench(hi_void)
+{
+    static const symc_mode modes[] = { SYMC_MODE_ECB, SYMC_MODE_CBC, SYMC_MODE_CBC, SYMC_MODE_CTR };
+    static const hi_u32 decrypts[] = { 0, 0, 1, 0 };
+    static const char *names[] = { "ECB", "CBC encrypt", "CBC decrypt", "CTR" };
+    hi_u8 *buf = malloc(SM4_BENCH_LEN);
+    hi_u8 key[SM4_BLOCK_SIZE], iv[AES_IV_SIZE];
+    double sliced, table;
+    hi_u32 m;
+
+    rand_fill(buf, SM4_BENCH_LEN);
+    rand_fill(key, sizeof(key));
+    rand_fill(iv, sizeof(iv));
+    printf("SM4, %u blocks a pass, %uK a call\n", SM4_PARA_BLOCKS, SM4_BENCH_LEN / 1024); /* 1024: K */
+    for (m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        sliced = bench_mode(modes[m], decrypts[m], key, iv, buf, HI_TRUE);
+        table = bench_mode(modes[m], decrypts[m], key, iv, buf, HI_FALSE);
+        printf("%-12s bitsliced %7.1f MB/s  table %7.1f MB/s  %.2fx\n", names[m], sliced, table, sliced / table);
+    }
+    free(buf);
+}
+
+int main(int argc, char *argv[])
+{
+    if ((argc > 1) && (strcmp(argv[1], "bench") == 0)) {
+        bench();
+        return 0;
+    }
+
+    printf("     %u blocks a pass\n", SM4_PARA_BLOCKS);
+    test_kat();
+    test_reference();
+    test_params();
+    if (g_fail != 0) {
+        printf("%u check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
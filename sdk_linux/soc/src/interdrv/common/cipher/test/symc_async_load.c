@@ -0,0 +1,684 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host load generator of the async symc path of kapi_symc.c.
+ *
+ * The real kapi_symc.c runs against a mock symc engine:
+ *  - race: the isr of the mock engine runs in its own thread, it writes the
+ *    output of a job and then calls the notify of kapi. The user thread polls
+ *    with kapi_symc_async_poll, collects with kapi_symc_async_done and checks
+ *    the output and the injected errors it sees. Build with "make tsan" to
+ *    let the thread sanitizer check the publication of async_ret/async_done.
+ *  - load: a virtual clock drives Poisson packet arrivals through the kapi
+ *    interface, one packet per sync ioctl or batches on the async channels,
+ *    and reports packets/s with the p50/p99/p99.9 latency of the packets.
+ *    The engine, irq and syscall costs are a model (MODEL_*), not measures.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <math.h>
+#include "cipher_host.h"
+#include "../src/drv/cipher_v1.0/drivers/kapi_symc.c"
+
+#define tool_check(cond, name) \
+    do { \
+        if (cond) { \
+            printf("ok   %s\n", name); \
+        } else { \
+            printf("FAIL %s\n", name); \
+            g_fail++; \
+        } \
+    } while (0)
+
+static hi_u32 g_fail = 0;
+
+/* ************************* stubs of the driver ************************* */
+hi_s32 cipher_check_mmz_phy_addr(hi_phys_addr_t phy_addr, hi_u32 length)
+{
+    return HI_SUCCESS;
+}
+
+hi_void *crypto_calloc(size_t n, size_t size)
+{
+    return calloc(n, size);
+}
+
+hi_s32 crypto_copy_from_user(hi_void *to, unsigned long to_len, const hi_void *from, unsigned long from_len)
+{
+    return memcpy_s(to, to_len, from, from_len) == EOK ? HI_SUCCESS : HI_FAILURE;
+}
+
+hi_s32 crypto_copy_to_user(hi_void *to, unsigned long to_len, const hi_void *from, unsigned long from_len)
+{
+    return memcpy_s(to, to_len, from, from_len) == EOK ? HI_SUCCESS : HI_FAILURE;
+}
+
+hi_s32 crypto_mem_create(crypto_mem *mem, hi_u32 type, const char *name, hi_u32 size)
+{
+    return HI_FAILURE;
+}
+
+hi_s32 crypto_mem_destroy(crypto_mem *mem)
+{
+    return HI_SUCCESS;
+}
+
+hi_s32 crypto_user_pages_pin(crypto_user_pages *upages, hi_void *buffer, hi_u32 length, hi_u32 write)
+{
+    return HI_FAILURE;
+}
+
+hi_void crypto_user_pages_unpin(crypto_user_pages *upages)
+{
+}
+
+hi_u32 crypto_user_pages_seg(const crypto_user_pages *upages, hi_u32 pos, compat_addr *dma_addr)
+{
+    return 0;
+}
+
+hi_void crypto_user_pages_flush(const crypto_user_pages *upages)
+{
+}
+
+hi_s32 crypto_user_pfn_phys(hi_void *buffer, hi_u32 length, hi_u32 write, compat_addr *dma_addr)
+{
+    return HI_FAILURE;
+}
+
+hi_s32 crypto_user_pfn_flush(hi_void *buffer, hi_u32 length)
+{
+    return HI_SUCCESS;
+}
+
+hi_s32 klad_load_hard_key(hi_u32 handle, hi_u32 ca_type, const hi_u8 *key, hi_u32 key_len)
+{
+    return HI_FAILURE;
+}
+
+hi_s32 klad_encrypt_key(hi_u32 keysel, hi_u32 target, hi_u8 *clear, hi_u8 *encrypt, hi_u32 key_len)
+{
+    return HI_FAILURE;
+}
+
+/* ******************************* mock engine ******************************* */
+/* latency model, ns: channel start and node list fetch, aes-cbc rate, isr + wake up, ioctl round trip */
+#define MODEL_SETUP_NS          2000ULL
+#define MODEL_PS_PER_BYTE       5000ULL
+#define MODEL_IRQ_NS            8000ULL
+#define MODEL_SYSCALL_NS        3000ULL
+
+#define MOCK_FAIL_EVERY         37          /* every n-th async job completes with an error */
+#define MOCK_JOB_MAX            CRYPTO_HARD_CHANNEL_MAX
+
+typedef struct {
+    hi_u32 chn;
+    hi_u32 busy;
+    hi_u64 done_at;                         /* virtual time the last node is written */
+    symc_multi_pack pack;                   /* points into async_buf of kapi, kept until collected */
+    callback_symc_done notify;
+    hi_void *param;
+    hi_u32 seq;
+    hi_s32 result;
+} mock_job;
+
+static struct {
+    hi_u32 chn_used;
+    mock_job job[MOCK_JOB_MAX];
+    hi_u32 async_cnt;
+    hi_u32 waitdone_busy;                   /* waitdone had to wait for the isr */
+
+    hi_u32 threaded;                        /* isr runs in g_mock.isr_thread, else in mock_isr_run */
+    hi_u64 now;                             /* virtual clock, ns */
+    hi_u64 engine_free;                     /* the engine serves the channels one by one */
+
+    pthread_t isr_thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    hi_u32 fifo[MOCK_JOB_MAX];
+    hi_u32 head, tail, stop;
+} g_mock;
+
+hi_s32 cryp_symc_init(hi_void)
+{
+    g_mock.chn_used = 0;
+    return HI_SUCCESS;
+}
+
+hi_void cryp_symc_deinit(hi_void)
+{
+}
+
+hi_s32 cryp_symc_alloc_chn(hi_u32 *hard_chn)
+{
+    hi_u32 i;
+
+    for (i = 0; i < CRYPTO_HARD_CHANNEL_MAX; i++) {
+        if (((CIPHER_HARD_CHANNEL_MASK >> i) & 0x1) && !((g_mock.chn_used >> i) & 0x1)) {
+            g_mock.chn_used |= 1 << i;
+            *hard_chn = i;
+            return HI_SUCCESS;
+        }
+    }
+    return HI_ERR_CIPHER_BUSY;
+}
+
+hi_void cryp_symc_free_chn(hi_u32 hard_chn)
+{
+    g_mock.chn_used &= ~(1 << hard_chn);
+}
+
+static hi_void *mock_create(hi_u32 hard_chn)
+{
+    g_mock.job[hard_chn].chn = hard_chn;
+    return &g_mock.job[hard_chn];
+}
+
+static hi_s32 mock_destroy(hi_void *ctx)
+{
+    return HI_SUCCESS;
+}
+
+static hi_s32 mock_setkey(hi_void *ctx, const hi_u8 *fkey, const hi_u8 *skey, hi_u32 *hisi_klen)
+{
+    return HI_SUCCESS;
+}
+
+static hi_s32 mock_setiv(hi_void *ctx, const hi_u8 *iv, hi_u32 ivlen, hi_u32 usage)
+{
+    return HI_SUCCESS;
+}
+
+static hi_u64 mock_cost(const symc_multi_pack *pack)
+{
+    hi_u64 bytes = 0;
+    hi_u32 i;
+
+    for (i = 0; i < pack->num; i++) {
+        bytes += pack->len[i];
+    }
+    return MODEL_SETUP_NS + bytes * MODEL_PS_PER_BYTE / 1000ULL;    /* 1000: ps to ns */
+}
+
+/* "encrypt": stamp the job sequence into the first word of each output */
+static hi_void mock_write_out(const symc_multi_pack *pack, hi_u32 seq)
+{
+    hi_u32 i;
+
+    for (i = 0; i < pack->num; i++) {
+        *(hi_u32 *)(uintptr_t)addr_u64(pack->out[i]) = seq;
+    }
+}
+
+static hi_void mock_isr(mock_job *job)
+{
+    callback_symc_done notify = job->notify;
+    hi_void *param = job->param;
+    hi_s32 result = job->result;
+
+    mock_write_out(&job->pack, job->seq);
+    /* the job may be reused by the user once waitdone sees it idle */
+    __atomic_store_n(&job->busy, HI_FALSE, __ATOMIC_RELEASE);
+    notify(param, result);
+}
+
+static hi_s32 mock_crypto(hi_void *ctx, hi_u32 operation, symc_multi_pack *pack, hi_u32 wait)
+{
+    hi_u64 start = (g_mock.now > g_mock.engine_free) ? g_mock.now : g_mock.engine_free;
+
+    g_mock.engine_free = start + mock_cost(pack);
+    g_mock.now = g_mock.engine_free + MODEL_IRQ_NS;
+    mock_write_out(pack, 0);
+    return HI_SUCCESS;
+}
+
+static hi_s32 mock_crypto_async(hi_void *ctx, hi_u32 operation, symc_multi_pack *pack,
+    callback_symc_done notify, hi_void *param)
+{
+    mock_job *job = ctx;
+    hi_u64 start = (g_mock.now > g_mock.engine_free) ? g_mock.now : g_mock.engine_free;
+
+    job->pack = *pack;
+    job->notify = notify;
+    job->param = param;
+    job->seq = ++g_mock.async_cnt;
+    job->result = (job->seq % MOCK_FAIL_EVERY == 0) ? HI_ERR_CIPHER_TIMEOUT : HI_SUCCESS;
+    job->busy = HI_TRUE;
+
+    if (g_mock.threaded == HI_TRUE) {
+        pthread_mutex_lock(&g_mock.lock);
+        g_mock.fifo[g_mock.tail++ % MOCK_JOB_MAX] = job->chn;
+        pthread_cond_signal(&g_mock.cond);
+        pthread_mutex_unlock(&g_mock.lock);
+    } else {
+        g_mock.engine_free = start + mock_cost(pack);
+        job->done_at = g_mock.engine_free;
+    }
+    return HI_SUCCESS;
+}
+
+static hi_s32 mock_waitdone(hi_void *ctx, hi_u32 timeout)
+{
+    mock_job *job = ctx;
+
+    if (__atomic_load_n(&job->busy, __ATOMIC_ACQUIRE) != HI_TRUE) {
+        return HI_SUCCESS;
+    }
+    g_mock.waitdone_busy++;
+    while (__atomic_load_n(&job->busy, __ATOMIC_ACQUIRE) == HI_TRUE) {
+        if (g_mock.threaded != HI_TRUE) {
+            mock_isr(job);
+        } else {
+            sched_yield();
+        }
+    }
+    return HI_SUCCESS;
+}
+
+static symc_func g_mock_func = {
+    .valid = HI_TRUE,
+    .alg = SYMC_ALG_AES,
+    .mode = SYMC_MODE_CBC,
+    .create = mock_create,
+    .destroy = mock_destroy,
+    .setkey = mock_setkey,
+    .setiv = mock_setiv,
+    .crypto_async = mock_crypto_async,
+    .crypto = mock_crypto,
+    .waitdone = mock_waitdone,
+};
+
+symc_func *cryp_get_symc_op(hi_cipher_alg alg, hi_cipher_work_mode mode)
+{
+    return &g_mock_func;
+}
+
+/* the isr thread: one channel at a time, as the engine does */
+static hi_void *mock_isr_thread(hi_void *arg)
+{
+    hi_u32 chn;
+
+    for (;;) {
+        pthread_mutex_lock(&g_mock.lock);
+        while ((g_mock.head == g_mock.tail) && (g_mock.stop == HI_FALSE)) {
+            pthread_cond_wait(&g_mock.cond, &g_mock.lock);
+        }
+        if (g_mock.head == g_mock.tail) {
+            pthread_mutex_unlock(&g_mock.lock);
+            return HI_NULL;
+        }
+        chn = g_mock.fifo[g_mock.head % MOCK_JOB_MAX];
+        pthread_mutex_unlock(&g_mock.lock);
+
+        /* the user side may look at async_done from here on */
+        mock_isr(&g_mock.job[chn]);
+
+        pthread_mutex_lock(&g_mock.lock);
+        g_mock.head++;
+        pthread_mutex_unlock(&g_mock.lock);
+    }
+}
+
+/* virtual clock: raise the irq of the jobs finished by now */
+static hi_void mock_isr_run(hi_u64 now)
+{
+    hi_u32 i;
+
+    for (i = 0; i < MOCK_JOB_MAX; i++) {
+        if ((g_mock.job[i].busy == HI_TRUE) && (g_mock.job[i].done_at <= now)) {
+            mock_isr(&g_mock.job[i]);
+        }
+    }
+}
+
+/* earliest wake up of the user for a finished job, ~0 if none is running */
+static hi_u64 mock_next_wake(hi_void)
+{
+    hi_u64 wake = ~0ULL;
+    hi_u32 i;
+
+    for (i = 0; i < MOCK_JOB_MAX; i++) {
+        if ((g_mock.job[i].busy == HI_TRUE) && (g_mock.job[i].done_at + MODEL_IRQ_NS < wake)) {
+            wake = g_mock.job[i].done_at + MODEL_IRQ_NS;
+        }
+    }
+    return wake;
+}
+
+/* ******************************* user side ******************************* */
+#define LOAD_CHN_MAX            CIPHER_HARD_CHANNEL_CNT
+#define LOAD_BATCH_MAX          32
+#define LOAD_PKT_LEN            1500
+#define LOAD_PKT_CNT            100000
+#define RACE_ROUND              20000
+
+static hi_u32 g_id[LOAD_CHN_MAX];
+static hi_u32 g_id_cnt;
+
+static hi_void user_open(hi_u32 cnt)
+{
+    symc_cfg_t cfg;
+    hi_u32 i;
+
+    (hi_void)memset_s(&cfg, sizeof(cfg), 0, sizeof(cfg));
+    cfg.alg = HI_CIPHER_ALG_AES;
+    cfg.mode = HI_CIPHER_WORK_MODE_CBC;
+    cfg.width = HI_CIPHER_BIT_WIDTH_128BIT;
+    cfg.klen = HI_CIPHER_KEY_AES_128BIT;
+    cfg.ivlen = AES_IV_SIZE;
+
+    if (kapi_symc_init() != HI_SUCCESS) {
+        tool_check(0, "kapi_symc_init");
+    }
+    for (i = 0; i < cnt; i++) {
+        if (kapi_symc_create(&g_id[i]) != HI_SUCCESS) {
+            break;
+        }
+        cfg.id = g_id[i];
+        if (kapi_symc_cfg(&cfg) != HI_SUCCESS) {
+            break;
+        }
+    }
+    g_id_cnt = i;
+}
+
+static hi_void user_close(hi_void)
+{
+    hi_u32 i;
+
+    for (i = 0; i < g_id_cnt; i++) {
+        (hi_void)kapi_symc_destroy(g_id[i]);
+    }
+    g_id_cnt = 0;
+    (hi_void)kapi_symc_deinit();
+}
+
+static hi_void set_pkg(hi_cipher_data *pkg, hi_u32 *buf, hi_u32 len)
+{
+    pkg->src_phys_addr = (hi_phys_addr_t)(uintptr_t)buf;
+    pkg->dst_phys_addr = (hi_phys_addr_t)(uintptr_t)buf;
+    pkg->byte_len = len;
+    pkg->odd_key = HI_FALSE;
+}
+
+/* isr on another thread, the user collects what async_poll reports and checks what the isr wrote */
+static hi_void test_race(hi_void)
+{
+    static hi_u32 out[LOAD_CHN_MAX][LOAD_BATCH_MAX];
+    hi_cipher_data pkg[LOAD_BATCH_MAX];
+    hi_u32 seq[LOAD_CHN_MAX] = {0};
+    hi_u32 i, k, done, round = 0, collected = 0, stale = 0, bad = 0, err = 0, busy = 0;
+    hi_s32 result;
+
+    (hi_void)memset_s(&g_mock, sizeof(g_mock), 0, sizeof(g_mock));
+    g_mock.threaded = HI_TRUE;
+    pthread_mutex_init(&g_mock.lock, HI_NULL);
+    pthread_cond_init(&g_mock.cond, HI_NULL);
+    pthread_create(&g_mock.isr_thread, HI_NULL, mock_isr_thread, HI_NULL);
+
+    user_open(LOAD_CHN_MAX);
+    tool_check(g_id_cnt == LOAD_CHN_MAX, "race: all channels configured");
+
+    for (i = 0; i < g_id_cnt; i++) {
+        for (k = 0; k < LOAD_BATCH_MAX; k++) {
+            set_pkg(&pkg[k], &out[i][k], sizeof(out[i][k]));
+        }
+        if (kapi_symc_crypto_multi_async(g_id[i], pkg, LOAD_BATCH_MAX, SYMC_OPERATION_ENCRYPT) == HI_SUCCESS) {
+            seq[i] = ++round;
+        }
+    }
+    busy += (kapi_symc_crypto_multi_async(g_id[0], pkg, 1, SYMC_OPERATION_ENCRYPT) == HI_ERR_CIPHER_BUSY);
+
+    while (collected < RACE_ROUND) {
+        if (kapi_symc_async_poll() != HI_TRUE) {
+            sched_yield();
+            continue;
+        }
+        for (i = 0; i < g_id_cnt; i++) {
+            if (seq[i] == 0) {
+                continue;
+            }
+            if (kapi_symc_async_done(g_id[i], &done, &result) != HI_SUCCESS) {
+                bad++;
+                continue;
+            }
+            if (done != HI_TRUE) {
+                stale++;
+                continue;
+            }
+            /* async_done seen set: the output and async_ret of the isr must be visible too */
+            for (k = 0; k < LOAD_BATCH_MAX; k++) {
+                bad += (out[i][k] != seq[i]);
+            }
+            err += (result != ((seq[i] % MOCK_FAIL_EVERY == 0) ? HI_ERR_CIPHER_TIMEOUT : HI_SUCCESS));
+            collected++;
+            seq[i] = 0;
+            for (k = 0; k < LOAD_BATCH_MAX; k++) {
+                set_pkg(&pkg[k], &out[i][k], sizeof(out[i][k]));
+            }
+            if (kapi_symc_crypto_multi_async(g_id[i], pkg, LOAD_BATCH_MAX, SYMC_OPERATION_ENCRYPT) == HI_SUCCESS) {
+                seq[i] = ++round;
+            }
+        }
+    }
+
+    user_close();
+    pthread_mutex_lock(&g_mock.lock);
+    g_mock.stop = HI_TRUE;
+    pthread_cond_signal(&g_mock.cond);
+    pthread_mutex_unlock(&g_mock.lock);
+    pthread_join(g_mock.isr_thread, HI_NULL);
+
+    printf("race: %u batches collected, %u polled channels not done yet, %u reaped by destroy\n",
+        collected, stale, g_mock.waitdone_busy);
+    tool_check(busy == 1, "race: second async crypto on a pending handle is busy");
+    tool_check(bad == 0, "race: output of the isr visible once async_done is seen");
+    tool_check(err == 0, "race: async_ret of the isr returned with the job");
+    pthread_mutex_destroy(&g_mock.lock);
+    pthread_cond_destroy(&g_mock.cond);
+}
+
+/* ************************* virtual clock load ************************* */
+typedef struct {
+    hi_u64 pps;                             /* packets per second finished */
+    hi_u64 p50, p99, p999;                  /* latency, ns */
+    hi_u32 lost;                            /* packets of the batches failed by injection */
+    hi_u32 bad;                             /* packets failed otherwise */
+} load_result;
+
+static hi_u64 g_arrival[LOAD_PKT_CNT];
+static hi_u64 g_latency[LOAD_PKT_CNT];
+static hi_u32 g_buf[LOAD_PKT_CNT];
+
+/* Poisson arrivals, a fixed seed makes the runs comparable */
+static hi_void load_arrivals(hi_u64 rate)
+{
+    hi_u64 t = 0;
+    hi_u32 i;
+
+    srand(1);
+    for (i = 0; i < LOAD_PKT_CNT; i++) {
+        t += (hi_u64)(-log((rand() + 1.0) / ((double)RAND_MAX + 2.0)) * 1e9 / (double)rate);
+        g_arrival[i] = t;
+    }
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    hi_u64 x = *(const hi_u64 *)a;
+    hi_u64 y = *(const hi_u64 *)b;
+
+    return (x > y) - (x < y);
+}
+
+static hi_void load_stat(load_result *res, hi_u32 cnt, hi_u64 first, hi_u64 last)
+{
+    res->pps = (last > first) ? (hi_u64)cnt * 1000000000ULL / (last - first) : 0;    /* 1000000000: ns per s */
+    qsort(g_latency, cnt, sizeof(g_latency[0]), cmp_u64);
+    res->p50 = cnt ? g_latency[cnt / 2] : 0;                /* 2: median */
+    res->p99 = cnt ? g_latency[cnt * 99 / 100] : 0;         /* 99, 100: percentile */
+    res->p999 = cnt ? g_latency[cnt * 999 / 1000] : 0;      /* 999, 1000: percentile */
+}
+
+/* one packet per ioctl on one handle, the caller sleeps until the irq */
+static hi_void load_sync(load_result *res)
+{
+    hi_cipher_data pkg;
+    hi_u32 i, cnt = 0;
+
+    user_open(1);
+    for (i = 0; i < LOAD_PKT_CNT; i++) {
+        if (g_mock.now < g_arrival[i]) {
+            g_mock.now = g_arrival[i];
+        }
+        g_mock.now += MODEL_SYSCALL_NS;
+        set_pkg(&pkg, &g_buf[i], LOAD_PKT_LEN);
+        if (kapi_symc_crypto_multi(g_id[0], &pkg, 1, SYMC_OPERATION_ENCRYPT, HI_TRUE) != HI_SUCCESS) {
+            res->bad++;
+            continue;
+        }
+        g_latency[cnt++] = g_mock.now - g_arrival[i];
+    }
+    user_close();
+    load_stat(res, cnt, g_arrival[0], g_mock.now);
+}
+
+/* the queued packets go in one batch to each idle handle, poll wakes the caller on the first irq */
+static hi_void load_async(load_result *res, hi_u32 chn_cnt)
+{
+    static hi_cipher_data pkg[LOAD_BATCH_MAX];
+    hi_u32 first[LOAD_CHN_MAX], num[LOAD_CHN_MAX] = {0};
+    hi_u32 i, k, n, done, next = 0, cnt = 0;
+    hi_u64 wake;
+    hi_s32 result;
+
+    user_open(chn_cnt);
+    chn_cnt = g_id_cnt;
+    while (cnt + res->lost + res->bad < LOAD_PKT_CNT) {
+        for (i = 0; i < chn_cnt && next < LOAD_PKT_CNT && g_arrival[next] <= g_mock.now; i++) {
+            if (num[i] != 0) {
+                continue;
+            }
+            for (n = 0; n < LOAD_BATCH_MAX && next + n < LOAD_PKT_CNT && g_arrival[next + n] <= g_mock.now; n++) {
+                set_pkg(&pkg[n], &g_buf[next + n], LOAD_PKT_LEN);
+            }
+            g_mock.now += MODEL_SYSCALL_NS;
+            if (kapi_symc_crypto_multi_async(g_id[i], pkg, n, SYMC_OPERATION_ENCRYPT) != HI_SUCCESS) {
+                res->bad += n;
+                next += n;
+                continue;
+            }
+            first[i] = next;
+            num[i] = n;
+            next += n;
+        }
+
+        /* sleep in poll until the first irq, or the next packet if a handle is idle */
+        wake = mock_next_wake();
+        for (i = 0; i < chn_cnt && next < LOAD_PKT_CNT; i++) {
+            if ((num[i] == 0) && (g_arrival[next] < wake)) {
+                wake = (g_arrival[next] > g_mock.now) ? g_arrival[next] : g_mock.now;
+                break;
+            }
+        }
+        if (wake > g_mock.now) {
+            g_mock.now = wake;
+        }
+        mock_isr_run(g_mock.now - MODEL_IRQ_NS);
+        if (kapi_symc_async_poll() != HI_TRUE) {
+            continue;
+        }
+
+        for (i = 0; i < chn_cnt; i++) {
+            if (num[i] == 0) {
+                continue;
+            }
+            g_mock.now += MODEL_SYSCALL_NS;
+            if ((kapi_symc_async_done(g_id[i], &done, &result) != HI_SUCCESS) || (done != HI_TRUE)) {
+                continue;
+            }
+            for (k = first[i]; k < first[i] + num[i]; k++) {
+                if (result == HI_SUCCESS) {
+                    g_latency[cnt++] = g_mock.now - g_arrival[k];
+                } else if (result == HI_ERR_CIPHER_TIMEOUT) {
+                    res->lost++;
+                } else {
+                    res->bad++;
+                }
+            }
+            num[i] = 0;
+        }
+    }
+    user_close();
+    load_stat(res, cnt, g_arrival[0], g_mock.now);
+}
+
+static hi_void load_print(const char *name, hi_u64 rate, const load_result *res)
+{
+    printf("%-10s %8llu %10llu %10.1f %10.1f %10.1f %6u\n", name, rate, res->pps,
+        res->p50 / 1000.0, res->p99 / 1000.0, res->p999 / 1000.0, res->lost + res->bad);    /* 1000.0: ns to us */
+}
+
+static hi_void test_load(hi_void)
+{
+    static const hi_u64 rate[] = { 20000, 60000, 100000, 140000 };
+    load_result sync_res, async_res;
+    hi_u32 i;
+
+    printf("load: %u packets of %u bytes, engine %llu ns + %llu ps/byte, irq %llu ns, ioctl %llu ns\n",
+        LOAD_PKT_CNT, LOAD_PKT_LEN, MODEL_SETUP_NS, MODEL_PS_PER_BYTE, MODEL_IRQ_NS, MODEL_SYSCALL_NS);
+    printf("%-10s %8s %10s %10s %10s %10s %6s\n", "mode", "offered", "pkt/s", "p50 us", "p99 us", "p99.9 us",
+        "error");
+    for (i = 0; i < sizeof(rate) / sizeof(rate[0]); i++) {
+        load_arrivals(rate[i]);
+
+        (hi_void)memset_s(&g_mock, sizeof(g_mock), 0, sizeof(g_mock));
+        (hi_void)memset_s(&sync_res, sizeof(sync_res), 0, sizeof(sync_res));
+        load_sync(&sync_res);
+        load_print("sync", rate[i], &sync_res);
+
+        (hi_void)memset_s(&g_mock, sizeof(g_mock), 0, sizeof(g_mock));
+        (hi_void)memset_s(&async_res, sizeof(async_res), 0, sizeof(async_res));
+        load_async(&async_res, LOAD_CHN_MAX);
+        load_print("async", rate[i], &async_res);
+
+        tool_check(sync_res.bad == 0, "load: sync packets all done");
+        tool_check(async_res.bad == 0, "load: async packets done or failed by injection only");
+        tool_check(g_mock.waitdone_busy == 0, "load: async_done reaps only after the isr");
+        if (i == sizeof(rate) / sizeof(rate[0]) - 1) {
+            tool_check(async_res.pps > sync_res.pps, "load: async batches beat sync ioctls at saturation");
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    g_cipher_host_log = HI_FALSE;
+
+    test_race();
+    test_load();
+
+    if (g_fail != 0) {
+        printf("%u check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
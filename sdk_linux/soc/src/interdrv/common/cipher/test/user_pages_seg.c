@@ -0,0 +1,478 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host test of the zero copy path of user buffers: crypto_user_pages_pin,
+ * _seg, _flush and _unpin of osal/drv_osal_sys_linux.c and the node list
+ * kapi_symc_user_sg_nodes of kapi_symc.c builds from them, run against a fake
+ * page table (host_inc/linux/mm.h). For seeded random buffers, with random
+ * offsets, lengths and runs of physically contiguous pages, in place or not,
+ * it checks that:
+ * - every byte of a node maps to the physical address of the user byte;
+ * - no node could be merged with the next one, and there are at most as many
+ *   nodes as pinned pages, the size of the list kapi allocates;
+ * - the flush covers the buffer once;
+ * - pages are pinned with FOLL_PIN (get_user_pages_fast before 5.6, built as
+ *   user_pages_seg_4_9), the output pages are dirtied, and every pin is
+ *   dropped, also when a page can't be pinned.
+ */
+
+#include "cipher_host.h"
+#include "../src/drv/cipher_v1.0/osal/drv_osal_sys_linux.c"
+#include "../src/drv/cipher_v1.0/drivers/kapi_symc.c"
+
+#define tool_check(cond, name) \
+    do { \
+        if (cond) { \
+            printf("ok   %s\n", name); \
+        } else { \
+            printf("FAIL %s\n", name); \
+            g_fail++; \
+        } \
+    } while (0)
+
+#define HOST_USER_BASE      0x10000000UL
+#define HOST_PHYS_BASE      0x80000000UL
+#define HOST_PAGE_MAX       96
+#define HOST_RUNS           4000
+#define HOST_BUF_PAGES_MAX  24
+#define HOST_SEED           20211123
+
+static hi_u32 g_fail = 0;
+
+struct task_struct g_host_task;
+
+static struct {
+    struct page page[HOST_PAGE_MAX];    /* page i is mapped at HOST_USER_BASE + i * PAGE_SIZE */
+    hi_u32 mapped;                      /* pages from here on are not mapped */
+    hi_u32 read_only;                   /* pages from here on can't be pinned for write */
+    hi_u32 gup_flags;                   /* flags of the last pin */
+    unsigned long flushed;
+    hi_u32 seed;
+} g_host;
+
+/* ***************************** fake page table ***************************** */
+static struct page *host_user_page(unsigned long addr, unsigned int gup_flags)
+{
+    hi_u32 idx = (addr - HOST_USER_BASE) >> PAGE_SHIFT;
+
+    if ((addr < HOST_USER_BASE) || (idx >= g_host.mapped)) {
+        return HI_NULL;
+    }
+    if (((gup_flags & FOLL_WRITE) != 0) && (idx >= g_host.read_only)) {
+        return HI_NULL;
+    }
+    return &g_host.page[idx];
+}
+
+static int host_gup(unsigned long start, int nr_pages, unsigned int gup_flags, struct page **pages, hi_bool pin)
+{
+    int i;
+    struct page *page = HI_NULL;
+
+    g_host.gup_flags = gup_flags;
+    for (i = 0; i < nr_pages; i++) {
+        page = host_user_page(start + (unsigned long)i * PAGE_SIZE, gup_flags);
+        if (page == HI_NULL) {
+            break;
+        }
+        if (pin) {
+            page->pin++;
+        } else {
+            page->ref++;
+        }
+        pages[i] = page;
+    }
+    return (i == 0) ? -14 : i; /* 14: EFAULT */
+}
+
+int pin_user_pages_fast(unsigned long start, int nr_pages, unsigned int gup_flags, struct page **pages)
+{
+    return host_gup(start, nr_pages, gup_flags, pages, HI_TRUE);
+}
+
+void unpin_user_pages_dirty_lock(struct page **pages, unsigned long npages, bool make_dirty)
+{
+    unsigned long i;
+
+    for (i = 0; i < npages; i++) {
+        pages[i]->dirty += make_dirty;
+        pages[i]->pin--;
+    }
+}
+
+int get_user_pages_fast(unsigned long start, int nr_pages, unsigned int gup_flags, struct page **pages)
+{
+    return host_gup(start, nr_pages, gup_flags, pages, HI_FALSE);
+}
+
+void put_page(struct page *page)
+{
+    page->ref--;
+}
+
+int set_page_dirty_lock(struct page *page)
+{
+    page->dirty++;
+    return 0;
+}
+
+void *kmap(struct page *page)
+{
+    return (void *)(uintptr_t)page->phys;
+}
+
+void kunmap(struct page *page)
+{
+}
+
+void __cpuc_flush_dcache_area(void *addr, size_t size)
+{
+    g_host.flushed += size;
+}
+
+void __flush_dcache_area(void *addr, size_t len)
+{
+    g_host.flushed += len;
+}
+
+/* ******************* stubs of what the user page path doesn't reach ******************* */
+hi_void *crypto_calloc(size_t n, size_t size)
+{
+    return calloc(n, size);
+}
+
+struct vm_area_struct *find_vma(struct mm_struct *mm, unsigned long addr)
+{
+    return HI_NULL;
+}
+
+int follow_pfn(struct vm_area_struct *vma, unsigned long address, unsigned long *pfn)
+{
+    return -1;
+}
+
+int dma_set_coherent_mask(struct device *dev, unsigned long long mask)
+{
+    return -1;
+}
+
+void *dma_alloc_coherent(struct device *dev, size_t size, dma_addr_t *dma_handle, int gfp)
+{
+    return HI_NULL;
+}
+
+void dma_free_coherent(struct device *dev, size_t size, void *cpu_addr, dma_addr_t dma_handle)
+{
+}
+
+void *kzalloc(size_t size, int gfp)
+{
+    return HI_NULL;
+}
+
+void kfree(const void *ptr)
+{
+}
+
+unsigned long virt_to_phys(const volatile void *address)
+{
+    return 0;
+}
+
+void *phys_to_virt(unsigned long long address)
+{
+    return HI_NULL;
+}
+
+unsigned long copy_from_user(void *to, const void *from, unsigned long n)
+{
+    return n;
+}
+
+unsigned long copy_to_user(void *to, const void *from, unsigned long n)
+{
+    return n;
+}
+
+hi_void *cipher_get_device(hi_void)
+{
+    return HI_NULL;
+}
+
+hi_u32 module_get_secure(hi_void)
+{
+    return 0;
+}
+
+hil_mmb_t *hil_mmb_getby_phys_2(unsigned long addr, unsigned long *out_offset)
+{
+    return HI_NULL;
+}
+
+int hil_map_mmz_check_phys(unsigned long addr_start, unsigned long addr_len)
+{
+    return -1;
+}
+
+hi_s32 cryp_symc_init(hi_void)
+{
+    return HI_FAILURE;
+}
+
+hi_void cryp_symc_deinit(hi_void)
+{
+}
+
+hi_s32 cryp_symc_alloc_chn(hi_u32 *hard_chn)
+{
+    return HI_FAILURE;
+}
+
+hi_void cryp_symc_free_chn(hi_u32 hard_chn)
+{
+}
+
+symc_func *cryp_get_symc_op(hi_cipher_alg alg, hi_cipher_work_mode mode)
+{
+    return HI_NULL;
+}
+
+hi_s32 klad_load_hard_key(hi_u32 handle, hi_u32 ca_type, const hi_u8 *key, hi_u32 key_len)
+{
+    return HI_FAILURE;
+}
+
+hi_s32 klad_encrypt_key(hi_u32 keysel, hi_u32 target, hi_u8 *clear, hi_u8 *encrypt, hi_u32 key_len)
+{
+    return HI_FAILURE;
+}
+
+/* ********************************** checks ********************************** */
+static hi_u32 host_rand(hi_u32 n)
+{
+    g_host.seed = g_host.seed * 1103515245 + 12345; /* LCG */
+    return (g_host.seed >> 16) % n;
+}
+
+/* runs of physically contiguous pages, a run never continues into the next one */
+static hi_void host_layout(hi_void)
+{
+    hi_u32 i;
+    unsigned long next = HOST_PHYS_BASE;
+
+    for (i = 0; i < HOST_PAGE_MAX; i++) {
+        if ((i == 0) || (host_rand(3) == 0)) { /* 3: a new run every third page on average */
+            next += PAGE_SIZE * (1 + host_rand(8)); /* 8: gap of up to 8 pages */
+        }
+        (hi_void)memset_s(&g_host.page[i], sizeof(struct page), 0, sizeof(struct page));
+        g_host.page[i].phys = next;
+        next += PAGE_SIZE;
+    }
+    g_host.mapped = HOST_PAGE_MAX;
+    g_host.read_only = HOST_PAGE_MAX;
+}
+
+static unsigned long host_phys_of(unsigned long addr)
+{
+    return g_host.page[(addr - HOST_USER_BASE) >> PAGE_SHIFT].phys + (addr & ~PAGE_MASK);
+}
+
+/* every byte of the node maps to the user byte: checked where a page of either side begins and at the ends */
+static hi_bool host_node_ok(unsigned long in, unsigned long out, hi_u32 pos, const symc_multi_pack *pack, hi_u32 n)
+{
+    hi_u32 k;
+    hi_u32 len = pack->len[n];
+
+    if (len == 0) {
+        return HI_FALSE;
+    }
+    for (k = 0; k < len; k++) {
+        if ((k != 0) && (k != len - 1) && (((in + pos + k) & ~PAGE_MASK) != 0) &&
+            (((out + pos + k) & ~PAGE_MASK) != 0)) {
+            continue;
+        }
+        if ((host_phys_of(in + pos + k) != addr_u64(pack->in[n]) + k) ||
+            (host_phys_of(out + pos + k) != addr_u64(pack->out[n]) + k)) {
+            return HI_FALSE;
+        }
+    }
+    return HI_TRUE;
+}
+
+static hi_bool host_pins_clear(hi_void)
+{
+    hi_u32 i;
+
+    for (i = 0; i < HOST_PAGE_MAX; i++) {
+        if ((g_host.page[i].pin != 0) || (g_host.page[i].ref != 0)) {
+            return HI_FALSE;
+        }
+    }
+    return HI_TRUE;
+}
+
+static hi_bool host_dirty_ok(unsigned long out, hi_u32 len)
+{
+    hi_u32 i;
+    hi_u32 first = (out - HOST_USER_BASE) >> PAGE_SHIFT;
+    hi_u32 last = (out + len - 1 - HOST_USER_BASE) >> PAGE_SHIFT;
+
+    for (i = 0; i < HOST_PAGE_MAX; i++) {
+        if ((g_host.page[i].dirty != 0) != ((i >= first) && (i <= last))) {
+            return HI_FALSE;
+        }
+    }
+    return HI_TRUE;
+}
+
+typedef struct {
+    hi_u32 runs;
+    hi_u32 pin_fail;
+    hi_u32 node_fail;
+    hi_u32 merge_fail;
+    hi_u32 count_fail;
+    hi_u32 flush_fail;
+    hi_u32 unpin_fail;
+    hi_u32 nodes;
+    hi_u32 pages;
+} host_stat;
+
+static hi_void host_run(unsigned long in, unsigned long out, hi_u32 len, host_stat *st)
+{
+    crypto_user_pages uin, uout;
+    symc_multi_pack pack;
+    hi_u8 *buf = HI_NULL;
+    hi_u32 num, n, pos;
+
+    st->runs++;
+    host_layout();
+    if (crypto_user_pages_pin(&uin, (hi_void *)(uintptr_t)in, len, HI_FALSE) != HI_SUCCESS) {
+        st->pin_fail++;
+        return;
+    }
+    if (crypto_user_pages_pin(&uout, (hi_void *)(uintptr_t)out, len, HI_TRUE) != HI_SUCCESS) {
+        crypto_user_pages_unpin(&uin);
+        st->pin_fail++;
+        return;
+    }
+
+    /* sized as kapi_symc_crypto_user_start does */
+    num = uin.page_num + uout.page_num;
+    buf = calloc(num, sizeof(compat_addr) * 2 + sizeof(symc_node_usage) + sizeof(hi_u32)); /* 2: in and out */
+    (hi_void)memset_s(&pack, sizeof(pack), 0, sizeof(pack));
+    pack.num = num;
+    kapi_symc_multi_pack_set_mem(&pack, buf, 0);
+    kapi_symc_user_sg_nodes(&uin, &uout, len, &pack);
+
+    st->count_fail += (pack.num == 0) || (pack.num > num);
+    for (n = 0, pos = 0; (n < pack.num) && (pack.num <= num); pos += pack.len[n], n++) {
+        st->node_fail += !host_node_ok(in, out, pos, &pack, n);
+        if (n + 1 < pack.num) {
+            st->merge_fail += (addr_u64(pack.in[n + 1]) == addr_u64(pack.in[n]) + pack.len[n]) &&
+                (addr_u64(pack.out[n + 1]) == addr_u64(pack.out[n]) + pack.len[n]);
+        }
+    }
+    st->count_fail += (pos != len);
+    st->nodes += pack.num;
+    st->pages += num;
+
+    g_host.flushed = 0;
+    crypto_user_pages_flush(&uin);
+    crypto_user_pages_flush(&uout);
+    st->flush_fail += (g_host.flushed != 2 * (unsigned long)len); /* 2: in and out */
+
+    crypto_user_pages_unpin(&uout);
+    crypto_user_pages_unpin(&uin);
+    st->unpin_fail += !host_pins_clear() || !host_dirty_ok(out, len);
+    free(buf);
+}
+
+static hi_void test_random(hi_void)
+{
+    host_stat st;
+    hi_u32 i, len;
+    unsigned long in, out;
+
+    (hi_void)memset_s(&st, sizeof(st), 0, sizeof(st));
+    for (i = 0; i < HOST_RUNS; i++) {
+        /* 4: one run in four is aes aligned, the path kapi takes; 5: one in five in place */
+        hi_u32 align = (host_rand(4) == 0) ? AES_BLOCK_SIZE : 1;
+        len = 1 + host_rand(HOST_BUF_PAGES_MAX * PAGE_SIZE);
+        len = (len + align - 1) / align * align;
+        in = HOST_USER_BASE + host_rand(HOST_PAGE_MAX / 2 * PAGE_SIZE) / align * align;
+        out = (host_rand(5) == 0) ? in :
+            HOST_USER_BASE + (HOST_PAGE_MAX / 2 * PAGE_SIZE) + host_rand(HOST_PAGE_MAX / 4 * PAGE_SIZE) / align * align;
+        host_run(in, out, len, &st);
+    }
+    printf("%u buffers, %u nodes for %u pinned pages\n", st.runs, st.nodes, st.pages);
+    tool_check(st.pin_fail == 0, "pin mapped buffers");
+    tool_check(st.node_fail == 0, "every node byte maps to its user byte");
+    tool_check(st.merge_fail == 0, "no node mergeable with the next one");
+    tool_check(st.count_fail == 0, "nodes cover the buffer, at most one per pinned page");
+    tool_check(st.flush_fail == 0, "flush covers the buffer once");
+    tool_check(st.unpin_fail == 0, "every pin dropped, output pages dirtied");
+}
+
+static hi_void test_pin(hi_void)
+{
+    crypto_user_pages up;
+    hi_void *buf = (hi_void *)(HOST_USER_BASE + PAGE_SIZE - 16); /* 16: crosses into the second page */
+
+    host_layout();
+    tool_check(crypto_user_pages_pin(&up, buf, 32, HI_TRUE) == HI_SUCCESS, "pin across a page"); /* 32: 2 pages */
+    tool_check((up.page_num == 2) && (up.offset == PAGE_SIZE - 16), "page count and offset"); /* 2, 16: as above */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
+    tool_check((g_host.page[0].pin == 1) && (g_host.page[1].pin == 1) && (g_host.page[0].ref == 0),
+        "pages pinned with FOLL_PIN");
+#else
+    tool_check((g_host.page[0].ref == 1) && (g_host.page[1].ref == 1), "pages referenced by get_user_pages");
+#endif
+    tool_check(g_host.gup_flags == FOLL_WRITE, "output pinned for write");
+    crypto_user_pages_unpin(&up);
+    tool_check(host_pins_clear() && (g_host.page[0].dirty == 1) && (g_host.page[1].dirty == 1),
+        "unpin dirties the output");
+
+    g_host.mapped = 3; /* 3: the fourth page is not mapped */
+    tool_check(crypto_user_pages_pin(&up, (hi_void *)HOST_USER_BASE, 4 * PAGE_SIZE, HI_FALSE) != HI_SUCCESS,
+        "pin of an unmapped page fails");
+    tool_check(host_pins_clear() && (up.page_num == 0), "partial pin dropped");
+
+    host_layout();
+    g_host.read_only = 1;
+    tool_check(crypto_user_pages_pin(&up, (hi_void *)HOST_USER_BASE, 2 * PAGE_SIZE, HI_FALSE) == HI_SUCCESS,
+        "read-only input pinned");
+    crypto_user_pages_unpin(&up);
+    tool_check(crypto_user_pages_pin(&up, (hi_void *)HOST_USER_BASE, 2 * PAGE_SIZE, HI_TRUE) != HI_SUCCESS,
+        "read-only output refused");
+    tool_check(host_pins_clear() && (g_host.page[0].dirty == 0), "refused output left clean");
+}
+
+int main(hi_void)
+{
+    g_host.seed = HOST_SEED;
+    test_pin();
+    test_random();
+
+    if (g_fail != 0) {
+        printf("%u check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
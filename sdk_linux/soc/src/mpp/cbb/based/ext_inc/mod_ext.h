@@ -74,6 +74,8 @@ extern hi_s32 cmpi_init_modules(hi_void);
 extern hi_void cmpi_exit_modules(hi_void);
 extern hi_s32 cmpi_register_module(umap_module *modules);
 extern hi_void cmpi_unregister_module(hi_mod_id mod_id);
+extern hi_void cmpi_log_track_module(hi_mod_id mod_id);
+extern hi_void cmpi_log_forget_module(hi_mod_id mod_id);
 
 #define func_entry(type, id) ((type *)cmpi_get_module_func_by_id(id))
 #define check_func_entry(id) (cmpi_get_module_func_by_id(id) != NULL)
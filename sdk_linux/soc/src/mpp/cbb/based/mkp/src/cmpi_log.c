@@ -124,6 +124,551 @@ static inline hi_u64 log_get_time(hi_void)
     return time.tv_sec * 1000000LLU + time.tv_usec;
 }
 
+/*
+ * Binary log mode: every cpu owns a ring of fixed size records. A writer
+ * reserves a slot and stores the format pointer, the raw arguments and a
+ * timestamp; nothing is formatted. The ring's own lock is held with irqs off
+ * while a slot is filled, so a preempted or interrupted writer can't leave a
+ * half written slot that another writer laps; it is only contended when the
+ * writer migrated. So the mode is not lock-free: it trades the global lock
+ * held around vsnprintf for a per-cpu one held around a copy of the
+ * arguments. log_read formats the records and merges the rings by timestamp.
+ *
+ * A record keeps the format pointer until it is read, which assumes that fmt
+ * is a string constant of the module registered as mod_id, or of base, which
+ * outlives every module. HI_TRACE from the module itself does that. mod_gen[]
+ * is odd while mod_id is registered: records of a module that is not
+ * registered are formatted right away, and cmpi_log_forget_module() bumps the
+ * generation under the reader's lock, so a record of an unloaded module is
+ * dropped and never formatted while the module goes away.
+ */
+#define LOG_BIN_MAX_CPUS  8
+#define LOG_BIN_MAX_ARGS  8
+#define LOG_BIN_STR_LEN   64 /* inline bytes shared by the %s arguments of one record */
+#define LOG_BIN_SPEC_LEN  16 /* longest conversion spec kept, e.g. "%-08llx" */
+#define LOG_BIN_MIN_SLOTS 16
+
+#define LOG_BIN_FLAG_TEXT 0x1 /* fmt could not be captured, text holds the formatted line */
+
+typedef enum {
+    LOG_BIN_ARG_INT = 0,
+    LOG_BIN_ARG_LONG,
+    LOG_BIN_ARG_LLONG,
+    LOG_BIN_ARG_PTR,
+    LOG_BIN_ARG_STR,
+} log_bin_arg_type;
+
+typedef struct {
+    hi_u32 seq; /* ring position + 1 once committed, 0 while it is written */
+    hi_u32 flags;
+    hi_s32 level;
+    hi_u32 mod_id;
+    hi_u32 mod_gen; /* g_log_bin.mod_gen[mod_id] when the record was written, odd if fmt is kept */
+    hi_u32 argc;
+    hi_u64 time; /* unit is ns */
+    const hi_char *fmt;
+    union {
+        struct {
+            hi_u64 args[LOG_BIN_MAX_ARGS];
+            hi_char str[LOG_BIN_STR_LEN];
+        } bin;
+        hi_char text[LOG_BIN_MAX_ARGS * sizeof(hi_u64) + LOG_BIN_STR_LEN];
+    } u;
+} log_bin_record;
+
+typedef struct {
+    osal_spinlock_t lock; /* serializes the writers of the ring */
+    osal_atomic_t head; /* next position to reserve */
+    hi_u32 tail; /* next position to read, reader only */
+    hi_u32 mask; /* slot number - 1 */
+    hi_u32 dropped; /* records overwritten before they were read */
+    log_bin_record *rec;
+    log_bin_record pending; /* oldest unread record, copied out by the reader */
+    hi_bool has_pending;
+} log_bin_ring;
+
+typedef struct {
+    hi_bool enable;
+    hi_bool sleeping; /* reader is waiting, writers have to wake it up */
+    hi_u32 ring_num;
+    log_bin_ring ring[LOG_BIN_MAX_CPUS];
+    hi_u32 mod_gen[HI_ID_BUTT + 1]; /* odd while the module is registered */
+    osal_mutex_t lock; /* serializes readers, the ring allocation and mod_gen[] updates */
+    hi_char line[LOG_MAX_ITEMLEN];
+    hi_u32 line_len;
+    hi_u32 line_pos;
+} log_bin_ctx;
+
+static log_bin_ctx g_log_bin = {0};
+
+/*
+ * Parse one conversion spec, p points behind the '%'. Return the character
+ * behind the spec, or NULL when the spec can not be replayed later (for
+ * example '*' widths, "%n" or the "%p" extensions which dereference the
+ * argument).
+ */
+static const hi_char *log_bin_parse_spec(const hi_char *p, log_bin_arg_type *type)
+{
+    hi_u32 lng = 0;
+
+    while ((*p == '-') || (*p == '+') || (*p == ' ') || (*p == '#') || (*p == '0')) {
+        p++;
+    }
+    while (((*p >= '0') && (*p <= '9')) || (*p == '.')) {
+        p++;
+    }
+    while ((*p == 'h') || (*p == 'l') || (*p == 'z') || (*p == 't') || (*p == 'j')) {
+        lng = (*p == 'l') ? (lng + 1) : ((*p == 'j') ? 2 : ((*p == 'h') ? lng : 1)); /* 2: long long */
+        p++;
+    }
+
+    switch (*p) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            *type = (lng == 0) ? LOG_BIN_ARG_INT : ((lng == 1) ? LOG_BIN_ARG_LONG : LOG_BIN_ARG_LLONG);
+            break;
+        case 's':
+            *type = LOG_BIN_ARG_STR;
+            break;
+        case 'p':
+            if (((p[1] >= 'a') && (p[1] <= 'z')) || ((p[1] >= 'A') && (p[1] <= 'Z'))) {
+                return HI_NULL;
+            }
+            *type = LOG_BIN_ARG_PTR;
+            break;
+        default:
+            return HI_NULL;
+    }
+    return p + 1;
+}
+
+static hi_s32 log_bin_scan(const hi_char *fmt, log_bin_arg_type *types, hi_u32 *argc)
+{
+    const hi_char *p = fmt;
+    hi_u32 n = 0;
+
+    while (*p != '\0') {
+        if (*p++ != '%') {
+            continue;
+        }
+        if (*p == '%') {
+            p++;
+            continue;
+        }
+        if (n >= LOG_BIN_MAX_ARGS) {
+            return HI_FAILURE;
+        }
+        p = log_bin_parse_spec(p, &types[n]);
+        if (p == HI_NULL) {
+            return HI_FAILURE;
+        }
+        n++;
+    }
+    *argc = n;
+    return HI_SUCCESS;
+}
+
+static hi_void log_bin_capture(log_bin_record *rec, const log_bin_arg_type *types, osal_va_list args)
+{
+    hi_u32 i;
+    hi_u32 str_pos = 0;
+    const hi_char *s = HI_NULL;
+
+    for (i = 0; i < rec->argc; i++) {
+        switch (types[i]) {
+            case LOG_BIN_ARG_INT:
+                rec->u.bin.args[i] = (hi_u64)(hi_u32)osal_va_arg(args, hi_s32);
+                break;
+            case LOG_BIN_ARG_LONG:
+                rec->u.bin.args[i] = (hi_u64)(unsigned long)osal_va_arg(args, long);
+                break;
+            case LOG_BIN_ARG_LLONG:
+                rec->u.bin.args[i] = (hi_u64)osal_va_arg(args, long long);
+                break;
+            case LOG_BIN_ARG_PTR:
+                rec->u.bin.args[i] = (hi_u64)(hi_uintptr_t)osal_va_arg(args, hi_void *);
+                break;
+            default:
+                /* strings may live on the caller's stack, so copy them, truncated if needed */
+                s = osal_va_arg(args, const hi_char *);
+                rec->u.bin.args[i] = str_pos;
+                if (str_pos >= LOG_BIN_STR_LEN - 1) {
+                    rec->u.bin.args[i] = LOG_BIN_STR_LEN - 1;
+                    break;
+                }
+                s = (s == HI_NULL) ? "(null)" : s;
+                while ((*s != '\0') && (str_pos < LOG_BIN_STR_LEN - 2)) { /* 2: keep room for two '\0' */
+                    rec->u.bin.str[str_pos++] = *s++;
+                }
+                rec->u.bin.str[str_pos++] = '\0';
+                break;
+        }
+    }
+    rec->u.bin.str[LOG_BIN_STR_LEN - 1] = '\0';
+}
+
+static hi_s32 log_bin_write(hi_s32 level, hi_mod_id mod_id, const char *fmt, osal_va_list args)
+{
+    log_bin_ring *ring = &g_log_bin.ring[osal_get_cpu_id() % g_log_bin.ring_num];
+    log_bin_arg_type types[LOG_BIN_MAX_ARGS];
+    log_bin_record *rec = HI_NULL;
+    unsigned long lock_flag;
+    hi_u32 pos;
+    hi_s32 len;
+
+    osal_spin_lock_irqsave(&ring->lock, &lock_flag);
+    pos = (hi_u32)osal_atomic_inc_return(&ring->head) - 1;
+    rec = &ring->rec[pos & ring->mask];
+
+    rec->seq = 0;
+    osal_smp_wmb();
+
+    rec->time = osal_sched_clock();
+    rec->level = level;
+    rec->mod_id = mod_id;
+    rec->mod_gen = g_log_bin.mod_gen[mod_id];
+    rec->fmt = fmt;
+    if (((rec->mod_gen & 1) != 0) && (log_bin_scan(fmt, types, &rec->argc) == HI_SUCCESS)) {
+        rec->flags = 0;
+        log_bin_capture(rec, types, args);
+        len = sizeof(*rec);
+    } else {
+        /* rare formats and unregistered modules are printed right away, but only into this cpu's slot */
+        rec->flags = LOG_BIN_FLAG_TEXT;
+        len = vsnprintf_s(rec->u.text, sizeof(rec->u.text), sizeof(rec->u.text) - 1, fmt, args);
+        if (len < 0) {
+            len = 0;
+            rec->u.text[sizeof(rec->u.text) - 1] = '\0';
+        }
+    }
+
+    osal_smp_wmb();
+    rec->seq = pos + 1;
+    osal_spin_unlock_irqrestore(&ring->lock, &lock_flag);
+
+    /* pairs with the barrier in log_bin_wait_condition */
+    osal_smp_mb();
+    if (g_log_bin.sleeping) {
+        osal_wakeup(&(g_log_buf.block_wait));
+    }
+    return len;
+}
+
+/* copy the oldest committed record of ring into ring->pending */
+static hi_bool log_bin_peek(log_bin_ring *ring)
+{
+    hi_u32 slots = ring->mask + 1;
+    hi_u32 head;
+    hi_u32 seq;
+    log_bin_record *rec = HI_NULL;
+
+    while (!ring->has_pending) {
+        head = (hi_u32)osal_atomic_read(&ring->head);
+        if (head == ring->tail) {
+            return HI_FALSE;
+        }
+        if (head - ring->tail > slots) {
+            ring->dropped += head - ring->tail - slots;
+            ring->tail = head - slots;
+        }
+
+        rec = &ring->rec[ring->tail & ring->mask];
+        seq = rec->seq;
+        osal_smp_rmb();
+        if (seq != ring->tail + 1) {
+            /* either a writer is still filling the slot, or it was lapped meanwhile */
+            if ((hi_u32)osal_atomic_read(&ring->head) - ring->tail > slots) {
+                continue;
+            }
+            return HI_FALSE;
+        }
+
+        if (memcpy_s(&ring->pending, sizeof(ring->pending), rec, sizeof(*rec)) != EOK) {
+            return HI_FALSE;
+        }
+        osal_smp_rmb();
+        if (rec->seq != seq) {
+            continue;
+        }
+        /* the copy is checked against the seq, still never trust it to be terminated */
+        if (ring->pending.flags & LOG_BIN_FLAG_TEXT) {
+            ring->pending.u.text[sizeof(ring->pending.u.text) - 1] = '\0';
+        } else {
+            ring->pending.u.bin.str[LOG_BIN_STR_LEN - 1] = '\0';
+        }
+        ring->tail++;
+        ring->has_pending = HI_TRUE;
+    }
+    return HI_TRUE;
+}
+
+static log_bin_ring *log_bin_oldest(hi_void)
+{
+    hi_u32 i;
+    log_bin_ring *oldest = HI_NULL;
+
+    for (i = 0; i < g_log_bin.ring_num; i++) {
+        if (!log_bin_peek(&g_log_bin.ring[i])) {
+            continue;
+        }
+        if ((oldest == HI_NULL) || (g_log_bin.ring[i].pending.time < oldest->pending.time)) {
+            oldest = &g_log_bin.ring[i];
+        }
+    }
+    return oldest;
+}
+
+static hi_s32 log_bin_format_arg(hi_char *out, hi_u32 size, const hi_char *spec,
+    const log_bin_record *rec, hi_u32 idx, log_bin_arg_type type)
+{
+    hi_u64 v = rec->u.bin.args[idx];
+
+    switch (type) {
+        case LOG_BIN_ARG_INT:
+            return snprintf_s(out, size, size - 1, spec, (hi_s32)v);
+        case LOG_BIN_ARG_LONG:
+            return snprintf_s(out, size, size - 1, spec, (long)v);
+        case LOG_BIN_ARG_LLONG:
+            return snprintf_s(out, size, size - 1, spec, (long long)v);
+        case LOG_BIN_ARG_PTR:
+            return snprintf_s(out, size, size - 1, spec, (hi_void *)(hi_uintptr_t)v);
+        default:
+            /* an offset out of the string buffer reads its terminating '\0' */
+            v = ((hi_u32)v < LOG_BIN_STR_LEN) ? (hi_u32)v : (LOG_BIN_STR_LEN - 1);
+            return snprintf_s(out, size, size - 1, spec, rec->u.bin.str + (hi_u32)v);
+    }
+}
+
+/* replay the record into out spec by spec, return the length of the line */
+static hi_u32 log_bin_format(const log_bin_record *rec, hi_char *out, hi_u32 size)
+{
+    hi_char spec[LOG_BIN_SPEC_LEN];
+    const hi_char *p = HI_NULL;
+    const hi_char *end = HI_NULL;
+    hi_char *mod_name = cmpi_get_module_name(rec->mod_id);
+    log_bin_arg_type type;
+    hi_u32 idx = 0;
+    hi_u32 len;
+    hi_s32 ret;
+
+    if (rec->mod_id >= HI_ID_BUTT) {
+        ret = snprintf_s(out, size, size - 1, "<%d>[%6u] <record of unknown module dropped>\n",
+            rec->level, rec->mod_id);
+        return (ret < 0) ? 0 : ret;
+    }
+
+    /* an unregistered module only has text records */
+    ret = snprintf_s(out, size, size - 1, "<%d>[%6s] ", rec->level, (mod_name != HI_NULL) ? mod_name : "-");
+    len = (ret < 0) ? 0 : ret;
+
+    if (rec->flags & LOG_BIN_FLAG_TEXT) {
+        ret = snprintf_s(out + len, size - len, size - len - 1, "%s", rec->u.text);
+        len += (ret < 0) ? 0 : ret;
+        return len;
+    }
+
+    /* the module is gone, its format strings may be gone too; the caller holds g_log_bin.lock */
+    if (rec->mod_gen != g_log_bin.mod_gen[rec->mod_id]) {
+        ret = snprintf_s(out + len, size - len, size - len - 1, "<record of unloaded module dropped>\n");
+        len += (ret < 0) ? 0 : ret;
+        return len;
+    }
+
+    for (p = rec->fmt; (*p != '\0') && (len < size - 1); p = end) {
+        if ((*p != '%') || (p[1] == '%')) {
+            out[len++] = *p;
+            end = p + ((*p == '%') ? 2 : 1); /* 2: skip "%%" */
+            continue;
+        }
+        end = log_bin_parse_spec(p + 1, &type);
+        if ((end == HI_NULL) || (idx >= rec->argc) || (idx >= LOG_BIN_MAX_ARGS) || (end - p >= LOG_BIN_SPEC_LEN)) {
+            break;
+        }
+        if (memcpy_s(spec, sizeof(spec), p, end - p) != EOK) {
+            break;
+        }
+        spec[end - p] = '\0';
+        ret = log_bin_format_arg(out + len, size - len, spec, rec, idx++, type);
+        if (ret < 0) {
+            break;
+        }
+        len += ret;
+    }
+    len = osal_min(len, size - 1);
+    out[len] = '\0';
+    return len;
+}
+
+static hi_bool log_bin_has_data(hi_void)
+{
+    hi_u32 i;
+    log_bin_ring *ring = HI_NULL;
+
+    if (g_log_bin.line_pos != g_log_bin.line_len) {
+        return HI_TRUE;
+    }
+    for (i = 0; i < g_log_bin.ring_num; i++) {
+        ring = &g_log_bin.ring[i];
+        if (ring->has_pending || ((hi_u32)osal_atomic_read(&ring->head) != ring->tail)) {
+            return HI_TRUE;
+        }
+    }
+    return HI_FALSE;
+}
+
+static hi_s32 log_bin_read(hi_char *buf, hi_s32 count)
+{
+    hi_s32 read_len = 0;
+    hi_u32 len;
+    log_bin_ring *ring = HI_NULL;
+
+    while (read_len < count) {
+        if (g_log_bin.line_pos == g_log_bin.line_len) {
+            ring = log_bin_oldest();
+            if (ring == HI_NULL) {
+                break;
+            }
+            g_log_bin.line_len = log_bin_format(&ring->pending, g_log_bin.line, LOG_MAX_ITEMLEN);
+            g_log_bin.line_pos = 0;
+            ring->has_pending = HI_FALSE;
+            continue;
+        }
+
+        len = osal_min(g_log_bin.line_len - g_log_bin.line_pos, (hi_u32)(count - read_len));
+#ifdef __HuaweiLite__
+        hi_unused(buf);
+        printk("%s", g_log_bin.line + g_log_bin.line_pos);
+        len = g_log_bin.line_len - g_log_bin.line_pos;
+#else
+        if (osal_copy_to_user(buf + read_len, g_log_bin.line + g_log_bin.line_pos, len) != 0) {
+            return (read_len != 0) ? read_len : -1;
+        }
+#endif
+        g_log_bin.line_pos += len;
+        read_len += len;
+    }
+    return read_len;
+}
+
+static hi_s32 log_bin_alloc(hi_void)
+{
+    hi_u32 i;
+    hi_u32 slots;
+    log_bin_ring *ring = HI_NULL;
+
+    g_log_bin.ring_num = osal_min(osal_get_cpu_num(), (hi_u32)LOG_BIN_MAX_CPUS);
+    g_log_bin.ring_num = (g_log_bin.ring_num == 0) ? 1 : g_log_bin.ring_num;
+
+    /* split the text buffer's budget over the rings, rounded down to a power of 2 */
+    slots = g_log_buf.max_len / g_log_bin.ring_num / sizeof(log_bin_record);
+    slots = (slots < LOG_BIN_MIN_SLOTS) ? LOG_BIN_MIN_SLOTS : slots;
+    while ((slots & (slots - 1)) != 0) {
+        slots &= slots - 1;
+    }
+
+    for (i = 0; i < g_log_bin.ring_num; i++) {
+        ring = &g_log_bin.ring[i];
+        if (osal_spin_lock_init(&ring->lock) < 0) {
+            goto FAIL;
+        }
+        if (osal_atomic_init(&ring->head) != 0) {
+            osal_spin_lock_destroy(&ring->lock);
+            goto FAIL;
+        }
+        osal_atomic_set(&ring->head, 0);
+        ring->tail = 0;
+        ring->dropped = 0;
+        ring->mask = slots - 1;
+        ring->has_pending = HI_FALSE;
+        ring->rec = (log_bin_record *)osal_vmalloc(slots * sizeof(log_bin_record));
+        if (ring->rec == HI_NULL) {
+            osal_atomic_destroy(&ring->head);
+            osal_spin_lock_destroy(&ring->lock);
+            goto FAIL;
+        }
+        (hi_void)memset_s(ring->rec, slots * sizeof(log_bin_record), 0, slots * sizeof(log_bin_record));
+    }
+    return HI_SUCCESS;
+
+FAIL:
+    osal_printk("log binary ring %u malloc failed.\n", i);
+    while (i-- > 0) {
+        osal_vfree(g_log_bin.ring[i].rec);
+        g_log_bin.ring[i].rec = HI_NULL;
+        osal_atomic_destroy(&g_log_bin.ring[i].head);
+        osal_spin_lock_destroy(&g_log_bin.ring[i].lock);
+    }
+    return HI_FAILURE;
+}
+
+static hi_void log_bin_free(hi_void)
+{
+    hi_u32 i;
+
+    for (i = 0; i < LOG_BIN_MAX_CPUS; i++) {
+        if (g_log_bin.ring[i].rec != HI_NULL) {
+            osal_vfree(g_log_bin.ring[i].rec);
+            g_log_bin.ring[i].rec = HI_NULL;
+            osal_atomic_destroy(&g_log_bin.ring[i].head);
+            osal_spin_lock_destroy(&g_log_bin.ring[i].lock);
+        }
+    }
+}
+
+/*
+ * The rings are never freed while the module is loaded: a writer may still
+ * hold a slot when the mode is switched back to text.
+ */
+static hi_s32 log_bin_set_enable(hi_bool enable)
+{
+    hi_s32 ret = HI_SUCCESS;
+
+    osal_mutex_lock(&g_log_bin.lock);
+    if (enable && (g_log_bin.ring[0].rec == HI_NULL)) {
+        ret = log_bin_alloc();
+    }
+    if (ret == HI_SUCCESS) {
+        osal_smp_wmb();
+        g_log_bin.enable = enable;
+    }
+    osal_mutex_unlock(&g_log_bin.lock);
+    return ret;
+}
+
+/* called when a module registers, from now on its records may keep its format strings */
+hi_void cmpi_log_track_module(hi_mod_id mod_id)
+{
+    if (mod_id >= HI_ID_BUTT) {
+        return;
+    }
+    osal_mutex_lock(&g_log_bin.lock);
+    if ((g_log_bin.mod_gen[mod_id] & 1) == 0) {
+        g_log_bin.mod_gen[mod_id]++;
+    }
+    osal_mutex_unlock(&g_log_bin.lock);
+}
+
+/*
+ * Called when a module unregisters, drops its queued records that reference its format strings.
+ * Waits for a reader that is formatting one of them.
+ */
+hi_void cmpi_log_forget_module(hi_mod_id mod_id)
+{
+    if (mod_id >= HI_ID_BUTT) {
+        return;
+    }
+    osal_mutex_lock(&g_log_bin.lock);
+    if ((g_log_bin.mod_gen[mod_id] & 1) != 0) {
+        g_log_bin.mod_gen[mod_id]++;
+    }
+    osal_mutex_unlock(&g_log_bin.lock);
+}
+
 hi_s32 log_write(hi_s32 level, hi_mod_id mod_id, const char *fmt, osal_va_list args)
 {
     hi_s32 new_len;
@@ -136,6 +681,10 @@ hi_s32 log_write(hi_s32 level, hi_mod_id mod_id, const char *fmt, osal_va_list a
     if (g_log_buf.addr == NULL) {
         return 0;
     }
+    if (g_log_bin.enable && (mod_id < HI_ID_BUTT)) {
+        osal_smp_rmb();
+        return log_bin_write(level, mod_id, fmt, args);
+    }
     HI_ASSERT(g_log_buf.write_pos <= g_log_buf.max_len);
     HI_ASSERT(g_log_buf.read_pos <= g_log_buf.max_len);
 
@@ -217,6 +766,15 @@ static hi_s32 log_proc_read(struct osal_proc_dir_entry *s)
                     g_log_buf.write_pos, g_log_buf.butt_pos);
     osal_seq_printf(s, "\n");
 
+    osal_seq_printf(s, "-----LOG BINARY RING STATE-----------------------------------------------------\n");
+    osal_seq_printf(s, "Binary %d\n", g_log_bin.enable);
+    for (i = 0; (i < LOG_BIN_MAX_CPUS) && (g_log_bin.ring[i].rec != HI_NULL); i++) {
+        osal_seq_printf(s, "Ring%u  Slots %5u  Head %10u  Tail %10u  Dropped %10u\n", i,
+                        g_log_bin.ring[i].mask + 1, (hi_u32)osal_atomic_read(&g_log_bin.ring[i].head),
+                        g_log_bin.ring[i].tail, g_log_bin.ring[i].dropped);
+    }
+    osal_seq_printf(s, "\n");
+
     osal_seq_printf(s, "-----CURRENT LOG LEVEL---------------------------------------------------------\n");
     for (i = 0; i < HI_ID_BUTT; i++) {
         hi_char *pa_temp_name = cmpi_get_module_name(i);
@@ -270,6 +828,13 @@ static hi_s32 log_proc_write(struct osal_proc_dir_entry *s, const char *buf,
         goto out;
     }
 
+    if (!osal_strcmp("binary", left)) {
+        if (log_bin_set_enable(level != 0) != HI_SUCCESS) {
+            osal_printk("enable binary log failed!\n");
+        }
+        goto out;
+    }
+
     if (!level && *right != '0') {
         osal_printk("invalid value!\n");
         goto out;
@@ -408,6 +973,13 @@ hi_void *read_q(hi_void *data)
 int wait_condition_call_back(const void *param)
 {
     hi_unused(param);
+    if (g_log_bin.enable) {
+        /* pairs with the barrier in log_bin_write */
+        osal_smp_mb();
+        if (log_bin_has_data()) {
+            return 1;
+        }
+    }
     return ((g_log_buf.read_pos != g_log_buf.write_pos) ||
             (g_state == LOG_STATE_CLOSE) ||
             (g_wait_data == HI_FALSE));
@@ -439,6 +1011,24 @@ static int log_read(char *buf, int count, long *offset, void *private_data)
 
     g_state = LOG_STATE_READ;
 
+    if (g_log_bin.enable) {
+        g_log_bin.sleeping = HI_TRUE;
+        error = osal_wait_event_interruptible(&g_log_buf.block_wait, wait_condition_call_back, NULL);
+        g_log_bin.sleeping = HI_FALSE;
+        if (error) {
+            return error;
+        }
+        /* text records written before the switch are drained first */
+        if (g_log_buf.write_pos == g_log_buf.read_pos) {
+            if (osal_mutex_lock_interruptible(&g_log_bin.lock) != 0) {
+                return -1;
+            }
+            read_len = log_bin_read(buf, count);
+            osal_mutex_unlock(&g_log_bin.lock);
+            return read_len;
+        }
+    }
+
     error = osal_wait_event_interruptible(&g_log_buf.block_wait, wait_condition_call_back, NULL);
     if (error) {
         return error;
@@ -548,6 +1138,11 @@ hi_s32 cmpi_log_init(hi_u32 log_buf_len)
         goto OUT4;
     }
 
+    if (osal_mutex_init(&(g_log_bin.lock)) < 0) {
+        osal_printk("mutex init failed!\n");
+        goto OUT5;
+    }
+
     if ((log_buf_len >= 2) && (log_buf_len <= 128)) { /* 2,min len. 128 max len */
         g_log_buf.max_len = log_buf_len * 1024; /* 1024,1kB is 1024 byte */
     } else {
@@ -558,11 +1153,13 @@ hi_s32 cmpi_log_init(hi_u32 log_buf_len)
     g_log_buf.addr = (hi_char *)osal_vmalloc(g_log_buf.max_len);
     if (g_log_buf.addr == NULL) {
         osal_printk("log buffer %d_b malloc failed.\n", g_log_buf.max_len);
-        goto OUT5;
+        goto OUT6;
     }
 
     return HI_SUCCESS;
 
+OUT6:
+    osal_mutex_destroy(&(g_log_bin.lock));
 OUT5:
     osal_wait_destroy(&(g_log_buf.block_wait));
 OUT4:
@@ -584,6 +1181,9 @@ hi_void cmpi_log_exit(hi_void)
         osal_vfree(g_log_buf.addr);
         g_log_buf.addr = NULL;
     }
+    g_log_bin.enable = HI_FALSE;
+    log_bin_free();
+    osal_mutex_destroy(&(g_log_bin.lock));
     osal_deregisterdevice(s_log_device);
     osal_destroydev(s_log_device);
 #ifdef CONFIG_HI_PROC_SHOW_SUPPORT
@@ -219,6 +219,7 @@ hi_s32 cmpi_register_module(umap_module *module)
     module->inited = HI_TRUE;
 
     osal_list_add_tail(&module->list, &g_mod_list);
+    cmpi_log_track_module(module->mod_id);
 
     return ret;
 }
@@ -237,6 +238,7 @@ hi_void cmpi_unregister_module(hi_mod_id mod_id)
             }
 
             osal_list_del(&tmp->list);
+            cmpi_log_forget_module(mod_id);
 
             HI_TRACE(HI_DBG_DEBUG,
                      HI_ID_CMPI, "MOD[%s] unregister OK!\n", tmp->mod_name);
@@ -0,0 +1,601 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Userspace stress test of the binary mode of the cmpi log. cmpi_log.c is
+ * built as is against hi_osal.h, with the OSAL calls it makes implemented on
+ * pthreads below; osal_get_cpu_id() returns the "cpu" of the calling thread.
+ *   text       writers on the text ring, for comparison
+ *   pinned     one writer per cpu while a reader drains: per writer order,
+ *              every record read once or counted as dropped, none torn
+ *   migrating  writers jump between cpus, so the rings are shared: same
+ *              checks, except that order across rings is only counted
+ *   unload     a module that unregisters: its queued records are dropped,
+ *              its format string is freed (ASan catches any later use), and
+ *              an unregistered module's records are still printed
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "../src/cmpi_log.c"
+
+#define STRESS_CPUS       4
+#define STRESS_RECORDS    200000 /* per writer */
+#define STRESS_LOG_KB     128    /* log_buf_len, the rings share it */
+#define STRESS_READ_LEN   4096
+#define STRESS_MOD        HI_ID_TDE
+#define STRESS_MOD_UNLOAD HI_ID_FB
+
+/* ------------------------------------------------------------------ host OSAL */
+
+static __thread unsigned int g_host_cpu;
+static hi_bool g_host_registered[HI_ID_BUTT];
+
+int osal_spin_lock_init(osal_spinlock_t *lock)
+{
+    lock->lock = malloc(sizeof(pthread_spinlock_t));
+    return (lock->lock == NULL) ? -1 : pthread_spin_init(lock->lock, PTHREAD_PROCESS_PRIVATE);
+}
+
+void osal_spin_lock_irqsave(osal_spinlock_t *lock, unsigned long *flags)
+{
+    *flags = 0;
+    pthread_spin_lock(lock->lock);
+}
+
+void osal_spin_unlock_irqrestore(osal_spinlock_t *lock, const unsigned long *flags)
+{
+    (void)flags;
+    pthread_spin_unlock(lock->lock);
+}
+
+void osal_spin_lock_destroy(osal_spinlock_t *lock)
+{
+    if (lock->lock != NULL) {
+        pthread_spin_destroy(lock->lock);
+        free(lock->lock);
+        lock->lock = NULL;
+    }
+}
+
+int osal_mutex_init(osal_mutex_t *mutex)
+{
+    mutex->mutex = malloc(sizeof(pthread_mutex_t));
+    return (mutex->mutex == NULL) ? -1 : pthread_mutex_init(mutex->mutex, NULL);
+}
+
+int osal_mutex_lock(osal_mutex_t *mutex)
+{
+    return pthread_mutex_lock(mutex->mutex);
+}
+
+int osal_mutex_lock_interruptible(osal_mutex_t *mutex)
+{
+    return pthread_mutex_lock(mutex->mutex);
+}
+
+void osal_mutex_unlock(osal_mutex_t *mutex)
+{
+    pthread_mutex_unlock(mutex->mutex);
+}
+
+void osal_mutex_destroy(osal_mutex_t *mutex)
+{
+    if (mutex->mutex != NULL) {
+        pthread_mutex_destroy(mutex->mutex);
+        free(mutex->mutex);
+        mutex->mutex = NULL;
+    }
+}
+
+int osal_atomic_init(osal_atomic_t *atomic)
+{
+    atomic->atomic = calloc(1, sizeof(int));
+    return (atomic->atomic == NULL) ? -1 : 0;
+}
+
+void osal_atomic_destroy(osal_atomic_t *atomic)
+{
+    free(atomic->atomic);
+    atomic->atomic = NULL;
+}
+
+int osal_atomic_read(osal_atomic_t *atomic)
+{
+    return __atomic_load_n((int *)atomic->atomic, __ATOMIC_SEQ_CST);
+}
+
+void osal_atomic_set(osal_atomic_t *atomic, int i)
+{
+    __atomic_store_n((int *)atomic->atomic, i, __ATOMIC_SEQ_CST);
+}
+
+int osal_atomic_inc_return(osal_atomic_t *atomic)
+{
+    return __atomic_add_fetch((int *)atomic->atomic, 1, __ATOMIC_SEQ_CST);
+}
+
+void osal_smp_mb(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void osal_smp_rmb(void)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+void osal_smp_wmb(void)
+{
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+int osal_wait_init(osal_wait_t *wait)
+{
+    wait->wait = NULL;
+    return 0;
+}
+
+void osal_wait_destroy(osal_wait_t *wait)
+{
+    (void)wait;
+}
+
+void osal_wakeup(osal_wait_t *wait)
+{
+    (void)wait;
+}
+
+int osal_wait_timeout_interruptible(osal_wait_t *wait, osal_wait_cond_func_t func, const void *param,
+    unsigned long ms)
+{
+    (void)wait;
+    (void)func;
+    (void)param;
+    (void)ms;
+    sched_yield();
+    return 0;
+}
+
+void osal_yield(void)
+{
+    sched_yield();
+}
+
+void *osal_vmalloc(unsigned long size)
+{
+    return malloc(size);
+}
+
+void osal_vfree(const void *addr)
+{
+    free((void *)addr);
+}
+
+int osal_printk(const char *fmt, ...)
+{
+    va_list args;
+    int ret;
+
+    va_start(args, fmt);
+    ret = vprintf(fmt, args);
+    va_end(args);
+    return ret;
+}
+
+int osal_strcmp(const char *s1, const char *s2)
+{
+    return strcmp(s1, s2);
+}
+
+long osal_strtol(const char *s, char **e, unsigned int base)
+{
+    return strtol(s, e, (int)base);
+}
+
+unsigned long osal_copy_from_user(void *to, const void *from, unsigned long n)
+{
+    memcpy(to, from, n);
+    return 0;
+}
+
+unsigned long osal_copy_to_user(void *to, const void *from, unsigned long n)
+{
+    memcpy(to, from, n);
+    return 0;
+}
+
+unsigned long long osal_sched_clock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+void osal_gettimeofday(osal_timeval_t *tv)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    tv->tv_sec = t.tv_sec;
+    tv->tv_usec = t.tv_usec;
+}
+
+unsigned int osal_get_cpu_id(void)
+{
+    return g_host_cpu;
+}
+
+unsigned int osal_get_cpu_num(void)
+{
+    return STRESS_CPUS;
+}
+
+osal_dev_t *osal_createdev(const char *name)
+{
+    (void)name;
+    return calloc(1, sizeof(osal_dev_t));
+}
+
+int osal_destroydev(osal_dev_t *osal_dev)
+{
+    free(osal_dev);
+    return 0;
+}
+
+int osal_registerdevice(osal_dev_t *osal_dev)
+{
+    (void)osal_dev;
+    return 0;
+}
+
+void osal_deregisterdevice(osal_dev_t *pdev)
+{
+    (void)pdev;
+}
+
+osal_proc_entry_t *osal_create_proc_entry(const char *name, osal_proc_entry_t *parent)
+{
+    static osal_proc_entry_t entry;
+
+    (void)name;
+    (void)parent;
+    return &entry;
+}
+
+void osal_seq_printf(osal_proc_entry_t *entry, const char *fmt, ...)
+{
+    (void)entry;
+    (void)fmt;
+}
+
+void osal_remove_proc_entry(const char *name, osal_proc_entry_t *parent)
+{
+    (void)name;
+    (void)parent;
+}
+
+hi_char *cmpi_get_module_name(hi_mod_id mod_id)
+{
+    static hi_char *names[HI_ID_BUTT] = {
+        [STRESS_MOD] = "tde",
+        [STRESS_MOD_UNLOAD] = "fb",
+    };
+
+    return ((mod_id < HI_ID_BUTT) && g_host_registered[mod_id]) ? names[mod_id] : HI_NULL;
+}
+
+/* ------------------------------------------------------------------ stress */
+
+typedef struct {
+    hi_u32 id;
+    hi_bool migrate;
+    hi_bool pace;       /* give the reader a chance now and then, or it only sees drops */
+    hi_u32 records;
+    hi_u64 ns;
+} stress_writer;
+
+typedef struct {
+    hi_u32 next[STRESS_CPUS];           /* per writer: record expected next */
+    hi_u8 *seen[STRESS_CPUS];
+    hi_u64 read;
+    hi_u64 torn;
+    hi_u64 dup;
+    hi_u64 out_of_order;                /* across rings, only possible when writers migrate */
+    hi_u64 bad;
+    hi_char line[LOG_MAX_ITEMLEN + 1];
+    hi_u32 line_len;
+} stress_reader;
+
+static volatile hi_bool g_stress_writing;
+static hi_u32 g_stress_fail = 0;
+
+#define stress_check(cond, name) do { \
+    if (!(cond)) { \
+        printf("FAIL %s (%s:%d)\n", name, __FILE__, __LINE__); \
+        g_stress_fail++; \
+    } else { \
+        printf("ok   %s\n", name); \
+    } \
+} while (0)
+
+static hi_u64 stress_sum(hi_u32 w, hi_u32 n)
+{
+    return ((hi_u64)w << 32) ^ ((hi_u64)n * 0x9e3779b97f4a7c15ULL);
+}
+
+static hi_void *stress_write(hi_void *arg)
+{
+    stress_writer *w = arg;
+    hi_char tag[16]; /* 16: a decimal hi_u32 */
+    hi_u64 start = osal_sched_clock();
+    hi_u32 n;
+    unsigned int seed = w->id;
+
+    g_host_cpu = w->id;
+    for (n = 0; n < w->records; n++) {
+        if (w->migrate) {
+            g_host_cpu = (hi_u32)rand_r(&seed) % STRESS_CPUS;
+        }
+        /* on the stack, as HI_TRACE callers often do */
+        (hi_void)snprintf(tag, sizeof(tag), "%u", n * 7); /* 7: any function of n */
+        HI_LOG(HI_DBG_ERR, STRESS_MOD, "w%u n%u s%s c%llx\n", w->id, n, tag, stress_sum(w->id, n));
+        if (w->pace && ((n % 128) == 0)) { /* 128: records between yields */
+            sched_yield();
+        }
+    }
+    w->ns = osal_sched_clock() - start;
+    return HI_NULL;
+}
+
+static hi_void stress_parse(stress_reader *r, const hi_char *line)
+{
+    hi_u32 w;
+    hi_u32 n;
+    hi_char tag[16]; /* 16: a decimal hi_u32 */
+    hi_char want[16]; /* 16: a decimal hi_u32 */
+    unsigned long long sum;
+
+    if (sscanf(line, "<%*d>[   tde] w%u n%u s%15s c%llx", &w, &n, tag, &sum) != 4 || /* 4: fields */
+        (w >= STRESS_CPUS) || (n >= STRESS_RECORDS)) {
+        if (r->bad++ == 0) {
+            printf("unexpected line: %s", line);
+        }
+        return;
+    }
+    (hi_void)snprintf(want, sizeof(want), "%u", n * 7); /* 7: as written */
+    if ((sum != stress_sum(w, n)) || (strcmp(tag, want) != 0)) {
+        r->torn++;
+        return;
+    }
+    if (r->seen[w][n] != 0) {
+        r->dup++;
+        return;
+    }
+    r->seen[w][n] = 1;
+    r->out_of_order += (n < r->next[w]);
+    r->next[w] = (n >= r->next[w]) ? (n + 1) : r->next[w];
+    r->read++;
+}
+
+/* what log_read does in binary mode, minus the wait */
+static hi_bool stress_read(stress_reader *r)
+{
+    hi_char buf[STRESS_READ_LEN];
+    hi_s32 len;
+    hi_s32 i;
+
+    osal_mutex_lock(&g_log_bin.lock);
+    len = log_bin_read(buf, sizeof(buf));
+    osal_mutex_unlock(&g_log_bin.lock);
+    for (i = 0; i < len; i++) {
+        if (r->line_len < LOG_MAX_ITEMLEN) {
+            r->line[r->line_len++] = buf[i];
+        }
+        if (buf[i] == '\n') {
+            r->line[r->line_len] = '\0';
+            stress_parse(r, r->line);
+            r->line_len = 0;
+        }
+    }
+    return (len > 0);
+}
+
+static hi_void *stress_reader_thread(hi_void *arg)
+{
+    stress_reader *r = arg;
+
+    while (g_stress_writing) {
+        if (!stress_read(r)) {
+            sched_yield();
+        }
+    }
+    while (stress_read(r)) {
+    }
+    return HI_NULL;
+}
+
+/* drop everything queued, as if it had been read */
+static hi_void stress_skip(hi_void)
+{
+    hi_u32 i;
+
+    for (i = 0; i < g_log_bin.ring_num; i++) {
+        g_log_bin.ring[i].tail = (hi_u32)osal_atomic_read(&g_log_bin.ring[i].head);
+        g_log_bin.ring[i].has_pending = HI_FALSE;
+        g_log_bin.ring[i].dropped = 0;
+    }
+}
+
+static hi_u64 stress_dropped(hi_void)
+{
+    hi_u64 dropped = 0;
+    hi_u32 i;
+
+    for (i = 0; i < g_log_bin.ring_num; i++) {
+        dropped += g_log_bin.ring[i].dropped;
+        g_log_bin.ring[i].dropped = 0;
+    }
+    return dropped;
+}
+
+/* returns the writer throughput in records per second */
+static double stress_run(const hi_char *name, hi_bool migrate, stress_reader *r)
+{
+    stress_writer writers[STRESS_CPUS];
+    pthread_t tid[STRESS_CPUS];
+    pthread_t reader;
+    hi_u64 ns = 0;
+    hi_u32 i;
+
+    g_stress_writing = HI_TRUE;
+    if (r != HI_NULL) {
+        (hi_void)pthread_create(&reader, HI_NULL, stress_reader_thread, r);
+    }
+    for (i = 0; i < STRESS_CPUS; i++) {
+        writers[i].id = i;
+        writers[i].migrate = migrate;
+        writers[i].pace = (r != HI_NULL);
+        writers[i].records = STRESS_RECORDS;
+        (hi_void)pthread_create(&tid[i], HI_NULL, stress_write, &writers[i]);
+    }
+    for (i = 0; i < STRESS_CPUS; i++) {
+        (hi_void)pthread_join(tid[i], HI_NULL);
+        ns = (writers[i].ns > ns) ? writers[i].ns : ns;
+    }
+    g_stress_writing = HI_FALSE;
+    if (r != HI_NULL) {
+        (hi_void)pthread_join(reader, HI_NULL);
+    }
+    printf("%-9s %u writers: %8.0f records/s\n", name, STRESS_CPUS,
+        (double)STRESS_CPUS * STRESS_RECORDS * 1e9 / (double)ns);
+    return (double)STRESS_CPUS * STRESS_RECORDS * 1e9 / (double)ns;
+}
+
+static hi_void stress_binary(const hi_char *name, hi_bool migrate)
+{
+    stress_reader r;
+    hi_u64 dropped;
+    hi_u32 i;
+    hi_char what[64]; /* 64: check name */
+
+    (hi_void)memset(&r, 0, sizeof(r));
+    for (i = 0; i < STRESS_CPUS; i++) {
+        r.seen[i] = calloc(STRESS_RECORDS, 1);
+    }
+    (hi_void)stress_run(name, migrate, &r);
+    dropped = stress_dropped();
+    printf("%-9s read %llu, dropped %llu, out of order %llu\n", name, (unsigned long long)r.read,
+        (unsigned long long)dropped, (unsigned long long)r.out_of_order);
+
+    (hi_void)snprintf(what, sizeof(what), "%s: no torn, duplicate or foreign record", name);
+    stress_check((r.torn == 0) && (r.dup == 0) && (r.bad == 0), what);
+    (hi_void)snprintf(what, sizeof(what), "%s: every record read or dropped", name);
+    stress_check(r.read + dropped == (hi_u64)STRESS_CPUS * STRESS_RECORDS, what);
+    if (!migrate) {
+        (hi_void)snprintf(what, sizeof(what), "%s: per writer order kept", name);
+        stress_check(r.out_of_order == 0, what);
+    }
+    for (i = 0; i < STRESS_CPUS; i++) {
+        free(r.seen[i]);
+    }
+}
+
+static hi_void stress_unload(hi_void)
+{
+    static const hi_char fmt_const[] = "x%u\n";
+    stress_reader r;
+    hi_char *fmt = strdup(fmt_const); /* the format string of a module that will be unloaded */
+    hi_char buf[STRESS_READ_LEN];
+    hi_s32 len;
+    hi_u32 i;
+
+    (hi_void)memset(&r, 0, sizeof(r));
+    (hi_void)stress_read(&r); /* drain */
+    g_host_cpu = 0;
+    g_host_registered[STRESS_MOD_UNLOAD] = HI_TRUE;
+    cmpi_log_track_module(STRESS_MOD_UNLOAD);
+    for (i = 0; i < 4; i++) { /* 4: records queued */
+        HI_LOG(HI_DBG_ERR, STRESS_MOD_UNLOAD, fmt, i);
+    }
+    osal_mutex_lock(&g_log_bin.lock);
+    len = log_bin_read(buf, sizeof(buf) - 1);
+    osal_mutex_unlock(&g_log_bin.lock);
+    buf[(len > 0) ? len : 0] = '\0';
+    stress_check(strstr(buf, "[    fb] x3\n") != HI_NULL, "unload: records of a registered module replayed");
+
+    for (i = 0; i < 4; i++) { /* 4: records queued */
+        HI_LOG(HI_DBG_ERR, STRESS_MOD_UNLOAD, fmt, i);
+    }
+    g_host_registered[STRESS_MOD_UNLOAD] = HI_FALSE;
+    cmpi_log_forget_module(STRESS_MOD_UNLOAD);
+    (hi_void)memset(fmt, '%', sizeof(fmt_const) - 1);
+    free(fmt);
+    osal_mutex_lock(&g_log_bin.lock);
+    len = log_bin_read(buf, sizeof(buf) - 1);
+    osal_mutex_unlock(&g_log_bin.lock);
+    buf[(len > 0) ? len : 0] = '\0';
+    stress_check((strstr(buf, "<record of unloaded module dropped>") != HI_NULL) && (strstr(buf, "x") == HI_NULL),
+        "unload: queued records dropped, freed format not read");
+
+    /* not registered any more: formatted at once, with a stack format */
+    (hi_void)snprintf(buf, sizeof(buf), "y%%u\n");
+    HI_LOG(HI_DBG_ERR, STRESS_MOD_UNLOAD, buf, 5); /* 5: any value */
+    (hi_void)memset(buf, 0, sizeof(buf));
+    osal_mutex_lock(&g_log_bin.lock);
+    len = log_bin_read(buf, sizeof(buf) - 1);
+    osal_mutex_unlock(&g_log_bin.lock);
+    buf[(len > 0) ? len : 0] = '\0';
+    stress_check(strstr(buf, "[     -] y5\n") != HI_NULL, "unload: unregistered module printed as text");
+}
+
+int main(hi_void)
+{
+    double text;
+    double bin;
+
+    if (cmpi_log_init(STRESS_LOG_KB) != HI_SUCCESS) {
+        printf("cmpi_log_init failed\n");
+        return 1;
+    }
+    g_host_registered[STRESS_MOD] = HI_TRUE;
+    cmpi_log_track_module(STRESS_MOD);
+
+    text = stress_run("text", HI_FALSE, HI_NULL);
+    if (log_bin_set_enable(HI_TRUE) != HI_SUCCESS) {
+        printf("binary mode failed\n");
+        return 1;
+    }
+    bin = stress_run("binary", HI_FALSE, HI_NULL);
+    stress_skip();
+    printf("binary/text writer speedup %.1fx, no reader\n", bin / text);
+
+    stress_binary("pinned", HI_FALSE);
+    stress_binary("migrating", HI_TRUE);
+    stress_unload();
+
+    cmpi_log_exit();
+    printf("%u check(s) failed\n", g_stress_fail);
+    return (g_stress_fail == 0) ? 0 : 1;
+}
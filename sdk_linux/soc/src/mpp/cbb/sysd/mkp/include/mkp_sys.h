@@ -68,6 +68,32 @@ typedef struct {
     hi_u32 buf_line;
 } vpss_venc_wrap_args;
 
+/* bucket 0 counts 0us, bucket i counts [2^(i-1), 2^i) us, the last bucket has no upper bound */
+#define SYS_BIND_HIST_NUM 20
+
+typedef enum {
+    SYS_BIND_FAIL_DELAY_MODE = 0, /* low delay data the receiver does not take */
+    SYS_BIND_FAIL_REFUSED, /* call_back of the receiver returned an error */
+    SYS_BIND_FAIL_BUTT
+} sys_bind_fail_reason;
+
+typedef struct {
+    hi_u32 send_cnt;
+    hi_u32 reset_cnt;
+    hi_u32 fail_cnt[SYS_BIND_FAIL_BUTT];
+    hi_s32 last_err; /* last error returned by call_back */
+    hi_u32 call_back_max; /* unit is us */
+    hi_u32 interval_max; /* unit is us */
+    hi_u32 call_back_hist[SYS_BIND_HIST_NUM];
+    hi_u32 interval_hist[SYS_BIND_HIST_NUM];
+} sys_bind_stat;
+
+typedef struct {
+    hi_mpp_chn dest_chn;
+    hi_mpp_chn src_chn;
+    sys_bind_stat stat;
+} sys_bind_stat_args;
+
 typedef enum {
     IOC_NR_SYS_INIT = 0,
     IOC_NR_SYS_EXIT,
@@ -121,6 +147,8 @@ typedef enum {
     IOC_NR_SYS_SET_COMPRESSV2_RATE,
     IOC_NR_SYS_GET_COMPRESSV2_RATE,
 #endif
+
+    IOC_NR_SYS_GET_BIND_STAT,
 } ioc_nr_sys;
 
 #define SYS_INIT_CTRL                   _IO(IOC_TYPE_SYS, IOC_NR_SYS_INIT)
@@ -178,6 +206,8 @@ typedef enum {
 #define SYS_GET_COMPRESSV2_RATE         _IOR(IOC_TYPE_SYS, IOC_NR_SYS_GET_COMPRESSV2_RATE, sys_compress_v2_param)
 #endif
 
+#define SYS_GET_BIND_STAT               _IOWR(IOC_TYPE_SYS, IOC_NR_SYS_GET_BIND_STAT, sys_bind_stat_args)
+
 /*
  * cur sender:VIU,VOU,VDEC,VPSS,AI
  * cur receive:VOU,VPSS,GRP,AO
@@ -251,6 +281,7 @@ hi_s32 sys_get_bind_num_by_src(hi_mpp_chn *src_chn, hi_u32 *bind_num);
 
 hi_s32 sys_get_bind_by_dest_inner(hi_mpp_chn *dest_chn, hi_mpp_chn *src_chn);
 hi_s32 sys_get_bind_by_src(hi_mpp_chn *src_chn, hi_mpp_bind_dest *bind_src);
+hi_s32 sys_get_bind_stat(hi_mpp_chn *dest_chn, hi_mpp_chn *src_chn, sys_bind_stat *stat);
 
 hi_s32 sys_bind_register_sender(bind_sender_info *info);
 hi_s32 sys_bind_unregister_sender(hi_mod_id mod_id);
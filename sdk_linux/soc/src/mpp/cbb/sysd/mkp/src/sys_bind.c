@@ -33,11 +33,25 @@
 static osal_spinlock_t g_sys_bind_lock;
 static osal_semaphore_t g_sys_dev_sem;
 
+/*
+ * Protects the stat and last_send_time of every dest. One dest has one bound
+ * src, but that src is sent from several contexts at once: bind_adjust_src_dev_id
+ * folds every VDEC device into device 0, bind_adjust_src_chn_id every VO channel
+ * into channel 0, and nothing keeps one channel from sending on two cpus.
+ * Innermost lock, taken inside g_sys_bind_lock.
+ */
+static osal_spinlock_t g_sys_bind_stat_lock;
+
 #define bind_spin_lock_init()   osal_spin_lock_init(&g_sys_bind_lock)
 #define bind_spin_lock_uninit() osal_spin_lock_destroy(&g_sys_bind_lock)
 #define bind_spin_lock(flags) osal_spin_lock_irqsave(&g_sys_bind_lock, &(flags))
 #define bind_spin_unlock(flags) osal_spin_unlock_irqrestore(&g_sys_bind_lock, &(flags))
 
+#define bind_stat_lock_init()   osal_spin_lock_init(&g_sys_bind_stat_lock)
+#define bind_stat_lock_uninit() osal_spin_lock_destroy(&g_sys_bind_stat_lock)
+#define bind_stat_lock(flags)   osal_spin_lock_irqsave(&g_sys_bind_stat_lock, &(flags))
+#define bind_stat_unlock(flags) osal_spin_unlock_irqrestore(&g_sys_bind_stat_lock, &(flags))
+
 #define sys_lock_may_in_interrupt_return(flags) \
     do {                                        \
         if (osal_in_interrupt()) {              \
@@ -91,8 +105,8 @@ typedef struct {
 typedef struct {
     hi_bool is_bind_src;
     hi_mpp_chn bind_src;
-    hi_u32 send_cnt;
-    hi_u32 reset_cnt;
+    hi_u64 last_send_time; /* unit is ns, 0 before the first frame */
+    sys_bind_stat stat;
 } sys_bind_dest;
 
 typedef struct {
@@ -111,9 +125,19 @@ typedef struct {
     hi_bool support_delay_data;
 } sys_binder_ctx;
 
+/*
+ * Destination list of one source as seen by sys_bind_send_data. It is never
+ * modified once published: bind and unbind build a new one and swap the
+ * pointer, readers pin it with ref inside an rcu read side.
+ */
+typedef struct {
+    osal_atomic_t ref;
+    hi_mpp_bind_dest bind_dest;
+} sys_bind_snap;
+
 typedef struct {
     hi_u32 max_index;
-    hi_mpp_bind_dest **send_bind_src;
+    sys_bind_snap **send_bind_src;
 } sys_binder_send;
 
 static sys_binder_ctx *g_sender_tbl[HI_ID_BUTT] = {HI_NULL};
@@ -122,6 +146,13 @@ static sys_binder_ctx *g_receiver_tbl[HI_ID_BUTT] = {HI_NULL};
 
 static sys_binder_send g_bind_send[HI_ID_BUTT];
 
+#define bind_rcu_dereference(p) (*(typeof(p) volatile *)&(p))
+#define bind_rcu_assign_pointer(p, v) \
+    do {                              \
+        osal_smp_wmb();               \
+        (p) = (v);                    \
+    } while (0)
+
 static hi_s32 sys_get_idx_by_dev_chn(sys_binder_ctx *binder_ctx, hi_s32 dev_id, hi_s32 chn_id)
 {
     return (binder_ctx->max_chn_cnt * dev_id) + chn_id;
@@ -171,23 +202,25 @@ static hi_s32 sys_check_bind_tbl_size(hi_u32 bind_tbl_size)
     return HI_SUCCESS;
 }
 
-static hi_s32 sys_get_bind_valid_send_ctx(hi_mpp_chn *src_chn, hi_mpp_bind_dest **send_bind_src)
+/* called inside an rcu read side */
+static hi_s32 sys_get_bind_valid_send_ctx(hi_mpp_chn *src_chn, sys_bind_snap **send_bind_src)
 {
     hi_u32 src_tbl_idx;
-    hi_mpp_bind_dest *send_bind_src_tmp = HI_NULL;
+    sys_binder_ctx *sender_ctx = bind_rcu_dereference(g_sender_tbl[src_chn->mod_id]);
+    sys_bind_snap *send_bind_src_tmp = HI_NULL;
 
-    if (g_sender_tbl[src_chn->mod_id] == HI_NULL) {
+    if (sender_ctx == HI_NULL) {
         sys_err_trace("mod %d have not register !\n", src_chn->mod_id);
         return HI_ERR_SYS_NOT_PERM;
     }
 
-    if (sys_check_bind_dev_chn_id(src_chn, g_sender_tbl[src_chn->mod_id]) != HI_SUCCESS) {
+    if (sys_check_bind_dev_chn_id(src_chn, sender_ctx) != HI_SUCCESS) {
         return HI_ERR_SYS_ILLEGAL_PARAM;
     }
 
-    src_tbl_idx = sys_get_idx_by_dev_chn(g_sender_tbl[src_chn->mod_id], src_chn->dev_id, src_chn->chn_id);
+    src_tbl_idx = sys_get_idx_by_dev_chn(sender_ctx, src_chn->dev_id, src_chn->chn_id);
 
-    send_bind_src_tmp = g_bind_send[src_chn->mod_id].send_bind_src[src_tbl_idx];
+    send_bind_src_tmp = bind_rcu_dereference(g_bind_send[src_chn->mod_id].send_bind_src[src_tbl_idx]);
     if (send_bind_src_tmp == HI_NULL) {
         sys_info_trace("mod %d, dev %d, chn %d, have not bind !\n", src_chn->mod_id, src_chn->dev_id, src_chn->chn_id);
         return HI_ERR_SYS_NOT_PERM;
@@ -349,7 +382,7 @@ static hi_s32 sys_init_sender_ctx(bind_sender_info *sender, hi_mod_id mod_id, sy
     if (g_bind_send[mod_id].send_bind_src == HI_NULL) {
         g_bind_send[mod_id].max_index = sender->max_dev_cnt * sender->max_chn_cnt;
         g_bind_send[mod_id].send_bind_src =
-            (hi_mpp_bind_dest **)osal_kmalloc(sizeof(hi_mpp_bind_dest *) * g_bind_send[mod_id].max_index,
+            (sys_bind_snap **)osal_kmalloc(sizeof(sys_bind_snap *) * g_bind_send[mod_id].max_index,
                 osal_gfp_kernel);
         if (g_bind_send[mod_id].send_bind_src == HI_NULL) {
             sys_err_trace("no memory for bind SRC!\n");
@@ -358,7 +391,7 @@ static hi_s32 sys_init_sender_ctx(bind_sender_info *sender, hi_mod_id mod_id, sy
             return HI_ERR_SYS_NOMEM;
         }
 
-        size = (sizeof(hi_mpp_bind_dest *) * g_bind_send[mod_id].max_index);
+        size = (sizeof(sys_bind_snap *) * g_bind_send[mod_id].max_index);
         (hi_void)memset_s(g_bind_send[mod_id].send_bind_src, size, 0, size);
     }
 
@@ -416,44 +449,97 @@ static hi_s32 sys_bind_check_bindship(hi_mpp_chn *src_chn, sys_bind_dest *dest_b
     return HI_SUCCESS;
 }
 
-static hi_s32 sys_deinit_send_bind_src_mem(hi_mpp_chn *src_chn)
+static sys_bind_snap *sys_bind_snap_alloc(hi_void)
 {
-    hi_u32 src_tbl_idx;
-    sys_binder_ctx *sender_ctx = HI_NULL;
+    sys_bind_snap *snap = HI_NULL;
 
-    sender_ctx = g_sender_tbl[src_chn->mod_id];
-    src_tbl_idx = sys_get_idx_by_dev_chn(sender_ctx, src_chn->dev_id, src_chn->chn_id);
-    if (g_bind_send[src_chn->mod_id].send_bind_src[src_tbl_idx] != HI_NULL) {
-        osal_kfree(g_bind_send[src_chn->mod_id].send_bind_src[src_tbl_idx]);
-        g_bind_send[src_chn->mod_id].send_bind_src[src_tbl_idx] = HI_NULL;
+    snap = (sys_bind_snap *)osal_kmalloc(sizeof(sys_bind_snap), osal_gfp_kernel);
+    if (snap == HI_NULL) {
+        sys_err_trace("no memory for bind SRC!\n");
+        return HI_NULL;
     }
 
-    return HI_SUCCESS;
+    (hi_void)memset_s(snap, sizeof(sys_bind_snap), 0, sizeof(sys_bind_snap));
+    if (osal_atomic_init(&snap->ref) != 0) {
+        sys_err_trace("bind SRC ref init failed!\n");
+        osal_kfree(snap);
+        return HI_NULL;
+    }
+    osal_atomic_set(&snap->ref, 1);
+
+    return snap;
+}
+
+static hi_void sys_bind_snap_put(sys_bind_snap *snap)
+{
+    if ((snap != HI_NULL) && (osal_atomic_dec_return(&snap->ref) == 0)) {
+        osal_atomic_destroy(&snap->ref);
+        osal_kfree(snap);
+    }
+}
+
+/* pin the published destination list of src_chn, drop it with sys_bind_snap_put */
+static hi_s32 sys_bind_snap_get(hi_mpp_chn *src_chn, sys_bind_snap **snap)
+{
+    hi_s32 ret;
+    sys_bind_snap *snap_tmp = HI_NULL;
+
+    osal_rcu_read_lock();
+    ret = sys_get_bind_valid_send_ctx(src_chn, &snap_tmp);
+    if (ret == HI_SUCCESS) {
+        osal_atomic_inc_return(&snap_tmp->ref);
+        *snap = snap_tmp;
+    }
+    osal_rcu_read_unlock();
+
+    return ret;
 }
 
-static hi_s32 sys_init_send_bind_src_mem(hi_mpp_chn *src_chn)
+/*
+ * Fill snap from the bind list of src_chn and publish it, with the bind
+ * spin lock held. Returns the list it replaces, to be passed to
+ * sys_bind_snap_retire once the lock is released.
+ */
+static sys_bind_snap *sys_bind_snap_publish(hi_mpp_chn *src_chn, sys_bind_snap *snap)
 {
-    hi_mpp_bind_dest *send_bind_src = HI_NULL;
     hi_u32 src_tbl_idx;
-    sys_binder_ctx *sender_ctx = HI_NULL;
+    sys_bind_snap *old = HI_NULL;
+    sys_binder_ctx *sender_ctx = g_sender_tbl[src_chn->mod_id];
+
+    (hi_void)sys_get_binder_by_src(src_chn, &snap->bind_dest);
 
-    sender_ctx = g_sender_tbl[src_chn->mod_id];
     src_tbl_idx = sys_get_idx_by_dev_chn(sender_ctx, src_chn->dev_id, src_chn->chn_id);
+    old = g_bind_send[src_chn->mod_id].send_bind_src[src_tbl_idx];
+    bind_rcu_assign_pointer(g_bind_send[src_chn->mod_id].send_bind_src[src_tbl_idx], snap);
 
-    send_bind_src = g_bind_send[src_chn->mod_id].send_bind_src[src_tbl_idx];
-    if (send_bind_src == HI_NULL) {
-        send_bind_src = (hi_mpp_bind_dest *)osal_kmalloc(sizeof(hi_mpp_bind_dest), osal_gfp_kernel);
-        if (send_bind_src == HI_NULL) {
-            sys_err_trace("no memory for bind SRC!\n");
-            return HI_ERR_SYS_NOMEM;
-        }
+    return old;
+}
 
-        (hi_void)memset_s(send_bind_src, sizeof(hi_mpp_bind_dest), 0, sizeof(hi_mpp_bind_dest));
+static hi_void sys_bind_snap_retire(sys_bind_snap *old)
+{
+    if (old == HI_NULL) {
+        return;
+    }
+
+    /* no new reader can find old after this, the last pinned reader frees it */
+    osal_synchronize_rcu();
+    sys_bind_snap_put(old);
+}
 
-        g_bind_send[src_chn->mod_id].send_bind_src[src_tbl_idx] = send_bind_src;
+static hi_void sys_free_mod_send_src_bind_mem(MOD_ID_E mod)
+{
+    hi_u32 j;
+
+    if (g_bind_send[mod].send_bind_src == HI_NULL) {
+        return;
     }
 
-    return HI_SUCCESS;
+    for (j = 0; j < g_bind_send[mod].max_index; j++) {
+        if (g_bind_send[mod].send_bind_src[j] != HI_NULL) {
+            sys_bind_snap_put(g_bind_send[mod].send_bind_src[j]);
+            g_bind_send[mod].send_bind_src[j] = HI_NULL;
+        }
+    }
 }
 
 static inline hi_s32 sys_bind_check_sender_dest_num(sys_bind_src *src_bind)
@@ -500,6 +586,7 @@ static hi_s32 sys_really_unbind(hi_mpp_chn *src_chn, hi_mpp_chn *dest_chn, sys_b
     hi_s32 ret;
     sys_bind_src *src_bind = HI_NULL;
     sys_bind_node *node = HI_NULL;
+    sys_bind_snap *snap = HI_NULL;
     struct osal_list_head *list_tmp = HI_NULL;
     struct osal_list_head *list_node = HI_NULL;
 
@@ -508,6 +595,11 @@ static hi_s32 sys_really_unbind(hi_mpp_chn *src_chn, hi_mpp_chn *dest_chn, sys_b
         return ret;
     }
 
+    snap = sys_bind_snap_alloc();
+    if (snap == HI_NULL) {
+        return HI_ERR_SYS_NOMEM;
+    }
+
     bind_spin_lock(flags);
 
     osal_list_for_each_safe(list_node, list_tmp, &src_bind->list_head) {
@@ -526,55 +618,65 @@ static hi_s32 sys_really_unbind(hi_mpp_chn *src_chn, hi_mpp_chn *dest_chn, sys_b
 
     dest_bind->is_bind_src = HI_FALSE;
 
+    snap = sys_bind_snap_publish(src_chn, snap);
+
     bind_spin_unlock(flags);
 
+    sys_bind_snap_retire(snap);
+
     return HI_SUCCESS;
 }
 
 static hi_s32 sys_really_bind(hi_mpp_chn *src_chn, hi_mpp_chn *dest_chn, sys_bind_src *src_bind,
     sys_bind_dest *dest_bind)
 {
-    hi_s32 ret;
     unsigned long flags;
+    unsigned long stat_flags;
     sys_bind_node *node = HI_NULL;
+    sys_bind_snap *snap = HI_NULL;
 
-    ret = sys_init_send_bind_src_mem(src_chn);
-    if (ret != HI_SUCCESS) {
-        return ret;
+    snap = sys_bind_snap_alloc();
+    if (snap == HI_NULL) {
+        return HI_ERR_SYS_NOMEM;
     }
 
     node = (sys_bind_node *)osal_kmalloc(sizeof(sys_bind_node), osal_gfp_kernel);
     if (node == HI_NULL) {
         sys_err_trace("kmalloc err!\n");
-        sys_deinit_send_bind_src_mem(src_chn);
+        sys_bind_snap_put(snap);
         return HI_ERR_SYS_NOMEM;
     }
 
-    bind_spin_lock(flags);
-
-    if (memcpy_s(&dest_bind->bind_src, sizeof(hi_mpp_chn), src_chn, sizeof(hi_mpp_chn)) != EOK) {
-        bind_spin_unlock(flags);
+    if (memcpy_s(&node->mpp_chn, sizeof(hi_mpp_chn), dest_chn, sizeof(hi_mpp_chn)) != EOK) {
         osal_kfree(node);
         node = HI_NULL;
-        sys_deinit_send_bind_src_mem(src_chn);
+        sys_bind_snap_put(snap);
         return HI_ERR_SYS_ILLEGAL_PARAM;
     }
-    dest_bind->is_bind_src = HI_TRUE;
-    dest_bind->send_cnt = 0;
-    dest_bind->reset_cnt = 0;
 
-    if (memcpy_s(&node->mpp_chn, sizeof(hi_mpp_chn), dest_chn, sizeof(hi_mpp_chn)) != EOK) {
+    bind_spin_lock(flags);
+
+    if (memcpy_s(&dest_bind->bind_src, sizeof(hi_mpp_chn), src_chn, sizeof(hi_mpp_chn)) != EOK) {
         bind_spin_unlock(flags);
         osal_kfree(node);
         node = HI_NULL;
-        sys_deinit_send_bind_src_mem(src_chn);
+        sys_bind_snap_put(snap);
         return HI_ERR_SYS_ILLEGAL_PARAM;
     }
+    dest_bind->is_bind_src = HI_TRUE;
+    bind_stat_lock(stat_flags);
+    dest_bind->last_send_time = 0;
+    (hi_void)memset_s(&dest_bind->stat, sizeof(dest_bind->stat), 0, sizeof(dest_bind->stat));
+    bind_stat_unlock(stat_flags);
 
     osal_list_add_tail(&node->list, &src_bind->list_head);
     src_bind->dest_num++;
 
+    snap = sys_bind_snap_publish(src_chn, snap);
+
     bind_spin_unlock(flags);
+
+    sys_bind_snap_retire(snap);
     return HI_SUCCESS;
 }
 
@@ -704,6 +806,41 @@ hi_s32 sys_get_bind_by_dest(hi_mpp_chn *dest_chn, hi_mpp_chn *src_chn, hi_bool i
     return HI_SUCCESS;
 }
 
+hi_s32 sys_get_bind_stat(hi_mpp_chn *dest_chn, hi_mpp_chn *src_chn, sys_bind_stat *stat)
+{
+    hi_s32 ret;
+    sys_bind_dest *dest_bind = HI_NULL;
+    unsigned long flags;
+    unsigned long stat_flags;
+
+    sys_check_null_ptr_return(dest_chn);
+    sys_check_null_ptr_return(src_chn);
+    sys_check_null_ptr_return(stat);
+
+    bind_spin_lock(flags);
+
+    ret = sys_get_bind_valid_dest_tbl(dest_chn, &dest_bind);
+    if (ret != HI_SUCCESS) {
+        bind_spin_unlock(flags);
+        return ret;
+    }
+
+    if (dest_bind->is_bind_src == HI_FALSE) {
+        sys_err_trace("dest have not bind any src \n");
+        bind_spin_unlock(flags);
+        return HI_ERR_SYS_ILLEGAL_PARAM;
+    }
+
+    (hi_void)memcpy_s(src_chn, sizeof(hi_mpp_chn), &dest_bind->bind_src, sizeof(hi_mpp_chn));
+    bind_stat_lock(stat_flags);
+    (hi_void)memcpy_s(stat, sizeof(sys_bind_stat), &dest_bind->stat, sizeof(sys_bind_stat));
+    bind_stat_unlock(stat_flags);
+
+    bind_spin_unlock(flags);
+
+    return HI_SUCCESS;
+}
+
 hi_s32 sys_get_bind_by_src(hi_mpp_chn *src_chn, hi_mpp_bind_dest *bind_dest)
 {
     hi_s32 ret;
@@ -836,54 +973,61 @@ fail:
 hi_s32 sys_bind_unregister_sender(hi_mod_id mod_id)
 {
     unsigned long flags;
+    sys_binder_ctx *binder_ctx = HI_NULL;
 
     if (sys_check_bind_mod_id(mod_id) != HI_SUCCESS) {
         return HI_ERR_SYS_ILLEGAL_PARAM;
     }
 
     bind_spin_lock(flags);
-    if (g_sender_tbl[mod_id] == HI_NULL) {
+    binder_ctx = g_sender_tbl[mod_id];
+    if (binder_ctx == HI_NULL) {
         sys_err_trace("mod:%d have not register ! \n", mod_id);
         bind_spin_unlock(flags);
         return HI_ERR_SYS_NOT_PERM;
     }
 
-    sys_deinit_sender(g_sender_tbl[mod_id], g_sender_tbl[mod_id]->tbl_size);
-    osal_kfree(g_sender_tbl[mod_id]);
     g_sender_tbl[mod_id] = HI_NULL;
+    sys_deinit_sender(binder_ctx, binder_ctx->tbl_size);
     bind_spin_unlock(flags);
 
+    /* sys_bind_send_data may still look at the ctx inside its rcu read side */
+    osal_synchronize_rcu();
+    osal_kfree(binder_ctx);
+    sys_free_mod_send_src_bind_mem(mod_id);
+
     return HI_SUCCESS;
 }
 
 hi_s32 sys_bind_unregister_receiver(hi_mod_id mod_id)
 {
     unsigned long flags;
+    sys_binder_ctx *binder_ctx = HI_NULL;
 
     if (sys_check_bind_mod_id(mod_id) != HI_SUCCESS) {
         return HI_ERR_SYS_ILLEGAL_PARAM;
     }
 
     bind_spin_lock(flags);
-    if (g_receiver_tbl[mod_id] == HI_NULL) {
+    binder_ctx = g_receiver_tbl[mod_id];
+    if (binder_ctx == HI_NULL) {
         sys_err_trace("mod:%d have not register ! \n", mod_id);
         bind_spin_unlock(flags);
         return HI_ERR_SYS_NOT_PERM;
     }
 
-    sys_deinit_receiver(g_receiver_tbl[mod_id]);
-
-    osal_kfree(g_receiver_tbl[mod_id]);
     g_receiver_tbl[mod_id] = HI_NULL;
     bind_spin_unlock(flags);
 
+    osal_synchronize_rcu();
+    sys_deinit_receiver(binder_ctx);
+    osal_kfree(binder_ctx);
+
     return HI_SUCCESS;
 }
 
-static hi_s32 sys_send_check_reciever_valid(hi_mod_id mod_id, hi_u32 flag)
+static hi_s32 sys_send_check_reciever_valid(sys_binder_ctx *receiver, hi_mod_id mod_id)
 {
-    sys_binder_ctx *receiver = g_receiver_tbl[mod_id];
-
     if (receiver == HI_NULL) {
         sys_warn_trace("mod %d have not register !\n", mod_id);
         return HI_FAILURE;
@@ -893,6 +1037,11 @@ static hi_s32 sys_send_check_reciever_valid(hi_mod_id mod_id, hi_u32 flag)
         return HI_FAILURE;
     }
 
+    return HI_SUCCESS;
+}
+
+static hi_s32 sys_send_check_delay_mode(sys_binder_ctx *receiver, hi_u32 flag)
+{
     if ((((flag & SYS_SEND_DATA_DELAY_MASK) == SYS_SEND_DATA_LOWDELAY) &&
         (!receiver->support_delay_data)) ||
         (((flag & SYS_SEND_DATA_DELAY_MASK) == SYS_SEND_DATA_LOWDELAY_FINISH) &&
@@ -903,16 +1052,62 @@ static hi_s32 sys_send_check_reciever_valid(hi_mod_id mod_id, hi_u32 flag)
     return HI_SUCCESS;
 }
 
+static hi_u32 sys_bind_hist_idx(hi_u32 us)
+{
+    hi_u32 idx = 0;
+
+    while ((us != 0) && (idx < SYS_BIND_HIST_NUM - 1)) {
+        us >>= 1;
+        idx++;
+    }
+
+    return idx;
+}
+
+static hi_void sys_bind_hist_add(hi_u32 *hist, hi_u32 *max, hi_u64 ns)
+{
+    hi_u64 us = osal_div_u64(ns, 1000); /* 1000: ns to us */
+    hi_u32 us32 = (us > 0xFFFFFFFF) ? 0xFFFFFFFF : (hi_u32)us;
+
+    hist[sys_bind_hist_idx(us32)]++;
+    if (us32 > *max) {
+        *max = us32;
+    }
+}
+
+/* account one call_back of dest_chn that took cost ns and returned ret */
+static hi_void sys_bind_send_done(hi_mpp_chn *dest_chn, sys_binder_ctx *receiver, hi_u64 cost, hi_s32 ret)
+{
+    sys_bind_dest *dest_bind = HI_NULL;
+    unsigned long flags;
+
+    osal_rcu_read_lock();
+    /* the receiver may have gone away while its call_back ran */
+    if (bind_rcu_dereference(g_receiver_tbl[dest_chn->mod_id]) == receiver) {
+        dest_bind = &receiver->dest_tbl[sys_get_idx_by_dev_chn(receiver, dest_chn->dev_id, dest_chn->chn_id)];
+        bind_stat_lock(flags);
+        sys_bind_hist_add(dest_bind->stat.call_back_hist, &dest_bind->stat.call_back_max, cost);
+        if (ret != HI_SUCCESS) {
+            dest_bind->stat.fail_cnt[SYS_BIND_FAIL_REFUSED]++;
+            dest_bind->stat.last_err = ret;
+        }
+        bind_stat_unlock(flags);
+    }
+    osal_rcu_read_unlock();
+}
+
 hi_s32 sys_bind_really_send_data(hi_mpp_bind_dest *send_bind_src, hi_u32 flag, mpp_data_type data_type,
     hi_void *v_data)
 {
     hi_u32 i;
-    unsigned long flags;
     hi_s32 ret = HI_SUCCESS;
     hi_s32 tmp_ret;
     hi_u32 dest_tbl_idx;
+    hi_u64 now;
+    unsigned long flags;
     sys_bind_dest *dest_bind = HI_NULL;
     sys_binder_ctx *receiver = HI_NULL;
+    hi_s32 (*call_back)(hi_s32 dev_id, hi_s32 chn_id, hi_bool block, mpp_data_type data_type, hi_void *pv_data);
 
     if (send_bind_src->num == 0) {
         sys_warn_trace("have not binder !\n");
@@ -924,24 +1119,43 @@ hi_s32 sys_bind_really_send_data(hi_mpp_bind_dest *send_bind_src, hi_u32 flag, m
     }
 
     for (i = 0; i < send_bind_src->num; i++) {
-        bind_spin_lock(flags);
+        osal_rcu_read_lock();
 
         HI_ASSERT(send_bind_src->mpp_chn[i].mod_id < HI_ID_BUTT);
-        receiver = g_receiver_tbl[send_bind_src->mpp_chn[i].mod_id];
+        receiver = bind_rcu_dereference(g_receiver_tbl[send_bind_src->mpp_chn[i].mod_id]);
 
-        if (sys_send_check_reciever_valid(send_bind_src->mpp_chn[i].mod_id, flag) != HI_SUCCESS) {
-            bind_spin_unlock(flags);
+        if (sys_send_check_reciever_valid(receiver, send_bind_src->mpp_chn[i].mod_id) != HI_SUCCESS) {
+            osal_rcu_read_unlock();
             continue;
         }
 
         dest_tbl_idx = sys_get_idx_by_dev_chn(receiver, send_bind_src->mpp_chn[i].dev_id,
             send_bind_src->mpp_chn[i].chn_id);
         dest_bind = &receiver->dest_tbl[dest_tbl_idx];
-        dest_bind->send_cnt++;
+        if (sys_send_check_delay_mode(receiver, flag) != HI_SUCCESS) {
+            bind_stat_lock(flags);
+            dest_bind->stat.fail_cnt[SYS_BIND_FAIL_DELAY_MODE]++;
+            bind_stat_unlock(flags);
+            osal_rcu_read_unlock();
+            continue;
+        }
 
-        bind_spin_unlock(flags);
-        tmp_ret = receiver->call_back(send_bind_src->mpp_chn[i].dev_id,
+        /* read inside the lock, so that last_send_time never goes back */
+        bind_stat_lock(flags);
+        now = osal_sched_clock();
+        if (dest_bind->last_send_time != 0) {
+            sys_bind_hist_add(dest_bind->stat.interval_hist, &dest_bind->stat.interval_max,
+                now - dest_bind->last_send_time);
+        }
+        dest_bind->last_send_time = now;
+        dest_bind->stat.send_cnt++;
+        bind_stat_unlock(flags);
+        call_back = receiver->call_back;
+
+        osal_rcu_read_unlock();
+        tmp_ret = call_back(send_bind_src->mpp_chn[i].dev_id,
             send_bind_src->mpp_chn[i].chn_id, (flag & SYS_SEND_DATA_BLOCK_MASK), data_type, v_data);
+        sys_bind_send_done(&send_bind_src->mpp_chn[i], receiver, osal_sched_clock() - now, tmp_ret);
         if ((flag & SYS_SEND_DATA_BLOCK_MASK) == SYS_SEND_DATA_NOBLOCK) {
             ret = (hi_u32)ret & (hi_u32)tmp_ret;
         } else {
@@ -957,8 +1171,7 @@ hi_s32 sys_bind_send_data(hi_mod_id mod_id, hi_s32 dev_id, hi_s32 chn_id, hi_u32
 {
     hi_s32 ret;
     hi_mpp_chn bind_chn;
-    hi_mpp_bind_dest *send_bind_src = HI_NULL;
-    unsigned long flags;
+    sys_bind_snap *send_bind_src = HI_NULL;
 
     HI_ASSERT(mod_id < HI_ID_BUTT);
     HI_ASSERT(data_type < MPP_DATA_BUTT);
@@ -967,30 +1180,25 @@ hi_s32 sys_bind_send_data(hi_mod_id mod_id, hi_s32 dev_id, hi_s32 chn_id, hi_u32
     bind_adjust_src_dev_id(mod_id, dev_id);
     bind_adjust_src_chn_id(mod_id, chn_id);
 
-    bind_spin_lock(flags);
-
     bind_chn.mod_id = mod_id;
     bind_chn.dev_id = dev_id;
     bind_chn.chn_id = chn_id;
-    ret = sys_get_bind_valid_send_ctx(&bind_chn, &send_bind_src);
+    ret = sys_bind_snap_get(&bind_chn, &send_bind_src);
     if (ret != HI_SUCCESS) {
-        bind_spin_unlock(flags);
         return HI_ERR_SYS_NOT_PERM;
     }
 
-    send_bind_src->num = 0;
-    ret = sys_get_binder_by_src(&bind_chn, send_bind_src);
-    HI_ASSERT(ret == HI_SUCCESS);
+    ret = sys_bind_really_send_data(&send_bind_src->bind_dest, flag, data_type, v_data);
+    sys_bind_snap_put(send_bind_src);
 
-    bind_spin_unlock(flags);
-
-    return sys_bind_really_send_data(send_bind_src, flag, data_type, v_data);
+    return ret;
 }
 
 hi_s32 sys_bind_really_reset_data(hi_mpp_bind_dest *send_bind_src, hi_void *private)
 {
     hi_u32 i;
     unsigned long flags;
+    unsigned long stat_flags;
     sys_bind_dest *dest_bind = HI_NULL;
     sys_binder_ctx *receiver = HI_NULL;
 
@@ -1009,7 +1217,9 @@ hi_s32 sys_bind_really_reset_data(hi_mpp_bind_dest *send_bind_src, hi_void *priv
             sys_unlock_may_in_interrupt_return(flags);
             continue;
         }
-        dest_bind->reset_cnt++;
+        bind_stat_lock(stat_flags);
+        dest_bind->stat.reset_cnt++;
+        bind_stat_unlock(stat_flags);
 
         if (receiver->reset_call_back == HI_NULL) {
             sys_unlock_may_in_interrupt_return(flags);
@@ -1028,8 +1238,7 @@ hi_s32 sys_bind_reset_data(hi_mod_id mod_id, hi_s32 dev_id, hi_s32 chn_id, hi_vo
 {
     hi_s32 ret;
     hi_mpp_chn bind_chn;
-    hi_mpp_bind_dest *send_bind_src = HI_NULL;
-    unsigned long flags;
+    sys_bind_snap *send_bind_src = HI_NULL;
 
     HI_ASSERT(mod_id < HI_ID_BUTT);
     sys_check_null_ptr_return(private);
@@ -1037,24 +1246,18 @@ hi_s32 sys_bind_reset_data(hi_mod_id mod_id, hi_s32 dev_id, hi_s32 chn_id, hi_vo
     bind_adjust_src_dev_id(mod_id, dev_id);
     bind_adjust_src_chn_id(mod_id, chn_id);
 
-    sys_lock_may_in_interrupt_return(flags);
-
     bind_chn.mod_id = mod_id;
     bind_chn.dev_id = dev_id;
     bind_chn.chn_id = chn_id;
-    ret = sys_get_bind_valid_send_ctx(&bind_chn, &send_bind_src);
+    ret = sys_bind_snap_get(&bind_chn, &send_bind_src);
     if (ret != HI_SUCCESS) {
-        sys_unlock_may_in_interrupt_return(flags);
         return ret;
     }
 
-    send_bind_src->num = 0;
-    ret = sys_get_binder_by_src(&bind_chn, send_bind_src);
-    HI_ASSERT(ret == HI_SUCCESS);
-
-    sys_unlock_may_in_interrupt_return(flags);
+    ret = sys_bind_really_reset_data(&send_bind_src->bind_dest, private);
+    sys_bind_snap_put(send_bind_src);
 
-    return sys_bind_really_reset_data(send_bind_src, private);
+    return ret;
 }
 
 hi_void sys_proc_show_sec_bindship(osal_proc_entry_t *s, sys_bind_node *node, sys_binder_ctx *sec_sender,
@@ -1083,7 +1286,7 @@ hi_void sys_proc_show_sec_bindship(osal_proc_entry_t *s, sys_bind_node *node, sy
                     bind_get_mod_name(fir_mpp_chn->mod_id), fir_mpp_chn->dev_id, fir_mpp_chn->chn_id,
                     bind_get_mod_name(node->mpp_chn.mod_id), node->mpp_chn.dev_id, k,
                     bind_get_mod_name(node2->mpp_chn.mod_id), node2->mpp_chn.dev_id, node2->mpp_chn.chn_id,
-                    dest_bind->send_cnt, dest_bind->reset_cnt);
+                    dest_bind->stat.send_cnt, dest_bind->stat.reset_cnt);
             }
             print_sec = HI_TRUE;
         }
@@ -1093,11 +1296,78 @@ hi_void sys_proc_show_sec_bindship(osal_proc_entry_t *s, sys_bind_node *node, sy
         osal_seq_printf(s, "%8s" "%8d" "%8d" "%8s" "%8d" "%8d" "%8s" "%8d" "%8d" "%11d" "%11u" "\n",
             bind_get_mod_name(fir_mpp_chn->mod_id), fir_mpp_chn->dev_id, fir_mpp_chn->chn_id,
             bind_get_mod_name(node->mpp_chn.mod_id), node->mpp_chn.dev_id, node->mpp_chn.chn_id,
-            "null", 0, 0, dest_bind->send_cnt, dest_bind->reset_cnt);
+            "null", 0, 0, dest_bind->stat.send_cnt, dest_bind->stat.reset_cnt);
     }
 }
 
 #ifdef CONFIG_HI_PROC_SHOW_SUPPORT
+static hi_void sys_bind_proc_show_hist(osal_proc_entry_t *s, const hi_char *name, const hi_u32 *hist)
+{
+    hi_u32 i;
+    hi_u32 last = 0;
+
+    for (i = 0; i < SYS_BIND_HIST_NUM; i++) {
+        if (hist[i] != 0) {
+            last = i;
+        }
+    }
+
+    osal_seq_printf(s, "%16s:", name);
+    for (i = 0; i <= last; i++) {
+        osal_seq_printf(s, " %u", hist[i]);
+    }
+    osal_seq_printf(s, "\n");
+}
+
+static hi_void sys_bind_proc_show_stat(osal_proc_entry_t *s)
+{
+    hi_u32 i, j;
+    hi_s32 dev_id = 0;
+    hi_s32 chn_id = 0;
+    sys_binder_ctx *receiver = HI_NULL;
+    sys_bind_dest *dest_bind = HI_NULL;
+    sys_bind_stat stat;
+    unsigned long flags;
+    unsigned long stat_flags;
+
+    osal_seq_printf(s, "\n-----BIND STATISTICS (hist bucket n counts [2^(n-1), 2^n) us)--------------------\n");
+    osal_seq_printf(s, "%8s" "%8s" "%8s" "%8s" "%8s" "%8s" "%11s" "%11s" "%11s" "%11s" "%11s" "%11s" "\n",
+        "SrcMod", "SrcDev", "SrcChn", "DstMod", "DstDev", "DstChn", "SendCnt", "DelaySkip", "Refused",
+        "LastErr", "CbMax", "IntvMax");
+
+    bind_spin_lock(flags);
+
+    for (i = 0; i < HI_ID_BUTT; i++) {
+        receiver = g_receiver_tbl[i];
+        if (receiver == HI_NULL) {
+            continue;
+        }
+
+        for (j = 0; j < receiver->tbl_size; j++) {
+            dest_bind = &receiver->dest_tbl[j];
+            if (dest_bind->is_bind_src == HI_FALSE) {
+                continue;
+            }
+
+            bind_stat_lock(stat_flags);
+            (hi_void)memcpy_s(&stat, sizeof(stat), &dest_bind->stat, sizeof(dest_bind->stat));
+            bind_stat_unlock(stat_flags);
+
+            sys_get_dev_chn_by_idx(receiver, j, &dev_id, &chn_id);
+            osal_seq_printf(s, "%8s" "%8d" "%8d" "%8s" "%8d" "%8d" "%11u" "%11u" "%11u" "%11x" "%11u" "%11u" "\n",
+                bind_get_mod_name(dest_bind->bind_src.mod_id), dest_bind->bind_src.dev_id,
+                dest_bind->bind_src.chn_id, bind_get_mod_name(i), dev_id, chn_id,
+                stat.send_cnt, stat.fail_cnt[SYS_BIND_FAIL_DELAY_MODE],
+                stat.fail_cnt[SYS_BIND_FAIL_REFUSED], stat.last_err,
+                stat.call_back_max, stat.interval_max);
+            sys_bind_proc_show_hist(s, "CbHist", stat.call_back_hist);
+            sys_bind_proc_show_hist(s, "IntvHist", stat.interval_hist);
+        }
+    }
+
+    bind_spin_unlock(flags);
+}
+
 hi_void sys_bind_proc_show(osal_proc_entry_t *s)
 {
     hi_u32 i, j;
@@ -1146,7 +1416,7 @@ hi_void sys_bind_proc_show(osal_proc_entry_t *s)
                     osal_seq_printf(s, "%8s" "%8d" "%8d" "%8s" "%8d" "%8d" "%8s" "%8d" "%8d" "%11d" "%11u" "\n",
                         bind_get_mod_name(i), fir_mpp_chn.dev_id, fir_mpp_chn.chn_id,
                         bind_get_mod_name(node->mpp_chn.mod_id), node->mpp_chn.dev_id, node->mpp_chn.chn_id,
-                        "null", 0, 0, dest_bind->send_cnt, dest_bind->reset_cnt);
+                        "null", 0, 0, dest_bind->stat.send_cnt, dest_bind->stat.reset_cnt);
                     continue;
                 }
 
@@ -1155,6 +1425,8 @@ hi_void sys_bind_proc_show(osal_proc_entry_t *s)
         }
     }
     bind_spin_unlock(flags);
+
+    sys_bind_proc_show_stat(s);
 }
 #endif
 
@@ -1164,7 +1436,13 @@ hi_s32 sys_bind_mod_init(hi_void)
         return HI_FAILURE;
     }
 
+    if (bind_stat_lock_init() < 0) {
+        bind_spin_lock_uninit();
+        return HI_FAILURE;
+    }
+
     if (bind_sem_init() < 0) {
+        bind_stat_lock_uninit();
         bind_spin_lock_uninit();
         return HI_FAILURE;
     }
@@ -1182,24 +1460,13 @@ hi_s32 sys_bind_init(hi_void)
 
 hi_void sys_bind_mod_exit(hi_void)
 {
+    bind_stat_lock_uninit();
     bind_spin_lock_uninit();
     bind_sem_uninit();
 
     return;
 }
 
-static hi_void sys_free_mod_send_src_bind_mem(MOD_ID_E mod)
-{
-    hi_u32 j;
-
-    for (j = 0; j < g_bind_send[mod].max_index; j++) {
-        if (g_bind_send[mod].send_bind_src[j] != HI_NULL) {
-            osal_kfree(g_bind_send[mod].send_bind_src[j]);
-            g_bind_send[mod].send_bind_src[j] = HI_NULL;
-        }
-    }
-}
-
 hi_void sys_bind_exit(hi_void)
 {
     hi_s32 i;
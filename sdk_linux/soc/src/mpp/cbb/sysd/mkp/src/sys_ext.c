@@ -595,6 +595,12 @@ static long sys_ioctl(unsigned int cmd, unsigned long arg, void *private_data)
                 break;
             }
 
+            case SYS_GET_BIND_STAT: {
+                sys_bind_stat_args *stat_arg = (sys_bind_stat_args *)(hi_uintptr_t)arg;
+                ret = sys_get_bind_stat(&stat_arg->dest_chn, &stat_arg->src_chn, &stat_arg->stat);
+                break;
+            }
+
             case SYS_MEM_SET_CTRL: {
                 sys_mem_args *mem_arg = (sys_mem_args *)(hi_uintptr_t)arg;
                 ret = sys_set_mem_conf(&mem_arg->mpp_chn, mem_arg->mmz_name);
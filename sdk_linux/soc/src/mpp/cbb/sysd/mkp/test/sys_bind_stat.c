@@ -0,0 +1,457 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Userspace test of the bind statistics of sys_bind.c, built as is against
+ * hi_osal.h with the OSAL calls it makes implemented on pthreads below.
+ * osal_sched_clock() reads a fake clock that only the test moves, so every
+ * interval and call_back duration is synthetic and known in advance.
+ *   buckets     hist bucket of each duration around the powers of two
+ *   timings     a bound VDEC -> VPSS pair fed with chosen intervals and
+ *               call_back costs: both histograms, maxima and send count
+ *               match a reference bucketing
+ *   failures    refused low delay data, call_back errors, resets, and the
+ *               reset of everything on a new bind
+ *   concurrent  VDEC devices 0 and 1 send at once, both fold into device 0
+ *               and so into one dest: no count lost, no negative interval
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/sys_bind.c"
+
+#define STAT_THREADS       4
+#define STAT_FRAMES        20000 /* per thread */
+#define STAT_TIMED_FRAMES  2000
+#define STAT_PROC_LEN      65536
+#define STAT_SEED          20211123
+
+#define tool_check(cond, name) \
+    do { \
+        if (cond) { \
+            printf("ok   %s\n", name); \
+        } else { \
+            printf("FAIL %s\n", name); \
+            g_fail++; \
+        } \
+    } while (0)
+
+static hi_u32 g_fail = 0;
+
+static struct {
+    hi_u64 clock;               /* ns, read by osal_sched_clock */
+    hi_u64 cost;                /* ns the call_back takes, single thread runs only */
+    hi_s32 call_back_ret;
+    hi_u32 call_back_cnt;
+    hi_u32 reset_cnt;
+    hi_char proc[STAT_PROC_LEN];
+    hi_u32 proc_len;
+} g_host;
+
+/* ------------------------------------------------------------------ host OSAL */
+
+int osal_spin_lock_init(osal_spinlock_t *lock)
+{
+    lock->lock = malloc(sizeof(pthread_spinlock_t));
+    return (lock->lock == NULL) ? -1 : pthread_spin_init(lock->lock, PTHREAD_PROCESS_PRIVATE);
+}
+
+void osal_spin_lock_irqsave(osal_spinlock_t *lock, unsigned long *flags)
+{
+    *flags = 0;
+    pthread_spin_lock(lock->lock);
+}
+
+void osal_spin_unlock_irqrestore(osal_spinlock_t *lock, const unsigned long *flags)
+{
+    (void)flags;
+    pthread_spin_unlock(lock->lock);
+}
+
+void osal_spin_lock_destroy(osal_spinlock_t *lock)
+{
+    if (lock->lock != NULL) {
+        pthread_spin_destroy(lock->lock);
+        free(lock->lock);
+        lock->lock = NULL;
+    }
+}
+
+int osal_sema_init(osal_semaphore_t *sem, int val)
+{
+    (void)val;
+    sem->sem = malloc(sizeof(pthread_mutex_t));
+    return (sem->sem == NULL) ? -1 : pthread_mutex_init(sem->sem, NULL);
+}
+
+int osal_down_interruptible(osal_semaphore_t *sem)
+{
+    return pthread_mutex_lock(sem->sem);
+}
+
+void osal_up(osal_semaphore_t *sem)
+{
+    pthread_mutex_unlock(sem->sem);
+}
+
+void osal_sema_destroy(osal_semaphore_t *sem)
+{
+    if (sem->sem != NULL) {
+        pthread_mutex_destroy(sem->sem);
+        free(sem->sem);
+        sem->sem = NULL;
+    }
+}
+
+int osal_atomic_init(osal_atomic_t *atomic)
+{
+    atomic->atomic = calloc(1, sizeof(int));
+    return (atomic->atomic == NULL) ? -1 : 0;
+}
+
+void osal_atomic_destroy(osal_atomic_t *atomic)
+{
+    free(atomic->atomic);
+    atomic->atomic = NULL;
+}
+
+void osal_atomic_set(osal_atomic_t *atomic, int i)
+{
+    __atomic_store_n((int *)atomic->atomic, i, __ATOMIC_SEQ_CST);
+}
+
+int osal_atomic_inc_return(osal_atomic_t *atomic)
+{
+    return __atomic_add_fetch((int *)atomic->atomic, 1, __ATOMIC_SEQ_CST);
+}
+
+int osal_atomic_dec_return(osal_atomic_t *atomic)
+{
+    return __atomic_sub_fetch((int *)atomic->atomic, 1, __ATOMIC_SEQ_CST);
+}
+
+void osal_smp_wmb(void)
+{
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/* the test never unbinds while sending, so no reader outlives an update */
+void osal_rcu_read_lock(void)
+{
+}
+
+void osal_rcu_read_unlock(void)
+{
+}
+
+void osal_synchronize_rcu(void)
+{
+}
+
+int osal_in_interrupt(void)
+{
+    return 0;
+}
+
+void *osal_kmalloc(unsigned long size, unsigned int osal_gfp_flag)
+{
+    (void)osal_gfp_flag;
+    return malloc(size);
+}
+
+void osal_kfree(const void *addr)
+{
+    free((void *)addr);
+}
+
+unsigned long long osal_div_u64(unsigned long long dividend, unsigned int divisor)
+{
+    return dividend / divisor;
+}
+
+unsigned long long osal_sched_clock(void)
+{
+    return __atomic_load_n(&g_host.clock, __ATOMIC_SEQ_CST);
+}
+
+void osal_seq_printf(osal_proc_entry_t *entry, const char *fmt, ...)
+{
+    va_list args;
+    int ret;
+
+    (void)entry;
+    va_start(args, fmt);
+    ret = vsnprintf(g_host.proc + g_host.proc_len, STAT_PROC_LEN - g_host.proc_len, fmt, args);
+    va_end(args);
+    if (ret > 0) {
+        g_host.proc_len += ((hi_u32)ret < STAT_PROC_LEN - g_host.proc_len) ? (hi_u32)ret : 0;
+    }
+}
+
+hi_char *cmpi_get_module_name(hi_mod_id mod_id)
+{
+    return (mod_id == HI_ID_VDEC) ? "vdec" : ((mod_id == HI_ID_VPSS) ? "vpss" : HI_NULL);
+}
+
+/* ------------------------------------------------------------------ receiver */
+
+static hi_u64 stat_clock_advance(hi_u64 ns)
+{
+    return __atomic_add_fetch(&g_host.clock, ns, __ATOMIC_SEQ_CST);
+}
+
+static hi_s32 stat_call_back(hi_s32 dev_id, hi_s32 chn_id, hi_bool block, mpp_data_type data_type, hi_void *pv_data)
+{
+    (void)dev_id;
+    (void)chn_id;
+    (void)block;
+    (void)data_type;
+    (void)pv_data;
+    __atomic_add_fetch(&g_host.call_back_cnt, 1, __ATOMIC_SEQ_CST);
+    stat_clock_advance(g_host.cost);
+    return g_host.call_back_ret;
+}
+
+static hi_s32 stat_reset_call_back(hi_s32 dev_id, hi_s32 chn_id, hi_void *pv_data)
+{
+    (void)dev_id;
+    (void)chn_id;
+    (void)pv_data;
+    g_host.reset_cnt++;
+    return HI_SUCCESS;
+}
+
+static hi_mpp_chn g_src = { HI_ID_VDEC, 0, 0 };
+static hi_mpp_chn g_dest = { HI_ID_VPSS, 0, 0 };
+
+static hi_void stat_setup(hi_void)
+{
+    bind_sender_info sender = { HI_ID_VDEC, 2, 1, HI_NULL }; /* 2: devices 0 and 1, both send as device 0 */
+    bind_receiver_info receiver = { HI_ID_VPSS, 1, 1, stat_call_back, stat_reset_call_back, HI_FALSE };
+
+    if ((sys_bind_mod_init() != HI_SUCCESS) || (sys_bind_init() != HI_SUCCESS) ||
+        (sys_bind_register_sender(&sender) != HI_SUCCESS) || (sys_bind_register_receiver(&receiver) != HI_SUCCESS) ||
+        (sys_bind(&g_src, &g_dest) != HI_SUCCESS)) {
+        printf("bind setup failed\n");
+        exit(1);
+    }
+}
+
+static hi_void stat_get(sys_bind_stat *stat)
+{
+    hi_mpp_chn src;
+
+    if (sys_get_bind_stat(&g_dest, &src, stat) != HI_SUCCESS) {
+        printf("sys_get_bind_stat failed\n");
+        exit(1);
+    }
+}
+
+static hi_u32 stat_sum(const hi_u32 *hist)
+{
+    hi_u32 i;
+    hi_u32 sum = 0;
+
+    for (i = 0; i < SYS_BIND_HIST_NUM; i++) {
+        sum += hist[i];
+    }
+    return sum;
+}
+
+/* bucket of us by definition: 0 for 0, then i for [2^(i-1), 2^i), the last one open */
+static hi_u32 stat_ref_bucket(hi_u64 us)
+{
+    hi_u32 i;
+
+    if (us == 0) {
+        return 0;
+    }
+    for (i = 1; i < SYS_BIND_HIST_NUM - 1; i++) {
+        if (us < (1ULL << i)) {
+            return i;
+        }
+    }
+    return SYS_BIND_HIST_NUM - 1;
+}
+
+static hi_u64 g_seed = STAT_SEED;
+
+static hi_u64 stat_rand(hi_u64 n)
+{
+    g_seed = g_seed * 6364136223846793005ULL + 1442695040888963407ULL; /* 64-bit LCG */
+    return (g_seed >> 16) % n; /* 16: the low bits are the least random */
+}
+
+/* a duration in a random bucket, up to 2^22 us so that the open last bucket gets some */
+static hi_u64 stat_rand_ns(hi_void)
+{
+    hi_u64 bits = stat_rand(SYS_BIND_HIST_NUM + 3); /* 3: buckets past the last one */
+    hi_u64 us = (bits == 0) ? 0 : ((1ULL << (bits - 1)) + stat_rand(1ULL << (bits - 1)));
+
+    return us * 1000 + stat_rand(1000); /* 1000: ns per us */
+}
+
+/* ------------------------------------------------------------------ checks */
+
+static hi_void test_buckets(hi_void)
+{
+    const struct {
+        hi_u64 ns;
+        hi_u32 idx;
+    } cases[] = {
+        { 0, 0 }, { 999, 0 }, { 1000, 1 }, { 1999, 1 }, { 2000, 2 }, { 3999, 2 }, { 4000, 3 },
+        { 1023999, 10 }, { 1024000, 11 }, { 262143999, 18 }, { 262144000, 19 }, { 1ULL << 50, 19 },
+    };
+    hi_u32 i;
+    hi_u32 ok = 0;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        hi_u32 hist[SYS_BIND_HIST_NUM] = { 0 };
+        hi_u32 max = 0;
+        sys_bind_hist_add(hist, &max, cases[i].ns);
+        ok += (hist[cases[i].idx] == 1) && (stat_sum(hist) == 1) &&
+            (max == ((cases[i].ns / 1000 > 0xFFFFFFFF) ? 0xFFFFFFFF : (hi_u32)(cases[i].ns / 1000))); /* 1000: us */
+    }
+    tool_check(ok == sizeof(cases) / sizeof(cases[0]), "buckets: edges of the powers of two, clamped max");
+}
+
+static hi_void test_timings(hi_void)
+{
+    hi_u32 i;
+    hi_u32 cb_ref[SYS_BIND_HIST_NUM] = { 0 };
+    hi_u32 intv_ref[SYS_BIND_HIST_NUM] = { 0 };
+    hi_u64 cb_max = 0;
+    hi_u64 intv_max = 0;
+    hi_u64 intv, cost;
+    sys_bind_stat stat;
+    hi_u32 data = 0;
+
+    g_host.call_back_ret = HI_SUCCESS;
+    for (i = 0; i < STAT_TIMED_FRAMES; i++) {
+        /* the time since the last send is the interval minus the previous call_back */
+        intv = stat_rand_ns() + g_host.cost;
+        cost = stat_rand_ns();
+        stat_clock_advance(intv - g_host.cost);
+        if (i != 0) {
+            intv_ref[stat_ref_bucket(intv / 1000)]++; /* 1000: us */
+            intv_max = (intv / 1000 > intv_max) ? intv / 1000 : intv_max; /* 1000: us */
+        }
+        g_host.cost = cost;
+        cb_ref[stat_ref_bucket(cost / 1000)]++; /* 1000: us */
+        cb_max = (cost / 1000 > cb_max) ? cost / 1000 : cb_max; /* 1000: us */
+        (hi_void)sys_bind_send_data(HI_ID_VDEC, 0, 0, SYS_SEND_DATA_BLOCK, MPP_DATA_VDEC_FRAME, &data);
+    }
+
+    stat_get(&stat);
+    tool_check(stat.send_cnt == STAT_TIMED_FRAMES, "timings: send count");
+    tool_check(memcmp(stat.call_back_hist, cb_ref, sizeof(cb_ref)) == 0, "timings: call_back histogram");
+    tool_check(memcmp(stat.interval_hist, intv_ref, sizeof(intv_ref)) == 0, "timings: interval histogram");
+    tool_check((stat.call_back_max == cb_max) && (stat.interval_max == intv_max), "timings: maxima");
+    tool_check((stat.call_back_hist[1] != 0) && (stat.call_back_hist[SYS_BIND_HIST_NUM - 1] != 0),
+        "timings: workload spans the buckets");
+}
+
+static hi_void test_failures(hi_void)
+{
+    sys_bind_stat stat;
+    hi_u32 data = 0;
+
+    g_host.cost = 0;
+    (hi_void)sys_bind_send_data(HI_ID_VDEC, 0, 0, SYS_SEND_DATA_BLOCK | SYS_SEND_DATA_LOWDELAY,
+        MPP_DATA_VDEC_FRAME, &data);
+    g_host.call_back_ret = HI_ERR_SYS_NOMEM;
+    (hi_void)sys_bind_send_data(HI_ID_VDEC, 0, 0, SYS_SEND_DATA_BLOCK, MPP_DATA_VDEC_FRAME, &data);
+    g_host.call_back_ret = HI_SUCCESS;
+    (hi_void)sys_bind_reset_data(HI_ID_VDEC, 1, 0, &data); /* 1: device 1 resets as device 0 */
+
+    stat_get(&stat);
+    tool_check(stat.fail_cnt[SYS_BIND_FAIL_DELAY_MODE] == 1, "failures: low delay data refused by the receiver");
+    tool_check((stat.fail_cnt[SYS_BIND_FAIL_REFUSED] == 1) && (stat.last_err == HI_ERR_SYS_NOMEM),
+        "failures: call_back error and its code");
+    tool_check(stat.send_cnt == STAT_TIMED_FRAMES + 1, "failures: only sent frames counted");
+    tool_check((stat.reset_cnt == 1) && (g_host.reset_cnt == 1), "failures: reset counted");
+
+    g_host.proc_len = 0;
+    sys_bind_proc_show(HI_NULL);
+    tool_check(strstr(g_host.proc, "BIND STATISTICS") != HI_NULL, "proc: statistics section shown");
+
+    (hi_void)sys_unbind(&g_src, &g_dest);
+    (hi_void)sys_bind(&g_src, &g_dest);
+    stat_get(&stat);
+    tool_check((stat.send_cnt == 0) && (stat.reset_cnt == 0) && (stat.call_back_max == 0) &&
+        (stat_sum(stat.interval_hist) == 0) && (stat.fail_cnt[SYS_BIND_FAIL_REFUSED] == 0),
+        "failures: a new bind starts from zero");
+}
+
+static hi_void *stat_sender(hi_void *arg)
+{
+    hi_s32 dev_id = (hi_s32)(uintptr_t)arg;
+    hi_u32 i;
+    hi_u32 data = 0;
+
+    for (i = 0; i < STAT_FRAMES; i++) {
+        stat_clock_advance(1000 + (i % 7) * 100); /* 1000, 7, 100: 1us to 1.6us between frames */
+        (hi_void)sys_bind_send_data(HI_ID_VDEC, dev_id, 0, SYS_SEND_DATA_BLOCK, MPP_DATA_VDEC_FRAME, &data);
+    }
+    return HI_NULL;
+}
+
+static hi_void test_concurrent(hi_void)
+{
+    pthread_t thread[STAT_THREADS];
+    sys_bind_stat stat;
+    hi_u64 start = osal_sched_clock();
+    hi_u32 i;
+
+    g_host.cost = 500; /* 500: ns */
+    g_host.call_back_cnt = 0;
+    for (i = 0; i < STAT_THREADS; i++) {
+        pthread_create(&thread[i], HI_NULL, stat_sender, (hi_void *)(uintptr_t)(i % 2)); /* 2: devices */
+    }
+    for (i = 0; i < STAT_THREADS; i++) {
+        pthread_join(thread[i], HI_NULL);
+    }
+
+    stat_get(&stat);
+    tool_check((stat.send_cnt == STAT_THREADS * STAT_FRAMES) && (g_host.call_back_cnt == stat.send_cnt),
+        "concurrent: every frame counted once");
+    tool_check(stat_sum(stat.call_back_hist) == stat.send_cnt, "concurrent: every call_back accounted");
+    tool_check(stat_sum(stat.interval_hist) == stat.send_cnt - 1, "concurrent: every interval accounted");
+    tool_check(stat.interval_max <= (osal_sched_clock() - start) / 1000, /* 1000: us */
+        "concurrent: no interval longer than the run");
+}
+
+int main(hi_void)
+{
+    stat_setup();
+    test_buckets();
+    test_timings();
+    test_failures();
+    test_concurrent();
+
+    if (g_fail != 0) {
+        printf("%u check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
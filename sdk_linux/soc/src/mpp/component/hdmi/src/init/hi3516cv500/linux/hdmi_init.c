@@ -32,6 +32,8 @@ static int hi35xx_hdmi_probe(struct platform_device *pdev)
         return PTR_ERR(hdmi_reg);
     }
     hdmi_set_reg(hdmi_reg);
+    /* without an "hdmi0" interrupt in the device tree HPD/RSEN are polled */
+    hdmi_set_init_irq(osal_platform_get_irq_byname(pdev, hdmi_dev_name));
 
     return hdmi_drv_mod_init();
 }
@@ -41,6 +43,7 @@ static int hi35xx_hdmi_remove(struct platform_device *pdev)
     hi_unused(pdev);
     hdmi_drv_mod_exit();
     hdmi_set_reg(NULL);
+    hdmi_set_init_irq(-1);
     return HI_SUCCESS;
 }
 
@@ -25,6 +25,7 @@
 #include "hi_osal.h"
 
 void hdmi_set_reg(char *reg);
+void hdmi_set_init_irq(int hdmi_irq);
 int hdmi_drv_mod_init(void);
 void hdmi_drv_mod_exit(void);
 
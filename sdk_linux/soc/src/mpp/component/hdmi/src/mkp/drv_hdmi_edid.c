@@ -29,6 +29,10 @@
 #define BIT6_MASK                           0x40
 #define BIT7_MASK                           0x80
 #define EDID_EXTENSION_BLK_ADDR             0x7e
+/* capability cache, FNV-1a hash */
+#define EDID_CACHE_HASH_BASIS               0x811c9dc5
+#define EDID_CACHE_HASH_PRIME               0x01000193
+#define EDID_MAX_EXT_BLOCK_NUM              (HDMI_EDID_MAX_BLOCK_NUM - 1)
 /* VENDOR  INFO */
 #define EDID_VEND_NAME_CHAR_MASK            0x1F
 #define EDID_VEND_CHAR_LOW_INVALID          0
@@ -327,8 +331,8 @@ static hi_s32 edid_vendor_info(hdmi_edid_info *edid_info)
     vendor->year = fst_blk->mfg_year + EDID_VEND_YEAR_BASE;
 
     edid_info("    %-20s : %s\n", "ID manufacturer name", vendor->mfrs_name);
-    edid_info("    %-20s : 0x%0.4X\n", "ID product code", vendor->product_code);
-    edid_info("    %-20s : 0x%0.8l_x\n", "ID serial number", vendor->serial_number);
+    edid_info("    %-20s : 0x%04X\n", "ID product code", vendor->product_code);
+    edid_info("    %-20s : 0x%08X\n", "ID serial number", vendor->serial_number);
     edid_info("    %-20s : %02u\n", "week of manufacture", vendor->week);
     edid_info("    %-20s : %u\n", "year of manufacture", vendor->year);
 
@@ -948,17 +952,24 @@ static hi_s32 edid_video_db(hdmi_sink_capability *cap, hdmi_edid_status *status,
     return HI_SUCCESS;
 }
 
-static hi_void edid_hfvs21_db(hdmi_sink_capability *cap, const hi_u8 *data)
+static hi_void edid_hfvs21_db(hdmi_sink_capability *cap, const hi_u8 *data, hi_u8 len)
 {
+    /* HDMI 2.1 fields are optional, a sink may stop after any of them */
     cap->fapa_start_location     = (data[0] & BIT0_MASK) ? HI_TRUE : HI_FALSE;
     cap->allm                    = (data[0] & BIT1_MASK) ? HI_TRUE : HI_FALSE;
     cap->fva                     = (data[0] & BIT2_MASK) ? HI_TRUE : HI_FALSE;
     cap->cnm_vrr                 = (data[0] & BIT3_MASK) ? HI_TRUE : HI_FALSE;
     cap->cinema_vrr              = (data[0] & BIT4_MASK) ? HI_TRUE : HI_FALSE;
     cap->m_delta                 = (data[0] & BIT5_MASK) ? HI_TRUE : HI_FALSE;
+    if (len < 3) { /* 3, byte-1~2, VRR min/max */
+        return;
+    }
     cap->vrr_min                 = data[1] & 0x3F;
     cap->vrr_max                 = data[1] & 0xC0;
     cap->vrr_max                 = (cap->vrr_max << 2) | data[2]; /* 2'b, bit[6:5] */
+    if (len < 6) { /* 6, byte-3~5, DSC */
+        return;
+    }
     cap->dsc_info.dsc_1p2        = (data[3] & BIT7_MASK) ? HI_TRUE : HI_FALSE;
     cap->dsc_info.dsc_native_420 = (data[3] & BIT6_MASK) ? HI_TRUE : HI_FALSE;
     cap->dsc_info.dsc_all_bpp    = (data[3] & BIT3_MASK) ? HI_TRUE : HI_FALSE;
@@ -1016,7 +1027,7 @@ static hi_s32 edid_hfvs_db(hdmi_sink_capability *cap, hdmi_edid_status *status,
     cap->max_frl_rate = (data[6] & EDID_UPPER_NIBBLE_MASK) >> 4; /* 4'b, bit[4:1] */
 
     if (len > 7) { /* hfvs db length extent 7~31 */
-        edid_hfvs21_db(cap, &data[7]);
+        edid_hfvs21_db(cap, &data[7], len - 7); /* 7, HDMI 2.1 fields start at byte-7 */
     }
 
     return HI_SUCCESS;
@@ -1030,15 +1041,15 @@ static hi_u32 g_common_4k_vic[] = {
     HDMI_4096X2160P24_256_135
 };
 
-static hi_void edid_latency_parse(hdmi_sink_capability *cap, hi_u8 *data, hi_u8 *offset)
+static hi_void edid_latency_parse(hdmi_sink_capability *cap, hi_u8 *data, hi_u8 len, hi_u8 *offset)
 {
-    if (cap->latency_fields_present) {
+    if (cap->latency_fields_present && (*offset + 2 <= len)) { /* 2, video & audio latency */
         cap->video_latency = data[(*offset)++];
         cap->audio_latency = data[(*offset)++];
         edid_info("    %-20s : 0x%02X\n", "video latency", cap->video_latency);
         edid_info("    %-20s : 0x%02X\n", "audio latency", cap->audio_latency);
     }
-    if (cap->i_latency_fields_present) {
+    if (cap->i_latency_fields_present && (*offset + 2 <= len)) { /* 2, video & audio latency */
         cap->interlaced_video_latency = data[(*offset)++];
         cap->interlaced_audio_latency = data[(*offset)++];
         edid_info("    %-20s : 0x%02X\n", "interlaced video latency", cap->interlaced_video_latency);
@@ -1130,7 +1141,10 @@ static hi_void edid_vsdb_prase_step9(hdmi_sink_capability *cap, hi_u8 *data, hdm
     hi_u8 _3d_multi_present = 0;
 
     offset = 8; /* offset 8 bit, data byte count + 1 */
-    edid_latency_parse(cap, data, &offset);
+    edid_latency_parse(cap, data, len, &offset);
+    if (offset >= len) {
+        return;
+    }
 
     byte = data[offset++]; /* data[8] */
     if (cap->hdmi_video_present) {
@@ -1142,7 +1156,7 @@ static hi_void edid_vsdb_prase_step9(hdmi_sink_capability *cap, hi_u8 *data, hdm
         edid_info("    %-20s : %02u\n", "image_size", (byte & (BIT4_MASK | BIT3_MASK)) >> 3); /* 3'b, BIT[1] */
     }
 
-    if (len < 10) { /* 10 offset for 3D */
+    if ((len < 10) || (offset >= len)) { /* 10 offset for 3D */
         return;
     }
     /* 10, byte-13, VIC & 3D len */
@@ -1158,7 +1172,8 @@ static hi_void edid_vsdb_prase_step9(hdmi_sink_capability *cap, hi_u8 *data, hdm
     }
 
     /* byte-following, 3D */
-    _3d_parse = ((_3d_present == HI_TRUE) && (hdmi_3d_len > 0) && (len >= (hdmi_3d_len + offset)) &&
+    /* 2, 3D_Structure_ALL is two bytes */
+    _3d_parse = ((_3d_present == HI_TRUE) && (hdmi_3d_len >= 2) && (len >= (hdmi_3d_len + offset)) &&
         ((_3d_multi_present == EDID_3DMULTI_PRESENT_LOWER8) || (_3d_multi_present == EDID_3DMULTI_PRESENT_UPPER8)));
     if (_3d_parse == HI_TRUE) {
         edid_3d_parse(cap, data, &offset);
@@ -1306,7 +1321,7 @@ static hi_s32 edid_y420_cap_map_db(hdmi_sink_capability *cap, hi_u8 *data, hi_u8
             }
         }
     } else { /* or, for sv_ds which support YUV420, the corresponding bit shall be set to 1 here. */
-        loop = len * 8; /* 8bit eq 1 byte  */
+        loop = (len - 1) * 8; /* 8bit eq 1 byte, len counts the ext tag code */
         for (i = 0; (i < loop) && (i < cap->support_vic_num) && (i < HDMI_EDID_MAX_VIC_COUNT); i++) {
             /* BYTE n(i/8), BIT x(i%8) */
             if ((data[i / 8] & (0x01 << (i % 8))) &&
@@ -1402,6 +1417,10 @@ static hi_s32 edid_hdr_meta_db(hdmi_sink_capability *cap, hi_u8 *data, hi_u8 len
 
     hdr_cap = &cap->hdr_cap;
     hdmi_if_null_return(hdr_cap, HI_FAILURE);
+    if (len < 3) { /* 3, ext tag code + byte-3~4 */
+        edid_warn("HDR static metadata db len:%u\n", len);
+        return HI_SUCCESS;
+    }
 
     /* BYTE 3 */
     hdr_cap->eotf.eotf_sdr = (data[0] & BIT0_MASK) ? HI_TRUE : HI_FALSE;          /* ET_0 */
@@ -1422,7 +1441,7 @@ static hi_s32 edid_hdr_meta_db(hdmi_sink_capability *cap, hi_u8 *data, hi_u8 len
 
 static hi_s32 edid_video_cap_db(hdmi_sink_capability *cap, hi_u8 *data, hi_u8 len)
 {
-    if (len == 0) {
+    if (len < 2) { /* 2, ext tag code + 1 byte payload */
         return HI_FAILURE;
     }
 
@@ -1437,6 +1456,11 @@ static hi_s32 edid_ext_data_block_parse(hdmi_sink_capability *cap, hdmi_edid_sta
     hi_s32 ret;
     hi_u8 ext_tag_code;
 
+    if (len == 0) {
+        status->parse_warn |= 1 << EDID_PARSE_WARN_BLOCKLEN_INVALID;
+        edid_warn("EXT-BLK ext data block without ext tag code!\n");
+        return HI_SUCCESS;
+    }
     ext_tag_code = data[0];
     data++;
 
@@ -1557,26 +1581,29 @@ static hi_void edid_ext_several_block_parse(hdmi_sink_capability *cap, hdmi_edid
 {
     hi_s32 ret;
     hi_u8 *tmp = HI_NULL;
-    hi_u8 blk_offset =  EDID_EXT_BLOCK_OFFSET;
+    hi_u32 blk_offset = EDID_EXT_BLOCK_OFFSET;
     hi_u8 db_tag_code, blk_len;
-    hi_u8 dtd_offset = data[2];
-
-    tmp = data + blk_offset;
+    /* the sink controls byte-2, never walk past the checksum byte */
+    hi_u32 dtd_offset = (data[2] < (HDMI_EDID_BLOCK_SIZE - 1)) ? data[2] : (HDMI_EDID_BLOCK_SIZE - 1);
 
     /* several data block */
-    for (blk_len = 0;
-         (blk_offset < dtd_offset) && (tmp != HI_NULL);
-         blk_offset += blk_len + 1) {
-        tmp += blk_len;
+    while (blk_offset < dtd_offset) {
+        tmp = data + blk_offset;
         blk_len = (*tmp) & EDID_DB_LEN_MASK;
         db_tag_code = ((*tmp) & EDID_DB_TAG_CODE_MASK) >> 5; /* 5'b, bit[3:1] */
-        tmp++;
+        if (blk_offset + 1 + blk_len > dtd_offset) {
+            status->parse_warn |= 1 << EDID_PARSE_WARN_BLOCKLEN_INVALID;
+            edid_warn("EXT_BLK data block over dt_ds offset:%u, len:%u\n", blk_offset, blk_len);
+            break;
+        }
         /* tag code */
-        ret = edid_db_parse(cap, db_tag_code, status, tmp, blk_len);
+        ret = edid_db_parse(cap, db_tag_code, status, tmp + 1, blk_len);
         hdmi_if_failure_return_void(ret);
+        blk_offset += blk_len + 1;
     }
     /* dt_ds */
-    tmp += blk_len;
+    blk_offset = dtd_offset;
+    tmp = data + blk_offset;
     while (((HDMI_EDID_BLOCK_SIZE - 1) - blk_offset) >= EDID_DTD_SIZE) {
         ret = edid_detail_timing(cap, status, tmp, EDID_DTD_SIZE);
         hdmi_if_failure_return_void(ret);
@@ -1655,6 +1682,13 @@ static hi_s32 edid_raw_parse(hdmi_edid_info *edid_info)
 
     ret = edid_first_blk_parse(edid_info);
     hdmi_if_failure_return(ret, HI_FAILURE);
+    /* blocks that were not read are zero and would pass the checksum */
+    if ((status->raw_len / HDMI_EDID_BLOCK_SIZE) <= cap->ext_block_num) {
+        status->parse_warn |= 1 << EDID_PARSE_WARN_EXT_BLK_OVER;
+        edid_warn("ext-BLK cnt %u over raw length %u\n", cap->ext_block_num, status->raw_len);
+        cap->ext_block_num = (status->raw_len > HDMI_EDID_BLOCK_SIZE) ?
+            (hi_u8)(status->raw_len / HDMI_EDID_BLOCK_SIZE - 1) : 0;
+    }
     for (blk_num = 1; blk_num <= cap->ext_block_num; blk_num++) {
         ret = edid_extention_block_parse(edid_info, blk_num);
         hdmi_if_failure_return(ret, HI_FAILURE);
@@ -1663,6 +1697,135 @@ static hi_s32 edid_raw_parse(hdmi_edid_info *edid_info)
     return HI_SUCCESS;
 }
 
+static hi_u32 edid_cache_hash(const hi_u8 *block0, const hi_u8 *ext_sum, hi_u32 ext_num)
+{
+    hi_u32 i;
+    hi_u32 hash = EDID_CACHE_HASH_BASIS;
+
+    for (i = 0; i < HDMI_EDID_BLOCK_SIZE; i++) {
+        hash = (hash ^ block0[i]) * EDID_CACHE_HASH_PRIME;
+    }
+    for (i = 0; i < ext_num; i++) {
+        hash = (hash ^ ext_sum[i]) * EDID_CACHE_HASH_PRIME;
+    }
+
+    return hash;
+}
+
+static hi_bool edid_cache_match(const hdmi_edid_cache_entry *entry, hi_u32 hash,
+    const hi_u8 *block0, const hi_u8 *ext_sum, hi_u32 ext_num)
+{
+    hi_u32 i;
+
+    if (!entry->valid || entry->hash != hash || entry->raw_len != (ext_num + 1) * HDMI_EDID_BLOCK_SIZE) {
+        return HI_FALSE;
+    }
+    if (osal_memcmp(entry->edid_raw, block0, HDMI_EDID_BLOCK_SIZE) != 0) {
+        return HI_FALSE;
+    }
+    for (i = 0; i < ext_num; i++) {
+        /* the checksum is the last byte of extension block i + 1 */
+        if (entry->edid_raw[(i + 2) * HDMI_EDID_BLOCK_SIZE - 1] != ext_sum[i]) {
+            return HI_FALSE;
+        }
+    }
+
+    return HI_TRUE;
+}
+
+/*
+ * A known sink is recognised from block 0 and the extension checksums, which
+ * costs one block of DDC traffic instead of the whole EDID and skips the parse.
+ */
+static hi_s32 edid_cache_load(hdmi_device *hdmi_dev, hdmi_edid_info *edid_info)
+{
+    errno_t err;
+    hi_s32 ret = HI_FAILURE;
+    hi_u32 i, hash, ext_num;
+    hi_u8 ext_sum[EDID_MAX_EXT_BLOCK_NUM] = {0};
+    hdmi_edid_status *status = &edid_info->status;
+    hdmi_edid_cache_entry *entry = HI_NULL;
+
+    /* block 0 lands in edid_raw, a full read on miss overwrites it */
+    hal_call_ret(ret, hal_hdmi_edid_fingerprint_read, hdmi_dev->hal, edid_info->edid_raw,
+        ext_sum, EDID_MAX_EXT_BLOCK_NUM);
+    if (ret < 0) {
+        return HI_FAILURE;
+    }
+    ext_num = (hi_u32)ret;
+    hash = edid_cache_hash(edid_info->edid_raw, ext_sum, ext_num);
+
+    for (i = 0; i < HDMI_EDID_CACHE_NUM; i++) {
+        entry = &hdmi_dev->edid_cache.entry[i];
+        if (!edid_cache_match(entry, hash, edid_info->edid_raw, ext_sum, ext_num)) {
+            continue;
+        }
+        err = memcpy_s(edid_info->edid_raw, sizeof(edid_info->edid_raw), entry->edid_raw, entry->raw_len);
+        hdmi_unequal_eok_return(err, HI_ERR_HDMI_INVALID_PARA);
+        err = memcpy_s(&edid_info->capability, sizeof(edid_info->capability),
+            &entry->capability, sizeof(hdmi_sink_capability));
+        hdmi_unequal_eok_return(err, HI_ERR_HDMI_INVALID_PARA);
+        entry->use_time = ++hdmi_dev->edid_cache.use_clock;
+        status->raw_len = entry->raw_len;
+        status->raw_valid = HI_TRUE;
+        status->parse_warn = entry->parse_warn;
+        status->cap_valid = HI_TRUE;
+        status->cache_hit_cnt++;
+        edid_info("EDID cache hit, entry %u\n", i);
+        return HI_SUCCESS;
+    }
+    status->cache_miss_cnt++;
+
+    return HI_FAILURE;
+}
+
+static hi_void edid_cache_store(hdmi_device *hdmi_dev, const hdmi_edid_info *edid_info)
+{
+    errno_t err;
+    hi_u32 i, hash, ext_num;
+    hi_u8 ext_sum[EDID_MAX_EXT_BLOCK_NUM] = {0};
+    const hdmi_edid_status *status = &edid_info->status;
+    hdmi_edid_cache *cache = &hdmi_dev->edid_cache;
+    hdmi_edid_cache_entry *entry = &cache->entry[0];
+
+    /* only a complete read can be recognised again from its fingerprint */
+    ext_num = edid_info->edid_raw[EDID_EXTENSION_BLK_ADDR];
+    ext_num = (ext_num < EDID_MAX_EXT_BLOCK_NUM) ? ext_num : EDID_MAX_EXT_BLOCK_NUM;
+    if (status->raw_len != (ext_num + 1) * HDMI_EDID_BLOCK_SIZE) {
+        return;
+    }
+    for (i = 0; i < ext_num; i++) {
+        ext_sum[i] = edid_info->edid_raw[(i + 2) * HDMI_EDID_BLOCK_SIZE - 1];
+    }
+    hash = edid_cache_hash(edid_info->edid_raw, ext_sum, ext_num);
+
+    /* same sink, else a free entry, else the least recently used one */
+    for (i = 0; i < HDMI_EDID_CACHE_NUM; i++) {
+        if (edid_cache_match(&cache->entry[i], hash, edid_info->edid_raw, ext_sum, ext_num) ||
+            !cache->entry[i].valid) {
+            entry = &cache->entry[i];
+            break;
+        }
+        if (cache->entry[i].use_time < entry->use_time) {
+            entry = &cache->entry[i];
+        }
+    }
+
+    entry->valid = HI_FALSE;
+    err = memcpy_s(entry->edid_raw, sizeof(entry->edid_raw), edid_info->edid_raw, status->raw_len);
+    hdmi_unequal_eok_return_void(err);
+    err = memcpy_s(&entry->capability, sizeof(entry->capability),
+        &edid_info->capability, sizeof(hdmi_sink_capability));
+    hdmi_unequal_eok_return_void(err);
+    entry->hash = hash;
+    entry->raw_len = status->raw_len;
+    entry->parse_warn = status->parse_warn;
+    entry->use_time = ++cache->use_clock;
+    entry->valid = HI_TRUE;
+
+    return;
+}
+
 hi_s32 drv_hdmi_edid_reset(hdmi_edid_info *edid_info)
 {
     hi_u8                *data   = HI_NULL;
@@ -1717,8 +1880,11 @@ hi_s32 drv_hdmi_edid_update(hdmi_edid_info *edid_info, hdmi_edid_updata_mode mod
         hdmi_dev = osal_container_of(edid_info, __typeof__(*hdmi_dev), edid_info);
         hal_call_void(hal_hdmi_hot_plug_status_get, hdmi_dev->hal, &hotplug);
         if (hotplug) {
-            hal_call_ret(ret, hal_hdmi_edid_raw_data_read, hdmi_dev->hal, HDMI_EDID_TOTAL_SIZE, data);
             status->cap_sink = HI_TRUE;
+            if (edid_cache_load(hdmi_dev, edid_info) == HI_SUCCESS) {
+                return HI_SUCCESS;
+            }
+            hal_call_ret(ret, hal_hdmi_edid_raw_data_read, hdmi_dev->hal, HDMI_EDID_TOTAL_SIZE, data);
         } else {
             status->cap_sink = HI_FALSE;
             edid_warn("sink do not connect, forbid to read edid\n");
@@ -1741,6 +1907,9 @@ hi_s32 drv_hdmi_edid_update(hdmi_edid_info *edid_info, hdmi_edid_updata_mode mod
         return HI_ERR_HDMI_READ_EDID_FAILED;
     }
     status->cap_valid = HI_TRUE;
+    if (hdmi_dev != HI_NULL) {
+        edid_cache_store(hdmi_dev, edid_info);
+    }
 
     return HI_SUCCESS;
 }
@@ -39,6 +39,7 @@
 #define HDMI_EDID_MAX_REAL_VIC            255U
 #define HDMI_VIC_VIRTUAL_BASE             (HDMI_EDID_MAX_REAL_VIC)
 #define DOLBY_IEEE_OUI                    0x00D046
+#define HDMI_EDID_CACHE_NUM               4
 
 typedef enum {
     HDMI_EDID_ESTABTIMG_VESA_800X600_60,
@@ -292,6 +293,8 @@ typedef struct {
     hi_u32 raw_get_err_cnt;        /* error from raw data getting count */
     hi_u32 cap_get_err_cnt;        /* error from capability getting count */
     hi_u32 raw_update_err_cnt;     /* error from raw data updating count */
+    hi_u32 cache_hit_cnt;          /* sink update served from the capability cache */
+    hi_u32 cache_miss_cnt;         /* sink update that needed a full read and parse */
 } hdmi_edid_status;
 
 typedef struct {
@@ -490,6 +493,22 @@ typedef struct {
     hdmi_sink_capability capability;
 } hdmi_edid_info;
 
+typedef struct {
+    hi_bool              valid;
+    hi_u32               hash;     /* of block 0 and the extension checksums */
+    hi_u32               use_time; /* LRU stamp */
+    hi_u32               raw_len;
+    hi_u32               parse_warn;
+    hi_u8                edid_raw[HDMI_EDID_TOTAL_SIZE];
+    hdmi_sink_capability capability;
+} hdmi_edid_cache_entry;
+
+/* parsed capability of recently seen sinks, kept across device open/close */
+typedef struct {
+    hi_u32                use_clock;
+    hdmi_edid_cache_entry entry[HDMI_EDID_CACHE_NUM];
+} hdmi_edid_cache;
+
 hdmi_edid_data drv_hdmi_edid_capability_get(hdmi_edid_info *edid_info, hdmi_sink_capability **capability);
 
 hi_s32 drv_hdmi_edid_raw_get(hdmi_edid_info *edid_info, hi_u8 *raw_data, hi_u32 len);
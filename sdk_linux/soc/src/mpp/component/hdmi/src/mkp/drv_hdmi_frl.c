@@ -621,6 +621,10 @@ hi_void drv_hdmi_frl_mach_init(hdmi_device_id hdmi_id)
         curr_frl_info->mode = HDMI_FRL_MODE_TMDS;
         (hi_void)memset_s(curr_frl_info->aen_cur_tx_ffe, sizeof(curr_frl_info->aen_cur_tx_ffe),
             FRL_TXFFE_MODE_0, sizeof(curr_frl_info->aen_cur_tx_ffe));
+        /* the timer thread may be idle, training needs it polling again */
+        if (hdmi_dev->hal != HI_NULL && hdmi_dev->hal->hal_hdmi_sequencer_wakeup != HI_NULL) {
+            hdmi_dev->hal->hal_hdmi_sequencer_wakeup(hdmi_dev->hal, HI_FALSE);
+        }
     }
 
     return;
@@ -58,6 +58,7 @@ hi_s32 g_hdmi_irq_timer = -1;
 #define DEV_HPD_ASSERT_WAIT_TIME     50
 #define HDMI_THREAD_STATE_WAIT_TIME  90
 #define HDMI_THREAD_DELAY            10
+#define HDMI_THREAD_IDLE_WAIT_TIME   1000
 #define HDMI_DEV_FMT_DELAY           500
 #define HDMI_DEV_MUTE_DELAY          120
 #define HDMI_VIDEO_ATTR_CLK_FS       74250
@@ -1069,6 +1070,86 @@ static hi_s32 hdmi_event_callback(hi_void *data, hdmi_event event)
     return ret;
 }
 
+static hi_void hdmi_kthread_wait(const hdmi_device *hdmi_dev)
+{
+    hi_u32 max_ms = HDMI_THREAD_IDLE_WAIT_TIME;
+
+#ifdef HDMI_FRL_SUPPORT
+    /* FRL training is still a polled machine */
+    if (hdmi_dev->frl_info.state_mach_info.start_mach) {
+        max_ms = HDMI_THREAD_DELAY;
+    }
+#endif
+    if (hdmi_dev->hal != HI_NULL && hdmi_dev->hal->hal_hdmi_sequencer_wait != HI_NULL) {
+        /* sleeps until a sequencer element is due or an HPD/RSEN interrupt arrives */
+        hdmi_dev->hal->hal_hdmi_sequencer_wait(hdmi_dev->hal, max_ms);
+    } else {
+        osal_msleep(HDMI_THREAD_DELAY);
+    }
+
+    return;
+}
+
+static hi_void hdmi_kthread_wakeup(const hdmi_device *hdmi_dev, hi_bool stop)
+{
+    if (hdmi_dev->hal != HI_NULL && hdmi_dev->hal->hal_hdmi_sequencer_wakeup != HI_NULL) {
+        hdmi_dev->hal->hal_hdmi_sequencer_wakeup(hdmi_dev->hal, stop);
+    }
+    return;
+}
+
+static hi_s32 hdmi_hpd_irq_handler(hi_s32 irq, hi_void *dev_id)
+{
+    hdmi_device *hdmi_dev = (hdmi_device *)dev_id;
+
+    hi_unused(irq);
+    if (hdmi_dev == HI_NULL || hdmi_dev->hal == HI_NULL || hdmi_dev->hal->hal_hdmi_hpd_irq_handler == HI_NULL) {
+        return OSAL_IRQ_NONE;
+    }
+
+    return hdmi_dev->hal->hal_hdmi_hpd_irq_handler(hdmi_dev->hal) ? OSAL_IRQ_HANDLED : OSAL_IRQ_NONE;
+}
+
+static hi_void hdmi_hpd_irq_request(hdmi_device *hdmi_dev)
+{
+    hi_s32 ret;
+
+    hdmi_dev->thread_info.irq_requested = HI_FALSE;
+    if (g_hdmi_irq_timer < 0) {
+        hdmi_info("no HDMI irq, poll HPD\n");
+        return;
+    }
+    ret = osal_request_irq((hi_u32)g_hdmi_irq_timer, hdmi_hpd_irq_handler, HI_NULL, "hi_hdmi", hdmi_dev);
+    if (ret != 0) {
+        hdmi_warn("request HDMI irq %d fail, poll HPD\n", g_hdmi_irq_timer);
+        return;
+    }
+    hdmi_dev->thread_info.irq_requested = HI_TRUE;
+    hal_call_ret(ret, hal_hdmi_hpd_irq_mode_set, hdmi_dev->hal, HI_TRUE);
+    if (ret != HI_SUCCESS) {
+        hdmi_warn("HPD interrupt mode set fail, poll HPD\n");
+    }
+
+    return;
+}
+
+static hi_void hdmi_hpd_irq_free(hdmi_device *hdmi_dev)
+{
+    hi_s32 ret;
+
+    if (hdmi_dev->thread_info.irq_requested != HI_TRUE) {
+        return;
+    }
+    hal_call_ret(ret, hal_hdmi_hpd_irq_mode_set, hdmi_dev->hal, HI_FALSE);
+    if (ret != HI_SUCCESS) {
+        hdmi_warn("HPD polling mode set fail\n");
+    }
+    osal_free_irq((hi_u32)g_hdmi_irq_timer, hdmi_dev);
+    hdmi_dev->thread_info.irq_requested = HI_FALSE;
+
+    return;
+}
+
 static hi_s32 hdmi_kthread_timer(void *data)
 {
     hdmi_device *hdmi_dev = (hdmi_device *)data;
@@ -1114,7 +1195,7 @@ static hi_s32 hdmi_kthread_timer(void *data)
         }
 
 #if defined(HDMI_SUPPORT_LOGIC_HISIV100)
-        osal_msleep(HDMI_THREAD_DELAY);
+        hdmi_kthread_wait(hdmi_dev);
 #endif
     }
 
@@ -1335,6 +1416,7 @@ static hi_s32 create_task(hdmi_device *hdmi_dev, hdmi_hal_init *hal_cfg)
             hdmi_err("create HDMI timer thread fail\n");
             return HI_FAILURE;
         }
+        hdmi_hpd_irq_request(hdmi_dev);
 
         hdmi_device_init(hdmi_dev);
     }
@@ -1488,6 +1570,9 @@ static hi_s32 hdmi_release(hdmi_device *hdmi_dev)
         if (hdmi_dev->kernel_cnt == 0) {
             if (hdmi_dev->thread_info.thread_timer) {
                 hdmi_info("stop hdmi kernel thread timer\n");
+                hdmi_hpd_irq_free(hdmi_dev);
+                /* the thread may sleep up to HDMI_THREAD_IDLE_WAIT_TIME, keep it awake until it stops */
+                hdmi_kthread_wakeup(hdmi_dev, HI_TRUE);
 #ifdef HDMI_LITEOS_SUPPORT
                 hdmi_dev->thread_info.thread_run = HI_FALSE;
                 osal_wait_event_uninterruptible(&hdmi_dev->thread_info.wait_destroy,
@@ -1918,6 +2003,7 @@ hi_s32 get_hdmi_thread_state_set(hdmi_device *hdmi_dev, hdmi_thread_state state)
 
     hdmi_info("state: %u\n", state);
     hdmi_dev->thread_info.thread_timer_sate = state;
+    hdmi_kthread_wakeup(hdmi_dev, HI_FALSE);
     hdmi_info("<<< out...\n");
 
     return HI_SUCCESS;
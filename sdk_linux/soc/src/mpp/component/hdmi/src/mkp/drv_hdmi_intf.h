@@ -34,6 +34,7 @@ typedef struct {
     hi_bool           thread_run;
     hi_bool           thread_exit;
     osal_wait_t       wait_destroy;
+    hi_bool           irq_requested;
 } hdmi_thread_info;
 
 typedef struct {
@@ -56,6 +57,7 @@ typedef struct {
     hdmi_callback          k_callback;
     hdmi_thread_info       thread_info;
     hdmi_edid_info         edid_info;
+    hdmi_edid_cache        edid_cache;
     hdmi_infoframe_type    info_frame;
     hdmi_attr              attr;
     hdmi_delay             delay;
@@ -1322,6 +1322,9 @@ static hi_void proc_edid_status(hdmi_proc_entry *file, hdmi_device_id hdmi_id)
     /* line 4 */
     osal_seq_printf(file, "%-20s: %-20d ", "RawGetErrCnt", status.raw_get_err_cnt);
     osal_seq_printf(file, "%-20s: %-20d \n", "RawLength", status.raw_len);
+    /* line 5 */
+    osal_seq_printf(file, "%-20s: %-20d ", "CacheHitCnt", status.cache_hit_cnt);
+    osal_seq_printf(file, "%-20s: %-20d \n", "CacheMissCnt", status.cache_miss_cnt);
 
     return;
 }
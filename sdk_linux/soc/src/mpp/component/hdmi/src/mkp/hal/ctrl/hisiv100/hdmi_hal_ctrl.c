@@ -57,6 +57,7 @@
 #define CTRL_AUDIO_INVALID_CFG   0xff
 #define CTRL_AUDIO_INVALID_RATE  0xffffffff
 #define CTRL_REAET_WAIT_TIME     5
+#define CTRL_HPD_DEBOUNCE_TIME   50  /* ms the HPD/RSEN lines must be quiet before they are read */
 #define HDMI_INFOFRAME_DATA_SIZE 31
 
 typedef struct {
@@ -1387,11 +1388,14 @@ static hi_void ctrl_hpd_intr_enable(hi_bool enable)
 {
     hdmi_reg_aon_intr_stat0_set(HI_TRUE);
     hdmi_reg_aon_intr_mask0_set(enable);
+    if (!enable) {
+        hdmi_reg_aon_intr_mask1_set(HI_FALSE);
+    }
     return;
 }
 
 #ifdef HDMI_HDR_SUPPORT
-static hi_void ctrl_hpd_timer_invoke(const hdmi_ctrl_info *ctrl_info)
+static hi_void ctrl_hpd_timer_invoke(hdmi_ctrl_info *ctrl_info)
 {
     hi_u32 i;
     hi_u64 timeout;
@@ -1403,7 +1407,10 @@ static hi_void ctrl_hpd_timer_invoke(const hdmi_ctrl_info *ctrl_info)
             continue;
         }
         timeout = hal_hdmi_mach_ms_get() - hdr_timer->start_time;
-        if (timeout >= hdr_timer->time_length) {
+        if (timeout < hdr_timer->time_length) {
+            /* HPD machine may run without a period, ask to be called at the deadline */
+            (hi_void)hal_hdmi_mach_trigger(ctrl_info->mach_id, (hi_u32)(hdr_timer->time_length - timeout));
+        } else {
             hdr_timer->enable = HI_FALSE;
             hdmi_info("ctrl timer %u disable!\n", hdr_timer->timer_type);
             switch (hdr_timer->timer_type) {
@@ -1423,40 +1430,74 @@ static hi_void ctrl_hpd_timer_invoke(const hdmi_ctrl_info *ctrl_info)
 }
 #endif
 
+/*
+ * Test and clear the edges latched by the interrupt handler, unless the lines
+ * are still bouncing. Return the end of the debounce window.
+ */
+static hi_u64 ctrl_intr_latch_take(hdmi_ctrl_info *ctrl_info, hi_u64 cur_time, hi_bool *hpd_intr, hi_bool *rsen_intr)
+{
+    unsigned long flags = 0;
+    hi_u64 debounce_time;
+
+    osal_spin_lock_irqsave(&ctrl_info->intr_lock, &flags);
+    debounce_time = ctrl_info->debounce_time;
+    if (cur_time >= debounce_time) {
+        *hpd_intr = ctrl_info->hpd_intr;
+        *rsen_intr = ctrl_info->rsen_intr;
+        ctrl_info->hpd_intr = HI_FALSE;
+        ctrl_info->rsen_intr = HI_FALSE;
+    }
+    osal_spin_unlock_irqrestore(&ctrl_info->intr_lock, &flags);
+
+    return debounce_time;
+}
+
 hi_void ctrl_mach_ppd_callback(hi_void *data)
 {
     hi_bool event = HI_FALSE;
+    hi_bool hpd_intr = HI_FALSE;
+    hi_bool rsen_intr = HI_FALSE;
+    hi_u64 cur_time;
+    hi_u64 debounce_time;
     hdmi_ctrl_info *ctrl_info = (hdmi_ctrl_info *)data;
 
     hdmi_if_null_return_void(data);
     hdmi_if_null_return_void(ctrl_info->event_data);
     hdmi_if_null_return_void(ctrl_info->event_callback);
 
-    if (hdmi_reg_aon_intr_stat0_get()) {
-        /* clr intr */
-        hdmi_reg_aon_intr_stat0_set(HI_TRUE);
-        /* event */
-        event = ctrl_hpd_get();
-        if (event != ctrl_info->hpd) {
-            ctrl_info->event_callback(ctrl_info->event_data,
-                (event == HI_TRUE) ? HDMI_EVENT_HOTPLUG : HDMI_EVENT_HOTUNPLUG);
-            ctrl_info->hpd = event;
-        } else {
-            hdmi_warn("HPD event not change: %u!\n", event);
+    /* the lines are read after the latch is cleared, so a later edge latches again and is seen next run */
+    cur_time = hal_hdmi_mach_ms_get();
+    debounce_time = ctrl_intr_latch_take(ctrl_info, cur_time, &hpd_intr, &rsen_intr);
+    if (cur_time < debounce_time) {
+        /* the lines are still bouncing, look again once they settled */
+        (hi_void)hal_hdmi_mach_trigger(ctrl_info->mach_id, (hi_u32)(debounce_time - cur_time));
+    } else {
+        if (hdmi_reg_aon_intr_stat0_get() || hpd_intr) {
+            /* clr intr */
+            hdmi_reg_aon_intr_stat0_set(HI_TRUE);
+            /* event */
+            event = ctrl_hpd_get();
+            if (event != ctrl_info->hpd) {
+                ctrl_info->event_callback(ctrl_info->event_data,
+                    (event == HI_TRUE) ? HDMI_EVENT_HOTPLUG : HDMI_EVENT_HOTUNPLUG);
+                ctrl_info->hpd = event;
+            } else {
+                hdmi_warn("HPD event not change: %u!\n", event);
+            }
         }
-    }
 
-    if (hdmi_reg_aon_intr_stat1_get()) {
-        /* clr intr */
-        hdmi_reg_aon_intr_stat1_set(HI_TRUE);
-        /* event */
-        event = ctrl_rsen_get();
-        if (event != ctrl_info->rsen) {
-            ctrl_info->event_callback(ctrl_info->event_data,
-                (event == HI_TRUE) ? HDMI_EVENT_RSEN_CONNECT : HDMI_EVENT_RSEN_DISCONNECT);
-            ctrl_info->rsen = event;
-        } else {
-            hdmi_warn("RSEN event not change: %u!\n", event);
+        if (hdmi_reg_aon_intr_stat1_get() || rsen_intr) {
+            /* clr intr */
+            hdmi_reg_aon_intr_stat1_set(HI_TRUE);
+            /* event */
+            event = ctrl_rsen_get();
+            if (event != ctrl_info->rsen) {
+                ctrl_info->event_callback(ctrl_info->event_data,
+                    (event == HI_TRUE) ? HDMI_EVENT_RSEN_CONNECT : HDMI_EVENT_RSEN_DISCONNECT);
+                ctrl_info->rsen = event;
+            } else {
+                hdmi_warn("RSEN event not change: %u!\n", event);
+            }
         }
     }
 
@@ -1467,6 +1508,59 @@ hi_void ctrl_mach_ppd_callback(hi_void *data)
     return;
 }
 
+hi_bool hal_hdmi_ctrl_hpd_irq_handle(hdmi_device_id hdmi)
+{
+    unsigned long flags = 0;
+    hi_bool handled = HI_FALSE;
+    hdmi_ctrl_info *ctrl_info = ctrl_info_ptr_get(hdmi);
+
+    /* interrupt context: no trace, no sleeping calls */
+    if (ctrl_info == HI_NULL || !ctrl_info->init) {
+        return HI_FALSE;
+    }
+    osal_spin_lock_irqsave(&ctrl_info->intr_lock, &flags);
+    if (hdmi_reg_aon_intr_stat0_get()) {
+        hdmi_reg_aon_intr_stat0_set(HI_TRUE);
+        ctrl_info->hpd_intr = HI_TRUE;
+        handled = HI_TRUE;
+    }
+    if (hdmi_reg_aon_intr_stat1_get()) {
+        hdmi_reg_aon_intr_stat1_set(HI_TRUE);
+        ctrl_info->rsen_intr = HI_TRUE;
+        handled = HI_TRUE;
+    }
+    if (handled) {
+        /* every edge restarts the debounce window */
+        ctrl_info->debounce_time = hal_hdmi_mach_ms_get() + CTRL_HPD_DEBOUNCE_TIME;
+    }
+    osal_spin_unlock_irqrestore(&ctrl_info->intr_lock, &flags);
+
+    if (handled) {
+        (hi_void)hal_hdmi_mach_trigger(ctrl_info->mach_id, CTRL_HPD_DEBOUNCE_TIME);
+    }
+
+    return handled;
+}
+
+hi_s32 hal_hdmi_ctrl_hpd_irq_mode_set(hdmi_device_id hdmi, hi_bool enable)
+{
+    hi_s32 ret;
+    hdmi_mach_ctrl mach_ctrl = {0};
+    hdmi_ctrl_info *ctrl_info = ctrl_info_ptr_get(hdmi);
+
+    hdmi_if_null_return(ctrl_info, HI_FAILURE);
+    hdmi_if_false_return(ctrl_info->init, HI_FAILURE);
+
+    /* with the interrupt the HPD machine only runs on edges and timer deadlines */
+    ret = hal_hdmi_mach_cfg_get(ctrl_info->mach_id, &mach_ctrl);
+    mach_ctrl.interval = enable ? HDMI_MACH_EVENT_INTERVAL : HDMI_MACH_DEFUALT_INTERVAL;
+    ret += hal_hdmi_mach_cfg_set(ctrl_info->mach_id, &mach_ctrl);
+    hdmi_reg_aon_intr_mask1_set(enable);
+    hdmi_info("HPD %s mode\n", enable ? "interrupt" : "polling");
+
+    return (ret != HI_SUCCESS) ? HI_FAILURE : HI_SUCCESS;
+}
+
 static hi_s32 ctrl_null_packet_set(hi_bool enable)
 {
     hdmi_reg_null_pkt_en_set(enable);
@@ -1546,6 +1640,7 @@ hi_s32 hal_hdmi_ctrl_init(hdmi_device_id hdmi, const hdmi_hal_init *hal_init)
         ret += hdmi_reg_video_path_regs_init(hal_init->base_addr);
 
         drv_hdmi_prod_crg_gate_set(HI_TRUE);
+        osal_spin_lock_init(&ctrl_info->intr_lock);
         ctrl_info->event_callback = hal_init->event_callback;
         ctrl_info->event_data = hal_init->event_data;
         ctrl_info->init       = HI_TRUE;
@@ -1578,6 +1673,7 @@ hi_s32 hal_hdmi_ctrl_deinit(hdmi_device_id hdmi)
     ret += hdmi_reg_tx_ctrl_regs_deinit();
     ret += hdmi_reg_tx_hdmi_regs_deinit();
     ret += hdmi_reg_video_path_regs_deinit();
+    osal_spin_lock_destroy(&ctrl_info->intr_lock);
 
     (hi_void)memset_s(ctrl_info, sizeof(hdmi_ctrl_info), 0, sizeof(hdmi_ctrl_info));
     ctrl_info->init = HI_FALSE;
@@ -2049,6 +2145,7 @@ hi_s32 hal_hdmi_ctrl_hdr_timer_set(hdmi_device_id hdmi, const hdmi_timer_config
             hdr_timer->timer_type  = hdr_timer_cfg->timer_type;
             hdr_timer->start_time  = hal_hdmi_mach_ms_get();
             hdr_timer->time_length = hdr_timer_cfg->time;
+            (hi_void)hal_hdmi_mach_trigger(ctrl_info->mach_id, (hi_u32)hdr_timer->time_length);
             break;
         } else if (hdr_timer_cfg->timer_type == hdr_timer->timer_type) {
             (hi_void)memset_s(hdr_timer, sizeof(ctrl_hdr_timer), 0, sizeof(ctrl_hdr_timer));
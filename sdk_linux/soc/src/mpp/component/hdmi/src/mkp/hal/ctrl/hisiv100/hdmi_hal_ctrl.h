@@ -137,6 +137,10 @@ typedef struct {
     mach_callback     *hpd_callback;
     hi_bool            hpd;
     hi_bool            rsen;
+    osal_spinlock_t    intr_lock;     /* protects hpd_intr, rsen_intr and debounce_time */
+    hi_bool            hpd_intr;      /* HPD edge latched by the interrupt handler */
+    hi_bool            rsen_intr;     /* RSEN edge latched by the interrupt handler */
+    hi_u64             debounce_time; /* in ms, the lines are read again after this time */
 } hdmi_ctrl_info;
 
 typedef struct {
@@ -193,6 +197,10 @@ hi_s32 hal_hdmi_ctrl_hpd_rsen_get(hdmi_device_id hdmi, hdmi_hpd_rsen *hpd_rsen);
 
 hi_s32 hal_hdmi_ctrl_hdr_timer_set(hdmi_device_id hdmi, const hdmi_timer_config *hdr_timer_cfg);
 
+hi_s32 hal_hdmi_ctrl_hpd_irq_mode_set(hdmi_device_id hdmi, hi_bool enable);
+
+hi_bool hal_hdmi_ctrl_hpd_irq_handle(hdmi_device_id hdmi);
+
 hi_void hal_hdmi_ctrl_dither_dbg_set(hdmi_device_id hdmi, hdmi_video_dither dither_mode);
 
 hi_s32 hal_hdmi_ctrl_csc_set(hdmi_device_id hdmi, const hdmi_video_config *video_cfg);
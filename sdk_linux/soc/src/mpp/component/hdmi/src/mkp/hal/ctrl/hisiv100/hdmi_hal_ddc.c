@@ -29,6 +29,7 @@
 #define DDC_MAX_FIFO_SIZE    16
 #define DDC_EXT_BLOCK_OFFSET 0x7e
 #define DDC_MAX_EDID_EXT_NUM 3    /* 3: 4(max block num) - 1(base block) */
+#define DDC_EDID_SEGMENT_BLKS 2   /* 2: a DDC segment holds two EDID blocks */
 #define DDC_DEFAULT_DELAY    8    /* 8us */
 
 static ddc_info g_ddc_info[HDMI_DEVICE_ID_BUTT];
@@ -624,3 +625,44 @@ hi_s32 hal_hdmi_ddc_edid_raw_get(hdmi_device_id hdmi, hi_s32 size, hi_u8 *data)
     return ret;
 }
 
+hi_s32 hal_hdmi_ddc_edid_fingerprint_get(hdmi_device_id hdmi, hi_u8 *block0, hi_u8 *ext_sum, hi_u32 sum_num)
+{
+    hi_u32 i, ext_block_num;
+    hi_s32 ret;
+    ddc_cfg cfg = {0};
+
+    hdmi_if_null_warn_return(block0, HI_FAILURE);
+    hdmi_if_null_warn_return(ext_sum, HI_FAILURE);
+
+    hal_hdmi_ddc_default_cfg_get(hdmi, &cfg);
+    cfg.segment    = 0;
+    cfg.func_type  = DDC_FUNC_TYPE_EDID;
+    cfg.issue_mode = DDC_MODE_READ_MUTIL_NO_ACK;
+    cfg.data_size  = HDMI_EDID_BLOCK_SIZE;
+    cfg.data       = block0;
+    ret = hal_hdmi_ddc_issue(hdmi, &cfg);
+    if (ret != HDMI_EDID_BLOCK_SIZE) {
+        hdmi_warn("edid block 0 read fail!\n");
+        return HI_FAILURE;
+    }
+
+    ext_block_num = block0[DDC_EXT_BLOCK_OFFSET];
+    ext_block_num = (ext_block_num < DDC_MAX_EDID_EXT_NUM) ? ext_block_num : DDC_MAX_EDID_EXT_NUM;
+    ext_block_num = (ext_block_num < sum_num) ? ext_block_num : sum_num;
+
+    /* only the checksum byte, the last one of each extension block */
+    cfg.data_size = 1;
+    for (i = 0; i < ext_block_num; i++) {
+        cfg.segment    = (hi_u8)((i + 1) / DDC_EDID_SEGMENT_BLKS);
+        cfg.offset     = (hi_u8)(((i + 1) % DDC_EDID_SEGMENT_BLKS) * HDMI_EDID_BLOCK_SIZE + HDMI_EDID_BLOCK_SIZE - 1);
+        cfg.issue_mode = (cfg.segment == 0) ? DDC_MODE_READ_MUTIL_NO_ACK : DDC_MODE_READ_SEGMENT_NO_ACK;
+        cfg.data       = &ext_sum[i];
+        if (hal_hdmi_ddc_issue(hdmi, &cfg) != 1) {
+            hdmi_warn("EDID EXT-block %u checksum read fail!\n", i + 1);
+            return HI_FAILURE;
+        }
+    }
+
+    return (hi_s32)ext_block_num;
+}
+
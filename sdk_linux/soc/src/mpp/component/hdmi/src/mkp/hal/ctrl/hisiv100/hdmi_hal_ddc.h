@@ -134,5 +134,8 @@ hi_void hal_hdmi_ddc_default_cfg_get(hdmi_device_id hdmi, ddc_cfg *cfg);
 
 hi_s32 hal_hdmi_ddc_edid_raw_get(hdmi_device_id hdmi, hi_s32 size, hi_u8 *data);
 
+/* read block 0 and the checksum of up to sum_num extension blocks, returns the extension count */
+hi_s32 hal_hdmi_ddc_edid_fingerprint_get(hdmi_device_id hdmi, hi_u8 *block0, hi_u8 *ext_sum, hi_u32 sum_num);
+
 #endif /* __HDMI_HAL_DDC_H__ */
 
@@ -381,6 +381,34 @@ static hi_void hal_hdmi_sequencer_handler_process(const struct hdmi_hal_ *hal)
     return;
 }
 
+static hi_void hal_hdmi_sequencer_wait(const struct hdmi_hal_ *hal, hi_u32 max_ms)
+{
+    hi_unused(hal);
+    hal_hdmi_mach_wait(max_ms);
+    return;
+}
+
+static hi_void hal_hdmi_sequencer_wakeup(const struct hdmi_hal_ *hal, hi_bool stop)
+{
+    hi_unused(hal);
+    hal_hdmi_mach_wakeup(stop);
+    return;
+}
+
+static hi_s32 hal_hdmi_hpd_irq_mode_set(const struct hdmi_hal_ *hal, hi_bool enable)
+{
+    hdmi_if_null_return(hal, HI_FAILURE);
+    return hal_hdmi_ctrl_hpd_irq_mode_set(hal->hal_ctx.hdmi_id, enable);
+}
+
+static hi_bool hal_hdmi_hpd_irq_handler(const struct hdmi_hal_ *hal)
+{
+    if (hal == HI_NULL) {
+        return HI_FALSE;
+    }
+    return hal_hdmi_ctrl_hpd_irq_handle(hal->hal_ctx.hdmi_id);
+}
+
 static hi_void hal_hdmi_hw_audio_status_get(hi_u32 hdmi_id, hdmi_hardware_status *hw_status)
 {
     ctrl_audio_status audio_stat = {0};
@@ -570,6 +598,13 @@ static hi_s32 hal_hdmi_edid_raw_data_read(const struct hdmi_hal_ *hal, hi_u32 si
     return ret;
 }
 
+static hi_s32 hal_hdmi_edid_fingerprint_read(const struct hdmi_hal_ *hal, hi_u8 block0[], hi_u8 ext_sum[],
+                                             hi_u32 sum_num)
+{
+    hdmi_if_null_return(hal, HI_FAILURE);
+    return hal_hdmi_ddc_edid_fingerprint_get(hal->hal_ctx.hdmi_id, block0, ext_sum, sum_num);
+}
+
 static hi_void hal_hdmi_phy_output_enable_get(const struct hdmi_hal_ *hal, hi_bool *enable)
 {
 #ifndef HDMI_FPGA_SUPPORT
@@ -695,10 +730,15 @@ static hi_void hal_pfn_init(hdmi_hal *hal)
     hal->hal_hdmi_phy_hw_spec_get           = hal_hdmi_phy_hw_spec_get;
     hal->hal_hdmi_hardware_status_get       = hal_hdmi_hardware_status_get;
     hal->hal_hdmi_sequencer_handler_process = hal_hdmi_sequencer_handler_process;
+    hal->hal_hdmi_sequencer_wait            = hal_hdmi_sequencer_wait;
+    hal->hal_hdmi_sequencer_wakeup          = hal_hdmi_sequencer_wakeup;
+    hal->hal_hdmi_hpd_irq_mode_set          = hal_hdmi_hpd_irq_mode_set;
+    hal->hal_hdmi_hpd_irq_handler           = hal_hdmi_hpd_irq_handler;
     hal->hal_hdmi_audio_mute_set            = hal_hdmi_audio_mute_set;
     hal->hal_hdmi_audio_path_set            = hal_hdmi_audio_path_set;
     hal->hal_hdmi_audio_path_enable_set     = hal_hdmi_audio_path_enable_set;
     hal->hal_hdmi_edid_raw_data_read        = hal_hdmi_edid_raw_data_read;
+    hal->hal_hdmi_edid_fingerprint_read     = hal_hdmi_edid_fingerprint_read;
     hal->hal_hdmi_phy_output_enable_get     = hal_hdmi_phy_output_enable_get;
     hal->hal_hdmi_hot_plug_status_get       = hal_hdmi_hot_plug_status_get;
     hal->hal_hdmi_video_mute_set            = hal_hdmi_video_mute_set;
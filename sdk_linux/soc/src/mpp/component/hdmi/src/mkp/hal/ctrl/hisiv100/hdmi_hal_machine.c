@@ -25,6 +25,10 @@
 
 typedef struct {
     osal_semaphore_t mach_mutex;
+    osal_spinlock_t  event_lock; /* protects triggered/trigger_time, wakeup and stop */
+    osal_wait_t      event_wait;
+    hi_bool wakeup;
+    hi_bool stop;
     hi_bool init;
     hi_u32 total;
     hdmi_mach_elem mach_elem[MACHINE_MAX_ID_NUM];
@@ -32,12 +36,76 @@ typedef struct {
 
 static hdmi_mach_info g_machine_info;
 
+static hi_bool mach_elem_due(hdmi_mach_info *mach_info, hdmi_mach_elem *tmp_elem, hi_u64 cur_time)
+{
+    unsigned long flags = 0;
+    hi_bool due = HI_FALSE;
+
+    if (!(tmp_elem->mach_run.valid_id) || !(tmp_elem->mach_run.enable)) {
+        return HI_FALSE;
+    }
+    if (tmp_elem->mach_ctrl.interval != HDMI_MACH_EVENT_INTERVAL &&
+        (cur_time - tmp_elem->mach_run.last_time) > tmp_elem->mach_ctrl.interval) {
+        due = HI_TRUE;
+    }
+    osal_spin_lock_irqsave(&mach_info->event_lock, &flags);
+    if (tmp_elem->mach_run.triggered && cur_time >= tmp_elem->mach_run.trigger_time) {
+        tmp_elem->mach_run.triggered = HI_FALSE;
+        due = HI_TRUE;
+    } else if (due) {
+        /* a periodic run also serves a pending trigger */
+        tmp_elem->mach_run.triggered = HI_FALSE;
+    }
+    osal_spin_unlock_irqrestore(&mach_info->event_lock, &flags);
+
+    return due;
+}
+
+static hi_u32 mach_next_timeout_get(hdmi_mach_info *mach_info, hi_u32 max_ms)
+{
+    hi_u32 i;
+    unsigned long flags = 0;
+    hi_u64 due_time;
+    hi_u64 cur_time = hal_hdmi_mach_ms_get();
+    hi_u64 next_time = cur_time + max_ms;
+    hdmi_mach_elem *tmp_elem = HI_NULL;
+
+    for (i = 0; i < MACHINE_MAX_ID_NUM; ++i) {
+        tmp_elem = &mach_info->mach_elem[i];
+        if (!(tmp_elem->mach_run.valid_id) || !(tmp_elem->mach_run.enable)) {
+            continue;
+        }
+        if (tmp_elem->mach_ctrl.interval != HDMI_MACH_EVENT_INTERVAL) {
+            due_time = tmp_elem->mach_run.last_time + tmp_elem->mach_ctrl.interval + 1;
+            next_time = (due_time < next_time) ? due_time : next_time;
+        }
+        osal_spin_lock_irqsave(&mach_info->event_lock, &flags);
+        if (tmp_elem->mach_run.triggered && tmp_elem->mach_run.trigger_time < next_time) {
+            next_time = tmp_elem->mach_run.trigger_time;
+        }
+        osal_spin_unlock_irqrestore(&mach_info->event_lock, &flags);
+    }
+
+    return (next_time > cur_time) ? (hi_u32)(next_time - cur_time) : 0;
+}
+
+static hi_s32 mach_wait_cond(const hi_void *param)
+{
+    const hdmi_mach_info *mach_info = (const hdmi_mach_info *)param;
+
+    return (mach_info->wakeup || mach_info->stop) ? 1 : 0;
+}
+
 hi_s32 hal_hdmi_mach_init(hi_void)
 {
     hdmi_mach_info *mach_info = &g_machine_info;
 
     if (!mach_info->init) {
         osal_sema_init(&mach_info->mach_mutex, 1);
+        osal_spin_lock_init(&mach_info->event_lock);
+        osal_wait_init(&mach_info->event_wait);
+        mach_info->wakeup = HI_FALSE;
+        mach_info->stop = HI_FALSE;
         (hi_void)memset_s(mach_info->mach_elem, MACHINE_MAX_ID_NUM * sizeof(hdmi_mach_elem), 0,
             MACHINE_MAX_ID_NUM * sizeof(hdmi_mach_elem));
         mach_info->total = 0;
@@ -58,6 +126,8 @@ hi_s32 hal_hdmi_mach_deinit(hi_void)
     mach_info->total = 0;
     mach_info->init = HI_FALSE;
     hdmi_mutex_unlock(mach_info->mach_mutex);
+    osal_wait_destroy(&mach_info->event_wait);
+    osal_spin_lock_destroy(&mach_info->event_lock);
     osal_sema_destroy(&mach_info->mach_mutex);
 
     return HI_SUCCESS;
@@ -76,8 +146,7 @@ hi_s32 hal_hdmi_mach_invoke(hi_void)
     } else {
         for (i = 0; i < MACHINE_MAX_ID_NUM; ++i) {
             tmp_elem = &mach_info->mach_elem[i];
-            if (!(tmp_elem->mach_run.valid_id) || !(tmp_elem->mach_run.enable) ||
-                ((hdmi_osal_get_time_in_ms() - tmp_elem->mach_run.last_time) <= tmp_elem->mach_ctrl.interval)) {
+            if (!mach_elem_due(mach_info, tmp_elem, hal_hdmi_mach_ms_get())) {
                 continue;
             }
             if (tmp_elem->mach_ctrl.callback != HI_NULL) {
@@ -198,6 +267,7 @@ hi_s32 hal_hdmi_mach_cfg_set(hi_u32 mach_id, const hdmi_mach_ctrl *mach_ctrl)
     errnumber = memcpy_s(&tmp_elem->mach_ctrl, sizeof(hdmi_mach_ctrl), mach_ctrl, sizeof(hdmi_mach_ctrl));
     hdmi_unlock_unequal_eok_return(errnumber, mach_info->mach_mutex, HI_ERR_HDMI_INVALID_PARA);
     hdmi_mutex_unlock(mach_info->mach_mutex);
+    hal_hdmi_mach_wakeup(HI_FALSE);
 
     return HI_SUCCESS;
 }
@@ -215,6 +285,7 @@ hi_s32 hal_hdmi_mach_start(hi_u32 mach_id)
     tmp_elem->mach_run.enable = HI_TRUE;
     tmp_elem->mach_run.enable_time = hdmi_osal_get_time_in_ms();
     hdmi_mutex_unlock(mach_info->mach_mutex);
+    hal_hdmi_mach_wakeup(HI_FALSE);
 
     return HI_SUCCESS;
 }
@@ -277,3 +348,69 @@ hi_u64 hal_hdmi_mach_ms_get(hi_void)
     return (hi_u64)hdmi_osal_get_time_in_ms();
 }
 
+hi_s32 hal_hdmi_mach_trigger(hi_u32 mach_id, hi_u32 delay_ms)
+{
+    unsigned long flags = 0;
+    hi_u64 trigger_time;
+    hdmi_mach_elem *tmp_elem = HI_NULL;
+    hdmi_mach_info *mach_info = &g_machine_info;
+
+    hdmi_if_false_return(mach_info->init, HI_FAILURE);
+    hdmi_check_max_return(mach_id, MACHINE_MAX_ID_NUM - 1, HI_FAILURE);
+
+    tmp_elem = &mach_info->mach_elem[mach_id];
+    trigger_time = hal_hdmi_mach_ms_get() + delay_ms;
+    osal_spin_lock_irqsave(&mach_info->event_lock, &flags);
+    /* keep the earliest request, the callback re-arms itself for later ones */
+    if (!tmp_elem->mach_run.triggered || trigger_time < tmp_elem->mach_run.trigger_time) {
+        tmp_elem->mach_run.trigger_time = trigger_time;
+    }
+    tmp_elem->mach_run.triggered = HI_TRUE;
+    mach_info->wakeup = HI_TRUE;
+    osal_spin_unlock_irqrestore(&mach_info->event_lock, &flags);
+    osal_wakeup(&mach_info->event_wait);
+
+    return HI_SUCCESS;
+}
+
+hi_void hal_hdmi_mach_wakeup(hi_bool stop)
+{
+    unsigned long flags = 0;
+    hdmi_mach_info *mach_info = &g_machine_info;
+
+    hdmi_if_false_return_void(mach_info->init);
+
+    osal_spin_lock_irqsave(&mach_info->event_lock, &flags);
+    mach_info->wakeup = HI_TRUE;
+    mach_info->stop = (mach_info->stop || stop) ? HI_TRUE : HI_FALSE;
+    osal_spin_unlock_irqrestore(&mach_info->event_lock, &flags);
+    osal_wakeup(&mach_info->event_wait);
+
+    return;
+}
+
+hi_void hal_hdmi_mach_wait(hi_u32 max_ms)
+{
+    hi_u32 timeout;
+    unsigned long flags = 0;
+    hdmi_mach_info *mach_info = &g_machine_info;
+
+    if (!mach_info->init) {
+        osal_msleep(max_ms);
+        return;
+    }
+
+    /* clear first, a trigger after the deadline is computed still ends the wait */
+    osal_spin_lock_irqsave(&mach_info->event_lock, &flags);
+    mach_info->wakeup = HI_FALSE;
+    osal_spin_unlock_irqrestore(&mach_info->event_lock, &flags);
+
+    timeout = mach_next_timeout_get(mach_info, max_ms);
+    if (timeout == 0) {
+        return;
+    }
+    (hi_void)osal_wait_event_timeout_interruptible(&mach_info->event_wait, mach_wait_cond, mach_info, timeout);
+
+    return;
+}
+
@@ -23,6 +23,8 @@
 #define HDMI_MACH_MAX_STAMPE_NUM   6
 #define HDMI_MACH_MAX_NAME_SIZE    15
 #define HDMI_MACH_DEFUALT_INTERVAL 10
+/* element without a period, it only runs when triggered by hal_hdmi_mach_trigger */
+#define HDMI_MACH_EVENT_INTERVAL   ((hi_u64)(-1))
 
 typedef hi_void (*mach_callback)(hi_void *data);
 
@@ -43,6 +45,8 @@ typedef struct {
     hi_u32  stamp_idx;
     hi_u64  timestamp[HDMI_MACH_MAX_STAMPE_NUM];
     hi_char name[HDMI_MACH_MAX_NAME_SIZE];
+    hi_bool triggered;
+    hi_u64  trigger_time;
 } hdmi_mach_run;
 
 typedef struct {
@@ -84,5 +88,14 @@ hi_s32 hal_hdmi_mach_elem_status_get(hi_u32 mach_id, hdmi_mach_elem_status *stat
 
 hi_u64 hal_hdmi_mach_ms_get(hi_void);
 
+/* run the element once after delay_ms, may be called in interrupt context */
+hi_s32 hal_hdmi_mach_trigger(hi_u32 mach_id, hi_u32 delay_ms);
+
+/* wake the sequencer thread, stop keeps it awake until it exits */
+hi_void hal_hdmi_mach_wakeup(hi_bool stop);
+
+/* sleep until the next element is due, a trigger arrives or max_ms passed */
+hi_void hal_hdmi_mach_wait(hi_u32 max_ms);
+
 #endif /* __HDMI_HAL_MACHINE_H__ */
 
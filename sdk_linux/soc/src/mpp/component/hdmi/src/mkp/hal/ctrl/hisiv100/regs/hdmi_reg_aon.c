@@ -47,6 +47,19 @@ int hdmi_reg_aon_intr_mask0_set(unsigned int aon_intr_mask0)
     return HI_SUCCESS;
 }
 
+int hdmi_reg_aon_intr_mask1_set(unsigned int aon_intr_mask1)
+{
+    hi_u32 *reg_addr = NULL;
+    tx_aon_intr_mask mask;
+
+    reg_addr = (hi_u32 *)&(g_tx_aon_regs->aon_irq_mask.u32);
+    mask.u32 = hdmi_tx_reg_read(reg_addr);
+    mask.bits.aon_intr_mask1 = aon_intr_mask1;
+    hdmi_tx_reg_write(reg_addr, mask.u32);
+
+    return HI_SUCCESS;
+}
+
 int hdmi_reg_aon_intr_stat1_set(unsigned int aon_intr_stat1)
 {
     hi_u32 *reg_addr = NULL;
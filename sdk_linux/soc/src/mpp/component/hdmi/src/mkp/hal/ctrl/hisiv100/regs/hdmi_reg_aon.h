@@ -240,6 +240,7 @@ typedef struct {
 int hdmi_reg_aon_regs_init(char *addr);
 int hdmi_reg_aon_regs_deinit(void);
 int hdmi_reg_aon_intr_mask0_set(unsigned int aon_intr_mask0);
+int hdmi_reg_aon_intr_mask1_set(unsigned int aon_intr_mask1);
 int hdmi_reg_aon_intr_stat0_set(unsigned int aon_intr_stat0);
 int hdmi_reg_aon_intr_stat1_set(unsigned int aon_intr_stat1);
 int hdmi_reg_dcc_man_en_set(unsigned int dcc_man_en);
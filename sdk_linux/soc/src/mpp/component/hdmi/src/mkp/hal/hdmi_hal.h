@@ -90,6 +90,10 @@ typedef struct hdmi_hal_ {
     hi_s32  (*hal_hdmi_phy_hw_spec_set)(const struct hdmi_hal_ *hdmi_hal, hi_u32 tmds_clk, const hdmi_hw_spec *hw_spec);
     hi_s32  (*hal_hdmi_phy_hw_spec_get)(const struct hdmi_hal_ *hdmi_hal, hdmi_hw_spec *hw_spec);
     hi_void (*hal_hdmi_sequencer_handler_process)(const struct hdmi_hal_ *hal);
+    hi_void (*hal_hdmi_sequencer_wait)(const struct hdmi_hal_ *hal, hi_u32 max_ms);
+    hi_void (*hal_hdmi_sequencer_wakeup)(const struct hdmi_hal_ *hal, hi_bool stop);
+    hi_s32  (*hal_hdmi_hpd_irq_mode_set)(const struct hdmi_hal_ *hal, hi_bool enable);
+    hi_bool (*hal_hdmi_hpd_irq_handler)(const struct hdmi_hal_ *hal);
     hi_void (*hal_hdmi_hardware_status_get)(const struct hdmi_hal_ *hal, hdmi_hardware_status *hw_status);
     hi_void (*hal_hdmi_hot_plug_status_get)(const struct hdmi_hal_ *hal, hi_bool *hot_plug);
     hi_void (*hal_hdmi_hdp_intr_status_get)(const struct hdmi_hal_ *hal, hi_bool *intr_status);
@@ -98,6 +102,8 @@ typedef struct hdmi_hal_ {
     hi_s32  (*hal_hdmi_audio_n_cts_set)(const struct hdmi_hal_ *hal, hdmi_audio_ncts *audio_cfg);
     hi_void (*hal_hdmi_audio_path_enable_set)(const struct hdmi_hal_ *hal, hi_bool enable);
     hi_s32  (*hal_hdmi_edid_raw_data_read)(const struct hdmi_hal_ *hal, hi_u32 size, hi_u8 out_buffer[]);
+    hi_s32  (*hal_hdmi_edid_fingerprint_read)(const struct hdmi_hal_ *hal, hi_u8 block0[], hi_u8 ext_sum[],
+                                               hi_u32 sum_num);
     hi_void (*hal_hdmi_phy_output_enable_get)(const struct hdmi_hal_ *hal, hi_bool *enable);
     hi_void (*hal_hdmi_video_mute_set)(const struct hdmi_hal_ *hal, hi_bool video_mute);
     hi_void (*hal_hdmi_black_data_set)(const struct hdmi_hal_ *hal, hdmi_black_frame_info *black_pram);
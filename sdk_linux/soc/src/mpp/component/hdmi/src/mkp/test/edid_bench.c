@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Benchmark of the EDID parser over a corpus: each file given on the command
+ * line is
+ * - parsed EDID_BENCH_LOOP times, reporting the mean time per parse;
+ * - run through drv_hdmi_edid_update against a fake sink, cold (cache miss:
+ *   fingerprint, full read, parse, store) and warm (cache hit: fingerprint
+ *   only). The fake HAL counts the DDC bytes each path moves and converts them
+ *   to bus time at EDID_BENCH_DDC_HZ, which dominates on real hardware.
+ */
+#include <time.h>
+#include "hdmi_edid_shim.h"
+#include "drv_hdmi_edid.c"
+
+#define EDID_BENCH_LOOP         100000
+#define EDID_BENCH_DDC_HZ       100000 /* standard mode DDC clock */
+#define EDID_BENCH_DDC_BYTE_BIT 9      /* 8 data bits and the ack */
+#define EDID_BENCH_DDC_OVERHEAD 4      /* address, offset, repeated start address and stop per transaction */
+
+typedef struct {
+    const hi_u8 *data;
+    hi_u32 len;
+    hi_u32 ddc_bytes;
+} edid_bench_sink;
+
+static hdmi_device g_edid_bench_dev;
+static hdmi_hal g_edid_bench_hal;
+static edid_bench_sink g_edid_bench_sink;
+
+static hi_double edid_bench_now(hi_void)
+{
+    struct timespec ts;
+
+    (hi_void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (hi_double)ts.tv_sec + (hi_double)ts.tv_nsec / 1e9; /* 1e9: ns per second */
+}
+
+static hi_void edid_bench_hot_plug_get(const struct hdmi_hal_ *hal, hi_bool *hot_plug)
+{
+    *hot_plug = HI_TRUE;
+}
+
+/* the sink answers whole blocks, as many as block 0 announces and the file holds */
+static hi_s32 edid_bench_raw_read(const struct hdmi_hal_ *hal, hi_u32 size, hi_u8 out_buffer[])
+{
+    hi_u32 len;
+
+    len = (g_edid_bench_sink.len < size) ? g_edid_bench_sink.len : size;
+    len = (len < (g_edid_bench_sink.data[EDID_EXTENSION_BLK_ADDR] + 1) * HDMI_EDID_BLOCK_SIZE) ?
+        len : (g_edid_bench_sink.data[EDID_EXTENSION_BLK_ADDR] + 1) * HDMI_EDID_BLOCK_SIZE;
+    (hi_void)memcpy(out_buffer, g_edid_bench_sink.data, len);
+    g_edid_bench_sink.ddc_bytes += len + (len / HDMI_EDID_BLOCK_SIZE) * EDID_BENCH_DDC_OVERHEAD;
+    return (hi_s32)len;
+}
+
+static hi_s32 edid_bench_fingerprint_read(const struct hdmi_hal_ *hal, hi_u8 block0[], hi_u8 ext_sum[],
+                                          hi_u32 sum_num)
+{
+    hi_u32 i, ext_num;
+
+    (hi_void)memcpy(block0, g_edid_bench_sink.data, HDMI_EDID_BLOCK_SIZE);
+    g_edid_bench_sink.ddc_bytes += HDMI_EDID_BLOCK_SIZE + EDID_BENCH_DDC_OVERHEAD;
+    ext_num = block0[EDID_EXTENSION_BLK_ADDR];
+    ext_num = (ext_num < sum_num) ? ext_num : sum_num;
+    for (i = 0; (i < ext_num) && ((i + 2) * HDMI_EDID_BLOCK_SIZE <= g_edid_bench_sink.len); i++) {
+        ext_sum[i] = g_edid_bench_sink.data[(i + 2) * HDMI_EDID_BLOCK_SIZE - 1];
+        g_edid_bench_sink.ddc_bytes += 1 + EDID_BENCH_DDC_OVERHEAD;
+    }
+    return (hi_s32)i;
+}
+
+static hi_void edid_bench_parse(const char *name, const hi_u8 *data, size_t size)
+{
+    static hdmi_edid_info edid_info;
+    hi_double start, cost;
+    hi_s32 ret = HI_SUCCESS;
+    hi_u32 loop;
+
+    start = edid_bench_now();
+    for (loop = 0; loop < EDID_BENCH_LOOP; loop++) {
+        /* the load is part of every real update, so it is timed too */
+        if (hdmi_edid_shim_load(&edid_info, data, size) != HI_SUCCESS) {
+            break;
+        }
+        ret = edid_raw_parse(&edid_info);
+    }
+    cost = edid_bench_now() - start;
+    if (loop != EDID_BENCH_LOOP) {
+        printf("%-36s %6s %6s %10s\n", name, "-", "short", "-");
+        return;
+    }
+    printf("%-36s %6u %6s %10.1f\n", name, edid_info.status.raw_len / HDMI_EDID_BLOCK_SIZE,
+           (ret == HI_SUCCESS) ? "ok" : "fail", cost * 1e9 / EDID_BENCH_LOOP); /* 1e9: ns per second */
+}
+
+/* one update, cold or warm; returns the host time in ns and the DDC bytes moved */
+static hi_s32 edid_bench_update(hi_bool cold, hi_double *ns, hi_u32 *ddc_bytes)
+{
+    hi_double start, cost;
+    hi_s32 ret = HI_SUCCESS;
+    hi_u32 loop;
+
+    start = edid_bench_now();
+    for (loop = 0; loop < EDID_BENCH_LOOP; loop++) {
+        if (cold) {
+            (hi_void)memset(&g_edid_bench_dev.edid_cache, 0, sizeof(g_edid_bench_dev.edid_cache));
+        }
+        g_edid_bench_sink.ddc_bytes = 0;
+        ret = drv_hdmi_edid_update(&g_edid_bench_dev.edid_info, HDMI_EDID_UPDATE_SINK);
+    }
+    cost = edid_bench_now() - start;
+    *ns = cost * 1e9 / EDID_BENCH_LOOP; /* 1e9: ns per second */
+    *ddc_bytes = g_edid_bench_sink.ddc_bytes;
+    return ret;
+}
+
+static hi_void edid_bench_cache(const char *name, const hi_u8 *data, size_t size)
+{
+    hi_double cold_ns, warm_ns;
+    hi_u32 cold_bytes, warm_bytes;
+    hi_s32 ret;
+
+    if (size < HDMI_EDID_BLOCK_SIZE) {
+        printf("%-36s %s\n", name, "short");
+        return;
+    }
+    g_edid_bench_sink.data = data;
+    g_edid_bench_sink.len = (size > HDMI_EDID_TOTAL_SIZE) ? HDMI_EDID_TOTAL_SIZE : (hi_u32)size;
+    g_edid_bench_sink.len -= g_edid_bench_sink.len % HDMI_EDID_BLOCK_SIZE;
+
+    ret = edid_bench_update(HI_TRUE, &cold_ns, &cold_bytes);
+    if (ret != HI_SUCCESS) {
+        printf("%-36s %6s\n", name, "fail");
+        return;
+    }
+    (hi_void)edid_bench_update(HI_FALSE, &warm_ns, &warm_bytes);
+    printf("%-36s %10.1f %10.1f %8u %8u %9.2f %9.2f\n", name, cold_ns, warm_ns, cold_bytes, warm_bytes,
+           (hi_double)cold_bytes * EDID_BENCH_DDC_BYTE_BIT * 1000 / EDID_BENCH_DDC_HZ,  /* 1000: ms */
+           (hi_double)warm_bytes * EDID_BENCH_DDC_BYTE_BIT * 1000 / EDID_BENCH_DDC_HZ); /* 1000: ms */
+}
+
+int main(int argc, char *argv[])
+{
+    hi_u8 *data[argc];
+    size_t size[argc];
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (hdmi_edid_shim_read_file(argv[i], &data[i], &size[i]) != HI_SUCCESS) {
+            printf("read %s failed\n", argv[i]);
+            return 1;
+        }
+    }
+
+    printf("%-36s %6s %6s %10s\n", "edid", "blocks", "result", "ns/parse");
+    for (i = 1; i < argc; i++) {
+        edid_bench_parse(argv[i], data[i], size[i]);
+    }
+
+    g_edid_bench_hal.hal_hdmi_hot_plug_status_get = edid_bench_hot_plug_get;
+    g_edid_bench_hal.hal_hdmi_edid_raw_data_read = edid_bench_raw_read;
+    g_edid_bench_hal.hal_hdmi_edid_fingerprint_read = edid_bench_fingerprint_read;
+    g_edid_bench_dev.hal = &g_edid_bench_hal;
+    printf("\n%-36s %10s %10s %8s %8s %9s %9s\n", "edid update", "miss ns", "hit ns", "miss B", "hit B",
+           "miss ms", "hit ms");
+    for (i = 1; i < argc; i++) {
+        edid_bench_cache(argv[i], data[i], size[i]);
+    }
+
+    for (i = 1; i < argc; i++) {
+        free(data[i]);
+    }
+    return 0;
+}
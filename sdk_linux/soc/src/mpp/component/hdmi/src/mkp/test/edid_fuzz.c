@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Fuzz target of the EDID parser. Built with -fsanitize=fuzzer it is a
+ * libFuzzer target; built without it, main() replays the files given on the
+ * command line, which is also the entry point for AFL (afl-clang-fast, @@).
+ */
+#include "hdmi_edid_shim.h"
+#include "drv_hdmi_edid.c"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static hdmi_edid_info edid_info;
+
+    if (hdmi_edid_shim_load(&edid_info, data, size) != HI_SUCCESS) {
+        return 0;
+    }
+    (hi_void)edid_raw_parse(&edid_info);
+    return 0;
+}
+
+#ifndef EDID_FUZZ_LIBFUZZER
+int main(int argc, char *argv[])
+{
+    hi_u8 *data = HI_NULL;
+    size_t size = 0;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (hdmi_edid_shim_read_file(argv[i], &data, &size) != HI_SUCCESS) {
+            printf("read %s failed\n", argv[i]);
+            return 1;
+        }
+        (hi_void)LLVMFuzzerTestOneInput(data, size);
+        free(data);
+        data = HI_NULL;
+    }
+    printf("%d input(s) parsed\n", argc - 1);
+    return 0;
+}
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host shims for building the EDID parser outside the kernel. Each harness is a
+ * single translation unit that includes this header and then drv_hdmi_edid.c,
+ * so the OSAL functions the parser links against are defined here once.
+ */
+#ifndef __HDMI_EDID_SHIM_H__
+#define __HDMI_EDID_SHIM_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hi_type.h"
+#include "hi_osal.h"
+#include "drv_hdmi_edid.h"
+
+int osal_memcmp(const void *cs, const void *ct, int count)
+{
+    return memcmp(cs, ct, (size_t)count);
+}
+
+/*
+ * Load raw sink data into edid_info the way drv_hdmi_edid_update does after the
+ * DDC read: whole blocks only, at most HDMI_EDID_TOTAL_SIZE bytes.
+ * HI_FAILURE is returned for input shorter than one block.
+ */
+static inline hi_s32 hdmi_edid_shim_load(hdmi_edid_info *edid_info, const hi_u8 *data, size_t size)
+{
+    size_t len;
+
+    (hi_void)memset(edid_info, 0, sizeof(*edid_info));
+    len = (size > HDMI_EDID_TOTAL_SIZE) ? HDMI_EDID_TOTAL_SIZE : size;
+    len -= len % HDMI_EDID_BLOCK_SIZE;
+    if (len == 0) {
+        return HI_FAILURE;
+    }
+    (hi_void)memcpy(edid_info->edid_raw, data, len);
+    edid_info->status.raw_len = (hi_u32)len;
+    edid_info->status.raw_valid = HI_TRUE;
+    return HI_SUCCESS;
+}
+
+/* read a whole file, the caller frees *data */
+static inline hi_s32 hdmi_edid_shim_read_file(const char *path, hi_u8 **data, size_t *size)
+{
+    FILE *fp = HI_NULL;
+    long len;
+
+    fp = fopen(path, "rb");
+    if (fp == HI_NULL) {
+        return HI_FAILURE;
+    }
+    if ((fseek(fp, 0, SEEK_END) != 0) || ((len = ftell(fp)) < 0) || (fseek(fp, 0, SEEK_SET) != 0)) {
+        fclose(fp);
+        return HI_FAILURE;
+    }
+    *data = malloc((size_t)len + 1);
+    if (*data == HI_NULL) {
+        fclose(fp);
+        return HI_FAILURE;
+    }
+    *size = fread(*data, 1, (size_t)len, fp);
+    fclose(fp);
+    return HI_SUCCESS;
+}
+
+#endif /* __HDMI_EDID_SHIM_H__ */
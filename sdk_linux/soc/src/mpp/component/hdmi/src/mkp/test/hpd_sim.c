@@ -0,0 +1,533 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host simulation of the HDMI hot-plug path: the hal sequencer
+ * (hdmi_hal_machine.c), the HPD element and interrupt handler of
+ * hdmi_hal_ctrl.c and the AON register accessors run unchanged against
+ * - a register block in memory whose interrupt status is write 1 to clear and
+ *   latches every HPD/RSEN edge, raising the interrupt when it is unmasked;
+ * - a millisecond clock that only moves while the timer thread sleeps in
+ *   hal_hdmi_mach_wait, so every run is exact and repeatable.
+ * Scripted edge sequences check the reported events and their times in
+ * interrupt and polling mode, edges that land while the HPD element reads the
+ * lines, the idle wakeups and the HDR timers. Random scripts then check that
+ * the reported state always ends equal to the lines and that no event is
+ * reported while the lines bounce.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hi_type.h"
+#include "hi_osal.h"
+#include "hdmi_hal_machine.c"
+#include "hdmi_reg_aon.c"
+#include "hdmi_reg_audio_path.c"
+#include "hdmi_reg_ctrl.c"
+#include "hdmi_reg_tx.c"
+#include "hdmi_reg_video_path.c"
+#include "hdmi_hal_ctrl.c"
+
+#define HPD_SIM_REG_SIZE     0x30000
+#define HPD_SIM_IDLE_WAIT    1000 /* HDMI_THREAD_IDLE_WAIT_TIME of drv_hdmi_intf.c */
+#define HPD_SIM_MAX_EDGE     16
+#define HPD_SIM_MAX_EXPECT   4
+#define HPD_SIM_MAX_EVENT    64
+#define HPD_SIM_MAX_SPIN     100 /* runs of the thread without the clock moving */
+#define HPD_SIM_IDLE_TIME    10000
+#define HPD_SIM_HDR_TIME     2000
+#define HPD_SIM_HDR_PLUG     10   /* ms before the HDR deadline */
+#define HPD_SIM_RANDOM_RUNS  2000
+#define HPD_SIM_RANDOM_GAP   120 /* ms between random edges, up to */
+#define HPD_SIM_RANDOM_EDGES 12
+
+typedef enum {
+    HPD_SIM_LINE_HPD,
+    HPD_SIM_LINE_RSEN
+} hpd_sim_line;
+
+/* an edge at its time, or armed at its time and made while the HPD element reads the lines */
+typedef enum {
+    HPD_SIM_EDGE_NOW,
+    HPD_SIM_EDGE_BEFORE_READ,
+    HPD_SIM_EDGE_AFTER_READ
+} hpd_sim_edge_type;
+
+typedef struct {
+    hi_u64 time;
+    hpd_sim_line line;
+    hpd_sim_edge_type type;
+} hpd_sim_edge;
+
+typedef struct {
+    hdmi_event event;
+    hi_u64 min_time;
+    hi_u64 max_time;
+} hpd_sim_expect;
+
+typedef struct {
+    const hi_char *name;
+    hi_bool irq_mode;
+    hi_u64 end_time;
+    hi_u32 edge_num;
+    hpd_sim_edge edge[HPD_SIM_MAX_EDGE];
+    hi_u32 expect_num;
+    hpd_sim_expect expect[HPD_SIM_MAX_EXPECT];
+} hpd_sim_script;
+
+typedef struct {
+    hi_u64 time;
+    hdmi_event event;
+} hpd_sim_event;
+
+typedef struct {
+    hi_u64 now;
+    hi_bool irq_mode;
+    hi_u32 wakeups;
+    const hpd_sim_edge *edge;
+    hi_u32 edge_num;
+    hi_u32 edge_next;
+    const hpd_sim_edge *armed;
+    hi_u64 last_edge_time;
+    hi_u64 edge_time[HPD_SIM_MAX_EDGE];
+    hi_u32 edge_done;
+    hi_u32 event_num;
+    hpd_sim_event event[HPD_SIM_MAX_EVENT];
+} hpd_sim;
+
+static hi_u32 g_hpd_sim_reg[HPD_SIM_REG_SIZE / sizeof(hi_u32)];
+static hpd_sim g_hpd_sim;
+static hi_u32 g_hpd_sim_fail;
+static hi_u32 g_hpd_sim_seed = 1;
+
+static hi_void hpd_sim_check(hi_bool cond, const hi_char *name, const hi_char *what)
+{
+    if (!cond) {
+        g_hpd_sim_fail++;
+    }
+    printf("%s %s: %s\n", cond ? "ok  " : "FAIL", name, what);
+}
+
+static hi_u32 hpd_sim_rand(hi_u32 range)
+{
+    g_hpd_sim_seed = g_hpd_sim_seed * 1103515245 + 12345; /* 1103515245, 12345: C89 rand constants */
+    return (g_hpd_sim_seed >> 16) % range; /* 16: the low bits of an LCG are weak */
+}
+
+/* the hardware: AON lines, W1C interrupt status and the interrupt line */
+static hi_bool hpd_sim_line_get(hpd_sim_line line)
+{
+    return (line == HPD_SIM_LINE_HPD) ? (hi_bool)g_tx_aon_regs->aon_state.bits.hotplug_state :
+        (hi_bool)g_tx_aon_regs->aon_state.bits.phy_rx_sense;
+}
+
+static hi_void hpd_sim_edge_make(const hpd_sim_edge *edge)
+{
+    hi_bool irq;
+
+    if (edge->line == HPD_SIM_LINE_HPD) {
+        g_tx_aon_regs->aon_state.bits.hotplug_state = !g_tx_aon_regs->aon_state.bits.hotplug_state;
+        g_tx_aon_regs->aon_irq_state.bits.aon_intr_stat0 = 1;
+        irq = g_tx_aon_regs->aon_irq_mask.bits.aon_intr_mask0;
+    } else {
+        g_tx_aon_regs->aon_state.bits.phy_rx_sense = !g_tx_aon_regs->aon_state.bits.phy_rx_sense;
+        g_tx_aon_regs->aon_irq_state.bits.aon_intr_stat1 = 1;
+        irq = g_tx_aon_regs->aon_irq_mask.bits.aon_intr_mask1;
+    }
+    g_hpd_sim.last_edge_time = g_hpd_sim.now;
+    g_hpd_sim.edge_time[g_hpd_sim.edge_done++] = g_hpd_sim.now;
+    /* in polling mode the driver requested no interrupt */
+    if (g_hpd_sim.irq_mode && irq) {
+        (hi_void)hal_hdmi_ctrl_hpd_irq_handle(HDMI_DEVICE_ID0);
+    }
+}
+
+hi_u32 hdmi_tx_reg_read(const hi_u32 *reg_addr)
+{
+    const hpd_sim_edge *armed = g_hpd_sim.armed;
+    hi_u32 value;
+
+    if (armed == HI_NULL || reg_addr != (const hi_u32 *)&g_tx_aon_regs->aon_state.u32) {
+        return *reg_addr;
+    }
+    /* only the HPD element reads the lines, after it took the latched edges */
+    g_hpd_sim.armed = HI_NULL;
+    if (armed->type == HPD_SIM_EDGE_BEFORE_READ) {
+        hpd_sim_edge_make(armed);
+        return *reg_addr;
+    }
+    value = *reg_addr;
+    hpd_sim_edge_make(armed);
+    return value;
+}
+
+hi_void hdmi_tx_reg_write(hi_u32 *reg_addr, hi_u32 value)
+{
+    if (reg_addr == (hi_u32 *)&g_tx_aon_regs->aon_irq_state.u32) {
+        *reg_addr &= ~value;
+        return;
+    }
+    *reg_addr = value;
+}
+
+/* the clock: events of the script fire as time passes while the thread sleeps */
+static hi_void hpd_sim_edges_fire(hi_void)
+{
+    const hpd_sim_edge *edge = HI_NULL;
+
+    while (g_hpd_sim.edge_next < g_hpd_sim.edge_num && g_hpd_sim.edge[g_hpd_sim.edge_next].time <= g_hpd_sim.now) {
+        edge = &g_hpd_sim.edge[g_hpd_sim.edge_next++];
+        if (edge->type == HPD_SIM_EDGE_NOW) {
+            hpd_sim_edge_make(edge);
+        } else {
+            g_hpd_sim.armed = edge;
+        }
+    }
+}
+
+/* sleep up to ms, return the time left when cond (if any) became true, 0 on timeout */
+static hi_u64 hpd_sim_sleep(hi_u64 ms, osal_wait_cond_func_t cond, const hi_void *param)
+{
+    hi_u64 end = g_hpd_sim.now + ms;
+    hi_u64 next;
+
+    while (g_hpd_sim.now < end) {
+        next = (g_hpd_sim.edge_next < g_hpd_sim.edge_num) ? g_hpd_sim.edge[g_hpd_sim.edge_next].time : end;
+        g_hpd_sim.now = (next < g_hpd_sim.now) ? g_hpd_sim.now : ((next < end) ? next : end);
+        hpd_sim_edges_fire();
+        if (cond != HI_NULL && cond(param) != 0) {
+            return (end > g_hpd_sim.now) ? (end - g_hpd_sim.now) : 1;
+        }
+    }
+    return 0;
+}
+
+hi_u32 hdmi_osal_get_time_in_ms(hi_void)
+{
+    return (hi_u32)g_hpd_sim.now;
+}
+
+unsigned long osal_msleep(unsigned int msecs)
+{
+    (hi_void)hpd_sim_sleep(msecs, HI_NULL, HI_NULL);
+    return 0;
+}
+
+unsigned long osal_msecs_to_jiffies(const unsigned int m)
+{
+    return m;
+}
+
+int osal_wait_timeout_interruptible(osal_wait_t *wait, osal_wait_cond_func_t func, const void *param,
+    unsigned long ms)
+{
+    return (int)hpd_sim_sleep(ms, func, param);
+}
+
+/* single thread: the interrupt runs inside the sleep, locks and wait queues have nothing to do */
+void osal_udelay(unsigned int usecs) {}
+int osal_sema_init(osal_semaphore_t *sem, int val) { return 0; }
+int osal_down(osal_semaphore_t *sem) { return 0; }
+void osal_up(osal_semaphore_t *sem) {}
+void osal_sema_destroy(osal_semaphore_t *sem) {}
+int osal_spin_lock_init(osal_spinlock_t *lock) { return 0; }
+void osal_spin_lock_irqsave(osal_spinlock_t *lock, unsigned long *flags) {}
+void osal_spin_unlock_irqrestore(osal_spinlock_t *lock, const unsigned long *flags) {}
+void osal_spin_lock_destroy(osal_spinlock_t *lock) {}
+int osal_wait_init(osal_wait_t *wait) { return 0; }
+void osal_wakeup(osal_wait_t *wait) {}
+void osal_wait_destroy(osal_wait_t *wait) {}
+int osal_strlen(const char *s) { return (int)strlen(s); }
+
+int hdmi_reg_crg_init(void) { return HI_SUCCESS; }
+int hdmi_reg_crg_deinit(void) { return HI_SUCCESS; }
+hi_void drv_hdmi_prod_crg_gate_set(hi_bool enable) {}
+hi_u32 hal_hdmi_n_value_get(hi_u32 sample_rate, hi_u32 tmds_clk) { return 0; }
+hi_u32 hal_hdmi_cts_value_get(hi_u32 sample_rate, hi_u32 tmds_clk) { return 0; }
+
+static hi_s32 hpd_sim_event_callback(hi_void *data, hdmi_event event)
+{
+    if (g_hpd_sim.event_num < HPD_SIM_MAX_EVENT) {
+        g_hpd_sim.event[g_hpd_sim.event_num].time = g_hpd_sim.now;
+        g_hpd_sim.event[g_hpd_sim.event_num].event = event;
+        g_hpd_sim.event_num++;
+    }
+    return HI_SUCCESS;
+}
+
+/* the driver side: probe, interrupt request and the timer thread of drv_hdmi_intf.c */
+static hi_void hpd_sim_start(hi_bool irq_mode, const hpd_sim_edge *edge, hi_u32 edge_num)
+{
+    hdmi_hal_init hal_init = {0};
+
+    (hi_void)memset(g_hpd_sim_reg, 0, sizeof(g_hpd_sim_reg));
+    (hi_void)memset(&g_hpd_sim, 0, sizeof(g_hpd_sim));
+    g_hpd_sim.irq_mode = irq_mode;
+    g_hpd_sim.edge = edge;
+    g_hpd_sim.edge_num = edge_num;
+    hal_init.event_data = &g_hpd_sim;
+    hal_init.event_callback = hpd_sim_event_callback;
+    hal_init.base_addr = (hi_char *)g_hpd_sim_reg;
+    (hi_void)hal_hdmi_mach_init();
+    (hi_void)hal_hdmi_ctrl_init(HDMI_DEVICE_ID0, &hal_init);
+    if (irq_mode) {
+        (hi_void)hal_hdmi_ctrl_hpd_irq_mode_set(HDMI_DEVICE_ID0, HI_TRUE);
+    }
+}
+
+static hi_void hpd_sim_stop(hi_void)
+{
+    (hi_void)hal_hdmi_ctrl_deinit(HDMI_DEVICE_ID0);
+    (hi_void)hal_hdmi_mach_deinit();
+}
+
+static hi_bool hpd_sim_run(hi_u64 end_time)
+{
+    hi_u64 last = g_hpd_sim.now;
+    hi_u32 spin = 0;
+
+    while (g_hpd_sim.now < end_time) {
+        hal_hdmi_mach_invoke();
+        g_hpd_sim.wakeups++;
+        hal_hdmi_mach_wait(HPD_SIM_IDLE_WAIT);
+        spin = (g_hpd_sim.now == last) ? (spin + 1) : 0;
+        last = g_hpd_sim.now;
+        if (spin > HPD_SIM_MAX_SPIN) {
+            return HI_FALSE;
+        }
+    }
+    return HI_TRUE;
+}
+
+static hi_u32 hpd_sim_hpd_runs(hi_void)
+{
+    hdmi_mach_elem_status status = {0};
+
+    (hi_void)hal_hdmi_mach_elem_status_get(g_ctrl_info[HDMI_DEVICE_ID0].mach_id, &status);
+    return status.mach_run.run_cnt;
+}
+
+static const hpd_sim_script g_hpd_sim_script[] = {
+    {
+        "plug", HI_TRUE, 1000,
+        1, { { 100, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW } },
+        1, { { HDMI_EVENT_HOTPLUG, 150, 150 } }
+    }, {
+        "plug and unplug", HI_TRUE, 1000,
+        2, { { 100, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW }, { 500, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW } },
+        2, { { HDMI_EVENT_HOTPLUG, 150, 150 }, { HDMI_EVENT_HOTUNPLUG, 550, 550 } }
+    }, {
+        "bouncing plug", HI_TRUE, 1000,
+        5, {
+            { 100, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW }, { 110, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW },
+            { 125, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW }, { 140, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW },
+            { 160, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW }
+        },
+        1, { { HDMI_EVENT_HOTPLUG, 210, 210 } }
+    }, {
+        "glitch", HI_TRUE, 1000,
+        2, { { 100, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW }, { 130, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW } },
+        0, { { 0 } }
+    }, {
+        "rsen after hpd", HI_TRUE, 1000,
+        3, {
+            { 100, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW }, { 120, HPD_SIM_LINE_RSEN, HPD_SIM_EDGE_NOW },
+            { 400, HPD_SIM_LINE_RSEN, HPD_SIM_EDGE_NOW }
+        },
+        3, {
+            { HDMI_EVENT_HOTPLUG, 170, 170 }, { HDMI_EVENT_RSEN_CONNECT, 170, 170 },
+            { HDMI_EVENT_RSEN_DISCONNECT, 450, 450 }
+        }
+    }, {
+        "unplug after the line read", HI_TRUE, 1000,
+        2, { { 100, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW }, { 120, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_AFTER_READ } },
+        2, { { HDMI_EVENT_HOTPLUG, 150, 150 }, { HDMI_EVENT_HOTUNPLUG, 200, 200 } }
+    }, {
+        "unplug before the line read", HI_TRUE, 1000,
+        2, { { 100, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW }, { 120, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_BEFORE_READ } },
+        0, { { 0 } }
+    }, {
+        "polled plug and unplug", HI_FALSE, 1000,
+        2, { { 100, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW }, { 500, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW } },
+        2, { { HDMI_EVENT_HOTPLUG, 100, 111 }, { HDMI_EVENT_HOTUNPLUG, 500, 511 } }
+    }, {
+        "polled rsen", HI_FALSE, 1000,
+        2, { { 100, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW }, { 100, HPD_SIM_LINE_RSEN, HPD_SIM_EDGE_NOW } },
+        2, { { HDMI_EVENT_HOTPLUG, 100, 111 }, { HDMI_EVENT_RSEN_CONNECT, 100, 111 } }
+    },
+};
+
+static hi_void test_script(const hpd_sim_script *script)
+{
+    hi_u32 i;
+    hi_bool match;
+
+    hpd_sim_start(script->irq_mode, script->edge, script->edge_num);
+    hpd_sim_check(hpd_sim_run(script->end_time), script->name, "the thread sleeps between runs");
+    match = (g_hpd_sim.event_num == script->expect_num);
+    for (i = 0; match && i < script->expect_num; i++) {
+        match = (g_hpd_sim.event[i].event == script->expect[i].event &&
+            g_hpd_sim.event[i].time >= script->expect[i].min_time &&
+            g_hpd_sim.event[i].time <= script->expect[i].max_time);
+    }
+    if (!match) {
+        for (i = 0; i < g_hpd_sim.event_num; i++) {
+            printf("     event 0x%x at %llu ms\n", g_hpd_sim.event[i].event,
+                (unsigned long long)g_hpd_sim.event[i].time);
+        }
+    }
+    hpd_sim_check(match, script->name, "the events and their times");
+    hpd_sim_check(g_ctrl_info[HDMI_DEVICE_ID0].hpd == hpd_sim_line_get(HPD_SIM_LINE_HPD) &&
+        g_ctrl_info[HDMI_DEVICE_ID0].rsen == hpd_sim_line_get(HPD_SIM_LINE_RSEN), script->name,
+        "the state ends equal to the lines");
+    hpd_sim_stop();
+}
+
+static hi_void test_idle(hi_void)
+{
+    hi_u32 irq_wakeups, irq_runs;
+
+    hpd_sim_start(HI_TRUE, HI_NULL, 0);
+    (hi_void)hpd_sim_run(HPD_SIM_IDLE_TIME);
+    irq_wakeups = g_hpd_sim.wakeups;
+    irq_runs = hpd_sim_hpd_runs();
+    hpd_sim_stop();
+    hpd_sim_check(irq_runs == 0 && irq_wakeups <= HPD_SIM_IDLE_TIME / HPD_SIM_IDLE_WAIT + 1, "idle",
+        "interrupt mode runs no HPD element and wakes once per idle wait");
+
+    hpd_sim_start(HI_FALSE, HI_NULL, 0);
+    (hi_void)hpd_sim_run(HPD_SIM_IDLE_TIME);
+    hpd_sim_check(hpd_sim_hpd_runs() >= HPD_SIM_IDLE_TIME / (HDMI_MACH_DEFUALT_INTERVAL + 1), "idle",
+        "polling mode runs the HPD element every period");
+    printf("     %u ms idle: interrupt mode %u wakeups, %u HPD runs; polling mode %u wakeups, %u HPD runs\n",
+        HPD_SIM_IDLE_TIME, irq_wakeups, irq_runs, g_hpd_sim.wakeups, hpd_sim_hpd_runs());
+    hpd_sim_stop();
+}
+
+static hi_void test_hdr_timer(hi_void)
+{
+    hdmi_timer_config timer = { HDMI_TIMER_ZERO_DRMIF, HI_TRUE, HPD_SIM_HDR_TIME };
+    /* a plug whose debounce window ends after the deadline must not delay the timeout */
+    hpd_sim_edge edge = { HPD_SIM_HDR_TIME - HPD_SIM_HDR_PLUG, HPD_SIM_LINE_HPD, HPD_SIM_EDGE_NOW };
+
+    hpd_sim_start(HI_TRUE, HI_NULL, 0);
+    (hi_void)hal_hdmi_ctrl_hdr_timer_set(HDMI_DEVICE_ID0, &timer);
+    (hi_void)hpd_sim_run(HPD_SIM_HDR_TIME * 2); /* 2: well past the deadline */
+    hpd_sim_check(g_hpd_sim.event_num == 1 && g_hpd_sim.event[0].event == HDMI_EVENT_ZERO_DRMIF_TIMEOUT &&
+        g_hpd_sim.event[0].time == HPD_SIM_HDR_TIME, "hdr timer", "the timeout is reported at its deadline");
+    hpd_sim_check(hpd_sim_hpd_runs() <= 2, "hdr timer", "the HPD element runs at the start and the deadline only"); /* 2 */
+    hpd_sim_stop();
+
+    hpd_sim_start(HI_TRUE, &edge, 1);
+    (hi_void)hal_hdmi_ctrl_hdr_timer_set(HDMI_DEVICE_ID0, &timer);
+    (hi_void)hpd_sim_run(HPD_SIM_HDR_TIME * 2); /* 2: well past the deadline */
+    hpd_sim_check(g_hpd_sim.event_num == 2 && /* 2: the timeout and the plug */
+        g_hpd_sim.event[0].event == HDMI_EVENT_ZERO_DRMIF_TIMEOUT && g_hpd_sim.event[0].time == HPD_SIM_HDR_TIME &&
+        g_hpd_sim.event[1].event == HDMI_EVENT_HOTPLUG &&
+        g_hpd_sim.event[1].time == edge.time + CTRL_HPD_DEBOUNCE_TIME, "hdr timer and plug",
+        "the timeout keeps its deadline, the plug its debounce window");
+    hpd_sim_stop();
+}
+
+/* no event while either line moved in the debounce window before it, events of a line alternate */
+static hi_bool hpd_sim_random_events_check(hi_void)
+{
+    hi_u32 i, j;
+    hi_bool hpd = HI_FALSE;
+    hi_bool rsen = HI_FALSE;
+    const hpd_sim_event *event = HI_NULL;
+
+    for (i = 0; i < g_hpd_sim.event_num; i++) {
+        event = &g_hpd_sim.event[i];
+        for (j = 0; j < g_hpd_sim.edge_done; j++) {
+            if (g_hpd_sim.edge_time[j] < event->time &&
+                g_hpd_sim.edge_time[j] + CTRL_HPD_DEBOUNCE_TIME > event->time) {
+                return HI_FALSE;
+            }
+        }
+        if (event->event == HDMI_EVENT_HOTPLUG || event->event == HDMI_EVENT_HOTUNPLUG) {
+            if (hpd == (event->event == HDMI_EVENT_HOTPLUG)) {
+                return HI_FALSE;
+            }
+            hpd = !hpd;
+        } else {
+            if (rsen == (event->event == HDMI_EVENT_RSEN_CONNECT)) {
+                return HI_FALSE;
+            }
+            rsen = !rsen;
+        }
+    }
+    return (hpd == hpd_sim_line_get(HPD_SIM_LINE_HPD) && rsen == hpd_sim_line_get(HPD_SIM_LINE_RSEN));
+}
+
+static hi_void test_random(hi_void)
+{
+    hi_u32 run, i, edge_num;
+    hi_u32 bad_events = 0;
+    hi_u32 late = 0;
+    hi_u32 spins = 0;
+    hi_u64 time;
+    hpd_sim_edge edge[HPD_SIM_RANDOM_EDGES];
+
+    for (run = 0; run < HPD_SIM_RANDOM_RUNS; run++) {
+        edge_num = 1 + hpd_sim_rand(HPD_SIM_RANDOM_EDGES);
+        time = 0;
+        for (i = 0; i < edge_num; i++) {
+            time += 1 + hpd_sim_rand(HPD_SIM_RANDOM_GAP);
+            edge[i].time = time;
+            edge[i].line = (hpd_sim_line)hpd_sim_rand(2); /* 2: hpd or rsen */
+            edge[i].type = (hpd_sim_edge_type)hpd_sim_rand(4); /* 4: half the edges at their time */
+            edge[i].type = (edge[i].type > HPD_SIM_EDGE_AFTER_READ) ? HPD_SIM_EDGE_NOW : edge[i].type;
+        }
+        hpd_sim_start(HI_TRUE, edge, edge_num);
+        spins += hpd_sim_run(time + CTRL_HPD_DEBOUNCE_TIME * 4) ? 0 : 1; /* 4: past the last window */
+        /* an edge armed after the last read is never made */
+        g_hpd_sim.armed = HI_NULL;
+        bad_events += hpd_sim_random_events_check() ? 0 : 1;
+        if (g_hpd_sim.event_num > 0 &&
+            g_hpd_sim.event[g_hpd_sim.event_num - 1].time > g_hpd_sim.last_edge_time + CTRL_HPD_DEBOUNCE_TIME) {
+            late++;
+        }
+        hpd_sim_stop();
+    }
+    hpd_sim_check(spins == 0, "random", "the thread sleeps between runs");
+    hpd_sim_check(bad_events == 0, "random", "events alternate, wait for quiet lines and end equal to the lines");
+    hpd_sim_check(late == 0, "random", "the last event comes one debounce window after the last edge");
+}
+
+int main(int argc, char *argv[])
+{
+    hi_u32 i;
+
+    if (argc > 1) {
+        g_hpd_sim_seed = (hi_u32)strtoul(argv[1], HI_NULL, 0);
+    }
+    for (i = 0; i < sizeof(g_hpd_sim_script) / sizeof(g_hpd_sim_script[0]); i++) {
+        test_script(&g_hpd_sim_script[i]);
+    }
+    test_idle();
+    test_hdr_timer();
+    test_random();
+
+    if (g_hpd_sim_fail != 0) {
+        printf("%u check(s) failed\n", g_hpd_sim_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -468,19 +468,16 @@ static hi_s32 hifb_blit_check(hi_tde_export_func **tde_export_func, HIFB_BUFFER_
     return HI_SUCCESS;
 }
 
-hi_s32 hifb_drv_blit(HIFB_BUFFER_S *src_img, HIFB_BUFFER_S *dst_img, hifb_blit_opt *opt,
-                     hi_bool is_refresh_screen, hi_s32 *refresh_handle)
+/* add the blit of src_img->UpdateRect onto dst_img->UpdateRect to the job */
+static hi_s32 drv_blit_add(hi_s32 handle, hi_tde_export_func *tde_export_func, HIFB_BUFFER_S *src_img,
+                           HIFB_BUFFER_S *dst_img, hifb_blit_opt *opt, hi_bool is_refresh_screen)
 {
-    hi_s32 ret, handle;
     hi_tde_surface src_sur = { 0 };
     hi_tde_surface dst_sur = { 0 };
     hi_tde_rect src_rect, dst_rect;
     hi_tde_opt option = { 0 };
-    hi_tde_export_func *tde_export_func = HI_NULL;
     hi_tde_double_src double_src;
-    if (hifb_blit_check((hi_tde_export_func **)&tde_export_func, src_img, dst_img, opt) != HI_SUCCESS) {
-        return HI_FAILURE;
-    }
+
     /* src init */
     drv_blit_init(&src_sur, &src_rect, src_img, opt);
     /* dst_init */
@@ -494,6 +491,20 @@ hi_s32 hifb_drv_blit(HIFB_BUFFER_S *src_img, HIFB_BUFFER_S *dst_img, hifb_blit_o
     /* get option */
     drv_blit_option_init(&src_sur, &dst_sur, &option, opt);
 
+    option.is_compress = opt->compress;
+    double_src.bg_rect = &dst_rect;
+    double_src.bg_surface = &dst_sur;
+    double_src.dst_rect = &dst_rect;
+    double_src.dst_surface = &dst_sur;
+    double_src.fg_rect = &src_rect;
+    double_src.fg_surface = &src_sur;
+    return tde_export_func->drv_tde_module_blit(handle, &double_src, &option);
+}
+
+static hi_s32 drv_blit_begin(hi_tde_export_func *tde_export_func, hifb_blit_opt *opt, hi_s32 *handle)
+{
+    hi_s32 ret;
+
     /* if region deflicker open */
     if (opt->region_deflicker) {
         ret = tde_export_func->drv_tde_module_enable_region_deflicker(HI_TRUE);
@@ -502,7 +513,19 @@ hi_s32 hifb_drv_blit(HIFB_BUFFER_S *src_img, HIFB_BUFFER_S *dst_img, hifb_blit_o
             return ret;
         }
     }
-    ret = tde_export_func->drv_tde_module_begin_job(&handle);
+    return tde_export_func->drv_tde_module_begin_job(handle);
+}
+
+hi_s32 hifb_drv_blit(HIFB_BUFFER_S *src_img, HIFB_BUFFER_S *dst_img, hifb_blit_opt *opt,
+                     hi_bool is_refresh_screen, hi_s32 *refresh_handle)
+{
+    hi_s32 ret, handle;
+    hi_tde_export_func *tde_export_func = HI_NULL;
+    if (hifb_blit_check((hi_tde_export_func **)&tde_export_func, src_img, dst_img, opt) != HI_SUCCESS) {
+        return HI_FAILURE;
+    }
+
+    ret = drv_blit_begin(tde_export_func, opt, &handle);
     if (ret != HI_SUCCESS) {
         return ret;
     }
@@ -511,14 +534,7 @@ hi_s32 hifb_drv_blit(HIFB_BUFFER_S *src_img, HIFB_BUFFER_S *dst_img, hifb_blit_o
         *refresh_handle = handle;
     }
 
-    option.is_compress = opt->compress;
-    double_src.bg_rect = &dst_rect;
-    double_src.bg_surface = &dst_sur;
-    double_src.dst_rect = &dst_rect;
-    double_src.dst_surface = &dst_sur;
-    double_src.fg_rect = &src_rect;
-    double_src.fg_surface = &src_sur;
-    ret = tde_export_func->drv_tde_module_blit(handle, &double_src, &option);
+    ret = drv_blit_add(handle, tde_export_func, src_img, dst_img, opt, is_refresh_screen);
     if (ret != HI_SUCCESS) {
         tde_export_func->drv_tde_module_cancel_job(handle);
         return ret;
@@ -532,6 +548,39 @@ hi_s32 hifb_drv_blit(HIFB_BUFFER_S *src_img, HIFB_BUFFER_S *dst_img, hifb_blit_o
     return HI_SUCCESS;
 }
 
+/* blit every rect of a damage list from src_img to the same place in dst_img, as one TDE job */
+hi_s32 hifb_drv_blit_rects(HIFB_BUFFER_S *src_img, HIFB_BUFFER_S *dst_img, const HIFB_RECT *rects, hi_u32 rect_num,
+                           hifb_blit_opt *opt)
+{
+    hi_s32 ret, handle;
+    hi_u32 i;
+    hi_tde_export_func *tde_export_func = HI_NULL;
+    if ((rects == HI_NULL) ||
+        (hifb_blit_check((hi_tde_export_func **)&tde_export_func, src_img, dst_img, opt) != HI_SUCCESS)) {
+        return HI_FAILURE;
+    }
+    if (rect_num == 0) {
+        return HI_SUCCESS;
+    }
+
+    ret = drv_blit_begin(tde_export_func, opt, &handle);
+    if (ret != HI_SUCCESS) {
+        return ret;
+    }
+
+    for (i = 0; i < rect_num; i++) {
+        src_img->UpdateRect = rects[i];
+        dst_img->UpdateRect = rects[i];
+        ret = drv_blit_add(handle, tde_export_func, src_img, dst_img, opt, HI_TRUE);
+        if (ret != HI_SUCCESS) {
+            tde_export_func->drv_tde_module_cancel_job(handle);
+            return ret;
+        }
+    }
+
+    return drv_blit_start(handle, opt, tde_export_func, HI_NULL);
+}
+
 static hi_void drv_rotate_init(hi_tde_surface *surface, hi_tde_rect *rect, HIFB_BUFFER_S *src_img,
                                HIFB_BUFFER_S *dst_img)
 {
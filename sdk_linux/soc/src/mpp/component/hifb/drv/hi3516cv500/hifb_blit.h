@@ -32,6 +32,8 @@ hi_bool hifb_tde_is_support_fmt(HIFB_COLOR_FMT_E fmt);
 hi_s32 hifb_drv_fill(HIFB_BUFFER_S *dst_img, hi_u32 fill_data);
 hi_s32 hifb_drv_blit(HIFB_BUFFER_S *src_img, HIFB_BUFFER_S *dst_img, hifb_blit_opt *opt, hi_bool refresh_screen,
                      hi_s32 *refresh_handle);
+hi_s32 hifb_drv_blit_rects(HIFB_BUFFER_S *src_img, HIFB_BUFFER_S *dst_img, const HIFB_RECT *rects, hi_u32 rect_num,
+                           hifb_blit_opt *opt);
 hi_s32 hifb_drv_rotate(HIFB_BUFFER_S *src_img, HIFB_BUFFER_S *dst_img, hifb_rotate_opt *rot_opt,
                        hi_bool refresh_screen);
 hi_s32 hifb_drv_set_tde_callback(int_callback tde_callback);
@@ -228,6 +228,7 @@ typedef enum {
     HIFB_LAYER_BUF_NONE = 0x2,   /* no display buf in fb,the buf user refreshed will be directly set to VO */
     HIFB_LAYER_BUF_DOUBLE_IMMEDIATE = 0x3, /* 2 display buf in fb, each refresh will be displayed */
     HIFB_LAYER_BUF_FENCE = 0x4,            /* 2 display buf in fb with fence */
+    HIFB_LAYER_BUF_TRIPLE = 0x5,           /* 3 display buf in fb, the newest drawn buf replaces a pending one */
     HIFB_LAYER_BUF_BUTT
 } HIFB_LAYER_BUF_E;
 
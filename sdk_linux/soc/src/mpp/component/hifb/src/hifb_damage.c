@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "hifb_damage.h"
+#include "securec.h"
+
+/* unit rect */
+static hi_void hifb_unite_rect(HIFB_RECT *dst_rect, const HIFB_RECT *src_rect)
+{
+    HIFB_RECT rect;
+    rect.x = (dst_rect->x < src_rect->x) ? dst_rect->x : src_rect->x;
+    rect.y = (dst_rect->y < src_rect->y) ? dst_rect->y : src_rect->y;
+    rect.w = ((dst_rect->x + dst_rect->w) > (src_rect->x + src_rect->w)) ?
+        (dst_rect->x + dst_rect->w - rect.x) : (src_rect->x + src_rect->w - rect.x);
+    rect.h = ((dst_rect->y + dst_rect->h) > (src_rect->y + src_rect->h)) ?
+        (dst_rect->y + dst_rect->h - rect.y) : (src_rect->y + src_rect->h - rect.y);
+    *dst_rect = rect;
+}
+
+/* check these two rectangle cover each other */
+static hi_bool hifb_iscontain(HIFB_RECT parent_rect, HIFB_RECT child_rect)
+{
+    HIFB_POINT_S point;
+    point.s32XPos = child_rect.x;
+    point.s32YPos = child_rect.y;
+    if ((point.s32XPos < parent_rect.x) || (point.s32XPos > (parent_rect.x + parent_rect.w)) ||
+        (point.s32YPos < parent_rect.y) || (point.s32YPos > (parent_rect.y + parent_rect.h))) {
+        return HI_FALSE;
+    }
+    point.s32XPos = child_rect.x + child_rect.w;
+    point.s32YPos = child_rect.y + child_rect.h;
+    if ((point.s32XPos < parent_rect.x) || (point.s32XPos > (parent_rect.x + parent_rect.w)) ||
+        (point.s32YPos < parent_rect.y) || (point.s32YPos > (parent_rect.y + parent_rect.h))) {
+        return HI_FALSE;
+    }
+    return HI_TRUE;
+}
+
+/* merge two damage rects when the merge copies at most 1/8 of the bounding rect in extra pixels */
+#define HIFB_DAMAGE_WASTE_RATIO 8
+
+static hi_u64 hifb_rect_area(const HIFB_RECT *rect)
+{
+    if ((rect->w <= 0) || (rect->h <= 0)) {
+        return 0;
+    }
+    return (hi_u64)rect->w * (hi_u64)rect->h;
+}
+
+static hi_u64 hifb_rect_overlap_area(const HIFB_RECT *rect_a, const HIFB_RECT *rect_b)
+{
+    HIFB_RECT rect;
+    rect.x = (rect_a->x > rect_b->x) ? rect_a->x : rect_b->x;
+    rect.y = (rect_a->y > rect_b->y) ? rect_a->y : rect_b->y;
+    rect.w = (((rect_a->x + rect_a->w) < (rect_b->x + rect_b->w)) ? (rect_a->x + rect_a->w) :
+        (rect_b->x + rect_b->w)) - rect.x;
+    rect.h = (((rect_a->y + rect_a->h) < (rect_b->y + rect_b->h)) ? (rect_a->y + rect_a->h) :
+        (rect_b->y + rect_b->h)) - rect.y;
+    return hifb_rect_area(&rect);
+}
+
+/* pixels the bounding rect of two rects covers that neither of them needs */
+static hi_u64 hifb_damage_merge_waste(const HIFB_RECT *rect_a, const HIFB_RECT *rect_b, HIFB_RECT *bound)
+{
+    *bound = *rect_a;
+    hifb_unite_rect(bound, rect_b);
+    return hifb_rect_area(bound) + hifb_rect_overlap_area(rect_a, rect_b) - hifb_rect_area(rect_a) -
+        hifb_rect_area(rect_b);
+}
+
+static hi_void hifb_damage_remove(hifb_damage *damage, hi_u32 index)
+{
+    damage->num--;
+    damage->rect[index] = damage->rect[damage->num];
+}
+
+hi_void hifb_damage_clear(hifb_damage *damage)
+{
+    damage->num = 0;
+}
+
+/* drop the damaged areas that rect covers, the coming refresh overwrites them anyway */
+hi_void hifb_damage_exclude(hifb_damage *damage, const HIFB_RECT *rect)
+{
+    hi_u32 i = 0;
+    while (i < damage->num) {
+        if (hifb_iscontain(*rect, damage->rect[i])) {
+            hifb_damage_remove(damage, i);
+        } else {
+            i++;
+        }
+    }
+}
+
+/*
+ * Add a rect to the damage list. It is merged with the existing rect that wastes the
+ * fewest pixels when that waste is small, or unconditionally when the list is full;
+ * the merged rect is then added again, as it may now absorb other rects.
+ */
+hi_void hifb_damage_add(hifb_damage *damage, const HIFB_RECT *new_rect)
+{
+    HIFB_RECT rect = *new_rect;
+    HIFB_RECT bound, best_bound;
+    hi_u64 waste;
+    hi_u64 best_waste = 0;
+    hi_u32 best;
+    hi_u32 i;
+
+    if (hifb_rect_area(&rect) == 0) {
+        return;
+    }
+    for (;;) {
+        for (i = 0; i < damage->num; i++) {
+            if (hifb_iscontain(damage->rect[i], rect)) {
+                return;
+            }
+        }
+        hifb_damage_exclude(damage, &rect);
+
+        best = damage->num;
+        for (i = 0; i < damage->num; i++) {
+            waste = hifb_damage_merge_waste(&damage->rect[i], &rect, &bound);
+            if ((best == damage->num) || (waste < best_waste)) {
+                best = i;
+                best_waste = waste;
+                best_bound = bound;
+            }
+        }
+        if ((best == damage->num) || ((damage->num < HIFB_DAMAGE_MAX_RECT) &&
+            (best_waste * HIFB_DAMAGE_WASTE_RATIO > hifb_rect_area(&best_bound)))) {
+            damage->rect[damage->num++] = rect;
+            return;
+        }
+        rect = best_bound;
+        hifb_damage_remove(damage, best);
+    }
+}
+
+hi_void hifb_damage_bound(const hifb_damage *damage, HIFB_RECT *bound)
+{
+    hi_u32 i;
+
+    (hi_void)memset_s(bound, sizeof(HIFB_RECT), 0, sizeof(HIFB_RECT));
+    for (i = 0; i < damage->num; i++) {
+        if (i == 0) {
+            *bound = damage->rect[0];
+        } else {
+            hifb_unite_rect(bound, &damage->rect[i]);
+        }
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __HIFB_DAMAGE_H__
+#define __HIFB_DAMAGE_H__
+
+#include "hi_type.h"
+#include "hifb.h"
+
+/*
+ * Areas drawn into the displayed buffer since the two buffers were last synced.
+ * Kept as a short list instead of one bounding rect, so updates far apart do not
+ * turn into a near full screen copy.
+ */
+#define HIFB_DAMAGE_MAX_RECT 16
+
+typedef struct {
+    HIFB_RECT rect[HIFB_DAMAGE_MAX_RECT];
+    hi_u32 num;
+} hifb_damage;
+
+hi_void hifb_damage_clear(hifb_damage *damage);
+hi_void hifb_damage_add(hifb_damage *damage, const HIFB_RECT *new_rect);
+hi_void hifb_damage_exclude(hifb_damage *damage, const HIFB_RECT *rect);
+hi_void hifb_damage_bound(const hifb_damage *damage, HIFB_RECT *bound);
+
+#endif /* __HIFB_DAMAGE_H__ */
@@ -147,6 +147,8 @@ static hi_s32 hifb_refresh_0buf(hi_u32 layer_id, HIFB_BUFFER_S *canvas_buf);
 static hi_s32 hifb_refresh_1buf(hi_u32 layer_id, HIFB_BUFFER_S *canvas_buf);
 static hi_s32 hifb_refresh_2buf(hi_u32 layer_id, HIFB_BUFFER_S *canvas_buf);
 static hi_s32 hifb_refresh_2buf_immediate_display(hi_u32 layer_id, HIFB_BUFFER_S *canvas_buf);
+static hi_s32 hifb_refresh_3buf(hi_u32 layer_id, HIFB_BUFFER_S *canvas_buf);
+static hi_void hifb_mailbox_reset(hifb_par *par);
 static hi_s32 hifb_set_mirrormode(hifb_par *par, HIFB_MIRROR_MODE_E mirror_mode);
 static hi_s32 hifb_set_rotatemode(struct fb_info *info, HIFB_ROTATE_MODE_E rotate_mode);
 #ifdef CURSOR
@@ -1642,6 +1644,7 @@ static hi_void hifb_open_init_config(struct fb_info *info, hi_u32 layer_id, hifb
     hifb_set_bufmode(par->layer_id, HIFB_LAYER_BUF_BUTT);
     hifb_set_alpha(par, &alpha);
     hifb_set_dispbufinfo(layer_id);
+    hifb_mailbox_reset(par);
     hifb_set_fmt(par, color_format);
     /* Anti-flicker when interlaced */
     display_info->need_antiflicker = (osd_data->scan_mode == HIFB_SCANMODE_I) ? (HI_TRUE) : (HI_FALSE);
@@ -3642,6 +3645,9 @@ hi_s32 hifb_check_mem_enough(struct fb_info *info, hi_u32 pitch, hi_u32 height)
         case HIFB_LAYER_BUF_ONE:
             buffer_num = 1;
             break;
+        case HIFB_LAYER_BUF_TRIPLE:
+            buffer_num = HIFB_DISP_BUF_NUM;
+            break;
         default:
             return HI_SUCCESS;
     }
@@ -3908,6 +3914,15 @@ static hi_void hifb_set_dispbufinfo(hi_u32 layer_id)
         disp_buf_info->phy_addr[0] = hifb_get_smem_start(info);
         disp_buf_info->phy_addr[1] = hifb_get_smem_start(info) + buf_size;
     }
+    /* the 3rd buf is only used by 3 buf mode, which checks that it differs from the 2nd */
+    if (hifb_get_smem_len(info) >= buf_size * HIFB_DISP_BUF_NUM) {
+        disp_buf_info->phy_addr[2] = disp_buf_info->phy_addr[1] + buf_size; /* 2 the 3rd buf */
+    } else {
+        disp_buf_info->phy_addr[2] = disp_buf_info->phy_addr[1]; /* 2 the 3rd buf */
+    }
+    if (refresh_info->buf_mode == HIFB_LAYER_BUF_TRIPLE) {
+        hifb_mailbox_reset(par);
+    }
     return;
 }
 
@@ -4132,41 +4147,6 @@ static hi_s32 hifb_refresh_1buf(hi_u32 layer_id, HIFB_BUFFER_S *canvas_buf)
     return HI_SUCCESS;
 }
 
-/* unit rect */
-static void hifb_unite_rect(HIFB_RECT *dst_rect, HIFB_RECT *src_rect)
-{
-    hi_s32 ret;
-    HIFB_RECT rect;
-    rect.x = (dst_rect->x < src_rect->x) ? dst_rect->x : src_rect->x;
-    rect.y = (dst_rect->y < src_rect->y) ? dst_rect->y : src_rect->y;
-    rect.w = ((dst_rect->x + dst_rect->w) > (src_rect->x + src_rect->w)) ?
-        (dst_rect->x + dst_rect->w - rect.x) : (src_rect->x + src_rect->w - rect.x);
-    rect.h = ((dst_rect->y + dst_rect->h) > (src_rect->y + src_rect->h)) ?
-        (dst_rect->y + dst_rect->h - rect.y) : (src_rect->y + src_rect->h - rect.y);
-    ret = memcpy_s(dst_rect, sizeof(HIFB_RECT), &rect, sizeof(HIFB_RECT));
-    hifb_unequal_eok_return_void(ret);
-    return;
-}
-
-/* check these two rectangle cover each other */
-static hi_bool hifb_iscontain(HIFB_RECT parent_rect, HIFB_RECT child_rect)
-{
-    HIFB_POINT_S point;
-    point.s32XPos = child_rect.x;
-    point.s32YPos = child_rect.y;
-    if ((point.s32XPos < parent_rect.x) || (point.s32XPos > (parent_rect.x + parent_rect.w)) ||
-        (point.s32YPos < parent_rect.y) || (point.s32YPos > (parent_rect.y + parent_rect.h))) {
-        return HI_FALSE;
-    }
-    point.s32XPos = child_rect.x + child_rect.w;
-    point.s32YPos = child_rect.y + child_rect.h;
-    if ((point.s32XPos < parent_rect.x) || (point.s32XPos > (parent_rect.x + parent_rect.w)) ||
-        (point.s32YPos < parent_rect.y) || (point.s32YPos > (parent_rect.y + parent_rect.h))) {
-        return HI_FALSE;
-    }
-    return HI_TRUE;
-}
-
 static hi_s32 refresh_2buf_prepare_back_buf(struct fb_info *info, HIFB_BUFFER_S *back_buf, hi_u32 *bytes_per_pixel)
 {
     hifb_par *par = (hifb_par *)info->par;
@@ -4177,6 +4157,7 @@ static hi_s32 refresh_2buf_prepare_back_buf(struct fb_info *info, HIFB_BUFFER_S
     hi_u32 buf_size = ((hifb_get_line_length(info) * hifb_get_yres(info)) + HIFB_ALIGNMENT) & (~HIFB_ALIGNMENT);
     if (refresh_info->disp_buf_info.need_flip == HI_TRUE) {
         hifb_error("Layer(%d) refresh again before display another buf, maybe refresh too fast !\n", par->layer_id);
+        refresh_info->pacing[HIFB_LAYER_BUF_DOUBLE].drop_num++;
     }
 
     refresh_info->disp_buf_info.need_flip = HI_FALSE;
@@ -4302,20 +4283,15 @@ static hi_s32 refresh_2buf_blit(hifb_par *par, hi_u64 osd_buf_addr, HIFB_BUFFER_
     /* Foreground as a source points to the buf at work */
     hifb_get_workdispbuf(par, (hi_u64*)(&fore_buf.stCanvas.u64PhyAddr));
 
-    /* The union rect is also used as an update area for the foreground and background. */
-    ret = memcpy_s(&fore_buf.UpdateRect, sizeof(HIFB_RECT), &refresh_info->disp_buf_info.union_rect, sizeof(HIFB_RECT));
-    hifb_unequal_eok_return(ret);
-    ret = memcpy_s(&back_buf->UpdateRect, sizeof(HIFB_RECT), &fore_buf.UpdateRect, sizeof(HIFB_RECT));
-    hifb_unequal_eok_return(ret);
     (hi_void)memset_s(&tmp, sizeof(hifb_blit_opt), 0x0, sizeof(hifb_blit_opt));
-    /* blit with union rect */
+    /* sync the damaged areas the new refresh does not cover, as one job */
     if ((display_info->rotate_mode != HIFB_ROTATE_90) &&
         (display_info->rotate_mode != HIFB_ROTATE_270)) {
-        if (hifb_iscontain(*new_union_rect, refresh_info->disp_buf_info.union_rect) == HI_FALSE) {
-            if (hifb_drv_blit(&fore_buf, back_buf, &tmp, HI_TRUE, HI_NULL) < 0) {
-                hifb_error("blit err!\n");
-                return HI_FAILURE;
-            }
+        hifb_damage_exclude(&refresh_info->disp_buf_info.damage, new_union_rect);
+        if (hifb_drv_blit_rects(&fore_buf, back_buf, refresh_info->disp_buf_info.damage.rect,
+                                refresh_info->disp_buf_info.damage.num, &tmp) < 0) {
+            hifb_error("blit err!\n");
+            return HI_FAILURE;
         }
     } else {
         if (display_info->rotate_mode == HIFB_ROTATE_90) {
@@ -4331,8 +4307,8 @@ static hi_s32 refresh_2buf_blit(hifb_par *par, hi_u64 osd_buf_addr, HIFB_BUFFER_
         }
     }
 
-    /* clear union rect */
-    (hi_void)memset_s(&(refresh_info->disp_buf_info.union_rect), sizeof(HIFB_RECT), 0, sizeof(HIFB_RECT));
+    /* clear damage */
+    hifb_damage_clear(&refresh_info->disp_buf_info.damage);
 
     refresh_info->disp_buf_info.fliped = HI_FALSE;
     return HI_SUCCESS;
@@ -4405,13 +4381,7 @@ static hi_void refresh_2buf_prepare_compress(hifb_par *par, HIFB_BUFFER_S *back_
 
 static inline hi_void refresh_2buf_update_rect(hifb_refresh_info *refresh_info, HIFB_RECT *new_union_rect)
 {
-    hi_s32 ret;
-    if ((refresh_info->disp_buf_info.union_rect.w == 0) || (refresh_info->disp_buf_info.union_rect.h == 0)) {
-        ret = memcpy_s(&refresh_info->disp_buf_info.union_rect, sizeof(HIFB_RECT), new_union_rect, sizeof(HIFB_RECT));
-        hifb_unequal_eok_return_void(ret);
-    } else {
-        hifb_unite_rect(&refresh_info->disp_buf_info.union_rect, new_union_rect);
-    }
+    hifb_damage_add(&refresh_info->disp_buf_info.damage, new_union_rect);
 }
 
 /* This function has a lock operation, so you can't call it if the caller has a lock operation. */
@@ -4575,6 +4545,7 @@ static hi_s32 refresh_2buf_imediate_blit(hifb_par *par, HIFB_BUFFER_S *back_buf,
     HIFB_BUFFER_S fore_buf = {0};
     hifb_rotate_opt rot_tmp = {0};
     hifb_blit_opt tmp_opt = {0};
+    hifb_damage damage;
     unsigned long lock_flag;
     hi_s32 ret;
 
@@ -4582,20 +4553,16 @@ static hi_s32 refresh_2buf_imediate_blit(hifb_par *par, HIFB_BUFFER_S *back_buf,
     if (display_info->rotate_mode  != HIFB_ROTATE_90 && display_info->rotate_mode != HIFB_ROTATE_270) {
         /*
          * because reverse, the 2 buffer needed to sync contain,
-         * if the fresh area has cover last fresh area, then no need to sync
+         * the damaged areas the fresh area covers need no sync
          */
-        if (!hifb_iscontain(*new_union_rect, refresh_info->disp_buf_info.union_rect) &&
-            refresh_info->disp_buf_info.union_rect.w && refresh_info->disp_buf_info.union_rect.h) {
+        hifb_damage_exclude(&refresh_info->disp_buf_info.damage, new_union_rect);
+        if (refresh_info->disp_buf_info.damage.num != 0) {
             ret = memcpy_s(&fore_buf, sizeof(HIFB_BUFFER_S), back_buf, sizeof(HIFB_BUFFER_S));
             hifb_unlock_unequal_eok_return(ret, &par->lock, lock_flag);
             fore_buf.stCanvas.u64PhyAddr = refresh_info->disp_buf_info.phy_addr[index];
-            ret = memcpy_s(&fore_buf.UpdateRect, sizeof(HIFB_RECT), &refresh_info->disp_buf_info.union_rect,
-                sizeof(HIFB_RECT));
-            hifb_unlock_unequal_eok_return(ret, &par->lock, lock_flag);
-            ret = memcpy_s(&back_buf->UpdateRect, sizeof(HIFB_RECT), &fore_buf.UpdateRect, sizeof(HIFB_RECT));
-            hifb_unlock_unequal_eok_return(ret, &par->lock, lock_flag);
+            damage = refresh_info->disp_buf_info.damage;
             hifb_spin_unlock_irqrestore(&par->lock, lock_flag);
-            if (hifb_drv_blit(&fore_buf, back_buf, &tmp_opt, HI_TRUE, HI_NULL) < 0) {
+            if (hifb_drv_blit_rects(&fore_buf, back_buf, damage.rect, damage.num, &tmp_opt) < 0) {
                 return HI_FAILURE;
             }
             hifb_spin_lock_irqsave(&par->lock, lock_flag);
@@ -4604,11 +4571,6 @@ static hi_s32 refresh_2buf_imediate_blit(hifb_par *par, HIFB_BUFFER_S *back_buf,
         ret = memcpy_s(&fore_buf, sizeof(HIFB_BUFFER_S), back_buf, sizeof(HIFB_BUFFER_S));
         hifb_unlock_unequal_eok_return(ret, &par->lock, lock_flag);
         fore_buf.stCanvas.u64PhyAddr = refresh_info->disp_buf_info.phy_addr[index];
-        ret = memcpy_s(&fore_buf.UpdateRect, sizeof(HIFB_RECT), &refresh_info->disp_buf_info.union_rect,
-            sizeof(HIFB_RECT));
-        hifb_unlock_unequal_eok_return(ret, &par->lock, lock_flag);
-        ret = memcpy_s(&back_buf->UpdateRect, sizeof(HIFB_RECT), &fore_buf.UpdateRect, sizeof(HIFB_RECT));
-        hifb_unlock_unequal_eok_return(ret, &par->lock, lock_flag);
         rot_tmp.rotate_mode = (display_info->rotate_mode == HIFB_ROTATE_90) ? (HIFB_ROTATE_270) : (HIFB_ROTATE_90);
         refresh_2buf_blit_init_buf(display_info, &fore_buf, back_buf, bytes_per_pixel);
         if (hifb_drv_rotate(&fore_buf, back_buf, &rot_tmp, HI_TRUE) < 0) {
@@ -4778,8 +4740,8 @@ static hi_s32 hifb_refresh_2buf_immediate_display(hi_u32 layer_id, HIFB_BUFFER_S
 
     hifb_spin_lock_irqsave(&par->lock, lock_flag);
     /* record the fresh area */
-    ret = memcpy_s(&refresh_info->disp_buf_info.union_rect, sizeof(HIFB_RECT), &new_union_rect, sizeof(HIFB_RECT));
-    hifb_unlock_unequal_eok_return(ret, &par->lock, lock_flag);
+    hifb_damage_clear(&refresh_info->disp_buf_info.damage);
+    hifb_damage_add(&refresh_info->disp_buf_info.damage, &new_union_rect);
     /* prepare for opt */
     refresh_2buf_imediate_prepare_opt(par, canvas_buf, &back_buf, bytes_per_pixel, &blit_opt);
     hifb_spin_unlock_irqrestore(&par->lock, lock_flag);
@@ -4805,6 +4767,276 @@ static hi_s32 hifb_refresh_2buf_immediate_display(hi_u32 layer_id, HIFB_BUFFER_S
     return HI_SUCCESS;
 }
 
+static inline hi_u64 hifb_get_time_us(hi_void)
+{
+    return osal_div_u64(osal_sched_clock(), 1000); /* 1000 ns per us */
+}
+
+static hi_void hifb_pacing_refreshed(hifb_refresh_info *refresh_info, HIFB_LAYER_BUF_E buf_mode, hi_u64 start)
+{
+    hifb_pacing_stat *stat = HI_NULL;
+    hi_u64 block_time = hifb_get_time_us() - start;
+
+    if (buf_mode >= HIFB_LAYER_BUF_BUTT) {
+        return;
+    }
+    stat = &refresh_info->pacing[buf_mode];
+    stat->refresh_num++;
+    stat->block_time += block_time;
+    if (block_time > stat->block_time_max) {
+        stat->block_time_max = (hi_u32)block_time;
+    }
+}
+
+/* called in the VO interrupt when a new buf is set to the layer */
+static hi_void hifb_pacing_displayed(hifb_refresh_info *refresh_info)
+{
+    hifb_pacing_stat *stat = HI_NULL;
+    hi_u64 now = hifb_get_time_us();
+    hi_u64 interval;
+
+    if (refresh_info->buf_mode >= HIFB_LAYER_BUF_BUTT) {
+        return;
+    }
+    stat = &refresh_info->pacing[refresh_info->buf_mode];
+    stat->display_num++;
+    if ((refresh_info->last_display_time != 0) && (now > refresh_info->last_display_time)) {
+        interval = now - refresh_info->last_display_time;
+        stat->interval_sum += interval;
+        stat->interval_num++;
+        if ((stat->interval_min == 0) || (interval < stat->interval_min)) {
+            stat->interval_min = (hi_u32)interval;
+        }
+        if (interval > stat->interval_max) {
+            stat->interval_max = (hi_u32)interval;
+        }
+    }
+    refresh_info->last_display_time = now;
+}
+
+/* Forget the mailbox state: the buf on the screen is the newest, the others are all stale */
+static hi_void hifb_mailbox_reset(hifb_par *par)
+{
+    hifb_dispbuf_info *disp_buf_info = &par->refresh_info.disp_buf_info;
+    hifb_mailbox_info *mailbox = &disp_buf_info->mailbox;
+    HIFB_RECT full_rect = {0};
+    hi_u32 i;
+
+    if (disp_buf_info->index_for_int >= HIFB_DISP_BUF_NUM) {
+        disp_buf_info->index_for_int = 0;
+    }
+    mailbox->pending_index = HIFB_DISP_BUF_INVALID;
+    mailbox->render_index = HIFB_DISP_BUF_INVALID;
+    mailbox->retired_index = HIFB_DISP_BUF_INVALID;
+    mailbox->newest_index = disp_buf_info->index_for_int;
+    disp_buf_info->need_flip = HI_FALSE;
+    disp_buf_info->refresh_handle = 0;
+
+    full_rect.w = (hi_s32)par->display_info.display_width;
+    full_rect.h = (hi_s32)par->display_info.display_height;
+    for (i = 0; i < HIFB_DISP_BUF_NUM; i++) {
+        hifb_damage_clear(&mailbox->stale[i]);
+        if ((i != mailbox->newest_index) && (full_rect.w > 0) && (full_rect.h > 0)) {
+            hifb_damage_add(&mailbox->stale[i], &full_rect);
+        }
+    }
+}
+
+/* called in the TDE callback, with the lock held */
+static hi_void hifb_mailbox_tde_done(hifb_par *par, hi_s32 tde_finish_handle)
+{
+    hifb_refresh_info *refresh_info = &par->refresh_info;
+    hifb_mailbox_info *mailbox = &refresh_info->disp_buf_info.mailbox;
+
+    /* the buf was drawn again before this job finished, wait for the last job */
+    if ((refresh_info->disp_buf_info.refresh_handle != tde_finish_handle) ||
+        (mailbox->render_index == HIFB_DISP_BUF_INVALID)) {
+        return;
+    }
+    if (mailbox->pending_index != HIFB_DISP_BUF_INVALID) {
+        refresh_info->pacing[HIFB_LAYER_BUF_TRIPLE].drop_num++;
+    }
+    /* Notify VO, the newest finished buf replaces the one waiting for display */
+    mailbox->pending_index = mailbox->render_index;
+    mailbox->render_index = HIFB_DISP_BUF_INVALID;
+    refresh_info->disp_buf_info.need_flip = HI_TRUE;
+}
+
+/*
+ * Pick the buf to draw into, with the lock held. It is neither on the screen nor waiting for
+ * display, unless a buf is still being drawn, which is then drawn again.
+ */
+static hi_u32 refresh_3buf_get_target(hifb_par *par)
+{
+    hifb_refresh_info *refresh_info = &par->refresh_info;
+    hifb_mailbox_info *mailbox = &refresh_info->disp_buf_info.mailbox;
+    hi_u32 target = HIFB_DISP_BUF_INVALID;
+    hi_u32 i;
+
+    /* the callback of the job in flight must not mark the buf finished any more */
+    refresh_info->disp_buf_info.refresh_handle = 0;
+    if (mailbox->render_index != HIFB_DISP_BUF_INVALID) {
+        return mailbox->render_index;
+    }
+
+    for (i = 0; i < HIFB_DISP_BUF_NUM; i++) {
+        if ((i == refresh_info->disp_buf_info.index_for_int) || (i == mailbox->pending_index)) {
+            continue;
+        }
+        /* the buf taken off the screen at the vertical timing is read until the frame starts */
+        if ((i == mailbox->retired_index) && (refresh_info->do_refresh_job == HI_FALSE)) {
+            continue;
+        }
+        target = i;
+        break;
+    }
+
+    /*
+     * Only the retired buf is left: draw into the waiting buf instead of waiting for the frame
+     * start. It holds the newest content, and would be replaced by this frame anyway.
+     */
+    if (target == HIFB_DISP_BUF_INVALID) {
+        target = mailbox->pending_index;
+        mailbox->pending_index = HIFB_DISP_BUF_INVALID;
+        refresh_info->disp_buf_info.need_flip = HI_FALSE;
+        refresh_info->pacing[HIFB_LAYER_BUF_TRIPLE].drop_num++;
+    }
+    return target;
+}
+
+static hi_s32 refresh_3buf_prepare_back_buf(struct fb_info *info, HIFB_BUFFER_S *back_buf, hi_u32 *target)
+{
+    hifb_par *par = (hifb_par *)info->par;
+    hifb_refresh_info *refresh_info = &par->refresh_info;
+    hifb_display_info *display_info = &par->display_info;
+    unsigned long lock_flag;
+
+    if ((display_info->rotate_mode == HIFB_ROTATE_90) || (display_info->rotate_mode == HIFB_ROTATE_270)) {
+        hifb_error("Layer(%d) can't rotate 90 or 270 in HIFB_LAYER_BUF_TRIPLE mode!\n", par->layer_id);
+        return HI_FAILURE;
+    }
+
+    hifb_spin_lock_irqsave(&par->lock, lock_flag);
+    if (refresh_info->disp_buf_info.phy_addr[2] == refresh_info->disp_buf_info.phy_addr[1]) { /* 2 the 3rd buf */
+        hifb_spin_unlock_irqrestore(&par->lock, lock_flag);
+        hifb_error("Layer(%d) has no memory for 3 display buf!\n", par->layer_id);
+        return HI_FAILURE;
+    }
+    *target = refresh_3buf_get_target(par);
+    par->refresh_info.disp_buf_info.mailbox.render_index = *target;
+    back_buf->stCanvas.u64PhyAddr = refresh_info->disp_buf_info.phy_addr[*target];
+    hifb_spin_unlock_irqrestore(&par->lock, lock_flag);
+
+    back_buf->stCanvas.enFmt = par->color_format;
+    back_buf->stCanvas.u32Height = display_info->display_height;
+    back_buf->stCanvas.u32Width = display_info->display_width;
+    back_buf->stCanvas.u32Pitch = hifb_get_line_length(info);
+    return HI_SUCCESS;
+}
+
+/* bring the areas where the target buf is older than the newest buf up to date, except the fresh area */
+static hi_s32 refresh_3buf_sync(hifb_par *par, HIFB_BUFFER_S *back_buf, hi_u32 target, HIFB_RECT *new_union_rect)
+{
+    hifb_dispbuf_info *disp_buf_info = &par->refresh_info.disp_buf_info;
+    hifb_mailbox_info *mailbox = &disp_buf_info->mailbox;
+    HIFB_BUFFER_S fore_buf = {0};
+    hifb_blit_opt tmp_opt = {0};
+    hifb_damage damage;
+    unsigned long lock_flag;
+    hi_s32 ret;
+
+    hifb_spin_lock_irqsave(&par->lock, lock_flag);
+    hifb_damage_exclude(&mailbox->stale[target], new_union_rect);
+    if ((mailbox->stale[target].num == 0) || (mailbox->newest_index == target)) {
+        hifb_spin_unlock_irqrestore(&par->lock, lock_flag);
+        return HI_SUCCESS;
+    }
+    ret = memcpy_s(&fore_buf, sizeof(HIFB_BUFFER_S), back_buf, sizeof(HIFB_BUFFER_S));
+    hifb_unlock_unequal_eok_return(ret, &par->lock, lock_flag);
+    fore_buf.stCanvas.u64PhyAddr = disp_buf_info->phy_addr[mailbox->newest_index];
+    damage = mailbox->stale[target];
+    hifb_spin_unlock_irqrestore(&par->lock, lock_flag);
+
+    /* TDE runs the jobs in order, so the newest buf may still be in drawing */
+    if (hifb_drv_blit_rects(&fore_buf, back_buf, damage.rect, damage.num, &tmp_opt) < 0) {
+        hifb_error("blit err!\n");
+        return HI_FAILURE;
+    }
+    return HI_SUCCESS;
+}
+
+static hi_void refresh_3buf_update_stale(hifb_par *par, hi_u32 target, HIFB_RECT *new_union_rect)
+{
+    hifb_mailbox_info *mailbox = &par->refresh_info.disp_buf_info.mailbox;
+    unsigned long lock_flag;
+    hi_u32 i;
+
+    hifb_spin_lock_irqsave(&par->lock, lock_flag);
+    for (i = 0; i < HIFB_DISP_BUF_NUM; i++) {
+        if (i == target) {
+            hifb_damage_clear(&mailbox->stale[i]);
+        } else {
+            hifb_damage_add(&mailbox->stale[i], new_union_rect);
+        }
+    }
+    mailbox->newest_index = target;
+    hifb_spin_unlock_irqrestore(&par->lock, lock_flag);
+}
+
+/*
+ * Mailbox refresh: draw into a free buf and return without waiting for the display. The TDE
+ * callback makes the buf the one to show at the next vertical timing, replacing any buf that
+ * is still waiting, so the screen always gets the newest finished frame.
+ */
+static hi_s32 hifb_refresh_3buf(hi_u32 layer_id, HIFB_BUFFER_S *canvas_buf)
+{
+    struct fb_info *info = g_layer[layer_id].info;
+    hifb_par *par = (hifb_par *)info->par;
+    hifb_refresh_info *refresh_info = &par->refresh_info;
+    hifb_blit_opt blit_opt = {0};
+    HIFB_BUFFER_S back_buf = {0};
+    HIFB_RECT new_union_rect = {0};
+    unsigned long lock_flag;
+    hi_u32 bytes_per_pixel = 2; /* 2 byte */
+    hi_u32 target = 0;
+    hi_s32 ret;
+
+    if (refresh_3buf_prepare_back_buf(info, &back_buf, &target) != HI_SUCCESS) {
+        return HI_FAILURE;
+    }
+
+    /* according to the hw arithmetic, calculate source and dst fresh rectangle */
+    refresh_2buf_get_new_rect(canvas_buf, &back_buf, &new_union_rect, &blit_opt);
+
+    if (refresh_3buf_sync(par, &back_buf, target, &new_union_rect) != HI_SUCCESS) {
+        goto err;
+    }
+
+    refresh_2buf_prepare_opt(par, canvas_buf, &back_buf, bytes_per_pixel, &blit_opt);
+
+    /* blit with refresh rect */
+    ret = hifb_drv_blit(canvas_buf, &back_buf, &blit_opt, HI_TRUE, &refresh_info->disp_buf_info.refresh_handle);
+    if (ret < 0) {
+        hifb_error("blit err:0x%x!\n", ret);
+        goto err;
+    }
+    refresh_3buf_update_stale(par, target, &new_union_rect);
+
+    hifb_spin_lock_irqsave(&par->lock, lock_flag);
+    ret = memcpy_s(&(refresh_info->user_buffer), sizeof(HIFB_BUFFER_S), canvas_buf, sizeof(HIFB_BUFFER_S));
+    hifb_unlock_unequal_eok_return(ret, &par->lock, lock_flag);
+    hifb_spin_unlock_irqrestore(&par->lock, lock_flag);
+    return HI_SUCCESS;
+
+err:
+    hifb_spin_lock_irqsave(&par->lock, lock_flag);
+    if (refresh_info->disp_buf_info.mailbox.render_index == target) {
+        refresh_info->disp_buf_info.mailbox.render_index = HIFB_DISP_BUF_INVALID;
+    }
+    hifb_spin_unlock_irqrestore(&par->lock, lock_flag);
+    return HI_FAILURE;
+}
+
 static hi_void hifb_refresh_again(hi_u32 layer_id)
 {
     struct fb_info *info = g_layer[layer_id].info;
@@ -5750,6 +5982,8 @@ static hi_void tde_callback_without_rotate(hifb_par *par, HIFB_LAYER_BUF_E buf_m
         } else {
             hifb_error("Layer(%d) refresh again before tde callback, maybe refresh too fast !\n", par->layer_id);
         }
+    } else if (buf_mode == HIFB_LAYER_BUF_TRIPLE) {
+        hifb_mailbox_tde_done(par, tde_finish_handle);
     }
 
     if (par->compress_info.compress_open) {
@@ -5796,6 +6030,8 @@ static hi_void tde_callback_without_rotate(hifb_par *par, HIFB_LAYER_BUF_E buf_m
         } else {
             hifb_error("Layer(%d) refresh again before tde callback, maybe refresh too fast !\n", par->layer_id);
         }
+    } else if (buf_mode == HIFB_LAYER_BUF_TRIPLE) {
+        hifb_mailbox_tde_done(par, tde_finish_handle);
     }
 
     if (par->compress_info.compress_open) {
@@ -5981,7 +6217,25 @@ static hi_void hifb_set_bufmode(hi_u32 layer_id, HIFB_LAYER_BUF_E layer_buf_mode
         par->modifying = HI_FALSE;
     }
 
+    if (refresh_info->buf_mode != layer_buf_mode) {
+        refresh_info->last_display_time = 0;
+    }
+
+    /* the other modes only know 2 display buf, move the layer off the 3rd one */
+    if ((refresh_info->buf_mode == HIFB_LAYER_BUF_TRIPLE) && (layer_buf_mode != HIFB_LAYER_BUF_TRIPLE)) {
+        refresh_info->disp_buf_info.need_flip = HI_FALSE;
+        refresh_info->disp_buf_info.refresh_handle = 0;
+        if (refresh_info->disp_buf_info.index_for_int >= 2) { /* 2 only buf 0 and 1 are used */
+            refresh_info->disp_buf_info.index_for_int = 0;
+            refresh_info->screen_addr = refresh_info->disp_buf_info.phy_addr[0];
+            par->param_modify_mask |= HIFB_LAYER_PARAMODIFY_DISPLAYADDR;
+        }
+    }
+
     refresh_info->buf_mode = layer_buf_mode;
+    if (layer_buf_mode == HIFB_LAYER_BUF_TRIPLE) {
+        hifb_mailbox_reset(par);
+    }
 }
 
 /*
@@ -6462,11 +6716,6 @@ static hi_s32 hifb_cursor_changepos(hi_u32 cursor_id, HIFB_POINT_S pos)
         return HI_FAILURE;
     }
 
-    /* pos no change */
-    if ((pos.s32XPos == cursor_par->display_info.pos.s32XPos) &&
-        (pos.s32YPos == cursor_par->display_info.pos.s32YPos)) {
-        return HI_SUCCESS;
-    }
     hifb_get_maxscreensize(cursor_par, &max_screensize.width, &max_screensize.height);
     if (pos.x_pos > max_screensize.width - hifb_min_width(cursor_id)) {
         hifb_warnng("the sum of x_pos(%d) and min_width(%d) larger than Vodev screen width(%d)!\n",
@@ -6480,6 +6729,13 @@ static hi_s32 hifb_cursor_changepos(hi_u32 cursor_id, HIFB_POINT_S pos)
         pos.y_pos = max_screensize.height - hifb_min_height(cursor_id);
     }
 
+    /* pos no change, checked after clamping so a cursor pushed against the screen edge is not redrawn */
+    if ((pos.s32XPos == cursor_par->display_info.pos.s32XPos) &&
+        (pos.s32YPos == cursor_par->display_info.pos.s32YPos)) {
+        cursor_par->cursor_info.move_skip_cnt++;
+        return HI_SUCCESS;
+    }
+
     cursor_par->display_info.pos.s32XPos = pos.s32XPos;
     cursor_par->display_info.pos.s32YPos = pos.s32YPos;
 
@@ -6927,6 +7183,28 @@ static hi_void callback_set_fmt_and_stride(hifb_par *par, hi_u32 layer_id)
     return;
 }
 
+static hi_bool callback_get_flip_index(hifb_refresh_info *refresh_info, hi_u32 *index)
+{
+    hifb_mailbox_info *mailbox = &refresh_info->disp_buf_info.mailbox;
+
+    if (refresh_info->disp_buf_info.need_flip != HI_TRUE) {
+        return HI_FALSE;
+    }
+    if (refresh_info->buf_mode == HIFB_LAYER_BUF_DOUBLE) {
+        /* Work buf to change to free buf. Take free buf to display */
+        *index = 1 - *index;
+        return HI_TRUE;
+    }
+    if ((refresh_info->buf_mode == HIFB_LAYER_BUF_TRIPLE) && (mailbox->pending_index != HIFB_DISP_BUF_INVALID)) {
+        /* Take the waiting buf to display, the work buf is still read until the frame starts */
+        mailbox->retired_index = *index;
+        *index = mailbox->pending_index;
+        mailbox->pending_index = HIFB_DISP_BUF_INVALID;
+        return HI_TRUE;
+    }
+    return HI_FALSE;
+}
+
 static hi_void callback_update_refresh_info(hifb_par *par, hi_u32 layer_id)
 {
     hifb_refresh_info *refresh_info = HI_NULL;
@@ -6939,10 +7217,7 @@ static hi_void callback_update_refresh_info(hifb_par *par, hi_u32 layer_id)
     info = g_layer[layer_id].info;
     buf_size = ((hifb_get_line_length(info) * hifb_get_yres(info)) + HIFB_ALIGNMENT) & (~HIFB_ALIGNMENT);
     compress_info = &par->compress_info;
-    if ((refresh_info->buf_mode == HIFB_LAYER_BUF_DOUBLE) &&
-        (refresh_info->disp_buf_info.need_flip == HI_TRUE)) {
-        /* Work buf to change to free buf. Take free buf to display */
-        index = 1 - index;
+    if (callback_get_flip_index(refresh_info, &index) == HI_TRUE) {
         refresh_info->disp_buf_info.index_for_int = index;
         /*
          * The display address is set to the address of the free buf,
@@ -6974,6 +7249,7 @@ static hi_void callback_update_refresh_info(hifb_par *par, hi_u32 layer_id)
         refresh_info->disp_buf_info.fliped = HI_TRUE;
         refresh_info->disp_buf_info.need_flip = HI_FALSE;
         refresh_info->disp_buf_info.int_pic_num++;
+        hifb_pacing_displayed(refresh_info);
     }
     return;
 }
@@ -7023,12 +7299,19 @@ static hi_void callback_modify_address(hifb_par *par, hi_u32 layer_id)
 
     par->param_modify_mask &= ~HIFB_LAYER_PARAMODIFY_DISPLAYADDR;
     compress_info->layer_addr_update = HI_TRUE;
+    hifb_pacing_displayed(refresh_info);
 
     if ((refresh_info->disp_buf_info.phy_addr[0] != refresh_info->disp_buf_info.phy_addr[1]) &&
         (refresh_info->disp_buf_info.phy_addr[0])) {
         if (refresh_info->screen_addr >=  refresh_info->disp_buf_info.phy_addr[0] &&
             refresh_info->screen_addr < refresh_info->disp_buf_info.phy_addr[1]) {
             refresh_info->disp_buf_info.index_for_int = 0;
+        } else if ((refresh_info->buf_mode == HIFB_LAYER_BUF_TRIPLE) &&
+                   (refresh_info->disp_buf_info.phy_addr[2] != refresh_info->disp_buf_info.phy_addr[1]) &&
+                   (refresh_info->screen_addr >= refresh_info->disp_buf_info.phy_addr[2]) && /* 2 the 3rd buf */
+                   (refresh_info->screen_addr < (refresh_info->disp_buf_info.phy_addr[0] +
+                   hifb_get_smem_len(info)))) {
+            refresh_info->disp_buf_info.index_for_int = 2; /* 2 the 3rd buf */
         } else if ((refresh_info->screen_addr >= refresh_info->disp_buf_info.phy_addr[1]) &&
                    (refresh_info->screen_addr < (refresh_info->disp_buf_info.phy_addr[0] +
                    hifb_get_smem_len(info)))) {
@@ -7353,10 +7636,12 @@ static hi_s32 hifb_refresh(hi_u32 layer_id, HIFB_BUFFER_S *canvas_buf, HIFB_LAYE
     hi_s32 ret = HI_FAILURE;
     hifb_par *par = (hifb_par *)g_layer[layer_id].info->par;
     hi_bool is_overlay = HI_FALSE; /* is the cusor overlay with refresh area */
+    hi_u64 start;
 
     if (canvas_buf == HI_NULL) {
         return HI_FAILURE;
     }
+    start = hifb_get_time_us();
 
     /*
      * For cursor layer
@@ -7383,6 +7668,9 @@ static hi_s32 hifb_refresh(hi_u32 layer_id, HIFB_BUFFER_S *canvas_buf, HIFB_LAYE
         case HIFB_LAYER_BUF_DOUBLE_IMMEDIATE:
             ret = hifb_refresh_2buf_immediate_display(layer_id, canvas_buf);
             break;
+        case HIFB_LAYER_BUF_TRIPLE:
+            ret = hifb_refresh_3buf(layer_id, canvas_buf);
+            break;
         default:
             break;
     }
@@ -7391,6 +7679,7 @@ static hi_s32 hifb_refresh(hi_u32 layer_id, HIFB_BUFFER_S *canvas_buf, HIFB_LAYE
         hifb_cursor_show(layer_id);
     }
 #endif
+    hifb_pacing_refreshed(&par->refresh_info, buf_mode, start);
     return ret;
 }
 
@@ -7830,6 +8119,12 @@ static hi_s32 hifb_set_rotatemode(struct fb_info *info, HIFB_ROTATE_MODE_E rotat
         return -EINVAL;
     }
 
+    if ((buf_mode == HIFB_LAYER_BUF_TRIPLE) &&
+        ((rotate_mode == HIFB_ROTATE_90) || (rotate_mode == HIFB_ROTATE_270))) {
+        hifb_error("Can't rotate 90 or 270 in HIFB_LAYER_BUF_TRIPLE mode!\n");
+        return -EINVAL;
+    }
+
     if ((rotate_mode != HIFB_ROTATE_NONE) && (display_info->mirror_mode != HIFB_MIRROR_NONE)) {
         hifb_error("Can't do rotate when mirror!\n");
         return -EINVAL;
@@ -7858,9 +8153,10 @@ static hi_s32 hifb_check_layerinfo(HIFB_LAYER_INFO_S *layer_info)
     }
 
     if (layer_info->u32Mask & HIFB_LAYERMASK_BUFMODE) {
-        if (layer_info->BufMode > HIFB_LAYER_BUF_DOUBLE_IMMEDIATE) {
-            hifb_error("BufMode(%d) is error, should between %d and %d\n", layer_info->BufMode, HIFB_LAYER_BUF_DOUBLE,
-                       HIFB_LAYER_BUF_DOUBLE_IMMEDIATE);
+        if ((layer_info->BufMode > HIFB_LAYER_BUF_DOUBLE_IMMEDIATE) &&
+            (layer_info->BufMode != HIFB_LAYER_BUF_TRIPLE)) {
+            hifb_error("BufMode(%d) is error, should between %d and %d or be %d\n", layer_info->BufMode,
+                       HIFB_LAYER_BUF_DOUBLE, HIFB_LAYER_BUF_DOUBLE_IMMEDIATE, HIFB_LAYER_BUF_TRIPLE);
             return HI_FAILURE;
         }
     }
@@ -7995,6 +8291,8 @@ static hi_s32 onputlayerinfo_check_buf_mode(struct fb_info *info, hifb_par* par,
         } else if ((layer_info->BufMode == HIFB_LAYER_BUF_DOUBLE) ||
                    (layer_info->BufMode == HIFB_LAYER_BUF_DOUBLE_IMMEDIATE)) {
             layer_size = 2 * hifb_get_line_length(info) * hifb_get_yres(info); /* 2 length data */
+        } else if (layer_info->BufMode == HIFB_LAYER_BUF_TRIPLE) {
+            layer_size = HIFB_DISP_BUF_NUM * hifb_get_line_length(info) * hifb_get_yres(info);
         } else {
             layer_size = 0;
         }
@@ -8016,6 +8314,13 @@ static hi_s32 onputlayerinfo_check_buf_mode(struct fb_info *info, hifb_par* par,
                 return HI_FAILURE;
             }
         }
+
+        if ((layer_info->BufMode == HIFB_LAYER_BUF_TRIPLE) &&
+            ((par->display_info.rotate_mode == HIFB_ROTATE_90) ||
+            (par->display_info.rotate_mode == HIFB_ROTATE_270))) {
+            hifb_error("HIFB_LAYER_BUF_TRIPLE doesn't support rotate 90 or 270!\n");
+            return HI_FAILURE;
+        }
     }
 
     /* if x>width or y>height ,how to deal with: see nothing in screen or return failure. */
@@ -9039,6 +9344,7 @@ hi_s32 hifb_print_softcursor_proc(struct fb_info *info, osal_proc_entry_t *p, hi
     osal_seq_printf(p,  "Colorkey value             \t :0x%x\n", par->ckey.key);
     osal_seq_printf(p,  "cursor hot pos(x, y)       \t :(%d, %d)\n", par->cursor_info.cursor.stHotPos.s32XPos,
         par->cursor_info.cursor.stHotPos.s32YPos);
+    osal_seq_printf(p,  "moves skipped              \t :%u\n", par->cursor_info.move_skip_cnt);
     return 0;
 }
 
@@ -9083,18 +9389,41 @@ static hi_void print_canvas_proc(osal_proc_entry_t *p, hifb_par *par)
     return;
 }
 
+static hi_void print_pacing_proc(osal_proc_entry_t *p, hifb_refresh_info *refresh_info, const hi_char **buf_mode)
+{
+    hifb_pacing_stat *stat = HI_NULL;
+    hi_u32 i;
+
+    for (i = 0; i < HIFB_LAYER_BUF_BUTT; i++) {
+        stat = &refresh_info->pacing[i];
+        if ((stat->refresh_num == 0) && (stat->display_num == 0)) {
+            continue;
+        }
+        osal_seq_printf(p,  "pacing (%s)\n", buf_mode[i]);
+        osal_seq_printf(p,  "  refresh num, block avg/max \t :%u, %llu/%u us\n", stat->refresh_num,
+            (stat->refresh_num != 0) ? osal_div_u64(stat->block_time, stat->refresh_num) : 0, stat->block_time_max);
+        osal_seq_printf(p,  "  shown num, dropped num    \t :%u, %u\n", stat->display_num, stat->drop_num);
+        osal_seq_printf(p,  "  interval min/avg/max      \t :%u/%llu/%u us\n", stat->interval_min,
+            (stat->interval_num != 0) ? osal_div_u64(stat->interval_sum, stat->interval_num) : 0,
+            stat->interval_max);
+    }
+    return;
+}
+
 static hi_void print_display_proc(osal_proc_entry_t *p, hifb_par *par)
 {
     const hi_char *buf_mode[] = {
-        "triple", "double", "single", "triple( no frame discarded)", "fence", "unknown"
+        "triple", "double", "single", "triple( no frame discarded)", "fence", "quadruple(mailbox)", "unknown"
     };
     hifb_display_info *display_info = &par->display_info;
     hifb_refresh_info *refresh_info = &par->refresh_info;
+    HIFB_RECT union_rect;
 
     osal_seq_printf(p,  "Display Buffer mode(+UsrBuf)\t :%s\n", buf_mode[refresh_info->buf_mode]);
     osal_seq_printf(p,  "Displaying addr (register) \t :0x%llx\n", refresh_info->screen_addr);
     osal_seq_printf(p,  "g_display buffer[0] addr     \t :0x%llx\n", refresh_info->disp_buf_info.phy_addr[0]);
     osal_seq_printf(p,  "g_display buffer[1] addr     \t :0x%llx\n", refresh_info->disp_buf_info.phy_addr[1]);
+    osal_seq_printf(p,  "g_display buffer[2] addr     \t :0x%llx\n", refresh_info->disp_buf_info.phy_addr[2]);
     osal_seq_printf(p,  "Be PreMul Mode:            \t :%s\n", display_info->premul == HI_TRUE ? "YES" : "NO");
     osal_seq_printf(p,  "displayrect                \t :(%u, %u)\n", display_info->display_width,
         display_info->display_height);
@@ -9106,9 +9435,16 @@ static hi_void print_display_proc(osal_proc_entry_t *p, hifb_par *par)
     osal_seq_printf(p,  "BufferIndexDisplaying(2buf)\t :%u\n", refresh_info->disp_buf_info.index_for_int);
     osal_seq_printf(p,  "refresh request num(2buf)  \t :%u\n", refresh_info->refresh_num);
     osal_seq_printf(p,  "switch buf num(2buf)       \t :%u\n", refresh_info->disp_buf_info.int_pic_num);
+    hifb_damage_bound(&refresh_info->disp_buf_info.damage, &union_rect);
     osal_seq_printf(p,  "union rect (2buf)          \t :(%d,%d,%d,%d)\n",
-        refresh_info->disp_buf_info.union_rect.x, refresh_info->disp_buf_info.union_rect.y,
-        refresh_info->disp_buf_info.union_rect.w, refresh_info->disp_buf_info.union_rect.h);
+        union_rect.x, union_rect.y, union_rect.w, union_rect.h);
+    osal_seq_printf(p,  "damage rect num (2buf)     \t :%u\n", refresh_info->disp_buf_info.damage.num);
+    osal_seq_printf(p,  "pending/render index (3buf)\t :%d/%d\n",
+        (refresh_info->disp_buf_info.mailbox.pending_index == HIFB_DISP_BUF_INVALID) ? -1 :
+        (hi_s32)refresh_info->disp_buf_info.mailbox.pending_index,
+        (refresh_info->disp_buf_info.mailbox.render_index == HIFB_DISP_BUF_INVALID) ? -1 :
+        (hi_s32)refresh_info->disp_buf_info.mailbox.render_index);
+    print_pacing_proc(p, refresh_info, buf_mode);
     return;
 }
 
@@ -21,6 +21,7 @@
 
 #include "hifb_vou_drv.h"
 #include "drv_tde_type.h"
+#include "hifb_damage.h"
 
 /* define the value of default set of each layer */
 #define HIFB_4K_DEF_WIDTH 3840
@@ -108,18 +109,48 @@ typedef struct {
     HIFB_DYNAMIC_RANGE_E dynamic_range; /* which dynamic range */
 } hifb_display_info;
 
+#define HIFB_DISP_BUF_NUM 3
+#define HIFB_DISP_BUF_INVALID HIFB_DISP_BUF_NUM
+
+/*
+ * State of the triple buffer (mailbox) mode. At any time one buf is on the screen, at most one
+ * finished buf waits for the next vertical timing, and at most one buf is being drawn by TDE.
+ * A newly finished buf replaces the waiting one, so the refresh never blocks on the display.
+ */
+typedef struct {
+    hi_u32 pending_index;   /* finished buf to show at the next vertical timing */
+    hi_u32 render_index;    /* buf the TDE job in flight draws into */
+    hi_u32 newest_index;    /* buf holding the latest content */
+    hi_u32 retired_index;   /* buf taken off the screen, scanned out until the frame starts */
+    hifb_damage stale[HIFB_DISP_BUF_NUM]; /* areas where each buf is older than the newest one */
+} hifb_mailbox_info;
+
 typedef struct {
-    hi_u64 phy_addr[2]; /* 2 buf address */
+    hi_u64 phy_addr[HIFB_DISP_BUF_NUM]; /* display buf address, the 3rd one only used by 3 buf mode */
     hi_u32 stride;     /* buf stride */
     hi_bool need_flip;
     hi_bool fliped;
     hi_u32 index_for_int;
     hi_u32 int_pic_num;
-    HIFB_RECT union_rect;
+    hifb_damage damage;
+    hifb_mailbox_info mailbox;
     hi_s32 refresh_handle;
     hi_bool compress; /* Identifies whether the frame to be displayed is compressed */
 } hifb_dispbuf_info;
 
+/* frame pacing of one buffer mode, times in us */
+typedef struct {
+    hi_u32 refresh_num;    /* refresh requests */
+    hi_u32 display_num;    /* new bufs put on the screen */
+    hi_u32 drop_num;       /* finished frames replaced before they were shown */
+    hi_u64 block_time;     /* total time the caller spent in refresh */
+    hi_u32 block_time_max;
+    hi_u64 interval_sum;   /* time between two bufs put on the screen */
+    hi_u32 interval_num;
+    hi_u32 interval_min;
+    hi_u32 interval_max;
+} hifb_pacing_stat;
+
 typedef struct {
     HIFB_LAYER_BUF_E buf_mode; /* buffer mode */
     HIFB_BUFFER_S user_buffer;
@@ -128,6 +159,8 @@ typedef struct {
     hifb_dispbuf_info disp_buf_info;
     hi_u32 refresh_num; /* refresh request num in 2 buf mode */
     hi_bool do_refresh_job;
+    hifb_pacing_stat pacing[HIFB_LAYER_BUF_BUTT];
+    hi_u64 last_display_time; /* us, 0 when no buf was shown in the current mode */
 } hifb_refresh_info;
 
 typedef struct {
@@ -150,6 +183,9 @@ typedef struct {
     HIFB_POINT_S pos_in_cursor;
 
     hi_u32 attached_cursor_id;
+
+    /* cursor layer only: moves that landed on the current position and were not redrawn */
+    hi_u32 move_skip_cnt;
 } hifb_cursor_info;
 
 typedef struct {
@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host test of the HiFB refresh damage list (src/hifb_damage.c). It checks that:
+ * - contained rects are dropped, covering rects absorb the entries they cover,
+ *   and rects far apart are kept apart;
+ * - on random updates the list covers every damaged pixel of a pixel mask, never
+ *   outgrows HIFB_DAMAGE_MAX_RECT nor the bound of the updates, and excluding a
+ *   refreshed rect only drops what that rect redraws;
+ * - on UI-like traces the two buffer sync copies fewer pixels than the bounding
+ *   rect it replaced, and never more.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hifb_damage.h"
+
+#define HIFB_TEST_W       320
+#define HIFB_TEST_H       240
+#define HIFB_TEST_RUNS    2000
+#define HIFB_TEST_ADD_MAX 40
+#define HIFB_SCREEN_W     1920
+#define HIFB_SCREEN_H     1080
+
+static hi_u32 g_fail = 0;
+static hi_u8 g_mask[HIFB_TEST_H][HIFB_TEST_W];
+
+#define tool_check(cond, name) do { \
+    if (cond) { \
+        printf("ok   %s\n", name); \
+    } else { \
+        printf("FAIL %s (%s:%d)\n", name, __FILE__, __LINE__); \
+        g_fail++; \
+    } \
+} while (0)
+
+static HIFB_RECT hifb_test_rect(hi_s32 x, hi_s32 y, hi_s32 w, hi_s32 h)
+{
+    HIFB_RECT rect = { x, y, w, h };
+    return rect;
+}
+
+static hi_bool hifb_test_in(const HIFB_RECT *rect, hi_s32 x, hi_s32 y)
+{
+    return (x >= rect->x) && (x < rect->x + rect->w) && (y >= rect->y) && (y < rect->y + rect->h);
+}
+
+static hi_bool hifb_test_has(const hifb_damage *damage, const HIFB_RECT *rect)
+{
+    hi_u32 i;
+
+    for (i = 0; i < damage->num; i++) {
+        if (memcmp(&damage->rect[i], rect, sizeof(HIFB_RECT)) == 0) {
+            return HI_TRUE;
+        }
+    }
+    return HI_FALSE;
+}
+
+static hi_u64 hifb_test_pixels(const hifb_damage *damage)
+{
+    hi_u64 pixels = 0;
+    hi_u32 i;
+
+    for (i = 0; i < damage->num; i++) {
+        pixels += (hi_u64)damage->rect[i].w * (hi_u64)damage->rect[i].h;
+    }
+    return pixels;
+}
+
+static hi_void hifb_test_directed(hi_void)
+{
+    hifb_damage damage;
+    HIFB_RECT clock = hifb_test_rect(1800, 0, 120, 40);
+    HIFB_RECT icon = hifb_test_rect(0, 1040, 40, 40);
+    HIFB_RECT rect, bound;
+
+    hifb_damage_clear(&damage);
+    hifb_damage_add(&damage, &clock);
+    hifb_damage_add(&damage, &icon);
+    tool_check((damage.num == 2) && hifb_test_has(&damage, &clock) && hifb_test_has(&damage, &icon),
+        "opposite corners stay two rects");
+    hifb_damage_bound(&damage, &bound);
+    rect = hifb_test_rect(0, 0, 1920, 1080);
+    tool_check(memcmp(&bound, &rect, sizeof(HIFB_RECT)) == 0, "the bound spans both rects");
+
+    rect = hifb_test_rect(1810, 10, 20, 20);
+    hifb_damage_add(&damage, &rect);
+    tool_check(damage.num == 2, "a contained rect is dropped");
+
+    rect = hifb_test_rect(1700, 0, 220, 100);
+    hifb_damage_add(&damage, &rect);
+    tool_check((damage.num == 2) && hifb_test_has(&damage, &rect) && !hifb_test_has(&damage, &clock),
+        "a covering rect absorbs the entry");
+
+    hifb_damage_clear(&damage);
+    rect = hifb_test_rect(0, 0, 100, 50);
+    hifb_damage_add(&damage, &rect);
+    rect = hifb_test_rect(0, 50, 100, 50);
+    hifb_damage_add(&damage, &rect);
+    rect = hifb_test_rect(0, 0, 100, 100);
+    tool_check((damage.num == 1) && hifb_test_has(&damage, &rect), "adjacent halves merge");
+
+    rect = hifb_test_rect(500, 500, 0, 10);
+    hifb_damage_add(&damage, &rect);
+    tool_check(damage.num == 1, "an empty rect is ignored");
+
+    rect = hifb_test_rect(200, 0, 10, 10);
+    hifb_damage_add(&damage, &rect);
+    rect = hifb_test_rect(0, 0, 150, 150);
+    hifb_damage_exclude(&damage, &rect);
+    tool_check((damage.num == 1) && (damage.rect[0].x == 200), "exclude drops the covered entry only");
+    rect = hifb_test_rect(205, 0, 100, 100);
+    hifb_damage_exclude(&damage, &rect);
+    tool_check(damage.num == 1, "exclude keeps a partly covered entry");
+
+    hifb_damage_clear(&damage);
+    hifb_damage_bound(&damage, &bound);
+    tool_check((damage.num == 0) && (bound.w == 0) && (bound.h == 0), "clear empties the list");
+}
+
+static hi_u32 hifb_test_rand(hi_u32 *seed, hi_u32 n)
+{
+    *seed = *seed * 1103515245 + 12345; /* LCG */
+    return (*seed >> 16) % n;
+}
+
+static HIFB_RECT hifb_test_rand_rect(hi_u32 *seed)
+{
+    HIFB_RECT rect;
+
+    /* mostly small widgets, now and then a large panel */
+    hi_u32 max = (hifb_test_rand(seed, 8) == 0) ? HIFB_TEST_W / 2 : HIFB_TEST_W / 16;
+    rect.w = 1 + hifb_test_rand(seed, max);
+    rect.h = 1 + hifb_test_rand(seed, max);
+    rect.x = hifb_test_rand(seed, HIFB_TEST_W - rect.w + 1);
+    rect.y = hifb_test_rand(seed, HIFB_TEST_H - rect.h + 1);
+    return rect;
+}
+
+static hi_void hifb_test_mask(const HIFB_RECT *rect, hi_u8 value)
+{
+    hi_s32 x, y;
+
+    for (y = rect->y; y < rect->y + rect->h; y++) {
+        for (x = rect->x; x < rect->x + rect->w; x++) {
+            g_mask[y][x] = value;
+        }
+    }
+}
+
+static hi_bool hifb_test_covered(const hifb_damage *damage)
+{
+    hi_s32 x, y;
+    hi_u32 i;
+
+    for (y = 0; y < HIFB_TEST_H; y++) {
+        for (x = 0; x < HIFB_TEST_W; x++) {
+            if (g_mask[y][x] == 0) {
+                continue;
+            }
+            for (i = 0; (i < damage->num) && !hifb_test_in(&damage->rect[i], x, y); i++) {
+            }
+            if (i == damage->num) {
+                return HI_FALSE;
+            }
+        }
+    }
+    return HI_TRUE;
+}
+
+static hi_bool hifb_test_within(const hifb_damage *damage, const HIFB_RECT *bound)
+{
+    hi_u32 i;
+
+    for (i = 0; i < damage->num; i++) {
+        if ((damage->rect[i].x < bound->x) || (damage->rect[i].y < bound->y) ||
+            (damage->rect[i].x + damage->rect[i].w > bound->x + bound->w) ||
+            (damage->rect[i].y + damage->rect[i].h > bound->y + bound->h)) {
+            return HI_FALSE;
+        }
+    }
+    return HI_TRUE;
+}
+
+static hi_void hifb_test_random(hi_void)
+{
+    hifb_damage damage;
+    HIFB_RECT rect, bound;
+    hi_u32 seed = 0x4f1b;
+    hi_u32 bad_cover = 0;
+    hi_u32 bad_num = 0;
+    hi_u32 bad_bound = 0;
+    hi_u32 bad_exclude = 0;
+    hi_u32 run, n, i;
+
+    for (run = 0; run < HIFB_TEST_RUNS; run++) {
+        hifb_damage_clear(&damage);
+        (hi_void)memset(g_mask, 0, sizeof(g_mask));
+        n = 1 + hifb_test_rand(&seed, HIFB_TEST_ADD_MAX);
+        for (i = 0; i < n; i++) {
+            rect = hifb_test_rand_rect(&seed);
+            hifb_damage_add(&damage, &rect);
+            hifb_test_mask(&rect, 1);
+            bound = (i == 0) ? rect : bound;
+            if (i != 0) {
+                bound.w = ((bound.x + bound.w) > (rect.x + rect.w) ? (bound.x + bound.w) : (rect.x + rect.w));
+                bound.h = ((bound.y + bound.h) > (rect.y + rect.h) ? (bound.y + bound.h) : (rect.y + rect.h));
+                bound.x = (bound.x < rect.x) ? bound.x : rect.x;
+                bound.y = (bound.y < rect.y) ? bound.y : rect.y;
+                bound.w -= bound.x;
+                bound.h -= bound.y;
+            }
+            bad_num += (damage.num <= HIFB_DAMAGE_MAX_RECT) ? 0 : 1;
+            bad_bound += hifb_test_within(&damage, &bound) ? 0 : 1;
+        }
+        /* the runs are 1 to HIFB_TEST_ADD_MAX adds long, so checking the last state is enough */
+        bad_cover += hifb_test_covered(&damage) ? 0 : 1;
+        /* the refresh redraws rect, what is left outside it must still be synced */
+        rect = hifb_test_rand_rect(&seed);
+        n = damage.num;
+        hifb_damage_exclude(&damage, &rect);
+        hifb_test_mask(&rect, 0);
+        bad_exclude += hifb_test_covered(&damage) ? 0 : 1;
+        for (i = 0; i < damage.num; i++) {
+            bad_exclude += (hifb_test_in(&rect, damage.rect[i].x, damage.rect[i].y) &&
+                hifb_test_in(&rect, damage.rect[i].x + damage.rect[i].w - 1, damage.rect[i].y + damage.rect[i].h - 1)) ?
+                1 : 0;
+        }
+        bad_exclude += (damage.num <= n) ? 0 : 1;
+    }
+    tool_check(bad_cover == 0, "every damaged pixel is covered");
+    tool_check(bad_num == 0, "the list never outgrows HIFB_DAMAGE_MAX_RECT");
+    tool_check(bad_bound == 0, "the list never outgrows the bound of the updates");
+    tool_check(bad_exclude == 0, "exclude drops only the rects the refresh redraws");
+}
+
+typedef struct {
+    const char *name;
+    HIFB_RECT update[2]; /* 2: refreshes in a frame */
+    hi_u32 num;
+} hifb_test_trace;
+
+static hi_bool hifb_test_contain(const HIFB_RECT *parent, const HIFB_RECT *child)
+{
+    return (child->x >= parent->x) && (child->y >= parent->y) && (child->x + child->w <= parent->x + parent->w) &&
+        (child->y + child->h <= parent->y + parent->h);
+}
+
+/*
+ * Two buffer refresh, one flip a frame: the first refresh after the flip copies the
+ * damage the refresh does not redraw to the back buffer, then every refresh of the
+ * frame adds to the damage. The single bounding rect the list replaced is copied
+ * whole unless the refresh covers it.
+ */
+static hi_void hifb_test_traces(hi_void)
+{
+    static const hifb_test_trace traces[] = {
+        { "clock+icon", { { 1800, 0, 120, 40 }, { 0, 1040, 40, 40 } }, 2 },
+        { "toast+clock", { { 660, 900, 600, 80 }, { 1800, 0, 120, 40 } }, 2 },
+        { "cursor", { { 960, 540, 32, 32 } }, 1 },
+        { "list scroll", { { 200, 100, 800, 880 } }, 1 },
+    };
+    hifb_damage damage;
+    HIFB_RECT bound;
+    hi_u64 list_pixels, bound_pixels;
+    hi_u32 t, frame, i;
+    hi_bool fewer = HI_TRUE;
+    hi_bool never_more = HI_TRUE;
+
+    for (t = 0; t < sizeof(traces) / sizeof(traces[0]); t++) {
+        list_pixels = 0;
+        bound_pixels = 0;
+        hifb_damage_clear(&damage);
+        (hi_void)memset(&bound, 0, sizeof(bound));
+        for (frame = 0; frame < 60; frame++) { /* 60: one second of frames */
+            for (i = 0; i < traces[t].num; i++) {
+                if (i == 0) {
+                    hifb_damage_exclude(&damage, &traces[t].update[i]);
+                    list_pixels += hifb_test_pixels(&damage);
+                    hifb_damage_clear(&damage);
+                    bound_pixels += hifb_test_contain(&traces[t].update[i], &bound) ? 0 :
+                        (hi_u64)bound.w * (hi_u64)bound.h;
+                }
+                hifb_damage_add(&damage, &traces[t].update[i]);
+                hifb_damage_bound(&damage, &bound);
+            }
+        }
+        printf("     %-12s pixels copied a frame: bound %8llu, list %8llu\n", traces[t].name,
+            (unsigned long long)(bound_pixels / 60), (unsigned long long)(list_pixels / 60)); /* 60: frames */
+        never_more = never_more && (list_pixels <= bound_pixels);
+        fewer = fewer && ((traces[t].num == 1) || (list_pixels * 10 < bound_pixels)); /* 10: an order less */
+    }
+    tool_check(never_more, "the list never copies more than the bound");
+    tool_check(fewer, "updates far apart copy an order of magnitude less");
+}
+
+int main(hi_void)
+{
+    hifb_test_directed();
+    hifb_test_random();
+    hifb_test_traces();
+    if (g_fail != 0) {
+        printf("%u check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -177,6 +177,43 @@ typedef struct {
     hi_tde_rotate_angle rotate_angle;
 } tde_rotate_cmd;
 
+/* operation types of a command buffer submitted by TDE_SUBMIT_JOB */
+typedef enum {
+    DRV_TDE_JOB_OP_QUICK_COPY = 0,
+    DRV_TDE_JOB_OP_QUICK_FILL,
+    DRV_TDE_JOB_OP_QUICK_RESIZE,
+    DRV_TDE_JOB_OP_BIT_BLIT,
+    DRV_TDE_JOB_OP_SOLID_DRAW,
+    DRV_TDE_JOB_OP_ROTATE,
+    DRV_TDE_JOB_OP_BUTT
+} drv_tde_job_op_type;
+
+#define DRV_TDE_JOB_MAX_OP 256
+
+/* one operation of a command buffer, the handle of the embedded command is ignored */
+typedef struct {
+    hi_u32 type;     /* < drv_tde_job_op_type */
+    hi_u32 reserved;
+    union {
+        drv_tde_quick_copy_cmd copy_cmd;
+        drv_tde_quick_fill_cmd fill_cmd;
+        drv_tde_quick_resize_cmd resize_cmd;
+        drv_tde_bitblit_cmd blit_cmd;
+        drv_tde_solid_draw_cmd draw_cmd;
+        tde_rotate_cmd rotate_cmd;
+    } cmd;
+} drv_tde_job_op;
+
+/* command buffer: all operations are put into one job which is then ended as TDE_END_JOB does */
+typedef struct {
+    hi_u64 op_addr;  /* < user address of the drv_tde_job_op array */
+    hi_u32 op_num;   /* < operation number, at most DRV_TDE_JOB_MAX_OP */
+    hi_bool is_sync;  /* < weather sync */
+    hi_bool is_block; /* < weather block */
+    hi_u32 time_out;  /* < time out(ms) */
+    hi_s32 handle;    /* < output, TDE handle of the job */
+} drv_tde_submit_job_cmd;
+
 #define TDE_BEGIN_JOB _IOR(TDE_IOC_MAGIC, 1, hi_s32)
 #define TDE_BIT_BLIT _IOW(TDE_IOC_MAGIC, 2, drv_tde_bitblit_cmd)
 #define TDE_SOLID_DRAW _IOW(TDE_IOC_MAGIC, 3, drv_tde_solid_draw_cmd)
@@ -201,6 +238,7 @@ typedef struct {
 #define TDE_PATTERN_FILL _IOW(TDE_IOC_MAGIC, 23, drv_tde_pattern_fill_cmd)
 #define TDE_ENABLE_REGIONDEFLICKER _IOW(TDE_IOC_MAGIC, 24, hi_bool)
 #define TDE_ROTATE _IOW(TDE_IOC_MAGIC, 25, tde_rotate_cmd)
+#define TDE_SUBMIT_JOB _IOWR(TDE_IOC_MAGIC, 26, drv_tde_submit_job_cmd)
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -33,6 +33,7 @@
 #include "hi_math.h"
 #include "securec.h"
 #include "tde_adp.h"
+#include "tde_slice.h"
 #include "osal_list.h"
 
 /* TDE osi ctl macro definition */
@@ -171,6 +172,9 @@ typedef struct {
     hi_u32 slice_dst_hoffset;
     hi_u32 fmt;
 } tde_slice_data;
+
+/* enough TDE_MAX_SLICE_WIDTH slices to cover the widest rect */
+#define TDE_SLICE_PLAN_MAX_NUM (TDE_MAX_RECT_WIDTH_EX / TDE_MAX_SLICE_WIDTH)
 #endif
 
 /* pixel format transform type */
@@ -2101,6 +2105,7 @@ static hi_void tde_osi_finalize_slice_calculation(tde_slice_data *slice_data, td
 hi_s32 tde_osi_calc_slice(hi_s32 handle, tde_hw_node *node)
 {
     tde_slice_data slice_data = { 0 };
+    tde_slice_range slice[TDE_SLICE_PLAN_MAX_NUM];
     hi_u32 n;
     hi_u32 i;
     hi_s32 ret;
@@ -2112,8 +2117,11 @@ hi_s32 tde_osi_calc_slice(hi_s32 handle, tde_hw_node *node)
     slice_data.des_crop_en = node->des_alpha.bits.des_crop_en;
     slice_data.des_crop_start_x = node->des_crop_pos_st.bits.des_crop_start_x;
     slice_data.des_crop_end_x = node->des_crop_pos_ed.bits.des_crop_end_x;
-    /* 256 alg data */
-    slice_data.node_num = slice_data.des_width / 256 + ((slice_data.des_width % 256) != 0);
+    slice_data.node_num = tde_slice_plan(slice_data.des_width, TDE_MAX_SLICE_WIDTH, slice, TDE_SLICE_PLAN_MAX_NUM);
+    if (slice_data.node_num == 0) {
+        tde_error("can not cut width %u into at most %d slices!\n", slice_data.des_width, TDE_SLICE_PLAN_MAX_NUM);
+        return HI_ERR_TDE_UNSUPPORTED_OPERATION;
+    }
 
     for (n = 0; n < slice_data.node_num; n++) {
         tde_hw_node *child_node;
@@ -2131,9 +2139,8 @@ hi_s32 tde_osi_calc_slice(hi_s32 handle, tde_hw_node *node)
             return HI_ERR_TDE_INVALID_PARA;
         }
 
-        slice_data.des_xst_pos_blk = n * TDE_MAX_SLICE_WIDTH;
-        slice_data.des_xed_pos_blk = (((n + 1) * TDE_MAX_SLICE_WIDTH) <= slice_data.des_width) ? (
-            ((n + 1) * TDE_MAX_SLICE_WIDTH) - 1) : slice_data.des_width - 1;
+        slice_data.des_xst_pos_blk = slice[n].xst;
+        slice_data.des_xed_pos_blk = slice[n].xed;
 
         for (i = 0; i < 2; i++) { /* 2 alg data */
             tde_osi_init_slice_data(&slice_data, child_node, i);
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "tde_slice.h"
+
+hi_u32 tde_slice_plan(hi_u32 des_width, hi_u32 max_width, tde_slice_range *slice, hi_u32 max_num)
+{
+    hi_u32 num, width, pos;
+
+    if ((des_width == 0) || (max_width < TDE_SLICE_ALIGN)) {
+        return 0;
+    }
+    if (max_width < des_width) {
+        max_width &= ~(TDE_SLICE_ALIGN - 1);
+    }
+    num = (des_width + max_width - 1) / max_width;
+    width = (des_width + num - 1) / num;
+    if (num > 1) {
+        width = (width + TDE_SLICE_ALIGN - 1) & ~(TDE_SLICE_ALIGN - 1);
+    }
+
+    for (num = 0, pos = 0; pos < des_width; num++, pos += width) {
+        if (num >= max_num) {
+            return 0;
+        }
+        slice[num].xst = pos;
+        slice[num].xed = ((pos + width < des_width) ? (pos + width) : des_width) - 1;
+    }
+    return num;
+}
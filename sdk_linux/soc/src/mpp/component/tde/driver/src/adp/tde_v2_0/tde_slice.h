@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __TDE_SLICE_H__
+#define __TDE_SLICE_H__
+
+#include "hi_type.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif
+#endif
+
+#define TDE_SLICE_ALIGN 2 /* slices start on even columns so 422/420 chroma is never split */
+
+/* Output columns [xst, xed] of the destination covered by one slice node */
+typedef struct {
+    hi_u32 xst;
+    hi_u32 xed;
+} tde_slice_range;
+
+/*
+ * Cut des_width output columns into the fewest slices of at most max_width columns and
+ * spread the columns evenly, so no narrow tail node is left. Pure function, returns the
+ * number of slices written to slice, 0 when more than max_num would be needed.
+ */
+hi_u32 tde_slice_plan(hi_u32 des_width, hi_u32 max_width, tde_slice_range *slice, hi_u32 max_num);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif
+#endif /* __TDE_SLICE_H__ */
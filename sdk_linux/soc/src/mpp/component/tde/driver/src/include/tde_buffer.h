@@ -31,29 +31,96 @@ extern "C" {
 static hi_u32 g_tde_phy_buff = 0;
 static hi_u32 g_tde_buff_ref = 0;
 static hi_u32 g_tde_tmp_buf = 0;
+static hi_bool g_tde_tmp_buf_reserve = HI_FALSE; /* reserve the buffer at init, so that it can be got in interrupt */
+static hi_bool g_tde_buff_reserved = HI_FALSE;
+static hi_u32 g_tde_buff_ref_max = 0;
 
 hi_void tde_set_tde_tmp_buffer(hi_u32 tde_tmp_buf)
 {
     g_tde_tmp_buf = tde_tmp_buf;
 }
 
+hi_void tde_set_tde_tmp_buffer_reserve(hi_bool tmp_buf_reserve)
+{
+    g_tde_tmp_buf_reserve = tmp_buf_reserve;
+}
+
 #ifndef HI_BUILD_IN_BOOT
 static osal_spinlock_t g_tde_buff_lock;
 static unsigned long g_tde_buff_lock_flags;
 #endif
-static hi_u32 tde_alloc_physic_buff(hi_u32 cb_cr_offset)
-{
-    hi_u32 phy_addr;
-    hi_u32 csc_buffer_size;
 
+static hi_u32 tde_get_physic_buff_size(hi_void)
+{
 #ifdef CFG_HI_TDE_CSCTMPBUFFER_SIZE
-    csc_buffer_size = CFG_HI_TDE_CSCTMPBUFFER_SIZE;
+    return CFG_HI_TDE_CSCTMPBUFFER_SIZE;
 #elif defined(HI_BUILD_IN_BOOT)
-    csc_buffer_size = 0;
+    return 0;
 #else
-    csc_buffer_size = g_tde_tmp_buf;
+    return g_tde_tmp_buf;
 #endif
+}
+
+#ifndef HI_BUILD_IN_BOOT
+/* Called once at init, a failure only leaves the buffer to be allocated on demand */
+static hi_void tde_reserve_physic_buff(hi_void)
+{
+    hi_u32 phy_addr;
+    hi_u32 csc_buffer_size = tde_get_physic_buff_size();
+
+    if ((!g_tde_tmp_buf_reserve) || (csc_buffer_size == 0)) {
+        return;
+    }
+    tde_get_phyaddr_mmb("TDE_TEMP_BUFFER", csc_buffer_size, phy_addr);
+    if (phy_addr == 0) {
+        tde_warning("reserve tde temp buffer(0x%x) failed, alloc it on demand!\n", csc_buffer_size);
+        return;
+    }
+    g_tde_phy_buff = phy_addr;
+    g_tde_buff_ref = 0;
+    g_tde_buff_reserved = HI_TRUE;
+}
+
+static hi_void tde_unreserve_physic_buff(hi_void)
+{
+    if (!g_tde_buff_reserved) {
+        return;
+    }
+    tde_free_mmb(g_tde_phy_buff);
+    g_tde_phy_buff = 0;
+    g_tde_buff_ref = 0;
+    g_tde_buff_reserved = HI_FALSE;
+}
+#endif
+
+static hi_bool tde_physic_buff_reserved(hi_void)
+{
+    return g_tde_buff_reserved;
+}
+
+static hi_void tde_physic_buff_ref_inc(hi_void)
+{
+    g_tde_buff_ref++;
+    if (g_tde_buff_ref > g_tde_buff_ref_max) {
+        g_tde_buff_ref_max = g_tde_buff_ref;
+    }
+}
+
+static hi_u32 tde_alloc_physic_buff(hi_u32 cb_cr_offset)
+{
+    hi_u32 phy_addr;
+    hi_u32 csc_buffer_size = tde_get_physic_buff_size();
+
     tde_spin_lock(&g_tde_buff_lock, g_tde_buff_lock_flags);
+    if (g_tde_buff_reserved) {
+        if ((cb_cr_offset * 3) > csc_buffer_size) { /* 3 * size */
+            tde_spin_unlock(&g_tde_buff_lock, g_tde_buff_lock_flags);
+            return 0;
+        }
+        tde_physic_buff_ref_inc();
+        tde_spin_unlock(&g_tde_buff_lock, g_tde_buff_lock_flags);
+        return g_tde_phy_buff + cb_cr_offset;
+    }
     if (g_tde_phy_buff == 0) {
         if ((cb_cr_offset * 3) > csc_buffer_size) { /* 3 * size */
             tde_spin_unlock(&g_tde_buff_lock, g_tde_buff_lock_flags);
@@ -74,7 +141,7 @@ static hi_u32 tde_alloc_physic_buff(hi_u32 cb_cr_offset)
             g_tde_phy_buff = phy_addr;
             g_tde_buff_ref = 0;
         } else {
-            g_tde_buff_ref++;
+            tde_physic_buff_ref_inc();
             tde_spin_unlock(&g_tde_buff_lock, g_tde_buff_lock_flags);
 #ifndef HI_BUILD_IN_BOOT
             tde_free_mmb(phy_addr);
@@ -83,7 +150,7 @@ static hi_u32 tde_alloc_physic_buff(hi_u32 cb_cr_offset)
         }
     }
 
-    g_tde_buff_ref++;
+    tde_physic_buff_ref_inc();
     tde_spin_unlock(&g_tde_buff_lock, g_tde_buff_lock_flags);
 
     return g_tde_phy_buff + cb_cr_offset;
@@ -98,7 +165,8 @@ static hi_void tde_free_physic_buff(hi_void)
     }
 
     g_tde_buff_ref--;
-    if (g_tde_buff_ref == 0) {
+    /* a reserved buffer lives until the module is unloaded */
+    if ((g_tde_buff_ref == 0) && (!g_tde_buff_reserved)) {
 #ifndef HI_BUILD_IN_BOOT
         hi_u32 phy_buff = g_tde_phy_buff;
 #endif
@@ -42,7 +42,14 @@ typedef struct {
 
 hi_bool tde_initial_handle(hi_void);
 
-hi_void tde_get_handle(hi_handle_mgr *res, hi_s32 *handle);
+/*
+ * Function:      get_handle
+ * Description:   Allocate a job handle for res and add res to the global handle list
+ * Input:         res:job resource
+ * Output:        handle:job ID
+ * Return:        HI_FALSE when all handles are in use
+ */
+hi_bool tde_get_handle(hi_handle_mgr *res, hi_s32 *handle);
 
 /*
  * Function:      query_handle
@@ -70,6 +77,20 @@ hi_void tde_destroy_handle(hi_void);
 hi_handle_mgr *tde_get_handle_list(hi_void);
 
 #ifndef HI_BUILD_IN_BOOT
+typedef hi_bool (*tde_handle_match)(const hi_handle_mgr *res, const hi_void *arg);
+
+/*
+ * Function:      collect_handle
+ * Description:   Release the handle of every resource that match accepts and move the resource to out, in one
+ *                pass under the handle list lock. The resources themselves are left to the caller to free.
+ *                The handle list lock is the innermost TDE lock: it may be taken under the job list lock, and
+ *                match must not take any lock.
+ * Input:         match:filter called with the handle list lock held arg:argument of match
+ * Output:        out:list head the collected resources are added to
+ * Return:        number of resources collected
+ */
+hi_u32 tde_collect_handle(tde_handle_match match, const hi_void *arg, struct osal_list_head *out);
+
 /*
  * Function:      TdeFreePendingJob
  * Description:   Free the job which is not submitted  when execute Ctrl +C (kill the current process).
@@ -142,6 +142,14 @@ hi_u32 tde_osi_list_get_phy_buff(hi_u32 cb_cr_offset);
 
 hi_void tde_osi_list_put_phy_buff(hi_u32 buff_num);
 
+#if !defined(HI_BUILD_IN_BOOT) && defined(CONFIG_HI_PROC_SHOW_SUPPORT)
+/*
+ * Function:      tde_osi_list_print_buff_info
+ * Description:   Show the temp buffer and its deferred free queue in proc
+ */
+osal_proc_entry_t *tde_osi_list_print_buff_info(osal_proc_entry_t *page);
+#endif
+
 hi_void tde_osi_list_free_serial_cmd(tde_swnode *fst_cmd, tde_swnode *last_cmd);
 hi_s32 tde_osi_list_lock_working_flag(unsigned long *lock);
 
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __TDE_SW_H__
+#define __TDE_SW_H__
+
+#include "drv_tde_type.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+/*
+ * Software reference model of the TDE operations.
+ *
+ * The functions below take the same surface/rect/option structures as the
+ * hardware path and produce the same pixels (up to +-1 LSB of filter and blend
+ * rounding), so they can be used to check hardware output and as a CPU
+ * fallback for small jobs. The code only depends on drv_tde_type.h and
+ * securec, so it also builds outside the kernel.
+ *
+ * Supported formats: the packed RGB/ARGB formats from RGB444 to RABG8888
+ * and A8. CLUT, YCbCr and semi-planar formats return
+ * HI_ERR_TDE_UNSUPPORTED_OPERATION.
+ */
+
+/*
+ * Translate the physical address of a surface into a CPU address.
+ * The default translation treats phy_addr as a CPU address, which is what a
+ * host build wants; a kernel user maps the MMZ buffer and installs its own.
+ */
+typedef hi_u8 *(*tde_sw_map_func)(hi_u64 phy_addr, hi_u32 size);
+
+hi_void tde_sw_set_map_func(tde_sw_map_func func);
+
+hi_bool tde_sw_is_fmt_supported(hi_tde_color_fmt color_fmt);
+
+/* fill_data is a raw pixel value of the destination format, as for quick fill */
+hi_s32 tde_sw_quick_fill(const hi_tde_surface *dst, const hi_tde_rect *dst_rect, hi_u32 fill_data);
+
+/* Same size copy, converting the color format if src and dst differ */
+hi_s32 tde_sw_quick_copy(const hi_tde_surface *src, const hi_tde_rect *src_rect,
+                         const hi_tde_surface *dst, const hi_tde_rect *dst_rect);
+
+/* Bilinear scaling of src_rect onto dst_rect */
+hi_s32 tde_sw_quick_resize(const hi_tde_surface *src, const hi_tde_rect *src_rect,
+                           const hi_tde_surface *dst, const hi_tde_rect *dst_rect);
+
+/*
+ * Blit fore_ground over back_ground into dst with ROP, alpha blending,
+ * colorkey, clip and mirror from opt. back_ground may be NULL, in which case
+ * the destination pixels are used as background. Scaling, colorize and
+ * deflicker are not modelled.
+ */
+hi_s32 tde_sw_blit(const hi_tde_surface *back_ground, const hi_tde_rect *back_ground_rect,
+                   const hi_tde_surface *fore_ground, const hi_tde_rect *fore_ground_rect,
+                   const hi_tde_surface *dst, const hi_tde_rect *dst_rect, const hi_tde_opt *opt);
+
+/* Rotate src_rect into dst_rect; src and dst must share the color format */
+hi_s32 tde_sw_rotate(const hi_tde_surface *src, const hi_tde_rect *src_rect,
+                     const hi_tde_surface *dst, const hi_tde_rect *dst_rect, hi_tde_rotate_angle rotate_angle);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* __TDE_SW_H__ */
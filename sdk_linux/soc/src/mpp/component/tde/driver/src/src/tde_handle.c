@@ -26,9 +26,35 @@
 
 hi_handle_mgr *g_tde_handle_list = HI_NULL; /* Manager list of global handle */
 
-static hi_s32 g_handle = 1;
+/*
+ * A handle is (generation << TDE_HANDLE_INDEX_BITS) | index. The generation of a slot is bumped whenever
+ * the slot is released, so a stale handle never matches the job that reuses its slot.
+ */
+#define TDE_HANDLE_INDEX_BITS 12
+#define TDE_HANDLE_TABLE_SIZE (1 << TDE_HANDLE_INDEX_BITS)
+#define TDE_HANDLE_INDEX_MASK (TDE_HANDLE_TABLE_SIZE - 1)
+#define TDE_HANDLE_GEN_MAX ((hi_u32)TDE_MAX_HANDLE_VALUE >> TDE_HANDLE_INDEX_BITS)
+
+typedef struct {
+    volatile hi_s32 handle; /* 0 when the slot is free */
+    hi_handle_mgr *volatile res;
+    hi_u32 gen;
+} tde_handle_slot;
+
+typedef struct {
+    tde_handle_slot slot[TDE_HANDLE_TABLE_SIZE];
+    hi_u16 free_index[TDE_HANDLE_TABLE_SIZE]; /* stack of free slot index */
+    hi_u32 free_num;
+} tde_handle_table;
+
+static tde_handle_table *g_tde_handle_table = HI_NULL;
+
 #ifndef HI_BUILD_IN_BOOT
-static osal_spinlock_t g_handle_lock;
+#define tde_handle_wmb() osal_smp_wmb()
+#define tde_handle_rmb() osal_smp_rmb()
+#else
+#define tde_handle_wmb()
+#define tde_handle_rmb()
 #endif
 
 hi_handle_mgr *tde_get_handle_list(hi_void)
@@ -36,10 +62,32 @@ hi_handle_mgr *tde_get_handle_list(hi_void)
     return g_tde_handle_list;
 }
 
+static hi_void tde_init_handle_table(hi_void)
+{
+    hi_u32 i;
+
+    for (i = 0; i < TDE_HANDLE_TABLE_SIZE; i++) {
+        g_tde_handle_table->slot[i].handle = 0;
+        g_tde_handle_table->slot[i].res = HI_NULL;
+        g_tde_handle_table->slot[i].gen = 1;
+        /* pop the low index first */
+        g_tde_handle_table->free_index[i] = (hi_u16)(TDE_HANDLE_TABLE_SIZE - 1 - i);
+    }
+    g_tde_handle_table->free_num = TDE_HANDLE_TABLE_SIZE;
+}
+
 hi_bool tde_initial_handle(hi_void)
 {
     if (g_tde_handle_list == HI_NULL) {
 #ifndef HI_BUILD_IN_BOOT
+        g_tde_handle_table = (tde_handle_table *)osal_vmalloc(sizeof(tde_handle_table));
+#else
+        g_tde_handle_table = (tde_handle_table *)HI_GFX_LOGO_Malloc(sizeof(tde_handle_table), "tde handle table");
+#endif
+        if (g_tde_handle_table == HI_NULL) {
+            return HI_FALSE;
+        }
+#ifndef HI_BUILD_IN_BOOT
 
         g_tde_handle_list = (hi_handle_mgr *)osal_kmalloc(sizeof(hi_handle_mgr), osal_gfp_kernel);
 
@@ -47,6 +95,7 @@ hi_bool tde_initial_handle(hi_void)
         g_tde_handle_list = (hi_handle_mgr *)HI_GFX_LOGO_Malloc(sizeof(hi_handle_mgr), "tde handle");
 #endif
         if (g_tde_handle_list == HI_NULL) {
+            tde_destroy_handle();
             return HI_FALSE;
         }
 
@@ -54,70 +103,79 @@ hi_bool tde_initial_handle(hi_void)
         OSAL_INIT_LIST_HEAD(&g_tde_handle_list->header);
 #ifndef HI_BUILD_IN_BOOT
         osal_spin_lock_init(&g_tde_handle_list->lock);
-        osal_spin_lock_init(&g_handle_lock);
 #endif
     }
 
-    g_handle = 1;
+    tde_init_handle_table();
 
     return HI_TRUE;
 }
 
-hi_void tde_get_handle(hi_handle_mgr *res, hi_s32 *handle)
+hi_bool tde_get_handle(hi_handle_mgr *res, hi_s32 *handle)
 {
 #ifndef HI_BUILD_IN_BOOT
     unsigned long lockflags;
-    unsigned long handlockflags;
 #endif
+    tde_handle_slot *slot = HI_NULL;
+    hi_u32 index;
+
     if ((res == HI_NULL) || (handle == HI_NULL) || (g_tde_handle_list == HI_NULL)) {
-        return;
-    }
-    tde_spin_lock(&g_handle_lock, handlockflags);
-    /* Jump over unlawful handle */
-    if (g_handle == TDE_MAX_HANDLE_VALUE) {
-        g_handle = 1;
+        return HI_FALSE;
     }
-    res->handle = g_handle;
-    *handle = g_handle++;
-    tde_spin_unlock(&g_handle_lock, handlockflags);
     tde_spin_lock(&g_tde_handle_list->lock, lockflags);
+    if (g_tde_handle_table->free_num == 0) {
+        tde_spin_unlock(&g_tde_handle_list->lock, lockflags);
+        tde_error("too many tde jobs, max %d!\n", TDE_HANDLE_TABLE_SIZE);
+        return HI_FALSE;
+    }
+    index = g_tde_handle_table->free_index[--g_tde_handle_table->free_num];
+    slot = &g_tde_handle_table->slot[index];
+
+    res->handle = (hi_s32)((slot->gen << TDE_HANDLE_INDEX_BITS) | index);
+    *handle = res->handle;
+    /* the resource must be visible before the handle which readers match against */
+    slot->res = res;
+    tde_handle_wmb();
+    slot->handle = res->handle;
     osal_list_add_tail(&res->header, &g_tde_handle_list->header);
     tde_spin_unlock(&g_tde_handle_list->lock, lockflags);
+    return HI_TRUE;
 }
 
-/* To accelerate the speed of find, find form back to front */
+/* Lock free: the slot is read like a seqlock with the handle value as sequence */
 hi_bool tde_query_handle(hi_s32 handle, hi_handle_mgr **res)
 {
-#ifndef HI_BUILD_IN_BOOT
-    unsigned long lockflags;
-#endif
+    tde_handle_slot *slot = HI_NULL;
     hi_handle_mgr *hdl = HI_NULL;
-    if (res == HI_NULL) {
-        return HI_FAILURE;
-    }
-    if (g_tde_handle_list == HI_NULL) {
-        return HI_FAILURE;
+
+    if ((res == HI_NULL) || (g_tde_handle_list == HI_NULL) || (handle <= 0)) {
+        return HI_FALSE;
     }
-    tde_spin_lock(&g_tde_handle_list->lock, lockflags);
-    hdl = osal_list_entry(g_tde_handle_list->header.prev, hi_handle_mgr, header);
-    if (hdl == HI_NULL) {
-        tde_spin_unlock(&g_tde_handle_list->lock, lockflags);
+    slot = &g_tde_handle_table->slot[(hi_u32)handle & TDE_HANDLE_INDEX_MASK];
+    if (slot->handle != handle) {
         return HI_FALSE;
     }
-    while (hdl != g_tde_handle_list) {
-        if (hdl->handle == handle) {
-            *res = hdl;
-            tde_spin_unlock(&g_tde_handle_list->lock, lockflags);
-            return HI_TRUE;
-        }
-        hdl = osal_list_entry(hdl->header.prev, hi_handle_mgr, header);
-        if (hdl == HI_NULL) {
-            tde_spin_unlock(&g_tde_handle_list->lock, lockflags);
-            return HI_FALSE;
-        }
+    tde_handle_rmb();
+    hdl = slot->res;
+    tde_handle_rmb();
+    if ((hdl == HI_NULL) || (slot->handle != handle)) {
+        return HI_FALSE;
     }
-    tde_spin_unlock(&g_tde_handle_list->lock, lockflags);
-    return HI_FALSE;
+    *res = hdl;
+    return HI_TRUE;
+}
+
+/* called with the handle list lock held, after the resource left the handle list */
+static hi_void tde_put_handle_slot(hi_u32 index)
+{
+    tde_handle_slot *slot = &g_tde_handle_table->slot[index];
+
+    slot->handle = 0;
+    tde_handle_wmb();
+    slot->res = HI_NULL;
+    /* Jump over unlawful handle */
+    slot->gen = (slot->gen >= TDE_HANDLE_GEN_MAX) ? 1 : (slot->gen + 1);
+    g_tde_handle_table->free_index[g_tde_handle_table->free_num++] = (hi_u16)index;
 }
 
 hi_bool tde_release_handle(hi_s32 handle)
@@ -125,38 +183,64 @@ hi_bool tde_release_handle(hi_s32 handle)
 #ifndef HI_BUILD_IN_BOOT
     unsigned long lockflags;
 #endif
-    hi_handle_mgr *hdl = HI_NULL;
-    if (g_tde_handle_list == HI_NULL) {
-        return HI_FAILURE;
+    tde_handle_slot *slot = HI_NULL;
+    hi_u32 index;
+
+    if ((g_tde_handle_list == HI_NULL) || (handle <= 0)) {
+        return HI_FALSE;
     }
+    index = (hi_u32)handle & TDE_HANDLE_INDEX_MASK;
+    slot = &g_tde_handle_table->slot[index];
     tde_spin_lock(&g_tde_handle_list->lock, lockflags);
-    hdl = osal_list_entry(g_tde_handle_list->header.next, hi_handle_mgr, header);
-    if (hdl == HI_NULL) {
+    if (slot->handle != handle) {
         tde_spin_unlock(&g_tde_handle_list->lock, lockflags);
         return HI_FALSE;
     }
-    while (hdl != g_tde_handle_list) {
-        if (hdl->handle == handle) {
-            osal_list_del_init(&hdl->header);
-            tde_spin_unlock(&g_tde_handle_list->lock, lockflags);
-            return HI_TRUE;
-        }
-        hdl = osal_list_entry(hdl->header.next, hi_handle_mgr, header);
-        if (hdl == HI_NULL) {
-            tde_spin_unlock(&g_tde_handle_list->lock, lockflags);
-            return HI_FALSE;
+    osal_list_del_init(&slot->res->header);
+    tde_put_handle_slot(index);
+    tde_spin_unlock(&g_tde_handle_list->lock, lockflags);
+    return HI_TRUE;
+}
+
+#ifndef HI_BUILD_IN_BOOT
+hi_u32 tde_collect_handle(tde_handle_match match, const hi_void *arg, struct osal_list_head *out)
+{
+    unsigned long lockflags;
+    hi_handle_mgr *res = HI_NULL;
+    hi_handle_mgr *save = HI_NULL;
+    hi_u32 num = 0;
+
+    if ((match == HI_NULL) || (out == HI_NULL) || (g_tde_handle_list == HI_NULL)) {
+        return 0;
+    }
+    tde_spin_lock(&g_tde_handle_list->lock, lockflags);
+    osal_list_for_each_entry_safe(res, save, &g_tde_handle_list->header, header) {
+        if (!match(res, arg)) {
+            continue;
         }
+        osal_list_move_tail(&res->header, out);
+        tde_put_handle_slot((hi_u32)res->handle & TDE_HANDLE_INDEX_MASK);
+        num++;
     }
     tde_spin_unlock(&g_tde_handle_list->lock, lockflags);
-    return HI_FALSE;
+    return num;
 }
+#endif
 
 hi_void tde_destroy_handle(hi_void)
 {
+    if (g_tde_handle_table != HI_NULL) {
+#ifndef HI_BUILD_IN_BOOT
+        osal_vfree(g_tde_handle_table);
+#else
+        osal_kfree((HI_CHAR *)g_tde_handle_table);
+#endif
+        g_tde_handle_table = HI_NULL;
+    }
+
     /* Free head node, note: other nodes are all loaded, their resource  are responsibilited by its own module */
     if (g_tde_handle_list != HI_NULL) {
         osal_spin_lock_destroy(&g_tde_handle_list->lock);
-        osal_spin_lock_destroy(&g_handle_lock);
 #ifndef HI_BUILD_IN_BOOT
         osal_kfree(g_tde_handle_list);
 #else
@@ -32,14 +32,17 @@
 #include "tde_handle.h"
 #include "tde_adp.h"
 #include "hi_common.h"
+#include "hi_math.h"
 #include "hi_tde_ext.h"
 #include "drv_tde_ioctl.h"
 #include "tde_osictl_k.h"
 #include "tde_hal_k.h"
+#include "tde_job.h"
 #ifdef CONFIG_HI_PROC_SHOW_SUPPORT
 #include "tde_proc.h"
 #endif
 #define TDE_NAME "HI_TDE"
+#define TDE_JOB_OP_CHUNK 8 /* command buffer operations copied in at a time, 8 * 432 bytes fits a page */
 
 static osal_spinlock_t g_task_let_lock;
 
@@ -76,6 +79,7 @@ static hi_s32 tde_osr_get_alpha_threshold_state(unsigned long argp, hi_void *pri
 static hi_s32 tde_osr_pattern_fill(unsigned long argp, hi_void *private_data);
 static hi_s32 tde_osr_enable_region_deflicker(unsigned long argp, hi_void *private_data);
 static hi_s32 tde_osr_rotate(unsigned long argp, hi_void *private_data);
+static hi_s32 tde_osr_submit_job(unsigned long argp, hi_void *private_data);
 
 tde_ctl_func_dispatch_item g_tde_ctl_func_dispatch_item[] = {
     {0, HI_NULL},
@@ -104,7 +108,7 @@ tde_ctl_func_dispatch_item g_tde_ctl_func_dispatch_item[] = {
     {TDE_PATTERN_FILL, tde_osr_pattern_fill},
     {TDE_ENABLE_REGIONDEFLICKER, tde_osr_enable_region_deflicker},
     {TDE_ROTATE, tde_osr_rotate},
-    {0, HI_NULL},
+    {TDE_SUBMIT_JOB, tde_osr_submit_job},
     {0, HI_NULL}
 };
 
@@ -409,6 +413,7 @@ typedef union {
     drv_tde_bitmap_maskblend_cmd mask_blend_cmd;
     drv_tde_pattern_fill_cmd pattern_cmd;
     tde_rotate_cmd rotate_cmd;
+    drv_tde_submit_job_cmd submit_cmd;
 } tde_ioctl_cmd;
 
 long tde_ioctl(unsigned int cmd, unsigned long arg, hi_void *private_data)
@@ -889,6 +894,113 @@ static hi_s32 tde_osr_rotate(unsigned long argp, hi_void *private_data)
     return tde_osi_quick_rotate(rotate_cmd->handle, &single_src, rotate_cmd->rotate_angle);
 }
 
+/* every operation goes through the same tde_osr_* path as its single ioctl */
+static hi_s32 tde_job_exec_op(drv_tde_job_op *op, hi_s32 handle, hi_void *private_data)
+{
+    switch (op->type) {
+        case DRV_TDE_JOB_OP_QUICK_COPY:
+            op->cmd.copy_cmd.handle = handle;
+            return tde_osr_quick_copy((unsigned long)(uintptr_t)&op->cmd.copy_cmd, private_data);
+        case DRV_TDE_JOB_OP_QUICK_FILL:
+            op->cmd.fill_cmd.handle = handle;
+            return tde_osr_quick_fill((unsigned long)(uintptr_t)&op->cmd.fill_cmd, private_data);
+        case DRV_TDE_JOB_OP_QUICK_RESIZE:
+            op->cmd.resize_cmd.handle = handle;
+            return tde_osr_quick_resize((unsigned long)(uintptr_t)&op->cmd.resize_cmd, private_data);
+        case DRV_TDE_JOB_OP_BIT_BLIT:
+            op->cmd.blit_cmd.handle = handle;
+            return tde_osr_blit_blit((unsigned long)(uintptr_t)&op->cmd.blit_cmd, private_data);
+        case DRV_TDE_JOB_OP_SOLID_DRAW:
+            op->cmd.draw_cmd.handle = handle;
+            return tde_osr_solid_draw((unsigned long)(uintptr_t)&op->cmd.draw_cmd, private_data);
+        case DRV_TDE_JOB_OP_ROTATE:
+            op->cmd.rotate_cmd.handle = handle;
+            return tde_osr_rotate((unsigned long)(uintptr_t)&op->cmd.rotate_cmd, private_data);
+        default:
+            return HI_ERR_TDE_INVALID_PARA;
+    }
+}
+
+/*
+ * The command buffer is copied in and run TDE_JOB_OP_CHUNK operations at a time, so each
+ * submit needs one small kmalloc instead of a vmalloc of the whole DRV_TDE_JOB_MAX_OP array.
+ */
+static hi_s32 tde_job_exec_chunk(drv_tde_job_op *ops, hi_u32 first, hi_u32 num, hi_s32 handle,
+    hi_void *private_data)
+{
+    hi_u32 i;
+    hi_s32 ret;
+
+    for (i = 0; i < num; i++) {
+        if (!tde_job_check_op(&ops[i])) {
+            tde_error("invalid operation %u of command buffer, type %u!\n", first + i, ops[i].type);
+            return HI_ERR_TDE_INVALID_PARA;
+        }
+    }
+    for (i = 0; i < num; i++) {
+        ret = tde_job_exec_op(&ops[i], handle, private_data);
+        if (ret != HI_SUCCESS) {
+            tde_error("operation %u of command buffer failed, ret 0x%x!\n", first + i, ret);
+            return ret;
+        }
+    }
+    return HI_SUCCESS;
+}
+
+static hi_s32 tde_osr_submit_job(unsigned long argp, hi_void *private_data)
+{
+    drv_tde_submit_job_cmd *submit = HI_NULL;
+    drv_tde_job_op *ops = HI_NULL;
+    drv_tde_end_job_cmd end_job;
+    hi_u32 num;
+    hi_u32 i;
+    hi_s32 ret;
+
+    if (argp == 0) {
+        return -EFAULT;
+    }
+    submit = (drv_tde_submit_job_cmd *)(uintptr_t)argp;
+    if ((submit->op_addr == 0) || (submit->op_num == 0) || (submit->op_num > DRV_TDE_JOB_MAX_OP)) {
+        tde_error("invalid command buffer, op num %u!\n", submit->op_num);
+        return HI_ERR_TDE_INVALID_PARA;
+    }
+
+    ops = (drv_tde_job_op *)osal_kmalloc(MIN2(submit->op_num, TDE_JOB_OP_CHUNK) * sizeof(drv_tde_job_op),
+        osal_gfp_kernel);
+    if (ops == HI_NULL) {
+        return HI_ERR_TDE_NO_MEM;
+    }
+
+    ret = tde_osi_begin_job(&submit->handle, private_data);
+    if (ret != HI_SUCCESS) {
+        goto out;
+    }
+    /* a bad entry cancels the job, so a half built job is never submitted */
+    for (i = 0; i < submit->op_num; i += num) {
+        num = MIN2(submit->op_num - i, TDE_JOB_OP_CHUNK);
+        if (osal_copy_from_user(ops, (hi_void *)(uintptr_t)(submit->op_addr + i * sizeof(drv_tde_job_op)),
+            num * sizeof(drv_tde_job_op))) {
+            ret = -EFAULT;
+        } else {
+            ret = tde_job_exec_chunk(ops, i, num, submit->handle, private_data);
+        }
+        if (ret != HI_SUCCESS) {
+            (hi_void)tde_osi_cancel_job(submit->handle);
+            goto out;
+        }
+    }
+
+    end_job.handle = submit->handle;
+    end_job.is_sync = submit->is_sync;
+    end_job.is_block = submit->is_block;
+    end_job.time_out = submit->time_out;
+    ret = tde_osi_end_job(&end_job, HI_NULL, HI_NULL);
+
+out:
+    osal_kfree(ops);
+    return ret;
+}
+
 #ifdef TDE_COREDUMP_DEBUG
 #define tde_read_reg(base, offset) (*(volatile unsigned int *)((void *)(base) + (offset)))
 #endif
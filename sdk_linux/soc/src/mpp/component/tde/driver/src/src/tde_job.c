@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "tde_job.h"
+
+/* the cheap part of tde_osi_pre_check_surface, done before any node of a chunk is built */
+static hi_bool tde_job_check_surface(const drv_tde_ioctl_surface *surface, const hi_tde_rect *rect)
+{
+    hi_bool invalid = ((surface->phy_addr == 0) || (surface->stride == 0) ||
+        (surface->color_fmt >= HI_TDE_COLOR_FMT_MAX) || (rect->width == 0) || (rect->height == 0) ||
+        (rect->pos_x < 0) || ((hi_u32)rect->pos_x >= surface->width) ||
+        (rect->pos_y < 0) || ((hi_u32)rect->pos_y >= surface->height));
+
+    return !invalid;
+}
+
+static hi_bool tde_job_check_blit(const drv_tde_bitblit_cmd *blit)
+{
+    hi_u32 null_indicator = blit->null_indicator;
+
+    if (!tde_job_check_surface(&blit->dst_surface, &blit->dst_rect)) {
+        return HI_FALSE;
+    }
+    /* 1, 2 background surface and rect, 3, 4 foreground surface and rect */
+    if ((((null_indicator >> 1) & 1) == 0) && (((null_indicator >> 2) & 1) == 0) && /* 2 Take the high */
+        !tde_job_check_surface(&blit->back_ground_surface, &blit->back_ground_rect)) {
+        return HI_FALSE;
+    }
+    if ((((null_indicator >> 3) & 1) == 0) && (((null_indicator >> 4) & 1) == 0) && /* 3, 4 Take the high */
+        !tde_job_check_surface(&blit->fore_ground_surface, &blit->fore_ground_rect)) {
+        return HI_FALSE;
+    }
+    return HI_TRUE;
+}
+
+static hi_bool tde_job_check_solid_draw(const drv_tde_solid_draw_cmd *draw)
+{
+    hi_u32 null_indicator = draw->null_indicator;
+
+    if (!tde_job_check_surface(&draw->dst_surface, &draw->dst_rect)) {
+        return HI_FALSE;
+    }
+    if ((((null_indicator >> 1) & 1) == 0) && (((null_indicator >> 2) & 1) == 0) && /* 2 Take the high */
+        !tde_job_check_surface(&draw->fore_ground_surface, &draw->fore_ground_rect)) {
+        return HI_FALSE;
+    }
+    return HI_TRUE;
+}
+
+hi_bool tde_job_check_op(const drv_tde_job_op *op)
+{
+    const drv_tde_quick_copy_cmd *copy = &op->cmd.copy_cmd;
+    const drv_tde_quick_resize_cmd *resize = &op->cmd.resize_cmd;
+    const tde_rotate_cmd *rotate = &op->cmd.rotate_cmd;
+
+    switch (op->type) {
+        case DRV_TDE_JOB_OP_QUICK_COPY:
+            return tde_job_check_surface(&copy->src_surface, &copy->src_rect) &&
+                tde_job_check_surface(&copy->dst_surface, &copy->dst_rect);
+        case DRV_TDE_JOB_OP_QUICK_FILL:
+            return tde_job_check_surface(&op->cmd.fill_cmd.dst_surface, &op->cmd.fill_cmd.dst_rect);
+        case DRV_TDE_JOB_OP_QUICK_RESIZE:
+            return tde_job_check_surface(&resize->src_surface, &resize->src_rect) &&
+                tde_job_check_surface(&resize->dst_surface, &resize->dst_rect);
+        case DRV_TDE_JOB_OP_BIT_BLIT:
+            return tde_job_check_blit(&op->cmd.blit_cmd);
+        case DRV_TDE_JOB_OP_SOLID_DRAW:
+            return tde_job_check_solid_draw(&op->cmd.draw_cmd);
+        case DRV_TDE_JOB_OP_ROTATE:
+            return tde_job_check_surface(&rotate->src_surface, &rotate->src_rect) &&
+                tde_job_check_surface(&rotate->dst_surface, &rotate->dst_rect);
+        default:
+            return HI_FALSE;
+    }
+}
@@ -45,13 +45,18 @@ typedef struct {
 } tde_swjoblist;
 
 #ifndef HI_BUILD_IN_BOOT
-typedef hi_void (*TDE_WQ_CB)(hi_u32);
-
+/*
+ * Physical buffers put back in interrupt context are only counted here and released by one
+ * preallocated work, so the completion path neither allocates nor takes a lock.
+ */
 typedef struct {
-    hi_u32 count;
-    TDE_WQ_CB wqcb;
+    osal_atomic_t pending;      /* buffers waiting to be released */
     struct osal_work_struct work;
-} tdefreewq;
+    hi_u32 deferred;            /* buffers released through the work */
+    hi_u32 get_fail_in_irq;     /* buffer requests refused in interrupt, no buffer is reserved */
+} tde_buff_free_queue;
+
+static tde_buff_free_queue g_tde_buff_free_queue;
 
 static osal_wait_t g_tde_block_job_wq; /* wait queue used to block */
 #endif
@@ -111,6 +116,47 @@ static hi_void tde_osi_list_do_free_phy_buff(hi_u32 buff_num)
     return;
 }
 
+#ifndef HI_BUILD_IN_BOOT
+/* the work never runs concurrently with itself, so it is the only consumer of the pending count */
+static hi_void tde_osi_list_free_phy_buff_work(struct osal_work_struct *work)
+{
+    hi_unused(work);
+    while (osal_atomic_read(&g_tde_buff_free_queue.pending) > 0) {
+        (hi_void)osal_atomic_dec_return(&g_tde_buff_free_queue.pending);
+        tde_free_physic_buff();
+        g_tde_buff_free_queue.deferred++;
+    }
+}
+
+static hi_s32 tde_osi_list_buff_init(hi_void)
+{
+    if (osal_atomic_init(&g_tde_buff_free_queue.pending) != 0) {
+        return HI_FAILURE;
+    }
+    if (osal_init_work(&g_tde_buff_free_queue.work, tde_osi_list_free_phy_buff_work) != 0) {
+        osal_atomic_destroy(&g_tde_buff_free_queue.pending);
+        return HI_FAILURE;
+    }
+    g_tde_buff_free_queue.deferred = 0;
+    g_tde_buff_free_queue.get_fail_in_irq = 0;
+    osal_spin_lock_init(&g_tde_buff_lock);
+    tde_reserve_physic_buff();
+    return HI_SUCCESS;
+}
+
+static hi_void tde_osi_list_buff_term(hi_void)
+{
+    /* the work may still be queued or running, it must be done before it is freed */
+    (hi_void)osal_cancel_work_sync(&g_tde_buff_free_queue.work);
+    osal_destroy_work(&g_tde_buff_free_queue.work);
+    /* release what the work did not get to */
+    tde_osi_list_free_phy_buff_work(HI_NULL);
+    osal_atomic_destroy(&g_tde_buff_free_queue.pending);
+    tde_unreserve_physic_buff();
+    osal_spin_lock_destroy(&g_tde_buff_lock);
+}
+#endif
+
 hi_s32 tde_osi_list_init(hi_void)
 {
 #ifndef HI_BUILD_IN_BOOT
@@ -137,7 +183,14 @@ hi_s32 tde_osi_list_init(hi_void)
     OSAL_INIT_LIST_HEAD(&g_tde_osi_job_list->list);
 #ifndef HI_BUILD_IN_BOOT
     osal_spin_lock_init(&g_tde_osi_job_list->lock);
-    osal_spin_lock_init(&g_tde_buff_lock);
+    if (tde_osi_list_buff_init() != HI_SUCCESS) {
+        osal_spin_lock_destroy(&g_tde_osi_job_list->lock);
+        tde_free(g_tde_osi_job_list);
+        g_tde_osi_job_list = HI_NULL;
+        osal_wait_destroy(&g_tde_block_job_wq);
+        tde_destroy_handle();
+        return HI_FAILURE;
+    }
 
 #ifdef TDE_HWC_COOPERATE
     osal_spin_lock_init(&g_working_flag_lock);
@@ -200,7 +253,6 @@ hi_void tde_osi_list_term(hi_void)
 #ifndef HI_BUILD_IN_BOOT
     osal_wait_destroy(&g_tde_block_job_wq);
 #endif
-    osal_spin_lock_destroy(&g_tde_buff_lock);
 #ifdef TDE_HWC_COOPERATE
     osal_spin_lock_destroy(&g_working_flag_lock);
 #endif
@@ -213,6 +265,8 @@ hi_void tde_osi_list_term(hi_void)
         osal_list_del_init(&job->list);
         tde_osi_list_destroy_job(job);
     }
+    /* after the jobs, whose nodes may still hold the temp buffer */
+    tde_osi_list_buff_term();
     osal_spin_lock_destroy(&g_tde_osi_job_list->lock);
 
     tde_free(g_tde_osi_job_list);
@@ -297,20 +351,27 @@ hi_s32 tde_osi_list_begin_job(hi_s32 *handle, hi_void *private_data)
     }
     job = (tde_swjob *)((hi_u8 *)handle_mgr + sizeof(hi_handle_mgr));
     handle_mgr->res = (hi_void *)job;
-    tde_get_handle(handle_mgr, handle);
+    /* the handle list is walked by tde_free_pending_job of other processes, fill the job before it goes there */
 #ifndef HI_BUILD_IN_BOOT
     ret = osal_wait_init(&job->query);
     if (ret != 0) {
         tde_error("osal_wait_init Fail!\n");
-        tde_osi_list_release_handle(handle_mgr);
+        tde_free(handle_mgr);
         return HI_ERR_TDE_NO_MEM;
     }
 #endif
     OSAL_INIT_LIST_HEAD(&job->list);
-    job->handle = *handle;
     if (private_data != HI_NULL) {
         job->private_data = private_data;
     }
+    if (!tde_get_handle(handle_mgr, handle)) {
+#ifndef HI_BUILD_IN_BOOT
+        osal_wait_destroy(&job->query);
+#endif
+        tde_free(handle_mgr);
+        return HI_ERR_TDE_NO_MEM;
+    }
+    job->handle = *handle;
     return HI_SUCCESS;
 }
 
@@ -935,54 +996,59 @@ hi_void tde_osi_list_node_comp()
 hi_u32 tde_osi_list_get_phy_buff(hi_u32 cb_cr_offset)
 {
 #ifndef HI_BUILD_IN_BOOT
-    if (osal_in_interrupt()) {
+    /* an unreserved buffer may have to be allocated from MMZ, which sleeps */
+    if (osal_in_interrupt() && !tde_physic_buff_reserved()) {
+        g_tde_buff_free_queue.get_fail_in_irq++;
         return 0;
     }
 #endif
     return tde_alloc_physic_buff(cb_cr_offset);
 }
 
-#ifndef HI_BUILD_IN_BOOT
-void tde_osi_list_freevmem(struct osal_work_struct *work)
-{
-    tdefreewq *w_queue_info = osal_container_of(work, tdefreewq, work);
-    if (w_queue_info != HI_NULL) {
-        w_queue_info->wqcb(w_queue_info->count);
-        tde_free(w_queue_info);
-    }
-    return;
-}
-
-void tde_osi_list_hsr(hi_void *func, hi_u32 data)
+hi_void tde_osi_list_put_phy_buff(hi_u32 buff_num)
 {
-    tdefreewq *wq = HI_NULL;
-
-    wq = tde_malloc(sizeof(tdefreewq));
-    if (wq == HI_NULL) {
-        tde_error("Malloc TDEFREEWQ_S failed!\n");
-        return;
-    }
-    wq->count = data;
-    wq->wqcb = (TDE_WQ_CB)func;
-    OSAL_INIT_WORK(&wq->work, tde_osi_list_freevmem);
-    osal_schedule_work(&wq->work);
-    return;
-}
+#ifndef HI_BUILD_IN_BOOT
+    hi_u32 i;
 #endif
 
-hi_void tde_osi_list_put_phy_buff(hi_u32 buff_num)
-{
     if (buff_num == 0) {
         return;
     }
 #ifndef HI_BUILD_IN_BOOT
-    tde_osi_list_hsr((hi_void *)tde_osi_list_do_free_phy_buff, buff_num);
+    /*
+     * Dropping the last reference of an unreserved buffer frees MMZ, which may sleep, and nodes are
+     * freed in interrupt or under the job list lock.
+     */
+    if (tde_physic_buff_reserved()) {
+        tde_osi_list_do_free_phy_buff(buff_num);
+        return;
+    }
+    for (i = 0; i < buff_num; i++) {
+        (hi_void)osal_atomic_inc_return(&g_tde_buff_free_queue.pending);
+    }
+    (hi_void)osal_schedule_work(&g_tde_buff_free_queue.work);
 #else
     tde_osi_list_do_free_phy_buff(buff_num);
 #endif
     return;
 }
 
+#if !defined(HI_BUILD_IN_BOOT) && defined(CONFIG_HI_PROC_SHOW_SUPPORT)
+osal_proc_entry_t *tde_osi_list_print_buff_info(osal_proc_entry_t *page)
+{
+    if (page == HI_NULL) {
+        return HI_NULL;
+    }
+    osal_seq_printf(page, "--------- Hisilicon TDE Temp Buffer Info ---------\n");
+    osal_seq_printf(page, "     Size    Reserved   PhyAddr    Ref  MaxRef  Pending  Deferred  IrqFail\n");
+    osal_seq_printf(page, " %8u   %8s 0x%08x %6u  %6u  %7d  %8u  %7u\n", tde_get_physic_buff_size(),
+                    tde_physic_buff_reserved() ? "Y" : "N", g_tde_phy_buff, g_tde_buff_ref, g_tde_buff_ref_max,
+                    osal_atomic_read(&g_tde_buff_free_queue.pending), g_tde_buff_free_queue.deferred,
+                    g_tde_buff_free_queue.get_fail_in_irq);
+    return page;
+}
+#endif
+
 #ifdef TDE_HWC_COOPERATE
 hi_s32 tde_osi_list_lock_working_flag(unsigned long *lock)
 {
@@ -1015,58 +1081,55 @@ hi_s32 tde_osi_list_get_working_flag(hi_bool *flag)
 }
 #endif
 
+/* called with the job list lock and the handle list lock held, submitted only changes under the job list lock */
+static hi_bool tde_osi_list_is_pending(const hi_handle_mgr *handle, const hi_void *private_data)
+{
+    const tde_swjob *job = (const tde_swjob *)handle->res;
+
+    if (job == HI_NULL) {
+        tde_error("ERR:pstJob Null Pointer!!!\n");
+        return HI_FALSE;
+    }
+    /* free when it is not submitted */
+#ifndef __RTOS__
+    return (!job->submitted) && (private_data == job->private_data);
+#else
+    hi_unused(private_data);
+    return !job->submitted;
+#endif
+}
+
+/*
+ * Lock order is job list lock -> handle list lock, as in tde_osi_list_cancel_job; the handle list lock is never
+ * held while another lock is taken. The pending jobs leave the handle list under both locks, so no other path can
+ * find them any more, and their nodes are freed after both are dropped.
+ */
 hi_void tde_free_pending_job(hi_void *private_data)
 {
     hi_handle_mgr *handle = HI_NULL;
     hi_handle_mgr *save = HI_NULL;
     tde_swjob *job = HI_NULL;
     unsigned long lockflags;
-    hi_handle_mgr *tde_handle_list = tde_get_handle_list();
+    struct osal_list_head pending;
 
-    if (tde_handle_list == HI_NULL) {
-        return;
-    }
+    OSAL_INIT_LIST_HEAD(&pending);
     tde_spin_lock(&g_tde_osi_job_list->lock, lockflags);
-    handle = osal_list_entry(tde_handle_list->header.next, hi_handle_mgr, header);
-    if (handle == HI_NULL) {
-        tde_info("No pending job!!\n");
+    if (tde_collect_handle(tde_osi_list_is_pending, private_data, &pending) == 0) {
         tde_spin_unlock(&g_tde_osi_job_list->lock, lockflags);
+        tde_info("No pending job!!\n");
         return;
     }
-    while (handle != tde_handle_list) {
-        save = handle;
-        job = (tde_swjob *)save->res;
-        /* debug */
-        if (job == HI_NULL) {
-            tde_error("ERR:pstJob Null Pointer!!!\n");
-            tde_spin_unlock(&g_tde_osi_job_list->lock, lockflags);
-            return;
-        }
+    tde_spin_unlock(&g_tde_osi_job_list->lock, lockflags);
 
-        /* END */
-        handle = osal_list_entry(handle->header.next, hi_handle_mgr, header);
-        /* free when it is not submitted */
-#ifndef __RTOS__
-        if ((!job->submitted) && (private_data == job->private_data)) {
-#else
-        if (!job->submitted) {
-            hi_unused(private_data);
-#endif
-            /* free handle resource */
-            tde_osi_list_free_serial_cmd(job->first_cmd, job->tail_node);
+    osal_list_for_each_entry_safe(handle, save, &pending, header) {
+        job = (tde_swjob *)handle->res;
+        osal_list_del_init(&handle->header);
+        /* free handle resource */
+        tde_osi_list_free_serial_cmd(job->first_cmd, job->tail_node);
 #ifndef HI_BUILD_IN_BOOT
-            osal_wait_destroy(&job->query);
+        osal_wait_destroy(&job->query);
 #endif
-            osal_list_del_init(&save->header);
-            tde_free(save);
-        }
-
-        if (handle == HI_NULL) {
-            tde_error("ERR: pstHandle Null Pointer!!\n");
-            tde_spin_unlock(&g_tde_osi_job_list->lock, lockflags);
-            return;
-        }
+        tde_free(handle);
     }
-    tde_spin_unlock(&g_tde_osi_job_list->lock, lockflags);
     return;
 }
@@ -20,6 +20,7 @@
 #ifdef CONFIG_HI_PROC_SHOW_SUPPORT
 #include "tde_proc.h"
 #include "tde_hal.h"
+#include "tde_osilist.h"
 #endif
 #include "securec.h"
 
@@ -75,6 +76,7 @@ int tde_read_proc(osal_proc_entry_t *p)
         return HI_FAILURE;
     }
     p = wprintinfo(p);
+    p = tde_osi_list_print_buff_info(p);
 
     for (j = 0; j < g_tde_proc_info.cur_node; j++) {
         cur = (hi_u32 *)&hw_node[j];
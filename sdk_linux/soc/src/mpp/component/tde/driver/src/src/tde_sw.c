@@ -0,0 +1,809 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "tde_sw.h"
+#include "securec.h"
+
+#define TDE_SW_CHN_MAX 0xff
+#define TDE_SW_CHN_BITS 8
+#define TDE_SW_BYTE_BITS 8
+#define TDE_SW_ALPHA_128 128
+#define TDE_SW_FIX_SHIFT 16               /* 16.16 fixed point sample positions when scaling */
+#define TDE_SW_FIX_HALF (1 << (TDE_SW_FIX_SHIFT - 1))
+#define TDE_SW_WEIGHT_SHIFT 8             /* 8-bit bilinear weights */
+#define TDE_SW_WEIGHT_ONE (1 << TDE_SW_WEIGHT_SHIFT)
+#define TDE_SW_TILE 16                    /* rotate 16x16 tiles so both sides stay in cache */
+#define TDE_SW_LANE_MASK 0x00ff00ffU      /* two 8-bit channels in 16-bit lanes of a word */
+#define TDE_SW_LANE_HALF 0x00800080U
+
+typedef struct {
+    hi_u8 bytes;
+    hi_u8 a_shift;
+    hi_u8 a_len;
+    hi_u8 r_shift;
+    hi_u8 r_len;
+    hi_u8 g_shift;
+    hi_u8 g_len;
+    hi_u8 b_shift;
+    hi_u8 b_len;
+} tde_sw_fmt_info;
+
+/* Pixel layout inside a little-endian word; bytes == 0 means the format is not modelled */
+static const tde_sw_fmt_info g_tde_sw_fmt[HI_TDE_COLOR_FMT_MAX] = {
+    [HI_TDE_COLOR_FMT_RGB444] = { 2, 0, 0, 8, 4, 4, 4, 0, 4 },  /* 2: bytes per pixel */
+    [HI_TDE_COLOR_FMT_BGR444] = { 2, 0, 0, 0, 4, 4, 4, 8, 4 },
+    [HI_TDE_COLOR_FMT_RGB555] = { 2, 0, 0, 10, 5, 5, 5, 0, 5 },
+    [HI_TDE_COLOR_FMT_BGR555] = { 2, 0, 0, 0, 5, 5, 5, 10, 5 },
+    [HI_TDE_COLOR_FMT_RGB565] = { 2, 0, 0, 11, 5, 5, 6, 0, 5 },
+    [HI_TDE_COLOR_FMT_BGR565] = { 2, 0, 0, 0, 5, 5, 6, 11, 5 },
+    [HI_TDE_COLOR_FMT_RGB888] = { 3, 0, 0, 16, 8, 8, 8, 0, 8 }, /* 3: bytes per pixel */
+    [HI_TDE_COLOR_FMT_BGR888] = { 3, 0, 0, 0, 8, 8, 8, 16, 8 },
+    [HI_TDE_COLOR_FMT_ARGB4444] = { 2, 12, 4, 8, 4, 4, 4, 0, 4 },
+    [HI_TDE_COLOR_FMT_ABGR4444] = { 2, 12, 4, 0, 4, 4, 4, 8, 4 },
+    [HI_TDE_COLOR_FMT_RGBA4444] = { 2, 0, 4, 12, 4, 8, 4, 4, 4 },
+    [HI_TDE_COLOR_FMT_BGRA4444] = { 2, 0, 4, 4, 4, 8, 4, 12, 4 },
+    [HI_TDE_COLOR_FMT_ARGB1555] = { 2, 15, 1, 10, 5, 5, 5, 0, 5 },
+    [HI_TDE_COLOR_FMT_ABGR1555] = { 2, 15, 1, 0, 5, 5, 5, 10, 5 },
+    [HI_TDE_COLOR_FMT_RGBA1555] = { 2, 0, 1, 11, 5, 6, 5, 1, 5 },
+    [HI_TDE_COLOR_FMT_BGRA1555] = { 2, 0, 1, 1, 5, 6, 5, 11, 5 },
+    [HI_TDE_COLOR_FMT_ARGB8565] = { 3, 16, 8, 11, 5, 5, 6, 0, 5 },
+    [HI_TDE_COLOR_FMT_ABGR8565] = { 3, 16, 8, 0, 5, 5, 6, 11, 5 },
+    [HI_TDE_COLOR_FMT_RGBA8565] = { 3, 0, 8, 19, 5, 13, 6, 8, 5 },
+    [HI_TDE_COLOR_FMT_BGRA8565] = { 3, 0, 8, 8, 5, 13, 6, 19, 5 },
+    [HI_TDE_COLOR_FMT_ARGB8888] = { 4, 24, 8, 16, 8, 8, 8, 0, 8 }, /* 4: bytes per pixel */
+    [HI_TDE_COLOR_FMT_ABGR8888] = { 4, 24, 8, 0, 8, 8, 8, 16, 8 },
+    [HI_TDE_COLOR_FMT_RGBA8888] = { 4, 0, 8, 24, 8, 16, 8, 8, 8 },
+    [HI_TDE_COLOR_FMT_BGRA8888] = { 4, 0, 8, 8, 8, 16, 8, 24, 8 },
+    [HI_TDE_COLOR_FMT_RABG8888] = { 4, 16, 8, 24, 8, 0, 8, 8, 8 },
+    [HI_TDE_COLOR_FMT_A8] = { 1, 0, 8, 0, 0, 0, 0, 0, 0 },
+};
+
+typedef struct {
+    hi_u32 a;
+    hi_u32 r;
+    hi_u32 g;
+    hi_u32 b;
+} tde_sw_color;
+
+typedef struct {
+    const hi_tde_surface *surface;
+    const tde_sw_fmt_info *fmt;
+    hi_u8 *base; /* first pixel of the operating rect */
+    hi_u32 stride;
+    hi_u32 width;
+    hi_u32 height;
+} tde_sw_plane;
+
+/* {src2 factor, src1 factor} of each fixed blend command, applied to premultiplied colors */
+static const hi_u8 g_tde_sw_blend_factor[HI_TDE_BLEND_CMD_CONFIG][2] = { /* 2: src2 and src1 */
+    [HI_TDE_BLEND_CMD_NONE] = { HI_TDE_BLEND_ONE, HI_TDE_BLEND_INVSRC2ALPHA },
+    [HI_TDE_BLEND_CMD_CLEAR] = { HI_TDE_BLEND_ZERO, HI_TDE_BLEND_ZERO },
+    [HI_TDE_BLEND_CMD_SRC] = { HI_TDE_BLEND_ONE, HI_TDE_BLEND_ZERO },
+    [HI_TDE_BLEND_CMD_SRCOVER] = { HI_TDE_BLEND_ONE, HI_TDE_BLEND_INVSRC2ALPHA },
+    [HI_TDE_BLEND_CMD_DSTOVER] = { HI_TDE_BLEND_INVSRC1ALPHA, HI_TDE_BLEND_ONE },
+    [HI_TDE_BLEND_CMD_SRCIN] = { HI_TDE_BLEND_SRC1ALPHA, HI_TDE_BLEND_ZERO },
+    [HI_TDE_BLEND_CMD_DSTIN] = { HI_TDE_BLEND_ZERO, HI_TDE_BLEND_SRC2ALPHA },
+    [HI_TDE_BLEND_CMD_SRCOUT] = { HI_TDE_BLEND_INVSRC1ALPHA, HI_TDE_BLEND_ZERO },
+    [HI_TDE_BLEND_CMD_DSTOUT] = { HI_TDE_BLEND_ZERO, HI_TDE_BLEND_INVSRC2ALPHA },
+    [HI_TDE_BLEND_CMD_SRCATOP] = { HI_TDE_BLEND_SRC1ALPHA, HI_TDE_BLEND_INVSRC2ALPHA },
+    [HI_TDE_BLEND_CMD_DSTATOP] = { HI_TDE_BLEND_INVSRC1ALPHA, HI_TDE_BLEND_SRC2ALPHA },
+    [HI_TDE_BLEND_CMD_ADD] = { HI_TDE_BLEND_ONE, HI_TDE_BLEND_ONE },
+    [HI_TDE_BLEND_CMD_XOR] = { HI_TDE_BLEND_INVSRC1ALPHA, HI_TDE_BLEND_INVSRC2ALPHA },
+    [HI_TDE_BLEND_CMD_DST] = { HI_TDE_BLEND_ZERO, HI_TDE_BLEND_ONE },
+};
+
+static hi_u8 *tde_sw_default_map(hi_u64 phy_addr, hi_u32 size)
+{
+    (hi_void)size;
+    return (hi_u8 *)(hi_uintptr_t)phy_addr;
+}
+
+static tde_sw_map_func g_tde_sw_map = tde_sw_default_map;
+
+hi_void tde_sw_set_map_func(tde_sw_map_func func)
+{
+    g_tde_sw_map = (func != HI_NULL) ? func : tde_sw_default_map;
+}
+
+hi_bool tde_sw_is_fmt_supported(hi_tde_color_fmt color_fmt)
+{
+    if ((color_fmt < HI_TDE_COLOR_FMT_RGB444) || (color_fmt >= HI_TDE_COLOR_FMT_MAX)) {
+        return HI_FALSE;
+    }
+    return (g_tde_sw_fmt[color_fmt].bytes != 0) ? HI_TRUE : HI_FALSE;
+}
+
+static hi_s32 tde_sw_plane_init(const hi_tde_surface *surface, const hi_tde_rect *rect, tde_sw_plane *plane)
+{
+    const tde_sw_fmt_info *fmt = HI_NULL;
+    hi_u64 size;
+    hi_u8 *vir_addr = HI_NULL;
+
+    if ((surface == HI_NULL) || (rect == HI_NULL)) {
+        return HI_ERR_TDE_NULL_PTR;
+    }
+    if (!tde_sw_is_fmt_supported(surface->color_fmt)) {
+        return HI_ERR_TDE_UNSUPPORTED_OPERATION;
+    }
+    fmt = &g_tde_sw_fmt[surface->color_fmt];
+
+    if ((rect->pos_x < 0) || (rect->pos_y < 0) || (rect->width == 0) || (rect->height == 0) ||
+        ((hi_u32)rect->pos_x >= surface->width) || ((hi_u32)rect->pos_y >= surface->height) ||
+        (rect->width > surface->width - (hi_u32)rect->pos_x) ||
+        (rect->height > surface->height - (hi_u32)rect->pos_y)) {
+        return HI_ERR_TDE_INVALID_PARA;
+    }
+    if ((hi_u64)surface->stride < (hi_u64)surface->width * fmt->bytes) {
+        return HI_ERR_TDE_INVALID_PARA;
+    }
+    size = (hi_u64)surface->stride * surface->height;
+    if (size > 0xffffffffULL) {
+        return HI_ERR_TDE_INVALID_PARA;
+    }
+    vir_addr = g_tde_sw_map(surface->phy_addr, (hi_u32)size);
+    if (vir_addr == HI_NULL) {
+        return HI_ERR_TDE_NULL_PTR;
+    }
+
+    plane->surface = surface;
+    plane->fmt = fmt;
+    plane->stride = surface->stride;
+    plane->base = vir_addr + (hi_u32)rect->pos_y * surface->stride + (hi_u32)rect->pos_x * fmt->bytes;
+    plane->width = rect->width;
+    plane->height = rect->height;
+    return HI_SUCCESS;
+}
+
+static inline hi_u8 *tde_sw_pixel(const tde_sw_plane *plane, hi_u32 x, hi_u32 y)
+{
+    return plane->base + y * plane->stride + x * plane->fmt->bytes;
+}
+
+static inline hi_u32 tde_sw_read_raw(const hi_u8 *pixel, hi_u8 bytes)
+{
+    hi_u32 value = 0;
+    hi_u8 i;
+
+    for (i = 0; i < bytes; i++) {
+        value |= (hi_u32)pixel[i] << (i * TDE_SW_BYTE_BITS);
+    }
+    return value;
+}
+
+static inline hi_void tde_sw_write_raw(hi_u8 *pixel, hi_u8 bytes, hi_u32 value)
+{
+    hi_u8 i;
+
+    for (i = 0; i < bytes; i++) {
+        pixel[i] = (hi_u8)(value >> (i * TDE_SW_BYTE_BITS));
+    }
+}
+
+/* Widen an n-bit channel to 8 bits by bit replication, the way the hardware does */
+static inline hi_u32 tde_sw_expand(hi_u32 value, hi_u8 len)
+{
+    if (len >= TDE_SW_CHN_BITS) {
+        return value & TDE_SW_CHN_MAX;
+    }
+    if (len == 1) {
+        return (value != 0) ? TDE_SW_CHN_MAX : 0;
+    }
+    return (value << (TDE_SW_CHN_BITS - len)) | (value >> (2 * len - TDE_SW_CHN_BITS)); /* 2: replicate the msbs */
+}
+
+static inline hi_u32 tde_sw_get_chn(hi_u32 raw, hi_u8 shift, hi_u8 len)
+{
+    if (len == 0) {
+        return 0;
+    }
+    return tde_sw_expand((raw >> shift) & ((1U << len) - 1), len);
+}
+
+static inline hi_u32 tde_sw_put_chn(hi_u32 value, hi_u8 shift, hi_u8 len)
+{
+    if (len == 0) {
+        return 0;
+    }
+    return (value >> (TDE_SW_CHN_BITS - len)) << shift;
+}
+
+static hi_void tde_sw_unpack(const tde_sw_plane *plane, hi_u32 raw, tde_sw_color *color)
+{
+    const tde_sw_fmt_info *fmt = plane->fmt;
+    const hi_tde_surface *surface = plane->surface;
+
+    color->r = tde_sw_get_chn(raw, fmt->r_shift, fmt->r_len);
+    color->g = tde_sw_get_chn(raw, fmt->g_shift, fmt->g_len);
+    color->b = tde_sw_get_chn(raw, fmt->b_shift, fmt->b_len);
+
+    if (fmt->a_len == 0) {
+        color->a = TDE_SW_CHN_MAX;
+    } else if ((fmt->a_len == 1) && surface->support_alpha_ext_1555) {
+        color->a = ((raw >> fmt->a_shift) & 0x1) ? surface->alpha1 : surface->alpha0;
+    } else {
+        color->a = tde_sw_get_chn(raw, fmt->a_shift, fmt->a_len);
+        if ((fmt->a_len == TDE_SW_CHN_BITS) && !surface->alpha_max_is_255) {
+            /* alpha range is [0, 128] */
+            color->a = (color->a >= TDE_SW_ALPHA_128) ? TDE_SW_CHN_MAX :
+                       ((color->a * TDE_SW_CHN_MAX + TDE_SW_ALPHA_128 / 2) / TDE_SW_ALPHA_128); /* 2: round */
+        }
+    }
+}
+
+static hi_u32 tde_sw_pack(const tde_sw_plane *plane, const tde_sw_color *color)
+{
+    const tde_sw_fmt_info *fmt = plane->fmt;
+    hi_u32 alpha = color->a;
+
+    if ((fmt->a_len == TDE_SW_CHN_BITS) && !plane->surface->alpha_max_is_255) {
+        alpha = (alpha * TDE_SW_ALPHA_128 + TDE_SW_CHN_MAX / 2) / TDE_SW_CHN_MAX; /* 2: round */
+    } else if (fmt->a_len == 1) {
+        alpha = (alpha >= TDE_SW_ALPHA_128) ? TDE_SW_CHN_MAX : 0;
+    }
+    return tde_sw_put_chn(alpha, fmt->a_shift, fmt->a_len) | tde_sw_put_chn(color->r, fmt->r_shift, fmt->r_len) |
+           tde_sw_put_chn(color->g, fmt->g_shift, fmt->g_len) | tde_sw_put_chn(color->b, fmt->b_shift, fmt->b_len);
+}
+
+static inline hi_void tde_sw_read_color(const tde_sw_plane *plane, hi_u32 x, hi_u32 y, tde_sw_color *color)
+{
+    tde_sw_unpack(plane, tde_sw_read_raw(tde_sw_pixel(plane, x, y), plane->fmt->bytes), color);
+}
+
+static inline hi_void tde_sw_write_color(const tde_sw_plane *plane, hi_u32 x, hi_u32 y, const tde_sw_color *color)
+{
+    tde_sw_write_raw(tde_sw_pixel(plane, x, y), plane->fmt->bytes, tde_sw_pack(plane, color));
+}
+
+/* x / 255 rounded to nearest, exact for x <= 255 * 255 */
+static inline hi_u32 tde_sw_div255(hi_u32 x)
+{
+    x += TDE_SW_ALPHA_128;
+    return (x + (x >> TDE_SW_CHN_BITS)) >> TDE_SW_CHN_BITS;
+}
+
+static inline hi_u32 tde_sw_min(hi_u32 a, hi_u32 b)
+{
+    return (a < b) ? a : b;
+}
+
+/* Copy len bytes that may overlap, as a blit inside one surface does */
+static hi_void tde_sw_move(hi_u8 *dst, const hi_u8 *src, hi_u32 len)
+{
+    hi_u32 i;
+
+    if ((dst + len <= src) || (src + len <= dst)) {
+        (hi_void)memcpy_s(dst, len, src, len);
+        return;
+    }
+    if (dst < src) {
+        for (i = 0; i < len; i++) {
+            dst[i] = src[i];
+        }
+    } else {
+        for (i = len; i > 0; i--) {
+            dst[i - 1] = src[i - 1];
+        }
+    }
+}
+
+hi_s32 tde_sw_quick_fill(const hi_tde_surface *dst, const hi_tde_rect *dst_rect, hi_u32 fill_data)
+{
+    tde_sw_plane plane;
+    hi_u32 row_len, done, len, y;
+    hi_s32 ret;
+
+    ret = tde_sw_plane_init(dst, dst_rect, &plane);
+    if (ret != HI_SUCCESS) {
+        return ret;
+    }
+
+    /* write one pixel, double it across the first line, then copy the line down */
+    row_len = plane.width * plane.fmt->bytes;
+    tde_sw_write_raw(plane.base, plane.fmt->bytes, fill_data);
+    for (done = plane.fmt->bytes; done < row_len; done += len) {
+        len = tde_sw_min(done, row_len - done);
+        (hi_void)memcpy_s(plane.base + done, len, plane.base, len);
+    }
+    for (y = 1; y < plane.height; y++) {
+        (hi_void)memcpy_s(tde_sw_pixel(&plane, 0, y), row_len, plane.base, row_len);
+    }
+    return HI_SUCCESS;
+}
+
+hi_s32 tde_sw_quick_copy(const hi_tde_surface *src, const hi_tde_rect *src_rect,
+                         const hi_tde_surface *dst, const hi_tde_rect *dst_rect)
+{
+    tde_sw_plane src_plane, dst_plane;
+    tde_sw_color color;
+    hi_u32 width, height, x, y, row;
+    hi_s32 ret;
+
+    ret = tde_sw_plane_init(src, src_rect, &src_plane);
+    if (ret != HI_SUCCESS) {
+        return ret;
+    }
+    ret = tde_sw_plane_init(dst, dst_rect, &dst_plane);
+    if (ret != HI_SUCCESS) {
+        return ret;
+    }
+    width = tde_sw_min(src_plane.width, dst_plane.width);
+    height = tde_sw_min(src_plane.height, dst_plane.height);
+
+    if (src->color_fmt == dst->color_fmt) {
+        /* walk the lines bottom-up when the destination lies after the source */
+        for (row = 0; row < height; row++) {
+            y = (dst_plane.base > src_plane.base) ? (height - 1 - row) : row;
+            tde_sw_move(tde_sw_pixel(&dst_plane, 0, y), tde_sw_pixel(&src_plane, 0, y), width * src_plane.fmt->bytes);
+        }
+        return HI_SUCCESS;
+    }
+
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++) {
+            tde_sw_read_color(&src_plane, x, y, &color);
+            tde_sw_write_color(&dst_plane, x, y, &color);
+        }
+    }
+    return HI_SUCCESS;
+}
+
+/* Sample position of a destination pixel center in the source, 16.16 fixed point */
+static inline hi_u32 tde_sw_sample_pos(hi_u32 dst_pos, hi_u32 src_len, hi_u32 dst_len)
+{
+    hi_s64 pos = ((((hi_s64)dst_pos * 2 + 1) * src_len) << TDE_SW_FIX_SHIFT) / ((hi_s64)dst_len * 2) - /* 2: center */
+                 TDE_SW_FIX_HALF;
+    hi_s64 max = (hi_s64)(src_len - 1) << TDE_SW_FIX_SHIFT;
+
+    if (pos < 0) {
+        return 0;
+    }
+    return (hi_u32)((pos > max) ? max : pos);
+}
+
+static inline hi_u32 tde_sw_lerp(hi_u32 c0, hi_u32 c1, hi_u32 weight)
+{
+    return c0 * (TDE_SW_WEIGHT_ONE - weight) + c1 * weight;
+}
+
+static hi_u32 tde_sw_bilinear(hi_u32 c00, hi_u32 c01, hi_u32 c10, hi_u32 c11, hi_u32 fx, hi_u32 fy)
+{
+    hi_u32 top = tde_sw_lerp(c00, c01, fx);
+    hi_u32 bottom = tde_sw_lerp(c10, c11, fx);
+
+    return (tde_sw_lerp(top, bottom, fy) + TDE_SW_FIX_HALF) >> TDE_SW_FIX_SHIFT;
+}
+
+hi_s32 tde_sw_quick_resize(const hi_tde_surface *src, const hi_tde_rect *src_rect,
+                           const hi_tde_surface *dst, const hi_tde_rect *dst_rect)
+{
+    tde_sw_plane src_plane, dst_plane;
+    tde_sw_color c00, c01, c10, c11, out;
+    hi_u32 x, y, sx, sy, x0, y0, x1, y1, fx, fy;
+    hi_s32 ret;
+
+    ret = tde_sw_plane_init(src, src_rect, &src_plane);
+    if (ret != HI_SUCCESS) {
+        return ret;
+    }
+    ret = tde_sw_plane_init(dst, dst_rect, &dst_plane);
+    if (ret != HI_SUCCESS) {
+        return ret;
+    }
+
+    for (y = 0; y < dst_plane.height; y++) {
+        sy = tde_sw_sample_pos(y, src_plane.height, dst_plane.height);
+        y0 = sy >> TDE_SW_FIX_SHIFT;
+        y1 = tde_sw_min(y0 + 1, src_plane.height - 1);
+        fy = (sy >> (TDE_SW_FIX_SHIFT - TDE_SW_WEIGHT_SHIFT)) & (TDE_SW_WEIGHT_ONE - 1);
+        for (x = 0; x < dst_plane.width; x++) {
+            sx = tde_sw_sample_pos(x, src_plane.width, dst_plane.width);
+            x0 = sx >> TDE_SW_FIX_SHIFT;
+            x1 = tde_sw_min(x0 + 1, src_plane.width - 1);
+            fx = (sx >> (TDE_SW_FIX_SHIFT - TDE_SW_WEIGHT_SHIFT)) & (TDE_SW_WEIGHT_ONE - 1);
+
+            tde_sw_read_color(&src_plane, x0, y0, &c00);
+            tde_sw_read_color(&src_plane, x1, y0, &c01);
+            tde_sw_read_color(&src_plane, x0, y1, &c10);
+            tde_sw_read_color(&src_plane, x1, y1, &c11);
+            out.a = tde_sw_bilinear(c00.a, c01.a, c10.a, c11.a, fx, fy);
+            out.r = tde_sw_bilinear(c00.r, c01.r, c10.r, c11.r, fx, fy);
+            out.g = tde_sw_bilinear(c00.g, c01.g, c10.g, c11.g, fx, fy);
+            out.b = tde_sw_bilinear(c00.b, c01.b, c10.b, c11.b, fx, fy);
+            tde_sw_write_color(&dst_plane, x, y, &out);
+        }
+    }
+    return HI_SUCCESS;
+}
+
+/*
+ * ROP2 on whole words: bit 3..0 of the rop code give the result for
+ * (S2, S1) = (1, 1), (1, 0), (0, 1), (0, 0).
+ */
+static inline hi_u32 tde_sw_rop(hi_tde_rop_mode rop, hi_u32 s2, hi_u32 s1)
+{
+    hi_u32 code = (hi_u32)rop;
+    hi_u32 value = 0;
+
+    value |= (code & 0x8) ? (s2 & s1) : 0;
+    value |= (code & 0x4) ? (s2 & ~s1) : 0;
+    value |= (code & 0x2) ? (~s2 & s1) : 0;
+    value |= (code & 0x1) ? (~s2 & ~s1) : 0;
+    return value;
+}
+
+static hi_bool tde_sw_key_comp_match(const hi_tde_color_key_comp *comp, hi_u32 value)
+{
+    hi_bool in_range;
+
+    if (comp->is_component_ignore) {
+        return HI_TRUE;
+    }
+    value &= comp->component_mask;
+    in_range = ((value >= comp->component_min) && (value <= comp->component_max)) ? HI_TRUE : HI_FALSE;
+    return comp->is_component_out ? !in_range : in_range;
+}
+
+static hi_bool tde_sw_key_match(const hi_tde_color_key *key, const tde_sw_color *color)
+{
+    return tde_sw_key_comp_match(&key->argb_color_key.alpha, color->a) &&
+           tde_sw_key_comp_match(&key->argb_color_key.red, color->r) &&
+           tde_sw_key_comp_match(&key->argb_color_key.green, color->g) &&
+           tde_sw_key_comp_match(&key->argb_color_key.blue, color->b);
+}
+
+static hi_u32 tde_sw_blend_factor(hi_tde_blend_mode mode, hi_u32 src2, hi_u32 src1, hi_u32 src2_alpha,
+                                  hi_u32 src1_alpha)
+{
+    switch (mode) {
+        case HI_TDE_BLEND_ONE:
+            return TDE_SW_CHN_MAX;
+        case HI_TDE_BLEND_SRC2COLOR:
+            return src2;
+        case HI_TDE_BLEND_INVSRC2COLOR:
+            return TDE_SW_CHN_MAX - src2;
+        case HI_TDE_BLEND_SRC2ALPHA:
+            return src2_alpha;
+        case HI_TDE_BLEND_INVSRC2ALPHA:
+            return TDE_SW_CHN_MAX - src2_alpha;
+        case HI_TDE_BLEND_SRC1COLOR:
+            return src1;
+        case HI_TDE_BLEND_INVSRC1COLOR:
+            return TDE_SW_CHN_MAX - src1;
+        case HI_TDE_BLEND_SRC1ALPHA:
+            return src1_alpha;
+        case HI_TDE_BLEND_INVSRC1ALPHA:
+            return TDE_SW_CHN_MAX - src1_alpha;
+        case HI_TDE_BLEND_SRC2ALPHASAT:
+            return tde_sw_min(src2_alpha, TDE_SW_CHN_MAX - src1_alpha);
+        default:
+            return 0;
+    }
+}
+
+static inline hi_u32 tde_sw_blend_chn(hi_u32 src2, hi_u32 src1, hi_u32 src2_factor, hi_u32 src1_factor)
+{
+    return tde_sw_min(tde_sw_div255(src2 * src2_factor) + tde_sw_div255(src1 * src1_factor), TDE_SW_CHN_MAX);
+}
+
+static hi_void tde_sw_premulti(tde_sw_color *color, hi_u32 scale)
+{
+    color->r = tde_sw_div255(color->r * scale);
+    color->g = tde_sw_div255(color->g * scale);
+    color->b = tde_sw_div255(color->b * scale);
+}
+
+static hi_void tde_sw_unpremulti(tde_sw_color *color)
+{
+    if (color->a == 0) {
+        color->r = 0;
+        color->g = 0;
+        color->b = 0;
+        return;
+    }
+    color->r = tde_sw_min((color->r * TDE_SW_CHN_MAX + color->a / 2) / color->a, TDE_SW_CHN_MAX); /* 2: round */
+    color->g = tde_sw_min((color->g * TDE_SW_CHN_MAX + color->a / 2) / color->a, TDE_SW_CHN_MAX); /* 2: round */
+    color->b = tde_sw_min((color->b * TDE_SW_CHN_MAX + color->a / 2) / color->a, TDE_SW_CHN_MAX); /* 2: round */
+}
+
+/* Porter-Duff blend of src2 (foreground) onto src1 (background), result in out */
+static hi_void tde_sw_blend(const hi_tde_opt *opt, const tde_sw_color *src2, const tde_sw_color *src1,
+                            tde_sw_color *out)
+{
+    const hi_tde_blend_opt *blend_opt = &opt->blend_opt;
+    tde_sw_color fg = *src2;
+    tde_sw_color bg = *src1;
+    hi_tde_blend_mode src2_mode, src1_mode;
+    hi_u32 sa, da;
+
+    sa = blend_opt->pixel_alpha_en ? fg.a : TDE_SW_CHN_MAX;
+    da = blend_opt->pixel_alpha_en ? bg.a : TDE_SW_CHN_MAX;
+    if (blend_opt->global_alpha_en) {
+        sa = tde_sw_div255(sa * opt->global_alpha);
+    }
+
+    if (!blend_opt->src2_alpha_premulti) {
+        tde_sw_premulti(&fg, sa);
+    } else if (blend_opt->global_alpha_en) {
+        tde_sw_premulti(&fg, opt->global_alpha);
+    }
+    if (!blend_opt->src1_alpha_premulti) {
+        tde_sw_premulti(&bg, da);
+    }
+
+    if (blend_opt->blend_cmd == HI_TDE_BLEND_CMD_CONFIG) {
+        src2_mode = blend_opt->src2_blend_mode;
+        src1_mode = blend_opt->src1_blend_mode;
+    } else {
+        src2_mode = (hi_tde_blend_mode)g_tde_sw_blend_factor[blend_opt->blend_cmd][0];
+        src1_mode = (hi_tde_blend_mode)g_tde_sw_blend_factor[blend_opt->blend_cmd][1];
+    }
+
+    out->r = tde_sw_blend_chn(fg.r, bg.r, tde_sw_blend_factor(src2_mode, fg.r, bg.r, sa, da),
+                              tde_sw_blend_factor(src1_mode, fg.r, bg.r, sa, da));
+    out->g = tde_sw_blend_chn(fg.g, bg.g, tde_sw_blend_factor(src2_mode, fg.g, bg.g, sa, da),
+                              tde_sw_blend_factor(src1_mode, fg.g, bg.g, sa, da));
+    out->b = tde_sw_blend_chn(fg.b, bg.b, tde_sw_blend_factor(src2_mode, fg.b, bg.b, sa, da),
+                              tde_sw_blend_factor(src1_mode, fg.b, bg.b, sa, da));
+    /* the alpha channel uses the alpha factors, SRC2ALPHASAT is 1.0 for it */
+    src2_mode = (src2_mode == HI_TDE_BLEND_SRC2ALPHASAT) ? HI_TDE_BLEND_ONE : src2_mode;
+    src1_mode = (src1_mode == HI_TDE_BLEND_SRC2ALPHASAT) ? HI_TDE_BLEND_ONE : src1_mode;
+    out->a = tde_sw_blend_chn(sa, da, tde_sw_blend_factor(src2_mode, sa, da, sa, da),
+                              tde_sw_blend_factor(src1_mode, sa, da, sa, da));
+
+    if (!blend_opt->src2_alpha_premulti) {
+        tde_sw_unpremulti(out);
+    }
+}
+
+static hi_bool tde_sw_clip_pass(const hi_tde_opt *opt, hi_s32 x, hi_s32 y)
+{
+    const hi_tde_rect *clip = &opt->clip_rect;
+    hi_bool inside;
+
+    if (opt->clip_mode == HI_TDE_CLIP_MODE_NONE) {
+        return HI_TRUE;
+    }
+    inside = ((x >= clip->pos_x) && (y >= clip->pos_y) && ((hi_s64)x < (hi_s64)clip->pos_x + clip->width) &&
+              ((hi_s64)y < (hi_s64)clip->pos_y + clip->height)) ? HI_TRUE : HI_FALSE;
+    return (opt->clip_mode == HI_TDE_CLIP_MODE_INSIDE) ? inside : !inside;
+}
+
+static hi_void tde_sw_blit_pixel(const hi_tde_opt *opt, const tde_sw_color *fg, const tde_sw_color *bg,
+                                 tde_sw_color *out)
+{
+    tde_sw_color src = *fg;
+    hi_u32 rop_word;
+
+    /* a pixel of the keyed surface that matches the key is transparent */
+    if ((opt->color_key_mode == HI_TDE_COLOR_KEY_MODE_FOREGROUND) && tde_sw_key_match(&opt->color_key_value, fg)) {
+        *out = *bg;
+        return;
+    }
+    if ((opt->color_key_mode == HI_TDE_COLOR_KEY_MODE_BACKGROUND) && tde_sw_key_match(&opt->color_key_value, bg)) {
+        *out = *fg;
+        return;
+    }
+
+    if (opt->alpha_blending_cmd & HI_TDE_ALPHA_BLENDING_ROP) {
+        rop_word = tde_sw_rop(opt->rop_color, (fg->r << 16) | (fg->g << 8) | fg->b, /* 16, 8: rgb word */
+                              (bg->r << 16) | (bg->g << 8) | bg->b);                /* 16, 8: rgb word */
+        src.r = (rop_word >> 16) & TDE_SW_CHN_MAX; /* 16: red */
+        src.g = (rop_word >> 8) & TDE_SW_CHN_MAX;  /* 8: green */
+        src.b = rop_word & TDE_SW_CHN_MAX;
+        src.a = tde_sw_rop(opt->rop_alpha, fg->a, bg->a) & TDE_SW_CHN_MAX;
+    }
+
+    if (opt->alpha_blending_cmd & HI_TDE_ALPHA_BLENDING_BLEND) {
+        tde_sw_blend(opt, &src, bg, out);
+    } else {
+        *out = src;
+    }
+
+    switch (opt->out_alpha_from) {
+        case HI_TDE_OUT_ALPHA_FROM_BACKGROUND:
+            out->a = bg->a;
+            break;
+        case HI_TDE_OUT_ALPHA_FROM_FOREGROUND:
+            out->a = fg->a;
+            break;
+        case HI_TDE_OUT_ALPHA_FROM_GLOBALALPHA:
+            out->a = opt->global_alpha;
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * SrcOver of premultiplied ARGB8888 with red/blue and alpha/green handled two
+ * channels per multiply. Gives the same result as tde_sw_blend for valid
+ * premultiplied input (color <= alpha).
+ */
+static inline hi_u32 tde_sw_srcover_argb8888(hi_u32 src, hi_u32 dst)
+{
+    hi_u32 inv_alpha = TDE_SW_CHN_MAX - (src >> 24); /* 24: alpha */
+    hi_u32 rb = (dst & TDE_SW_LANE_MASK) * inv_alpha + TDE_SW_LANE_HALF;
+    hi_u32 ag = ((dst >> TDE_SW_CHN_BITS) & TDE_SW_LANE_MASK) * inv_alpha + TDE_SW_LANE_HALF;
+
+    rb = ((rb + ((rb >> TDE_SW_CHN_BITS) & TDE_SW_LANE_MASK)) >> TDE_SW_CHN_BITS) & TDE_SW_LANE_MASK;
+    ag = (ag + ((ag >> TDE_SW_CHN_BITS) & TDE_SW_LANE_MASK)) & ~TDE_SW_LANE_MASK;
+    return src + (rb | ag);
+}
+
+static hi_bool tde_sw_is_srcover_fast(const tde_sw_plane *bg, const tde_sw_plane *fg, const tde_sw_plane *dst,
+                                      const hi_tde_opt *opt)
+{
+    const hi_tde_blend_opt *blend_opt = &opt->blend_opt;
+
+    if ((bg->surface->color_fmt != HI_TDE_COLOR_FMT_ARGB8888) ||
+        (fg->surface->color_fmt != HI_TDE_COLOR_FMT_ARGB8888) ||
+        (dst->surface->color_fmt != HI_TDE_COLOR_FMT_ARGB8888) || !bg->surface->alpha_max_is_255 ||
+        !fg->surface->alpha_max_is_255 || !dst->surface->alpha_max_is_255) {
+        return HI_FALSE;
+    }
+    if ((opt->alpha_blending_cmd != HI_TDE_ALPHA_BLENDING_BLEND) || (opt->color_key_mode != HI_TDE_COLOR_KEY_MODE_NONE) ||
+        (opt->clip_mode != HI_TDE_CLIP_MODE_NONE) || (opt->mirror != HI_TDE_MIRROR_NONE) ||
+        (opt->out_alpha_from != HI_TDE_OUT_ALPHA_FROM_NORM)) {
+        return HI_FALSE;
+    }
+    return ((blend_opt->blend_cmd == HI_TDE_BLEND_CMD_SRCOVER) || (blend_opt->blend_cmd == HI_TDE_BLEND_CMD_NONE)) &&
+           blend_opt->pixel_alpha_en && !blend_opt->global_alpha_en && blend_opt->src1_alpha_premulti &&
+           blend_opt->src2_alpha_premulti;
+}
+
+static hi_void tde_sw_blit_srcover_fast(const tde_sw_plane *bg, const tde_sw_plane *fg, const tde_sw_plane *dst,
+                                        hi_u32 width, hi_u32 height)
+{
+    hi_u32 x, y, value;
+
+    for (y = 0; y < height; y++) {
+        const hi_u8 *fg_line = tde_sw_pixel(fg, 0, y);
+        const hi_u8 *bg_line = tde_sw_pixel(bg, 0, y);
+        hi_u8 *dst_line = tde_sw_pixel(dst, 0, y);
+
+        for (x = 0; x < width; x++) {
+            value = tde_sw_srcover_argb8888(tde_sw_read_raw(fg_line + x * 4, 4), /* 4: bytes of argb8888 */
+                                            tde_sw_read_raw(bg_line + x * 4, 4)); /* 4: bytes of argb8888 */
+            tde_sw_write_raw(dst_line + x * 4, 4, value); /* 4: bytes of argb8888 */
+        }
+    }
+}
+
+hi_s32 tde_sw_blit(const hi_tde_surface *back_ground, const hi_tde_rect *back_ground_rect,
+                   const hi_tde_surface *fore_ground, const hi_tde_rect *fore_ground_rect,
+                   const hi_tde_surface *dst, const hi_tde_rect *dst_rect, const hi_tde_opt *opt)
+{
+    tde_sw_plane bg_plane, fg_plane, dst_plane;
+    tde_sw_color fg, bg, out;
+    hi_u32 width, height, x, y, fg_x, fg_y;
+    hi_s32 ret;
+
+    if (opt == HI_NULL) {
+        return tde_sw_quick_copy(fore_ground, fore_ground_rect, dst, dst_rect);
+    }
+    if ((opt->alpha_blending_cmd & HI_TDE_ALPHA_BLENDING_COLORIZE) ||
+        (opt->alpha_blending_cmd >= HI_TDE_ALPHA_BLENDING_MAX) || (opt->blend_opt.blend_cmd >= HI_TDE_BLEND_CMD_MAX) ||
+        (opt->rop_color >= HI_TDE_ROP_MAX) || (opt->rop_alpha >= HI_TDE_ROP_MAX)) {
+        return HI_ERR_TDE_UNSUPPORTED_OPERATION;
+    }
+
+    ret = tde_sw_plane_init(fore_ground, fore_ground_rect, &fg_plane);
+    if (ret != HI_SUCCESS) {
+        return ret;
+    }
+    ret = tde_sw_plane_init(dst, dst_rect, &dst_plane);
+    if (ret != HI_SUCCESS) {
+        return ret;
+    }
+    if (back_ground != HI_NULL) {
+        ret = tde_sw_plane_init(back_ground, back_ground_rect, &bg_plane);
+        if (ret != HI_SUCCESS) {
+            return ret;
+        }
+    } else {
+        bg_plane = dst_plane;
+    }
+
+    if (opt->resize && ((fg_plane.width != dst_plane.width) || (fg_plane.height != dst_plane.height))) {
+        return HI_ERR_TDE_UNSUPPORTED_OPERATION;
+    }
+    width = tde_sw_min(tde_sw_min(fg_plane.width, bg_plane.width), dst_plane.width);
+    height = tde_sw_min(tde_sw_min(fg_plane.height, bg_plane.height), dst_plane.height);
+
+    if (tde_sw_is_srcover_fast(&bg_plane, &fg_plane, &dst_plane, opt)) {
+        tde_sw_blit_srcover_fast(&bg_plane, &fg_plane, &dst_plane, width, height);
+        return HI_SUCCESS;
+    }
+
+    for (y = 0; y < height; y++) {
+        fg_y = ((opt->mirror == HI_TDE_MIRROR_VERTICAL) || (opt->mirror == HI_TDE_MIRROR_BOTH)) ? (height - 1 - y) : y;
+        for (x = 0; x < width; x++) {
+            if (!tde_sw_clip_pass(opt, dst_rect->pos_x + (hi_s32)x, dst_rect->pos_y + (hi_s32)y)) {
+                continue;
+            }
+            fg_x = ((opt->mirror == HI_TDE_MIRROR_HORIZONTAL) || (opt->mirror == HI_TDE_MIRROR_BOTH)) ?
+                   (width - 1 - x) : x;
+            tde_sw_read_color(&fg_plane, fg_x, fg_y, &fg);
+            tde_sw_read_color(&bg_plane, x, y, &bg);
+            tde_sw_blit_pixel(opt, &fg, &bg, &out);
+            tde_sw_write_color(&dst_plane, x, y, &out);
+        }
+    }
+    return HI_SUCCESS;
+}
+
+static inline hi_void tde_sw_rotate_pos(hi_tde_rotate_angle angle, hi_u32 width, hi_u32 height, hi_u32 x, hi_u32 y,
+                                        hi_u32 *dst_x, hi_u32 *dst_y)
+{
+    if (angle == HI_TDE_ROTATE_CLOCKWISE_90) {
+        *dst_x = height - 1 - y;
+        *dst_y = x;
+    } else if (angle == HI_TDE_ROTATE_CLOCKWISE_180) {
+        *dst_x = width - 1 - x;
+        *dst_y = height - 1 - y;
+    } else {
+        *dst_x = y;
+        *dst_y = width - 1 - x;
+    }
+}
+
+hi_s32 tde_sw_rotate(const hi_tde_surface *src, const hi_tde_rect *src_rect,
+                     const hi_tde_surface *dst, const hi_tde_rect *dst_rect, hi_tde_rotate_angle rotate_angle)
+{
+    tde_sw_plane src_plane, dst_plane;
+    hi_u32 width, height, tile_x, tile_y, x, y, dst_x, dst_y, x_end, y_end;
+    hi_s32 ret;
+
+    if ((rotate_angle < HI_TDE_ROTATE_CLOCKWISE_90) || (rotate_angle >= HI_TDE_ROTATE_MAX)) {
+        return HI_ERR_TDE_INVALID_PARA;
+    }
+    ret = tde_sw_plane_init(src, src_rect, &src_plane);
+    if (ret != HI_SUCCESS) {
+        return ret;
+    }
+    ret = tde_sw_plane_init(dst, dst_rect, &dst_plane);
+    if (ret != HI_SUCCESS) {
+        return ret;
+    }
+    if (src->color_fmt != dst->color_fmt) {
+        return HI_ERR_TDE_UNSUPPORTED_OPERATION;
+    }
+
+    if (rotate_angle == HI_TDE_ROTATE_CLOCKWISE_180) {
+        width = tde_sw_min(src_plane.width, dst_plane.width);
+        height = tde_sw_min(src_plane.height, dst_plane.height);
+    } else {
+        width = tde_sw_min(src_plane.width, dst_plane.height);
+        height = tde_sw_min(src_plane.height, dst_plane.width);
+    }
+
+    for (tile_y = 0; tile_y < height; tile_y += TDE_SW_TILE) {
+        y_end = tde_sw_min(tile_y + TDE_SW_TILE, height);
+        for (tile_x = 0; tile_x < width; tile_x += TDE_SW_TILE) {
+            x_end = tde_sw_min(tile_x + TDE_SW_TILE, width);
+            for (y = tile_y; y < y_end; y++) {
+                for (x = tile_x; x < x_end; x++) {
+                    tde_sw_rotate_pos(rotate_angle, width, height, x, y, &dst_x, &dst_y);
+                    tde_sw_write_raw(tde_sw_pixel(&dst_plane, dst_x, dst_y), src_plane.fmt->bytes,
+                                     tde_sw_read_raw(tde_sw_pixel(&src_plane, x, y), src_plane.fmt->bytes));
+                }
+            }
+        }
+    }
+    return HI_SUCCESS;
+}
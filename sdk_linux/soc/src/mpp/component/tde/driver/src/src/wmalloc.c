@@ -26,10 +26,10 @@ typedef struct {
     hi_u16 n_free;
     hi_u16 n_first;
     hi_u16 n_unit_size;
-#if HI_TDE_MEMCOUNT_SUPPORT
-    hi_u16 n_max_used; /* max used unit number */
+    hi_u16 n_max_used; /* max number of units taken out of the shared pool, cached ones included */
     hi_u16 n_max_num;  /* max unit number */
-#endif
+    hi_u16 n_mag_size; /* capacity of the per-CPU magazines, 0 when the pool is too small to cache */
+    hi_u16 n_batch;    /* units moved between a magazine and the shared pool at a time */
     hi_void *start_addr;
     struct _memory_block *next;
 } memory_block;
@@ -42,10 +42,29 @@ typedef enum {
     UNIT_SIZE_BUTT
 } unit_size;
 
+/*
+ * Per-CPU magazines sit in front of the shared pools, so building a job only takes the
+ * uncontended lock of the local magazine and g_mem_lock is taken once per batch.
+ */
+#define TDE_MEM_MAX_CPU 4
+#define TDE_MAG_SIZE 16
+#define TDE_MAG_MIN_SIZE 2
+#define TDE_MAG_POOL_SHARE 4 /* a magazine never caches more than 1/4 of its share of the pool */
+
+typedef struct {
+    osal_spinlock_t lock;
+    hi_u16 count;
+    hi_u16 unit[TDE_MAG_SIZE];
+} tde_magazine;
+
 static memory_block g_stru_mem_block[UNIT_SIZE_BUTT];
+static tde_magazine g_mem_mag[UNIT_SIZE_BUTT][TDE_MEM_MAX_CPU];
 
 #ifndef HI_BUILD_IN_BOOT
 static osal_spinlock_t g_mem_lock;
+#define tde_mem_cpu_id() (osal_get_cpu_id() % TDE_MEM_MAX_CPU)
+#else
+#define tde_mem_cpu_id() 0
 #endif
 
 #define print_mem_info()                                                                                              \
@@ -62,6 +81,7 @@ static osal_spinlock_t g_mem_lock;
 static hi_s32 memory_block_init(unit_size size, hi_u16 n_unit_num, hi_void *addr)
 {
     hi_u16 i;
+    hi_u32 mag_size;
 
     hi_u8 *data = (hi_u8 *)addr;
 
@@ -89,42 +109,136 @@ static hi_s32 memory_block_init(unit_size size, hi_u16 n_unit_num, hi_void *addr
     g_stru_mem_block[size].n_size = n_unit_num * g_stru_mem_block[size].n_unit_size;
     g_stru_mem_block[size].next = HI_NULL;
     g_stru_mem_block[size].start_addr = addr;
-
-#if HI_TDE_MEMCOUNT_SUPPORT
     g_stru_mem_block[size].n_max_num = n_unit_num;
     g_stru_mem_block[size].n_max_used = 0;
-#endif
+
+    mag_size = n_unit_num / (TDE_MEM_MAX_CPU * TDE_MAG_POOL_SHARE);
+    mag_size = (mag_size > TDE_MAG_SIZE) ? TDE_MAG_SIZE : mag_size;
+    g_stru_mem_block[size].n_mag_size = (mag_size < TDE_MAG_MIN_SIZE) ? 0 : (hi_u16)mag_size;
+    g_stru_mem_block[size].n_batch = (hi_u16)(g_stru_mem_block[size].n_mag_size / 2); /* 2 half of the magazine */
+    for (i = 0; i < TDE_MEM_MAX_CPU; i++) {
+        g_mem_mag[size][i].count = 0;
+    }
 
     return HI_SUCCESS;
 }
 
-static hi_void *malloc_unit(unit_size size)
+static hi_void *memory_block_addr(const memory_block *block, hi_u16 index)
+{
+    return (hi_u8 *)block->start_addr + index * block->n_unit_size;
+}
+
+/* g_mem_lock must be held */
+static hi_bool memory_block_pop(memory_block *block, hi_u16 *index)
+{
+    if (block->n_free == 0) {
+        return HI_FALSE;
+    }
+    *index = block->n_first;
+    block->n_first = *(hi_u16 *)memory_block_addr(block, *index);
+    block->n_free--;
+    if ((block->n_max_num - block->n_free) > block->n_max_used) {
+        block->n_max_used = block->n_max_num - block->n_free;
+    }
+    return HI_TRUE;
+}
+
+/* g_mem_lock must be held */
+static hi_void memory_block_push(memory_block *block, hi_u16 index)
+{
+    *(hi_u16 *)memory_block_addr(block, index) = block->n_first; /* point to next unit can be assigned */
+    block->n_first = index;
+    block->n_free++;
+}
+
+/* the magazine lock must be held */
+static hi_void magazine_refill(memory_block *block, tde_magazine *mag)
 {
     unsigned long lockflags;
+    hi_u16 index;
 
-    memory_block *block = HI_NULL;
-    hi_u8 *free = HI_NULL;
+    tde_spin_lock(&g_mem_lock, lockflags);
+    while ((mag->count < block->n_batch) && memory_block_pop(block, &index)) {
+        mag->unit[mag->count++] = index;
+    }
+    tde_spin_unlock(&g_mem_lock, lockflags);
+}
+
+/* the magazine lock must be held */
+static hi_void magazine_drain(memory_block *block, tde_magazine *mag)
+{
+    unsigned long lockflags;
+    hi_u16 i;
 
     tde_spin_lock(&g_mem_lock, lockflags);
-    block = &g_stru_mem_block[size];
-    tde_info("eUnitSize %d, malloc units:%d, first malloc unit:%d...\n", block->n_unit_size, block->n_free,
-             block->n_first);
-    if (!block->n_free) {
+    for (i = 0; i < block->n_batch; i++) {
+        memory_block_push(block, mag->unit[--mag->count]);
+    }
+    tde_spin_unlock(&g_mem_lock, lockflags);
+}
+
+/* the shared pool is empty, take a unit parked in the magazine of another CPU */
+static hi_bool magazine_steal(unit_size size, hi_u16 *index)
+{
+    unsigned long lockflags;
+    tde_magazine *mag = HI_NULL;
+    hi_u32 i;
+
+    for (i = 0; i < TDE_MEM_MAX_CPU; i++) {
+        mag = &g_mem_mag[size][i];
+        tde_spin_lock(&mag->lock, lockflags);
+        if (mag->count != 0) {
+            *index = mag->unit[--mag->count];
+            tde_spin_unlock(&mag->lock, lockflags);
+            return HI_TRUE;
+        }
+        tde_spin_unlock(&mag->lock, lockflags);
+    }
+    return HI_FALSE;
+}
+
+static hi_bool malloc_unit_index(unit_size size, hi_u16 *index)
+{
+    unsigned long lockflags;
+    memory_block *block = &g_stru_mem_block[size];
+    tde_magazine *mag = HI_NULL;
+    hi_bool got = HI_FALSE;
+
+    if (block->n_mag_size == 0) {
+        tde_spin_lock(&g_mem_lock, lockflags);
+        got = memory_block_pop(block, index);
         tde_spin_unlock(&g_mem_lock, lockflags);
-        return HI_NULL;
+        return got;
+    }
+
+    mag = &g_mem_mag[size][tde_mem_cpu_id()];
+    tde_spin_lock(&mag->lock, lockflags);
+    if (mag->count == 0) {
+        magazine_refill(block, mag);
+    }
+    if (mag->count != 0) {
+        *index = mag->unit[--mag->count];
+        got = HI_TRUE;
     }
+    tde_spin_unlock(&mag->lock, lockflags);
 
-    free = (hi_u8 *)block->start_addr + block->n_first * block->n_unit_size;
+    return got ? HI_TRUE : magazine_steal(size, index);
+}
 
-    block->n_first = *(hi_u16 *)free;
-    block->n_free--;
-#if HI_TDE_MEMCOUNT_SUPPORT
-    if ((g_stru_mem_block[size].n_max_num - block->n_free) > g_stru_mem_block[size].n_max_used) {
-        g_stru_mem_block[size].n_max_used = g_stru_mem_block[size].n_max_num - block->n_free;
+static hi_void *malloc_unit(unit_size size, unsigned long len)
+{
+    memory_block *block = &g_stru_mem_block[size];
+    hi_u8 *free = HI_NULL;
+    hi_u16 index;
+
+    if (!malloc_unit_index(size, &index)) {
+        tde_info("eUnitSize %d, no free unit\n", block->n_unit_size);
+        return HI_NULL;
     }
-#endif
-    tde_spin_unlock(&g_mem_lock, lockflags);
-    (hi_void)memset_s(free, block->n_unit_size, 0, block->n_unit_size);
+    free = (hi_u8 *)memory_block_addr(block, index);
+
+    /* only the bytes the caller asked for, a smaller object may be served from a larger unit */
+    (hi_void)memset_s(free, block->n_unit_size, 0, len);
     return free;
 }
 
@@ -138,7 +252,7 @@ static hi_void *wmalloc(unsigned long size)
     }
     if (size <= CMD_SIZE) {
         for (i = UNIT_SIZE_CMD; i < UNIT_SIZE_BUTT; i++) {
-            malloc = malloc_unit(i);
+            malloc = malloc_unit(i, size);
             if (malloc != HI_NULL) {
                 return malloc;
             }
@@ -146,7 +260,7 @@ static hi_void *wmalloc(unsigned long size)
         return HI_NULL;
     } else if (size <= JOB_SIZE) {
         for (i = UNIT_SIZE_JOB; i < UNIT_SIZE_BUTT; i++) {
-            malloc = malloc_unit(i);
+            malloc = malloc_unit(i, size);
             if (malloc != HI_NULL) {
                 return malloc;
             }
@@ -154,41 +268,51 @@ static hi_void *wmalloc(unsigned long size)
         return HI_NULL;
     } else if (size <= NODE_SIZE) {
         for (i = UNIT_SIZE_NODE; i < UNIT_SIZE_BUTT; i++) {
-            malloc = malloc_unit(i);
+            malloc = malloc_unit(i, size);
             if (malloc != HI_NULL) {
                 return malloc;
             }
         }
         return HI_NULL;
     } else {
-        return malloc_unit(UNIT_SIZE_FILTER);
+        return malloc_unit(UNIT_SIZE_FILTER, size);
     }
 }
 
 static hi_s32 free_unit(unit_size size, hi_void *ptr)
 {
     unsigned long lockflags;
-    memory_block *block = HI_NULL;
-    tde_spin_lock(&g_mem_lock, lockflags);
-    block = &g_stru_mem_block[size];
+    memory_block *block = &g_stru_mem_block[size];
+    tde_magazine *mag = HI_NULL;
+    hi_ulong offset;
+    hi_u16 index;
 
-    if (((hi_u8 *)ptr < (hi_u8 *)block->start_addr) ||
+    /* the pool layout never changes after wmeminit, so the owner is found without any lock */
+    if ((block->n_unit_size == 0) || ((hi_u8 *)ptr < (hi_u8 *)block->start_addr) ||
         ((hi_u8 *)ptr >= ((hi_u8 *)block->start_addr + block->n_size))) {
-        tde_spin_unlock(&g_mem_lock, lockflags);
         return HI_FAILURE;
     }
+    offset = (hi_ulong)((hi_u8 *)ptr - (hi_u8 *)block->start_addr);
+    if ((offset % block->n_unit_size) != 0) {
+        tde_error("free misaligned unit 0x%pK!\n", ptr);
+        return HI_FAILURE;
+    }
+    index = (hi_u16)(offset / block->n_unit_size);
 
-    block->n_free++;
-    *(hi_u16 *)ptr = block->n_first; /* point to next unit can be assigned */
-
-    if (block->n_unit_size == 0) {
+    if (block->n_mag_size == 0) {
+        tde_spin_lock(&g_mem_lock, lockflags);
+        memory_block_push(block, index);
         tde_spin_unlock(&g_mem_lock, lockflags);
-        return HI_FAILURE;
+        return HI_SUCCESS;
     }
-    block->n_first = (hi_u16)(((hi_u8 *)ptr - (hi_u8 *)(block->start_addr)) / block->n_unit_size);
 
-    tde_info("eUnitSize:%hu,first free unit:%hu, free units:%hu\n", block->n_unit_size, block->n_first, block->n_free);
-    tde_spin_unlock(&g_mem_lock, lockflags);
+    mag = &g_mem_mag[size][tde_mem_cpu_id()];
+    tde_spin_lock(&mag->lock, lockflags);
+    if (mag->count >= block->n_mag_size) {
+        magazine_drain(block, mag);
+    }
+    mag->unit[mag->count++] = index;
+    tde_spin_unlock(&mag->lock, lockflags);
     return HI_SUCCESS;
 }
 
@@ -204,6 +328,18 @@ static hi_s32 wfree(hi_void *ptr)
     return HI_FAILURE;
 }
 
+/* units parked in the magazines are free as well */
+static hi_u32 wgetcachednum(unit_size size)
+{
+    hi_u32 cached = 0;
+    hi_u32 i;
+
+    for (i = 0; i < TDE_MEM_MAX_CPU; i++) {
+        cached += g_mem_mag[size][i].count;
+    }
+    return cached;
+}
+
 hi_void *tde_malloc(hi_u32 size)
 {
     hi_void *ptr = HI_NULL;
@@ -258,6 +394,28 @@ hi_void tde_init_set_buf(hi_u32 temp_buf)
     g_tde_buf = temp_buf;
 }
 
+static hi_void wmem_mag_lock_init(hi_void)
+{
+    hi_u32 i, j;
+
+    for (i = 0; i < UNIT_SIZE_BUTT; i++) {
+        for (j = 0; j < TDE_MEM_MAX_CPU; j++) {
+            osal_spin_lock_init(&g_mem_mag[i][j].lock);
+        }
+    }
+}
+
+static hi_void wmem_mag_lock_destroy(hi_void)
+{
+    hi_u32 i, j;
+
+    for (i = 0; i < UNIT_SIZE_BUTT; i++) {
+        for (j = 0; j < TDE_MEM_MAX_CPU; j++) {
+            osal_spin_lock_destroy(&g_mem_mag[i][j].lock);
+        }
+    }
+}
+
 hi_s32 wmeminit(void)
 {
     hi_s32 ret;
@@ -306,6 +464,7 @@ hi_s32 wmeminit(void)
     if (ret != HI_SUCCESS) {
     }
     osal_spin_lock_init(&g_mem_lock);
+    wmem_mag_lock_init();
     print_mem_info();
 
     return HI_SUCCESS;
@@ -321,6 +480,7 @@ hi_void wmemterm(void)
     g_mem_poolphy_addr = 0;
     g_mem_pool_vrt_addr = HI_NULL;
 #ifndef HI_BUILD_IN_BOOT
+    wmem_mag_lock_destroy();
     osal_spin_lock_destroy(&g_mem_lock);
 #endif
     return;
@@ -351,11 +511,12 @@ hi_void *wgetvrt(hi_u64 phyaddr)
 hi_u32 wgetfreenum(hi_void)
 {
     unit_size size = 0;
-    hi_u32 free_unit_num = g_stru_mem_block[size].n_free;
+    hi_u32 free_unit_num = g_stru_mem_block[size].n_free + wgetcachednum(size);
+    hi_u32 free_num;
 
     for (size = UNIT_SIZE_CMD; size < UNIT_SIZE_FILTER; size++) {
-        free_unit_num = (free_unit_num > g_stru_mem_block[size].n_free) ? g_stru_mem_block[size].n_free :
-                         free_unit_num;
+        free_num = g_stru_mem_block[size].n_free + wgetcachednum(size);
+        free_unit_num = (free_unit_num > free_num) ? free_num : free_unit_num;
     }
 
     return free_unit_num;
@@ -366,48 +527,30 @@ hi_u32 wgetfreenum(hi_void)
 #ifdef CONFIG_HI_PROC_SHOW_SUPPORT
 osal_proc_entry_t *wprintinfo(osal_proc_entry_t *page)
 {
-#if HI_TDE_MEMCOUNT_SUPPORT
-    hi_u32 max_used_cmd, max_used_job, max_used_node, max_used_filter;
-#else
-    hi_u32 free_cmd, free_job, free_node, free_filter;
-#endif
+    unit_size size;
+    memory_block *block = HI_NULL;
+    hi_u32 cached;
+    hi_u32 used;
+    hi_u32 used_bytes = 0;
+    hi_u32 max_used_bytes = 0;
+
     if (page == HI_NULL) {
         return HI_SUCCESS;
     }
 
-#if HI_TDE_MEMCOUNT_SUPPORT
-    max_used_cmd = g_stru_mem_block[UNIT_SIZE_CMD].n_max_used;
-    max_used_job = g_stru_mem_block[UNIT_SIZE_JOB].n_max_used;
-    max_used_node = g_stru_mem_block[UNIT_SIZE_NODE].n_max_used;
-    max_used_filter = g_stru_mem_block[UNIT_SIZE_FILTER].n_max_used;
-#else
-    free_cmd = g_stru_mem_block[UNIT_SIZE_CMD].n_free;
-    free_job = g_stru_mem_block[UNIT_SIZE_JOB].n_free;
-    free_node = g_stru_mem_block[UNIT_SIZE_NODE].n_free;
-    free_filter = g_stru_mem_block[UNIT_SIZE_FILTER].n_free;
-#endif
     osal_seq_printf(page, "--------- Hisilicon TDE Memory Pool Info ---------\n");
-#if HI_TDE_MEMCOUNT_SUPPORT
-    osal_seq_printf(page, "     Type         Total       MaxUsed\n");
-    osal_seq_printf(page, "[Unit %d ]   %8u  %8u\n", CMD_SIZE, HI_TDE_CMD_NUM, max_used_cmd);
-    osal_seq_printf(page, "[Unit %d ]   %8u  %8u\n", JOB_SIZE, HI_TDE_JOB_NUM, max_used_job);
-    osal_seq_printf(page, "[Unit %d]   %8u  %8u\n", NODE_SIZE, HI_TDE_NODE_NUM, max_used_job);
-    osal_seq_printf(page, "[Unit%d]   %8u  %8u\n", FILTER_SIZE, HI_TDE_FILTER_NUM, max_used_filter);
-    osal_seq_printf(page, "[Total   ]   %8uK %8uK\n", TDE_MEMPOOL_SIZE / 1024, /* 1024 Demotion byte */
-                    (CMD_SIZE * max_used_cmd + JOB_SIZE * max_used_job + NODE_SIZE * max_used_node + FILTER_SIZE *
-                     max_used_filter) / 1024); /* 1024 Demotion byte */
-#else
-    osal_seq_printf(page, "     Type         Total       Used\n");
-    osal_seq_printf(page, "[Unit %d ]   %8lld  %8lld\n", CMD_SIZE, HI_TDE_CMD_NUM, HI_TDE_CMD_NUM - free_cmd);
-    osal_seq_printf(page, "[Unit %d ]   %8lld  %8lld\n", JOB_SIZE, HI_TDE_JOB_NUM, HI_TDE_JOB_NUM - free_job);
-    osal_seq_printf(page, "[Unit %ld]   %8lld  %8lld\n", (unsigned long)NODE_SIZE, HI_TDE_NODE_NUM,
-                    HI_TDE_NODE_NUM - free_node);
-    osal_seq_printf(page, "[Unit%d]   %8d  %8d\n", FILTER_SIZE, HI_TDE_FILTER_NUM, HI_TDE_FILTER_NUM - free_filter);
-    osal_seq_printf(page, "[Total   ]   %8lldK %8lldK\n", TDE_MEMPOOL_SIZE / 1024, /* 1024 Demotion byte */
-                    (TDE_MEMPOOL_SIZE - (CMD_SIZE * free_cmd + JOB_SIZE * free_job + NODE_SIZE * free_node +
-                    FILTER_SIZE * free_filter)) / 1024); /* 1024 Demotion byte */
-
-#endif
+    osal_seq_printf(page, "     Type         Total      Used    Cached   MaxUsed   MagSize\n");
+    for (size = UNIT_SIZE_CMD; size < UNIT_SIZE_BUTT; size++) {
+        block = &g_stru_mem_block[size];
+        cached = wgetcachednum(size);
+        used = block->n_max_num - block->n_free - cached;
+        used_bytes += used * block->n_unit_size;
+        max_used_bytes += block->n_max_used * block->n_unit_size;
+        osal_seq_printf(page, "[Unit %4u]   %8u  %8u  %8u  %8u  %8u\n", block->n_unit_size, block->n_max_num,
+                        used, cached, block->n_max_used, block->n_mag_size);
+    }
+    osal_seq_printf(page, "[Total    ]   %8lluK %8uK %18uK\n", (hi_u64)TDE_MEMPOOL_SIZE / 1024, /* 1024 Demotion byte */
+                    used_bytes / 1024, max_used_bytes / 1024); /* 1024 Demotion byte */
     return page;
 }
 #endif
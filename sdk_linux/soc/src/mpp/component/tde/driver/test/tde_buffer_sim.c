@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host simulation of the TDE temp buffer (src/include/tde_buffer.h) and its
+ * deferred free queue (tde_osi_list_get_phy_buff/put_phy_buff in
+ * src/src/tde_osilist.c). Storms of job bursts, each followed by an idle TDE,
+ * take the buffer from task or interrupt context, complete in random order and
+ * have their releases drained by the work at random points; an MMZ allocation may also race with another one,
+ * as the buffer lock is dropped around it. Both with and without the
+ * g_bTdeTmpBufReserve reservation it checks that:
+ * - every address handed out lies in the one live MMZ buffer;
+ * - an unreserved buffer is never taken in interrupt;
+ * - once the storm is drained, no reference is left and every MMZ buffer was
+ *   freed, a reserved one only at unload.
+ * It also prints how many MMZ allocations each mode costs per storm.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hi_type.h"
+
+/* host stand-ins of tde_define.h and hi_osal.h, only what tde_buffer.h uses */
+#define __TDE_DEFINE_H__
+#define __HI_OSAL__
+#define MMB_ADDR_INVALID 1
+#define hi_unused(x) ((hi_void)(x))
+#define tde_warning(fmt...)
+#define tde_error(fmt...)
+#define osal_printk(fmt...)
+
+typedef struct {
+    hi_u32 locked;
+} osal_spinlock_t;
+
+static hi_u32 g_sim_lock_fail = 0;
+
+#define tde_spin_lock(lock, flag) do { \
+    g_sim_lock_fail += ((lock)->locked != 0); \
+    (lock)->locked = 1; \
+    (flag) = 0; \
+} while (0)
+#define tde_spin_unlock(lock, flag) do { \
+    g_sim_lock_fail += ((lock)->locked == 0); \
+    (lock)->locked = 0; \
+    hi_unused(flag); \
+} while (0)
+
+static hi_u32 tde_sim_mmz_malloc(hi_u32 size);
+static hi_void tde_sim_mmz_free(hi_u32 phy_addr);
+
+#define tde_get_phyaddr_mmb(bufname, size, phyaddr) do { \
+    hi_unused(bufname); \
+    (phyaddr) = tde_sim_mmz_malloc(size); \
+} while (0)
+#define tde_free_mmb(phyaddr) tde_sim_mmz_free(phyaddr)
+
+#include "tde_buffer.h"
+
+#define TDE_SIM_BUF_SIZE    1658880 /* g_u32TdeTmpBuf default */
+#define TDE_SIM_MMZ_BASE    0x90000000
+#define TDE_SIM_JOB_MAX     64      /* jobs in flight */
+#define TDE_SIM_STORM_JOBS  20000
+#define TDE_SIM_BURST_MAX   256     /* jobs submitted before the TDE goes idle */
+#define TDE_SIM_STORMS      8
+
+typedef struct {
+    hi_u32 allocs;
+    hi_u32 frees;
+    hi_u32 live;
+    hi_u32 live_addr[2]; /* the buffer and the one of a racing allocation */
+    hi_u32 next_addr;
+    hi_u32 race_pct;     /* chance that another CPU allocates meanwhile */
+    hi_bool racing;
+    hi_u32 race_refs;    /* references taken by the racing CPU, put back with the next completion */
+} tde_sim_mmz;
+
+typedef struct {
+    hi_u32 pending;      /* g_tde_buff_free_queue.pending */
+    hi_u32 deferred;
+    hi_u32 get_fail_in_irq;
+} tde_sim_queue;
+
+typedef struct {
+    hi_u32 buff_num;     /* temp buffer references held by the job nodes */
+} tde_sim_job;
+
+static tde_sim_mmz g_sim_mmz;
+static tde_sim_queue g_sim_queue;
+static hi_u32 g_sim_fail = 0;
+
+#define tde_sim_check(cond, name) do { \
+    if (!(cond)) { \
+        printf("FAIL %s (%s:%d)\n", name, __FILE__, __LINE__); \
+        g_sim_fail++; \
+    } \
+} while (0)
+
+static hi_u32 tde_sim_rand(hi_u32 n)
+{
+    return (hi_u32)rand() % n;
+}
+
+static hi_u32 tde_sim_get_phy_buff(hi_bool in_irq, hi_u32 cb_cr_offset);
+
+static hi_u32 tde_sim_mmz_malloc(hi_u32 size)
+{
+    hi_u32 phy_addr = g_sim_mmz.next_addr;
+
+    tde_sim_check(size == TDE_SIM_BUF_SIZE, "mmz size");
+    tde_sim_check(g_tde_buff_lock.locked == 0, "mmz allocated under the buffer lock");
+    tde_sim_check(g_sim_mmz.live < 2, "more than two buffers live"); /* 2: the buffer and a racing one */
+    g_sim_mmz.next_addr += 0x200000; /* 0x200000: a fresh address per allocation */
+    g_sim_mmz.live_addr[g_sim_mmz.live++] = phy_addr;
+    g_sim_mmz.allocs++;
+    /* another CPU gets the buffer while this one sleeps in MMZ */
+    if (!g_sim_mmz.racing && (tde_sim_rand(100) < g_sim_mmz.race_pct)) { /* 100: percent */
+        g_sim_mmz.racing = HI_TRUE;
+        g_sim_mmz.race_refs += (tde_sim_get_phy_buff(HI_FALSE, 0) != 0);
+        g_sim_mmz.racing = HI_FALSE;
+    }
+    return phy_addr;
+}
+
+static hi_void tde_sim_mmz_free(hi_u32 phy_addr)
+{
+    hi_u32 i;
+
+    tde_sim_check(g_tde_buff_lock.locked == 0, "mmz freed under the buffer lock");
+    for (i = 0; i < g_sim_mmz.live; i++) {
+        if (g_sim_mmz.live_addr[i] == phy_addr) {
+            g_sim_mmz.live_addr[i] = g_sim_mmz.live_addr[--g_sim_mmz.live];
+            g_sim_mmz.frees++;
+            return;
+        }
+    }
+    tde_sim_check(0, "mmz free of a buffer not allocated");
+}
+
+/* tde_osi_list_get_phy_buff */
+static hi_u32 tde_sim_get_phy_buff(hi_bool in_irq, hi_u32 cb_cr_offset)
+{
+    if (in_irq && !tde_physic_buff_reserved()) {
+        g_sim_queue.get_fail_in_irq++;
+        return 0;
+    }
+    return tde_alloc_physic_buff(cb_cr_offset);
+}
+
+/* tde_osi_list_put_phy_buff, the work is scheduled and runs at a later tde_sim_work() */
+static hi_void tde_sim_put_phy_buff(hi_u32 buff_num)
+{
+    hi_u32 i;
+
+    if (buff_num == 0) {
+        return;
+    }
+    if (tde_physic_buff_reserved()) {
+        for (i = 0; i < buff_num; i++) {
+            tde_free_physic_buff();
+        }
+        return;
+    }
+    g_sim_queue.pending += buff_num;
+}
+
+/* tde_osi_list_free_phy_buff_work */
+static hi_void tde_sim_work(hi_void)
+{
+    while (g_sim_queue.pending > 0) {
+        g_sim_queue.pending--;
+        tde_free_physic_buff();
+        g_sim_queue.deferred++;
+    }
+}
+
+static hi_void tde_sim_check_addr(hi_u32 phy_addr, hi_u32 cb_cr_offset)
+{
+    hi_u32 i;
+
+    for (i = 0; i < g_sim_mmz.live; i++) {
+        if (phy_addr == g_sim_mmz.live_addr[i] + cb_cr_offset) {
+            tde_sim_check(g_sim_mmz.live_addr[i] == g_tde_phy_buff, "address of a buffer about to be freed");
+            return;
+        }
+    }
+    tde_sim_check(0, "address outside every live buffer");
+}
+
+static hi_void tde_sim_submit(tde_sim_job *job)
+{
+    hi_u32 nodes = 1 + tde_sim_rand(4); /* 4: nodes per job */
+    hi_bool in_irq = (tde_sim_rand(4) == 0); /* 4: a quarter is built from the completion interrupt */
+    hi_u32 i;
+    hi_u32 cb_cr_offset;
+    hi_u32 phy_addr;
+
+    job->buff_num = 0;
+    for (i = 0; i < nodes; i++) {
+        if (tde_sim_rand(2) == 0) { /* 2: half of the nodes need a color space conversion */
+            continue;
+        }
+        /* 3: the offset must leave room for the three planes */
+        cb_cr_offset = tde_sim_rand(TDE_SIM_BUF_SIZE / 3 + 0x1000) & ~0xfu; /* 0x1000: also too big offsets */
+        phy_addr = tde_sim_get_phy_buff(in_irq, cb_cr_offset);
+        if (phy_addr == 0) {
+            tde_sim_check((in_irq && !tde_physic_buff_reserved()) || (cb_cr_offset * 3 > TDE_SIM_BUF_SIZE),
+                "buffer refused");
+            continue;
+        }
+        tde_sim_check(!in_irq || tde_physic_buff_reserved(), "unreserved buffer taken in interrupt");
+        tde_sim_check_addr(phy_addr, cb_cr_offset);
+        job->buff_num++;
+    }
+}
+
+static hi_void tde_sim_storm(hi_bool reserve, hi_u32 seed)
+{
+    tde_sim_job jobs[TDE_SIM_JOB_MAX] = {{0}};
+    hi_u32 in_flight = 0;
+    hi_u32 submitted = 0;
+    hi_u32 burst = 0;
+    hi_u32 idx;
+
+    srand(seed);
+    (hi_void)memset(&g_sim_mmz, 0, sizeof(g_sim_mmz));
+    (hi_void)memset(&g_sim_queue, 0, sizeof(g_sim_queue));
+    g_sim_mmz.next_addr = TDE_SIM_MMZ_BASE;
+    g_tde_buff_ref_max = 0;
+    tde_set_tde_tmp_buffer(TDE_SIM_BUF_SIZE);
+    tde_set_tde_tmp_buffer_reserve(reserve);
+    tde_reserve_physic_buff();
+    tde_sim_check(tde_physic_buff_reserved() == reserve, "reservation at init");
+    g_sim_mmz.race_pct = 20; /* 20: percent of MMZ allocations raced, none at init */
+
+    while ((submitted < TDE_SIM_STORM_JOBS) || (in_flight > 0)) {
+        if ((burst == 0) && (in_flight == 0)) {
+            /* idle, the work has released everything before the next burst */
+            tde_sim_work();
+            burst = 1 + tde_sim_rand(TDE_SIM_BURST_MAX);
+        }
+        if ((burst > 0) && (submitted < TDE_SIM_STORM_JOBS) && (in_flight < TDE_SIM_JOB_MAX) &&
+            ((in_flight == 0) || (tde_sim_rand(3) != 0))) { /* 3: submit twice as often as complete */
+            tde_sim_submit(&jobs[in_flight++]);
+            submitted++;
+            burst--;
+        } else {
+            /* jobs of several handles complete out of submit order */
+            idx = tde_sim_rand(in_flight);
+            tde_sim_put_phy_buff(jobs[idx].buff_num);
+            jobs[idx] = jobs[--in_flight];
+            tde_sim_put_phy_buff(g_sim_mmz.race_refs);
+            g_sim_mmz.race_refs = 0;
+            burst = (submitted < TDE_SIM_STORM_JOBS) ? burst : 0;
+        }
+        if (tde_sim_rand(16) == 0) { /* 16: the work runs now and then */
+            tde_sim_work();
+        }
+        tde_sim_check(g_sim_lock_fail == 0, "buffer lock unbalanced");
+    }
+    tde_sim_work();
+
+    tde_sim_check(g_tde_buff_ref == 0, "reference left after the storm");
+    tde_sim_check(reserve ? (g_sim_mmz.live == 1) : (g_sim_mmz.live == 0), "mmz live after the storm");
+    tde_sim_check(reserve || (g_tde_phy_buff == 0), "unreserved buffer kept");
+    tde_sim_check(!reserve || (g_sim_mmz.allocs == 1), "reserved buffer allocated again");
+    tde_sim_check(!reserve || (g_sim_queue.deferred == 0), "reserved buffer deferred");
+    tde_unreserve_physic_buff();
+    tde_sim_check((g_sim_mmz.live == 0) && (g_sim_mmz.allocs == g_sim_mmz.frees), "mmz leaked at unload");
+
+    printf("%-10s seed %2u: mmz alloc %5u free %5u, max ref %3u, deferred %6u, refused in irq %5u\n",
+        reserve ? "reserved" : "on demand", seed, g_sim_mmz.allocs, g_sim_mmz.frees, g_tde_buff_ref_max,
+        g_sim_queue.deferred, g_sim_queue.get_fail_in_irq);
+}
+
+int main(hi_void)
+{
+    hi_u32 seed;
+
+    for (seed = 1; seed <= TDE_SIM_STORMS; seed++) {
+        tde_sim_storm(HI_FALSE, seed);
+        tde_sim_storm(HI_TRUE, seed);
+    }
+    printf("%u check(s) failed\n", g_sim_fail);
+    return (g_sim_fail == 0) ? 0 : 1;
+}
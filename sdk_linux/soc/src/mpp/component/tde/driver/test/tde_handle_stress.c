@@ -0,0 +1,425 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host stress test of the TDE job handles (src/src/tde_handle.c) and of
+ * tde_free_pending_job in src/src/tde_osilist.c, both linked as they are, on
+ * pthreads. Every client thread begins a burst of jobs, cancels some of them
+ * and leaves the rest to tde_free_pending_job as a closing process does, all
+ * while the other clients do the same on the shared handle list. It checks
+ * that:
+ * - a client's free never takes a job of another client, nor leaves one of its own;
+ * - every job, handle and wait queue is freed once the clients are done;
+ * - no two locks are ever taken in both orders, and no lock is taken while the
+ *   handle list lock is held, so the handle list lock is the innermost one.
+ * Build it with -fsanitize=thread (make tsan) to have the list walks checked too.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tde_handle.h"
+
+#define TDE_STRESS_CLIENTS   4
+#define TDE_STRESS_ROUNDS    2000
+#define TDE_STRESS_BURST_MAX 32
+#define TDE_STRESS_LOCK_MAX  8
+
+typedef struct {
+    pthread_mutex_t mutex;
+    hi_u32 id;
+} tde_stress_lock;
+
+typedef struct {
+    hi_u32 seed;
+    hi_s32 handle[TDE_STRESS_BURST_MAX];
+    hi_bool cancelled[TDE_STRESS_BURST_MAX];
+} tde_stress_client;
+
+static pthread_mutex_t g_stress_mutex = PTHREAD_MUTEX_INITIALIZER;
+static hi_u32 g_stress_lock_num = 0;
+static hi_u8 g_stress_order[TDE_STRESS_LOCK_MAX][TDE_STRESS_LOCK_MAX]; /* [held][taken] */
+static __thread hi_u32 g_stress_held[TDE_STRESS_LOCK_MAX];
+static __thread hi_u32 g_stress_held_num = 0;
+static hi_s32 g_stress_mem_live = 0;
+static hi_s32 g_stress_wait_live = 0;
+static hi_u32 g_fail = 0;
+
+#define tool_check(cond, name) do { \
+    if (!(cond)) { \
+        pthread_mutex_lock(&g_stress_mutex); \
+        printf("FAIL %s (%s:%d)\n", name, __FILE__, __LINE__); \
+        g_fail++; \
+        pthread_mutex_unlock(&g_stress_mutex); \
+    } \
+} while (0)
+
+/* host stand-ins of the osal calls the two files make */
+int osal_spin_lock_init(osal_spinlock_t *lock)
+{
+    tde_stress_lock *l = (tde_stress_lock *)calloc(1, sizeof(tde_stress_lock));
+
+    if (l == NULL) {
+        return -1;
+    }
+    pthread_mutex_init(&l->mutex, NULL);
+    pthread_mutex_lock(&g_stress_mutex);
+    l->id = g_stress_lock_num++;
+    pthread_mutex_unlock(&g_stress_mutex);
+    if (l->id >= TDE_STRESS_LOCK_MAX) {
+        printf("FAIL too many locks\n");
+        exit(1);
+    }
+    lock->lock = l;
+    return 0;
+}
+
+void osal_spin_lock_destroy(osal_spinlock_t *lock)
+{
+    tde_stress_lock *l = (tde_stress_lock *)lock->lock;
+
+    pthread_mutex_destroy(&l->mutex);
+    free(l);
+    lock->lock = NULL;
+}
+
+void osal_spin_lock_irqsave(osal_spinlock_t *lock, unsigned long *flags)
+{
+    tde_stress_lock *l = (tde_stress_lock *)lock->lock;
+    hi_u32 i;
+
+    for (i = 0; i < g_stress_held_num; i++) {
+        __atomic_store_n(&g_stress_order[g_stress_held[i]][l->id], 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_lock(&l->mutex);
+    g_stress_held[g_stress_held_num++] = l->id;
+    *flags = 0;
+}
+
+void osal_spin_unlock_irqrestore(osal_spinlock_t *lock, const unsigned long *flags)
+{
+    tde_stress_lock *l = (tde_stress_lock *)lock->lock;
+    hi_u32 i;
+
+    for (i = 0; (i < g_stress_held_num) && (g_stress_held[i] != l->id); i++) {
+    }
+    tool_check(i < g_stress_held_num, "unlock of a lock not held");
+    for (; i + 1 < g_stress_held_num; i++) {
+        g_stress_held[i] = g_stress_held[i + 1];
+    }
+    g_stress_held_num--;
+    pthread_mutex_unlock(&l->mutex);
+}
+
+void *osal_vmalloc(unsigned long size)
+{
+    return malloc(size);
+}
+
+void osal_vfree(const void *addr)
+{
+    free((void *)addr);
+}
+
+void *osal_kmalloc(unsigned long size, unsigned int osal_gfp_flag)
+{
+    return malloc(size);
+}
+
+void osal_kfree(const void *addr)
+{
+    free((void *)addr);
+}
+
+/* wmalloc hands out zeroed memory */
+hi_void *tde_malloc(hi_u32 size)
+{
+    __atomic_add_fetch(&g_stress_mem_live, 1, __ATOMIC_RELAXED);
+    return calloc(1, size);
+}
+
+hi_void tde_free(hi_void *ptr)
+{
+    __atomic_sub_fetch(&g_stress_mem_live, 1, __ATOMIC_RELAXED);
+    free(ptr);
+}
+
+hi_u64 wgetphy(hi_void *ptr)
+{
+    return (hi_u64)(uintptr_t)ptr;
+}
+
+hi_void *wgetvrt(hi_u64 phyaddr)
+{
+    return (hi_void *)(uintptr_t)phyaddr;
+}
+
+hi_u32 wgetfreenum(hi_void)
+{
+    return 0;
+}
+
+int osal_wait_init(osal_wait_t *wait)
+{
+    __atomic_add_fetch(&g_stress_wait_live, 1, __ATOMIC_RELAXED);
+    wait->wait = wait;
+    return 0;
+}
+
+void osal_wait_destroy(osal_wait_t *wait)
+{
+    tool_check(wait->wait == wait, "wait queue destroyed twice");
+    __atomic_sub_fetch(&g_stress_wait_live, 1, __ATOMIC_RELAXED);
+    wait->wait = NULL;
+}
+
+int osal_wait_timeout_interruptible(osal_wait_t *wait, osal_wait_cond_func_t func, const void *param,
+    unsigned long ms)
+{
+    return 0;
+}
+
+int osal_wait_timeout_uninterruptible(osal_wait_t *wait, osal_wait_cond_func_t func, const void *param,
+    unsigned long ms)
+{
+    return 0;
+}
+
+void osal_wakeup(osal_wait_t *wait)
+{
+}
+
+unsigned long osal_msecs_to_jiffies(const unsigned int m)
+{
+    return m;
+}
+
+void osal_smp_rmb(void)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+void osal_smp_wmb(void)
+{
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+int osal_atomic_init(osal_atomic_t *atomic)
+{
+    atomic->atomic = calloc(1, sizeof(int));
+    return (atomic->atomic == NULL) ? -1 : 0;
+}
+
+void osal_atomic_destroy(osal_atomic_t *atomic)
+{
+    free(atomic->atomic);
+    atomic->atomic = NULL;
+}
+
+int osal_atomic_read(osal_atomic_t *v)
+{
+    return __atomic_load_n((int *)v->atomic, __ATOMIC_RELAXED);
+}
+
+int osal_atomic_inc_return(osal_atomic_t *v)
+{
+    return __atomic_add_fetch((int *)v->atomic, 1, __ATOMIC_RELAXED);
+}
+
+int osal_atomic_dec_return(osal_atomic_t *v)
+{
+    return __atomic_sub_fetch((int *)v->atomic, 1, __ATOMIC_RELAXED);
+}
+
+int osal_init_work(struct osal_work_struct *work, osal_work_func_t func)
+{
+    work->func = func;
+    return 0;
+}
+
+int osal_schedule_work(struct osal_work_struct *work)
+{
+    work->func(work);
+    return 0;
+}
+
+int osal_cancel_work_sync(struct osal_work_struct *work)
+{
+    return 0;
+}
+
+void osal_destroy_work(struct osal_work_struct *work)
+{
+}
+
+int osal_in_interrupt(void)
+{
+    return 0;
+}
+
+void osal_flush_dcache_area(void *kvirt, unsigned long phys_addr, unsigned long length)
+{
+}
+
+int osal_printk(const char *fmt, ...)
+{
+    return 0;
+}
+
+void osal_seq_printf(osal_proc_entry_t *entry, const char *fmt, ...)
+{
+}
+
+unsigned long long cmpi_mmz_malloc(const char *mmz_name, const char *buf_name, unsigned long ul_size)
+{
+    return MMB_ADDR_INVALID;
+}
+
+void cmpi_mmz_free(unsigned long long phy_addr, void *vir_addr)
+{
+}
+
+/* no job of this test reaches the hardware */
+hi_bool tde_hal_ctl_is_idle_safely(hi_void)
+{
+    return HI_TRUE;
+}
+
+hi_u32 tde_hal_ctl_int_status(hi_void)
+{
+    return 0;
+}
+
+hi_void tde_hal_node_enable_complete_int(hi_void *buf)
+{
+}
+
+hi_void tde_hal_next_node_addr(hi_void *buf, hi_u64 phy_addr)
+{
+}
+
+hi_s32 tde_hal_node_execute(hi_u64 nodephy_addr, hi_u64 update, hi_bool aq_use_buff)
+{
+    return HI_SUCCESS;
+}
+
+hi_u64 tde_hal_cur_node(hi_void)
+{
+    return 0;
+}
+
+static hi_u32 tde_stress_rand(hi_u32 *seed, hi_u32 n)
+{
+    *seed = *seed * 1103515245 + 12345; /* LCG, one stream per client */
+    return (*seed >> 16) % n;
+}
+
+static hi_void tde_stress_round(tde_stress_client *client)
+{
+    hi_handle_mgr *res = HI_NULL;
+    hi_u32 burst = 1 + tde_stress_rand(&client->seed, TDE_STRESS_BURST_MAX);
+    hi_u32 i;
+
+    for (i = 0; i < burst; i++) {
+        tool_check(tde_osi_list_begin_job(&client->handle[i], client) == HI_SUCCESS, "begin job");
+        client->cancelled[i] = HI_FALSE;
+    }
+    for (i = 0; i < burst; i++) {
+        if (tde_stress_rand(&client->seed, 4) == 0) { /* 4: cancel one job in four */
+            tool_check(tde_osi_list_cancel_job(client->handle[i]) == HI_SUCCESS, "cancel job");
+            client->cancelled[i] = HI_TRUE;
+        }
+    }
+    /* the other clients freed theirs meanwhile, never one of these */
+    for (i = 0; i < burst; i++) {
+        if (client->cancelled[i]) {
+            tool_check(!tde_query_handle(client->handle[i], &res), "cancelled job gone");
+            continue;
+        }
+        if (!tde_query_handle(client->handle[i], &res)) {
+            tool_check(0, "job kept until its client frees it");
+            continue;
+        }
+        tool_check(((tde_swjob *)res->res)->private_data == client, "job still owned by its client");
+    }
+    tde_free_pending_job(client);
+    for (i = 0; i < burst; i++) {
+        tool_check(!tde_query_handle(client->handle[i], &res), "pending job freed");
+    }
+}
+
+static hi_void *tde_stress_client_run(hi_void *arg)
+{
+    tde_stress_client *client = (tde_stress_client *)arg;
+    hi_u32 round;
+
+    for (round = 0; round < TDE_STRESS_ROUNDS; round++) {
+        tde_stress_round(client);
+    }
+    return HI_NULL;
+}
+
+static hi_void tde_stress_check_order(hi_void)
+{
+    tde_stress_lock *handle_lock = (tde_stress_lock *)tde_get_handle_list()->lock.lock;
+    hi_u32 nested = 0;
+    hi_u32 i;
+    hi_u32 j;
+
+    for (i = 0; i < g_stress_lock_num; i++) {
+        tool_check(!g_stress_order[handle_lock->id][i], "no lock taken under the handle list lock");
+        for (j = 0; j < g_stress_lock_num; j++) {
+            nested += g_stress_order[i][j];
+            tool_check(!(g_stress_order[i][j] && g_stress_order[j][i]), "no lock pair taken in both orders");
+        }
+    }
+    tool_check(nested != 0, "lock nesting exercised");
+    printf("%u lock(s), %u nesting order(s) seen\n", g_stress_lock_num, nested);
+}
+
+int main(hi_void)
+{
+    static tde_stress_client client[TDE_STRESS_CLIENTS];
+    pthread_t thread[TDE_STRESS_CLIENTS];
+    hi_u32 i;
+
+    if (tde_osi_list_init() != HI_SUCCESS) {
+        printf("FAIL tde_osi_list_init\n");
+        return 1;
+    }
+    for (i = 0; i < TDE_STRESS_CLIENTS; i++) {
+        client[i].seed = 0x7de0 + i;
+        pthread_create(&thread[i], NULL, tde_stress_client_run, &client[i]);
+    }
+    for (i = 0; i < TDE_STRESS_CLIENTS; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    tool_check(osal_list_empty(&tde_get_handle_list()->header), "handle list empty");
+    tde_stress_check_order();
+    tde_osi_list_term();
+    tool_check(g_stress_mem_live == 0, "every tde_malloc freed");
+    tool_check(g_stress_wait_live == 0, "every wait queue destroyed");
+
+    if (g_fail != 0) {
+        printf("%u check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
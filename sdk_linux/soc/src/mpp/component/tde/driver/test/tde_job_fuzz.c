@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Fuzz target of the TDE_SUBMIT_JOB command decoder (src/src/tde_job.c). The
+ * input is cut into drv_tde_job_op records as the ioctl copies them in, and
+ * every record the decoder accepts must name a known operation whose
+ * destination is a usable surface; anything else aborts. Built with
+ * -fsanitize=fuzzer it is a libFuzzer target; built without it, main() replays
+ * the files given on the command line (also the AFL entry point, @@), or runs
+ * the decoder self checks when there are none.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tde_job.h"
+
+static hi_bool tde_job_fuzz_dst_ok(const drv_tde_ioctl_surface *surface, const hi_tde_rect *rect)
+{
+    return (surface->phy_addr != 0) && (surface->stride != 0) && (surface->color_fmt < HI_TDE_COLOR_FMT_MAX) &&
+        (rect->pos_x >= 0) && ((hi_u32)rect->pos_x < surface->width) &&
+        (rect->pos_y >= 0) && ((hi_u32)rect->pos_y < surface->height) && (rect->width != 0) && (rect->height != 0);
+}
+
+static hi_bool tde_job_fuzz_accepted_ok(const drv_tde_job_op *op)
+{
+    switch (op->type) {
+        case DRV_TDE_JOB_OP_QUICK_COPY:
+            return tde_job_fuzz_dst_ok(&op->cmd.copy_cmd.dst_surface, &op->cmd.copy_cmd.dst_rect);
+        case DRV_TDE_JOB_OP_QUICK_FILL:
+            return tde_job_fuzz_dst_ok(&op->cmd.fill_cmd.dst_surface, &op->cmd.fill_cmd.dst_rect);
+        case DRV_TDE_JOB_OP_QUICK_RESIZE:
+            return tde_job_fuzz_dst_ok(&op->cmd.resize_cmd.dst_surface, &op->cmd.resize_cmd.dst_rect);
+        case DRV_TDE_JOB_OP_BIT_BLIT:
+            return tde_job_fuzz_dst_ok(&op->cmd.blit_cmd.dst_surface, &op->cmd.blit_cmd.dst_rect);
+        case DRV_TDE_JOB_OP_SOLID_DRAW:
+            return tde_job_fuzz_dst_ok(&op->cmd.draw_cmd.dst_surface, &op->cmd.draw_cmd.dst_rect);
+        case DRV_TDE_JOB_OP_ROTATE:
+            return tde_job_fuzz_dst_ok(&op->cmd.rotate_cmd.dst_surface, &op->cmd.rotate_cmd.dst_rect);
+        default:
+            return HI_FALSE;
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    drv_tde_job_op op;
+    size_t num = size / sizeof(drv_tde_job_op);
+    size_t i;
+
+    if (num > DRV_TDE_JOB_MAX_OP) {
+        num = DRV_TDE_JOB_MAX_OP;
+    }
+    for (i = 0; i < num; i++) {
+        /* copied out like osal_copy_from_user does, the input itself is not aligned */
+        (hi_void)memcpy(&op, data + i * sizeof(op), sizeof(op));
+        if (tde_job_check_op(&op) && !tde_job_fuzz_accepted_ok(&op)) {
+            printf("operation %zu of type %u accepted with an unusable destination\n", i, op.type);
+            abort();
+        }
+    }
+    return 0;
+}
+
+#ifndef TDE_JOB_FUZZ_LIBFUZZER
+static hi_u32 g_tde_job_fuzz_fail = 0;
+
+#define tde_job_fuzz_check(cond, name) do { \
+    if (!(cond)) { \
+        printf("FAIL %s (%s:%d)\n", name, __FILE__, __LINE__); \
+        g_tde_job_fuzz_fail++; \
+    } else { \
+        printf("ok   %s\n", name); \
+    } \
+} while (0)
+
+static hi_void tde_job_fuzz_surface(drv_tde_ioctl_surface *surface, hi_tde_rect *rect)
+{
+    surface->phy_addr = 0x80000000; /* any non zero address */
+    surface->color_fmt = HI_TDE_COLOR_FMT_ARGB8888;
+    surface->width = 64;  /* 64: surface width */
+    surface->height = 32; /* 32: surface height */
+    surface->stride = 64 * 4; /* 64 * 4: ARGB8888 line */
+    rect->pos_x = 0;
+    rect->pos_y = 0;
+    rect->width = 64;  /* 64: whole surface */
+    rect->height = 32; /* 32: whole surface */
+}
+
+static hi_void tde_job_fuzz_self_check(hi_void)
+{
+    drv_tde_job_op op;
+
+    (hi_void)memset(&op, 0, sizeof(op));
+    op.type = DRV_TDE_JOB_OP_QUICK_FILL;
+    tde_job_fuzz_surface(&op.cmd.fill_cmd.dst_surface, &op.cmd.fill_cmd.dst_rect);
+    tde_job_fuzz_check(tde_job_check_op(&op), "fill accepted");
+    op.cmd.fill_cmd.dst_rect.pos_x = 64; /* 64: one past the last column */
+    tde_job_fuzz_check(!tde_job_check_op(&op), "fill outside the surface rejected");
+    op.cmd.fill_cmd.dst_rect.pos_x = -1;
+    tde_job_fuzz_check(!tde_job_check_op(&op), "negative position rejected");
+    op.cmd.fill_cmd.dst_rect.pos_x = 0;
+    op.cmd.fill_cmd.dst_surface.color_fmt = HI_TDE_COLOR_FMT_MAX;
+    tde_job_fuzz_check(!tde_job_check_op(&op), "unknown color format rejected");
+
+    (hi_void)memset(&op, 0, sizeof(op));
+    op.type = DRV_TDE_JOB_OP_BUTT;
+    tde_job_fuzz_surface(&op.cmd.fill_cmd.dst_surface, &op.cmd.fill_cmd.dst_rect);
+    tde_job_fuzz_check(!tde_job_check_op(&op), "unknown operation rejected");
+
+    (hi_void)memset(&op, 0, sizeof(op));
+    op.type = DRV_TDE_JOB_OP_BIT_BLIT;
+    tde_job_fuzz_surface(&op.cmd.blit_cmd.dst_surface, &op.cmd.blit_cmd.dst_rect);
+    op.cmd.blit_cmd.null_indicator = (1 << 1) | (1 << 3); /* 1, 3: no background, no foreground */
+    tde_job_fuzz_check(tde_job_check_op(&op), "blit without sources accepted");
+    op.cmd.blit_cmd.null_indicator = 1 << 1; /* 1: no background, foreground still read */
+    tde_job_fuzz_check(!tde_job_check_op(&op), "blit with an empty foreground rejected");
+
+    (hi_void)memset(&op, 0, sizeof(op));
+    op.type = DRV_TDE_JOB_OP_QUICK_COPY;
+    tde_job_fuzz_surface(&op.cmd.copy_cmd.dst_surface, &op.cmd.copy_cmd.dst_rect);
+    tde_job_fuzz_check(!tde_job_check_op(&op), "copy without a source rejected");
+}
+
+static hi_s32 tde_job_fuzz_replay(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    uint8_t *data = HI_NULL;
+    long size;
+
+    if (fp == HI_NULL) {
+        return HI_FAILURE;
+    }
+    if ((fseek(fp, 0, SEEK_END) != 0) || ((size = ftell(fp)) < 0) || (fseek(fp, 0, SEEK_SET) != 0) ||
+        ((data = malloc((size_t)size + 1)) == HI_NULL) || (fread(data, 1, (size_t)size, fp) != (size_t)size)) {
+        free(data);
+        fclose(fp);
+        return HI_FAILURE;
+    }
+    fclose(fp);
+    (hi_void)LLVMFuzzerTestOneInput(data, (size_t)size);
+    free(data);
+    return HI_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    int i;
+
+    if (argc == 1) {
+        tde_job_fuzz_self_check();
+        printf("%u check(s) failed\n", g_tde_job_fuzz_fail);
+        return (g_tde_job_fuzz_fail == 0) ? 0 : 1;
+    }
+    for (i = 1; i < argc; i++) {
+        if (tde_job_fuzz_replay(argv[i]) != HI_SUCCESS) {
+            printf("read %s failed\n", argv[i]);
+            return 1;
+        }
+    }
+    printf("%d input(s) decoded\n", argc - 1);
+    return 0;
+}
+#endif
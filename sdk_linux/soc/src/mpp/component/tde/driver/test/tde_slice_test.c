@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host checks of the TDE slice planner. Every destination width up to
+ * TDE_MAX_RECT_WIDTH_EX is planned against the 256-column slice limit used by
+ * tde_osi_calc_slice, plus a few other limits, and each plan must:
+ * - cover [0, width) with contiguous, non-empty slices;
+ * - keep every slice within the limit and start it on an even column;
+ * - use ceil(width / limit) slices, the node count of the fixed 256 split;
+ * - give every slice the same width, except the last, which loses at most
+ *   TDE_SLICE_ALIGN columns per slice to rounding.
+ */
+
+#include <stdio.h>
+#include "tde_slice.h"
+
+#define TDE_SLICE_TEST_WIDTH_MAX 0x2000 /* TDE_MAX_RECT_WIDTH_EX */
+#define TDE_SLICE_TEST_NUM_MAX   (TDE_SLICE_TEST_WIDTH_MAX / TDE_SLICE_ALIGN)
+
+static hi_u32 g_tde_slice_test_fail = 0;
+
+#define tde_slice_test_check(cond, name) do { \
+    if (!(cond)) { \
+        printf("FAIL %s (%s:%d)\n", name, __FILE__, __LINE__); \
+        g_tde_slice_test_fail++; \
+    } else { \
+        printf("ok   %s\n", name); \
+    } \
+} while (0)
+
+static tde_slice_range g_tde_slice_test_plan[TDE_SLICE_TEST_NUM_MAX];
+
+/* returns 0 when the plan of des_width against max_width satisfies every rule above */
+static hi_s32 tde_slice_test_plan_ok(hi_u32 des_width, hi_u32 max_width)
+{
+    hi_u32 num, i, width, first, limit;
+
+    limit = (des_width <= max_width) ? des_width : (max_width & ~(TDE_SLICE_ALIGN - 1));
+    num = tde_slice_plan(des_width, max_width, g_tde_slice_test_plan, TDE_SLICE_TEST_NUM_MAX);
+    if ((num == 0) || (num != (des_width + limit - 1) / limit)) {
+        return -1;
+    }
+    if ((g_tde_slice_test_plan[0].xst != 0) || (g_tde_slice_test_plan[num - 1].xed != des_width - 1)) {
+        return -1;
+    }
+    first = g_tde_slice_test_plan[0].xed + 1;
+    for (i = 0; i < num; i++) {
+        if (g_tde_slice_test_plan[i].xed < g_tde_slice_test_plan[i].xst) {
+            return -1;
+        }
+        width = g_tde_slice_test_plan[i].xed - g_tde_slice_test_plan[i].xst + 1;
+        if ((width > max_width) || ((i < num - 1) && (width != first)) ||
+            (width + TDE_SLICE_ALIGN * num < first)) {
+            return -1;
+        }
+        if ((i > 0) && ((g_tde_slice_test_plan[i].xst != g_tde_slice_test_plan[i - 1].xed + 1) ||
+            (g_tde_slice_test_plan[i].xst % TDE_SLICE_ALIGN != 0))) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static hi_void tde_slice_test_widths(hi_u32 max_width)
+{
+    hi_u32 des_width;
+    hi_u32 bad = 0;
+    char name[64]; /* 64: check name length */
+
+    for (des_width = 1; des_width <= TDE_SLICE_TEST_WIDTH_MAX; des_width++) {
+        if (tde_slice_test_plan_ok(des_width, max_width) != 0) {
+            if (bad == 0) {
+                printf("     first bad width %u for limit %u\n", des_width, max_width);
+            }
+            bad++;
+        }
+    }
+    (hi_void)snprintf(name, sizeof(name), "widths 1..%u, limit %u", TDE_SLICE_TEST_WIDTH_MAX, max_width);
+    tde_slice_test_check(bad == 0, name);
+}
+
+static hi_void tde_slice_test_examples(hi_void)
+{
+    hi_u32 num;
+
+    /* 1920 = 7 * 256 + 128: eight 240-column slices instead of seven full ones and a 128 tail */
+    num = tde_slice_plan(1920, 256, g_tde_slice_test_plan, TDE_SLICE_TEST_NUM_MAX); /* 1920, 256: 1080p, limit */
+    tde_slice_test_check((num == 8) && (g_tde_slice_test_plan[7].xst == 1680) && /* 8, 1680: 7 * 240 */
+        (g_tde_slice_test_plan[7].xed == 1919), "1920 in 8 slices of 240"); /* 1919: last column */
+
+    num = tde_slice_plan(257, 256, g_tde_slice_test_plan, TDE_SLICE_TEST_NUM_MAX); /* 257, 256: one over */
+    tde_slice_test_check((num == 2) && (g_tde_slice_test_plan[1].xst == 130), "257 in 130 + 127"); /* 130 */
+
+    num = tde_slice_plan(TDE_SLICE_TEST_WIDTH_MAX, 256, g_tde_slice_test_plan, /* 256: slice limit */
+        TDE_SLICE_TEST_WIDTH_MAX / 256); /* 256: slice limit */
+    tde_slice_test_check(num == TDE_SLICE_TEST_WIDTH_MAX / 256, "widest rect fits the plan array"); /* 256 */
+}
+
+static hi_void tde_slice_test_reject(hi_void)
+{
+    tde_slice_test_check(tde_slice_plan(0, 256, g_tde_slice_test_plan, TDE_SLICE_TEST_NUM_MAX) == 0, /* 256 */
+        "zero width rejected");
+    tde_slice_test_check(tde_slice_plan(100, 1, g_tde_slice_test_plan, TDE_SLICE_TEST_NUM_MAX) == 0, /* 100 */
+        "limit below the alignment rejected");
+    tde_slice_test_check(tde_slice_plan(1025, 256, g_tde_slice_test_plan, 4) == 0, /* 1025, 256, 4: 5 needed */
+        "too many slices rejected");
+}
+
+int main(int argc, char *argv[])
+{
+    static const hi_u32 limit[] = { 256, 2, 3, 255, 1024, 1920, 4096 }; /* 256: TDE_MAX_SLICE_WIDTH */
+    hi_u32 i;
+
+    for (i = 0; i < sizeof(limit) / sizeof(limit[0]); i++) {
+        tde_slice_test_widths(limit[i]);
+    }
+    tde_slice_test_examples();
+    tde_slice_test_reject();
+
+    printf("%u check(s) failed\n", g_tde_slice_test_fail);
+    return (g_tde_slice_test_fail == 0) ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host benchmark of the TDE software reference model, reports Mpixel/s for
+ * each operation and color format on a 1920x1080 surface.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tde_sw.h"
+
+#define TDE_SW_BENCH_WIDTH  1920
+#define TDE_SW_BENCH_HEIGHT 1080
+#define TDE_SW_BENCH_LOOP   10
+
+typedef enum {
+    TDE_SW_BENCH_FILL = 0,
+    TDE_SW_BENCH_COPY,
+    TDE_SW_BENCH_RESIZE,
+    TDE_SW_BENCH_BLEND,
+    TDE_SW_BENCH_ROTATE_90,
+    TDE_SW_BENCH_ROTATE_180,
+    TDE_SW_BENCH_OP_MAX
+} tde_sw_bench_op;
+
+typedef struct {
+    hi_tde_color_fmt fmt;
+    const char *name;
+    hi_u32 bytes;
+} tde_sw_bench_fmt;
+
+static const char *g_tde_sw_bench_op_name[TDE_SW_BENCH_OP_MAX] = {
+    "fill", "copy", "resize 2x", "blend srcover", "rotate 90", "rotate 180",
+};
+
+static const tde_sw_bench_fmt g_tde_sw_bench_fmt[] = {
+    { HI_TDE_COLOR_FMT_ARGB8888, "ARGB8888", 4 }, /* 4: bytes per pixel */
+    { HI_TDE_COLOR_FMT_RGB888,   "RGB888",   3 }, /* 3: bytes per pixel */
+    { HI_TDE_COLOR_FMT_RGB565,   "RGB565",   2 }, /* 2: bytes per pixel */
+    { HI_TDE_COLOR_FMT_ARGB1555, "ARGB1555", 2 }, /* 2: bytes per pixel */
+};
+
+static hi_void tde_sw_bench_surface(hi_tde_surface *surface, hi_u8 *buf, const tde_sw_bench_fmt *fmt,
+                                    hi_u32 width, hi_u32 height)
+{
+    (hi_void)memset(surface, 0, sizeof(*surface));
+    surface->phy_addr = (hi_u64)(hi_uintptr_t)buf;
+    surface->color_fmt = fmt->fmt;
+    surface->width = width;
+    surface->height = height;
+    surface->stride = (width * fmt->bytes + 0xf) & ~0xfU;
+    surface->alpha_max_is_255 = HI_TRUE;
+}
+
+static hi_s32 tde_sw_bench_run_once(tde_sw_bench_op op, const hi_tde_surface *src, const hi_tde_surface *dst,
+                                    const hi_tde_surface *rot)
+{
+    hi_tde_rect rect = { 0, 0, TDE_SW_BENCH_WIDTH, TDE_SW_BENCH_HEIGHT };
+    hi_tde_rect half = { 0, 0, TDE_SW_BENCH_WIDTH / 2, TDE_SW_BENCH_HEIGHT / 2 }; /* 2: resize source is half */
+    hi_tde_rect rot_rect = { 0, 0, TDE_SW_BENCH_HEIGHT, TDE_SW_BENCH_WIDTH };
+    hi_tde_opt opt;
+
+    switch (op) {
+        case TDE_SW_BENCH_FILL:
+            return tde_sw_quick_fill(dst, &rect, 0x5a);
+        case TDE_SW_BENCH_COPY:
+            return tde_sw_quick_copy(src, &rect, dst, &rect);
+        case TDE_SW_BENCH_RESIZE:
+            return tde_sw_quick_resize(src, &half, dst, &rect);
+        case TDE_SW_BENCH_BLEND:
+            (hi_void)memset(&opt, 0, sizeof(opt));
+            opt.alpha_blending_cmd = HI_TDE_ALPHA_BLENDING_BLEND;
+            opt.blend_opt.blend_cmd = HI_TDE_BLEND_CMD_SRCOVER;
+            opt.blend_opt.pixel_alpha_en = HI_TRUE;
+            opt.blend_opt.src1_alpha_premulti = HI_TRUE;
+            opt.blend_opt.src2_alpha_premulti = HI_TRUE;
+            return tde_sw_blit(dst, &rect, src, &rect, dst, &rect, &opt);
+        case TDE_SW_BENCH_ROTATE_90:
+            return tde_sw_rotate(src, &rect, rot, &rot_rect, HI_TDE_ROTATE_CLOCKWISE_90);
+        case TDE_SW_BENCH_ROTATE_180:
+            return tde_sw_rotate(src, &rect, dst, &rect, HI_TDE_ROTATE_CLOCKWISE_180);
+        default:
+            return HI_FAILURE;
+    }
+}
+
+static hi_double tde_sw_bench_now(hi_void)
+{
+    struct timespec ts;
+
+    (hi_void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (hi_double)ts.tv_sec + (hi_double)ts.tv_nsec / 1e9; /* 1e9: ns per second */
+}
+
+int main(int argc, char *argv[])
+{
+    hi_tde_surface src, dst, rot;
+    hi_u8 *src_buf = HI_NULL;
+    hi_u8 *dst_buf = HI_NULL;
+    hi_u8 *rot_buf = HI_NULL;
+    hi_u32 size, i, op, loop;
+    hi_double start, cost;
+    hi_s32 ret = 0;
+
+    (hi_void)argc;
+    (hi_void)argv;
+
+    /* big enough for the widest format in either orientation */
+    size = ((TDE_SW_BENCH_WIDTH * 4 + 0xf) & ~0xfU) * TDE_SW_BENCH_WIDTH; /* 4: max bytes per pixel */
+    src_buf = calloc(1, size);
+    dst_buf = calloc(1, size);
+    rot_buf = calloc(1, size);
+    if ((src_buf == HI_NULL) || (dst_buf == HI_NULL) || (rot_buf == HI_NULL)) {
+        printf("alloc %u bytes failed\n", size);
+        ret = 1;
+        goto out;
+    }
+    for (i = 0; i < size; i++) {
+        src_buf[i] = (hi_u8)(i * 7); /* 7: pattern */
+    }
+
+    printf("%-10s %-14s %10s\n", "format", "operation", "Mpixel/s");
+    for (i = 0; i < sizeof(g_tde_sw_bench_fmt) / sizeof(g_tde_sw_bench_fmt[0]); i++) {
+        tde_sw_bench_surface(&src, src_buf, &g_tde_sw_bench_fmt[i], TDE_SW_BENCH_WIDTH, TDE_SW_BENCH_HEIGHT);
+        tde_sw_bench_surface(&dst, dst_buf, &g_tde_sw_bench_fmt[i], TDE_SW_BENCH_WIDTH, TDE_SW_BENCH_HEIGHT);
+        tde_sw_bench_surface(&rot, rot_buf, &g_tde_sw_bench_fmt[i], TDE_SW_BENCH_HEIGHT, TDE_SW_BENCH_WIDTH);
+        for (op = 0; op < TDE_SW_BENCH_OP_MAX; op++) {
+            start = tde_sw_bench_now();
+            for (loop = 0; loop < TDE_SW_BENCH_LOOP; loop++) {
+                if (tde_sw_bench_run_once((tde_sw_bench_op)op, &src, &dst, &rot) != HI_SUCCESS) {
+                    break;
+                }
+            }
+            cost = tde_sw_bench_now() - start;
+            if (loop != TDE_SW_BENCH_LOOP) {
+                printf("%-10s %-14s %10s\n", g_tde_sw_bench_fmt[i].name, g_tde_sw_bench_op_name[op], "unsupported");
+                continue;
+            }
+            printf("%-10s %-14s %10.1f\n", g_tde_sw_bench_fmt[i].name, g_tde_sw_bench_op_name[op],
+                   (hi_double)TDE_SW_BENCH_WIDTH * TDE_SW_BENCH_HEIGHT * TDE_SW_BENCH_LOOP / cost / 1e6); /* 1e6 */
+        }
+    }
+
+out:
+    free(src_buf);
+    free(dst_buf);
+    free(rot_buf);
+    return ret;
+}
@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host self checks of the TDE software reference model. The hardware results
+ * are not available here, so each operation is checked against an identity it
+ * must satisfy (fill contents, format round trips, rotate/mirror cycles,
+ * 1:1 resize, SrcOver fast path against the generic blend).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tde_sw.h"
+
+#define TDE_SW_TEST_WIDTH  77
+#define TDE_SW_TEST_HEIGHT 45
+
+typedef struct {
+    hi_tde_surface surface;
+    hi_tde_rect rect;
+    hi_u8 *buf;
+} tde_sw_test_image;
+
+static hi_u32 g_tde_sw_test_fail = 0;
+
+#define tde_sw_test_check(cond, name) do { \
+    if (!(cond)) { \
+        printf("FAIL %s (%s:%d)\n", name, __FILE__, __LINE__); \
+        g_tde_sw_test_fail++; \
+    } else { \
+        printf("ok   %s\n", name); \
+    } \
+} while (0)
+
+static hi_u32 tde_sw_test_bpp(hi_tde_color_fmt fmt)
+{
+    switch (fmt) {
+        case HI_TDE_COLOR_FMT_ARGB8888:
+            return 4; /* 4: bytes per pixel */
+        case HI_TDE_COLOR_FMT_RGB888:
+            return 3; /* 3: bytes per pixel */
+        case HI_TDE_COLOR_FMT_RGB565:
+        case HI_TDE_COLOR_FMT_ARGB1555:
+            return 2; /* 2: bytes per pixel */
+        default:
+            return 1;
+    }
+}
+
+static hi_s32 tde_sw_test_image_init(tde_sw_test_image *image, hi_tde_color_fmt fmt, hi_u32 width, hi_u32 height)
+{
+    (hi_void)memset(image, 0, sizeof(*image));
+    image->surface.color_fmt = fmt;
+    image->surface.width = width;
+    image->surface.height = height;
+    /* pad the stride like the hardware wants it, 16 byte aligned */
+    image->surface.stride = (width * tde_sw_test_bpp(fmt) + 0xf) & ~0xfU;
+    image->surface.alpha_max_is_255 = HI_TRUE;
+    image->buf = calloc(image->surface.stride, height);
+    if (image->buf == HI_NULL) {
+        return HI_FAILURE;
+    }
+    image->surface.phy_addr = (hi_u64)(hi_uintptr_t)image->buf;
+    image->rect.width = width;
+    image->rect.height = height;
+    return HI_SUCCESS;
+}
+
+static hi_void tde_sw_test_image_deinit(tde_sw_test_image *image)
+{
+    free(image->buf);
+    image->buf = HI_NULL;
+}
+
+/* pseudo random, premultiplied when the format has alpha so SrcOver input is valid */
+static hi_void tde_sw_test_image_pattern(tde_sw_test_image *image, hi_u32 seed)
+{
+    hi_u32 x, y, i, bpp, value, alpha;
+    hi_u8 *pixel = HI_NULL;
+
+    bpp = tde_sw_test_bpp(image->surface.color_fmt);
+    for (y = 0; y < image->surface.height; y++) {
+        for (x = 0; x < image->surface.width; x++) {
+            seed = seed * 1103515245U + 12345U; /* 1103515245, 12345: lcg */
+            value = seed >> 1;
+            if (image->surface.color_fmt == HI_TDE_COLOR_FMT_ARGB8888) {
+                alpha = value >> 24; /* 24: alpha */
+                value = (alpha << 24) | ((((value >> 16) & 0xff) * alpha / 0xff) << 16) | /* 24, 16: a, r */
+                        ((((value >> 8) & 0xff) * alpha / 0xff) << 8) | ((value & 0xff) * alpha / 0xff); /* 8: g */
+            }
+            pixel = image->buf + y * image->surface.stride + x * bpp;
+            for (i = 0; i < bpp; i++) {
+                pixel[i] = (hi_u8)(value >> (i * 8)); /* 8: bits per byte */
+            }
+        }
+    }
+}
+
+static hi_bool tde_sw_test_image_equal(const tde_sw_test_image *a, const tde_sw_test_image *b, hi_u32 tolerance)
+{
+    hi_u32 x, y, row;
+    hi_s32 diff;
+
+    row = a->surface.width * tde_sw_test_bpp(a->surface.color_fmt);
+    for (y = 0; y < a->surface.height; y++) {
+        for (x = 0; x < row; x++) {
+            diff = (hi_s32)a->buf[y * a->surface.stride + x] - (hi_s32)b->buf[y * b->surface.stride + x];
+            if ((hi_u32)abs(diff) > tolerance) {
+                return HI_FALSE;
+            }
+        }
+    }
+    return HI_TRUE;
+}
+
+static hi_void tde_sw_test_fill(hi_void)
+{
+    tde_sw_test_image image;
+    hi_tde_rect rect = { 5, 3, 20, 11 }; /* 5, 3, 20, 11: rect inside the image */
+    hi_bool ok = HI_TRUE;
+    hi_u32 x, y, value, expect;
+
+    if (tde_sw_test_image_init(&image, HI_TDE_COLOR_FMT_ARGB8888, TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) !=
+        HI_SUCCESS) {
+        tde_sw_test_check(HI_FALSE, "fill alloc");
+        return;
+    }
+    tde_sw_test_check(tde_sw_quick_fill(&image.surface, &rect, 0x80112233) == HI_SUCCESS, "fill argb8888");
+    for (y = 0; y < image.surface.height; y++) {
+        for (x = 0; x < image.surface.width; x++) {
+            (hi_void)memcpy(&value, image.buf + y * image.surface.stride + x * 4, sizeof(value)); /* 4: argb8888 */
+            expect = ((x >= (hi_u32)rect.pos_x) && (x < (hi_u32)rect.pos_x + rect.width) &&
+                      (y >= (hi_u32)rect.pos_y) && (y < (hi_u32)rect.pos_y + rect.height)) ? 0x80112233 : 0;
+            ok = (value == expect) ? ok : HI_FALSE;
+        }
+    }
+    tde_sw_test_check(ok, "fill touches only the rect");
+
+    rect.pos_x = TDE_SW_TEST_WIDTH - 1;
+    tde_sw_test_check(tde_sw_quick_fill(&image.surface, &rect, 0) == HI_ERR_TDE_INVALID_PARA, "fill rect outside");
+    tde_sw_test_image_deinit(&image);
+}
+
+static hi_void tde_sw_test_copy(hi_void)
+{
+    static const hi_tde_color_fmt fmt[] = {
+        HI_TDE_COLOR_FMT_RGB565, HI_TDE_COLOR_FMT_ARGB1555, HI_TDE_COLOR_FMT_RGB888,
+    };
+    tde_sw_test_image src, mid, dst;
+    hi_u32 i;
+    char name[64]; /* 64: name length */
+
+    for (i = 0; i < sizeof(fmt) / sizeof(fmt[0]); i++) {
+        if ((tde_sw_test_image_init(&src, fmt[i], TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) != HI_SUCCESS) ||
+            (tde_sw_test_image_init(&mid, HI_TDE_COLOR_FMT_ARGB8888, TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) !=
+             HI_SUCCESS) ||
+            (tde_sw_test_image_init(&dst, fmt[i], TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) != HI_SUCCESS)) {
+            tde_sw_test_check(HI_FALSE, "copy alloc");
+            return;
+        }
+        /* without the alpha extension the 1555 alpha bit expands to 0 or 255 and is kept */
+        tde_sw_test_image_pattern(&src, i + 1);
+        /* a narrow format widened to argb8888 and back must be lossless */
+        (hi_void)snprintf(name, sizeof(name), "copy fmt %d -> argb8888 -> fmt %d", fmt[i], fmt[i]);
+        tde_sw_test_check((tde_sw_quick_copy(&src.surface, &src.rect, &mid.surface, &mid.rect) == HI_SUCCESS) &&
+                          (tde_sw_quick_copy(&mid.surface, &mid.rect, &dst.surface, &dst.rect) == HI_SUCCESS) &&
+                          tde_sw_test_image_equal(&src, &dst, 0), name);
+        tde_sw_test_image_deinit(&src);
+        tde_sw_test_image_deinit(&mid);
+        tde_sw_test_image_deinit(&dst);
+    }
+}
+
+static hi_void tde_sw_test_resize(hi_void)
+{
+    tde_sw_test_image src, dst;
+
+    if ((tde_sw_test_image_init(&src, HI_TDE_COLOR_FMT_ARGB8888, TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) !=
+         HI_SUCCESS) ||
+        (tde_sw_test_image_init(&dst, HI_TDE_COLOR_FMT_ARGB8888, TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) !=
+         HI_SUCCESS)) {
+        tde_sw_test_check(HI_FALSE, "resize alloc");
+        return;
+    }
+    tde_sw_test_image_pattern(&src, 7); /* 7: seed */
+    tde_sw_test_check((tde_sw_quick_resize(&src.surface, &src.rect, &dst.surface, &dst.rect) == HI_SUCCESS) &&
+                      tde_sw_test_image_equal(&src, &dst, 1), "resize 1:1 is a copy");
+    tde_sw_test_image_deinit(&src);
+    tde_sw_test_image_deinit(&dst);
+}
+
+static hi_void tde_sw_test_rotate(hi_void)
+{
+    tde_sw_test_image src, tmp, dst;
+    hi_bool ok;
+
+    if ((tde_sw_test_image_init(&src, HI_TDE_COLOR_FMT_RGB565, TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) !=
+         HI_SUCCESS) ||
+        (tde_sw_test_image_init(&tmp, HI_TDE_COLOR_FMT_RGB565, TDE_SW_TEST_HEIGHT, TDE_SW_TEST_WIDTH) !=
+         HI_SUCCESS) ||
+        (tde_sw_test_image_init(&dst, HI_TDE_COLOR_FMT_RGB565, TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) !=
+         HI_SUCCESS)) {
+        tde_sw_test_check(HI_FALSE, "rotate alloc");
+        return;
+    }
+    tde_sw_test_image_pattern(&src, 3); /* 3: seed */
+
+    ok = (tde_sw_rotate(&src.surface, &src.rect, &tmp.surface, &tmp.rect, HI_TDE_ROTATE_CLOCKWISE_90) ==
+          HI_SUCCESS) &&
+         (tde_sw_rotate(&tmp.surface, &tmp.rect, &dst.surface, &dst.rect, HI_TDE_ROTATE_CLOCKWISE_270) ==
+          HI_SUCCESS);
+    tde_sw_test_check(ok && tde_sw_test_image_equal(&src, &dst, 0), "rotate 90 then 270");
+
+    (hi_void)memset(dst.buf, 0, dst.surface.stride * dst.surface.height);
+    ok = (tde_sw_rotate(&src.surface, &src.rect, &tmp.surface, &tmp.rect, HI_TDE_ROTATE_CLOCKWISE_270) ==
+          HI_SUCCESS) &&
+         (tde_sw_rotate(&tmp.surface, &tmp.rect, &dst.surface, &dst.rect, HI_TDE_ROTATE_CLOCKWISE_90) ==
+          HI_SUCCESS);
+    tde_sw_test_check(ok && tde_sw_test_image_equal(&src, &dst, 0), "rotate 270 then 90");
+
+    tde_sw_test_image_deinit(&tmp);
+    if (tde_sw_test_image_init(&tmp, HI_TDE_COLOR_FMT_RGB565, TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) !=
+        HI_SUCCESS) {
+        tde_sw_test_check(HI_FALSE, "rotate alloc");
+        return;
+    }
+    (hi_void)memset(dst.buf, 0, dst.surface.stride * dst.surface.height);
+    ok = (tde_sw_rotate(&src.surface, &src.rect, &tmp.surface, &tmp.rect, HI_TDE_ROTATE_CLOCKWISE_180) ==
+          HI_SUCCESS) &&
+         (tde_sw_rotate(&tmp.surface, &tmp.rect, &dst.surface, &dst.rect, HI_TDE_ROTATE_CLOCKWISE_180) ==
+          HI_SUCCESS);
+    tde_sw_test_check(ok && tde_sw_test_image_equal(&src, &dst, 0), "rotate 180 twice");
+
+    tde_sw_test_image_deinit(&src);
+    tde_sw_test_image_deinit(&tmp);
+    tde_sw_test_image_deinit(&dst);
+}
+
+static hi_void tde_sw_test_blit(hi_void)
+{
+    tde_sw_test_image fg, bg, fast, generic, tmp;
+    hi_tde_opt opt;
+
+    if ((tde_sw_test_image_init(&fg, HI_TDE_COLOR_FMT_ARGB8888, TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) !=
+         HI_SUCCESS) ||
+        (tde_sw_test_image_init(&bg, HI_TDE_COLOR_FMT_ARGB8888, TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) !=
+         HI_SUCCESS) ||
+        (tde_sw_test_image_init(&fast, HI_TDE_COLOR_FMT_ARGB8888, TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) !=
+         HI_SUCCESS) ||
+        (tde_sw_test_image_init(&generic, HI_TDE_COLOR_FMT_ARGB8888, TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) !=
+         HI_SUCCESS) ||
+        (tde_sw_test_image_init(&tmp, HI_TDE_COLOR_FMT_ARGB8888, TDE_SW_TEST_WIDTH, TDE_SW_TEST_HEIGHT) !=
+         HI_SUCCESS)) {
+        tde_sw_test_check(HI_FALSE, "blit alloc");
+        return;
+    }
+    tde_sw_test_image_pattern(&fg, 11); /* 11: seed */
+    tde_sw_test_image_pattern(&bg, 13); /* 13: seed */
+
+    /* premultiplied SrcOver takes the two-channel fast path */
+    (hi_void)memset(&opt, 0, sizeof(opt));
+    opt.alpha_blending_cmd = HI_TDE_ALPHA_BLENDING_BLEND;
+    opt.blend_opt.blend_cmd = HI_TDE_BLEND_CMD_SRCOVER;
+    opt.blend_opt.pixel_alpha_en = HI_TRUE;
+    opt.blend_opt.src1_alpha_premulti = HI_TRUE;
+    opt.blend_opt.src2_alpha_premulti = HI_TRUE;
+    tde_sw_test_check(tde_sw_blit(&bg.surface, &bg.rect, &fg.surface, &fg.rect, &fast.surface, &fast.rect, &opt) ==
+                      HI_SUCCESS, "blit srcover fast path");
+
+    /* an empty outside clip passes every pixel but forces the per pixel blend */
+    opt.clip_mode = HI_TDE_CLIP_MODE_OUTSIDE;
+    tde_sw_test_check(tde_sw_blit(&bg.surface, &bg.rect, &fg.surface, &fg.rect, &generic.surface, &generic.rect,
+                                  &opt) == HI_SUCCESS, "blit srcover generic path");
+    tde_sw_test_check(tde_sw_test_image_equal(&fast, &generic, 1), "blit srcover fast == generic");
+
+    /* ROP copypen with full alpha output is a plain copy of the foreground */
+    (hi_void)memset(&opt, 0, sizeof(opt));
+    opt.alpha_blending_cmd = HI_TDE_ALPHA_BLENDING_ROP;
+    opt.rop_color = HI_TDE_ROP_COPYPEN;
+    opt.rop_alpha = HI_TDE_ROP_COPYPEN;
+    tde_sw_test_check((tde_sw_blit(&bg.surface, &bg.rect, &fg.surface, &fg.rect, &generic.surface, &generic.rect,
+                                   &opt) == HI_SUCCESS) && tde_sw_test_image_equal(&fg, &generic, 0),
+                      "blit rop copypen");
+
+    /* horizontal mirror applied twice gives the foreground back */
+    opt.mirror = HI_TDE_MIRROR_HORIZONTAL;
+    tde_sw_test_check((tde_sw_blit(&bg.surface, &bg.rect, &fg.surface, &fg.rect, &tmp.surface, &tmp.rect, &opt) ==
+                       HI_SUCCESS) &&
+                      (tde_sw_blit(&bg.surface, &bg.rect, &tmp.surface, &tmp.rect, &generic.surface, &generic.rect,
+                                   &opt) == HI_SUCCESS) && tde_sw_test_image_equal(&fg, &generic, 0),
+                      "blit mirror twice");
+
+    tde_sw_test_image_deinit(&fg);
+    tde_sw_test_image_deinit(&bg);
+    tde_sw_test_image_deinit(&fast);
+    tde_sw_test_image_deinit(&generic);
+    tde_sw_test_image_deinit(&tmp);
+}
+
+int main(int argc, char *argv[])
+{
+    (hi_void)argc;
+    (hi_void)argv;
+
+    tde_sw_test_fill();
+    tde_sw_test_copy();
+    tde_sw_test_resize();
+    tde_sw_test_rotate();
+    tde_sw_test_blit();
+
+    printf("%u check(s) failed\n", g_tde_sw_test_fail);
+    return (g_tde_sw_test_fail == 0) ? 0 : 1;
+}
@@ -0,0 +1,444 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host test and benchmark of the TDE unit pools (src/src/wmalloc.c) on pthreads,
+ * each thread standing for one CPU. Without an argument it checks that:
+ * - no unit is handed to two owners at once, while the threads allocate, fill and
+ *   free bursts of jobs, some of them freed from another CPU;
+ * - an allocation starts with the bytes asked for cleared;
+ * - every unit is back in its shared pool or a magazine once the threads are done,
+ *   and none is there twice;
+ * - units parked in the magazines of idle CPUs are still handed out when the
+ *   shared pools run dry.
+ * With "bench" it reports the alloc/free throughput at 1 to 4 threads, through the
+ * per-CPU magazines and through the shared pool alone, which is the path of a pool
+ * too small to be cached, and how often g_mem_lock was taken per operation.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../src/src/wmalloc.c"
+
+#define TDE_WM_THREADS      TDE_MEM_MAX_CPU
+#define TDE_WM_ROUNDS       20000
+#define TDE_WM_BURST_MAX    8
+#define TDE_WM_BENCH_ROUNDS 400000
+#define TDE_WM_BUF          0x20000 /* the g_u32TdeBuf default of tde_init.c */
+#define TDE_WM_PHY_BASE     0x80000000ULL
+
+typedef struct {
+    pthread_mutex_t mutex;
+    hi_u64 taken;
+    hi_u64 contended;
+} tde_wm_lock;
+
+typedef struct {
+    hi_u8 *ptr;
+    hi_u32 len;
+    hi_u8 tag;
+} tde_wm_unit;
+
+typedef struct {
+    hi_u32 cpu;
+    hi_u32 seed;
+    hi_u32 rounds;
+} tde_wm_thread;
+
+static __thread hi_u32 g_wm_cpu = 0;
+static pthread_mutex_t g_wm_mutex = PTHREAD_MUTEX_INITIALIZER;
+static hi_u32 g_fail = 0;
+
+#define tool_check(cond, name) do { \
+    pthread_mutex_lock(&g_wm_mutex); \
+    if (cond) { \
+        printf("ok   %s\n", name); \
+    } else { \
+        printf("FAIL %s (%s:%d)\n", name, __FILE__, __LINE__); \
+        g_fail++; \
+    } \
+    pthread_mutex_unlock(&g_wm_mutex); \
+} while (0)
+
+/* a failure seen by a worker thread, reported once by tde_wm_stress */
+static hi_u32 g_wm_bad_fill = 0;
+static hi_u32 g_wm_bad_clear = 0;
+static hi_u32 g_wm_bad_addr = 0;
+
+/* host stand-ins of the osal and cmpi calls wmalloc.c makes */
+int osal_spin_lock_init(osal_spinlock_t *lock)
+{
+    tde_wm_lock *l = (tde_wm_lock *)calloc(1, sizeof(tde_wm_lock));
+
+    if (l == NULL) {
+        return -1;
+    }
+    pthread_mutex_init(&l->mutex, NULL);
+    lock->lock = l;
+    return 0;
+}
+
+void osal_spin_lock_destroy(osal_spinlock_t *lock)
+{
+    tde_wm_lock *l = (tde_wm_lock *)lock->lock;
+
+    pthread_mutex_destroy(&l->mutex);
+    free(l);
+    lock->lock = NULL;
+}
+
+void osal_spin_lock_irqsave(osal_spinlock_t *lock, unsigned long *flags)
+{
+    tde_wm_lock *l = (tde_wm_lock *)lock->lock;
+
+    if (pthread_mutex_trylock(&l->mutex) != 0) {
+        pthread_mutex_lock(&l->mutex);
+        l->contended++;
+    }
+    l->taken++;
+    *flags = 0;
+}
+
+void osal_spin_unlock_irqrestore(osal_spinlock_t *lock, const unsigned long *flags)
+{
+    tde_wm_lock *l = (tde_wm_lock *)lock->lock;
+
+    pthread_mutex_unlock(&l->mutex);
+}
+
+unsigned int osal_get_cpu_id(void)
+{
+    return g_wm_cpu;
+}
+
+void osal_seq_printf(osal_proc_entry_t *entry, const char *fmt, ...)
+{
+}
+
+unsigned long long cmpi_mmz_malloc(const char *mmz_name, const char *buf_name, unsigned long ul_size)
+{
+    return TDE_WM_PHY_BASE;
+}
+
+void cmpi_mmz_free(unsigned long long phy_addr, void *vir_addr)
+{
+}
+
+void *cmpi_remap_nocache(unsigned long long phy_addr, unsigned long ul_size)
+{
+    return aligned_alloc(64, (ul_size + 63) & ~63UL); /* 64: a cache line */
+}
+
+void cmpi_unmap(void *virt_addr)
+{
+    free(virt_addr);
+}
+
+static hi_u32 tde_wm_rand(hi_u32 *seed, hi_u32 n)
+{
+    *seed = *seed * 1103515245 + 12345; /* LCG, one stream per thread */
+    return (*seed >> 16) % n;
+}
+
+/* mostly commands and nodes, as a job is built, now and then a job or a filter */
+static hi_u32 tde_wm_rand_len(hi_u32 *seed)
+{
+    static const hi_u32 lens[] = { CMD_SIZE, CMD_SIZE / 2, NODE_SIZE, NODE_SIZE, JOB_SIZE, FILTER_SIZE };
+    hi_u32 len = lens[tde_wm_rand(seed, sizeof(lens) / sizeof(lens[0]))];
+
+    return len - tde_wm_rand(seed, 8); /* 8: odd sizes round up to the unit */
+}
+
+static hi_bool tde_wm_owned(const hi_u8 *ptr)
+{
+    const memory_block *block = HI_NULL;
+    unit_size size;
+
+    for (size = UNIT_SIZE_CMD; size < UNIT_SIZE_BUTT; size++) {
+        block = &g_stru_mem_block[size];
+        if ((ptr >= (hi_u8 *)block->start_addr) && (ptr < (hi_u8 *)block->start_addr + block->n_size)) {
+            return ((hi_ulong)(ptr - (hi_u8 *)block->start_addr) % block->n_unit_size) == 0;
+        }
+    }
+    return HI_FALSE;
+}
+
+static hi_bool tde_wm_alloc(tde_wm_unit *unit, hi_u32 len, hi_u8 tag)
+{
+    hi_u32 i;
+
+    unit->ptr = (hi_u8 *)tde_malloc(len);
+    if (unit->ptr == HI_NULL) {
+        return HI_FALSE;
+    }
+    if (!tde_wm_owned(unit->ptr) || (wgetphy(unit->ptr) == 0)) {
+        __atomic_add_fetch(&g_wm_bad_addr, 1, __ATOMIC_RELAXED);
+    }
+    for (i = 0; i < len; i++) {
+        if (unit->ptr[i] != 0) {
+            __atomic_add_fetch(&g_wm_bad_clear, 1, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    unit->len = len;
+    unit->tag = tag;
+    memset(unit->ptr, tag, len);
+    return HI_TRUE;
+}
+
+static hi_void tde_wm_free(const tde_wm_unit *unit)
+{
+    hi_u32 i;
+
+    /* a unit handed to someone else meanwhile has been cleared or refilled */
+    for (i = 0; i < unit->len; i++) {
+        if (unit->ptr[i] != unit->tag) {
+            __atomic_add_fetch(&g_wm_bad_fill, 1, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    tde_free(unit->ptr);
+}
+
+static hi_void *tde_wm_stress_thread(hi_void *arg)
+{
+    tde_wm_thread *t = (tde_wm_thread *)arg;
+    tde_wm_unit unit[TDE_WM_BURST_MAX];
+    hi_u32 round, i, n, got;
+
+    for (round = 0; round < t->rounds; round++) {
+        g_wm_cpu = t->cpu;
+        n = 1 + tde_wm_rand(&t->seed, TDE_WM_BURST_MAX);
+        for (got = 0; got < n; got++) {
+            if (!tde_wm_alloc(&unit[got], tde_wm_rand_len(&t->seed), (hi_u8)(1 + tde_wm_rand(&t->seed, 255)))) {
+                break;
+            }
+        }
+        /* one burst in four completes on another CPU, as a job freed by the interrupt */
+        if (tde_wm_rand(&t->seed, 4) == 0) {
+            g_wm_cpu = tde_wm_rand(&t->seed, TDE_MEM_MAX_CPU);
+        }
+        for (i = 0; i < got; i++) {
+            tde_wm_free(&unit[i]);
+        }
+    }
+    return HI_NULL;
+}
+
+/* every unit is in its shared pool or in one magazine, and in only one place */
+static hi_bool tde_wm_accounted(hi_void)
+{
+    static hi_u8 seen[0x10000];
+    const memory_block *block = HI_NULL;
+    const tde_magazine *mag = HI_NULL;
+    unit_size size;
+    hi_u16 index;
+    hi_u32 i, j, n;
+
+    for (size = UNIT_SIZE_CMD; size < UNIT_SIZE_BUTT; size++) {
+        block = &g_stru_mem_block[size];
+        (hi_void)memset(seen, 0, sizeof(seen));
+        n = 0;
+        for (i = 0, index = block->n_first; i < block->n_free; i++) {
+            if ((index >= block->n_max_num) || seen[index]) {
+                return HI_FALSE;
+            }
+            seen[index] = 1;
+            n++;
+            index = *(hi_u16 *)memory_block_addr(block, index);
+        }
+        for (i = 0; i < TDE_MEM_MAX_CPU; i++) {
+            mag = &g_mem_mag[size][i];
+            for (j = 0; j < mag->count; j++) {
+                if ((mag->unit[j] >= block->n_max_num) || seen[mag->unit[j]]) {
+                    return HI_FALSE;
+                }
+                seen[mag->unit[j]] = 1;
+                n++;
+            }
+        }
+        if (n != block->n_max_num) {
+            return HI_FALSE;
+        }
+    }
+    return HI_TRUE;
+}
+
+static hi_void tde_wm_init(hi_u32 buf)
+{
+    tde_init_set_buf(buf);
+    if (wmeminit() != HI_SUCCESS) {
+        printf("FAIL wmeminit\n");
+        exit(1);
+    }
+}
+
+static hi_void tde_wm_stress(hi_void)
+{
+    pthread_t tid[TDE_WM_THREADS];
+    tde_wm_thread t[TDE_WM_THREADS];
+    hi_u32 i;
+
+    tde_wm_init(TDE_WM_BUF);
+    tool_check((g_stru_mem_block[UNIT_SIZE_CMD].n_mag_size >= TDE_MAG_MIN_SIZE) &&
+        (g_stru_mem_block[UNIT_SIZE_NODE].n_mag_size >= TDE_MAG_MIN_SIZE), "command and node pools are cached");
+    tool_check(g_stru_mem_block[UNIT_SIZE_FILTER].n_mag_size == 0, "the filter pool is too small to be cached");
+    tool_check(wgetfreenum() == HI_TDE_CMD_NUM, "every unit free after init");
+
+    for (i = 0; i < TDE_WM_THREADS; i++) {
+        t[i].cpu = i;
+        t[i].seed = 0x7de0 + i;
+        t[i].rounds = TDE_WM_ROUNDS;
+        pthread_create(&tid[i], NULL, tde_wm_stress_thread, &t[i]);
+    }
+    for (i = 0; i < TDE_WM_THREADS; i++) {
+        pthread_join(tid[i], NULL);
+    }
+    tool_check(g_wm_bad_fill == 0, "no unit handed to two owners at once");
+    tool_check(g_wm_bad_clear == 0, "allocations start cleared");
+    tool_check(g_wm_bad_addr == 0, "allocations are units of the pool");
+    tool_check(tde_wm_accounted(), "every unit back once, in a pool or a magazine");
+    tool_check(wgetfreenum() == HI_TDE_CMD_NUM, "every unit free after the stress");
+    tool_check((g_stru_mem_block[UNIT_SIZE_NODE].n_max_used != 0) &&
+        (g_stru_mem_block[UNIT_SIZE_NODE].n_max_used <= g_stru_mem_block[UNIT_SIZE_NODE].n_max_num),
+        "the high water mark stays within the pool");
+    wmemterm();
+}
+
+/* the magazines of CPUs 1..3 hold units, CPU 0 still gets every unit of every pool */
+static hi_void tde_wm_drain(hi_void)
+{
+    static tde_wm_unit unit[0x10000];
+    hi_u32 total = 0;
+    hi_u32 cached = 0;
+    hi_u32 i, n;
+    unit_size size;
+
+    tde_wm_init(TDE_WM_BUF);
+    for (g_wm_cpu = 1; g_wm_cpu < TDE_MEM_MAX_CPU; g_wm_cpu++) {
+        for (n = 0; n < TDE_WM_BURST_MAX; n++) {
+            (hi_void)tde_wm_alloc(&unit[n], CMD_SIZE, 1);
+        }
+        for (i = 0; i < n; i++) {
+            tde_wm_free(&unit[i]);
+        }
+    }
+    for (size = UNIT_SIZE_CMD; size < UNIT_SIZE_BUTT; size++) {
+        total += g_stru_mem_block[size].n_max_num;
+        cached += wgetcachednum(size);
+    }
+    tool_check(cached != 0, "idle CPUs keep units in their magazines");
+
+    g_wm_cpu = 0;
+    for (n = 0; (n < sizeof(unit) / sizeof(unit[0])) && tde_wm_alloc(&unit[n], CMD_SIZE, (hi_u8)(1 + n % 255)); n++) {
+    }
+    tool_check(n == total, "a dry pool takes the units parked on other CPUs");
+    for (i = 0; i < n; i++) {
+        g_wm_cpu = i % TDE_MEM_MAX_CPU;
+        tde_wm_free(&unit[i]);
+    }
+    tool_check(g_wm_bad_fill == 0, "the drained units are intact");
+    tool_check(tde_wm_accounted(), "every drained unit back once");
+    wmemterm();
+}
+
+static hi_void *tde_wm_bench_thread(hi_void *arg)
+{
+    tde_wm_thread *t = (tde_wm_thread *)arg;
+    /* one job as tde_osilist.c builds it: the job, a node and its commands */
+    static const hi_u32 lens[] = { JOB_SIZE, NODE_SIZE, CMD_SIZE, CMD_SIZE, NODE_SIZE, CMD_SIZE };
+    hi_void *ptr[sizeof(lens) / sizeof(lens[0])];
+    hi_u32 round, i;
+
+    g_wm_cpu = t->cpu;
+    for (round = 0; round < t->rounds; round++) {
+        for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+            ptr[i] = tde_malloc(lens[i]);
+        }
+        for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+            tde_free(ptr[i]);
+        }
+    }
+    return HI_NULL;
+}
+
+static double tde_wm_now(hi_void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9; /* 1e9: ns per s */
+}
+
+static hi_void tde_wm_bench(hi_u32 buf, hi_bool shared)
+{
+    pthread_t tid[TDE_WM_THREADS];
+    tde_wm_thread t[TDE_WM_THREADS];
+    tde_wm_lock *mem_lock = HI_NULL;
+    hi_u32 threads, i;
+    unit_size size;
+    double start, secs, ops;
+
+    for (threads = 1; threads <= TDE_WM_THREADS; threads++) {
+        tde_wm_init(buf);
+        if (shared) {
+            for (size = UNIT_SIZE_CMD; size < UNIT_SIZE_BUTT; size++) {
+                g_stru_mem_block[size].n_mag_size = 0;
+            }
+        }
+        mem_lock = (tde_wm_lock *)g_mem_lock.lock;
+        start = tde_wm_now();
+        for (i = 0; i < threads; i++) {
+            t[i].cpu = i;
+            t[i].rounds = TDE_WM_BENCH_ROUNDS / threads;
+            pthread_create(&tid[i], NULL, tde_wm_bench_thread, &t[i]);
+        }
+        for (i = 0; i < threads; i++) {
+            pthread_join(tid[i], NULL);
+        }
+        secs = tde_wm_now() - start;
+        ops = (double)(TDE_WM_BENCH_ROUNDS / threads) * threads * 12; /* 12: 6 allocs and 6 frees a round */
+        printf("%4uK %-9s %u thread(s)  %7.2f Mop/s  g_mem_lock %.3f/op, %llu contended\n",
+            buf / 1024, shared ? "shared" : "magazine", threads, ops / secs / 1e6, /* 1024: K, 1e6: M */
+            (double)mem_lock->taken / ops, (unsigned long long)mem_lock->contended);
+        wmemterm();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if ((argc > 1) && (strcmp(argv[1], "bench") == 0)) {
+        tde_wm_bench(TDE_WM_BUF, HI_TRUE);
+        tde_wm_bench(TDE_WM_BUF, HI_FALSE);
+        tde_wm_bench(TDE_MAX_BUFFER, HI_TRUE);
+        tde_wm_bench(TDE_MAX_BUFFER, HI_FALSE);
+        return 0;
+    }
+
+    tde_wm_stress();
+    tde_wm_drain();
+    if (g_fail != 0) {
+        printf("%u check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
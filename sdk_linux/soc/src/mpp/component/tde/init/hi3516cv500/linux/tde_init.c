@@ -28,10 +28,12 @@
 hi_u32 g_u32TdeTmpBuf = 1658880; /* 1658880 buffer size */
 bool g_bResizeFilter = true;
 hi_u32 g_u32TdeBuf = 0x20000; /* 0x20000 buffer size */
+bool g_bTdeTmpBufReserve = false; /* true pins g_u32TdeTmpBuf of MMZ from load to unload */
 
 module_param(g_u32TdeTmpBuf, uint, S_IRUGO);
 module_param(g_bResizeFilter, bool, S_IRUGO);
 module_param(g_u32TdeBuf, uint, S_IRUGO);
+module_param(g_bTdeTmpBufReserve, bool, S_IRUGO);
 
 static int hi35xx_tde_probe(struct platform_device *pdev)
 {
@@ -59,6 +61,7 @@ static int hi35xx_tde_probe(struct platform_device *pdev)
     if (g_u32TdeTmpBuf > 0) {
         tde_set_tde_tmp_buffer(g_u32TdeTmpBuf);
     }
+    tde_set_tde_tmp_buffer_reserve(g_bTdeTmpBufReserve);
 
     if (tde_drv_mod_init() != HI_SUCCESS) {
         osal_printk("load tde.ko for %s...FAILED!\n", CHIP_NAME);
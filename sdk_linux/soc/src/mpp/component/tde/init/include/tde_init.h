@@ -36,6 +36,7 @@ hi_void tde_hal_set_base_vir_addr(hi_u32 *temp_base_vir_addr);
 hi_void tde_init_set_buf(hi_u32 tde_buf);
 hi_void tde_set_resize_filter(hi_bool is_resize_filter);
 hi_void tde_set_tde_tmp_buffer(hi_u32 tde_tmp_buf);
+hi_void tde_set_tde_tmp_buffer_reserve(hi_bool tmp_buf_reserve);
 
 #ifdef __cplusplus
 #if __cplusplus
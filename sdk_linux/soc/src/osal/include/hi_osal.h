@@ -83,6 +83,12 @@ extern void osal_spin_unlock_irqrestore(osal_spinlock_t *lock, const unsigned lo
 /* notice:must be called when kmod exit, other wise will lead to memory leak; */
 extern void osal_spin_lock_destroy(osal_spinlock_t *lock);
 
+/* rcu api */
+extern void osal_rcu_read_lock(void);
+extern void osal_rcu_read_unlock(void);
+/* may sleep, waits until all read sides started before the call are left */
+extern void osal_synchronize_rcu(void);
+
 /* wait api */
 typedef int (*osal_wait_cond_func_t)(const void *param);
 
@@ -196,10 +202,13 @@ extern int osal_init_work(struct osal_work_struct *work, osal_work_func_t func);
     } while (0)
 
 extern int osal_schedule_work(struct osal_work_struct *work);
+extern int osal_cancel_work_sync(struct osal_work_struct *work);
 extern void osal_destroy_work(struct osal_work_struct *work);
 
 /* schedule */
 extern void osal_yield(void);
+extern unsigned int osal_get_cpu_id(void);
+extern unsigned int osal_get_cpu_num(void);
 
 /* interrupt api */
 enum osal_irqreturn {
@@ -274,6 +283,8 @@ extern int osal_access_ok(int type, const void *addr, unsigned long size);
 
 /* cache api */
 extern void osal_flush_dcache_area(void *kvirt, unsigned long phys_addr, unsigned long length);
+extern void osal_clean_dcache_area(void *kvirt, unsigned long phys_addr, unsigned long length);
+extern void osal_invalid_dcache_area(void *kvirt, unsigned long phys_addr, unsigned long length);
 
 /* math */
 extern unsigned long long osal_div_u64(unsigned long long dividend, unsigned int divisor);
@@ -19,6 +19,7 @@
 #ifndef _OSAL_MMZ_H
 #define _OSAL_MMZ_H
 
+#include <linux/rbtree.h>
 #include "hi_osal.h"
 
 #define CACHE_LINE_SIZE            0x40
@@ -40,9 +41,16 @@ struct hil_media_memory_zone {
     };
     struct osal_list_head mmb_list;
 
+    /* index of mmb_list by phys_addr and by kvirt, protected by g_mmz_lock */
+    struct rb_root mmb_phys_root;
+    struct rb_root mmb_kvirt_root;
+
     unsigned int alloc_type;
     unsigned long block_align;
 
+    /* free extents of the segfit allocator, NULL for the other allocators */
+    struct mmz_segfit *segfit;
+
     void (*destructor)(const void *);
 };
 typedef struct hil_media_memory_zone hil_mmz_t;
@@ -57,6 +65,8 @@ struct hil_media_memory_block {
     char name[HIL_MMB_NAME_LEN];
     struct hil_media_memory_zone *zone;
     struct osal_list_head list;
+    struct rb_node phys_node;
+    struct rb_node kvirt_node;
 
     unsigned long phys_addr;
     void *kvirt;
@@ -207,11 +217,12 @@ struct dirty_area {
 
 #define IOC_MMB_SYS_FLUSH_CACHE    _IOW('m', 24, struct mmb_info)
 #define IOC_MMB_BASE_CHECK_ADDR    _IOW('m', 25, struct mmb_info)
-#define IOC_MMB_INVALID_CACHE      _IOW('m', 26, struct mmb_info)
+#define IOC_MMB_INVALID_CACHE      _IOW('m', 26, struct mmb_info) /* mapped: any user mapping of phys_addr */
 #define IOC_MMB_CHECK_PHY_ALLOC    _IOWR('m', 27, struct mmb_info)
 #define IOC_MMB_MMF_REMAP          _IOWR('m', 28, struct mmb_info)
 #define IOC_MMB_MMF_REMAP_CACHED   _IOWR('m', 29, struct mmb_info)
 #define IOC_MMB_MMF_UNMAP          _IOWR('m', 30, struct mmb_info)
+#define IOC_MMB_CLEAN_CACHE        _IOW('m', 31, struct mmb_info) /* mapped: any user mapping of phys_addr */
 
 #define IOC_MMB_ADD_REF            _IO('r', 30) /* ioctl(file, cmd, arg), arg is mmb_addr */
 #define IOC_MMB_DEC_REF            _IO('r', 31) /* ioctl(file, cmd, arg), arg is mmb_addr */
@@ -219,6 +230,37 @@ struct dirty_area {
 #define IOC_MMB_FLUSH_DCACHE       _IO('c', 40)
 
 #define IOC_MMB_FLUSH_DCACHE_DIRTY _IOW('d', 50, struct dirty_area)
+
+#define MMZ_CACHE_OP_FLUSH         0 /* clean and invalidate */
+#define MMZ_CACHE_OP_CLEAN         1
+#define MMZ_CACHE_OP_INVALID       2
+
+#define MMZ_CACHE_RANGE_MAX        256
+
+/*
+ * IOC_MMB_FLUSH_RANGES is all or nothing: when a range is not inside a
+ * writable mapping of an mmb of the caller, the call fails before any cache
+ * maintenance is done. Ranges are merged only inside one vma.
+ */
+
+struct mmz_cache_range {
+    __phys_addr_type__ phys_addr; /* physical address inside an mmb of the caller */
+    void *__phys_addr_align__ virt_addr; /* user virtual address, coherent with phys_addr */
+    __phys_len_type__ __phys_addr_align__ size;
+    unsigned int __phys_addr_align__ op; /* MMZ_CACHE_OP_XXX */
+} __phys_addr_align__;
+
+struct mmz_cache_ranges {
+    struct mmz_cache_range *__phys_addr_align__ ranges; /* user array of count elements */
+    unsigned int __phys_addr_align__ count;
+
+    /* filled in by the driver */
+    unsigned int merged_count; /* ranges left after coalescing */
+    unsigned int flush_all; /* 1: the whole cache was flushed instead */
+    __phys_len_type__ __phys_addr_align__ total_size; /* bytes covered after coalescing */
+} __phys_addr_align__;
+
+#define IOC_MMB_FLUSH_RANGES       _IOWR('f', 60, struct mmz_cache_ranges)
 #define IOC_MMB_TEST_CACHE         _IOW('t', 11, struct mmb_info)
 
 #define MMZ_SETUP_CMDLINE_LEN      256
@@ -256,6 +298,7 @@ extern int hil_map_mmz_check_phys(unsigned long addr_start, unsigned long addr_l
 extern int hil_is_phys_in_mmz(unsigned long addr_start, unsigned long addr_len);
 
 extern int hil_vma_check(unsigned long vm_start, unsigned long vm_end);
+extern int hil_vma_check_flags(unsigned long vm_start, unsigned long vm_end, unsigned long vm_flags);
 extern int hil_mmb_flush_dcache_byaddr_safe(void *kvirt, unsigned long phys_addr, unsigned long length);
 
 extern unsigned long hil_mmz_get_phys(const char *zone_name);
@@ -273,6 +316,7 @@ extern void *hil_mmb_map2kern_cached(hil_mmb_t *mmb);
 
 extern int hil_mmb_flush_dcache_byaddr(void *kvirt, unsigned long phys_addr, unsigned long length);
 extern int hil_mmb_invalid_cache_byaddr(void *kvirt, unsigned long phys_addr, unsigned long length);
+extern int hil_mmb_clean_cache_byaddr(void *kvirt, unsigned long phys_addr, unsigned long length);
 
 extern int hil_mmb_unmap(hil_mmb_t *mmb);
 extern int hil_mmb_get(hil_mmb_t *mmb);
@@ -46,7 +46,22 @@ struct mmz_allocator {
     void (*mmf_unmap)(void *virt);
 };
 
+/* mmb index maintenance, must be called with g_mmz_lock held */
+void mmz_mmb_index_insert_phys(hil_mmb_t *mmb);
+void mmz_mmb_index_erase_phys(hil_mmb_t *mmb);
+void mmz_mmb_index_insert_kvirt(hil_mmb_t *mmb);
+void mmz_mmb_index_erase_kvirt(hil_mmb_t *mmb);
+
 int cma_allocator_setopt(struct mmz_allocator *allocator);
 int hisi_allocator_setopt(struct mmz_allocator *allocator);
+int segfit_allocator_setopt(struct mmz_allocator *allocator);
+
+/* segfit backend of the hisi allocator, must be called with g_mmz_lock held */
+unsigned long segfit_find_region(unsigned long *region_len, hil_mmz_t *mmz, unsigned long size,
+                                 unsigned long align, unsigned int order);
+int segfit_reserve_region(hil_mmz_t *mmz, unsigned long start, unsigned long size);
+void segfit_release_region(hil_mmz_t *mmz, unsigned long start, unsigned long size);
+void segfit_zone_stat(hil_mmz_t *mmz, unsigned long *free_bytes, unsigned long *extents,
+                      unsigned long *largest);
 
 #endif /* __ALLOCATOR_H__ */
@@ -117,6 +117,7 @@ static int do_mmb_alloc(hil_mmb_t* mmb)
                     mmb->zone->name,  __func__, __LINE__);
     }
     osal_list_add(&mmb->list, p->list.prev);
+    mmz_mmb_index_insert_phys(mmb);
 
     mmz_trace(1, HIL_MMB_FMT_S, hil_mmb_fmt_arg(mmb));
 
@@ -328,6 +329,7 @@ static void __mmb_free(hil_mmb_t *mmb)
 
     dma_release_from_contiguous(mmz->cma_dev, page, count);
 
+    mmz_mmb_index_erase_phys(mmb);
     osal_list_del(&mmb->list);
     kfree(mmb);
 }
@@ -435,6 +437,7 @@ static void *__mmb_map2kern(hil_mmb_t *mmb, int cached)
 
     mmb->flags |= HIL_MMB_MAP2KERN;
     mmb->map_ref++;
+    mmz_mmb_index_insert_kvirt(mmb);
 
     return mmb->kvirt;
 }
@@ -464,6 +467,7 @@ static int __mmb_unmap(hil_mmb_t *mmb)
     {
         vunmap(mmb->kvirt);
     }
+    mmz_mmb_index_erase_kvirt(mmb);
     mmb->kvirt = NULL;
     mmb->flags &= ~HIL_MMB_MAP2KERN;
     mmb->flags &= ~HIL_MMB_MAP2KERN_CACHED;
@@ -23,6 +23,7 @@
 #include <asm/uaccess.h>
 #include <asm/io.h>
 #include <linux/list.h>
+#include <linux/rbtree.h>
 #include <asm/cacheflush.h>
 #include <linux/version.h>
 #include "securec.h"
@@ -204,19 +205,22 @@ static unsigned long find_fixed_region_from_highaddr(unsigned long *region_len,
 static int do_mmb_alloc(hil_mmb_t *mmb)
 {
     hil_mmb_t *p = NULL;
+    struct rb_node *prev = NULL;
     mmz_trace_func();
 
-    /* add mmb sorted */
-    osal_list_for_each_entry(p, &mmb->zone->mmb_list, list) {
-        if (mmb->phys_addr < p->phys_addr) {
-            break;
-        }
+    /* add mmb sorted, the phys index gives its predecessor */
+    mmz_mmb_index_insert_phys(mmb);
+    prev = rb_prev(&mmb->phys_node);
+    if (prev == NULL) {
+        osal_list_add(&mmb->list, &mmb->zone->mmb_list);
+    } else {
+        p = rb_entry(prev, hil_mmb_t, phys_node);
         if (mmb->phys_addr == p->phys_addr) {
             osal_trace(KERN_ERR "ERROR: media-mem allocator bad in %s! (%s, %d)",
                    mmb->zone->name, __FUNCTION__, __LINE__);
         }
+        osal_list_add(&mmb->list, &p->list);
     }
-    osal_list_add(&mmb->list, p->list.prev);
 
     mmz_trace(1, HIL_MMB_FMT_S, hil_mmb_fmt_arg(mmb));
 
@@ -260,7 +264,11 @@ static hil_mmb_t *__mmb_alloc(const char *name,
         continue;
     }
 
-    start = find_fixed_region(&region_len, mmz, size, align);
+    if (mmz->segfit != NULL) {
+        start = segfit_find_region(&region_len, mmz, size, align, LOW_TO_HIGH);
+    } else {
+        start = find_fixed_region(&region_len, mmz, size, align);
+    }
     if ((fixed_len > region_len) && (start != 0)) {
         fixed_len = region_len;
         fixed_start = start;
@@ -277,6 +285,11 @@ static hil_mmb_t *__mmb_alloc(const char *name,
         return NULL;
     }
 
+    if ((fixed_mmz->segfit != NULL) && segfit_reserve_region(fixed_mmz, fixed_start, size)) {
+        kfree(mmb);
+        return NULL;
+    }
+
     (void)memset_s(mmb, sizeof(hil_mmb_t), 0, sizeof(hil_mmb_t));
     mmb->zone = fixed_mmz;
     mmb->phys_addr = fixed_start;
@@ -288,6 +301,9 @@ static hil_mmb_t *__mmb_alloc(const char *name,
     }
 
     if ((err_value != EOK) || do_mmb_alloc(mmb)) {
+        if (fixed_mmz->segfit != NULL) {
+            segfit_release_region(fixed_mmz, fixed_start, size);
+        }
         kfree(mmb);
         mmb = NULL;
     }
@@ -347,7 +363,9 @@ static hil_mmb_t *__mmb_alloc_v2(const char *name,
         size = mmz_align2(size, mmz->block_align);
     }
 
-    if (order == LOW_TO_HIGH) {
+    if (mmz->segfit != NULL) {
+        start = segfit_find_region(&region_len, mmz, size, align, order);
+    } else if (order == LOW_TO_HIGH) {
         start = find_fixed_region(&region_len, mmz, size, align);
     } else if (order == HIGH_TO_LOW) {
         start = find_fixed_region_from_highaddr(&region_len, mmz, size, align);
@@ -370,6 +388,11 @@ static hil_mmb_t *__mmb_alloc_v2(const char *name,
         return NULL;
     }
 
+    if ((fixed_mmz->segfit != NULL) && segfit_reserve_region(fixed_mmz, fixed_start, size)) {
+        kfree(mmb);
+        return NULL;
+    }
+
     (void)memset_s(mmb, sizeof(hil_mmb_t), 0, sizeof(hil_mmb_t));
     mmb->zone = fixed_mmz;
     mmb->phys_addr = fixed_start;
@@ -383,6 +406,9 @@ static hil_mmb_t *__mmb_alloc_v2(const char *name,
     }
 
     if ((err_value != EOK) || do_mmb_alloc(mmb)) {
+        if (fixed_mmz->segfit != NULL) {
+            segfit_release_region(fixed_mmz, fixed_start, size);
+        }
         kfree(mmb);
         mmb = NULL;
     }
@@ -422,6 +448,7 @@ static void *__mmb_map2kern(hil_mmb_t *mmb, int cached)
     if (mmb->kvirt) {
         mmb->flags |= HIL_MMB_MAP2KERN;
         mmb->map_ref++;
+        mmz_mmb_index_insert_kvirt(mmb);
     } else {
         mmb->flags &= ~HIL_MMB_MAP2KERN_CACHED;
     }
@@ -440,6 +467,11 @@ static void __mmb_free(hil_mmb_t *mmb)
 #endif
     }
 
+    if (mmb->zone->segfit != NULL) {
+        segfit_release_region(mmb->zone, mmb->phys_addr, mmb->length);
+    }
+
+    mmz_mmb_index_erase_phys(mmb);
     osal_list_del(&mmb->list);
     kfree(mmb);
 }
@@ -465,6 +497,7 @@ static int __mmb_unmap(hil_mmb_t *mmb)
         iounmap(mmb->kvirt);
     }
 
+    mmz_mmb_index_erase_kvirt(mmb);
     mmb->kvirt = NULL;
     mmb->flags &= ~HIL_MMB_MAP2KERN;
     mmb->flags &= ~HIL_MMB_MAP2KERN_CACHED;
@@ -46,6 +46,7 @@
 #include <linux/seq_file.h>
 #include <linux/string.h>
 #include <linux/list.h>
+#include <linux/rbtree.h>
 #include <linux/time.h>
 #include <linux/dma-mapping.h>
 #include "securec.h"
@@ -250,7 +251,7 @@ int hil_mmz_register(hil_mmz_t *zone)
 
     down(&g_mmz_lock);
 
-    if (strcmp(g_setup_allocator, "hisi") == 0) {
+    if ((strcmp(g_setup_allocator, "hisi") == 0) || (strcmp(g_setup_allocator, "segfit") == 0)) {
         ret = _check_mmz(zone);
         if (ret) {
             up(&g_mmz_lock);
@@ -259,6 +260,8 @@ int hil_mmz_register(hil_mmz_t *zone)
     }
 
     OSAL_INIT_LIST_HEAD(&zone->mmb_list);
+    zone->mmb_phys_root = RB_ROOT;
+    zone->mmb_kvirt_root = RB_ROOT;
 
     osal_list_add(&zone->list, &g_mmz_list);
 
@@ -489,29 +492,90 @@ int hil_mmb_flush_dcache_byaddr(void *kvirt,
 }
 EXPORT_SYMBOL(hil_mmb_flush_dcache_byaddr);
 
+#define MMZ_CACHE_CLEAN      0
+#define MMZ_CACHE_INVALID    1
+
+static void mmz_cache_range_op(void *kvirt, unsigned long phys_addr, unsigned long length, int op)
+{
+    if (op == MMZ_CACHE_CLEAN) {
+        /* inner first, so that the lines written back reach l2 before it is cleaned */
+#ifdef CONFIG_64BIT
+        __clean_dcache_area_poc(kvirt, length);
+#else
+        dmac_map_area(kvirt, length, DMA_TO_DEVICE);
+#endif
+#if defined(CONFIG_CACHE_HIL2V200) || defined(CONFIG_CACHE_L2X0)
+        outer_clean_range(phys_addr, phys_addr + length);
+#endif
+    } else {
+        /* outer first, so that no stale l2 line refills l1 after it is invalidated */
+#if defined(CONFIG_CACHE_HIL2V200) || defined(CONFIG_CACHE_L2X0)
+        outer_inv_range(phys_addr, phys_addr + length);
+#endif
+#ifdef CONFIG_64BIT
+        __inval_dcache_area(kvirt, length);
+#else
+        dmac_map_area(kvirt, length, DMA_FROM_DEVICE);
+#endif
+    }
+    osal_unused(phys_addr);
+}
+
+int hil_mmb_clean_cache_byaddr(void *kvirt,
+                               unsigned long phys_addr,
+                               unsigned long length)
+{
+    if (kvirt == NULL) {
+        return -EINVAL;
+    }
+
+    if (length != 0) {
+        mmz_cache_range_op(kvirt, phys_addr, length, MMZ_CACHE_CLEAN);
+    }
+
+    return 0;
+}
+EXPORT_SYMBOL(hil_mmb_clean_cache_byaddr);
+
+/*
+ * Invalidate without writing back. A cache line only partly covered by
+ * the range may hold dirty data of its neighbour, so the unaligned head
+ * and tail lines are cleaned and invalidated, only the fully covered
+ * lines in between are invalidated.
+ */
 int hil_mmb_invalid_cache_byaddr(void *kvirt,
                                  unsigned long phys_addr,
                                  unsigned long length)
 {
-    osal_unused(phys_addr);
+    unsigned long start = (unsigned long)(uintptr_t)kvirt;
+    unsigned long end = start + length;
+    unsigned long head_line = start & ~(CACHE_LINE_SIZE - 1);
+    unsigned long tail_line = end & ~(CACHE_LINE_SIZE - 1);
+    unsigned long inv_start = mmz_align2(start, CACHE_LINE_SIZE);
+
     if (kvirt == NULL) {
         return -EINVAL;
     }
 
-#ifdef CONFIG_64BIT
-    __flush_dcache_area(kvirt, length);
-#else
-    /*
-     * dmac_map_area is invalid in  hi3518ev200 kernel,
-     * arm9 is not supported yet
-     */
-#if (HICHIP == 0x3516A100)
-    /* flush without clean */
-    dmac_map_area(kvirt, length, DMA_FROM_DEVICE);
-#else
-    __cpuc_flush_dcache_area(kvirt, length);
-#endif
-#endif
+    if (length == 0) {
+        return 0;
+    }
+
+    if (start != head_line) {
+        hil_mmb_flush_dcache_byaddr((void *)(uintptr_t)head_line, phys_addr - (start - head_line),
+            CACHE_LINE_SIZE);
+    }
+
+    if ((end != tail_line) && ((tail_line != head_line) || (start == head_line))) {
+        hil_mmb_flush_dcache_byaddr((void *)(uintptr_t)tail_line, phys_addr + (tail_line - start),
+            CACHE_LINE_SIZE);
+    }
+
+    if (inv_start < tail_line) {
+        mmz_cache_range_op((void *)(uintptr_t)inv_start, phys_addr + (inv_start - start),
+            tail_line - inv_start, MMZ_CACHE_INVALID);
+    }
+
     return 0;
 }
 EXPORT_SYMBOL(hil_mmb_invalid_cache_byaddr);
@@ -619,28 +683,119 @@ int hil_mmb_free(hil_mmb_t *mmb)
 }
 EXPORT_SYMBOL(hil_mmb_free);
 
-#define MACH_MMB(p, val, member) do { \
-    hil_mmz_t *__mach_mmb_zone__ = NULL; \
-    (p) = NULL; \
-    list_for_each_entry(__mach_mmb_zone__, &g_mmz_list, list) { \
-        hil_mmb_t *__mach_mmb__ = NULL; \
-        list_for_each_entry(__mach_mmb__, &__mach_mmb_zone__->mmb_list, list) { \
-            if (__mach_mmb__->member == (val)) { \
-                (p) = __mach_mmb__; \
-                break; \
-            } \
-        } \
-        if ((p) != NULL) { \
-            break; \
-        } \
-    } \
-} while (0)
+static inline unsigned long mmb_index_key(const hil_mmb_t *mmb, int by_kvirt)
+{
+    return by_kvirt ? (unsigned long)(uintptr_t)mmb->kvirt : mmb->phys_addr;
+}
+
+static inline hil_mmb_t *mmb_index_entry(struct rb_node *node, int by_kvirt)
+{
+    return by_kvirt ? rb_entry(node, hil_mmb_t, kvirt_node) : rb_entry(node, hil_mmb_t, phys_node);
+}
+
+static void mmb_index_insert(struct rb_root *root, hil_mmb_t *mmb, int by_kvirt)
+{
+    struct rb_node **link = &root->rb_node;
+    struct rb_node *parent = NULL;
+    struct rb_node *node = by_kvirt ? &mmb->kvirt_node : &mmb->phys_node;
+    unsigned long key = mmb_index_key(mmb, by_kvirt);
+
+    while (*link != NULL) {
+        parent = *link;
+        if (key < mmb_index_key(mmb_index_entry(parent, by_kvirt), by_kvirt)) {
+            link = &parent->rb_left;
+        } else {
+            link = &parent->rb_right;
+        }
+    }
+
+    rb_link_node(node, parent, link);
+    rb_insert_color(node, root);
+}
+
+/*
+ * mmbs of one zone never overlap, neither in phys nor in kvirt space,
+ * so the mmb covering val is the one with the greatest key <= val.
+ */
+static hil_mmb_t *mmb_index_find(const struct rb_root *root, unsigned long val, int by_kvirt)
+{
+    struct rb_node *node = root->rb_node;
+    hil_mmb_t *floor = NULL;
+
+    while (node != NULL) {
+        hil_mmb_t *p = mmb_index_entry(node, by_kvirt);
+        if (val < mmb_index_key(p, by_kvirt)) {
+            node = node->rb_left;
+        } else {
+            floor = p;
+            node = node->rb_right;
+        }
+    }
+
+    if ((floor != NULL) && ((val - mmb_index_key(floor, by_kvirt)) < floor->length)) {
+        return floor;
+    }
+
+    return NULL;
+}
+
+static hil_mmb_t *mmb_index_lookup(unsigned long val, int by_kvirt, unsigned long *out_offset)
+{
+    hil_mmz_t *zone = NULL;
+    hil_mmb_t *p = NULL;
+
+    list_for_each_entry(zone, &g_mmz_list, list) {
+        p = mmb_index_find(by_kvirt ? &zone->mmb_kvirt_root : &zone->mmb_phys_root, val, by_kvirt);
+        if (p != NULL) {
+            if (out_offset != NULL) {
+                *out_offset = val - mmb_index_key(p, by_kvirt);
+            }
+            return p;
+        }
+    }
+
+    return NULL;
+}
+
+void mmz_mmb_index_insert_phys(hil_mmb_t *mmb)
+{
+    /* the mmb is not kernel-mapped yet */
+    RB_CLEAR_NODE(&mmb->kvirt_node);
+    mmb_index_insert(&mmb->zone->mmb_phys_root, mmb, 0);
+}
+
+void mmz_mmb_index_erase_phys(hil_mmb_t *mmb)
+{
+    mmz_mmb_index_erase_kvirt(mmb);
+    rb_erase(&mmb->phys_node, &mmb->zone->mmb_phys_root);
+    RB_CLEAR_NODE(&mmb->phys_node);
+}
+
+void mmz_mmb_index_insert_kvirt(hil_mmb_t *mmb)
+{
+    if ((mmb->kvirt == NULL) || !RB_EMPTY_NODE(&mmb->kvirt_node)) {
+        return;
+    }
+    mmb_index_insert(&mmb->zone->mmb_kvirt_root, mmb, 1);
+}
+
+void mmz_mmb_index_erase_kvirt(hil_mmb_t *mmb)
+{
+    if (RB_EMPTY_NODE(&mmb->kvirt_node)) {
+        return;
+    }
+    rb_erase(&mmb->kvirt_node, &mmb->zone->mmb_kvirt_root);
+    RB_CLEAR_NODE(&mmb->kvirt_node);
+}
 
 hil_mmb_t *hil_mmb_getby_phys(unsigned long addr)
 {
     hil_mmb_t *p = NULL;
     down(&g_mmz_lock);
-    MACH_MMB(p, addr, phys_addr);
+    p = mmb_index_lookup(addr, 0, NULL);
+    if ((p != NULL) && (p->phys_addr != addr)) {
+        p = NULL;
+    }
     up(&g_mmz_lock);
     return p;
 }
@@ -724,34 +879,16 @@ unsigned long usr_virt_to_phys(unsigned long virt)
 }
 EXPORT_SYMBOL(usr_virt_to_phys);
 
-#define mach_mmb_2(p, val, member, Outoffset) do { \
-    hil_mmz_t *__mach_mmb_zone__ = NULL; \
-    (p) = NULL; \
-    list_for_each_entry(__mach_mmb_zone__, &g_mmz_list, list) { \
-        hil_mmb_t *__mach_mmb__ = NULL; \
-        list_for_each_entry(__mach_mmb__, &__mach_mmb_zone__->mmb_list, list) { \
-            if ((__mach_mmb__->member <= (val)) && ((__mach_mmb__->length + __mach_mmb__->member) > (val))) { \
-                (p) = __mach_mmb__; \
-                (Outoffset) = (val) - __mach_mmb__->member; \
-                break; \
-            } \
-        } \
-        if ((p) != NULL) { \
-            break; \
-        } \
-    } \
-} while (0)
-
 hil_mmb_t *hil_mmb_getby_kvirt(void *virt)
 {
     hil_mmb_t *p = NULL;
-    unsigned long out_offset;
+    unsigned long out_offset = 0;
 
     if (virt == NULL) {
         return NULL;
     }
     down(&g_mmz_lock);
-    mach_mmb_2(p, virt, kvirt, out_offset);
+    p = mmb_index_lookup((unsigned long)(uintptr_t)virt, 1, &out_offset);
     up(&g_mmz_lock);
 
     mmz_trace(1, "Outoffset %lu \n", out_offset);
@@ -765,7 +902,7 @@ hil_mmb_t *hil_mmb_getby_phys_2(unsigned long addr, unsigned long *out_offset)
     hil_mmb_t *p = NULL;
 
     down(&g_mmz_lock);
-    mach_mmb_2(p, addr, phys_addr, *out_offset);
+    p = mmb_index_lookup(addr, 0, out_offset);
     up(&g_mmz_lock);
     return p;
 }
@@ -870,7 +1007,7 @@ int hil_map_mmz_register(hil_mmz_t *zone)
 
     down(&g_mmz_lock);
 
-    if (strcmp(g_setup_allocator, "hisi") == 0) {
+    if ((strcmp(g_setup_allocator, "hisi") == 0) || (strcmp(g_setup_allocator, "segfit") == 0)) {
         ret = _check_mmz(zone);
         if (ret != 0) {
             up(&g_mmz_lock);
@@ -885,6 +1022,8 @@ int hil_map_mmz_register(hil_mmz_t *zone)
     }
 
     OSAL_INIT_LIST_HEAD(&zone->mmb_list);
+    zone->mmb_phys_root = RB_ROOT;
+    zone->mmb_kvirt_root = RB_ROOT;
 
     osal_list_add(&zone->list, &g_map_mmz_list);
 
@@ -1005,7 +1144,7 @@ int hil_map_mmz_check_phys(unsigned long addr_start, unsigned long addr_len)
 }
 EXPORT_SYMBOL(hil_map_mmz_check_phys);
 
-int hil_vma_check(unsigned long vm_start, unsigned long vm_end)
+int hil_vma_check_flags(unsigned long vm_start, unsigned long vm_end, unsigned long vm_flags)
 {
     struct vm_area_struct *pvma1 = NULL;
     struct vm_area_struct *pvma2 = NULL;
@@ -1028,7 +1167,7 @@ int hil_vma_check(unsigned long vm_start, unsigned long vm_end)
         return -1;
     }
 
-    if (!(pvma1->vm_flags & VM_WRITE)) {
+    if ((pvma1->vm_flags & vm_flags) != vm_flags) {
         osal_trace(KERN_ERR "ERROR vma flag:0x%lx\n", pvma1->vm_flags);
         return -1;
     }
@@ -1041,6 +1180,12 @@ int hil_vma_check(unsigned long vm_start, unsigned long vm_end)
 
     return 0;
 }
+EXPORT_SYMBOL(hil_vma_check_flags);
+
+int hil_vma_check(unsigned long vm_start, unsigned long vm_end)
+{
+    return hil_vma_check_flags(vm_start, vm_end, VM_WRITE);
+}
 EXPORT_SYMBOL(hil_vma_check);
 
 int hil_is_phys_in_mmz(unsigned long addr_start, unsigned long addr_len)
@@ -1134,6 +1279,14 @@ int mmz_seq_show(struct osal_proc_dir_entry *sfile)
             used_size += mmb->length / 1024; /* 1024: 1KByte = 1024Byte */
             ++block_number;
         }
+
+        if (p->segfit != NULL) {
+            unsigned long free_bytes, extents, largest;
+
+            segfit_zone_stat(p, &free_bytes, &extents, &largest);
+            osal_seq_printf(sfile, "   segfit: free=%luKB, free_extents=%lu, largest_free=%luKB\n",
+                free_bytes / SZ_1K, extents, largest / SZ_1K);
+        }
     }
 
     if (mmz_total_size != 0) {
@@ -1221,9 +1374,11 @@ int media_mem_init(void)
 #endif
     } else if (strcmp(g_setup_allocator, "hisi") == 0) {
         ret = hisi_allocator_setopt(&g_the_allocator);
+    } else if (strcmp(g_setup_allocator, "segfit") == 0) {
+        ret = segfit_allocator_setopt(&g_the_allocator);
     } else {
-        osal_trace("The module param \"g_setup_allocator\" should be \"cma\" or \"hisi\", which is \"%s\"\n",
-            g_setup_allocator);
+        osal_trace("The module param \"g_setup_allocator\" should be \"cma\", \"hisi\" or \"segfit\", "
+            "which is \"%s\"\n", g_setup_allocator);
         mmz_exit_check();
         return -EINVAL;
     }
@@ -40,6 +40,7 @@
 #include <linux/time.h>
 #include <linux/sched.h>
 #include <linux/dma-mapping.h>
+#include <linux/sort.h>
 #include <linux/uaccess.h>
 #include <asm/uaccess.h>
 #include <asm/io.h>
@@ -66,6 +67,18 @@ struct mmz_userdev_info {
     struct osal_list_head list;
 };
 
+/*
+ * Cost model of IOC_MMB_FLUSH_RANGES, in nanoseconds: a range costs a
+ * fixed setup plus a per-KB part, the whole cache costs flush_all_cost
+ * and stalls every cpu. 0 disables the whole cache fallback.
+ */
+static unsigned int g_flush_all_cost = 200000;
+static unsigned int g_flush_range_setup_cost = 1000;
+static unsigned int g_flush_range_kb_cost = 500;
+module_param_named(flush_all_cost, g_flush_all_cost, uint, 0600);
+module_param_named(flush_range_setup_cost, g_flush_range_setup_cost, uint, 0600);
+module_param_named(flush_range_kb_cost, g_flush_range_kb_cost, uint, 0600);
+
 static int mmz_flush_dcache_mmb_dirty(struct dirty_area *p_area)
 {
     if (p_area == NULL) {
@@ -562,9 +575,83 @@ int ioctl_mmb_check_mmz_phy_addr(unsigned long long phy_addr, unsigned int len)
     return cmpi_check_mmz_phy_addr(phy_addr, len);
 }
 
-int ioctl_mmb_invalid_cache_byaddr(void *kvirt, unsigned long phys_addr, unsigned long len)
+/* the page of virt must be mapped to the page of phys, at the same offset; mmap_sem held */
+static int mmz_userdev_virt_maps_phys(unsigned long virt, unsigned long phys)
+{
+    unsigned long trans_phy;
+
+    if ((virt & ~PAGE_MASK) != (phys & ~PAGE_MASK)) {
+        return 0;
+    }
+    trans_phy = usr_virt_to_phys(virt & PAGE_MASK);
+    return (trans_phy != 0) && ((trans_phy & PAGE_MASK) == (phys & PAGE_MASK));
+}
+
+/*
+ * The range may be reached through any user mapping of an mmb: the
+ * IOC_MMB_USER_REMAP one of its owner, or a mapping of the phys address set up
+ * by another module (sys mmap, hifb). It must lie in one mmb and in one vma,
+ * and the first and last page of that vma range must map the phys range, so
+ * the phys address handed to the outer cache is memory the caller has mapped.
+ * The mmz mappings are one remap_pfn_range per vma, linear in between.
+ * Invalidate only needs the mapping to be readable, clean needs it writable.
+ */
+static int mmz_userdev_cache_op(struct file *file, const struct mmb_info *pmi, int clean)
+{
+    int ret;
+    struct mm_struct *mm = current->mm;
+    hil_mmb_t *mmb = NULL;
+    unsigned long offset = 0;
+    unsigned long virt = (unsigned long)(uintptr_t)pmi->mapped;
+    unsigned long phys = (unsigned long)pmi->phys_addr;
+    unsigned long len = pmi->size;
+
+    osal_unused(file);
+    if ((virt == 0) || (len == 0) || (virt + len < virt)) {
+        return -EINVAL;
+    }
+
+    mmb = hil_mmb_getby_phys_2(phys, &offset);
+    if ((mmb == NULL) || (len > mmb->length - offset)) {
+        osal_trace(KERN_WARNING "cache range 0x%lx+0x%lx is not inside one mmb!\n", phys, len);
+        return -EFAULT;
+    }
+
+#if LINUX_VERSION_CODE > KERNEL_VERSION(5,10,0)
+    down_read(&mm->mmap_lock);
+#else
+    down_read(&mm->mmap_sem);
+#endif
+
+    if (hil_vma_check_flags(virt, virt + len, clean ? VM_WRITE : VM_READ)) {
+        ret = -EPERM;
+    } else if (!mmz_userdev_virt_maps_phys(virt, phys) ||
+               !mmz_userdev_virt_maps_phys(virt + len - 1, phys + len - 1)) {
+        osal_trace(KERN_WARNING "cache range 0x%lx+0x%lx is not mapped at 0x%lx!\n", phys, len, virt);
+        ret = -EFAULT;
+    } else if (clean) {
+        ret = hil_mmb_clean_cache_byaddr(pmi->mapped, pmi->phys_addr, len);
+    } else {
+        ret = hil_mmb_invalid_cache_byaddr(pmi->mapped, pmi->phys_addr, len);
+    }
+
+#if LINUX_VERSION_CODE > KERNEL_VERSION(5,10,0)
+    up_read(&mm->mmap_lock);
+#else
+    up_read(&mm->mmap_sem);
+#endif
+
+    return ret;
+}
+
+int ioctl_mmb_invalid_cache_byaddr(struct file *file, const struct mmb_info *pmi)
 {
-    return hil_mmb_invalid_cache_byaddr(kvirt, phys_addr, len);
+    return mmz_userdev_cache_op(file, pmi, 0);
+}
+
+int ioctl_mmb_clean_cache_byaddr(struct file *file, const struct mmb_info *pmi)
+{
+    return mmz_userdev_cache_op(file, pmi, 1);
 }
 
 int ioctl_mmb_check_phy_in_priv(struct file const *file, struct mmb_info const *pmi)
@@ -610,6 +697,208 @@ int ioctl_mmb_user_mmf_unmap(void *virt_addr)
     return 0;
 }
 
+struct mmz_flush_item {
+    unsigned long phys;
+    unsigned long virt;
+    unsigned long size;
+    unsigned int op;
+    const struct vm_area_struct *vma; /* vma holding the range, set under mmap_sem */
+};
+
+static int mmz_flush_item_cmp(const void *a, const void *b)
+{
+    const struct mmz_flush_item *x = a;
+    const struct mmz_flush_item *y = b;
+
+    if (x->op != y->op) {
+        return (x->op < y->op) ? -1 : 1;
+    }
+    if (x->virt != y->virt) {
+        return (x->virt < y->virt) ? -1 : 1;
+    }
+    return 0;
+}
+
+/*
+ * merge overlapping or adjacent ranges of the same op inside one vma, with
+ * the same virt to phys offset. Two mmbs mapped next to each other are two
+ * vmas, a merged range over them would fail hil_vma_check.
+ */
+static unsigned int mmz_flush_items_coalesce(struct mmz_flush_item *items, unsigned int count)
+{
+    unsigned int i;
+    unsigned int n = 1;
+
+    for (i = 1; i < count; i++) {
+        struct mmz_flush_item *last = &items[n - 1];
+        unsigned long end;
+
+        if ((items[i].op == last->op) && (items[i].vma == last->vma) &&
+            (items[i].virt <= (last->virt + last->size)) &&
+            ((items[i].virt - last->virt) == (items[i].phys - last->phys))) {
+            end = max(last->virt + last->size, items[i].virt + items[i].size);
+            last->size = end - last->virt;
+            continue;
+        }
+        items[n++] = items[i];
+    }
+
+    return n;
+}
+
+static int mmz_flush_items_use_all(const struct mmz_flush_item *items, unsigned int count)
+{
+#ifdef CONFIG_64BIT
+    /* flush_cache_all is a stub on 64-bit, ranges are the only way */
+    osal_unused(items);
+    osal_unused(count);
+    return 0;
+#else
+    unsigned long long cost = 0;
+    unsigned int i;
+
+    if (g_flush_all_cost == 0) {
+        return 0;
+    }
+
+    for (i = 0; i < count; i++) {
+        cost += g_flush_range_setup_cost +
+                (unsigned long long)g_flush_range_kb_cost * DIV_ROUND_UP(items[i].size, SZ_1K);
+    }
+
+    return cost > g_flush_all_cost;
+#endif
+}
+
+static int mmz_flush_item_check(struct mmz_userdev_info *pmu, const struct mmz_cache_range *range,
+                                struct mmz_flush_item *item)
+{
+    hil_mmb_t *mmb = NULL;
+    struct mmb_info *pmi = NULL;
+    unsigned long offset = 0;
+
+    if ((range->size == 0) || (range->op > MMZ_CACHE_OP_INVALID)) {
+        return -EINVAL;
+    }
+
+    mmb = hil_mmb_getby_phys_2(range->phys_addr, &offset);
+    if (mmb == NULL) {
+        return -EFAULT;
+    }
+
+    pmi = get_mmbinfo_safe(mmb->phys_addr, pmu);
+    if (pmi == NULL) {
+        return -EPERM;
+    }
+
+    if (((uintptr_t)range->virt_addr != (uintptr_t)pmi->mapped + offset) ||
+        (range->size > (mmb->length - offset))) {
+        osal_trace(KERN_WARNING "flush range 0x%lx+0x%lx is not consistent with mmb<%s>!\n",
+            (unsigned long)range->phys_addr, (unsigned long)range->size, mmb->name);
+        return -EFAULT;
+    }
+
+    item->phys = range->phys_addr;
+    item->virt = (unsigned long)(uintptr_t)range->virt_addr;
+    item->size = range->size;
+    item->op = range->op;
+    item->vma = NULL;
+
+    return 0;
+}
+
+static void mmz_flush_item_do(const struct mmz_flush_item *item)
+{
+    void *virt = (void *)(uintptr_t)item->virt;
+
+    if (item->op == MMZ_CACHE_OP_CLEAN) {
+        hil_mmb_clean_cache_byaddr(virt, item->phys, item->size);
+    } else if (item->op == MMZ_CACHE_OP_INVALID) {
+        hil_mmb_invalid_cache_byaddr(virt, item->phys, item->size);
+    } else {
+        hil_mmb_flush_dcache_byaddr(virt, item->phys, item->size);
+    }
+}
+
+static int ioctl_mmb_flush_ranges(struct mmz_userdev_info *pmu, struct mmz_cache_ranges *req)
+{
+    struct mmz_cache_range *ranges = NULL;
+    struct mmz_flush_item *items = NULL;
+    struct mm_struct *mm = current->mm;
+    unsigned int count;
+    unsigned int i;
+    int ret = 0;
+
+    if ((req->count == 0) || (req->count > MMZ_CACHE_RANGE_MAX) || (req->ranges == NULL)) {
+        return -EINVAL;
+    }
+
+    ranges = kmalloc(sizeof(*ranges) * req->count, GFP_KERNEL);
+    items = kmalloc(sizeof(*items) * req->count, GFP_KERNEL);
+    if ((ranges == NULL) || (items == NULL)) {
+        ret = -ENOMEM;
+        goto out;
+    }
+
+    if (copy_from_user(ranges, (void __user *)req->ranges, sizeof(*ranges) * req->count)) {
+        ret = -EFAULT;
+        goto out;
+    }
+
+    for (i = 0; i < req->count; i++) {
+        ret = mmz_flush_item_check(pmu, &ranges[i], &items[i]);
+        if (ret != 0) {
+            goto out;
+        }
+    }
+
+    sort(items, req->count, sizeof(*items), mmz_flush_item_cmp, NULL);
+
+#if LINUX_VERSION_CODE > KERNEL_VERSION(5,10,0)
+    down_read(&mm->mmap_lock);
+#else
+    down_read(&mm->mmap_sem);
+#endif
+    /* all or nothing: every range is checked before the cache is touched */
+    for (i = 0; i < req->count; i++) {
+        if (hil_vma_check(items[i].virt, items[i].virt + items[i].size)) {
+            ret = -EPERM;
+            goto unlock;
+        }
+        items[i].vma = find_vma(mm, items[i].virt);
+    }
+
+    count = mmz_flush_items_coalesce(items, req->count);
+
+    req->merged_count = count;
+    req->total_size = 0;
+    for (i = 0; i < count; i++) {
+        req->total_size += items[i].size;
+    }
+
+    req->flush_all = mmz_flush_items_use_all(items, count);
+    if (req->flush_all) {
+        mmz_flush_dcache_all();
+        goto unlock;
+    }
+
+    for (i = 0; i < count; i++) {
+        mmz_flush_item_do(&items[i]);
+    }
+
+unlock:
+#if LINUX_VERSION_CODE > KERNEL_VERSION(5,10,0)
+    up_read(&mm->mmap_lock);
+#else
+    up_read(&mm->mmap_sem);
+#endif
+
+out:
+    kfree(items);
+    kfree(ranges);
+    return ret;
+}
+
 static int mmz_userdev_ioctl_m(struct file *file, unsigned int cmd, struct mmb_info *pmi)
 {
     int ret;
@@ -647,7 +936,10 @@ static int mmz_userdev_ioctl_m(struct file *file, unsigned int cmd, struct mmb_i
             ret = ioctl_mmb_check_mmz_phy_addr(pmi->phys_addr, pmi->size);
             break;
         case _IOC_NR(IOC_MMB_INVALID_CACHE):
-            ret = ioctl_mmb_invalid_cache_byaddr(pmi->mapped, pmi->phys_addr, pmi->size);
+            ret = ioctl_mmb_invalid_cache_byaddr(file, pmi);
+            break;
+        case _IOC_NR(IOC_MMB_CLEAN_CACHE):
+            ret = ioctl_mmb_clean_cache_byaddr(file, pmi);
             break;
         case _IOC_NR(IOC_MMB_CHECK_PHY_ALLOC):
             ret = ioctl_mmb_check_phy_in_priv(file, pmi);
@@ -844,6 +1136,27 @@ static long mmz_userdev_ioctl(struct file *file, unsigned int cmd, unsigned long
 #else
         up_read(&mm->mmap_sem);
 #endif
+    } else if (_IOC_TYPE(cmd) == 'f') {
+        struct mmz_cache_ranges req;
+
+        if ((cmd != IOC_MMB_FLUSH_RANGES) || (arg == 0)) {
+            error_mmz("cmd=%08X, arg==0x%08lx\n", cmd, arg);
+            ret = -EINVAL;
+            goto __error_exit;
+        }
+
+        (void)memset_s(&req, sizeof(req), 0, sizeof(req));
+        if (copy_from_user(&req, (void *)(uintptr_t)arg, sizeof(req))) {
+            osal_trace("\nmmz_userdev_ioctl: copy_from_user error.\n");
+            ret = -EFAULT;
+            goto __error_exit;
+        }
+
+        ret = ioctl_mmb_flush_ranges(pmu, &req);
+        if ((ret == 0) && copy_to_user((void *)(uintptr_t)arg, &req, sizeof(req))) {
+            osal_trace("\nmmz_userdev_ioctl: copy_to_user error.\n");
+            ret = -EFAULT;
+        }
     } else if (_IOC_TYPE(cmd) == 't') {
         struct mmb_info mi;
 
@@ -0,0 +1,431 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Segregated-fit backend for the hisi allocator.
+ *
+ * Every zone keeps its free extents in an rbtree sorted by address (for
+ * coalescing on free) and in power-of-two size class lists (for the search
+ * on alloc). A bitmap of non-empty classes lets the search skip straight
+ * to the first class that can hold the request, so neither alloc nor free
+ * walks the zone's mmb_list. HIGH_TO_LOW requests must land at the highest
+ * address that fits, so they walk the free extents by address from the top
+ * instead. Mapping, unmapping and cmdline parsing are
+ * shared with the hisi allocator.
+ */
+
+#include <linux/slab.h>
+#include <linux/bitops.h>
+#include <linux/rbtree.h>
+#include <linux/list.h>
+#include "securec.h"
+#include "allocator.h"
+
+#define SEGFIT_CLASS_NUM    32
+
+struct segfit_extent {
+    struct rb_node node;
+    struct osal_list_head list;
+    unsigned int cls;
+    unsigned long start;
+    unsigned long len;
+};
+
+struct mmz_segfit {
+    struct rb_root root;
+    struct osal_list_head class_list[SEGFIT_CLASS_NUM];
+    DECLARE_BITMAP(class_map, SEGFIT_CLASS_NUM);
+    unsigned long extent_cnt;
+    unsigned long free_bytes;
+};
+
+extern struct osal_list_head g_mmz_list;
+
+static int (*g_hisi_allocator_init)(char *args);
+
+static unsigned int segfit_class(unsigned long len)
+{
+    unsigned long grains = len / MMZ_GRAIN;
+    unsigned int cls;
+
+    if (grains == 0) {
+        return 0;
+    }
+    cls = (unsigned int)(fls_long(grains) - 1);
+
+    return (cls < SEGFIT_CLASS_NUM) ? cls : (SEGFIT_CLASS_NUM - 1);
+}
+
+static void segfit_class_add(struct mmz_segfit *sf, struct segfit_extent *ext)
+{
+    ext->cls = segfit_class(ext->len);
+    osal_list_add(&ext->list, &sf->class_list[ext->cls]);
+    set_bit(ext->cls, sf->class_map);
+}
+
+static void segfit_class_del(struct mmz_segfit *sf, struct segfit_extent *ext)
+{
+    osal_list_del(&ext->list);
+    if (osal_list_empty(&sf->class_list[ext->cls])) {
+        clear_bit(ext->cls, sf->class_map);
+    }
+}
+
+static void segfit_tree_insert(struct mmz_segfit *sf, struct segfit_extent *ext)
+{
+    struct rb_node **link = &sf->root.rb_node;
+    struct rb_node *parent = NULL;
+
+    while (*link != NULL) {
+        parent = *link;
+        if (ext->start < rb_entry(parent, struct segfit_extent, node)->start) {
+            link = &parent->rb_left;
+        } else {
+            link = &parent->rb_right;
+        }
+    }
+
+    rb_link_node(&ext->node, parent, link);
+    rb_insert_color(&ext->node, &sf->root);
+}
+
+/* the free extent with the greatest start <= addr */
+static struct segfit_extent *segfit_tree_floor(const struct mmz_segfit *sf, unsigned long addr)
+{
+    struct rb_node *node = sf->root.rb_node;
+    struct segfit_extent *floor = NULL;
+
+    while (node != NULL) {
+        struct segfit_extent *ext = rb_entry(node, struct segfit_extent, node);
+        if (addr < ext->start) {
+            node = node->rb_left;
+        } else {
+            floor = ext;
+            node = node->rb_right;
+        }
+    }
+
+    return floor;
+}
+
+static void segfit_extent_remove(struct mmz_segfit *sf, struct segfit_extent *ext)
+{
+    segfit_class_del(sf, ext);
+    rb_erase(&ext->node, &sf->root);
+    sf->extent_cnt--;
+    kfree(ext);
+}
+
+static int segfit_extent_fit(const struct segfit_extent *ext, unsigned long size,
+                             unsigned long align, unsigned int order, unsigned long *start)
+{
+    unsigned long end = ext->start + ext->len;
+    unsigned long pos;
+
+    if (ext->len < size) {
+        return 0;
+    }
+
+    if (order == HIGH_TO_LOW) {
+        pos = mmz_align2low(end - size, align);
+        if (pos < ext->start) {
+            return 0;
+        }
+    } else {
+        pos = mmz_align2(ext->start, align);
+        if ((pos < ext->start) || (pos > end) || ((end - pos) < size)) {
+            return 0;
+        }
+    }
+
+    *start = pos;
+    return 1;
+}
+
+static struct mmz_segfit *segfit_zone_attach(hil_mmz_t *zone)
+{
+    struct mmz_segfit *sf = NULL;
+    struct segfit_extent *ext = NULL;
+    unsigned int i;
+
+    sf = kzalloc(sizeof(*sf), GFP_KERNEL);
+    ext = kzalloc(sizeof(*ext), GFP_KERNEL);
+    if ((sf == NULL) || (ext == NULL)) {
+        osal_trace(KERN_ERR "%s: System OOM!\n", __func__);
+        kfree(sf);
+        kfree(ext);
+        return NULL;
+    }
+
+    sf->root = RB_ROOT;
+    for (i = 0; i < SEGFIT_CLASS_NUM; i++) {
+        OSAL_INIT_LIST_HEAD(&sf->class_list[i]);
+    }
+
+    ext->start = mmz_grain_align(zone->phys_start);
+    ext->len = mmz_align2low(zone->phys_start + zone->nbytes, MMZ_GRAIN) - ext->start;
+    segfit_tree_insert(sf, ext);
+    segfit_class_add(sf, ext);
+    sf->extent_cnt = 1;
+    sf->free_bytes = ext->len;
+
+    return sf;
+}
+
+static void segfit_zone_destructor(const void *p)
+{
+    hil_mmz_t *zone = (hil_mmz_t *)p;
+    struct mmz_segfit *sf = zone->segfit;
+    struct rb_node *node = NULL;
+
+    if (sf != NULL) {
+        while ((node = rb_first(&sf->root)) != NULL) {
+            segfit_extent_remove(sf, rb_entry(node, struct segfit_extent, node));
+        }
+        kfree(sf);
+        zone->segfit = NULL;
+    }
+
+    kfree(zone);
+}
+
+unsigned long segfit_find_region(unsigned long *region_len, hil_mmz_t *mmz, unsigned long size,
+                                 unsigned long align, unsigned int order)
+{
+    struct mmz_segfit *sf = mmz->segfit;
+    struct segfit_extent *ext = NULL;
+    struct rb_node *node = NULL;
+    unsigned long start;
+    unsigned int cls;
+
+    align = mmz_grain_align(align);
+    if (align == 0) {
+        align = MMZ_GRAIN;
+    }
+    size = mmz_grain_align(size);
+
+    /*
+     * Same placement as find_fixed_region_from_highaddr: the first extent
+     * from the top that fits holds the highest fitting start in the zone.
+     */
+    if (order == HIGH_TO_LOW) {
+        for (node = rb_last(&sf->root); node != NULL; node = rb_prev(node)) {
+            ext = rb_entry(node, struct segfit_extent, node);
+            if (segfit_extent_fit(ext, size, align, order, &start)) {
+                *region_len = ext->len;
+                return start;
+            }
+        }
+
+        *region_len = size;
+        return 0;
+    }
+
+    /*
+     * Extents of the request's own class may still be too small, extents
+     * of any higher class are large enough and only alignment can fail,
+     * so the first hit there is normally the first extent tried.
+     */
+    for (cls = find_next_bit(sf->class_map, SEGFIT_CLASS_NUM, segfit_class(size));
+         cls < SEGFIT_CLASS_NUM;
+         cls = find_next_bit(sf->class_map, SEGFIT_CLASS_NUM, cls + 1)) {
+        osal_list_for_each_entry(ext, &sf->class_list[cls], list) {
+            if (segfit_extent_fit(ext, size, align, order, &start)) {
+                *region_len = ext->len;
+                return start;
+            }
+        }
+    }
+
+    *region_len = size;
+    return 0;
+}
+
+int segfit_reserve_region(hil_mmz_t *mmz, unsigned long start, unsigned long size)
+{
+    struct mmz_segfit *sf = mmz->segfit;
+    struct segfit_extent *ext = NULL;
+    struct segfit_extent *tail = NULL;
+    unsigned long end;
+    unsigned long ext_end;
+
+    size = mmz_grain_align(size);
+    end = start + size;
+
+    ext = segfit_tree_floor(sf, start);
+    if ((ext == NULL) || ((end - ext->start) > ext->len)) {
+        osal_trace(KERN_ERR "ERROR: segfit region 0x%08lX+0x%lx is not free in %s\n",
+            start, size, mmz->name);
+        return -1;
+    }
+    ext_end = ext->start + ext->len;
+
+    /* a hole in the middle of the extent needs a second descriptor */
+    if ((start > ext->start) && (end < ext_end)) {
+        tail = kzalloc(sizeof(*tail), GFP_KERNEL);
+        if (tail == NULL) {
+            osal_trace(KERN_ERR "%s: System OOM!\n", __func__);
+            return -1;
+        }
+        tail->start = end;
+        tail->len = ext_end - end;
+    }
+
+    segfit_class_del(sf, ext);
+    if (start > ext->start) {
+        ext->len = start - ext->start;
+        segfit_class_add(sf, ext);
+    } else if (end < ext_end) {
+        /* keeps its place in the tree, no neighbour lies in between */
+        ext->start = end;
+        ext->len = ext_end - end;
+        segfit_class_add(sf, ext);
+    } else {
+        rb_erase(&ext->node, &sf->root);
+        sf->extent_cnt--;
+        kfree(ext);
+    }
+
+    if (tail != NULL) {
+        segfit_tree_insert(sf, tail);
+        segfit_class_add(sf, tail);
+        sf->extent_cnt++;
+    }
+
+    sf->free_bytes -= size;
+
+    return 0;
+}
+
+void segfit_release_region(hil_mmz_t *mmz, unsigned long start, unsigned long size)
+{
+    struct mmz_segfit *sf = mmz->segfit;
+    struct segfit_extent *prev = NULL;
+    struct segfit_extent *next = NULL;
+    struct segfit_extent *ext = NULL;
+    struct rb_node *node = NULL;
+
+    size = mmz_grain_align(size);
+
+    prev = segfit_tree_floor(sf, start);
+    node = (prev != NULL) ? rb_next(&prev->node) : rb_first(&sf->root);
+    if (node != NULL) {
+        next = rb_entry(node, struct segfit_extent, node);
+    }
+
+    if ((prev != NULL) && ((prev->start + prev->len) != start)) {
+        prev = NULL;
+    }
+    if ((next != NULL) && (next->start != (start + size))) {
+        next = NULL;
+    }
+
+    sf->free_bytes += size;
+
+    if (prev != NULL) {
+        segfit_class_del(sf, prev);
+        prev->len += size;
+        if (next != NULL) {
+            prev->len += next->len;
+            segfit_extent_remove(sf, next);
+        }
+        segfit_class_add(sf, prev);
+        return;
+    }
+
+    if (next != NULL) {
+        segfit_class_del(sf, next);
+        next->start = start;
+        next->len += size;
+        segfit_class_add(sf, next);
+        return;
+    }
+
+    ext = kzalloc(sizeof(*ext), GFP_KERNEL);
+    if (ext == NULL) {
+        osal_trace(KERN_ERR "ERROR: segfit lost region 0x%08lX+0x%lx in %s, System OOM!\n",
+            start, size, mmz->name);
+        sf->free_bytes -= size;
+        return;
+    }
+    ext->start = start;
+    ext->len = size;
+    segfit_tree_insert(sf, ext);
+    segfit_class_add(sf, ext);
+    sf->extent_cnt++;
+}
+
+void segfit_zone_stat(hil_mmz_t *mmz, unsigned long *free_bytes, unsigned long *extents,
+                      unsigned long *largest)
+{
+    struct mmz_segfit *sf = mmz->segfit;
+    struct segfit_extent *ext = NULL;
+    unsigned int cls;
+
+    *free_bytes = sf->free_bytes;
+    *extents = sf->extent_cnt;
+    *largest = 0;
+
+    for (cls = SEGFIT_CLASS_NUM; cls > 0; cls--) {
+        if (!test_bit(cls - 1, sf->class_map)) {
+            continue;
+        }
+        osal_list_for_each_entry(ext, &sf->class_list[cls - 1], list) {
+            if (ext->len > *largest) {
+                *largest = ext->len;
+            }
+        }
+        break;
+    }
+}
+
+static int segfit_allocator_init(char *s)
+{
+    hil_mmz_t *zone = NULL;
+    int ret;
+
+    ret = g_hisi_allocator_init(s);
+    if (ret != 0) {
+        return ret;
+    }
+
+    osal_list_for_each_entry(zone, &g_mmz_list, list) {
+        zone->segfit = segfit_zone_attach(zone);
+        if (zone->segfit == NULL) {
+            return -ENOMEM;
+        }
+        zone->destructor = segfit_zone_destructor;
+    }
+
+    return 0;
+}
+
+int segfit_allocator_setopt(struct mmz_allocator *allocator)
+{
+    int ret;
+
+    ret = hisi_allocator_setopt(allocator);
+    if (ret != 0) {
+        return ret;
+    }
+
+    g_hisi_allocator_init = allocator->init;
+    allocator->init = segfit_allocator_init;
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host test of IOC_MMB_INVALID_CACHE and IOC_MMB_CLEAN_CACHE (mmz_userdev.c).
+ *
+ *   cache_op_edges              run the checks
+ *
+ * The range is given as a user address and a phys address. It is accepted
+ * through any mapping of an mmb, the IOC_MMB_USER_REMAP one of the caller or
+ * one set up by another module, when both edges of the user range map the
+ * matching phys bytes. Edges that are not word, line or page aligned, ranges
+ * ending on the last byte of an mmb and ranges crossing a page are checked to
+ * reach the outer cache unchanged; ranges leaving the mmb or the vma, a user
+ * address of another page or offset, and a clean of a read-only mapping are
+ * refused before any maintenance.
+ */
+
+#include "mmz_userdev.c"
+#include "userdev_host.h"
+
+#define EDGE_MMB_SIZE   (4 * PAGE_SIZE)
+
+static int cache_op(unsigned int cmd, unsigned long virt, unsigned long phys, unsigned long len)
+{
+    struct mmb_info mi = { 0 };
+
+    mi.mapped = (void *)(uintptr_t)virt;
+    mi.phys_addr = phys;
+    mi.size = len;
+    host_op_reset();
+    return (int)mmz_userdev_ioctl(&g_host_file, cmd, (unsigned long)(uintptr_t)&mi);
+}
+
+/* the call succeeded and handed exactly [phys, phys + len) to the cache */
+static int cache_op_ok(unsigned int cmd, unsigned long virt, unsigned long phys, unsigned long len)
+{
+    unsigned int op = (cmd == IOC_MMB_CLEAN_CACHE) ? HOST_OP_CLEAN : HOST_OP_INVALID;
+
+    if (cache_op(cmd, virt, phys, len) != 0) {
+        return 0;
+    }
+    return (g_host.op_cnt == 1) && (g_host.op[0].op == op) && (g_host.op[0].phys == phys) &&
+           (g_host.op[0].virt == virt) && (g_host.op[0].len == len) && (g_host.unlocked == 0);
+}
+
+/* the call failed with err and no maintenance was done */
+static int cache_op_err(unsigned int cmd, unsigned long virt, unsigned long phys, unsigned long len, int err)
+{
+    return (cache_op(cmd, virt, phys, len) == err) && (g_host.op_cnt == 0);
+}
+
+static void test_own_mapping(unsigned long virt, unsigned long phys)
+{
+    tool_check(cache_op_ok(IOC_MMB_INVALID_CACHE, virt, phys, EDGE_MMB_SIZE), "whole mmb");
+    tool_check(cache_op_ok(IOC_MMB_CLEAN_CACHE, virt, phys, EDGE_MMB_SIZE), "whole mmb, clean");
+    tool_check(cache_op_ok(IOC_MMB_INVALID_CACHE, virt + 1, phys + 1, 3), "unaligned start and end");
+    tool_check(cache_op_ok(IOC_MMB_INVALID_CACHE, virt + 33, phys + 33, 62), "edges inside cache lines");
+    tool_check(cache_op_ok(IOC_MMB_INVALID_CACHE, virt + PAGE_SIZE - 3, phys + PAGE_SIZE - 3, 7),
+        "range crossing a page");
+    tool_check(cache_op_ok(IOC_MMB_INVALID_CACHE, virt + EDGE_MMB_SIZE - 5, phys + EDGE_MMB_SIZE - 5, 5),
+        "range ending on the last byte of the mmb");
+    tool_check(cache_op_ok(IOC_MMB_INVALID_CACHE, virt + EDGE_MMB_SIZE - 1, phys + EDGE_MMB_SIZE - 1, 1),
+        "last byte of the mmb");
+    tool_check(cache_op_err(IOC_MMB_INVALID_CACHE, virt + EDGE_MMB_SIZE - 4, phys + EDGE_MMB_SIZE - 4, 5, -EFAULT),
+        "one byte past the mmb");
+    tool_check(cache_op_err(IOC_MMB_INVALID_CACHE, virt, phys, 0, -EINVAL), "empty range");
+    tool_check(cache_op_err(IOC_MMB_INVALID_CACHE, virt, phys, ~0UL, -EINVAL), "wrapping range");
+}
+
+static void test_foreign_mapping(unsigned long own_phys)
+{
+    hil_mmb_t *mmb = hil_mmb_alloc("hifb", EDGE_MMB_SIZE, 0, 0, NULL);
+    unsigned long fb = host_map_phys(mmb->phys_addr, EDGE_MMB_SIZE, VM_READ | VM_WRITE);
+    unsigned long sys = host_map_phys(own_phys + PAGE_SIZE, 2 * PAGE_SIZE, VM_READ | VM_WRITE);
+    unsigned long ro = host_map_phys(mmb->phys_addr, PAGE_SIZE, VM_READ);
+
+    tool_check(cache_op_ok(IOC_MMB_INVALID_CACHE, fb + 7, mmb->phys_addr + 7, 3 * PAGE_SIZE),
+        "mapping of an mmb of another module");
+    tool_check(cache_op_ok(IOC_MMB_CLEAN_CACHE, fb + EDGE_MMB_SIZE - 2, mmb->phys_addr + EDGE_MMB_SIZE - 2, 2),
+        "mapping of an mmb of another module, clean of its last bytes");
+    tool_check(cache_op_ok(IOC_MMB_INVALID_CACHE, sys + 5, own_phys + PAGE_SIZE + 5, PAGE_SIZE),
+        "second mapping of a part of an own mmb");
+    tool_check(cache_op_err(IOC_MMB_INVALID_CACHE, sys + 5, own_phys + 5, PAGE_SIZE, -EFAULT),
+        "user address of another page");
+    tool_check(cache_op_err(IOC_MMB_INVALID_CACHE, sys + 5, own_phys + PAGE_SIZE + 6, 8, -EFAULT),
+        "user address of another offset");
+    tool_check(cache_op_err(IOC_MMB_INVALID_CACHE, sys + PAGE_SIZE, own_phys + 2 * PAGE_SIZE, 2 * PAGE_SIZE,
+        -EPERM), "range leaving the vma");
+    tool_check(cache_op_ok(IOC_MMB_INVALID_CACHE, ro + 1, mmb->phys_addr + 1, 9), "read-only mapping, invalidate");
+    tool_check(cache_op_err(IOC_MMB_CLEAN_CACHE, ro + 1, mmb->phys_addr + 1, 9, -EPERM),
+        "read-only mapping, clean");
+    tool_check(cache_op_err(IOC_MMB_INVALID_CACHE, g_host.virt_next + PAGE_SIZE, mmb->phys_addr, 4, -EPERM),
+        "unmapped user address");
+    tool_check(cache_op_err(IOC_MMB_INVALID_CACHE, fb, g_host.phys_next + PAGE_SIZE, 4, -EFAULT),
+        "phys outside every mmb");
+}
+
+int main(void)
+{
+    unsigned long phys = 0;
+    unsigned long virt;
+
+    host_open();
+    virt = host_mmb_map("edge", EDGE_MMB_SIZE, &phys);
+    tool_check(virt != 0, "map an mmb");
+    /* a neighbour mapped right after it, so a range past the end hits mapped memory */
+    tool_check(host_mmb_map("next", EDGE_MMB_SIZE, &(unsigned long){ 0 }) == virt + EDGE_MMB_SIZE,
+        "map the neighbour mmb");
+    test_own_mapping(virt, phys);
+    test_foreign_mapping(phys);
+    host_close();
+
+    if (g_fail != 0) {
+        printf("%u check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
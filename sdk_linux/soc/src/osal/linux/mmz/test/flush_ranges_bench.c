@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host test and benchmark of IOC_MMB_FLUSH_RANGES (mmz_userdev.c).
+ *
+ *   flush_ranges_bench          run the checks, then time the ioctl for
+ *                               scattered and adjacent ranges of 1..256 entries
+ *
+ * The checks cover ranges of two mmbs mapped back to back (phys and virt
+ * contiguous, two vmas), a mapping split by mprotect, merging inside one vma,
+ * the all or nothing failure and the whole cache fallback of the cost model.
+ * The benchmark reports the driver time per call on the host (copy, checks,
+ * sort, vma lookup, coalescing; the cache maintenance itself is logged only),
+ * with the merged ranges and the modelled cost of the maintenance.
+ */
+
+#include "mmz_userdev.c"
+#include "userdev_host.h"
+
+#define BENCH_MMB_CNT   8
+#define BENCH_MMB_SIZE  (1 * SZ_1M)
+#define BENCH_LOOPS     2000
+#define BENCH_SEED      20211123
+
+static struct {
+    unsigned long virt[BENCH_MMB_CNT];
+    unsigned long phys[BENCH_MMB_CNT];
+} g_map;
+
+static struct mmz_cache_range g_range[MMZ_CACHE_RANGE_MAX];
+
+static void set_range(struct mmz_cache_range *r, unsigned int mmb, unsigned long offset,
+                      unsigned long size, unsigned int op)
+{
+    r->phys_addr = g_map.phys[mmb] + offset;
+    r->virt_addr = (void *)(uintptr_t)(g_map.virt[mmb] + offset);
+    r->size = size;
+    r->op = op;
+}
+
+static int flush_ranges(unsigned int count, struct mmz_cache_ranges *req)
+{
+    (void)memset_s(req, sizeof(*req), 0, sizeof(*req));
+    req->ranges = g_range;
+    req->count = count;
+    host_op_reset();
+    return (int)mmz_userdev_ioctl(&g_host_file, IOC_MMB_FLUSH_RANGES, (unsigned long)(uintptr_t)req);
+}
+
+static void map_all(void)
+{
+    unsigned int i;
+    char name[16]; /* 16: "bench%u" */
+
+    host_open();
+    for (i = 0; i < BENCH_MMB_CNT; i++) {
+        (void)snprintf_s(name, sizeof(name), sizeof(name) - 1, "bench%u", i);
+        g_map.virt[i] = host_mmb_map(name, BENCH_MMB_SIZE, &g_map.phys[i]);
+    }
+}
+
+static void test_checks(void)
+{
+    struct mmz_cache_ranges req;
+    unsigned long tail = BENCH_MMB_SIZE - SZ_1K * 4; /* 4: last 4KB of the mmb */
+    int ret;
+
+    map_all();
+    tool_check((g_map.virt[1] == g_map.virt[0] + BENCH_MMB_SIZE) &&
+        (g_map.phys[1] == g_map.phys[0] + BENCH_MMB_SIZE), "mmb 0 and 1 are back to back in phys and virt");
+
+    /* the tail of mmb 0 and the head of mmb 1 look like one range, but they are two vmas */
+    set_range(&g_range[0], 0, tail, SZ_1K * 4, MMZ_CACHE_OP_CLEAN);
+    set_range(&g_range[1], 1, 0, SZ_1K * 4, MMZ_CACHE_OP_CLEAN);
+    ret = flush_ranges(2, &req);
+    tool_check((ret == 0) && (req.merged_count == 2) && (g_host.op_cnt == 2),
+        "ranges of two adjacent mappings are not merged and are both cleaned");
+
+    /* inside one vma, overlapping and adjacent ranges become one */
+    set_range(&g_range[0], 2, 0, SZ_1K * 8, MMZ_CACHE_OP_FLUSH);
+    set_range(&g_range[1], 2, SZ_1K * 4, SZ_1K * 8, MMZ_CACHE_OP_FLUSH);
+    set_range(&g_range[2], 2, SZ_1K * 12, SZ_1K * 4, MMZ_CACHE_OP_FLUSH);
+    set_range(&g_range[3], 2, SZ_1K * 12, SZ_1K * 4, MMZ_CACHE_OP_INVALID);
+    ret = flush_ranges(4, &req);
+    tool_check((ret == 0) && (req.merged_count == 2) && (req.total_size == SZ_1K * 20) &&
+        (g_host.op_cnt == 2) && (g_host.op[0].len == SZ_1K * 16), "ranges of one vma merge per op");
+    tool_check(g_host.unlocked == 0, "maintenance runs under mmap_sem");
+
+    /* mprotect splits mapping 3, each half is checked and maintained on its own */
+    host_mprotect(g_map.virt[3] + SZ_1K * 64, g_map.virt[3] + BENCH_MMB_SIZE, VM_READ | VM_WRITE | 0x100);
+    set_range(&g_range[0], 3, SZ_1K * 60, SZ_1K * 4, MMZ_CACHE_OP_FLUSH);
+    set_range(&g_range[1], 3, SZ_1K * 64, SZ_1K * 4, MMZ_CACHE_OP_FLUSH);
+    ret = flush_ranges(2, &req);
+    tool_check((ret == 0) && (req.merged_count == 2) && (g_host.op_cnt == 2),
+        "ranges of a mapping split by mprotect are not merged");
+
+    /* a read only part fails the call before any maintenance */
+    host_mprotect(g_map.virt[4] + SZ_1K * 64, g_map.virt[4] + SZ_1K * 128, VM_READ);
+    set_range(&g_range[0], 4, 0, SZ_1K * 4, MMZ_CACHE_OP_INVALID);
+    set_range(&g_range[1], 5, 0, SZ_1K * 4, MMZ_CACHE_OP_INVALID);
+    set_range(&g_range[2], 4, SZ_1K * 64, SZ_1K * 4, MMZ_CACHE_OP_INVALID);
+    ret = flush_ranges(3, &req);
+    tool_check((ret == -EPERM) && (g_host.op_cnt == 0) && (g_host.flush_all == 0),
+        "a range of a read only vma fails the call with nothing maintained");
+
+    /* virt not matching the phys of the caller's mapping */
+    set_range(&g_range[0], 5, 0, SZ_1K * 4, MMZ_CACHE_OP_FLUSH);
+    g_range[0].virt_addr = (void *)(uintptr_t)(g_map.virt[6]);
+    ret = flush_ranges(1, &req);
+    tool_check((ret == -EFAULT) && (g_host.op_cnt == 0), "virt of another mapping is refused");
+
+    /* the whole mmb 6 and 7 cost more than the whole cache */
+    set_range(&g_range[0], 6, 0, BENCH_MMB_SIZE, MMZ_CACHE_OP_FLUSH);
+    set_range(&g_range[1], 7, 0, BENCH_MMB_SIZE, MMZ_CACHE_OP_CLEAN);
+    ret = flush_ranges(2, &req);
+    tool_check((ret == 0) && (req.flush_all == 1) && (g_host.flush_all == 1) && (g_host.op_cnt == 0),
+        "large ranges fall back to the whole cache");
+
+    host_close();
+}
+
+static unsigned long long model_cost(const struct mmz_cache_ranges *req)
+{
+    if (req->flush_all) {
+        return g_flush_all_cost;
+    }
+    return (unsigned long long)req->merged_count * g_flush_range_setup_cost +
+        (unsigned long long)g_flush_range_kb_cost * DIV_ROUND_UP(req->total_size, SZ_1K);
+}
+
+/* scattered: random 1..16 KB ranges over all mmbs; adjacent: 4 KB runs over the seam of mmb 0 and 1 */
+static void bench_fill(unsigned int count, int adjacent)
+{
+    unsigned int i;
+
+    for (i = 0; i < count; i++) {
+        if (adjacent) {
+            unsigned long off = BENCH_MMB_SIZE - (count / 2) * SZ_1K * 4 + i * SZ_1K * 4; /* 2: half before the seam */
+            set_range(&g_range[i], (off >= BENCH_MMB_SIZE) ? 1 : 0, off % BENCH_MMB_SIZE, SZ_1K * 4,
+                MMZ_CACHE_OP_CLEAN);
+        } else {
+            unsigned long size = (1 + rand() % 16) * SZ_1K; /* 16: up to 16 KB */
+            unsigned long off = (rand() % ((BENCH_MMB_SIZE - size) / CACHE_LINE_SIZE)) * CACHE_LINE_SIZE;
+            set_range(&g_range[i], rand() % BENCH_MMB_CNT, off, size, MMZ_CACHE_OP_CLEAN);
+        }
+    }
+}
+
+static void bench(void)
+{
+    static const unsigned int count[] = { 1, 4, 16, 64, 256 };
+    static const char *pattern[] = { "scattered", "adjacent" };
+    struct mmz_cache_ranges req;
+    unsigned int i, p, loop, fail = 0;
+    double start, ns;
+
+    map_all();
+    srand(BENCH_SEED);
+    printf("\n%-10s %6s %12s %8s %10s %12s %9s\n", "pattern", "ranges", "ns/call", "merged", "KB", "model ns",
+        "flush_all");
+    for (p = 0; p < 2; p++) { /* 2: patterns */
+        for (i = 0; i < sizeof(count) / sizeof(count[0]); i++) {
+            bench_fill(count[i], p);
+            start = host_now_ns();
+            for (loop = 0; loop < BENCH_LOOPS; loop++) {
+                fail += (flush_ranges(count[i], &req) != 0);
+            }
+            ns = (host_now_ns() - start) / BENCH_LOOPS;
+            printf("%-10s %6u %12.0f %8u %10lu %12llu %9u\n", pattern[p], count[i], ns, req.merged_count,
+                (unsigned long)req.total_size / SZ_1K, model_cost(&req), req.flush_all);
+        }
+    }
+    host_close();
+    tool_check(fail == 0, "benchmark calls all succeed");
+}
+
+int main(int argc, char *argv[])
+{
+    test_checks();
+    bench();
+
+    if (g_fail != 0) {
+        printf("%u check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host stand-ins for the page table walk of usr_virt_to_phys in media_mem.c.
+ * The mmz host tests never reach it: every level reads as not mapped.
+ */
+
+#ifndef __MMZ_HOST_PGTABLE_H__
+#define __MMZ_HOST_PGTABLE_H__
+
+#include <linux/mm.h>
+
+typedef unsigned long pgd_t;
+typedef unsigned long pud_t;
+typedef unsigned long pmd_t;
+typedef unsigned long pte_t;
+
+#define PAGE_OFFSET                 0xc0000000UL
+#define PHYS_MASK                   (~0UL)
+#define pgd_offset(mm, addr)        ((pgd_t *)NULL)
+#define pgd_none(pgd)               ((void)(pgd), 1)
+#define pud_offset(pgd, addr)       ((pud_t *)NULL)
+#define pud_none(pud)               ((void)(pud), 1)
+#define pmd_offset(pud, addr)       ((pmd_t *)NULL)
+#define pmd_none(pmd)               ((void)(pmd), 1)
+#define pte_offset_map(pmd, addr)   ((pte_t *)NULL)
+#define pte_none(pte)               ((void)(pte), 1)
+#define pte_unmap(pte)
+#define pte_val(pte)                (pte)
+
+#endif /* __MMZ_HOST_PGTABLE_H__ */
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host stand-ins for the process, file and vma definitions mmz_userdev.c
+ * uses. The vma lookup, the user mapping and the cache maintenance calls
+ * are only declared, each test implements them on its own fake address space.
+ */
+
+#ifndef __MMZ_HOST_MM_H__
+#define __MMZ_HOST_MM_H__
+
+#include <linux/kernel.h>
+#include <sys/types.h>
+
+#define __user
+#define THIS_MODULE NULL
+#define module_param_named(name, value, type, perm)
+#define module_param(name, type, perm)
+#define module_param_string(name, string, len, perm)
+#define MODULE_PARM_DESC(name, desc)
+#define S_IRUGO 0444
+#define LINUX_VERSION_CODE 0x040925 /* 4.9.37 */
+#define KERNEL_VERSION(a, b, c) (((a) << 16) + ((b) << 8) + (c))
+
+#define O_SYNC     04010000
+#define PROT_READ  0x1
+#define PROT_WRITE 0x2
+#define MAP_SHARED 0x01
+#define VM_READ    0x1UL
+#define VM_WRITE   0x2UL
+
+#define PAGE_ALIGN(x)       (((x) + PAGE_SIZE - 1) & PAGE_MASK)
+#define DIV_ROUND_UP(n, d)  (((n) + (d) - 1) / (d))
+#define max(a, b)           ((a) > (b) ? (a) : (b))
+#define IS_ERR_VALUE(x)     ((unsigned long)(x) >= (unsigned long)-4095)
+
+#define list_for_each_entry_safe osal_list_for_each_entry_safe
+#define list_for_each_entry      osal_list_for_each_entry
+#define list_for_each_safe       osal_list_for_each_safe
+#define list_entry               osal_list_entry
+
+#define pr_err          printf
+#define simple_strtoul  strtoul
+
+struct semaphore {
+    int count;
+};
+#define DEFINE_SEMAPHORE(name) struct semaphore name = { 1 }
+#define sema_init(sem, val) ((sem)->count = (val))
+#define down(sem)           ((sem)->count--)
+#define up(sem)             ((sem)->count++)
+
+struct rw_semaphore {
+    int readers;
+};
+#define down_read(sem) ((sem)->readers++)
+#define up_read(sem)   ((sem)->readers--)
+
+struct mm_struct {
+    struct rw_semaphore mmap_sem;
+};
+
+struct task_struct {
+    pid_t pid;
+    struct mm_struct *mm;
+};
+extern struct task_struct g_host_task;
+#define current (&g_host_task)
+
+typedef struct {
+    unsigned long pgprot;
+} pgprot_t;
+#define pgprot_val(x)           ((x).pgprot)
+#define __pgprot(x)             ((pgprot_t) { (x) })
+#define pgprot_writecombine(x)  (x)
+#define L_PTE_PRESENT           0
+#define L_PTE_YOUNG             0
+#define L_PTE_DIRTY             0
+#define L_PTE_MT_DEV_CACHED     0
+
+struct vm_area_struct {
+    unsigned long vm_start;
+    unsigned long vm_end;
+    unsigned long vm_flags;
+    unsigned long vm_pgoff;
+    pgprot_t vm_page_prot;
+};
+
+struct page;
+#define pfn_valid(pfn)                      0
+#define pfn_to_page(pfn)                    NULL
+#define __pfn_to_phys(pfn)                  ((unsigned int)((pfn) << PAGE_SHIFT))
+#define vm_insert_page(vma, addr, page)     (-1)
+#define remap_pfn_range(vma, addr, pfn, size, prot) 0
+
+struct inode {
+    int unused;
+};
+
+struct file {
+    void *private_data;
+    unsigned int f_flags;
+};
+
+struct file_operations {
+    void *owner;
+    int (*open)(struct inode *inode, struct file *file);
+    int (*release)(struct inode *inode, struct file *file);
+    long (*unlocked_ioctl)(struct file *file, unsigned int cmd, unsigned long arg);
+    int (*mmap)(struct file *file, struct vm_area_struct *vma);
+};
+
+#define MISC_DYNAMIC_MINOR 255
+struct miscdevice {
+    int minor;
+    const char *name;
+    const struct file_operations *fops;
+};
+#define misc_register(dev)   ((void)(dev), 0)
+#define misc_deregister(dev) ((void)(dev))
+
+#define copy_from_user(to, from, n) (memcpy((to), (from), (n)), 0)
+#define copy_to_user(to, from, n)   (memcpy((to), (from), (n)), 0)
+
+#define sort(base, num, size, cmp, swap) qsort((base), (num), (size), (cmp))
+
+typedef void (*smp_call_func_t)(void *info);
+void on_each_cpu(smp_call_func_t func, void *info, int wait);
+
+struct vm_area_struct *find_vma(struct mm_struct *mm, unsigned long addr);
+unsigned long vm_mmap(struct file *file, unsigned long addr, unsigned long len,
+                      unsigned long prot, unsigned long flags, unsigned long pgoff);
+int vm_munmap(unsigned long start, size_t len);
+
+/* the kernel's direct mapping, media_mem.c checks the zones against it */
+#define PHYS_OFFSET     0x40000000UL
+#define high_memory     ((void *)0x50000000UL)
+#define __pa(x)         ((unsigned long)(x))
+
+#define DMA_TO_DEVICE   1
+#define DMA_FROM_DEVICE 2
+void dmac_map_area(const void *addr, size_t size, int dir);
+
+void __cpuc_flush_kern_all(void);
+void __cpuc_flush_dcache_area(void *addr, size_t size);
+void outer_flush_all(void);
+
+#endif /* __MMZ_HOST_MM_H__ */
@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host stand-in for the kernel rbtree, only for the mmz host tests. Same
+ * interface as the subset media_mem.c and the allocators use: the caller
+ * descends and links the node itself, then rb_insert_color() rebalances.
+ * This is a plain red-black tree with parent pointers, so search depth and
+ * timings match the kernel's within a constant.
+ */
+
+#ifndef __MMZ_HOST_RBTREE_H__
+#define __MMZ_HOST_RBTREE_H__
+
+#include <stddef.h>
+
+#define RB_RED   0
+#define RB_BLACK 1
+
+struct rb_node {
+    struct rb_node *rb_parent;
+    struct rb_node *rb_right;
+    struct rb_node *rb_left;
+    int rb_color;
+};
+
+struct rb_root {
+    struct rb_node *rb_node;
+};
+
+#ifndef container_of
+#define container_of(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif
+
+#define RB_ROOT (struct rb_root) { NULL, }
+#define rb_entry(ptr, type, member) container_of(ptr, type, member)
+#define RB_EMPTY_ROOT(root) ((root)->rb_node == NULL)
+#define RB_EMPTY_NODE(node) ((node)->rb_parent == (node))
+#define RB_CLEAR_NODE(node) ((node)->rb_parent = (node))
+
+static inline void rb_link_node(struct rb_node *node, struct rb_node *parent, struct rb_node **rb_link)
+{
+    node->rb_parent = parent;
+    node->rb_left = NULL;
+    node->rb_right = NULL;
+    node->rb_color = RB_RED;
+    *rb_link = node;
+}
+
+static inline void rb_host_replace_child(struct rb_node *old, struct rb_node *new, struct rb_node *parent,
+                                         struct rb_root *root)
+{
+    if (parent == NULL) {
+        root->rb_node = new;
+    } else if (parent->rb_left == old) {
+        parent->rb_left = new;
+    } else {
+        parent->rb_right = new;
+    }
+}
+
+static inline void rb_host_rotate_left(struct rb_node *x, struct rb_root *root)
+{
+    struct rb_node *y = x->rb_right;
+
+    x->rb_right = y->rb_left;
+    if (y->rb_left != NULL) {
+        y->rb_left->rb_parent = x;
+    }
+    y->rb_parent = x->rb_parent;
+    rb_host_replace_child(x, y, x->rb_parent, root);
+    y->rb_left = x;
+    x->rb_parent = y;
+}
+
+static inline void rb_host_rotate_right(struct rb_node *x, struct rb_root *root)
+{
+    struct rb_node *y = x->rb_left;
+
+    x->rb_left = y->rb_right;
+    if (y->rb_right != NULL) {
+        y->rb_right->rb_parent = x;
+    }
+    y->rb_parent = x->rb_parent;
+    rb_host_replace_child(x, y, x->rb_parent, root);
+    y->rb_right = x;
+    x->rb_parent = y;
+}
+
+static inline int rb_host_is_red(const struct rb_node *node)
+{
+    return (node != NULL) && (node->rb_color == RB_RED);
+}
+
+static inline void rb_insert_color(struct rb_node *node, struct rb_root *root)
+{
+    struct rb_node *parent, *gparent, *uncle;
+
+    while (rb_host_is_red(parent = node->rb_parent)) {
+        gparent = parent->rb_parent;
+        if (parent == gparent->rb_left) {
+            uncle = gparent->rb_right;
+            if (rb_host_is_red(uncle)) {
+                parent->rb_color = RB_BLACK;
+                uncle->rb_color = RB_BLACK;
+                gparent->rb_color = RB_RED;
+                node = gparent;
+                continue;
+            }
+            if (node == parent->rb_right) {
+                rb_host_rotate_left(parent, root);
+                node = parent;
+                parent = node->rb_parent;
+            }
+            parent->rb_color = RB_BLACK;
+            gparent->rb_color = RB_RED;
+            rb_host_rotate_right(gparent, root);
+        } else {
+            uncle = gparent->rb_left;
+            if (rb_host_is_red(uncle)) {
+                parent->rb_color = RB_BLACK;
+                uncle->rb_color = RB_BLACK;
+                gparent->rb_color = RB_RED;
+                node = gparent;
+                continue;
+            }
+            if (node == parent->rb_left) {
+                rb_host_rotate_right(parent, root);
+                node = parent;
+                parent = node->rb_parent;
+            }
+            parent->rb_color = RB_BLACK;
+            gparent->rb_color = RB_RED;
+            rb_host_rotate_left(gparent, root);
+        }
+    }
+    root->rb_node->rb_color = RB_BLACK;
+}
+
+/* restore the black height after a black node was unlinked above child, which may be NULL */
+static inline void rb_host_erase_color(struct rb_node *child, struct rb_node *parent, struct rb_root *root)
+{
+    struct rb_node *sibling;
+
+    while ((child != root->rb_node) && !rb_host_is_red(child)) {
+        if (child == parent->rb_left) {
+            sibling = parent->rb_right;
+            if (rb_host_is_red(sibling)) {
+                sibling->rb_color = RB_BLACK;
+                parent->rb_color = RB_RED;
+                rb_host_rotate_left(parent, root);
+                sibling = parent->rb_right;
+            }
+            if (!rb_host_is_red(sibling->rb_left) && !rb_host_is_red(sibling->rb_right)) {
+                sibling->rb_color = RB_RED;
+                child = parent;
+                parent = child->rb_parent;
+                continue;
+            }
+            if (!rb_host_is_red(sibling->rb_right)) {
+                sibling->rb_left->rb_color = RB_BLACK;
+                sibling->rb_color = RB_RED;
+                rb_host_rotate_right(sibling, root);
+                sibling = parent->rb_right;
+            }
+            sibling->rb_color = parent->rb_color;
+            parent->rb_color = RB_BLACK;
+            sibling->rb_right->rb_color = RB_BLACK;
+            rb_host_rotate_left(parent, root);
+        } else {
+            sibling = parent->rb_left;
+            if (rb_host_is_red(sibling)) {
+                sibling->rb_color = RB_BLACK;
+                parent->rb_color = RB_RED;
+                rb_host_rotate_right(parent, root);
+                sibling = parent->rb_left;
+            }
+            if (!rb_host_is_red(sibling->rb_left) && !rb_host_is_red(sibling->rb_right)) {
+                sibling->rb_color = RB_RED;
+                child = parent;
+                parent = child->rb_parent;
+                continue;
+            }
+            if (!rb_host_is_red(sibling->rb_left)) {
+                sibling->rb_right->rb_color = RB_BLACK;
+                sibling->rb_color = RB_RED;
+                rb_host_rotate_left(sibling, root);
+                sibling = parent->rb_left;
+            }
+            sibling->rb_color = parent->rb_color;
+            parent->rb_color = RB_BLACK;
+            sibling->rb_left->rb_color = RB_BLACK;
+            rb_host_rotate_right(parent, root);
+        }
+        child = root->rb_node;
+        break;
+    }
+    if (child != NULL) {
+        child->rb_color = RB_BLACK;
+    }
+}
+
+static inline void rb_erase(struct rb_node *node, struct rb_root *root)
+{
+    struct rb_node *child, *parent, *next;
+    int color;
+
+    if ((node->rb_left != NULL) && (node->rb_right != NULL)) {
+        /* move the successor into node's place, then fix up where the successor was */
+        next = node->rb_right;
+        while (next->rb_left != NULL) {
+            next = next->rb_left;
+        }
+        child = next->rb_right;
+        color = next->rb_color;
+        if (next->rb_parent == node) {
+            parent = next;
+        } else {
+            parent = next->rb_parent;
+            parent->rb_left = child;
+            if (child != NULL) {
+                child->rb_parent = parent;
+            }
+            next->rb_right = node->rb_right;
+            node->rb_right->rb_parent = next;
+        }
+        next->rb_left = node->rb_left;
+        node->rb_left->rb_parent = next;
+        next->rb_parent = node->rb_parent;
+        next->rb_color = node->rb_color;
+        rb_host_replace_child(node, next, node->rb_parent, root);
+    } else {
+        child = (node->rb_left != NULL) ? node->rb_left : node->rb_right;
+        parent = node->rb_parent;
+        color = node->rb_color;
+        if (child != NULL) {
+            child->rb_parent = parent;
+        }
+        rb_host_replace_child(node, child, parent, root);
+    }
+
+    if (color == RB_BLACK) {
+        rb_host_erase_color(child, parent, root);
+    }
+}
+
+static inline struct rb_node *rb_first(const struct rb_root *root)
+{
+    struct rb_node *node = root->rb_node;
+
+    if (node == NULL) {
+        return NULL;
+    }
+    while (node->rb_left != NULL) {
+        node = node->rb_left;
+    }
+    return node;
+}
+
+static inline struct rb_node *rb_last(const struct rb_root *root)
+{
+    struct rb_node *node = root->rb_node;
+
+    if (node == NULL) {
+        return NULL;
+    }
+    while (node->rb_right != NULL) {
+        node = node->rb_right;
+    }
+    return node;
+}
+
+static inline struct rb_node *rb_next(const struct rb_node *node)
+{
+    struct rb_node *parent;
+
+    if (node->rb_right != NULL) {
+        node = node->rb_right;
+        while (node->rb_left != NULL) {
+            node = node->rb_left;
+        }
+        return (struct rb_node *)node;
+    }
+    while (((parent = node->rb_parent) != NULL) && (node == parent->rb_right)) {
+        node = parent;
+    }
+    return parent;
+}
+
+static inline struct rb_node *rb_prev(const struct rb_node *node)
+{
+    struct rb_node *parent;
+
+    if (node->rb_left != NULL) {
+        node = node->rb_left;
+        while (node->rb_right != NULL) {
+            node = node->rb_right;
+        }
+        return (struct rb_node *)node;
+    }
+    while (((parent = node->rb_parent) != NULL) && (node == parent->rb_left)) {
+        node = parent;
+    }
+    return parent;
+}
+
+#endif /* __MMZ_HOST_RBTREE_H__ */
@@ -0,0 +1,436 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host test of the phys and kvirt mmb indexes of media_mem.c.
+ *
+ *   mmb_lookup          seeded random alloc/map/unmap/free workload over three
+ *                       zones, two of them overlapping as cma zones may
+ *   mmb_lookup bench    lookup timings at 10k and 100k mmbs, index against
+ *                       the list walk media_mem.c did before
+ *
+ * After every operation hil_mmb_getby_phys, hil_mmb_getby_phys_2 and
+ * hil_mmb_getby_kvirt are compared with a walk of the zone and mmb lists
+ * at both edges of live mmbs, of freed mmbs and at random addresses. The
+ * walk takes the first zone of g_mmz_list that covers the address, as the
+ * lookup must when zones overlap. An unmapped mmb must never be found by
+ * kvirt, the old walk found it at addresses below its length.
+ */
+
+#include <time.h>
+#include "media_mem.c"
+
+#define tool_check(cond, name) \
+    do { \
+        if (cond) { \
+            printf("ok   %s\n", name); \
+        } else { \
+            printf("FAIL %s\n", name); \
+            g_fail++; \
+        } \
+    } while (0)
+
+#define MMB_LOOKUP_ZONE_A       0x80000000UL
+#define MMB_LOOKUP_ZONE_B       0x82000000UL /* overlaps the upper half of zone a */
+#define MMB_LOOKUP_ZONE_C       0x90000000UL
+#define MMB_LOOKUP_ZONE_SIZE    (64 * SZ_1M)
+#define MMB_LOOKUP_KVIRT_BASE   0x100000000UL
+#define MMB_LOOKUP_OPS          20000
+#define MMB_LOOKUP_LIVE_MAX     256
+#define MMB_LOOKUP_PROBES       16
+#define MMB_LOOKUP_SEED         20211123
+
+#define MMB_LOOKUP_BENCH_SIZE   (16 * SZ_1K)
+#define MMB_LOOKUP_BENCH_GAP    (4 * SZ_1K)
+#define MMB_LOOKUP_BENCH_LOOKUP 1000000
+#define MMB_LOOKUP_BENCH_WALK   20000000 /* mmbs visited by the timed list walks */
+
+static unsigned int g_fail = 0;
+
+struct task_struct g_host_task;
+
+static struct {
+    hil_mmz_t *zone[3];    /* 3: zones a, b and c */
+    hil_mmb_t *live[MMB_LOOKUP_LIVE_MAX];
+    unsigned int live_cnt;
+    hil_mmb_t *dead;       /* last freed mmb, its edges are probed until the next free */
+    unsigned long dead_phys;
+    unsigned long dead_len;
+    unsigned long kvirt_next;
+    unsigned long seed;
+    unsigned long probes;
+    unsigned long phys_fail;
+    unsigned long kvirt_fail;
+    unsigned long exact_fail;
+    unsigned long unmapped_fail;
+} g_lookup;
+
+/* media_mem.c reaches these only from paths the test does not take */
+int hisi_allocator_setopt(struct mmz_allocator *allocator)
+{
+    return -1;
+}
+
+int segfit_allocator_setopt(struct mmz_allocator *allocator)
+{
+    return -1;
+}
+
+int mmz_userdev_init(void)
+{
+    return 0;
+}
+
+void mmz_userdev_exit(void)
+{
+}
+
+struct vm_area_struct *find_vma(struct mm_struct *mm, unsigned long addr)
+{
+    return NULL;
+}
+
+void dmac_map_area(const void *addr, size_t size, int dir)
+{
+}
+
+void __cpuc_flush_dcache_area(void *addr, size_t size)
+{
+}
+
+static unsigned long mmb_lookup_rand(unsigned long n)
+{
+    g_lookup.seed = g_lookup.seed * 6364136223846793005UL + 1442695040888963407UL; /* 64-bit LCG */
+    return (g_lookup.seed >> 33) % n; /* 33: the high bits are the random ones */
+}
+
+static double mmb_lookup_now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec; /* 1e9: ns per second */
+}
+
+/* the walk of mach_mmb_2, which hil_mmb_getby_kvirt and hil_mmb_getby_phys_2 used before the index */
+static hil_mmb_t *mmb_lookup_walk(unsigned long val, int by_kvirt, unsigned long *out_offset)
+{
+    hil_mmz_t *zone = NULL;
+    hil_mmb_t *p = NULL;
+
+    osal_list_for_each_entry(zone, &g_mmz_list, list) {
+        osal_list_for_each_entry(p, &zone->mmb_list, list) {
+            unsigned long key = by_kvirt ? (unsigned long)(uintptr_t)p->kvirt : p->phys_addr;
+            if (by_kvirt && (p->kvirt == NULL)) {
+                continue;
+            }
+            if ((key <= val) && (key + p->length > val)) {
+                *out_offset = val - key;
+                return p;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void mmb_lookup_probe(unsigned long phys, unsigned long kvirt)
+{
+    unsigned long offset = 0;
+    unsigned long ref_offset = 0;
+    hil_mmb_t *ref = NULL;
+    hil_mmb_t *p = NULL;
+
+    g_lookup.probes++;
+    ref = mmb_lookup_walk(phys, 0, &ref_offset);
+    p = hil_mmb_getby_phys_2(phys, &offset);
+    g_lookup.phys_fail += (p != ref) || ((p != NULL) && (offset != ref_offset));
+    p = hil_mmb_getby_phys(phys);
+    g_lookup.exact_fail += (p != (((ref != NULL) && (ref_offset == 0)) ? ref : NULL));
+
+    ref = mmb_lookup_walk(kvirt, 1, &ref_offset);
+    p = hil_mmb_getby_kvirt((void *)(uintptr_t)kvirt);
+    g_lookup.kvirt_fail += (p != ((kvirt == 0) ? NULL : ref));
+}
+
+static void mmb_lookup_probe_mmb(const hil_mmb_t *mmb)
+{
+    unsigned long kvirt = (unsigned long)(uintptr_t)mmb->kvirt;
+
+    mmb_lookup_probe(mmb->phys_addr - 1, kvirt - 1);
+    mmb_lookup_probe(mmb->phys_addr, kvirt);
+    mmb_lookup_probe(mmb->phys_addr + mmb->length - 1, kvirt + mmb->length - 1);
+    mmb_lookup_probe(mmb->phys_addr + mmb->length, kvirt + mmb->length);
+    if (mmb->kvirt == NULL) {
+        /* below the length of an unmapped mmb, where the walk of its NULL kvirt would find it */
+        g_lookup.unmapped_fail += (hil_mmb_getby_kvirt((void *)(uintptr_t)(1 + mmb_lookup_rand(mmb->length))) ==
+            mmb);
+    }
+}
+
+static void mmb_lookup_probe_all(void)
+{
+    unsigned int i;
+    hil_mmz_t *zone = NULL;
+
+    for (i = 0; i < MMB_LOOKUP_PROBES; i++) {
+        zone = g_lookup.zone[mmb_lookup_rand(3)]; /* 3: zones */
+        mmb_lookup_probe(zone->phys_start + mmb_lookup_rand(zone->nbytes),
+            MMB_LOOKUP_KVIRT_BASE + mmb_lookup_rand(g_lookup.kvirt_next - MMB_LOOKUP_KVIRT_BASE + 1));
+    }
+    if (g_lookup.live_cnt != 0) {
+        mmb_lookup_probe_mmb(g_lookup.live[mmb_lookup_rand(g_lookup.live_cnt)]);
+    }
+    if (g_lookup.dead_len != 0) {
+        mmb_lookup_probe(g_lookup.dead_phys, 0);
+        mmb_lookup_probe(g_lookup.dead_phys + g_lookup.dead_len - 1, 0);
+    }
+}
+
+/* the index is kept by the allocators, the test calls the same hooks they call */
+static hil_mmb_t *mmb_lookup_alloc(hil_mmz_t *zone, unsigned long phys, unsigned long length)
+{
+    hil_mmb_t *mmb = calloc(1, sizeof(hil_mmb_t));
+
+    mmb->zone = zone;
+    mmb->phys_addr = phys;
+    mmb->length = length;
+    osal_list_add_tail(&mmb->list, &zone->mmb_list);
+    mmz_mmb_index_insert_phys(mmb);
+    return mmb;
+}
+
+static void mmb_lookup_map(hil_mmb_t *mmb)
+{
+    /* a gap after each mapping, so that neighbours in kvirt are not always neighbours in phys */
+    mmb->kvirt = (void *)(uintptr_t)g_lookup.kvirt_next;
+    g_lookup.kvirt_next += mmb->length + PAGE_SIZE * mmb_lookup_rand(4); /* 4: gap of up to 3 pages */
+    mmz_mmb_index_insert_kvirt(mmb);
+}
+
+static void mmb_lookup_unmap(hil_mmb_t *mmb)
+{
+    mmz_mmb_index_erase_kvirt(mmb);
+    mmb->kvirt = NULL;
+}
+
+static void mmb_lookup_free(hil_mmb_t *mmb)
+{
+    mmz_mmb_index_erase_phys(mmb);
+    osal_list_del(&mmb->list);
+    free(mmb);
+}
+
+/* a free range of the zone, mmbs of other zones may overlap it */
+static int mmb_lookup_fits(const hil_mmz_t *zone, unsigned long phys, unsigned long length)
+{
+    hil_mmb_t *p = NULL;
+
+    osal_list_for_each_entry(p, &zone->mmb_list, list) {
+        if ((phys < p->phys_addr + p->length) && (p->phys_addr < phys + length)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void mmb_lookup_step(void)
+{
+    unsigned int i;
+    hil_mmb_t *mmb = NULL;
+    hil_mmz_t *zone = NULL;
+    unsigned long op = mmb_lookup_rand(8); /* 8: 3/8 alloc, 2/8 map, 1/8 unmap, 2/8 free */
+    unsigned long phys, length;
+
+    if ((op < 3) && (g_lookup.live_cnt < MMB_LOOKUP_LIVE_MAX)) { /* 3: alloc */
+        zone = g_lookup.zone[mmb_lookup_rand(3)]; /* 3: zones */
+        length = PAGE_SIZE * (1 + mmb_lookup_rand(64)); /* 64: up to 64 pages */
+        phys = zone->phys_start + PAGE_SIZE * mmb_lookup_rand((zone->nbytes - length) / PAGE_SIZE + 1);
+        if (mmb_lookup_fits(zone, phys, length)) {
+            g_lookup.live[g_lookup.live_cnt++] = mmb_lookup_alloc(zone, phys, length);
+        }
+        return;
+    }
+    if (g_lookup.live_cnt == 0) {
+        return;
+    }
+    i = mmb_lookup_rand(g_lookup.live_cnt);
+    mmb = g_lookup.live[i];
+    if (op < 5) { /* 5: map, or remap at a new address */
+        if (mmb->kvirt != NULL) {
+            mmb_lookup_unmap(mmb);
+        }
+        mmb_lookup_map(mmb);
+    } else if (op < 6) { /* 6: unmap */
+        if (mmb->kvirt != NULL) {
+            mmb_lookup_unmap(mmb);
+        }
+    } else {
+        g_lookup.dead_phys = mmb->phys_addr;
+        g_lookup.dead_len = mmb->length;
+        mmb_lookup_free(mmb);
+        g_lookup.live[i] = g_lookup.live[--g_lookup.live_cnt];
+    }
+}
+
+static hil_mmz_t *mmb_lookup_zone(const char *name, unsigned long start)
+{
+    hil_mmz_t *zone = hil_mmz_create(name, 0, start, MMB_LOOKUP_ZONE_SIZE);
+
+    if ((zone == NULL) || (hil_mmz_register(zone) != 0)) {
+        printf("register of zone %s failed\n", name);
+        exit(1);
+    }
+    return zone;
+}
+
+static void mmb_lookup_teardown(void)
+{
+    unsigned int i;
+
+    while (g_lookup.live_cnt != 0) {
+        mmb_lookup_free(g_lookup.live[--g_lookup.live_cnt]);
+    }
+    for (i = 0; i < 3; i++) { /* 3: zones */
+        if (g_lookup.zone[i] != NULL) {
+            (void)hil_mmz_unregister(g_lookup.zone[i]);
+            (void)hil_mmz_destroy(g_lookup.zone[i]);
+            g_lookup.zone[i] = NULL;
+        }
+    }
+}
+
+/* the floor of b does not cover the address, the mmb of a, later in g_mmz_list, does */
+static void mmb_lookup_overlap(void)
+{
+    hil_mmb_t *big = mmb_lookup_alloc(g_lookup.zone[0], MMB_LOOKUP_ZONE_B, 2 * SZ_1M); /* 2: 2M */
+    hil_mmb_t *small = mmb_lookup_alloc(g_lookup.zone[1], MMB_LOOKUP_ZONE_B + SZ_1M, PAGE_SIZE);
+    unsigned long offset = 0;
+
+    tool_check(hil_mmb_getby_phys_2(MMB_LOOKUP_ZONE_B + SZ_1M + 2 * PAGE_SIZE, &offset) == big, /* 2: past small */
+        "overlapping zones: floor of the first zone misses, next zone found");
+    tool_check(offset == SZ_1M + 2 * PAGE_SIZE, "overlapping zones: offset"); /* 2: as above */
+    tool_check(hil_mmb_getby_phys(MMB_LOOKUP_ZONE_B + SZ_1M) == small,
+        "overlapping zones: first zone of g_mmz_list wins");
+
+    mmb_lookup_map(big);
+    mmb_lookup_unmap(big);
+    tool_check(hil_mmb_getby_kvirt((void *)(uintptr_t)PAGE_SIZE) == NULL, "unmapped mmb not found at kvirt below its length");
+    mmb_lookup_map(big);
+    tool_check(hil_mmb_getby_kvirt((char *)big->kvirt + SZ_1M) == big, "remapped mmb found at its new kvirt");
+    mmb_lookup_free(small);
+    mmb_lookup_free(big);
+}
+
+static int mmb_lookup_check(void)
+{
+    unsigned long i;
+
+    (void)strcpy_s(g_setup_allocator, sizeof(g_setup_allocator), "cma"); /* cma zones are not checked for overlap */
+    g_lookup.zone[0] = mmb_lookup_zone("a", MMB_LOOKUP_ZONE_A);
+    g_lookup.zone[1] = mmb_lookup_zone("b", MMB_LOOKUP_ZONE_B);
+    g_lookup.zone[2] = mmb_lookup_zone("c", MMB_LOOKUP_ZONE_C); /* 2: zone c */
+    g_lookup.kvirt_next = MMB_LOOKUP_KVIRT_BASE;
+    g_lookup.seed = MMB_LOOKUP_SEED;
+
+    mmb_lookup_overlap();
+    for (i = 0; i < MMB_LOOKUP_OPS; i++) {
+        mmb_lookup_step();
+        mmb_lookup_probe_all();
+    }
+    printf("%d ops, %lu probes\n", MMB_LOOKUP_OPS, g_lookup.probes);
+    tool_check(g_lookup.phys_fail == 0, "hil_mmb_getby_phys_2 matches the list walk");
+    tool_check(g_lookup.exact_fail == 0, "hil_mmb_getby_phys matches the list walk");
+    tool_check(g_lookup.kvirt_fail == 0, "hil_mmb_getby_kvirt matches the list walk of mapped mmbs");
+    tool_check(g_lookup.unmapped_fail == 0, "unmapped mmbs never found by kvirt");
+    mmb_lookup_teardown();
+
+    if (g_fail != 0) {
+        printf("%u check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
+
+static void mmb_lookup_bench_one(unsigned long count)
+{
+    unsigned long i;
+    unsigned long offset = 0;
+    unsigned long stride = MMB_LOOKUP_BENCH_SIZE + MMB_LOOKUP_BENCH_GAP;
+    unsigned long walks = MMB_LOOKUP_BENCH_WALK / count;
+    unsigned long found = 0;
+    hil_mmz_t *zone = hil_mmz_create("bench", 0, MMB_LOOKUP_ZONE_A, count * stride);
+    double t0, index_phys, index_kvirt, walk_phys, walk_kvirt;
+
+    (void)hil_mmz_register(zone);
+    g_lookup.zone[0] = zone;
+    g_lookup.kvirt_next = MMB_LOOKUP_KVIRT_BASE;
+    for (i = 0; i < count; i++) {
+        mmb_lookup_map(mmb_lookup_alloc(zone, MMB_LOOKUP_ZONE_A + i * stride, MMB_LOOKUP_BENCH_SIZE));
+    }
+
+    t0 = mmb_lookup_now();
+    for (i = 0; i < MMB_LOOKUP_BENCH_LOOKUP; i++) {
+        found += hil_mmb_getby_phys_2(MMB_LOOKUP_ZONE_A + mmb_lookup_rand(count * stride), &offset) != NULL;
+    }
+    index_phys = (mmb_lookup_now() - t0) / MMB_LOOKUP_BENCH_LOOKUP;
+    t0 = mmb_lookup_now();
+    for (i = 0; i < MMB_LOOKUP_BENCH_LOOKUP; i++) {
+        found += hil_mmb_getby_kvirt((void *)(uintptr_t)(MMB_LOOKUP_KVIRT_BASE +
+            mmb_lookup_rand(g_lookup.kvirt_next - MMB_LOOKUP_KVIRT_BASE))) != NULL;
+    }
+    index_kvirt = (mmb_lookup_now() - t0) / MMB_LOOKUP_BENCH_LOOKUP;
+    t0 = mmb_lookup_now();
+    for (i = 0; i < walks; i++) {
+        found += mmb_lookup_walk(MMB_LOOKUP_ZONE_A + mmb_lookup_rand(count * stride), 0, &offset) != NULL;
+    }
+    walk_phys = (mmb_lookup_now() - t0) / walks;
+    t0 = mmb_lookup_now();
+    for (i = 0; i < walks; i++) {
+        found += mmb_lookup_walk(MMB_LOOKUP_KVIRT_BASE + mmb_lookup_rand(g_lookup.kvirt_next - MMB_LOOKUP_KVIRT_BASE),
+            1, &offset) != NULL;
+    }
+    walk_kvirt = (mmb_lookup_now() - t0) / walks;
+
+    printf("%8lu %12.1f %12.1f %12.1f %12.1f %10lu\n", count, index_phys, walk_phys, index_kvirt, walk_kvirt,
+        found);
+    while (!osal_list_empty(&zone->mmb_list)) {
+        mmb_lookup_free(osal_list_first_entry(&zone->mmb_list, hil_mmb_t, list));
+    }
+    (void)hil_mmz_unregister(zone);
+    (void)hil_mmz_destroy(zone);
+    g_lookup.zone[0] = NULL;
+}
+
+static int mmb_lookup_bench(void)
+{
+    g_lookup.seed = MMB_LOOKUP_SEED;
+
+    printf("    mmbs  phys ns/idx phys ns/walk kvirt ns/idx kvirt ns/walk   found\n");
+    mmb_lookup_bench_one(10000);  /* 10000: 10k mmbs */
+    mmb_lookup_bench_one(100000); /* 100000: 100k mmbs */
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if ((argc > 1) && (strcmp(argv[1], "bench") == 0)) {
+        return mmb_lookup_bench();
+    }
+    return mmb_lookup_check();
+}
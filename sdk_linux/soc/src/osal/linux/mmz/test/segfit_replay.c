@@ -0,0 +1,307 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host replay of allocations through the segfit backend.
+ *
+ *   segfit_replay           run a seeded random workload of SEGFIT_REPLAY_OPS operations
+ *   segfit_replay trace...  replay trace files, one operation per line:
+ *                             a <id> <size> <align> <order>   allocate, order 0 LOW_TO_HIGH, 1 HIGH_TO_LOW
+ *                             f <id>                          free
+ *
+ * After every operation the free extents are checked against a grain map of
+ * the zone: sorted, coalesced, in the right size class and adding up to
+ * free_bytes. Every HIGH_TO_LOW placement must be the highest fitting start
+ * in the zone, which is what find_fixed_region_from_highaddr returns.
+ * The time spent in segfit_find_region is reported per operation.
+ */
+
+#include <time.h>
+#include "segfit_allocator.c"
+
+#define SEGFIT_REPLAY_ZONE_START 0x80000000UL
+#define SEGFIT_REPLAY_ZONE_SIZE  (16 * SZ_1M)
+#define SEGFIT_REPLAY_GRAINS     (SEGFIT_REPLAY_ZONE_SIZE / MMZ_GRAIN)
+#define SEGFIT_REPLAY_ID_MAX     4096
+#define SEGFIT_REPLAY_OPS        20000
+#define SEGFIT_REPLAY_LIVE_MAX   128 /* ids used by the random workload */
+#define SEGFIT_REPLAY_SEED       20211123
+
+struct osal_list_head g_mmz_list;
+
+typedef struct {
+    unsigned long start;
+    unsigned long size;
+} segfit_replay_block;
+
+typedef struct {
+    hil_mmz_t zone;
+    unsigned char used[SEGFIT_REPLAY_GRAINS];
+    segfit_replay_block block[SEGFIT_REPLAY_ID_MAX];
+    unsigned long ops;
+    unsigned long alloc_fail;
+    unsigned long check_fail;
+    double find_ns;
+} segfit_replay_ctx;
+
+static segfit_replay_ctx g_replay;
+
+int hisi_allocator_setopt(struct mmz_allocator *allocator)
+{
+    return -1;
+}
+
+static double segfit_replay_now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec; /* 1e9: ns per second */
+}
+
+static unsigned long segfit_replay_grain(unsigned long addr)
+{
+    return (addr - SEGFIT_REPLAY_ZONE_START) / MMZ_GRAIN;
+}
+
+static int segfit_replay_is_free(unsigned long start, unsigned long size)
+{
+    unsigned long i;
+
+    for (i = segfit_replay_grain(start); i < segfit_replay_grain(start + size); i++) {
+        if (g_replay.used[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* brute force twin of find_fixed_region_from_highaddr over the grain map */
+static unsigned long segfit_replay_highest_fit(unsigned long size, unsigned long align)
+{
+    unsigned long end = SEGFIT_REPLAY_ZONE_START + SEGFIT_REPLAY_ZONE_SIZE;
+    unsigned long pos;
+
+    if (size > SEGFIT_REPLAY_ZONE_SIZE) {
+        return 0;
+    }
+    for (pos = mmz_align2low(end - size, align); pos >= SEGFIT_REPLAY_ZONE_START; pos -= align) {
+        if (segfit_replay_is_free(pos, size)) {
+            return pos;
+        }
+        if (pos < align) {
+            break;
+        }
+    }
+    return 0;
+}
+
+/* the extents must be exactly the maximal free runs of the grain map */
+static int segfit_replay_check_extents(void)
+{
+    struct mmz_segfit *sf = g_replay.zone.segfit;
+    struct rb_node *node = NULL;
+    struct segfit_extent *ext = NULL;
+    unsigned long grain = 0;
+    unsigned long cnt = 0;
+    unsigned long bytes = 0;
+    unsigned long first, last;
+
+    for (node = rb_first(&sf->root); node != NULL; node = rb_next(node)) {
+        ext = rb_entry(node, struct segfit_extent, node);
+        while ((grain < SEGFIT_REPLAY_GRAINS) && g_replay.used[grain]) {
+            grain++;
+        }
+        first = grain;
+        while ((grain < SEGFIT_REPLAY_GRAINS) && !g_replay.used[grain]) {
+            grain++;
+        }
+        last = grain;
+        if ((ext->start != SEGFIT_REPLAY_ZONE_START + first * MMZ_GRAIN) ||
+            (ext->len != (last - first) * MMZ_GRAIN) || (ext->cls != segfit_class(ext->len)) ||
+            !test_bit(ext->cls, sf->class_map)) {
+            return -1;
+        }
+        cnt++;
+        bytes += ext->len;
+    }
+    while ((grain < SEGFIT_REPLAY_GRAINS) && g_replay.used[grain]) {
+        grain++;
+    }
+    if ((grain != SEGFIT_REPLAY_GRAINS) || (cnt != sf->extent_cnt) || (bytes != sf->free_bytes)) {
+        return -1;
+    }
+    return 0;
+}
+
+static void segfit_replay_mark(unsigned long start, unsigned long size, unsigned char used)
+{
+    (void)memset(&g_replay.used[segfit_replay_grain(start)], used, size / MMZ_GRAIN);
+}
+
+static void segfit_replay_alloc(unsigned int id, unsigned long size, unsigned long align, unsigned int order)
+{
+    unsigned long region_len, start, expect;
+    double begin;
+
+    if ((id >= SEGFIT_REPLAY_ID_MAX) || (g_replay.block[id].size != 0) || (size == 0)) {
+        return;
+    }
+    size = mmz_grain_align(size);
+    align = (mmz_grain_align(align) == 0) ? MMZ_GRAIN : mmz_grain_align(align);
+    expect = (order == HIGH_TO_LOW) ? segfit_replay_highest_fit(size, align) : 0;
+
+    begin = segfit_replay_now();
+    start = segfit_find_region(&region_len, &g_replay.zone, size, align, order);
+    g_replay.find_ns += segfit_replay_now() - begin;
+    g_replay.ops++;
+
+    if ((order == HIGH_TO_LOW) && (start != expect)) {
+        printf("FAIL HIGH_TO_LOW size 0x%lx align 0x%lx at 0x%lx, highest fit 0x%lx\n", size, align, start, expect);
+        g_replay.check_fail++;
+    }
+    if (start == 0) {
+        g_replay.alloc_fail++;
+        return;
+    }
+    if ((start % align != 0) || !segfit_replay_is_free(start, size) ||
+        (segfit_reserve_region(&g_replay.zone, start, size) != 0)) {
+        printf("FAIL bad region 0x%lx+0x%lx\n", start, size);
+        g_replay.check_fail++;
+        return;
+    }
+    segfit_replay_mark(start, size, 1);
+    g_replay.block[id].start = start;
+    g_replay.block[id].size = size;
+}
+
+static void segfit_replay_free(unsigned int id)
+{
+    if ((id >= SEGFIT_REPLAY_ID_MAX) || (g_replay.block[id].size == 0)) {
+        return;
+    }
+    segfit_release_region(&g_replay.zone, g_replay.block[id].start, g_replay.block[id].size);
+    segfit_replay_mark(g_replay.block[id].start, g_replay.block[id].size, 0);
+    g_replay.block[id].size = 0;
+    g_replay.ops++;
+}
+
+static int segfit_replay_begin(void)
+{
+    (void)memset(&g_replay, 0, sizeof(g_replay));
+    g_replay.zone.phys_start = SEGFIT_REPLAY_ZONE_START;
+    g_replay.zone.nbytes = SEGFIT_REPLAY_ZONE_SIZE;
+    g_replay.zone.segfit = segfit_zone_attach(&g_replay.zone);
+    return (g_replay.zone.segfit == NULL) ? -1 : 0;
+}
+
+static void segfit_replay_end(const char *name)
+{
+    struct mmz_segfit *sf = g_replay.zone.segfit;
+    struct rb_node *node = NULL;
+    unsigned long free_bytes, extents, largest;
+
+    segfit_zone_stat(&g_replay.zone, &free_bytes, &extents, &largest);
+    printf("%-24s ops %7lu  alloc fail %5lu  free %6luKB  extents %4lu  largest %6luKB  find %6.1f ns/op  %s\n",
+        name, g_replay.ops, g_replay.alloc_fail, free_bytes / SZ_1K, extents, largest / SZ_1K,
+        (g_replay.ops == 0) ? 0.0 : g_replay.find_ns / g_replay.ops,
+        (g_replay.check_fail == 0) ? "ok" : "FAIL");
+    while ((node = rb_first(&sf->root)) != NULL) {
+        segfit_extent_remove(sf, rb_entry(node, struct segfit_extent, node));
+    }
+    kfree(sf);
+}
+
+static void segfit_replay_step_check(void)
+{
+    if (segfit_replay_check_extents() != 0) {
+        printf("FAIL extents disagree with the zone after op %lu\n", g_replay.ops);
+        g_replay.check_fail++;
+    }
+}
+
+static void segfit_replay_random(void)
+{
+    static const unsigned long align[] = { 0, 0x1000, 0x10000, 0x100000 };
+    unsigned int i, id;
+    unsigned long size;
+
+    srand(SEGFIT_REPLAY_SEED);
+    for (i = 0; i < SEGFIT_REPLAY_OPS; i++) {
+        id = (unsigned int)rand() % SEGFIT_REPLAY_LIVE_MAX;
+        if (g_replay.block[id].size != 0) {
+            segfit_replay_free(id);
+        } else {
+            /* 4KB..1MB, log-uniform */
+            size = (1UL << (12 + rand() % 9)) + (unsigned long)(rand() % 4) * MMZ_GRAIN; /* 12, 9: 4KB..1MB */
+            segfit_replay_alloc(id, size, align[rand() % 4], (unsigned int)rand() % 2); /* 4, 2: choices */
+        }
+        segfit_replay_step_check();
+    }
+}
+
+static int segfit_replay_file(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    char line[128]; /* 128: longest trace line */
+    unsigned int id, order;
+    unsigned long size, align;
+
+    if (fp == NULL) {
+        printf("open %s failed\n", path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (sscanf(line, "a %u %li %li %u", &id, &size, &align, &order) == 4) { /* 4: fields */
+            segfit_replay_alloc(id, size, align, order);
+        } else if (sscanf(line, "f %u", &id) == 1) {
+            segfit_replay_free(id);
+        } else {
+            continue;
+        }
+        segfit_replay_step_check();
+    }
+    fclose(fp);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int fail = 0;
+    int i;
+
+    if (argc == 1) {
+        if (segfit_replay_begin() != 0) {
+            return 1;
+        }
+        segfit_replay_random();
+        fail += (g_replay.check_fail != 0);
+        segfit_replay_end("random");
+    }
+    for (i = 1; i < argc; i++) {
+        if (segfit_replay_begin() != 0) {
+            return 1;
+        }
+        if (segfit_replay_file(argv[i]) != 0) {
+            return 1;
+        }
+        fail += (g_replay.check_fail != 0);
+        segfit_replay_end(argv[i]);
+    }
+    return (fail == 0) ? 0 : 1;
+}
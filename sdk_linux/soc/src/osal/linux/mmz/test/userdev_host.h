@@ -0,0 +1,408 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Fake process for the host tests of mmz_userdev.c: a bump allocator of
+ * physically contiguous mmbs, a vma list filled by vm_mmap, and a log of the
+ * cache maintenance calls. A test includes it after mmz_userdev.c and drives
+ * the driver through mmz_userdev_open and mmz_userdev_ioctl. Every vma maps
+ * phys linearly from vm_pgoff, as remap_pfn_range does.
+ */
+
+#ifndef __MMZ_USERDEV_HOST_H__
+#define __MMZ_USERDEV_HOST_H__
+
+#include <time.h>
+
+#define HOST_PHYS_BASE   0x80000000UL
+#define HOST_VIRT_BASE   0x40000000UL
+#define HOST_MMB_MAX     64
+#define HOST_VMA_MAX     64
+#define HOST_OP_MAX      4096
+
+#define HOST_OP_FLUSH    0
+#define HOST_OP_CLEAN    1
+#define HOST_OP_INVALID  2
+
+#define tool_check(cond, name) \
+    do { \
+        if (cond) { \
+            printf("ok   %s\n", name); \
+        } else { \
+            printf("FAIL %s\n", name); \
+            g_fail++; \
+        } \
+    } while (0)
+
+typedef struct {
+    unsigned int op;
+    unsigned long virt;
+    unsigned long phys;
+    unsigned long len;
+} host_cache_op;
+
+static unsigned int g_fail = 0;
+
+static struct mm_struct g_host_mm;
+struct task_struct g_host_task = { .pid = 100, .mm = &g_host_mm };
+
+static struct {
+    hil_mmb_t mmb[HOST_MMB_MAX];
+    unsigned int mmb_cnt;
+    unsigned long phys_next;
+
+    struct vm_area_struct vma[HOST_VMA_MAX]; /* sorted by vm_start */
+    unsigned int vma_cnt;
+    unsigned long virt_next;
+
+    host_cache_op op[HOST_OP_MAX];
+    unsigned int op_cnt;
+    unsigned long op_bytes;
+    unsigned int flush_all;
+    unsigned int unlocked;                   /* maintenance without mmap_sem held */
+} g_host;
+
+static void host_reset(void)
+{
+    (void)memset_s(&g_host, sizeof(g_host), 0, sizeof(g_host));
+    g_host.phys_next = HOST_PHYS_BASE;
+    g_host.virt_next = HOST_VIRT_BASE;
+}
+
+static void host_op_reset(void)
+{
+    g_host.op_cnt = 0;
+    g_host.op_bytes = 0;
+    g_host.flush_all = 0;
+    g_host.unlocked = 0;
+}
+
+static void host_op_log(unsigned int op, void *kvirt, unsigned long phys_addr, unsigned long length)
+{
+    if (g_host.op_cnt < HOST_OP_MAX) {
+        g_host.op[g_host.op_cnt].op = op;
+        g_host.op[g_host.op_cnt].virt = (unsigned long)(uintptr_t)kvirt;
+        g_host.op[g_host.op_cnt].phys = phys_addr;
+        g_host.op[g_host.op_cnt].len = length;
+    }
+    g_host.op_cnt++;
+    g_host.op_bytes += length;
+    g_host.unlocked += (g_host_mm.mmap_sem.readers == 0);
+}
+
+/* ********************************* mmb ********************************* */
+hil_mmb_t *hil_mmb_alloc(const char *name, unsigned long size, unsigned long align,
+                         unsigned long gfp, const char *mmz_name)
+{
+    hil_mmb_t *mmb = NULL;
+
+    if (g_host.mmb_cnt >= HOST_MMB_MAX) {
+        return NULL;
+    }
+    mmb = &g_host.mmb[g_host.mmb_cnt++];
+    (void)strncpy_s(mmb->name, sizeof(mmb->name), name, sizeof(mmb->name) - 1);
+    mmb->phys_addr = g_host.phys_next;
+    mmb->length = PAGE_ALIGN(size);
+    g_host.phys_next += mmb->length;
+    return mmb;
+}
+
+hil_mmb_t *hil_mmb_alloc_v2(const char *name, unsigned long size, unsigned long align,
+                            unsigned long gfp, const char *mmz_name, unsigned int order)
+{
+    return hil_mmb_alloc(name, size, align, gfp, mmz_name);
+}
+
+int hil_mmb_free(hil_mmb_t *mmb)
+{
+    mmb->length = 0;
+    return 0;
+}
+
+int hil_mmb_get(hil_mmb_t *mmb)
+{
+    mmb->phy_ref++;
+    return 0;
+}
+
+int hil_mmb_put(hil_mmb_t *mmb)
+{
+    mmb->phy_ref--;
+    return 0;
+}
+
+hil_mmb_t *hil_mmb_getby_phys_2(unsigned long addr, unsigned long *out_offset)
+{
+    unsigned int i;
+
+    for (i = 0; i < g_host.mmb_cnt; i++) {
+        hil_mmb_t *mmb = &g_host.mmb[i];
+        if ((addr >= mmb->phys_addr) && (addr < mmb->phys_addr + mmb->length)) {
+            *out_offset = addr - mmb->phys_addr;
+            return mmb;
+        }
+    }
+    return NULL;
+}
+
+int hil_map_mmz_check_phys(unsigned long addr_start, unsigned long addr_len)
+{
+    return -1;
+}
+
+/* as media_mem.c: 0 for an unaligned or unmapped address, bit 0 set for a cacheable page */
+unsigned long usr_virt_to_phys(unsigned long virt)
+{
+    struct vm_area_struct *vma = find_vma(current->mm, virt);
+
+    if ((virt & 0x3) || (vma == NULL) || (vma->vm_start > virt)) {
+        return 0;
+    }
+    return ((vma->vm_pgoff << PAGE_SHIFT) + (virt - vma->vm_start)) | 1;
+}
+
+int cmpi_check_mmz_phy_addr(unsigned long long phy_addr, unsigned int len)
+{
+    return 0;
+}
+
+void *cmpi_remap_cached(unsigned long long phy_addr, unsigned long ul_size)
+{
+    return NULL;
+}
+
+void *cmpi_remap_nocache(unsigned long long phy_addr, unsigned long ul_size)
+{
+    return NULL;
+}
+
+void hil_mmf_unmap(void *virt)
+{
+}
+
+/* ********************************* vma ********************************** */
+struct vm_area_struct *find_vma(struct mm_struct *mm, unsigned long addr)
+{
+    unsigned int i;
+
+    for (i = 0; i < g_host.vma_cnt; i++) {
+        if (addr < g_host.vma[i].vm_end) {
+            return &g_host.vma[i];
+        }
+    }
+    return NULL;
+}
+
+static void host_vma_insert(unsigned long start, unsigned long end, unsigned long flags, unsigned long pgoff)
+{
+    unsigned int i = g_host.vma_cnt;
+
+    while ((i > 0) && (g_host.vma[i - 1].vm_start > start)) {
+        g_host.vma[i] = g_host.vma[i - 1];
+        i--;
+    }
+    g_host.vma[i].vm_start = start;
+    g_host.vma[i].vm_end = end;
+    g_host.vma[i].vm_flags = flags;
+    g_host.vma[i].vm_pgoff = pgoff;
+    g_host.vma_cnt++;
+}
+
+/* mappings are placed back to back, as mmap often does */
+unsigned long vm_mmap(struct file *file, unsigned long addr, unsigned long len,
+                      unsigned long prot, unsigned long flags, unsigned long pgoff)
+{
+    struct vm_area_struct vma = { 0 };
+    unsigned long start = g_host.virt_next;
+    int ret;
+
+    if (g_host.vma_cnt >= HOST_VMA_MAX) {
+        return (unsigned long)-ENOMEM;
+    }
+    vma.vm_start = start;
+    vma.vm_end = start + len;
+    vma.vm_pgoff = pgoff >> PAGE_SHIFT;
+    ret = mmz_userdev_mmap(file, &vma);
+    if (ret != 0) {
+        return (unsigned long)ret;
+    }
+    host_vma_insert(start, start + len, ((prot & PROT_READ) ? VM_READ : 0) | ((prot & PROT_WRITE) ? VM_WRITE : 0),
+        vma.vm_pgoff);
+    g_host.virt_next += len;
+    return start;
+}
+
+int vm_munmap(unsigned long start, size_t len)
+{
+    unsigned int i, n = 0;
+
+    for (i = 0; i < g_host.vma_cnt; i++) {
+        if ((g_host.vma[i].vm_start >= start) && (g_host.vma[i].vm_end <= start + len)) {
+            continue;
+        }
+        g_host.vma[n++] = g_host.vma[i];
+    }
+    g_host.vma_cnt = n;
+    return 0;
+}
+
+/* a mapping of phys made by another module, e.g. sys mmap or hifb, returns the user address */
+static inline unsigned long host_map_phys(unsigned long phys, unsigned long len, unsigned long flags)
+{
+    unsigned long start = g_host.virt_next;
+
+    if (g_host.vma_cnt >= HOST_VMA_MAX) {
+        return 0;
+    }
+    host_vma_insert(start, start + len, flags, phys >> PAGE_SHIFT);
+    g_host.virt_next += len;
+    return start;
+}
+
+/* mprotect: [start, end) becomes a vma of its own with the flags */
+static inline void host_mprotect(unsigned long start, unsigned long end, unsigned long flags)
+{
+    struct vm_area_struct *vma = find_vma(&g_host_mm, start);
+    struct vm_area_struct old;
+
+    if ((vma == NULL) || (vma->vm_start > start) || (vma->vm_end < end)) {
+        return;
+    }
+    old = *vma;
+    (void)vm_munmap(old.vm_start, old.vm_end - old.vm_start);
+    if (old.vm_start < start) {
+        host_vma_insert(old.vm_start, start, old.vm_flags, old.vm_pgoff);
+    }
+    host_vma_insert(start, end, flags, old.vm_pgoff + ((start - old.vm_start) >> PAGE_SHIFT));
+    if (end < old.vm_end) {
+        host_vma_insert(end, old.vm_end, old.vm_flags, old.vm_pgoff + ((end - old.vm_start) >> PAGE_SHIFT));
+    }
+}
+
+/* as media_mem.c, without the traces */
+int hil_vma_check_flags(unsigned long vm_start, unsigned long vm_end, unsigned long vm_flags)
+{
+    struct vm_area_struct *pvma1 = find_vma(current->mm, vm_start);
+    struct vm_area_struct *pvma2 = find_vma(current->mm, vm_end - 1);
+
+    if ((pvma1 == NULL) || (pvma2 == NULL) || (pvma1 != pvma2)) {
+        return -1;
+    }
+    if ((pvma1->vm_flags & vm_flags) != vm_flags) {
+        return -1;
+    }
+    if (pvma1->vm_start > vm_start) {
+        return -1;
+    }
+    return 0;
+}
+
+int hil_vma_check(unsigned long vm_start, unsigned long vm_end)
+{
+    return hil_vma_check_flags(vm_start, vm_end, VM_WRITE);
+}
+
+/* ******************************** cache ********************************* */
+int hil_mmb_flush_dcache_byaddr(void *kvirt, unsigned long phys_addr, unsigned long length)
+{
+    host_op_log(HOST_OP_FLUSH, kvirt, phys_addr, length);
+    return 0;
+}
+
+int hil_mmb_clean_cache_byaddr(void *kvirt, unsigned long phys_addr, unsigned long length)
+{
+    host_op_log(HOST_OP_CLEAN, kvirt, phys_addr, length);
+    return 0;
+}
+
+int hil_mmb_invalid_cache_byaddr(void *kvirt, unsigned long phys_addr, unsigned long length)
+{
+    host_op_log(HOST_OP_INVALID, kvirt, phys_addr, length);
+    return 0;
+}
+
+int hil_mmb_flush_dcache_byaddr_safe(void *kvirt, unsigned long phys_addr, unsigned long length)
+{
+    return hil_mmb_flush_dcache_byaddr(kvirt, phys_addr, length);
+}
+
+void on_each_cpu(smp_call_func_t func, void *info, int wait)
+{
+    func(info);
+}
+
+void __cpuc_flush_kern_all(void)
+{
+    g_host.flush_all++;
+}
+
+void __cpuc_flush_dcache_area(void *addr, size_t size)
+{
+    host_op_log(HOST_OP_FLUSH, addr, 0, size);
+}
+
+void outer_flush_all(void)
+{
+}
+
+/* ****************************** user side ******************************* */
+static struct file g_host_file;
+
+static void host_open(void)
+{
+    struct inode inode;
+
+    host_reset();
+    (void)mmz_userdev_open(&inode, &g_host_file);
+}
+
+static void host_close(void)
+{
+    struct inode inode;
+
+    (void)mmz_userdev_release(&inode, &g_host_file);
+}
+
+/* allocate an mmb of the caller and map it cached, returns the user address */
+static unsigned long host_mmb_map(const char *name, unsigned long size, unsigned long *phys)
+{
+    struct mmb_info mi = { 0 };
+
+    (void)strncpy_s(mi.mmb_name, sizeof(mi.mmb_name), name, sizeof(mi.mmb_name) - 1);
+    mi.size = size;
+    if (mmz_userdev_ioctl(&g_host_file, IOC_MMB_ALLOC, (unsigned long)(uintptr_t)&mi) != 0) {
+        return 0;
+    }
+    mi.prot = PROT_READ | PROT_WRITE;
+    mi.flags = MAP_SHARED;
+    if (mmz_userdev_ioctl(&g_host_file, IOC_MMB_USER_REMAP_CACHED, (unsigned long)(uintptr_t)&mi) != 0) {
+        return 0;
+    }
+    *phys = mi.phys_addr;
+    return (unsigned long)(uintptr_t)mi.mapped;
+}
+
+static inline double host_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#endif /* __MMZ_USERDEV_HOST_H__ */
@@ -30,3 +30,15 @@ void osal_flush_dcache_area(void *kvirt, unsigned long phys_addr, unsigned long
 }
 EXPORT_SYMBOL(osal_flush_dcache_area);
 
+void osal_clean_dcache_area(void *kvirt, unsigned long phys_addr, unsigned long length)
+{
+    hil_mmb_clean_cache_byaddr(kvirt, phys_addr, length);
+}
+EXPORT_SYMBOL(osal_clean_dcache_area);
+
+void osal_invalid_dcache_area(void *kvirt, unsigned long phys_addr, unsigned long length)
+{
+    hil_mmb_invalid_cache_byaddr(kvirt, phys_addr, length);
+}
+EXPORT_SYMBOL(osal_invalid_dcache_area);
+
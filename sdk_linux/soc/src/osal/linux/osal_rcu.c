@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2021 HiSilicon (Shanghai) Technologies CO., LIMITED.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "hi_osal.h"
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/rcupdate.h>
+
+void osal_rcu_read_lock(void)
+{
+    rcu_read_lock();
+}
+EXPORT_SYMBOL(osal_rcu_read_lock);
+
+void osal_rcu_read_unlock(void)
+{
+    rcu_read_unlock();
+}
+EXPORT_SYMBOL(osal_rcu_read_unlock);
+
+void osal_synchronize_rcu(void)
+{
+    synchronize_rcu();
+}
+EXPORT_SYMBOL(osal_synchronize_rcu);
@@ -20,9 +20,23 @@
 #include <linux/module.h>
 #include <linux/kernel.h>
 #include <linux/sched.h>
+#include <linux/smp.h>
 
 void osal_yield(void)
 {
     cond_resched();
 }
 EXPORT_SYMBOL(osal_yield);
+
+/* the caller may migrate right after this returns, so treat it as a hint */
+unsigned int osal_get_cpu_id(void)
+{
+    return raw_smp_processor_id();
+}
+EXPORT_SYMBOL(osal_get_cpu_id);
+
+unsigned int osal_get_cpu_num(void)
+{
+    return nr_cpu_ids;
+}
+EXPORT_SYMBOL(osal_get_cpu_num);
@@ -111,6 +111,17 @@ int osal_schedule_work(struct osal_work_struct *work)
 }
 EXPORT_SYMBOL(osal_schedule_work);
 
+/* wait for a running work and drop a pending one, must be done before the work is destroyed */
+int osal_cancel_work_sync(struct osal_work_struct *work)
+{
+    if ((work != NULL) && (work->work != NULL)) {
+        return (int)cancel_work_sync(work->work);
+    } else {
+        return (int)false;
+    }
+}
+EXPORT_SYMBOL(osal_cancel_work_sync);
+
 void osal_destroy_work(struct osal_work_struct *work)
 {
     if ((work != NULL) && (work->work != NULL)) {